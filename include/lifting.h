@@ -211,6 +211,12 @@ TemporalS *sync_tfunc4_temporals_temporals_cross(TemporalS *ts1, TemporalS *ts2,
 Temporal *sync_tfunc4_temporal_temporal_cross(Temporal *temp1, Temporal *temp2,
 	Datum (*func)(Datum, Datum, Oid, Oid), Oid valuetypid);
 
+TemporalSeq *sync_tfuncn_temporalseq(TemporalSeq **seqs, int count, 
+	Datum param, Datum (*func)(Datum *, int, Datum), Oid valuetypid, 
+	bool linear);
+TemporalS *sync_tfuncn_temporal(Temporal **temps, int count, Datum param,
+	Datum (*func)(Datum *, int, Datum), Oid valuetypid, bool linear);
+
 /*****************************************************************************/
 
 #endif
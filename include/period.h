@@ -62,6 +62,7 @@ extern Datum period_timespan(PG_FUNCTION_ARGS);
 extern Datum period_eq(PG_FUNCTION_ARGS);
 extern Datum period_ne(PG_FUNCTION_ARGS);
 extern Datum period_cmp(PG_FUNCTION_ARGS);
+extern Datum period_sortsupport(PG_FUNCTION_ARGS);
 extern Datum period_lt(PG_FUNCTION_ARGS);
 extern Datum period_le(PG_FUNCTION_ARGS);
 extern Datum period_ge(PG_FUNCTION_ARGS);
@@ -89,8 +90,10 @@ extern void period_set(Period *p, TimestampTz lower, TimestampTz upper,
 extern Period *period_copy(Period *p);
 extern float8 period_to_secs(TimestampTz t1, TimestampTz t2);
 extern Interval *period_timespan_internal(Period *p);
+extern bool periodarr_has_adjacent(Period **periods, int count);
 extern Period **periodarr_normalize(Period **periods, int count, int *newcount);
 extern Period *period_super_union(Period *p1, Period *p2);
+extern void period_expand(Period *p1, const Period *p2);
 
 /* Used for GiST and SP-GiST */
 
@@ -19,6 +19,16 @@
 
 /*****************************************************************************/
 
+/* Structure for constructing a PeriodSet from ordered periods */
+
+typedef struct
+{
+	PeriodSet  *ps;			/* Period set under construction */
+	char	   *data;		/* Pointer to the periods appended so far */
+	int			maxcount;	/* Maximum number of periods */
+	int			count;		/* Number of periods appended so far */
+} PeriodSetBuilder;
+
 /* Assorted support functions */
 
 extern Period *periodset_per_n(PeriodSet *ps, int index);
@@ -26,6 +36,10 @@ extern Period *periodset_bbox(PeriodSet *ps);
 extern PeriodSet *periodset_from_periodarr_internal(Period **periods, 
 	int count, bool normalize);
 extern PeriodSet *periodset_copy(PeriodSet *ps);
+extern void periodset_build_init(PeriodSetBuilder *builder, int maxcount);
+extern void periodset_build_append(PeriodSetBuilder *builder,
+	TimestampTz lower, TimestampTz upper, bool lower_inc, bool upper_inc);
+extern PeriodSet *periodset_build_finish(PeriodSetBuilder *builder);
 extern bool periodset_find_timestamp(PeriodSet *ps, TimestampTz t, int *pos);
 
 /* Input/output functions */
@@ -30,6 +30,9 @@ extern Datum tbox_ge(PG_FUNCTION_ARGS);
 extern Datum tbox_eq(PG_FUNCTION_ARGS);
 extern Datum tbox_ne(PG_FUNCTION_ARGS);
 extern Datum tbox_cmp(PG_FUNCTION_ARGS);
+extern Datum tbox_sortsupport(PG_FUNCTION_ARGS);
+extern Datum tbox_zorder_key(PG_FUNCTION_ARGS);
+extern Datum tbox_hilbert_key(PG_FUNCTION_ARGS);
 
 extern int tbox_cmp_internal(const TBOX *box1, const TBOX *box2);
 extern bool tbox_eq_internal(const TBOX *box1, const TBOX *box2);
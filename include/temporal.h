@@ -18,6 +18,8 @@
 #include <utils/rangetypes.h>
 
 #include "timetypes.h"
+#include "temporal_stats.h"
+#include "temporal_cache.h"
 
 #ifndef USE_FLOAT4_BYVAL
 #error Postgres needs to be configured with USE_FLOAT4_BYVAL
@@ -29,6 +31,10 @@
 
 #define EPSILON					1.0E-06
 
+/* Number of instants scanned forward from the position found by a previous
+ * search before reverting to a binary search */
+#define HINT_MAX_SCAN			8
+
 #define MOBDB_LIB_VERSION_STR "MobilityDB 1.0alpha1"
 #define MOBDB_PGSQL_VERSION 115
 #define MOBDB_PGSQL_VERSION_STR "PostgreSQL 11.5"
@@ -83,20 +89,92 @@ struct temporal_duration_struct
 #define MOBDB_FLAGS_GET_Z(flags) 			((bool) (((flags) & 0x08)>>3))
 #define MOBDB_FLAGS_GET_T(flags) 			((bool) (((flags) & 0x10)>>4))
 #define MOBDB_FLAGS_GET_GEODETIC(flags) 	((bool) (((flags) & 0x20)>>5))
+/* The following flags are only used for TemporalSeq */
+#define MOBDB_FLAGS_GET_TRAJ(flags) 		((bool) (((flags) & 0x40)>>6))
+#define MOBDB_FLAGS_GET_SUMMARY(flags) 		((bool) (((flags) & 0x80)>>7))
+/* The following flag is only used for TemporalI, TemporalSeq, and TemporalS */
+#define MOBDB_FLAGS_GET_OFFSETS32(flags) 	((bool) (((flags) & 0x100)>>8))
+/* The following flag is only used for TemporalSeq and TemporalS */
+#define MOBDB_FLAGS_GET_COMPRESSED(flags) 	((bool) (((flags) & 0x200)>>9))
 
 #define MOBDB_FLAGS_SET_LINEAR(flags, value) \
-	((flags) = (value) ? ((flags) | 0x01) : ((flags) & 0xFE))
+	((flags) = (value) ? ((flags) | 0x01) : ((flags) & ~0x01))
 /* The following flag is only used for TemporalInst */
 #define MOBDB_FLAGS_SET_BYVAL(flags, value) \
-	((flags) = (value) ? ((flags) | 0x02) : ((flags) & 0xFD))
+	((flags) = (value) ? ((flags) | 0x02) : ((flags) & ~0x02))
 #define MOBDB_FLAGS_SET_X(flags, value) \
-	((flags) = (value) ? ((flags) | 0x04) : ((flags) & 0xFB))
+	((flags) = (value) ? ((flags) | 0x04) : ((flags) & ~0x04))
 #define MOBDB_FLAGS_SET_Z(flags, value) \
-	((flags) = (value) ? ((flags) | 0x08) : ((flags) & 0xF7))
+	((flags) = (value) ? ((flags) | 0x08) : ((flags) & ~0x08))
 #define MOBDB_FLAGS_SET_T(flags, value) \
-	((flags) = (value) ? ((flags) | 0x10) : ((flags) & 0xEF))
+	((flags) = (value) ? ((flags) | 0x10) : ((flags) & ~0x10))
 #define MOBDB_FLAGS_SET_GEODETIC(flags, value) \
-	((flags) = (value) ? ((flags) | 0x20) : ((flags) & 0xDF))
+	((flags) = (value) ? ((flags) | 0x20) : ((flags) & ~0x20))
+/* The following flags are only used for TemporalSeq */
+#define MOBDB_FLAGS_SET_TRAJ(flags, value) \
+	((flags) = (value) ? ((flags) | 0x40) : ((flags) & ~0x40))
+#define MOBDB_FLAGS_SET_SUMMARY(flags, value) \
+	((flags) = (value) ? ((flags) | 0x80) : ((flags) & ~0x80))
+/* The following flag is only used for TemporalI, TemporalSeq, and TemporalS */
+#define MOBDB_FLAGS_SET_OFFSETS32(flags, value) \
+	((flags) = (value) ? ((flags) | 0x100) : ((flags) & ~0x100))
+/* The following flag is only used for TemporalSeq and TemporalS */
+#define MOBDB_FLAGS_SET_COMPRESSED(flags, value) \
+	((flags) = (value) ? ((flags) | 0x200) : ((flags) & ~0x200))
+
+/*****************************************************************************
+ * Macros for manipulating the offsets of TemporalI, TemporalSeq, and TemporalS
+ *
+ * Version 1 of the on-disk format stores the offsets of the components in
+ * an array of size_t. Version 2, which is recorded with the OFFSETS32 flag
+ * and is the one used for all new values, stores them in an array of uint32
+ * padded to a multiple of 8 bytes. Since a varlena cannot exceed 1 GB, the
+ * offsets always fit in 32 bits. The data follows the array of offsets in
+ * both versions, so that values of version 1 written by previous releases
+ * are read without conversion. They are rewritten in version 2 with the
+ * function temporal_upgrade.
+ *****************************************************************************/
+
+#define TEMPORAL_FORMAT_VERSION(flags) \
+	(MOBDB_FLAGS_GET_OFFSETS32(flags) ? 2 : 1)
+/* Size of an array of n offsets including the padding */
+#define TEMPORAL_OFFSETS_SIZE(flags, n) \
+	(MOBDB_FLAGS_GET_OFFSETS32(flags) ? \
+		DOUBLEALIGN(sizeof(uint32) * (n)) : sizeof(size_t) * (n))
+/* Start of the data following an array of n offsets */
+#define TEMPORAL_DATA_PTR(offsets, flags, n) \
+	((char *) (offsets) + TEMPORAL_OFFSETS_SIZE(flags, n))
+#define TEMPORAL_OFFSET_GET(offsets, flags, i) \
+	(MOBDB_FLAGS_GET_OFFSETS32(flags) ? \
+		(size_t) ((uint32 *) (offsets))[i] : ((size_t *) (offsets))[i])
+#define TEMPORAL_OFFSET_SET(offsets, flags, i, value) \
+	do { \
+		if (MOBDB_FLAGS_GET_OFFSETS32(flags)) \
+			((uint32 *) (offsets))[i] = (uint32) (value); \
+		else \
+			((size_t *) (offsets))[i] = (value); \
+	} while (0)
+
+/*****************************************************************************
+ * Compressed layout of TemporalSeq and TemporalS
+ *
+ * The values compressed with the function temporal_compress are recorded
+ * with the COMPRESSED flag. They have no offsets: their fixed part is
+ * followed by the bounding box, by the period in the case of a TemporalS,
+ * and by the instants encoded as explained in temporal_compress.c. The
+ * bounding box and the period are thus read without decoding the value. 
+ * The instants are decoded by PG_GETARG_TEMPORAL, which is why the other 
+ * ways to get a full temporal value from a datum must go through 
+ * temporal_detoast_uncompressed.
+ *****************************************************************************/
+
+/* Bounding box of a compressed TemporalSeq or TemporalS */
+#define TEMPORAL_COMPRESSED_BBOX_PTR(temp) \
+	((void *) (temp)->offsets)
+/* Period of a compressed TemporalS */
+#define TEMPORALS_COMPRESSED_PERIOD_PTR(ts) \
+	((Period *) ((char *) (ts)->offsets + \
+		double_pad(temporal_bbox_size((ts)->valuetypid))))
 
 /*****************************************************************************
  * Struct definitions
@@ -249,13 +327,14 @@ typedef int (*qsort_comparator) (const void *a, const void *b);
 
 /* Temporal types */
 
+/* The following macros do not decode the compressed values */
 #define DatumGetTemporal(X)			((Temporal *) PG_DETOAST_DATUM(X))
 #define DatumGetTemporalInst(X)		((TemporalInst *) PG_DETOAST_DATUM(X))
 #define DatumGetTemporalI(X)		((TemporalI *) PG_DETOAST_DATUM(X))
 #define DatumGetTemporalSeq(X)		((TemporalSeq *) PG_DETOAST_DATUM(X))
 #define DatumGetTemporalS(X)		((TemporalS *) PG_DETOAST_DATUM(X))
 
-#define PG_GETARG_TEMPORAL(i)		((Temporal *) PG_GETARG_VARLENA_P(i))
+#define PG_GETARG_TEMPORAL(i)		((Temporal *) temporal_detoast_cached(PG_GETARG_DATUM(i)))
 
 #define PG_GETARG_ANYDATUM(i) (get_typlen(get_fn_expr_argtype(fcinfo->flinfo, i)) == -1 ? \
 	PointerGetDatum(PG_GETARG_VARLENA_P(i)) : PG_GETARG_DATUM(i))
@@ -285,6 +364,7 @@ typedef int (*qsort_comparator) (const void *a, const void *b);
 /* Internal functions */
 
 extern Temporal *temporal_copy(Temporal *temp);
+extern bool temporal_identical(const void *t1, const void *t2);
 extern Temporal *pg_getarg_temporal(Temporal *temp);
 extern bool intersection_temporal_temporal(Temporal *temp1, Temporal *temp2, 
 	Temporal **inter1, Temporal **inter2);
@@ -308,6 +388,7 @@ extern bool temporal_type_oid(Oid temptypid);
 
 /* Trajectory functions */
 
+extern bool precompute_trajectory;
 extern bool type_has_precomputed_trajectory(Oid valuetypid);
 
 /* Parameter tests */
@@ -338,6 +419,8 @@ extern Datum temporali_constructor(PG_FUNCTION_ARGS);
 extern Datum tlinearseq_constructor(PG_FUNCTION_ARGS);
 extern Datum temporalseq_constructor(PG_FUNCTION_ARGS);
 extern Datum temporals_constructor(PG_FUNCTION_ARGS);
+extern Datum temporal_append_instants(PG_FUNCTION_ARGS);
+extern Datum temporal_merge(PG_FUNCTION_ARGS);
 
 /* Cast functions */
 
@@ -345,12 +428,15 @@ extern Datum tint_to_tfloat(PG_FUNCTION_ARGS);
 extern Datum temporal_to_period(PG_FUNCTION_ARGS);
 
 extern Temporal *tint_to_tfloat_internal(Temporal *temp);
+extern void tint_to_tfloat_inplace(Temporal *temp);
 
 /* Accessor functions */
 
 extern Datum temporal_duration(PG_FUNCTION_ARGS);
 extern Datum temporal_interpolation(PG_FUNCTION_ARGS);
 extern Datum temporal_mem_size(PG_FUNCTION_ARGS);
+extern Datum temporal_format_version(PG_FUNCTION_ARGS);
+extern Datum temporal_upgrade(PG_FUNCTION_ARGS);
 extern Datum temporal_get_values(PG_FUNCTION_ARGS);
 extern Datum temporal_get_time(PG_FUNCTION_ARGS);
 extern Datum temporalinst_get_value(PG_FUNCTION_ARGS);
@@ -360,17 +446,22 @@ extern Datum temporal_start_value(PG_FUNCTION_ARGS);
 extern Datum temporal_end_value(PG_FUNCTION_ARGS);
 extern Datum temporal_min_value(PG_FUNCTION_ARGS);
 extern Datum temporal_max_value(PG_FUNCTION_ARGS);
+extern Datum tnumber_min_value_period(PG_FUNCTION_ARGS);
+extern Datum tnumber_max_value_period(PG_FUNCTION_ARGS);
 extern Datum temporal_num_instants(PG_FUNCTION_ARGS);
 extern Datum temporal_start_instant(PG_FUNCTION_ARGS);
 extern Datum temporal_end_instant(PG_FUNCTION_ARGS);
 extern Datum temporal_instant_n(PG_FUNCTION_ARGS);
 extern Datum temporal_instants(PG_FUNCTION_ARGS);
+extern Datum temporal_unnest(PG_FUNCTION_ARGS);
 extern Datum temporal_num_timestamps(PG_FUNCTION_ARGS);
 extern Datum temporal_start_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_end_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_timestamp_n(PG_FUNCTION_ARGS);
 extern Datum temporal_shift(PG_FUNCTION_ARGS);
 
+extern void temporal_shift_inplace(Temporal *temp, Interval *interval);
+
 extern Datum temporal_ever_eq(PG_FUNCTION_ARGS);
 extern Datum temporal_ever_ne(PG_FUNCTION_ARGS);
 extern Datum temporal_ever_lt(PG_FUNCTION_ARGS);
@@ -385,7 +476,11 @@ extern Datum temporal_always_le(PG_FUNCTION_ARGS);
 extern Datum temporal_always_gt(PG_FUNCTION_ARGS);
 extern Datum temporal_always_ge(PG_FUNCTION_ARGS);
 
+extern TemporalS *temporal_merge_internal(Temporal **temparr, int count,
+	bool last);
 extern PeriodSet *temporal_get_time_internal(Temporal *temp);
+extern Temporal *temporal_upgrade_internal(Temporal *temp);
+extern Datum *temporal_values1(Temporal *temp, int *count);
 extern Datum tfloat_ranges(Temporal *temp);
 extern Datum temporal_min_value_internal(Temporal *temp);
 extern TimestampTz temporal_start_timestamp_internal(Temporal *temp);
@@ -401,6 +496,13 @@ extern Datum temporal_at_values(PG_FUNCTION_ARGS);
 extern Datum tnumber_at_range(PG_FUNCTION_ARGS);
 extern Datum tnumber_minus_range(PG_FUNCTION_ARGS);
 extern Datum tnumber_at_ranges(PG_FUNCTION_ARGS);
+extern Datum temporal_when_at_value(PG_FUNCTION_ARGS);
+extern Datum tbool_when_true(PG_FUNCTION_ARGS);
+extern Datum tnumber_when_at_range(PG_FUNCTION_ARGS);
+extern Datum tnumber_when_lt(PG_FUNCTION_ARGS);
+extern Datum tnumber_when_le(PG_FUNCTION_ARGS);
+extern Datum tnumber_when_gt(PG_FUNCTION_ARGS);
+extern Datum tnumber_when_ge(PG_FUNCTION_ARGS);
 extern Datum tnumber_minus_ranges(PG_FUNCTION_ARGS);
 extern Datum temporal_at_min(PG_FUNCTION_ARGS);
 extern Datum temporal_minus_min(PG_FUNCTION_ARGS);
@@ -409,6 +511,7 @@ extern Datum temporal_minus_max(PG_FUNCTION_ARGS);
 extern Datum temporal_at_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_minus_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_value_at_timestamp(PG_FUNCTION_ARGS);
+extern Datum temporal_values_at_timestampset(PG_FUNCTION_ARGS);
 extern Datum temporal_at_timestampset(PG_FUNCTION_ARGS);
 extern Datum temporal_minus_timestampset(PG_FUNCTION_ARGS);
 extern Datum temporal_at_period(PG_FUNCTION_ARGS);
@@ -419,11 +522,31 @@ extern Datum temporal_intersects_timestamp(PG_FUNCTION_ARGS);
 extern Datum temporal_intersects_timestampset(PG_FUNCTION_ARGS);
 extern Datum temporal_intersects_period(PG_FUNCTION_ARGS);
 extern Datum temporal_intersects_periodset(PG_FUNCTION_ARGS);
+
+/* Sampling functions */
+
+extern Datum temporal_sample(PG_FUNCTION_ARGS);
+extern Datum temporal_bucket(PG_FUNCTION_ARGS);
+extern Datum temporalarr_sync(PG_FUNCTION_ARGS);
+extern Datum temporalarr_sync_grid(PG_FUNCTION_ARGS);
+
+extern int64 interval_grid_step(Interval *interval);
+extern TimestampTz timestamp_grid_ceil(TimestampTz t, TimestampTz origin,
+	int64 step);
+extern int64 timestamp_grid_bucket(TimestampTz t, TimestampTz origin,
+	int64 step);
  
 extern Temporal *temporal_at_min_internal(Temporal *temp);
+extern Temporal *temporal_at_value_internal(Temporal *temp, Datum value);
+extern PeriodSet *temporal_when_at_value_internal(Temporal *temp, Datum value);
+extern PeriodSet *tnumber_when_at_range_internal(Temporal *temp, RangeType *range);
 extern TemporalInst *temporal_at_timestamp_internal(Temporal *temp, TimestampTz t);
+extern Temporal *temporal_at_period_internal(Temporal *temp, Period *p);
 extern Temporal *temporal_at_periodset_internal(Temporal *temp, PeriodSet *ps);
+extern Temporal *temporal_minus_periodset_internal(Temporal *temp, PeriodSet *ps);
 extern void temporal_period(Period *p, Temporal *temp);
+extern void temporal_period_slice(Datum tempdatum, Period *p);
+extern size_t temporal_bbox_slice(Datum tempdatum, void *box);
 extern char *temporal_to_string(Temporal *temp, char *(*value_out)(Oid, Datum));
 extern void temporal_bbox(void *box, const Temporal *temp);
 
@@ -435,6 +558,7 @@ extern Datum temporal_eq(PG_FUNCTION_ARGS);
 extern Datum temporal_ge(PG_FUNCTION_ARGS);
 extern Datum temporal_gt(PG_FUNCTION_ARGS);
 extern Datum temporal_cmp(PG_FUNCTION_ARGS);
+extern Datum temporal_sortsupport(PG_FUNCTION_ARGS);
 extern Datum temporal_hash(PG_FUNCTION_ARGS);
 
 extern uint32 temporal_hash_internal(const Temporal *temp);
@@ -15,6 +15,7 @@
 
 #include <postgres.h>
 #include <catalog/pg_type.h>
+#include <storage/buffile.h>
 #include "temporal.h"
 
 /*****************************************************************************/
@@ -25,6 +26,27 @@
 #define SKIPLIST_INITIAL_CAPACITY 1024
 #define SKIPLIST_GROW 2
 #define SKIPLIST_INITIAL_FREELIST 32
+#define SKIPLIST_BLOCKSIZE (64 * 1024)
+#define SKIPLIST_INITIAL_RUNS 8
+
+/* Sorted run of values of a skiplist written to a temporary file */
+
+typedef struct
+{
+	int fileno;				/* position of the run in the temporary file */
+	off_t offset;
+	int count;				/* number of values of the run */
+} SkipListRun;
+
+typedef struct
+{
+	BufFile *file;
+	Datum (*func)(Datum, Datum);	/* function merging the runs */
+	bool crossings;
+	int count;
+	int capacity;
+	SkipListRun *runs;
+} SkipListSpill;
 
 typedef struct
 {
@@ -42,11 +64,45 @@ typedef struct
 	int freecount;
 	int freecap;
 	int tail;
+	int last[SKIPLIST_MAXLEVEL];
+	bool lastvalid;
 	void *extra;
 	size_t extrasize;
 	Elem *elems;
+	MemoryContext ctx;		/* memory context of the temporal values */
+	size_t memsize;			/* size of the temporal values */
+	size_t peakmemsize;		/* peak size of the temporal values */
+	SkipListSpill *spill;	/* runs spilled to disk, if any */
 } SkipList;
 
+/* InstArr - Internal type for building a temporal sequence from instants */
+
+#define INSTARR_INITIAL_CAPACITY 64
+
+typedef struct
+{
+	int count;
+	int capacity;
+	bool ordered;			/* true if the instants are in time order */
+	TemporalInst **instants;
+} InstArr;
+
+/* BucketCount - Internal type for counting temporal values per time bucket */
+
+#define BUCKETCOUNT_INITIAL_CAPACITY 64
+/* 2000-01-03 00:00:00+00, the default origin of the grids of tsample */
+#define BUCKETCOUNT_DEFAULT_ORIGIN (2 * USECS_PER_DAY)
+
+typedef struct
+{
+	TimestampTz origin;		/* origin of the buckets */
+	int64 step;				/* size of the buckets in microseconds */
+	int64 first;			/* index of the bucket of the first counter */
+	int count;
+	int capacity;
+	int32 *counts;
+} BucketCount;
+
 /*****************************************************************************/
 
 extern Datum datum_min_int32(Datum l, Datum r);
@@ -67,14 +123,20 @@ extern SkipList *skiplist_make(FunctionCallInfo fcinfo, Temporal **values,
 	int count);
 extern void skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, 
 	Temporal **values, int count, Datum (*func)(Datum, Datum), bool crossings);
+extern void skiplist_unspill(FunctionCallInfo fcinfo, SkipList *list);
 extern void aggstate_set_extra(FunctionCallInfo fcinfo, SkipList *state, 
 	void *data, size_t size);
+extern void aggstate_write(SkipList *state, StringInfo buf);
+extern SkipList *aggstate_read(FunctionCallInfo fcinfo, StringInfo buf);
 
 extern SkipList *temporalseq_tagg_transfn(FunctionCallInfo fcinfo, SkipList *state, 
 	TemporalSeq *seq, Datum (*func)(Datum, Datum), bool interpoint);
 extern SkipList *temporal_tagg_combinefn(FunctionCallInfo fcinfo, SkipList *state1,
 	SkipList *state2, Datum (*func)(Datum, Datum), bool crossings);
 
+extern InstArr *instarr_append(FunctionCallInfo fcinfo, InstArr *state, 
+	Datum value, TimestampTz t, Oid valuetypid);
+
 /*****************************************************************************/
 
 extern Datum temporal_extent_transfn(PG_FUNCTION_ARGS);
@@ -104,11 +166,29 @@ extern Datum tnumber_tavg_transfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_combinefn(PG_FUNCTION_ARGS);
 extern Datum temporal_tagg_finalfn(PG_FUNCTION_ARGS);
 extern Datum tnumber_tavg_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_mtransfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_invtransfn(PG_FUNCTION_ARGS);
+extern Datum tnumber_tavg_mtransfn(PG_FUNCTION_ARGS);
+extern Datum tnumber_tavg_invtransfn(PG_FUNCTION_ARGS);
+extern Datum tint_tsum_mfinalfn(PG_FUNCTION_ARGS);
+extern Datum tfloat_tsum_mfinalfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmin_transfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmin_combinefn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmax_transfn(PG_FUNCTION_ARGS);
 extern Datum ttext_tmax_combinefn(PG_FUNCTION_ARGS);
 
+extern Datum temporal_tseq_agg_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tseq_agg_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_tseq_agg_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tseq_agg_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_tseq_agg_deserialize(PG_FUNCTION_ARGS);
+
+extern Datum temporal_tcount_buckets_transfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_buckets_combinefn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_buckets_finalfn(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_buckets_serialize(PG_FUNCTION_ARGS);
+extern Datum temporal_tcount_buckets_deserialize(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
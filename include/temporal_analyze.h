@@ -19,6 +19,23 @@
 #include <parser/parse_oper.h>
 #include <statistics/extended_stats_internal.h>
 
+/*
+ * Two-dimensional histogram of the value and time dimensions of temporal
+ * numbers. The number of cells per dimension is bounded by the statistics
+ * target and by TBOX_HIST_MAX_SIZE.
+ */
+#define STATISTIC_KIND_TBOX_HISTOGRAM  10
+#define TBOX_HIST_MAX_SIZE  100
+
+/*
+ * Most common values of the value sets of temporal values, that is, of the
+ * distinct base values taken by each temporal value, as done by PostgreSQL
+ * for the elements of arrays. The frequencies are followed by the maximum
+ * frequency of the values that are not in the list and by the fraction of
+ * temporal values that take a single base value.
+ */
+#define STATISTIC_KIND_VALUE_MCELEM  11
+
 /* 
  * Extra data for compute_stats function 
  * Structure based on the ArrayAnalyzeExtraData from file array_typanalyze.c
@@ -85,6 +102,9 @@ typedef struct
  * Statistics information for temporal types
  *****************************************************************************/
 
+extern int analyze_detoast_limit;
+extern bool analyze_detoast_limit_reached(double fetched_bytes);
+
 extern void temporal_extra_info(VacAttrStats *stats);
 
 extern void temporalinst_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
@@ -0,0 +1,55 @@
+/*****************************************************************************
+ *
+ * temporal_brin.h
+ *	  BRIN indexes for time types and temporal numbers
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_BRIN_H__
+#define __TEMPORAL_BRIN_H__
+
+#include <postgres.h>
+#include <access/brin_internal.h>
+#include <access/brin_tuple.h>
+#include <access/skey.h>
+#include <catalog/pg_type.h>
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/* Generic functions for BRIN indexes summarizing a range by a bounding box */
+
+extern BrinOpcInfo *brin_bbox_opcinfo(Oid storagetype);
+extern bool brin_bbox_add_null(BrinValues *column);
+extern bool brin_bbox_add_value(BrinValues *column, const void *box,
+	size_t size, bool (*contains)(const void *, const void *),
+	void (*expand)(void *, const void *));
+extern bool brin_bbox_null_consistent(BrinValues *column, ScanKey key,
+	bool *result);
+extern void brin_bbox_union(BrinValues *col_a, BrinValues *col_b,
+	size_t size, void (*expand)(void *, const void *));
+
+/* BRIN functions for time types */
+
+extern Datum brin_period_opcinfo(PG_FUNCTION_ARGS);
+extern Datum brin_timestampset_add_value(PG_FUNCTION_ARGS);
+extern Datum brin_period_add_value(PG_FUNCTION_ARGS);
+extern Datum brin_periodset_add_value(PG_FUNCTION_ARGS);
+extern Datum brin_period_consistent(PG_FUNCTION_ARGS);
+extern Datum brin_period_union(PG_FUNCTION_ARGS);
+
+/* BRIN functions for temporal numbers */
+
+extern Datum brin_tbox_opcinfo(PG_FUNCTION_ARGS);
+extern Datum brin_tnumber_add_value(PG_FUNCTION_ARGS);
+extern Datum brin_tnumber_consistent(PG_FUNCTION_ARGS);
+extern Datum brin_tbox_union(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,29 @@
+/*****************************************************************************
+ *
+ * temporal_cache.h
+ *	  Cache of the temporal values detoasted in the current transaction
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_CACHE_H__
+#define __TEMPORAL_CACHE_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+/*****************************************************************************/
+
+extern int detoast_cache_size;
+extern int shared_cache_size;
+
+extern void temporal_cache_init(void);
+extern struct varlena *temporal_detoast_cached(Datum value);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,33 @@
+/*****************************************************************************
+ *
+ * temporal_compress.h
+ *	  Compressed encoding of temporal sequences and sequence sets
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_COMPRESS_H__
+#define __TEMPORAL_COMPRESS_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+extern Temporal *temporal_compress_internal(Temporal *temp);
+extern Temporal *temporal_uncompressed(Temporal *temp);
+extern Temporal *temporal_detoast_uncompressed(Datum value);
+
+extern Datum temporal_compress(PG_FUNCTION_ARGS);
+extern Datum temporal_decompress(PG_FUNCTION_ARGS);
+extern Datum temporal_is_compressed(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
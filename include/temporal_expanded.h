@@ -0,0 +1,43 @@
+/*****************************************************************************
+ *
+ * temporal_expanded.h
+ *	  Read-write expanded temporal values transformed in place
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_EXPANDED_H__
+#define __TEMPORAL_EXPANDED_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <utils/expandeddatum.h>
+
+#include "temporal.h"
+
+/*****************************************************************************/
+
+/*
+ * Expanded temporal value. The value keeps its flat representation, which
+ * is allocated in the memory context of the object, so that it is flattened
+ * with a single copy.
+ */
+typedef struct
+{
+	ExpandedObjectHeader hdr;	/* Standard header of expanded objects */
+	Temporal   *temp;			/* Flat temporal value */
+} ExpandedTemporal;
+
+#define PG_RETURN_EXPANDED_TEMPORAL(x)	PG_RETURN_DATUM(EOHPGetRWDatum(&(x)->hdr))
+
+extern ExpandedTemporal *expanded_temporal_make(void);
+extern ExpandedTemporal *temporal_get_expanded_rw(Datum value);
+extern ExpandedTemporal *temporal_expand_rw(Datum value);
+
+/*****************************************************************************/
+
+#endif
@@ -15,9 +15,21 @@
 
 #include <postgres.h>
 #include <catalog/pg_type.h>
+#include <fmgr.h>
 
 /*****************************************************************************/
 
+/*
+ * Function converting the query argument of an index method into a box. It
+ * returns false when the query cannot match any index entry, e.g., when it
+ * is an empty geometry.
+ */
+typedef bool (*index_query_box_func)(void *box, Datum query, Oid subtype);
+
+extern bool index_query_box(FmgrInfo *flinfo, Datum query, Oid subtype,
+	index_query_box_func func, size_t boxsize, void *box);
+extern bool temporal_query_box(void *box, Datum query, Oid subtype);
+
 extern Datum gist_temporal_consistent(PG_FUNCTION_ARGS);
 extern Datum gist_temporal_compress(PG_FUNCTION_ARGS);
 
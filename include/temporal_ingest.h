@@ -0,0 +1,31 @@
+/*****************************************************************************
+ *
+ * temporal_ingest.h
+ *	  Batched ingestion of instants into temporal columns
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_INGEST_H__
+#define __TEMPORAL_INGEST_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+/*****************************************************************************/
+
+extern int64 ingest_flush_internal(Oid staging, Oid target, AttrNumber keyatt,
+	AttrNumber tempatt, int batchsize);
+
+extern Datum ingest_flush(PG_FUNCTION_ARGS);
+extern Datum ingest_start(PG_FUNCTION_ARGS);
+
+extern PGDLLEXPORT void ingest_worker_main(Datum main_arg);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,40 @@
+/*****************************************************************************
+ *
+ * temporal_parallel.h
+ *	  Pool of threads for the numeric kernels of a single query
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_PARALLEL_H__
+#define __TEMPORAL_PARALLEL_H__
+
+#include <postgres.h>
+
+/*****************************************************************************/
+
+/* Maximum number of threads, including the backend, running a kernel */
+#define PARALLEL_MAX_THREADS 64
+
+extern int parallel_max_threads;
+
+/*
+ * Kernel applied to the items [start, end) of an array. A kernel may run in
+ * a thread other than the one of the backend and thus must not call any
+ * function of PostgreSQL: it must not allocate memory with palloc, raise
+ * errors with ereport, or access the detoasted values or the catalogs. It
+ * only reads the arrays prepared by the caller and writes the items of the
+ * results it was given.
+ */
+typedef void (*ParallelKernel)(void *arg, int start, int end);
+
+extern void parallel_for(int count, int minchunk, ParallelKernel kernel,
+	void *arg);
+
+/*****************************************************************************/
+
+#endif
@@ -86,6 +86,11 @@ extern Datum overbefore_tnumber_tnumber(PG_FUNCTION_ARGS);
 extern Datum after_tnumber_tnumber(PG_FUNCTION_ARGS);
 extern Datum overafter_tnumber_tnumber(PG_FUNCTION_ARGS);
 
+extern Datum distance_temporal_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_timestamp_temporal(PG_FUNCTION_ARGS);
+extern Datum distance_temporal_period(PG_FUNCTION_ARGS);
+extern Datum distance_period_temporal(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
@@ -0,0 +1,61 @@
+/*****************************************************************************
+ *
+ * temporal_profile.h
+ *	  Per-backend timing of the calls to external functions
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_PROFILE_H__
+#define __TEMPORAL_PROFILE_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <portability/instr_time.h>
+
+/*****************************************************************************/
+
+extern bool profile_enabled;
+extern bool profile_notice;
+
+/*
+ * Time spent in the calls that leave the code of the extension, e.g., the
+ * functions of PostGIS, the detoasting of the temporal arguments, or the
+ * splices into the skiplists of the aggregates. The time is only measured
+ * when the extension is compiled with WITH_PROFILE and mobilitydb.profile
+ * is enabled, otherwise the macros below expand to nothing. The name must
+ * be a string that lives as long as the backend, e.g., a literal.
+ */
+#ifdef WITH_PROFILE
+#define MOBDB_PROFILE_BEGIN(start) \
+	instr_time start; \
+	if (profile_enabled) \
+		profile_begin(&(start)); \
+	else \
+		INSTR_TIME_SET_ZERO(start)
+#define MOBDB_PROFILE_END(name, start) \
+	do { \
+		if (! INSTR_TIME_IS_ZERO(start)) \
+			profile_end((name), &(start)); \
+	} while (0)
+#else
+#define MOBDB_PROFILE_BEGIN(start)		((void) 0)
+#define MOBDB_PROFILE_END(name, start)	((void) 0)
+#endif
+
+extern void profile_begin(instr_time *start);
+extern void profile_end(const char *name, instr_time *start);
+extern void temporal_profile_init(void);
+
+/*****************************************************************************/
+
+extern Datum mobilitydb_profile(PG_FUNCTION_ARGS);
+extern Datum mobilitydb_profile_reset(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
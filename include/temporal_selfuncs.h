@@ -39,6 +39,8 @@ extern Selectivity temporalinst_sel(PlannerInfo *root, VariableStatData *vardata
 	Period *period, CachedOp cachedOp);
 extern Selectivity temporals_sel(PlannerInfo *root, VariableStatData *vardata,
 	Period *period, CachedOp cachedOp);
+extern Selectivity temporals_joinsel(VariableStatData *vardata1,
+	VariableStatData *vardata2, CachedOp cachedOp);
 
 
 /*****************************************************************************
@@ -52,6 +54,7 @@ extern double var_eq_const(VariableStatData *vardata, Oid operator,
 
 extern Datum temporal_sel(PG_FUNCTION_ARGS);
 extern Datum temporal_joinsel(PG_FUNCTION_ARGS);
+extern Datum temporal_ever_sel(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
@@ -0,0 +1,62 @@
+/*****************************************************************************
+ *
+ * temporal_stats.h
+ *	  Per-backend performance counters
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#ifndef __TEMPORAL_STATS_H__
+#define __TEMPORAL_STATS_H__
+
+#include <postgres.h>
+#include <fmgr.h>
+
+/*****************************************************************************/
+
+/*
+ * Counters of the work done in the hot paths of the extension. They are 
+ * only maintained when the extension is compiled with WITH_STATS, otherwise 
+ * the macros below expand to nothing and their arguments are not evaluated.
+ */
+typedef enum
+{
+	STAT_LIFTED_CALLS,			/* Calls to the lifting functions */
+	STAT_LIFTED_INSTANTS,		/* Instants of the arguments of these calls */
+	STAT_SYNC_CALLS,			/* Calls to the synchronized lifting functions */
+	STAT_DETOASTED_VALUES,		/* Temporal arguments that were detoasted */
+	STAT_DETOASTED_BYTES,		/* Size of these values after detoasting */
+	STAT_CONSTRUCTED_BYTES,		/* Size of the temporal values constructed */
+	STAT_FUNCTION_CALLOUTS,		/* Calls through call_functionN, e.g., PostGIS */
+	STAT_SPATIALREL_CALLS,		/* Spatial relationships of temporal points */
+	STAT_SKIPLIST_SPLICES,		/* Splices into the skiplists of aggregates */
+	STAT_SKIPLIST_SPILLS,		/* Runs of these skiplists spilled to disk */
+	STAT_INDEX_CONSISTENT_CALLS,	/* Calls to GiST and SP-GiST consistent */
+	STAT_DETOAST_CACHE_HITS,	/* Temporal arguments found in the detoast cache */
+	STAT_SHARED_CACHE_HITS,		/* Temporal arguments found in the shared cache */
+	STAT_INDEX_QUERY_CACHE_HITS,	/* Index query boxes found in fn_extra */
+	STAT_EXPANDED_REUSED,		/* Read-write expanded arguments reused */
+	STAT_COUNT
+} MobilityStat;
+
+#ifdef WITH_STATS
+extern uint64 mobility_stats[STAT_COUNT];
+#define MOBDB_STAT_ADD(stat, n)		(mobility_stats[(stat)] += (uint64) (n))
+#else
+#define MOBDB_STAT_ADD(stat, n)		((void) 0)
+#endif
+
+#define MOBDB_STAT_INC(stat)		MOBDB_STAT_ADD(stat, 1)
+
+/*****************************************************************************/
+
+extern Datum mobilitydb_stats(PG_FUNCTION_ARGS);
+extern Datum mobilitydb_stats_reset(PG_FUNCTION_ARGS);
+
+/*****************************************************************************/
+
+#endif
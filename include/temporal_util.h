@@ -16,6 +16,7 @@
 #include <postgres.h>
 #include <catalog/pg_type.h>
 #include <utils/rangetypes.h>
+#include <utils/sortsupport.h>
 #include "timetypes.h"
 #include "temporal.h"
 #include "postgis.h"
@@ -38,10 +39,23 @@ extern Datum call_input(Oid type, char *str);
 extern char *call_output(Oid type, Datum value);
 extern bytea *call_send(Oid type, Datum value);
 extern Datum call_recv(Oid type, StringInfo buf);
-extern Datum call_function1(PGFunction func, Datum arg1);
-extern Datum call_function2(PGFunction func, Datum arg1, Datum arg2);
-extern Datum call_function3(PGFunction func, Datum arg1, Datum arg2, Datum arg3);
-extern Datum call_function4(PGFunction func, Datum arg1, Datum arg2, Datum arg3, Datum arg4);
+extern Datum call_function1_named(const char *name, PGFunction func,
+	Datum arg1);
+extern Datum call_function2_named(const char *name, PGFunction func,
+	Datum arg1, Datum arg2);
+extern Datum call_function3_named(const char *name, PGFunction func,
+	Datum arg1, Datum arg2, Datum arg3);
+extern Datum call_function4_named(const char *name, PGFunction func,
+	Datum arg1, Datum arg2, Datum arg3, Datum arg4);
+
+#define call_function1(func, arg1) \
+	call_function1_named(#func, func, arg1)
+#define call_function2(func, arg1, arg2) \
+	call_function2_named(#func, func, arg1, arg2)
+#define call_function3(func, arg1, arg2, arg3) \
+	call_function3_named(#func, func, arg1, arg2, arg3)
+#define call_function4(func, arg1, arg2, arg3, arg4) \
+	call_function4_named(#func, func, arg1, arg2, arg3, arg4)
 
 /* Array functions */
 
@@ -67,15 +81,33 @@ extern void rangearr_sort(RangeType **ranges, int count);
 extern void temporalinstarr_sort(TemporalInst **instants, int count);
 extern void temporalseqarr_sort(TemporalSeq **sequences, int count);
 
+/* Sort support functions */
+
+extern void sortsupport_abbrev_init(SortSupport ssup,
+	int (*comparator)(Datum, Datum, SortSupport), uint64 (*key)(Datum));
+extern uint64 timestamp_sortkey(TimestampTz t);
+extern uint64 double_sortkey(double d);
+
 /* Remove duplicate functions */
 
 extern int datum_remove_duplicates(Datum *values, int count, Oid valuetypid);
 extern int timestamp_remove_duplicates(TimestampTz *values, int count);
 
+/* Search functions */
+
+extern int timestamp_interpolate_pos(TimestampTz lower, TimestampTz upper,
+	int n, TimestampTz t);
+
 /* Text functions */
 
 extern int text_cmp(text *arg1, text *arg2, Oid collid);
 
+/* Hash functions on datums */
+
+extern uint32 double_hash(double d);
+extern uint32 timestamp_hash(TimestampTz t);
+extern uint32 datum_hash(Datum value, Oid type);
+
 /* Comparison functions on datums */
 
 extern bool datum_eq(Datum l, Datum r, Oid type);
@@ -99,6 +131,11 @@ extern Datum datum2_le2(Datum l, Datum r, Oid typel, Oid typer);
 extern Datum datum2_gt2(Datum l, Datum r, Oid typel, Oid typer);
 extern Datum datum2_ge2(Datum l, Datum r, Oid typel, Oid typer);
 
+/* Space-filling curves */
+
+extern double spacefill_coord(double value, double min, double max);
+extern int64 spacefill_key(const double *coords, int n, bool hilbert);
+
 /*****************************************************************************/
 
 #endif
@@ -17,6 +17,7 @@
 #include <catalog/pg_type.h>
 #include <utils/rangetypes.h>
 #include "temporal.h"
+#include "periodset.h"
 
 /*****************************************************************************/
 
@@ -48,6 +49,7 @@ extern TemporalI *temporali_append_instant(TemporalI *ti, TemporalInst *inst);
 /* Cast functions */
  
 TemporalI *tinti_to_tfloati(TemporalI *ti);
+extern void tinti_to_tfloati_inplace(TemporalI *ti);
 TemporalI *tfloati_to_tinti(TemporalI *ti);
 
 /* Transformation functions */
@@ -58,6 +60,7 @@ extern TemporalI *temporals_to_temporali(TemporalS *ts);
 
 /* Accessor functions */
 
+extern Datum *temporali_values1(TemporalI *ti, int *count);
 extern ArrayType *temporali_values(TemporalI *ti);
 extern ArrayType *tfloati_ranges(TemporalI *ti);
 extern PeriodSet *temporali_get_time(TemporalI *ti);
@@ -72,6 +75,7 @@ extern TimestampTz temporali_start_timestamp(TemporalI *ti);
 extern TimestampTz temporali_end_timestamp(TemporalI *ti);
 extern ArrayType *temporali_timestamps(TemporalI *ti);
 extern TemporalI *temporali_shift(TemporalI *ti, Interval *interval);
+extern void temporali_shift_inplace(TemporalI *ti, Interval *interval);
 
 extern bool temporali_ever_eq(TemporalI *ti, Datum value);
 extern bool temporali_ever_lt(TemporalI *ti, Datum value);
@@ -89,6 +93,10 @@ extern TemporalI *temporali_at_values(TemporalI *ti, Datum *values, int count);
 extern TemporalI *temporali_minus_values(TemporalI *ti, Datum *values, int count);
 extern TemporalI *tnumberi_at_range(TemporalI *ti, RangeType *range);
 extern TemporalI *tnumberi_minus_range(TemporalI *ti, RangeType *range);
+extern void temporali_when_at_value(PeriodSetBuilder *builder, TemporalI *ti,
+	Datum value);
+extern void tnumberi_when_at_range(PeriodSetBuilder *builder, TemporalI *ti,
+	RangeType *range);
 extern TemporalI *tnumberi_at_ranges(TemporalI *ti, RangeType **normranges, int count);
 extern TemporalI *tnumberi_minus_ranges(TemporalI *ti, RangeType **normranges, int count);
 extern TemporalI *temporali_at_min(TemporalI *ti);
@@ -97,6 +105,10 @@ extern TemporalI *temporali_at_max(TemporalI *ti);
 extern TemporalI *temporali_minus_max(TemporalI *ti);
 extern TemporalInst *temporali_at_timestamp(TemporalI *ti, TimestampTz t);
 extern bool temporali_value_at_timestamp(TemporalI *ti, TimestampTz t, Datum *result);
+extern bool temporali_value_at_timestamp_hint(TemporalI *ti, TimestampTz t,
+	int *hint, Datum *result);
+extern void temporali_values_at_timestampset(TemporalI *ti, TimestampSet *ts,
+	Datum *values, bool *nulls);
 extern TemporalI * temporali_minus_timestamp(TemporalI *ti, TimestampTz t);
 extern TemporalI *temporali_at_timestampset(TemporalI *ti, TimestampSet *ts);
 extern TemporalI *temporali_minus_timestampset(TemporalI *ti, TimestampSet *ts);
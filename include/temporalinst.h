@@ -17,10 +17,14 @@
 #include <catalog/pg_type.h>
 #include <utils/rangetypes.h>
 #include "temporal.h"
+#include "periodset.h"
 #include "postgis.h"
 
 /*****************************************************************************/
  
+extern size_t temporalinst_make_size(Datum value, Oid valuetypid);
+extern void temporalinst_set(TemporalInst *inst, size_t size, Datum value,
+	TimestampTz t, Oid valuetypid);
 extern TemporalInst *temporalinst_make(Datum value, TimestampTz t, Oid valuetypid);
 extern TemporalInst *temporalinst_copy(TemporalInst *inst);
 extern Datum* temporalinst_value_ptr(TemporalInst *inst);
@@ -45,6 +49,7 @@ extern TemporalI *temporalinst_append_instant(TemporalInst *inst1, TemporalInst
 /* Cast functions */
 
 extern TemporalInst *tintinst_to_tfloatinst(TemporalInst *inst);
+extern void tintinst_to_tfloatinst_inplace(TemporalInst *inst);
 extern TemporalInst *tfloatinst_to_tintinst(TemporalInst *inst);
 
 /* Transformation functions */
@@ -63,6 +68,7 @@ extern void temporalinst_period(Period *p, TemporalInst *inst);
 extern ArrayType *temporalinst_timestamps(TemporalInst *inst);
 extern ArrayType *temporalinst_instants_array(TemporalInst *inst);
 extern TemporalInst *temporalinst_shift(TemporalInst *inst, Interval *interval);
+extern void temporalinst_shift_inplace(TemporalInst *inst, Interval *interval);
 
 extern bool temporalinst_ever_eq(TemporalInst *inst, Datum value);
 extern bool temporalinst_ever_lt(TemporalInst *inst, Datum value);
@@ -80,9 +86,15 @@ extern TemporalInst *temporalinst_at_values(TemporalInst *inst, Datum *values, i
 extern TemporalInst *temporalinst_minus_values(TemporalInst *inst, Datum *values, int count);
 extern TemporalInst *tnumberinst_at_range(TemporalInst *inst, RangeType *range);
 extern TemporalInst *tnumberinst_minus_range(TemporalInst *inst, RangeType *range);
+extern void temporalinst_when_at_value(PeriodSetBuilder *builder,
+	TemporalInst *inst, Datum value);
+extern void tnumberinst_when_at_range(PeriodSetBuilder *builder,
+	TemporalInst *inst, RangeType *range);
 
 extern TemporalInst *temporalinst_at_timestamp(TemporalInst *inst, TimestampTz t);
 extern bool temporalinst_value_at_timestamp(TemporalInst *inst, TimestampTz t, Datum *result);
+extern void temporalinst_values_at_timestampset(TemporalInst *inst,
+	TimestampSet *ts, Datum *values, bool *nulls);
 extern TemporalInst *temporalinst_minus_timestamp(TemporalInst *inst, TimestampTz t);
 extern TemporalInst *temporalinst_at_timestampset(TemporalInst *inst, TimestampSet *ts);
 extern TemporalInst *temporalinst_minus_timestampset(TemporalInst *inst, TimestampSet *ts);
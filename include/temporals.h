@@ -17,6 +17,7 @@
 #include <catalog/pg_type.h>
 #include <utils/rangetypes.h>
 #include "temporal.h"
+#include "periodset.h"
 
 /*****************************************************************************/
 
@@ -64,10 +65,13 @@ extern TemporalS *temporals_read(StringInfo buf, Oid valuetypid);
 /* Append function */
 
 extern TemporalS *temporals_append_instant(TemporalS *ts, TemporalInst *inst);
+extern TemporalS *temporals_append_instants(TemporalS *ts, 
+	TemporalInst **instants, int count);
 
 /* Cast functions */
 
 extern TemporalS *tints_to_tfloats(TemporalS *ts);
+extern void tints_to_tfloats_inplace(TemporalS *ts);
 extern TemporalS *tfloats_to_tints(TemporalS *ts);
 
 /* Transformation functions */
@@ -86,6 +90,8 @@ extern void *temporals_bbox_ptr(TemporalS *ts);
 extern void temporals_bbox(void *box, TemporalS *ts);
 extern Datum temporals_min_value(TemporalS *ts);
 extern Datum temporals_max_value(TemporalS *ts);
+extern bool tnumbers_minmax_period(TemporalS *ts, Period *p, 
+	double *min, double *max);
 extern PeriodSet *temporals_get_time(TemporalS *ts);
 extern Datum temporals_timespan(TemporalS *ts);
 extern void temporals_period(Period *p, TemporalS *ts);
@@ -93,14 +99,21 @@ extern TemporalSeq **temporals_sequences(TemporalS *ts);
 extern ArrayType *temporals_sequences_array(TemporalS *ts);
 extern int temporals_num_instants(TemporalS *ts);
 extern TemporalInst *temporals_instant_n(TemporalS *ts, int n);
+extern void temporals_instant_counts(TemporalS *ts, int *counts);
+extern TemporalInst *temporals_instant_n_counts(TemporalS *ts, 
+	const int *counts, int n);
 extern ArrayType *temporals_instants_array(TemporalS *ts);
 extern TimestampTz temporals_start_timestamp(TemporalS *ts);
 extern TimestampTz temporals_end_timestamp(TemporalS *ts);
 extern int temporals_num_timestamps(TemporalS *ts);
 extern bool temporals_timestamp_n(TemporalS *ts, int n, TimestampTz *result);
+extern void temporals_timestamp_counts(TemporalS *ts, int *counts);
+extern bool temporals_timestamp_n_counts(TemporalS *ts, const int *counts,
+	int n, TimestampTz *result);
 extern TimestampTz *temporals_timestamps1(TemporalS *ts, int *count);
 extern ArrayType *temporals_timestamps(TemporalS *ts);
 extern TemporalS *temporals_shift(TemporalS *ts, Interval *interval);
+extern void temporals_shift_inplace(TemporalS *ts, Interval *interval);
 
 extern bool temporals_ever_eq(TemporalS *ts, Datum value);
 extern bool temporals_ever_lt(TemporalS *ts, Datum value);
@@ -118,6 +131,10 @@ extern TemporalS *temporals_at_values(TemporalS *ts, Datum *values, int count);
 extern TemporalS *temporals_minus_values(TemporalS *ts, Datum *values, int count);
 extern TemporalS *tnumbers_at_range(TemporalS *ts, RangeType *range);
 extern TemporalS *tnumbers_minus_range(TemporalS *ts, RangeType *range);
+extern void temporals_when_at_value(PeriodSetBuilder *builder, TemporalS *ts,
+	Datum value);
+extern void tnumbers_when_at_range(PeriodSetBuilder *builder, TemporalS *ts,
+	RangeType *range);
 extern TemporalS *tnumbers_at_ranges(TemporalS *ts, RangeType **normranges, int count);
 extern TemporalS *tnumbers_minus_ranges(TemporalS *ts, RangeType **normranges, int count);
 extern TemporalS *temporals_at_min(TemporalS *ts);
@@ -126,6 +143,10 @@ extern TemporalS *temporals_at_max(TemporalS *ts);
 extern TemporalS *temporals_minus_max(TemporalS *ts);
 extern TemporalInst *temporals_at_timestamp(TemporalS *ts, TimestampTz t);
 extern bool temporals_value_at_timestamp(TemporalS *ts, TimestampTz t, Datum *result);
+extern bool temporals_value_at_timestamp_hint(TemporalS *ts, TimestampTz t,
+	int *seqhint, int *insthint, Datum *result);
+extern void temporals_values_at_timestampset(TemporalS *ts1, TimestampSet *ts2,
+	Datum *values, bool *nulls);
 extern TemporalS *temporals_minus_timestamp(TemporalS *ts, TimestampTz t);
 extern TemporalI *temporals_at_timestampset(TemporalS *ts, TimestampSet *ts1);
 extern TemporalS *temporals_minus_timestampset(TemporalS *ts, TimestampSet *ts1);
@@ -142,6 +163,8 @@ extern bool temporals_intersects_periodset(TemporalS *ts, PeriodSet *ps);
 
 extern double tnumbers_integral(TemporalS *ts);
 extern double tnumbers_twavg(TemporalS *ts);
+extern double tnumbers_integral_period(TemporalS *ts, Period *p);
+extern double tnumbers_twavg_period(TemporalS *ts, Period *p);
 
 /* Comparison functions */
 
@@ -17,16 +17,65 @@
 #include <catalog/pg_type.h>
 #include <utils/rangetypes.h>
 #include "temporal.h"
+#include "periodset.h"
+
+/*****************************************************************************/
+
+/* Structure for constructing a TemporalSeq from ordered instants */
+
+typedef struct
+{
+	TemporalSeq *seq;		/* Sequence under construction */
+	Oid			valuetypid;	/* Base type of the instants */
+	bool		linear;		/* Linear interpolation */
+	bool		normalize;	/* Remove the redundant instants */
+	int			maxcount;	/* Number of instants of the array of offsets */
+	int			count;		/* Number of instants appended so far */
+	size_t		pdata;		/* Offset of the instants in the sequence */
+	size_t		size;		/* Size of the instants appended so far */
+	size_t		maxsize;	/* Allocated size of the sequence */
+	TBOX		box;		/* Bounding box of temporal numbers */
+} TemporalSeqBuilder;
+
+/* Block summary of long sequences of temporal numbers */
+
+#define SUMMARY_BLOCK_SIZE	32	/* Number of segments of a block */
+
+typedef struct
+{
+	int32		size;		/* Size of the summary in bytes */
+	int32		count;		/* Number of blocks */
+	double		integral[1];	/* Integral from the first instant to the 
+							   first instant of each block and to the last
+							   instant, count + 1 values, followed by the
+							   minimum and maximum values of the nodes of
+							   a segment tree over the blocks, 4 * count 
+							   values */
+} TemporalSeqSummary;
+
+extern int summary_min_count;
 
 /*****************************************************************************/
 
 extern TemporalInst *temporalseq_inst_n(TemporalSeq *seq, int index);
+extern TemporalSeqSummary *temporalseq_summary_ptr(TemporalSeq *seq);
 extern TemporalSeq *temporalseq_from_temporalinstarr(TemporalInst **instants, 
 	int count, bool lower_inc, bool upper_inc, bool linear, bool normalize);
+extern void temporalseq_build_init(TemporalSeqBuilder *builder, 
+	Oid valuetypid, int maxcount, bool linear, bool normalize);
+extern void temporalseq_build_append(TemporalSeqBuilder *builder,
+	Datum value, TimestampTz t);
+extern void temporalseq_build_append_inst(TemporalSeqBuilder *builder,
+	TemporalInst *inst);
+extern TemporalSeq *temporalseq_build_finish(TemporalSeqBuilder *builder,
+	bool lower_inc, bool upper_inc);
 extern TemporalSeq *temporalseq_copy(TemporalSeq *seq);
 extern int temporalseq_find_timestamp(TemporalSeq *seq, TimestampTz t);
+extern int temporalseq_find_timestamp_hint(TemporalSeq *seq, TimestampTz t,
+	int hint);
 extern Datum temporalseq_value_at_timestamp1(TemporalInst *inst1, 
 	TemporalInst *inst2, bool linear, TimestampTz t);
+extern bool temporalseqarr_has_adjacent(TemporalSeq **sequences, int count);
 extern TemporalSeq **temporalseqarr_normalize(TemporalSeq **sequences, int count, 
 	int *newcount);
 
@@ -48,6 +97,8 @@ extern bool intersection_temporalseq_temporalseq(TemporalSeq *seq1, TemporalSeq
 extern bool synchronize_temporalseq_temporalseq(TemporalSeq *seq1, TemporalSeq *seq2, 
 	TemporalSeq **sync1, TemporalSeq **sync2, bool interpoint);
 
+extern bool tnumberseq_intersect_at_timestamp(TemporalInst *start1, 
+	TemporalInst *end1, TemporalInst *start2, TemporalInst *end2, TimestampTz *t);
 extern bool tpointseq_intersect_at_timestamp(TemporalInst *start1, TemporalInst *end1, 
 	bool linear1, TemporalInst *start2, TemporalInst *end2, bool linear2, TimestampTz *t);
 extern bool temporalseq_intersect_at_timestamp(TemporalInst *start1, TemporalInst *end1, 
@@ -62,10 +113,13 @@ extern TemporalSeq *temporalseq_read(StringInfo buf, Oid valuetypid);
 /* Append function */
 
 extern TemporalSeq *temporalseq_append_instant(TemporalSeq *seq, TemporalInst *inst);
+extern TemporalSeq *temporalseq_append_instants(TemporalSeq *seq, 
+	TemporalInst **instants, int count);
 
 /* Cast functions */
 
 extern TemporalSeq *tintseq_to_tfloatseq(TemporalSeq *seq);
+extern void tintseq_to_tfloatseq_inplace(TemporalSeq *seq);
 extern TemporalSeq *tfloatseq_to_tintseq(TemporalSeq *seq);
 
 /* Transformation functions */
@@ -88,6 +142,8 @@ extern RangeType *tfloatseq_range(TemporalSeq *seq);
 extern ArrayType *tfloatseq_ranges(TemporalSeq *seq);
 extern Datum temporalseq_min_value(TemporalSeq *seq);
 extern Datum temporalseq_max_value(TemporalSeq *seq);
+extern void tnumberseq_minmax_period(TemporalSeq *seq, Period *p, 
+	double *min, double *max);
 extern void temporalseq_period(Period *p, TemporalSeq *seq);
 extern Datum temporalseq_timespan(TemporalSeq *seq);
 extern TemporalInst **temporalseq_instants(TemporalSeq *seq);
@@ -98,6 +154,7 @@ extern TimestampTz *temporalseq_timestamps1(TemporalSeq *seq);
 extern ArrayType *temporalseq_timestamps(TemporalSeq *seq);
 extern TemporalSeq *temporalseq_shift(TemporalSeq *seq, 
 	Interval *interval);
+extern void temporalseq_shift_inplace(TemporalSeq *seq, Interval *interval);
 
 extern bool temporalseq_ever_eq(TemporalSeq *seq, Datum value);
 extern bool temporalseq_ever_lt(TemporalSeq *seq, Datum value);
@@ -125,6 +182,10 @@ extern int tnumberseq_at_range2(TemporalSeq **result, TemporalSeq *seq, RangeTyp
 extern TemporalS *tnumberseq_at_range(TemporalSeq *seq, RangeType *range);
 extern int tnumberseq_minus_range1(TemporalSeq **result, TemporalSeq *seq, RangeType *range);
 extern TemporalS *tnumberseq_minus_range(TemporalSeq *seq, RangeType *range);
+extern void temporalseq_when_at_value(PeriodSetBuilder *builder,
+	TemporalSeq *seq, Datum value);
+extern void tnumberseq_when_at_range(PeriodSetBuilder *builder,
+	TemporalSeq *seq, RangeType *range);
 extern int tnumberseq_at_ranges1(TemporalSeq **result, TemporalSeq *seq, 
 	RangeType **normranges, int count);
 extern TemporalS *tnumberseq_at_ranges(TemporalSeq *seq, 
@@ -142,6 +203,12 @@ extern TemporalInst *temporalseq_at_timestamp1(TemporalInst *inst1,
 	TemporalInst *inst2, bool linear, TimestampTz t);
 extern TemporalInst *temporalseq_at_timestamp(TemporalSeq *seq, TimestampTz t);
 extern bool temporalseq_value_at_timestamp(TemporalSeq *seq, TimestampTz t, Datum *result);
+extern bool temporalseq_value_at_timestamp_hint(TemporalSeq *seq, TimestampTz t,
+	int *hint, Datum *result);
+extern void temporalseq_values_at_timestampset1(TemporalSeq *seq,
+	TimestampSet *ts, int *pos, Datum *values, bool *nulls);
+extern void temporalseq_values_at_timestampset(TemporalSeq *seq,
+	TimestampSet *ts, Datum *values, bool *nulls);
 extern int temporalseq_minus_timestamp1(TemporalSeq **result, TemporalSeq *seq, 
 	TimestampTz t);
 extern TemporalS *temporalseq_minus_timestamp(TemporalSeq *seq, TimestampTz t);
@@ -151,11 +218,13 @@ extern int temporalseq_minus_timestampset1(TemporalSeq **result, TemporalSeq *se
 extern TemporalS *temporalseq_minus_timestampset(TemporalSeq *seq, TimestampSet *ts);
 extern TemporalSeq *temporalseq_at_period(TemporalSeq *seq, Period *p);
 extern TemporalS *temporalseq_minus_period(TemporalSeq *seq, Period *p);
+extern int temporalseq_at_periodset_walk(TemporalSeq **result, TemporalSeq *seq, 
+	PeriodSet *ps, int *from);
 extern int temporalseq_at_periodset1(TemporalSeq **result, TemporalSeq *seq, PeriodSet *ps);
 extern TemporalSeq **temporalseq_at_periodset2(TemporalSeq *seq, PeriodSet *ps, int *count);
 extern TemporalS *temporalseq_at_periodset(TemporalSeq *seq, PeriodSet *ps);
 extern int temporalseq_minus_periodset1(TemporalSeq **result, TemporalSeq *seq, PeriodSet *ps, 
-	int from, int count);
+	int *from);
 extern TemporalS *temporalseq_minus_periodset(TemporalSeq *seq, PeriodSet *ps);
 extern bool temporalseq_intersects_timestamp(TemporalSeq *seq, TimestampTz t);
 extern bool temporalseq_intersects_timestampset(TemporalSeq *seq, TimestampSet *t);
@@ -166,6 +235,8 @@ extern bool temporalseq_intersects_periodset(TemporalSeq *seq, PeriodSet *ps);
 
 extern double tnumberseq_integral(TemporalSeq *seq);
 extern double tnumberseq_twavg(TemporalSeq *seq);
+extern double tnumberseq_integral_period(TemporalSeq *seq, Period *p);
+extern double tnumberseq_twavg_period(TemporalSeq *seq, Period *p);
 
 /* Comparison functions */
 
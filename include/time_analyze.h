@@ -43,6 +43,8 @@ extern Datum period_analyze(PG_FUNCTION_ARGS);
 extern Datum timestampset_analyze(PG_FUNCTION_ARGS);
 extern Datum periodset_analyze(PG_FUNCTION_ARGS);
 
+extern Datum merge_period_stats(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
@@ -26,8 +26,17 @@ extern Datum gist_periodset_compress(PG_FUNCTION_ARGS);
 extern Datum gist_period_penalty(PG_FUNCTION_ARGS);
 extern Datum gist_period_picksplit(PG_FUNCTION_ARGS);
 extern Datum gist_period_same(PG_FUNCTION_ARGS);
+extern Datum gist_period_distance(PG_FUNCTION_ARGS);
+extern Datum gist_timeset_distance(PG_FUNCTION_ARGS);
 extern Datum gist_period_fetch(PG_FUNCTION_ARGS);
 
+extern Datum gist_periodset_consistent(PG_FUNCTION_ARGS);
+extern Datum gist_periodset_distance(PG_FUNCTION_ARGS);
+extern Datum gist_periodset_union(PG_FUNCTION_ARGS);
+extern Datum gist_periodset_penalty(PG_FUNCTION_ARGS);
+extern Datum gist_periodset_picksplit(PG_FUNCTION_ARGS);
+extern Datum gist_periodset_same(PG_FUNCTION_ARGS);
+
 extern bool index_leaf_consistent_time(Period *key, Period *query, StrategyNumber strategy);
 extern bool index_internal_consistent_period(Period *key, Period *query, StrategyNumber strategy);
 extern bool index_period_bbox_recheck(StrategyNumber strategy);
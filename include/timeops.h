@@ -323,6 +323,31 @@ extern PeriodSet *minus_periodset_timestampset_internal(PeriodSet *ps, Timestamp
 extern PeriodSet *minus_periodset_period_internal(PeriodSet *ps, Period *p);
 extern PeriodSet *minus_periodset_periodset_internal(PeriodSet *ps1, PeriodSet *ps2);
 
+/* Distance functions */
+
+extern Datum distance_timestamp_timestampset(PG_FUNCTION_ARGS);
+extern Datum distance_timestamp_period(PG_FUNCTION_ARGS);
+extern Datum distance_timestamp_periodset(PG_FUNCTION_ARGS);
+extern Datum distance_timestampset_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_timestampset_period(PG_FUNCTION_ARGS);
+extern Datum distance_period_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_period_timestampset(PG_FUNCTION_ARGS);
+extern Datum distance_period_period(PG_FUNCTION_ARGS);
+extern Datum distance_period_periodset(PG_FUNCTION_ARGS);
+extern Datum distance_periodset_timestamp(PG_FUNCTION_ARGS);
+extern Datum distance_periodset_period(PG_FUNCTION_ARGS);
+
+extern double distance_period_timestamp_internal(Period *p, TimestampTz t);
+extern double distance_period_period_internal(Period *p1, Period *p2);
+extern double distance_timestampset_timestamp_internal(TimestampSet *ts, TimestampTz t);
+extern double distance_timestampset_period_internal(TimestampSet *ts, Period *p);
+extern double distance_periodset_timestamp_internal(PeriodSet *ps, TimestampTz t);
+extern double distance_periodset_period_internal(PeriodSet *ps, Period *p);
+
+/* Join of arrays */
+
+extern Datum overlaps_pairs(PG_FUNCTION_ARGS);
+
 #endif
 
 /*****************************************************************************/
\ No newline at end of file
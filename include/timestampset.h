@@ -19,12 +19,25 @@
 
 /*****************************************************************************/
 
+/* Structure for constructing a TimestampSet from ordered timestamps */
+
+typedef struct
+{
+	TimestampSet *ts;		/* Timestamp set under construction */
+	TimestampTz *times;		/* Timestamps appended so far */
+	int			maxcount;	/* Maximum number of timestamps */
+	int			count;		/* Number of timestamps appended so far */
+} TimestampSetBuilder;
+
 /* assorted support functions */
 
 extern TimestampTz timestampset_time_n(TimestampSet *ts, int index);
 extern Period *timestampset_bbox(TimestampSet *ts);
 extern TimestampSet *timestampset_from_timestamparr_internal(TimestampTz *times, int count);
 extern TimestampSet *timestampset_copy(TimestampSet *ts);
+extern void timestampset_build_init(TimestampSetBuilder *builder, int maxcount);
+extern void timestampset_build_append(TimestampSetBuilder *builder, TimestampTz t);
+extern TimestampSet *timestampset_build_finish(TimestampSetBuilder *builder);
 extern bool timestampset_find_timestamp(TimestampSet *ts, TimestampTz t, int *pos);
 
 /* Input/output functions */
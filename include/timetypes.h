@@ -24,6 +24,10 @@
 #include <access/stratnum.h>
 #include <utils/timestamp.h>
 
+/* Number of elements of a timestamp or period set below which the search
+ * functions switch from a binary search to a scan */
+#define TIME_SEARCH_BLOCK 16
+
 typedef struct 
 {
 	TimestampTz	lower;			/* the lower bound value */
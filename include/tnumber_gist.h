@@ -20,14 +20,18 @@
 /*****************************************************************************/
 
 extern Datum gist_tbox_union(PG_FUNCTION_ARGS);
+extern void rt_tbox_union(TBOX *n, const TBOX *a, const TBOX *b);
 extern Datum gist_tbox_penalty(PG_FUNCTION_ARGS);
 extern Datum gist_tbox_picksplit(PG_FUNCTION_ARGS);
 extern Datum gist_tnumber_consistent(PG_FUNCTION_ARGS);
 extern Datum gist_tnumber_compress(PG_FUNCTION_ARGS);
+extern Datum gist_tnumber_distance(PG_FUNCTION_ARGS);
 extern Datum gist_tbox_same(PG_FUNCTION_ARGS);
+extern Datum gist_tbox_fetch(PG_FUNCTION_ARGS);
 
 /* The following functions are also called by IndexSpgistTnumber.c */
 extern bool index_leaf_consistent_tbox(TBOX *key, TBOX *query, StrategyNumber strategy);
+extern bool gist_internal_consistent_tbox(TBOX *key, TBOX *query, StrategyNumber strategy);
 
 /*****************************************************************************/
 
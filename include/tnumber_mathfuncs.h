@@ -37,6 +37,8 @@ extern Datum div_base_temporal(PG_FUNCTION_ARGS);
 extern Datum div_temporal_base(PG_FUNCTION_ARGS);
 extern Datum div_temporal_temporal(PG_FUNCTION_ARGS);
 
+extern Datum tfloat_weighted_sum(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
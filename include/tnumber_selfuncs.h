@@ -15,10 +15,15 @@
 
 #include <postgres.h>
 #include <catalog/pg_operator.h>
+#include <utils/selfuncs.h>
 #include "temporal.h"
+#include "oidcache.h"
 
 /*****************************************************************************/
 
+extern Selectivity tnumbers_sel(PlannerInfo *root, VariableStatData *vardata, 
+	TBOX *box, CachedOp cachedOp, Oid valuetypid);
+
 extern Datum tnumber_sel(PG_FUNCTION_ARGS);
 extern Datum tnumber_joinsel(PG_FUNCTION_ARGS);
 
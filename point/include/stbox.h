@@ -27,6 +27,9 @@ extern Datum geodstbox_constructor(PG_FUNCTION_ARGS);
 extern STBOX *stbox_new(bool hasx, bool hasz, bool hast, bool geodetic);
 extern STBOX *stbox_copy(const STBOX *box);
 extern int stbox_cmp_internal(const STBOX *box1, const STBOX *box2);
+extern Datum stbox_sortsupport(PG_FUNCTION_ARGS);
+extern Datum stbox_zorder_key(PG_FUNCTION_ARGS);
+extern Datum stbox_hilbert_key(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
@@ -116,6 +116,7 @@ extern Datum tpointi_values(TemporalI *ti);
 /* Restriction functions */
 
 extern Datum tpoint_at_value(PG_FUNCTION_ARGS);
+extern Datum tpoint_when_at_value(PG_FUNCTION_ARGS);
 extern Datum tpoint_minus_value(PG_FUNCTION_ARGS);
 extern Datum tpoint_at_values(PG_FUNCTION_ARGS);
 extern Datum tpoint_minus_values(PG_FUNCTION_ARGS);
@@ -23,8 +23,18 @@ extern Datum tpoint_extent_combinefn(PG_FUNCTION_ARGS);
 
 extern Datum tpoint_tcentroid_transfn(PG_FUNCTION_ARGS);
 extern Datum tpoint_tcentroid_combinefn(PG_FUNCTION_ARGS);
+extern Datum tpoint_tcentroid_serialize(PG_FUNCTION_ARGS);
+extern Datum tpoint_tcentroid_deserialize(PG_FUNCTION_ARGS);
 extern Datum tpoint_tcentroid_finalfn(PG_FUNCTION_ARGS);
 
+extern Datum tpoint_tseq_agg_transfn(PG_FUNCTION_ARGS);
+
+extern Datum tpoint_tdensity_transfn(PG_FUNCTION_ARGS);
+extern Datum tpoint_tdensity_combinefn(PG_FUNCTION_ARGS);
+extern Datum tpoint_tdensity_serialize(PG_FUNCTION_ARGS);
+extern Datum tpoint_tdensity_deserialize(PG_FUNCTION_ARGS);
+extern Datum tpoint_tdensity_finalfn(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
@@ -34,6 +34,7 @@ extern bool same_stbox_stbox_internal(const STBOX *box1, const STBOX *box2);
 
 /* Functions computing the bounding box at the creation of the temporal point */
 
+extern void stbox_expand(STBOX *box1, const STBOX *box2);
 extern void tpointinst_make_stbox(STBOX *box, Datum value, TimestampTz t);
 extern void tpointinstarr_to_stbox(STBOX *box, TemporalInst **inst, int count);
 extern void tpointseqarr_to_stbox(STBOX *box, TemporalSeq **seq, int count);
@@ -47,6 +48,13 @@ extern Datum tpoint_expand_spatial(PG_FUNCTION_ARGS);
 extern Datum stbox_expand_temporal(PG_FUNCTION_ARGS);
 extern Datum tpoint_expand_temporal(PG_FUNCTION_ARGS);
 
+/* Longitude/latitude boxes for geodetic values */
+
+extern Datum stbox_latlon(PG_FUNCTION_ARGS);
+extern Datum tpoint_latlon(PG_FUNCTION_ARGS);
+
+extern void stbox_latlon_internal(STBOX *result, const STBOX *box);
+
 /* Transform a <Type> to a STBOX */
 
 extern Datum geo_to_stbox(PG_FUNCTION_ARGS);
@@ -87,6 +95,8 @@ extern Datum same_bbox_tpoint_geo(PG_FUNCTION_ARGS);
 extern Datum same_bbox_tpoint_stbox(PG_FUNCTION_ARGS);
 extern Datum same_bbox_tpoint_tpoint(PG_FUNCTION_ARGS);
 
+extern Datum tpoint_stboxes(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
@@ -14,14 +14,56 @@
 #define __TPOINT_DISTANCE_H__
 
 #include <postgres.h>
+#include <liblwgeom.h>
 #include <catalog/pg_type.h>
 #include "temporal.h"
 
 /*****************************************************************************/
 
+/* Mean radius of the WGS 84 ellipsoid, used for the spherical approximation */
+#define SPHERE_MEAN_RADIUS		6371008.7714
+/* Upper bound of the relative error of the spherical approximation */
+#define SPHERE_REL_ERROR		0.006
+/* Maximum length of the segments located on a local plane, in meters */
+#define LOCAL_PLANE_MAX_LENGTH	100000.0
+/* Sine of the angle below which the two ends of a great circle segment 
+ * are considered equal or antipodal */
+#define GEOG_SEGMENT_MIN_SINE	1e-12
+/* Maximum number of iterations when intersecting great circle segments */
+#define GEOG_SEGMENT_MAX_ITER	8
+/* Maximum distance in meters between intersecting moving points */
+#define GEOG_SEGMENT_TOLERANCE	0.00001
+
+/* Great circle segment between two geographic points */
+typedef struct
+{
+	POINT3DZ	p1;			/* Start point in degrees */
+	POINT3DZ	p2;			/* End point in degrees */
+	bool		hasz;		/* True when the Z values are interpolated */
+	double		a[3];		/* Unit vector of the start point */
+	double		b[3];		/* Unit vector of the end point */
+	double		n[3];		/* Unit normal of the plane of the great circle */
+	double		omega;		/* Angle between the two ends */
+	double		sinomega;	/* Sine of the angle between the two ends */
+} GeogSegment;
+
+extern bool geodetic_fast_path;
+
 extern Datum geom_distance2d(Datum geom1, Datum geom2);
 extern Datum geom_distance3d(Datum geom1, Datum geom2);
 extern Datum geog_distance(Datum geog1, Datum geog2);
+extern double geog_point_distance_sphere(const POINT2D *p1, const POINT2D *p2);
+extern Datum geog_distance_sphere(Datum geog1, Datum geog2);
+extern void geog_points_local_plane(POINT2D *points, int count);
+extern bool geog_segment_init(GeogSegment *seg, Datum value1, Datum value2,
+	bool hasz);
+extern POINT3DZ geog_segment_point(const GeogSegment *seg, double fraction);
+extern double geog_segment_locate(const GeogSegment *seg, const POINT2D *p,
+	double *dist);
+extern bool geog_segments_intersect(const GeogSegment *seg1, 
+	const GeogSegment *seg2, double *fraction);
+extern bool geogpoint_interpolate(Datum value1, Datum value2, double fraction,
+	Datum *result);
 
 extern Datum distance_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum distance_tpoint_geo(PG_FUNCTION_ARGS);
@@ -30,7 +72,12 @@ extern Datum distance_tpoint_tpoint(PG_FUNCTION_ARGS);
 extern bool tpointseq_min_dist_at_timestamp(TemporalInst *start1, TemporalInst *end1, 
 	TemporalInst *start2, TemporalInst *end2, TimestampTz *t);
 
+extern bool tpoint_distance_kernel(Temporal *temp1, Temporal *temp2);
+extern bool tpoint_min_dist_kernel(Temporal *temp1, Temporal *temp2,
+	double maxdist, double stopdist, double *mindist, TimestampTz *mint);
 extern Temporal *distance_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2);
+extern bool NAD_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2,
+	double *mindist, TimestampTz *mint);
 
 /*****************************************************************************/
 
@@ -20,17 +20,29 @@
 
 /*****************************************************************************/
 
+extern double index_time_weight;
+extern int index_time_unit;
+extern bool index_use_z;
+
 extern Datum gist_tpoint_consistent(PG_FUNCTION_ARGS);
+extern Datum gist_tpoint_distance(PG_FUNCTION_ARGS);
 extern Datum gist_tpoint_union(PG_FUNCTION_ARGS);
+extern void adjust_stbox(STBOX *b, const STBOX *addon);
 extern Datum gist_tpoint_penalty(PG_FUNCTION_ARGS);
 extern Datum gist_tpoint_picksplit(PG_FUNCTION_ARGS);
 extern Datum gist_tpoint_same(PG_FUNCTION_ARGS);
 extern Datum gist_tpoint_compress(PG_FUNCTION_ARGS);
+extern Datum gist_stbox_fetch(PG_FUNCTION_ARGS);
+extern Datum gist_tgeogpoint_latlon_consistent(PG_FUNCTION_ARGS);
+extern Datum gist_tgeogpoint_latlon_compress(PG_FUNCTION_ARGS);
 
 /* The following functions are also called by IndexSpgistTPoint.c */
+extern bool tpoint_query_box(void *box, Datum query, Oid subtype);
 extern bool index_tpoint_recheck(StrategyNumber strategy);
 extern bool index_leaf_consistent_stbox(STBOX *key, STBOX *query,
 	StrategyNumber strategy);
+extern bool gist_internal_consistent_stbox(STBOX *key, STBOX *query,
+	StrategyNumber strategy);
 
 /*****************************************************************************/
 
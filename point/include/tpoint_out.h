@@ -28,6 +28,8 @@ extern Datum tpoint_as_mfjson(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_binary(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_ewkb(PG_FUNCTION_ARGS);
 extern Datum tpoint_as_hexewkb(PG_FUNCTION_ARGS);
+extern Datum tpoint_as_mvtgeom(PG_FUNCTION_ARGS);
+extern Datum tpointarr_as_columnar(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
 
@@ -16,6 +16,7 @@
 #include <postgres.h>
 #include <liblwgeom.h>
 #include <catalog/pg_type.h>
+#include <lib/stringinfo.h>
 #include "temporal.h"
 
 /*****************************************************************************/
@@ -26,6 +27,7 @@ extern void ensure_same_srid_tpoint(Temporal *temp1, Temporal *temp2);
 extern void ensure_same_srid_tpoint_gs(Temporal *temp, GSERIALIZED *gs);
 extern void ensure_same_dimensionality_tpoint(Temporal *temp1, Temporal *temp2);
 extern void ensure_same_dimensionality_tpoint_gs(Temporal *temp, GSERIALIZED *gs);
+extern void ensure_same_geodetic_tpoint_stbox(Temporal *temp, STBOX *box);
 extern void ensure_has_Z_tpoint(Temporal *temp);
 extern void ensure_point_type(GSERIALIZED *gs);
 extern void ensure_non_empty(GSERIALIZED *gs);
@@ -40,7 +42,13 @@ extern POINT3DZ gs_get_point3dz(GSERIALIZED *gs);
 extern POINT2D datum_get_point2d(Datum value);
 extern POINT3DZ datum_get_point3dz(Datum value);
 extern bool datum_point_eq(Datum geopoint1, Datum geopoint2);
+extern uint32 datum_point_hash(Datum geopoint);
+extern bool geo_get_gbox2d(Datum geo, GBOX *box);
+extern bool geopoint_segment_overlaps_gbox2d(Datum start, Datum end,
+	const GBOX *box);
 extern GSERIALIZED* geometry_serialize(LWGEOM* geom);
+extern void geompoint_write(Datum value, StringInfo buf);
+extern bool geompoint_read(StringInfo buf, Datum *result);
 
 /* Functions for spatial reference systems */
 
@@ -48,6 +56,7 @@ extern Datum tpoint_srid(PG_FUNCTION_ARGS);
 extern Datum tpoint_set_srid(PG_FUNCTION_ARGS);
 
 extern Temporal *tpoint_set_srid_internal(Temporal *temp, int32 srid) ;
+extern void tpoint_set_srid_inplace(Temporal *temp, int32 srid);
 extern int tpoint_srid_internal(Temporal *t);
 extern TemporalInst *tgeompointinst_transform(TemporalInst *inst, Datum srid);
 
@@ -94,6 +103,16 @@ extern Datum tpoint_minus_geometry(PG_FUNCTION_ARGS);
 
 extern TemporalSeq **tpointseq_at_geometry2(TemporalSeq *seq, Datum geo, int *count);
 
+extern Datum tpoint_at_stbox(PG_FUNCTION_ARGS);
+extern Datum tpoint_minus_stbox(PG_FUNCTION_ARGS);
+
+extern Temporal *tpoint_at_stbox_internal(Temporal *temp, STBOX *box);
+
+/* Tiling functions */
+
+extern Datum tpoint_tile(PG_FUNCTION_ARGS);
+extern Datum tpoint_stops(PG_FUNCTION_ARGS);
+
 /* Nearest approach functions */
 
 extern Datum NAI_geo_tpoint(PG_FUNCTION_ARGS);
@@ -113,6 +132,9 @@ extern Datum shortestline_tpoint_tpoint(PG_FUNCTION_ARGS);
 extern Datum tpoint_to_geo(PG_FUNCTION_ARGS);
 extern Datum geo_to_tpoint(PG_FUNCTION_ARGS);
 
+extern Datum tpoint_simplify(PG_FUNCTION_ARGS);
+extern Datum tpoint_simplify_pyramid(PG_FUNCTION_ARGS);
+
 /*****************************************************************************/
 
 #endif
@@ -39,6 +39,7 @@ extern Datum geog_covers(Datum geog1, Datum geog2);
 extern Datum geog_coveredby(Datum geog1, Datum geog2);
 extern Datum geog_intersects(Datum geog1, Datum geog2);
 extern Datum geog_dwithin(Datum geog1, Datum geog2, Datum dist);
+extern Datum geog_dwithin_sphere(Datum geog1, Datum geog2, Datum dist);
 
 extern Datum contains_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum contains_tpoint_geo(PG_FUNCTION_ARGS);
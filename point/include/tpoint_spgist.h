@@ -23,6 +23,10 @@ extern Datum spgist_tpoint_choose(PG_FUNCTION_ARGS);
 extern Datum spgist_tpoint_picksplit(PG_FUNCTION_ARGS);
 extern Datum spgist_tpoint_inner_consistent(PG_FUNCTION_ARGS);
 extern Datum spgist_tpoint_leaf_consistent(PG_FUNCTION_ARGS);
+extern Datum spgist_tpoint_kdtree_config(PG_FUNCTION_ARGS);
+extern Datum spgist_tpoint_kdtree_choose(PG_FUNCTION_ARGS);
+extern Datum spgist_tpoint_kdtree_picksplit(PG_FUNCTION_ARGS);
+extern Datum spgist_tpoint_kdtree_inner_consistent(PG_FUNCTION_ARGS);
 extern Datum spgist_tpoint_compress(PG_FUNCTION_ARGS);
 
 /*****************************************************************************/
@@ -53,6 +53,10 @@ extern Datum twithin_tpoint_tpoint(PG_FUNCTION_ARGS);
 extern Datum tdwithin_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum tdwithin_tpoint_geo(PG_FUNCTION_ARGS);
 extern Datum tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS);
+extern Datum tdwithin_pairs(PG_FUNCTION_ARGS);
+
+extern Temporal *tdwithin_tpoint_tpoint_internal(Temporal *temp1, 
+	Temporal *temp2, Datum dist);
 
 extern Datum trelate_geo_tpoint(PG_FUNCTION_ARGS);
 extern Datum trelate_tpoint_geo(PG_FUNCTION_ARGS);
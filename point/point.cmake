@@ -11,6 +11,7 @@ point/src/tpoint_parser.c
 point/src/tpoint_posops.c
 point/src/tpoint_gist.c
 point/src/tpoint_spgist.c
+point/src/tpoint_brin.c
 point/src/projection_gk.c
 point/src/tpoint_spatialfuncs.c
 point/src/tpoint_spatialrels.c
@@ -38,6 +39,7 @@ point/src/sql/66_tpoint_spatialrels.in.sql
 point/src/sql/68_tpoint_tempspatialrels.in.sql
 point/src/sql/70_tpoint_gist.in.sql
 point/src/sql/72_tpoint_spgist.in.sql
+point/src/sql/74_tpoint_brin.in.sql
 )
 
 target_sources(${CMAKE_PROJECT_NAME} PRIVATE ${SRCPOINT})
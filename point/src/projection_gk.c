@@ -118,17 +118,17 @@ point2d_get_datum(POINT2D point2D)
 {
 	LWPOINT *p = lwpoint_make2d(4326, point2D.x, point2D.y);
 	GSERIALIZED *result = geometry_serialize((LWGEOM *)p);
-
+	lwpoint_free(p);
 	return PointerGetDatum(result);
 }
 
-static Datum
-gk(Datum inst)
+/* Project the coordinates of a point */
+
+static POINT2D
+gk_point(POINT2D point2D)
 {
 	eqwgs = (awgs * awgs - bwgs * bwgs) / (awgs * awgs);
 	eqbes = (abes * abes - bbes * bbes) / (abes * abes);
-	POINT2D point2D = datum_get_point2d(inst);
-	POINT2D result;
 	double x = point2D.x;
 	double y = point2D.y;
 	double a = (x / 180) * Pi;
@@ -152,8 +152,7 @@ gk(Datum inst)
 	p = BLRauenberg(X, Y, Z);
 	double b2 = p.x;
 	double l2 = p.y;
-	result = BesselBLToGaussKrueger(b2, l2);
-	return point2d_get_datum(result);
+	return BesselBLToGaussKrueger(b2, l2);
 }
 
 /* Transform geometry to Gauss Kruger Projection */
@@ -170,9 +169,7 @@ geometry_transform_gk_internal(GSERIALIZED *gs)
 			lwpoint = lwpoint_construct_empty(0, false, false);
 		else
 		{
-			POINT2D point2D	= gs_get_point2d(gs);
-			Datum geom = gk(point2d_get_datum(point2D));
-			point2D	= datum_get_point2d(geom);
+			POINT2D point2D	= gk_point(gs_get_point2d(gs));
 			lwpoint = lwpoint_make2d(4326, point2D.x, point2D.y);
 		}
 		result = geometry_serialize((LWGEOM *)lwpoint);
@@ -188,26 +185,22 @@ geometry_transform_gk_internal(GSERIALIZED *gs)
 		}
 		else
 		{
-			LWPOINT *lwpoint = NULL;
+			/* The vertices are projected directly in the point array */
 			LWGEOM *lwgeom = lwgeom_from_gserialized(gs);
-			line = lwgeom_as_lwline(lwgeom);
-			uint32_t numPoints = line->points->npoints;
-			LWPOINT **points = palloc(sizeof(LWPOINT *) * numPoints);
+			POINTARRAY *pa = lwgeom_as_lwline(lwgeom)->points;
+			uint32_t numPoints = pa->npoints;
+			POINTARRAY *newpa = ptarray_construct(false, false, numPoints);
 			for (uint32_t i = 0; i < numPoints; i++)
 			{
-				lwpoint = lwline_get_lwpoint((LWLINE*)lwgeom, i);
-				Datum point2d_datum = PointerGetDatum(gserialized_from_lwgeom(lwpoint_as_lwgeom(lwpoint), 0));
-				Datum geom = gk(point2d_datum);
-				POINT2D point2D	= datum_get_point2d(geom);
-				points[i] = lwpoint_make2d(4326, point2D.x, point2D.y);
+				POINT2D point2D;
+				getPoint2d_p(pa, i, &point2D);
+				point2D = gk_point(point2D);
+				POINT4D point4D = {point2D.x, point2D.y, 0.0, 0.0};
+				ptarray_set_point4d(newpa, i, &point4D);
 			}
-
-			line = lwline_from_ptarray(4326, numPoints, points);
+			line = lwline_construct(4326, NULL, newpa);
 			result = geometry_serialize(lwline_as_lwgeom(line));
-			lwline_free(line);lwpoint_free(lwpoint);lwgeom_free(lwgeom);
-			for( uint32_t i = 0; i < numPoints; i++)
-				lwpoint_free(points[i]);
-			pfree(points);
+			lwline_free(line); lwgeom_free(lwgeom);
 		}
 	}
 	else
@@ -217,13 +210,31 @@ geometry_transform_gk_internal(GSERIALIZED *gs)
 	return result;
 }
 
+/*
+ * Transform an array of temporal instants to the Gauss Krueger projection.
+ * The coordinates are projected directly and a single point is serialized
+ * per instant.
+ */
+static void
+tgeompointinstarr_transform_gk(TemporalInst **result, TemporalInst **instants,
+	int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		POINT2D point2D = gk_point(datum_get_point2d(
+			temporalinst_value(instants[i])));
+		Datum geom = point2d_get_datum(point2D);
+		result[i] = temporalinst_make(geom, instants[i]->t,
+			type_oid(T_GEOMETRY));
+		pfree(DatumGetPointer(geom));
+	}
+}
+
 static TemporalInst *
 tgeompointinst_transform_gk(TemporalInst *inst)
 {
-	Datum geom = gk(temporalinst_value(inst));
-	TemporalInst *result = temporalinst_make(geom, inst->t,
-		type_oid(T_GEOMETRY));
-	pfree(DatumGetPointer(geom));
+	TemporalInst *result;
+	tgeompointinstarr_transform_gk(&result, &inst, 1);
 	return result;
 }
 
@@ -232,10 +243,8 @@ tgeompointi_transform_gk_internal(TemporalI *ti)
 {
 	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
 	for (int i = 0; i < ti->count; i++)
-	{
-		TemporalInst *inst = temporali_inst_n(ti, i);
-		instants[i] = tgeompointinst_transform_gk(inst);
-	}
+		instants[i] = temporali_inst_n(ti, i);
+	tgeompointinstarr_transform_gk(instants, instants, ti->count);
 	TemporalI *result = temporali_from_temporalinstarr(instants, ti->count);
 
 	for (int i = 0; i < ti->count; i++)
@@ -250,10 +259,8 @@ tgeompointseq_transform_gk_internal(TemporalSeq *seq)
 {
 	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
 	for (int i = 0; i < seq->count; i++)
-	{
-		TemporalInst *inst = temporalseq_inst_n(seq, i);
-		instants[i] = tgeompointinst_transform_gk(inst);
-	}
+		instants[i] = temporalseq_inst_n(seq, i);
+	tgeompointinstarr_transform_gk(instants, instants, seq->count);
 	TemporalSeq *result = temporalseq_from_temporalinstarr(instants,
 		seq->count, seq->period.lower_inc, seq->period.upper_inc, 
 		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
@@ -274,10 +281,8 @@ tgeompoints_transform_gk_internal(TemporalS *ts)
 		TemporalSeq *seq = temporals_seq_n(ts, i);
 		TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
 		for (int j = 0; j < seq->count; j++)
-		{
-			TemporalInst *inst = temporalseq_inst_n(seq, j);
-			instants[j] = tgeompointinst_transform_gk(inst);
-		}
+			instants[j] = temporalseq_inst_n(seq, j);
+		tgeompointinstarr_transform_gk(instants, instants, seq->count);
 		sequences[i] = temporalseq_from_temporalinstarr(instants,
 			seq->count, seq->period.lower_inc, seq->period.upper_inc, 
 			MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
@@ -185,6 +185,10 @@ CREATE FUNCTION stbox_cmp(stbox, stbox)
 	RETURNS int4
 	AS 'MODULE_PATHNAME', 'stbox_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION stbox_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'stbox_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR = (
 	LEFTARG = stbox, RIGHTARG = stbox,
@@ -232,6 +236,20 @@ CREATE OPERATOR CLASS stbox_ops
 	OPERATOR	3	= ,
 	OPERATOR	4	>= ,
 	OPERATOR	5	> ,
-	FUNCTION	1	stbox_cmp(stbox, stbox);
+	FUNCTION	1	stbox_cmp(stbox, stbox),
+	FUNCTION	2	stbox_sortsupport(internal);
+
+/*****************************************************************************
+ * Space-filling curves
+ *****************************************************************************/
+
+CREATE FUNCTION zorderKey(stbox, stbox)
+	RETURNS bigint
+	AS 'MODULE_PATHNAME', 'stbox_zorder_key'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION hilbertKey(stbox, stbox)
+	RETURNS bigint
+	AS 'MODULE_PATHNAME', 'stbox_hilbert_key'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 /*****************************************************************************/
@@ -219,6 +219,32 @@ CREATE FUNCTION appendInstant(tgeogpoint, tgeogpoint)
 	AS 'MODULE_PATHNAME', 'temporal_append_instant'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION appendInstants(tgeompoint, tgeompoint[])
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_append_instants'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(tgeogpoint, tgeogpoint[])
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_append_instants'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION merge(tgeompoint[])
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tgeompoint[], policy text)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tgeogpoint[])
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tgeogpoint[], policy text)
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /******************************************************************************
  * Functions
  ******************************************************************************/
@@ -250,6 +276,47 @@ CREATE FUNCTION memSize(tgeogpoint)
 	AS 'MODULE_PATHNAME', 'temporal_mem_size'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION formatVersion(tgeompoint)
+	RETURNS int
+	AS 'MODULE_PATHNAME', 'temporal_format_version'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION formatVersion(tgeogpoint)
+	RETURNS int
+	AS 'MODULE_PATHNAME', 'temporal_format_version'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION upgrade(tgeompoint)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_upgrade'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION upgrade(tgeogpoint)
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_upgrade'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tgeompoint)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tgeogpoint)
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION decompress(tgeompoint)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_decompress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION decompress(tgeogpoint)
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_decompress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION isCompressed(tgeompoint)
+	RETURNS boolean
+	AS 'MODULE_PATHNAME', 'temporal_is_compressed'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION isCompressed(tgeogpoint)
+	RETURNS boolean
+	AS 'MODULE_PATHNAME', 'temporal_is_compressed'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 -- value is a reserved word in SQL
 CREATE FUNCTION getValue(tgeompoint)
 	RETURNS geometry(Point)
@@ -369,6 +436,17 @@ CREATE FUNCTION instants(tgeogpoint)
 	AS 'MODULE_PATHNAME', 'temporal_instants'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION unnestInstants(tgeompoint, OUT t timestamptz, OUT value geometry,
+		OUT seqno integer)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporal_unnest'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(tgeogpoint, OUT t timestamptz, OUT value geography,
+		OUT seqno integer)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporal_unnest'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION numTimestamps(tgeompoint)
 	RETURNS integer
 	AS 'MODULE_PATHNAME', 'temporal_num_timestamps'
@@ -564,6 +642,15 @@ CREATE FUNCTION atValue(tgeogpoint, geography(Point))
 	AS 'MODULE_PATHNAME', 'tpoint_at_value'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION whenAtValue(tgeompoint, geometry(Point))
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tpoint_when_at_value'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenAtValue(tgeogpoint, geography(Point))
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tpoint_when_at_value'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION minusValue(tgeompoint, geometry(Point))
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'tpoint_minus_value'
@@ -618,6 +705,15 @@ CREATE FUNCTION valueAtTimestamp(tgeogpoint, timestamptz)
 	AS 'MODULE_PATHNAME', 'temporal_value_at_timestamp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION valuesAtTimestampSet(tgeompoint, timestampset)
+	RETURNS geometry(Point)[]
+	AS 'MODULE_PATHNAME', 'temporal_values_at_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION valuesAtTimestampSet(tgeogpoint, timestampset)
+	RETURNS geography(Point)[]
+	AS 'MODULE_PATHNAME', 'temporal_values_at_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION atTimestampSet(tgeompoint, timestampset)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'temporal_at_timestampset'
@@ -708,6 +804,51 @@ CREATE FUNCTION intersectsPeriodSet(tgeogpoint, periodset)
 	AS 'MODULE_PATHNAME', 'temporal_intersects_periodset'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tsample(tgeompoint, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_sample'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(tgeogpoint, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_sample'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tbucket(tgeompoint, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_bucket'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbucket(tgeogpoint, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_bucket'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tsync(tgeompoint[], mode text DEFAULT 'union',
+		OUT t timestamptz, OUT vals geometry[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tgeogpoint[], mode text DEFAULT 'union',
+		OUT t timestamptz, OUT vals geography[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tgeompoint[], interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT t timestamptz, OUT vals geometry[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync_grid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tgeogpoint[], interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT t timestamptz, OUT vals geography[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync_grid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /******************************************************************************
  * Comparison functions and B-tree indexing
  ******************************************************************************/
@@ -740,6 +881,10 @@ CREATE FUNCTION tgeompoint_cmp(tgeompoint, tgeompoint)
 	RETURNS int4
 	AS 'MODULE_PATHNAME', 'temporal_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'temporal_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR < (
 	LEFTARG = tgeompoint, RIGHTARG = tgeompoint,
@@ -791,7 +936,8 @@ CREATE OPERATOR CLASS tgeompoint_ops
 		OPERATOR	3	=,
 		OPERATOR	4	>=,
 		OPERATOR	5	>,
-		FUNCTION	1	tgeompoint_cmp(tgeompoint, tgeompoint);
+		FUNCTION	1	tgeompoint_cmp(tgeompoint, tgeompoint),
+		FUNCTION	2	tgeompoint_sortsupport(internal);
 
 /******************************************************************************/
 
@@ -823,6 +969,10 @@ CREATE FUNCTION tgeogpoint_cmp(tgeogpoint, tgeogpoint)
 	RETURNS int4
 	AS 'MODULE_PATHNAME', 'temporal_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'temporal_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR < (
 	LEFTARG = tgeogpoint, RIGHTARG = tgeogpoint,
@@ -868,7 +1018,8 @@ CREATE OPERATOR CLASS tgeogpoint_ops
 		OPERATOR	3	=,
 		OPERATOR	4	>=,
 		OPERATOR	5	>,
-		FUNCTION	1	tgeogpoint_cmp(tgeogpoint, tgeogpoint);
+		FUNCTION	1	tgeogpoint_cmp(tgeogpoint, tgeogpoint),
+		FUNCTION	2	tgeogpoint_sortsupport(internal);
 
 /******************************************************************************/
 
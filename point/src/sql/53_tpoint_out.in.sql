@@ -100,4 +100,19 @@ CREATE FUNCTION asHexEWKB(tgeogpoint, endianenconding text DEFAULT 'NDR')
 	AS 'MODULE_PATHNAME', 'tpoint_as_hexewkb'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION asMVTGeom(tpoint tgeompoint, bounds stbox,
+		extent int4 DEFAULT 4096, buffer int4 DEFAULT 256,
+		clip bool DEFAULT true, OUT geom geometry, OUT times float8[])
+	AS 'MODULE_PATHNAME', 'tpoint_as_mvtgeom'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION asColumnar(tgeompoint[])
+	RETURNS bytea
+	AS 'MODULE_PATHNAME', 'tpointarr_as_columnar'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION asColumnar(tgeogpoint[])
+	RETURNS bytea
+	AS 'MODULE_PATHNAME', 'tpointarr_as_columnar'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************/
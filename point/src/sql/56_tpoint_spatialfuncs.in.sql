@@ -124,11 +124,36 @@ CREATE FUNCTION azimuth(tgeogpoint)
 CREATE FUNCTION atGeometry(tgeompoint, geometry)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'tpoint_at_geometry'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE FUNCTION minusGeometry(tgeompoint, geometry)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'tpoint_minus_geometry'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+
+CREATE FUNCTION atStbox(tgeompoint, stbox)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'tpoint_at_stbox'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION minusStbox(tgeompoint, stbox)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'tpoint_minus_stbox'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tile(tgeompoint, xsize float8, ysize float8, interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT tile_id bigint, OUT time_bucket timestamptz, OUT piece tgeompoint)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'tpoint_tile'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION stops(tgeompoint, maxradius float8, minduration interval,
+		OUT period period, OUT centroid geometry)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'tpoint_stops'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 /*****************************************************************************/
@@ -136,54 +161,66 @@ CREATE FUNCTION minusGeometry(tgeompoint, geometry)
 CREATE FUNCTION NearestApproachInstant(geometry, tgeompoint)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'NAI_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION NearestApproachInstant(tgeompoint, geometry)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'NAI_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION NearestApproachInstant(tgeompoint, tgeompoint)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'NAI_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE FUNCTION NearestApproachInstant(geography, tgeogpoint)
 	RETURNS tgeogpoint
 	AS 'MODULE_PATHNAME', 'NAI_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION NearestApproachInstant(tgeogpoint, geography)
 	RETURNS tgeogpoint
 	AS 'MODULE_PATHNAME', 'NAI_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION NearestApproachInstant(tgeogpoint, tgeogpoint)
 	RETURNS tgeogpoint
 	AS 'MODULE_PATHNAME', 'NAI_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE FUNCTION nearestApproachDistance(geometry, tgeompoint)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'NAD_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION nearestApproachDistance(tgeompoint, geometry)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'NAD_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION nearestApproachDistance(tgeompoint, tgeompoint)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'NAD_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE FUNCTION nearestApproachDistance(geography, tgeogpoint)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'NAD_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION nearestApproachDistance(tgeogpoint, geography)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'NAD_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION nearestApproachDistance(tgeogpoint, tgeogpoint)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'NAD_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE OPERATOR |=| (
 	LEFTARG = geometry, RIGHTARG = tgeompoint,
@@ -220,28 +257,34 @@ CREATE OPERATOR |=| (
 CREATE FUNCTION shortestLine(geometry, tgeompoint)
 	RETURNS geometry
 	AS 'MODULE_PATHNAME', 'shortestline_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION shortestLine(tgeompoint, geometry)
 	RETURNS geometry
 	AS 'MODULE_PATHNAME', 'shortestline_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION shortestLine(tgeompoint, tgeompoint)
 	RETURNS geometry
 	AS 'MODULE_PATHNAME', 'shortestline_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE FUNCTION shortestLine(geography, tgeogpoint)
 	RETURNS geography
 	AS 'MODULE_PATHNAME', 'shortestline_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION shortestLine(tgeogpoint, geography)
 	RETURNS geography
 	AS 'MODULE_PATHNAME', 'shortestline_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION shortestLine(tgeogpoint, tgeogpoint)
 	RETURNS geography
 	AS 'MODULE_PATHNAME', 'shortestline_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 /*****************************************************************************/
 
@@ -274,3 +317,26 @@ CREATE FUNCTION tgeogpoint(geography)
 CREATE CAST (geography AS tgeogpoint) WITH FUNCTION tgeogpoint(geography);
 
 /*****************************************************************************/
+
+CREATE FUNCTION simplify(tgeompoint, float)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'tpoint_simplify'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION simplify(tgeompoint, float, float)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'tpoint_simplify'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+/* Level i of the pyramid is simplified with the tolerance tolerance * 2^(i-1) */
+CREATE FUNCTION simplifyPyramid(tgeompoint, tolerance float, levels integer)
+	RETURNS tgeompoint[]
+	AS 'MODULE_PATHNAME', 'tpoint_simplify_pyramid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+/* Coarsest level whose tolerance does not exceed the resolution of the map */
+CREATE FUNCTION pyramidLevel(tgeompoint[], tolerance float, resolution float)
+	RETURNS tgeompoint
+	AS 'SELECT $1[LEAST(array_length($1, 1),
+		GREATEST(1, floor(ln($3 / $2) / ln(2))::integer + 1))]'
+	LANGUAGE 'sql' IMMUTABLE STRICT PARALLEL SAFE;
+
+/*****************************************************************************/
@@ -63,6 +63,15 @@ CREATE FUNCTION stbox(tgeogpoint)
 	AS 'MODULE_PATHNAME', 'tpoint_stbox'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION stboxes(tgeompoint, integer DEFAULT 1)
+	RETURNS stbox[]
+	AS 'MODULE_PATHNAME', 'tpoint_stboxes'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION stboxes(tgeogpoint, integer DEFAULT 1)
+	RETURNS stbox[]
+	AS 'MODULE_PATHNAME', 'tpoint_stboxes'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE CAST (geometry AS stbox) WITH FUNCTION stbox(geometry) AS IMPLICIT;
 CREATE CAST (geography AS stbox) WITH FUNCTION stbox(geography) AS IMPLICIT;
 CREATE CAST (timestamptz AS stbox) WITH FUNCTION stbox(timestamptz) AS IMPLICIT;
@@ -160,6 +169,15 @@ CREATE FUNCTION expandTemporal(tgeogpoint, interval)
 	AS 'MODULE_PATHNAME', 'tpoint_expand_temporal'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION latLonBox(stbox)
+	RETURNS stbox
+	AS 'MODULE_PATHNAME', 'stbox_latlon'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION latLonBox(tgeogpoint)
+	RETURNS stbox
+	AS 'MODULE_PATHNAME', 'tpoint_latlon'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************
  * Contains
  *****************************************************************************/
@@ -19,15 +19,18 @@
 CREATE FUNCTION distance(geometry, tgeompoint)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'distance_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION distance(tgeompoint, geometry)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'distance_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION distance(tgeompoint, tgeompoint)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'distance_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE OPERATOR <-> (
 	PROCEDURE = distance,
@@ -54,15 +57,18 @@ CREATE OPERATOR <-> (
 CREATE FUNCTION distance(geography, tgeogpoint)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'distance_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION distance(tgeogpoint, geography)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'distance_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION distance(tgeogpoint, tgeogpoint)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'distance_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;		
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 CREATE OPERATOR <-> (
 	PROCEDURE = distance,
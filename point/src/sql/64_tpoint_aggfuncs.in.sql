@@ -42,10 +42,26 @@ CREATE FUNCTION tcount_transfn(internal, tgeompoint)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_mtransfn(internal, tgeompoint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invtransfn(internal, tgeompoint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tcount_transfn(internal, tgeogpoint)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_mtransfn(internal, tgeogpoint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invtransfn(internal, tgeogpoint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
 
 CREATE AGGREGATE tcount(tgeompoint) (
 	SFUNC = tcount_transfn,
@@ -54,6 +70,10 @@ CREATE AGGREGATE tcount(tgeompoint) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tcount_mtransfn,
+	MINVFUNC = tcount_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tagg_finalfn,
 	PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tgeogpoint) (
@@ -63,6 +83,10 @@ CREATE AGGREGATE tcount(tgeogpoint) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tcount_mtransfn,
+	MINVFUNC = tcount_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tagg_finalfn,
 	PARALLEL = SAFE
 );
 
@@ -102,6 +126,14 @@ CREATE FUNCTION tcentroid_combinefn(internal, internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'tpoint_tcentroid_combinefn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcentroid_serialize(internal)
+	RETURNS bytea
+	AS 'MODULE_PATHNAME', 'tpoint_tcentroid_serialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tcentroid_deserialize(bytea, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tcentroid_deserialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 CREATE FUNCTION tcentroid_finalfn(internal)
 	RETURNS tgeompoint
 	AS 'MODULE_PATHNAME', 'tpoint_tcentroid_finalfn'
@@ -112,8 +144,175 @@ CREATE AGGREGATE tcentroid(tgeompoint) (
 	STYPE = internal,
 	COMBINEFUNC = tcentroid_combinefn,
 	FINALFUNC = tcentroid_finalfn,
-	SERIALFUNC = tagg_serialize,
-	DESERIALFUNC = tagg_deserialize,
+	SERIALFUNC = tcentroid_serialize,
+	DESERIALFUNC = tcentroid_deserialize,
+	PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregate building a temporal sequence from (point, timestamp) rows
+ *****************************************************************************/
+
+CREATE FUNCTION tseq_agg_transfn(internal, geometry, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tseq_agg_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeompoint_tseq_agg_finalfn(internal)
+	RETURNS tgeompoint
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tseq_agg(geometry, timestamptz) (
+	SFUNC = tseq_agg_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tseq_agg_combinefn,
+	FINALFUNC = tgeompoint_tseq_agg_finalfn,
+	SERIALFUNC = tseq_agg_serialize,
+	DESERIALFUNC = tseq_agg_deserialize,
+	PARALLEL = SAFE
+);
+
+CREATE FUNCTION tseq_agg_transfn(internal, geography, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tseq_agg_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tgeogpoint_tseq_agg_finalfn(internal)
+	RETURNS tgeogpoint
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tseq_agg(geography, timestamptz) (
+	SFUNC = tseq_agg_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tseq_agg_combinefn,
+	FINALFUNC = tgeogpoint_tseq_agg_finalfn,
+	SERIALFUNC = tseq_agg_serialize,
+	DESERIALFUNC = tseq_agg_deserialize,
+	PARALLEL = SAFE
+);
+
+/* Merge of temporal fragments */
+
+CREATE AGGREGATE merge_agg(tgeompoint) (
+	SFUNC = array_append,
+	STYPE = tgeompoint[],
+	FINALFUNC = merge,
+	PARALLEL = SAFE
+);
+CREATE AGGREGATE merge_agg(tgeogpoint) (
+	SFUNC = array_append,
+	STYPE = tgeogpoint[],
+	FINALFUNC = merge,
+	PARALLEL = SAFE
+);
+
+/* Temporal count per time bucket */
+
+CREATE FUNCTION tcount_buckets_transfn(internal, tgeompoint, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tgeompoint, interval) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tgeompoint, interval, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tgeompoint, interval, timestamptz) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tgeogpoint, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tgeogpoint, interval) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tgeogpoint, interval, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tgeogpoint, interval, timestamptz) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+
+/* Spatiotemporal density */
+
+CREATE TYPE tdensity_cell AS (
+	cell geometry,
+	bucket timestamptz,
+	seconds float
+);
+
+CREATE FUNCTION tdensity_transfn(internal, tgeompoint, float, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tdensity_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tdensity_transfn(internal, tgeompoint, float, interval,
+		timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tdensity_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tdensity_combinefn(internal, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tdensity_combinefn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tdensity_finalfn(internal)
+	RETURNS tdensity_cell[]
+	AS 'MODULE_PATHNAME', 'tpoint_tdensity_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tdensity_serialize(internal)
+	RETURNS bytea
+	AS 'MODULE_PATHNAME', 'tpoint_tdensity_serialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tdensity_deserialize(bytea, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tpoint_tdensity_deserialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tdensity(tgeompoint, float, interval) (
+	SFUNC = tdensity_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tdensity_combinefn,
+	FINALFUNC = tdensity_finalfn,
+	SERIALFUNC = tdensity_serialize,
+	DESERIALFUNC = tdensity_deserialize,
+	PARALLEL = SAFE
+);
+CREATE AGGREGATE tdensity(tgeompoint, float, interval, timestamptz) (
+	SFUNC = tdensity_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tdensity_combinefn,
+	FINALFUNC = tdensity_finalfn,
+	SERIALFUNC = tdensity_serialize,
+	DESERIALFUNC = tdensity_deserialize,
 	PARALLEL = SAFE
 );
 
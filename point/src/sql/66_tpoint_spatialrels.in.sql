@@ -32,7 +32,8 @@
 CREATE FUNCTION _contains(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'contains_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION contains(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._contains($1,$2)'
@@ -41,16 +42,22 @@ CREATE FUNCTION contains(geometry, tgeompoint)
 CREATE FUNCTION _contains(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'contains_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION contains(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._contains($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION contains(tgeompoint, tgeompoint)
+CREATE FUNCTION _contains(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'contains_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION contains(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._contains($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * containsproperly
@@ -59,7 +66,8 @@ CREATE FUNCTION contains(tgeompoint, tgeompoint)
 CREATE FUNCTION _containsproperly(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'containsproperly_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION containsproperly(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._containsproperly($1,$2)'
@@ -68,16 +76,22 @@ CREATE FUNCTION containsproperly(geometry, tgeompoint)
 CREATE FUNCTION _containsproperly(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'containsproperly_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION containsproperly(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._containsproperly($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION containsproperly(tgeompoint, tgeompoint)
+CREATE FUNCTION _containsproperly(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'containsproperly_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION containsproperly(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._containsproperly($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 		
 /*****************************************************************************
  * covers
@@ -86,7 +100,8 @@ CREATE FUNCTION containsproperly(tgeompoint, tgeompoint)
 CREATE FUNCTION _covers(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'covers_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION covers(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._covers($1,$2)'
@@ -95,23 +110,30 @@ CREATE FUNCTION covers(geometry, tgeompoint)
 CREATE FUNCTION _covers(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'covers_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION covers(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._covers($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION covers(tgeompoint, tgeompoint)
+CREATE FUNCTION _covers(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'covers_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION covers(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._covers($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************/
 
 CREATE FUNCTION _covers(geography, tgeogpoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'covers_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION covers(geography, tgeogpoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._covers($1,$2)'
@@ -120,16 +142,22 @@ CREATE FUNCTION covers(geography, tgeogpoint)
 CREATE FUNCTION _covers(tgeogpoint, geography)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'covers_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION covers(tgeogpoint, geography)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.@>) $2 AND @extschema@._covers($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION covers(tgeogpoint, tgeogpoint)
+CREATE FUNCTION _covers(tgeogpoint, tgeogpoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'covers_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION covers(tgeogpoint, tgeogpoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._covers($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 			
 /*****************************************************************************
  * coveredby
@@ -138,7 +166,8 @@ CREATE FUNCTION covers(tgeogpoint, tgeogpoint)
 CREATE FUNCTION _coveredby(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'coveredby_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION coveredby(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.<@) $2 AND @extschema@._coveredby($1,$2)'
@@ -147,23 +176,30 @@ CREATE FUNCTION coveredby(geometry, tgeompoint)
 CREATE FUNCTION _coveredby(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'coveredby_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION coveredby(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.<@) $2 AND @extschema@._coveredby($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION coveredby(tgeompoint, tgeompoint)
+CREATE FUNCTION _coveredby(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'coveredby_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION coveredby(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._coveredby($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************/
 
 CREATE FUNCTION _coveredby(geography, tgeogpoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'coveredby_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION coveredby(geography, tgeogpoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.<@) $2 AND @extschema@._coveredby($1,$2)'
@@ -172,16 +208,22 @@ CREATE FUNCTION coveredby(geography, tgeogpoint)
 CREATE FUNCTION _coveredby(tgeogpoint, geography)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'coveredby_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION coveredby(tgeogpoint, geography)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.<@) $2 AND @extschema@._coveredby($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION coveredby(tgeogpoint, tgeogpoint)
+CREATE FUNCTION _coveredby(tgeogpoint, tgeogpoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'coveredby_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION coveredby(tgeogpoint, tgeogpoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._coveredby($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 		
 /*****************************************************************************
  * crosses
@@ -190,7 +232,8 @@ CREATE FUNCTION coveredby(tgeogpoint, tgeogpoint)
 CREATE FUNCTION _crosses(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'crosses_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION crosses(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._crosses($1,$2)'
@@ -199,16 +242,22 @@ CREATE FUNCTION crosses(geometry, tgeompoint)
 CREATE FUNCTION _crosses(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'crosses_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION crosses(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._crosses($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION crosses(tgeompoint, tgeompoint)
+CREATE FUNCTION _crosses(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'crosses_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION crosses(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._crosses($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * disjoint
@@ -217,15 +266,18 @@ CREATE FUNCTION crosses(tgeompoint, tgeompoint)
 CREATE FUNCTION disjoint(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'disjoint_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION disjoint(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'disjoint_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION disjoint(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'disjoint_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 /*****************************************************************************
  * equals
@@ -234,7 +286,8 @@ CREATE FUNCTION disjoint(tgeompoint, tgeompoint)
 CREATE FUNCTION _equals(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'equals_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION equals(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.~=) $2 AND @extschema@._equals($1,$2)'
@@ -243,16 +296,22 @@ CREATE FUNCTION equals(geometry, tgeompoint)
 CREATE FUNCTION _equals(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'equals_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION equals(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.~=) $2 AND @extschema@._equals($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION equals(tgeompoint, tgeompoint)
+CREATE FUNCTION _equals(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'equals_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION equals(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._equals($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * intersects
@@ -261,7 +320,8 @@ CREATE FUNCTION equals(tgeompoint, tgeompoint)
 CREATE FUNCTION _intersects(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'intersects_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION intersects(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._intersects($1,$2)'
@@ -270,23 +330,30 @@ CREATE FUNCTION intersects(geometry, tgeompoint)
 CREATE FUNCTION _intersects(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'intersects_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION intersects(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._intersects($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION intersects(tgeompoint, tgeompoint)
+CREATE FUNCTION _intersects(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'intersects_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION intersects(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._intersects($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************/
 
 CREATE FUNCTION _intersects(geography, tgeogpoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'intersects_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION intersects(geography, tgeogpoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._intersects($1,$2)'
@@ -295,16 +362,22 @@ CREATE FUNCTION intersects(geography, tgeogpoint)
 CREATE FUNCTION _intersects(tgeogpoint, geography)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'intersects_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION intersects(tgeogpoint, geography)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._intersects($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION intersects(tgeogpoint, tgeogpoint)
+CREATE FUNCTION _intersects(tgeogpoint, tgeogpoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'intersects_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION intersects(tgeogpoint, tgeogpoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._intersects($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * overlaps
@@ -313,7 +386,8 @@ CREATE FUNCTION intersects(tgeogpoint, tgeogpoint)
 CREATE FUNCTION _overlaps(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'overlaps_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION overlaps(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._overlaps($1,$2)'
@@ -322,16 +396,22 @@ CREATE FUNCTION overlaps(geometry, tgeompoint)
 CREATE FUNCTION _overlaps(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'overlaps_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION overlaps(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._overlaps($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION overlaps(tgeompoint, tgeompoint)
+CREATE FUNCTION _overlaps(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'overlaps_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION overlaps(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._overlaps($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * touches
@@ -340,7 +420,8 @@ CREATE FUNCTION overlaps(tgeompoint, tgeompoint)
 CREATE FUNCTION _touches(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'touches_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION touches(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._touches($1,$2)'
@@ -349,16 +430,22 @@ CREATE FUNCTION touches(geometry, tgeompoint)
 CREATE FUNCTION _touches(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'touches_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION touches(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._touches($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION touches(tgeompoint, tgeompoint)
+CREATE FUNCTION _touches(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'touches_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION touches(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._touches($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * within
@@ -367,7 +454,8 @@ CREATE FUNCTION touches(tgeompoint, tgeompoint)
 CREATE FUNCTION _within(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'within_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION within(geometry, tgeompoint)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.<@) $2 AND @extschema@._within($1,$2)'
@@ -376,16 +464,22 @@ CREATE FUNCTION within(geometry, tgeompoint)
 CREATE FUNCTION _within(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'within_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION within(tgeompoint, geometry)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.<@) $2 AND @extschema@._within($1,$2)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION within(tgeompoint, tgeompoint)
+CREATE FUNCTION _within(tgeompoint, tgeompoint)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'within_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION within(tgeompoint, tgeompoint)
+	RETURNS boolean
+	AS 'SELECT $1 OPERATOR(@extschema@.&&) $2 AND @extschema@._within($1,$2)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * dwithin
@@ -394,7 +488,8 @@ CREATE FUNCTION within(tgeompoint, tgeompoint)
 CREATE FUNCTION _dwithin(geometry, tgeompoint, dist float8)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'dwithin_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION dwithin(geometry, tgeompoint, dist float8)
 	RETURNS boolean
 	AS 'SELECT @extschema@.ST_Expand($1,$3) OPERATOR(@extschema@.&&) $2
@@ -404,24 +499,33 @@ CREATE FUNCTION dwithin(geometry, tgeompoint, dist float8)
 CREATE FUNCTION _dwithin(tgeompoint, geometry, dist float8)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'dwithin_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION dwithin(tgeompoint, geometry, dist float8)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) @extschema@.ST_Expand($2,$3) 
 	AND @extschema@._dwithin($1, $2, $3)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION dwithin(tgeompoint, tgeompoint, dist float8)
+CREATE FUNCTION _dwithin(tgeompoint, tgeompoint, dist float8)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'dwithin_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+CREATE FUNCTION dwithin(tgeompoint, tgeompoint, dist float8)
+	RETURNS boolean
+	AS 'SELECT @extschema@.expandSpatial($1,$3) OPERATOR(@extschema@.&&) $2
+	AND $1 OPERATOR(@extschema@.&&) @extschema@.expandSpatial($2,$3)
+	AND @extschema@._dwithin($1, $2, $3)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************/
 
 CREATE FUNCTION _dwithin(geography, tgeogpoint, dist float8)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'dwithin_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION dwithin(geography, tgeogpoint, dist float8)
 	RETURNS boolean
 	AS 'SELECT @extschema@._ST_Expand($1,$3) OPERATOR(@extschema@.&&) $2
@@ -431,17 +535,32 @@ CREATE FUNCTION dwithin(geography, tgeogpoint, dist float8)
 CREATE FUNCTION _dwithin(tgeogpoint, geography, dist float8)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'dwithin_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION dwithin(tgeogpoint, geography, dist float8)
 	RETURNS boolean
 	AS 'SELECT $1 OPERATOR(@extschema@.&&) @extschema@._ST_Expand($2,$3) 
 	AND @extschema@._dwithin($1, $2, $3)'
 	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
-CREATE FUNCTION dwithin(tgeogpoint, tgeogpoint, dist float8)
+CREATE FUNCTION _dwithin(tgeogpoint, tgeogpoint, dist float8)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'dwithin_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
+-- The boxes of geography points are geocentric boxes on the unit sphere.
+-- The distance in meters is converted into a bound of the chord between
+-- the points, using the mean radius of the WGS 84 ellipsoid and the relative
+-- error of the spherical approximation (SPHERE_MEAN_RADIUS and 
+-- SPHERE_REL_ERROR in tpoint_distance.h).
+CREATE FUNCTION dwithin(tgeogpoint, tgeogpoint, dist float8)
+	RETURNS boolean
+	AS 'SELECT @extschema@.expandSpatial($1,$3 * 1.006 / 6371008.7714) 
+	OPERATOR(@extschema@.&&) $2
+	AND $1 OPERATOR(@extschema@.&&) 
+	@extschema@.expandSpatial($2,$3 * 1.006 / 6371008.7714)
+	AND @extschema@._dwithin($1, $2, $3)'
+	LANGUAGE 'sql' IMMUTABLE PARALLEL SAFE;
 	
 /*****************************************************************************
  * relate (2 arguments)
@@ -450,15 +569,18 @@ CREATE FUNCTION dwithin(tgeogpoint, tgeogpoint, dist float8)
 CREATE FUNCTION relate(geometry, tgeompoint)
 	RETURNS text
 	AS 'MODULE_PATHNAME', 'relate_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION relate(tgeompoint, geometry)
 	RETURNS text
 	AS 'MODULE_PATHNAME', 'relate_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION relate(tgeompoint, tgeompoint)
 	RETURNS text
 	AS 'MODULE_PATHNAME', 'relate_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 /*****************************************************************************
  * relate (3 arguments)
@@ -467,14 +589,17 @@ CREATE FUNCTION relate(tgeompoint, tgeompoint)
 CREATE FUNCTION relate(geometry, tgeompoint, pattern text)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'relate_pattern_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION relate(tgeompoint, geometry, pattern text)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'relate_pattern_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 CREATE FUNCTION relate(tgeompoint, tgeompoint, pattern text)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'relate_pattern_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 500;
 
 /*****************************************************************************/
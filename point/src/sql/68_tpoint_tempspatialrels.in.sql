@@ -25,15 +25,18 @@
 CREATE FUNCTION tcontains(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcontains_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcontains(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcontains_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcontains(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcontains_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * tcovers
@@ -42,30 +45,36 @@ CREATE FUNCTION tcontains(tgeompoint, tgeompoint)
 CREATE FUNCTION tcovers(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcovers_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcovers(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcovers_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcovers(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcovers_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************/
 
 CREATE FUNCTION tcovers(geography, tgeogpoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcovers_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcovers(tgeogpoint, geography)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcovers_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcovers(tgeogpoint, tgeogpoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcovers_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * tcoveredby
@@ -74,30 +83,36 @@ CREATE FUNCTION tcovers(tgeogpoint, tgeogpoint)
 CREATE FUNCTION tcoveredby(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcoveredby_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcoveredby(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcoveredby_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcoveredby(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcoveredby_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************/
 
 CREATE FUNCTION tcoveredby(geography, tgeogpoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcoveredby_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcoveredby(tgeogpoint, geography)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcoveredby_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tcoveredby(tgeogpoint, tgeogpoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tcoveredby_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * tdisjoint
@@ -106,15 +121,18 @@ CREATE FUNCTION tcoveredby(tgeogpoint, tgeogpoint)
 CREATE FUNCTION tdisjoint(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdisjoint_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tdisjoint(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdisjoint_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tdisjoint(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdisjoint_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * tequals
@@ -123,15 +141,18 @@ CREATE FUNCTION tdisjoint(tgeompoint, tgeompoint)
 CREATE FUNCTION tequals(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tequals_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tequals(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tequals_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tequals(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tequals_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * tintersects
@@ -140,30 +161,36 @@ CREATE FUNCTION tequals(tgeompoint, tgeompoint)
 CREATE FUNCTION tintersects(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tintersects_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tintersects(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tintersects_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tintersects(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tintersects_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************/
 
 CREATE FUNCTION tintersects(geography, tgeogpoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tintersects_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tintersects(tgeogpoint, geography)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tintersects_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tintersects(tgeogpoint, tgeogpoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tintersects_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * ttouches
@@ -172,15 +199,18 @@ CREATE FUNCTION tintersects(tgeogpoint, tgeogpoint)
 CREATE FUNCTION ttouches(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'ttouches_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION ttouches(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'ttouches_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION ttouches(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'ttouches_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * twithin
@@ -189,15 +219,18 @@ CREATE FUNCTION ttouches(tgeompoint, tgeompoint)
 CREATE FUNCTION twithin(geometry, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'twithin_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION twithin(tgeompoint, geometry)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'twithin_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION twithin(tgeompoint, tgeompoint)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'twithin_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * tdwithin
@@ -206,30 +239,43 @@ CREATE FUNCTION twithin(tgeompoint, tgeompoint)
 CREATE FUNCTION tdwithin(geometry, tgeompoint, dist float8)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdwithin_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tdwithin(tgeompoint, geometry, dist float8)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdwithin_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tdwithin(tgeompoint, tgeompoint, dist float8)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdwithin_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
+
+CREATE FUNCTION tdwithinPairs(ids bigint[], tpoints tgeompoint[], dist float8,
+		OUT id1 bigint, OUT id2 bigint, OUT periods periodset)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'tdwithin_pairs'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************/
 
 CREATE FUNCTION tdwithin(geography, tgeogpoint, dist float8)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdwithin_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tdwithin(tgeogpoint, geography, dist float8)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdwithin_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;	
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION tdwithin(tgeogpoint, tgeogpoint, dist float8)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'tdwithin_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * trelate (2 arguments)
@@ -238,15 +284,18 @@ CREATE FUNCTION tdwithin(tgeogpoint, tgeogpoint, dist float8)
 CREATE FUNCTION trelate(geometry, tgeompoint)
 	RETURNS ttext
 	AS 'MODULE_PATHNAME', 'trelate_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION trelate(tgeompoint, geometry)
 	RETURNS ttext
 	AS 'MODULE_PATHNAME', 'trelate_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION trelate(tgeompoint, tgeompoint)
 	RETURNS ttext
 	AS 'MODULE_PATHNAME', 'trelate_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************
  * trelate (3 arguments)
@@ -255,14 +304,17 @@ CREATE FUNCTION trelate(tgeompoint, tgeompoint)
 CREATE FUNCTION trelate(geometry, tgeompoint, pattern text)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'trelate_pattern_geo_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION trelate(tgeompoint, geometry, pattern text)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'trelate_pattern_tpoint_geo'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 CREATE FUNCTION trelate(tgeompoint, tgeompoint, pattern text)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'trelate_pattern_tpoint_tpoint'
-	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
 
 /*****************************************************************************/
@@ -18,6 +18,18 @@ CREATE FUNCTION gist_tgeogpoint_consistent(internal, tgeogpoint, smallint, oid,
 	RETURNS bool
 	AS 'MODULE_PATHNAME', 'gist_tpoint_consistent'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_stbox_consistent(internal, stbox, smallint, oid, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME', 'gist_tpoint_consistent'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tgeompoint_distance(internal, tgeompoint, smallint, oid, internal)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'gist_tpoint_distance'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_stbox_fetch(internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 CREATE FUNCTION gist_tpoint_union(internal, internal)
 	RETURNS stbox
 	AS 'MODULE_PATHNAME', 'gist_tpoint_union'
@@ -124,7 +136,8 @@ CREATE OPERATOR CLASS gist_tgeompoint_ops
 	FUNCTION	3	gist_tpoint_compress(internal),
 	FUNCTION	5	gist_tpoint_penalty(internal, internal, internal),
 	FUNCTION	6	gist_tpoint_picksplit(internal, internal),
-	FUNCTION	7	gist_tpoint_same(stbox, stbox, internal);
+	FUNCTION	7	gist_tpoint_same(stbox, stbox, internal),
+	FUNCTION	8	gist_tgeompoint_distance(internal, tgeompoint, smallint, oid, internal);
 	
 CREATE OPERATOR CLASS gist_tgeogpoint_ops
 	DEFAULT FOR TYPE tgeogpoint USING gist AS
@@ -168,5 +181,115 @@ CREATE OPERATOR CLASS gist_tgeogpoint_ops
 	FUNCTION	5	gist_tpoint_penalty(internal, internal, internal),
 	FUNCTION	6	gist_tpoint_picksplit(internal, internal),
 	FUNCTION	7	gist_tpoint_same(stbox, stbox, internal);
+
+/*
+ * Alternative operator class for geodetic temporal points whose keys are
+ * longitude/latitude/time boxes instead of geocentric boxes, which are 
+ * much tighter for thin trajectories such as shipping lanes.
+ */
+CREATE FUNCTION gist_tgeogpoint_latlon_consistent(internal, tgeogpoint, smallint, oid, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME', 'gist_tgeogpoint_latlon_consistent'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tgeogpoint_latlon_compress(internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'gist_tgeogpoint_latlon_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS gist_tgeogpoint_latlon_ops
+	FOR TYPE tgeogpoint USING gist AS
+	STORAGE stbox,
+	-- overlaps
+	OPERATOR	3		&& (tgeogpoint, geography),  
+	OPERATOR	3		&& (tgeogpoint, stbox),  
+	OPERATOR	3		&& (tgeogpoint, tgeogpoint),  
+  	-- same
+	OPERATOR	6		~= (tgeogpoint, geography),  
+	OPERATOR	6		~= (tgeogpoint, stbox),  
+	OPERATOR	6		~= (tgeogpoint, tgeogpoint),  
+	-- contains
+	OPERATOR	7		@> (tgeogpoint, geography),  
+	OPERATOR	7		@> (tgeogpoint, stbox),  
+	OPERATOR	7		@> (tgeogpoint, tgeogpoint),  
+	-- contained by
+	OPERATOR	8		<@ (tgeogpoint, geography),  
+	OPERATOR	8		<@ (tgeogpoint, stbox),  
+	OPERATOR	8		<@ (tgeogpoint, tgeogpoint),  
+	-- overlaps or before
+	OPERATOR	28		&<# (tgeogpoint, stbox),
+	OPERATOR	28		&<# (tgeogpoint, tgeogpoint),
+	-- strictly before
+	OPERATOR	29		<<# (tgeogpoint, stbox),
+	OPERATOR	29		<<# (tgeogpoint, tgeogpoint),
+	-- strictly after
+	OPERATOR	30		#>> (tgeogpoint, stbox),
+	OPERATOR	30		#>> (tgeogpoint, tgeogpoint),
+	-- overlaps or after
+	OPERATOR	31		#&> (tgeogpoint, stbox),
+	OPERATOR	31		#&> (tgeogpoint, tgeogpoint),
+	-- functions
+	FUNCTION	1	gist_tgeogpoint_latlon_consistent(internal, tgeogpoint, smallint, oid, internal),
+	FUNCTION	2	gist_tpoint_union(internal, internal),
+	FUNCTION	3	gist_tgeogpoint_latlon_compress(internal),
+	FUNCTION	5	gist_tpoint_penalty(internal, internal, internal),
+	FUNCTION	6	gist_tpoint_picksplit(internal, internal),
+	FUNCTION	7	gist_tpoint_same(stbox, stbox, internal);
 	
 /******************************************************************************/
+
+/*
+ * The boxes obtained by splitting a temporal point with the function stboxes
+ * can be indexed, e.g., in a table (id, box) filled with unnest(stboxes(...)),
+ * which yields much tighter index keys than the single box of the value.
+ */
+CREATE OPERATOR CLASS gist_stbox_ops
+	DEFAULT FOR TYPE stbox USING gist AS
+	-- strictly left
+	OPERATOR	1		<< (stbox, stbox),
+	-- overlaps or left
+	OPERATOR	2		&< (stbox, stbox),
+	-- overlaps
+	OPERATOR	3		&& (stbox, stbox),
+	-- overlaps or right
+	OPERATOR	4		&> (stbox, stbox),
+	-- strictly right
+	OPERATOR	5		>> (stbox, stbox),
+	-- same
+	OPERATOR	6		~= (stbox, stbox),
+	-- contains
+	OPERATOR	7		@> (stbox, stbox),
+	-- contained by
+	OPERATOR	8		<@ (stbox, stbox),
+	-- overlaps or below
+	OPERATOR	9		&<| (stbox, stbox),
+	-- strictly below
+	OPERATOR	10		<<| (stbox, stbox),
+	-- strictly above
+	OPERATOR	11		|>> (stbox, stbox),
+	-- overlaps or above
+	OPERATOR	12		|&> (stbox, stbox),
+	-- overlaps or before
+	OPERATOR	28		&<# (stbox, stbox),
+	-- strictly before
+	OPERATOR	29		<<# (stbox, stbox),
+	-- strictly after
+	OPERATOR	30		#>> (stbox, stbox),
+	-- overlaps or after
+	OPERATOR	31		#&> (stbox, stbox),
+	-- overlaps or front
+	OPERATOR	32		&</ (stbox, stbox),
+	-- strictly front
+	OPERATOR	33		<</ (stbox, stbox),
+	-- strictly back
+	OPERATOR	34		/>> (stbox, stbox),
+	-- overlaps or back
+	OPERATOR	35		/&> (stbox, stbox),
+	-- functions
+	FUNCTION	1	gist_stbox_consistent(internal, stbox, smallint, oid, internal),
+	FUNCTION	2	gist_tpoint_union(internal, internal),
+	FUNCTION	5	gist_tpoint_penalty(internal, internal, internal),
+	FUNCTION	6	gist_tpoint_picksplit(internal, internal),
+	FUNCTION	7	gist_tpoint_same(stbox, stbox, internal),
+	FUNCTION	9	gist_stbox_fetch(internal);
+
+/******************************************************************************/
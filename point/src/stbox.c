@@ -647,6 +647,26 @@ stbox_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(cmp);
 }
 
+static int
+stbox_sortsupport_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	return stbox_cmp_internal(DatumGetSTboxP(x), DatumGetSTboxP(y));
+}
+
+/*
+ * No abbreviated keys are used since the component compared first depends
+ * on the dimensions of both boxes, which may vary from one box to another
+ */
+PG_FUNCTION_INFO_V1(stbox_sortsupport);
+
+PGDLLEXPORT Datum
+stbox_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+	sortsupport_abbrev_init(ssup, &stbox_sortsupport_cmp, NULL);
+	PG_RETURN_VOID();
+}
+
 PG_FUNCTION_INFO_V1(stbox_lt);
 
 PGDLLEXPORT Datum
@@ -727,5 +747,59 @@ stbox_ne(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(! stbox_eq_internal(box1, box2));
 }
 
-/*****************************************************************************/
+/*****************************************************************************
+ * Space-filling curves
+ *****************************************************************************/
 
+/*
+ * Key of the box in a space-filling curve covering the extent. The key is
+ * computed from the center of the box in the dimensions shared by the box
+ * and the extent, and ordering the boxes by their key clusters them by 
+ * spatiotemporal locality.
+ */
+static int64
+stbox_spacefill_key(const STBOX *box, const STBOX *extent, bool hilbert)
+{
+	double coords[4];
+	int n = 0;
+	if (MOBDB_FLAGS_GET_X(box->flags) && MOBDB_FLAGS_GET_X(extent->flags))
+	{
+		coords[n++] = spacefill_coord((box->xmin + box->xmax) / 2, 
+			extent->xmin, extent->xmax);
+		coords[n++] = spacefill_coord((box->ymin + box->ymax) / 2, 
+			extent->ymin, extent->ymax);
+		if (MOBDB_FLAGS_GET_Z(box->flags) && MOBDB_FLAGS_GET_Z(extent->flags))
+			coords[n++] = spacefill_coord((box->zmin + box->zmax) / 2, 
+				extent->zmin, extent->zmax);
+	}
+	if (MOBDB_FLAGS_GET_T(box->flags) && MOBDB_FLAGS_GET_T(extent->flags))
+		coords[n++] = spacefill_coord(((double) box->tmin + 
+			(double) box->tmax) / 2, (double) extent->tmin, 
+			(double) extent->tmax);
+	if (n == 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The box and the extent must have at least one common dimension")));
+	return spacefill_key(coords, n, hilbert);
+}
+
+PG_FUNCTION_INFO_V1(stbox_zorder_key);
+
+PGDLLEXPORT Datum
+stbox_zorder_key(PG_FUNCTION_ARGS)
+{
+	STBOX *box = PG_GETARG_STBOX_P(0);
+	STBOX *extent = PG_GETARG_STBOX_P(1);
+	PG_RETURN_INT64(stbox_spacefill_key(box, extent, false));
+}
+
+PG_FUNCTION_INFO_V1(stbox_hilbert_key);
+
+PGDLLEXPORT Datum
+stbox_hilbert_key(PG_FUNCTION_ARGS)
+{
+	STBOX *box = PG_GETARG_STBOX_P(0);
+	STBOX *extent = PG_GETARG_STBOX_P(1);
+	PG_RETURN_INT64(stbox_spacefill_key(box, extent, true));
+}
+
+/*****************************************************************************/
@@ -476,6 +476,13 @@ tpoint_ever_eq(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_BOOL(false);
 	}
+	/* A temporal point that stays at the point is equal to it */
+	if (same_stbox_stbox_internal(&box1, &box2))
+	{
+		PG_FREE_IF_COPY(temp, 0);
+		PG_FREE_IF_COPY(gs, 1);
+		PG_RETURN_BOOL(true);
+	}
 
 	bool result = false;
 	ensure_valid_duration(temp->duration);
@@ -848,6 +855,36 @@ tpoint_at_value(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/* Time during which the temporal point is equal to a point */
+
+PG_FUNCTION_INFO_V1(tpoint_when_at_value);
+
+PGDLLEXPORT Datum
+tpoint_when_at_value(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+	ensure_point_type(gs);
+	ensure_same_srid_tpoint_gs(temp, gs);
+	ensure_same_dimensionality_tpoint_gs(temp, gs);
+	/* Bounding box test */
+	STBOX box1, box2;
+	memset(&box1, 0, sizeof(STBOX));
+	memset(&box2, 0, sizeof(STBOX));
+	PeriodSet *result = NULL;
+	if (geo_to_stbox_internal(&box2, gs))
+	{
+		temporal_bbox(&box1, temp);
+		if (contains_stbox_stbox_internal(&box1, &box2))
+			result = temporal_when_at_value_internal(temp, PointerGetDatum(gs));
+	}
+	PG_FREE_IF_COPY(temp, 0);
+	PG_FREE_IF_COPY(gs, 1);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************/
 
 /* Restriction to the complement of a value */
@@ -15,6 +15,14 @@
 #include "tpoint_aggfuncs.h"
 
 #include <assert.h>
+#include <math.h>
+#include <funcapi.h>
+#include <libpq/pqformat.h>
+#include <utils/array.h>
+#include <utils/hsearch.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/typcache.h>
 
 #include "temporaltypes.h"
 #include "oidcache.h"
@@ -23,47 +31,12 @@
 #include "temporal_aggfuncs.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
+#include "tpoint_boxops.h"
 
 /*****************************************************************************
  * Generic functions
  *****************************************************************************/
 
-struct GeoAggregateState
-{
-	int32_t srid;
-	bool hasz;
-};
-
-static void
-geoaggstate_check(SkipList *state, int32_t srid, bool hasz)
-{
-	if(! state)
-		return;
-	struct GeoAggregateState *extra = state->extra;
-	if (extra && extra->srid != srid)
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-			errmsg("Geometries must have the same SRID for temporal aggregation")));
-	if (extra && extra->hasz != hasz)
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-			errmsg("Geometries must have the same dimensionality for temporal aggregation")));
-}
-
-static void 
-geoaggstate_check_as(SkipList *state1, SkipList *state2)
-{
-	struct GeoAggregateState *extra2 = state2->extra;
-	if (extra2)
-		geoaggstate_check(state1, extra2->srid, extra2->hasz);
-}
-
-static void
-geoaggstate_check_t(SkipList *state, Temporal *t)
-{
-	geoaggstate_check(state, tpoint_srid_internal(t), MOBDB_FLAGS_GET_Z(t->flags) != 0);
-}
-
-/*****************************************************************************/
-
 /*
  * Transform a temporal point type into a temporal double3/double4 type for 
  * performing centroid aggregation 
@@ -74,7 +47,8 @@ tpointinst_transform_tcentroid(TemporalInst *inst)
 	TemporalInst *result;
 	if (MOBDB_FLAGS_GET_Z(inst->flags))
 	{
-		POINT3DZ point = datum_get_point3dz(temporalinst_value(inst));
+		POINT3DZ point = gs_get_point3dz((GSERIALIZED *)
+			DatumGetPointer(temporalinst_value(inst)));
 		double4 dvalue;
 		double4_set(&dvalue, point.x, point.y, point.z, 1);
 		result = temporalinst_make(PointerGetDatum(&dvalue), inst->t,
@@ -82,7 +56,8 @@ tpointinst_transform_tcentroid(TemporalInst *inst)
 	}
 	else 
 	{
-		POINT2D point = datum_get_point2d(temporalinst_value(inst));
+		POINT2D point = gs_get_point2d((GSERIALIZED *)
+			DatumGetPointer(temporalinst_value(inst)));
 		double3 dvalue;
 		double3_set(&dvalue, point.x, point.y, 1);
 		result = temporalinst_make(PointerGetDatum(&dvalue), inst->t,
@@ -91,18 +66,6 @@ tpointinst_transform_tcentroid(TemporalInst *inst)
 	return result;
 }
 
-static TemporalInst **
-tpointi_transform_tcentroid(TemporalI *ti)
-{
-	TemporalInst **result = palloc(sizeof(TemporalInst *) * ti->count);
-	for (int i = 0; i < ti->count; i++)
-	{
-		TemporalInst *inst = temporali_inst_n(ti, i);
-		result[i] = tpointinst_transform_tcentroid(inst);
-	}
-	return result;
-}
-
 static TemporalSeq *
 tpointseq_transform_tcentroid(TemporalSeq *seq)
 {
@@ -135,24 +98,13 @@ tpoints_transform_tcentroid(TemporalS *ts)
 	return result;
 }
 
-/* Dispatch function  */
+/* Dispatch function for sequence and sequence set durations */
 
 static Temporal **
 tpoint_transform_tcentroid(Temporal *temp, int *count)
 {
 	Temporal **result = NULL;
-	if (temp->duration == TEMPORALINST) 
-	{
-		result = palloc(sizeof(Temporal *));
-		result[0] = (Temporal *)tpointinst_transform_tcentroid((TemporalInst *)temp);
-		*count = 1;
-	}
-	else if (temp->duration == TEMPORALI)
-	{
-		result = (Temporal **)tpointi_transform_tcentroid((TemporalI *) temp);
-		*count = ((TemporalI *)temp)->count;
-	} 
-	else if (temp->duration == TEMPORALSEQ)
+	if (temp->duration == TEMPORALSEQ)
 	{
 		result = palloc(sizeof(Temporal *));
 		result[0] = (Temporal *)tpointseq_transform_tcentroid((TemporalSeq *) temp);
@@ -171,63 +123,65 @@ tpoint_transform_tcentroid(Temporal *temp, int *count)
  * Extent
  *****************************************************************************/
 
+/* 
+ * As for the other extent aggregates, the bounding box of the temporal 
+ * points is read from the slices of the values containing it and the state
+ * is expanded in place when called in aggregate context
+ */
+
+static void
+tpoint_extent_check(const STBOX *box1, const STBOX *box2)
+{
+	if (MOBDB_FLAGS_GET_Z(box1->flags) != MOBDB_FLAGS_GET_Z(box2->flags))
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("One argument has Z dimension but the other does not")));
+	if (MOBDB_FLAGS_GET_GEODETIC(box1->flags) != MOBDB_FLAGS_GET_GEODETIC(box2->flags))
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("One argument has geodetic coordinates but the other does not")));
+}
+
+static STBOX *
+tpoint_extent_state(FunctionCallInfo fcinfo, STBOX *box)
+{
+	if (AggCheckCallContext(fcinfo, NULL))
+		return box;
+	STBOX *result = palloc(sizeof(STBOX));
+	memcpy(result, box, sizeof(STBOX));
+	return result;
+}
+
 PG_FUNCTION_INFO_V1(tpoint_extent_transfn);
 
 PGDLLEXPORT Datum 
 tpoint_extent_transfn(PG_FUNCTION_ARGS)
 {
 	STBOX *box = PG_ARGISNULL(0) ? NULL : PG_GETARG_STBOX_P(0);
-	Temporal *temp = PG_ARGISNULL(1) ? NULL : PG_GETARG_TEMPORAL(1);
-	STBOX box1, *result = NULL;
+	STBOX box1, *result;
 	memset(&box1, 0, sizeof(STBOX));
 
 	/* Can't do anything with null inputs */
-	if (!box && !temp)
+	if (!box && PG_ARGISNULL(1))
 		PG_RETURN_NULL();
+	/* Non-null box and null temporal, return the box */
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(box);
+
+	temporal_bbox_slice(PG_GETARG_DATUM(1), &box1);
 	/* Null box and non-null temporal, return the bbox of the temporal */
 	if (!box)
 	{
-		result = palloc0(sizeof(STBOX));
-		temporal_bbox(result, temp);
-		PG_RETURN_POINTER(result);
-	}
-	/* Non-null box and null temporal, return the box */
-	if (!temp)
-	{
-		result = palloc0(sizeof(STBOX));
-		memcpy(result, box, sizeof(STBOX));
+		result = palloc(sizeof(STBOX));
+		memcpy(result, &box1, sizeof(STBOX));
 		PG_RETURN_POINTER(result);
 	}
 
-	temporal_bbox(&box1, temp);
 	if (!MOBDB_FLAGS_GET_X(box->flags) || !MOBDB_FLAGS_GET_T(box->flags))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				errmsg("Argument STBOX must have both X and T dimensions")));
-	if (MOBDB_FLAGS_GET_Z(box->flags) != MOBDB_FLAGS_GET_Z(box1.flags))
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-				errmsg("One argument has Z dimension but the other does not")));
-	if (MOBDB_FLAGS_GET_GEODETIC(box->flags) != MOBDB_FLAGS_GET_GEODETIC(box1.flags))
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-				errmsg("One argument has geodetic coordinates but the other does not")));
+	tpoint_extent_check(box, &box1);
 
-	result = palloc0(sizeof(STBOX));
-	result->xmax = Max(box->xmax, box1.xmax);
-	result->ymax = Max(box->ymax, box1.ymax);
-	result->tmax = Max(box->tmax, box1.tmax);
-	result->xmin = Min(box->xmin, box1.xmin);
-	result->ymin = Min(box->ymin, box1.ymin);
-	result->tmin = Min(box->tmin, box1.tmin);
-	if (MOBDB_FLAGS_GET_Z(box->flags) || MOBDB_FLAGS_GET_GEODETIC(box->flags))
-	{
-		result->zmax = Max(box->zmax, box1.zmax);
-		result->zmin = Min(box->zmin, box1.zmin);
-	}
-	MOBDB_FLAGS_SET_X(result->flags, true);
-	MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(box->flags));
-	MOBDB_FLAGS_SET_T(result->flags, true);
-	MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(box->flags));
-
-	PG_FREE_IF_COPY(temp, 1);
+	result = tpoint_extent_state(fcinfo, box);
+	stbox_expand(result, &box1);
 	PG_RETURN_POINTER(result);
 }
 
@@ -251,30 +205,10 @@ tpoint_extent_combinefn(PG_FUNCTION_ARGS)
 		!MOBDB_FLAGS_GET_X(box2->flags) || !MOBDB_FLAGS_GET_T(box2->flags))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				errmsg("Arguments must have both X and T dimensions")));
-	if (MOBDB_FLAGS_GET_Z(box1->flags) != MOBDB_FLAGS_GET_Z(box2->flags))
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-				errmsg("One argument has Z dimension but the other does not")));
-	if (MOBDB_FLAGS_GET_GEODETIC(box1->flags) != MOBDB_FLAGS_GET_GEODETIC(box2->flags))
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-				errmsg("One argument has geodetic coordinates but the other does not")));
-
-	result = palloc0(sizeof(STBOX));
-	result->xmax = Max(box1->xmax, box2->xmax);
-	result->ymax = Max(box1->ymax, box2->ymax);
-	result->tmax = Max(box1->tmax, box2->tmax);
-	result->xmin = Min(box1->xmin, box2->xmin);
-	result->ymin = Min(box1->ymin, box2->ymin);
-	result->tmin = Min(box1->tmin, box2->tmin);
-	if (MOBDB_FLAGS_GET_Z(box1->flags) || MOBDB_FLAGS_GET_GEODETIC(box1->flags))
-	{
-		result->zmax = Max(box1->zmax, box2->zmax);
-		result->zmin = Min(box1->zmin, box2->zmin);
-	}
-	MOBDB_FLAGS_SET_X(result->flags, true);
-	MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(box1->flags));
-	MOBDB_FLAGS_SET_T(result->flags, true);
-	MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(box1->flags));
+	tpoint_extent_check(box1, box2);
 
+	result = tpoint_extent_state(fcinfo, box1);
+	stbox_expand(result, box2);
 	PG_RETURN_POINTER(result);
 }
 
@@ -282,13 +216,158 @@ tpoint_extent_combinefn(PG_FUNCTION_ARGS)
  * Centroid
  *****************************************************************************/
 
+/*
+ * State of the temporal centroid aggregation. For temporal points of
+ * instant or instant set duration, the sums of the coordinates and the
+ * number of points of each instant are kept in a flat array, whose entries
+ * are only sorted and merged by timestamp when the array is full and in
+ * the final function. For sequence and sequence set durations, whose sums
+ * must be computed on the synchronized values, they are kept in a skiplist
+ * of temporal double3/double4 values.
+ */
+typedef struct
+{
+	TimestampTz t;
+	double x;
+	double y;
+	double z;
+	double count;
+} TCentroidInst;
+
+typedef struct
+{
+	int32_t srid;
+	bool hasz;
+	int count;					/* Number of entries of the array */
+	int capacity;
+	TCentroidInst *instants;
+	SkipList *seqstate;			/* State for sequence durations */
+} TCentroidState;
+
+#define TCENTROID_INITIAL_CAPACITY 1024
+
+static TCentroidState *
+tcentroid_state_make(FunctionCallInfo fcinfo, int32_t srid, bool hasz)
+{
+	MemoryContext ctx;
+	if (! AggCheckCallContext(fcinfo, &ctx))
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Operation not supported")));
+	TCentroidState *result = MemoryContextAllocZero(ctx, sizeof(TCentroidState));
+	result->srid = srid;
+	result->hasz = hasz;
+	return result;
+}
+
+static void
+tcentroid_state_check(TCentroidState *state, int32_t srid, bool hasz)
+{
+	if (state->srid != srid)
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Geometries must have the same SRID for temporal aggregation")));
+	if (state->hasz != hasz)
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Geometries must have the same dimensionality for temporal aggregation")));
+}
+
+static void
+tcentroid_state_check_duration(TCentroidState *state, bool instants)
+{
+	if ((instants && state->seqstate) || (! instants && state->count > 0))
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Cannot aggregate temporal values of different duration")));
+}
+
+static int
+tcentroidinst_cmp(const void *a, const void *b)
+{
+	TimestampTz t1 = ((const TCentroidInst *) a)->t;
+	TimestampTz t2 = ((const TCentroidInst *) b)->t;
+	return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
+}
+
+/* Sort the entries of the array and merge those with the same timestamp */
+
+static void
+tcentroid_state_compact(TCentroidState *state)
+{
+	if (state->count <= 1)
+		return;
+	qsort(state->instants, state->count, sizeof(TCentroidInst),
+		&tcentroidinst_cmp);
+	int k = 0;
+	for (int i = 1; i < state->count; i++)
+	{
+		TCentroidInst *inst = &state->instants[i];
+		TCentroidInst *last = &state->instants[k];
+		if (inst->t == last->t)
+		{
+			last->x += inst->x;
+			last->y += inst->y;
+			last->z += inst->z;
+			last->count += inst->count;
+		}
+		else
+			state->instants[++k] = *inst;
+	}
+	state->count = k + 1;
+}
+
+/* Make room in the array for count more entries */
+
+static void
+tcentroid_state_reserve(TCentroidState *state, int count)
+{
+	if (state->count + count <= state->capacity)
+		return;
+	/* Merging the instants with equal timestamps may free enough room */
+	tcentroid_state_compact(state);
+	if (state->count + count <= state->capacity &&
+		state->count <= state->capacity / 2)
+		return;
+	int capacity = Max(state->capacity, TCENTROID_INITIAL_CAPACITY);
+	while (capacity < (state->count + count) * 2)
+		capacity *= 2;
+	/* The array is allocated in the memory context of the state */
+	if (state->instants == NULL)
+		state->instants = MemoryContextAlloc(GetMemoryChunkContext(state),
+			sizeof(TCentroidInst) * capacity);
+	else
+		state->instants = repalloc(state->instants,
+			sizeof(TCentroidInst) * capacity);
+	state->capacity = capacity;
+}
+
+static void
+tcentroid_state_add(TCentroidState *state, TemporalInst *inst)
+{
+	TCentroidInst *entry = &state->instants[state->count++];
+	GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(temporalinst_value(inst));
+	entry->t = inst->t;
+	if (state->hasz)
+	{
+		POINT3DZ point = gs_get_point3dz(gs);
+		entry->x = point.x;
+		entry->y = point.y;
+		entry->z = point.z;
+	}
+	else
+	{
+		POINT2D point = gs_get_point2d(gs);
+		entry->x = point.x;
+		entry->y = point.y;
+		entry->z = 0;
+	}
+	entry->count = 1;
+}
+
 PG_FUNCTION_INFO_V1(tpoint_tcentroid_transfn);
 
 PGDLLEXPORT Datum
 tpoint_tcentroid_transfn(PG_FUNCTION_ARGS)
 {
-	SkipList *state = PG_ARGISNULL(0) ? NULL : 
-		(SkipList *) PG_GETARG_POINTER(0);
+	TCentroidState *state = PG_ARGISNULL(0) ? NULL : 
+		(TCentroidState *) PG_GETARG_POINTER(0);
 	if (PG_ARGISNULL(1))
 	{
 		if (state)
@@ -298,34 +377,47 @@ tpoint_tcentroid_transfn(PG_FUNCTION_ARGS)
 	}
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 
-	geoaggstate_check_t(state, temp);
-	Datum (*func)(Datum, Datum) = MOBDB_FLAGS_GET_Z(temp->flags) ?
-		&datum_sum_double4 : &datum_sum_double3;
+	int32_t srid = tpoint_srid_internal(temp);
+	bool hasz = MOBDB_FLAGS_GET_Z(temp->flags) != 0;
+	if (state)
+		tcentroid_state_check(state, srid, hasz);
+	else
+		state = tcentroid_state_make(fcinfo, srid, hasz);
 
+	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI)
+	{
+		tcentroid_state_check_duration(state, true);
+		if (temp->duration == TEMPORALINST)
+		{
+			tcentroid_state_reserve(state, 1);
+			tcentroid_state_add(state, (TemporalInst *) temp);
+		}
+		else
+		{
+			TemporalI *ti = (TemporalI *) temp;
+			tcentroid_state_reserve(state, ti->count);
+			for (int i = 0; i < ti->count; i++)
+				tcentroid_state_add(state, temporali_inst_n(ti, i));
+		}
+		PG_FREE_IF_COPY(temp, 1);
+		PG_RETURN_POINTER(state);
+	}
+
+	tcentroid_state_check_duration(state, false);
+	Datum (*func)(Datum, Datum) = hasz ?
+		&datum_sum_double4 : &datum_sum_double3;
 	int count;
 	Temporal **temporals = tpoint_transform_tcentroid(temp, &count);
-	if (state)
+	if (state->seqstate)
 	{
-		if (skiplist_headval(state)->duration != temporals[0]->duration)
-			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-				errmsg("Cannot aggregate temporal values of different duration")));
-		if (MOBDB_FLAGS_GET_LINEAR(skiplist_headval(state)->flags) != 
+		if (MOBDB_FLAGS_GET_LINEAR(skiplist_headval(state->seqstate)->flags) != 
 				MOBDB_FLAGS_GET_LINEAR(temporals[0]->flags))
 			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
 				errmsg("Cannot aggregate temporal values of different interpolation")));
-
-		skiplist_splice(fcinfo, state, temporals, count, func, false);
+		skiplist_splice(fcinfo, state->seqstate, temporals, count, func, false);
 	}
 	else
-	{
-		state = skiplist_make(fcinfo, temporals, count);
-		struct GeoAggregateState extra =
-		{
-			.srid = tpoint_srid_internal(temp),
-			.hasz = MOBDB_FLAGS_GET_Z(temp->flags) != 0
-		};
-		aggstate_set_extra(fcinfo, state, &extra, sizeof(struct GeoAggregateState));
-	}
+		state->seqstate = skiplist_make(fcinfo, temporals, count);
 
 	for (int i = 0; i< count; i++)
 		pfree(temporals[i]);
@@ -342,72 +434,142 @@ PG_FUNCTION_INFO_V1(tpoint_tcentroid_combinefn);
 PGDLLEXPORT Datum
 tpoint_tcentroid_combinefn(PG_FUNCTION_ARGS)
 {
-	SkipList *state1 = PG_ARGISNULL(0) ? NULL : 
-		(SkipList *) PG_GETARG_POINTER(0);
-	SkipList *state2 = PG_ARGISNULL(1) ? NULL :
-		(SkipList *) PG_GETARG_POINTER(1);
-
-	geoaggstate_check_as(state1, state2);
-	struct GeoAggregateState *extra = NULL;
-	if (state1 && state1->extra) 
-		extra = state1->extra;
-	if (state2 && state2->extra) 
-		extra = state2->extra;
-	assert(extra != NULL);
-	Datum (*func)(Datum, Datum) = extra->hasz ?
-		&datum_sum_double4 : &datum_sum_double3;
-	SkipList *result = temporal_tagg_combinefn(fcinfo, state1, state2, 
-		func, false);
+	TCentroidState *state1 = PG_ARGISNULL(0) ? NULL : 
+		(TCentroidState *) PG_GETARG_POINTER(0);
+	TCentroidState *state2 = PG_ARGISNULL(1) ? NULL :
+		(TCentroidState *) PG_GETARG_POINTER(1);
+	if (! state2)
+	{
+		if (! state1)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state1);
+	}
+	if (! state1)
+		PG_RETURN_POINTER(state2);
 
-	PG_RETURN_POINTER(result);
+	tcentroid_state_check(state1, state2->srid, state2->hasz);
+	if (state2->count > 0)
+	{
+		tcentroid_state_check_duration(state1, true);
+		tcentroid_state_reserve(state1, state2->count);
+		memcpy(&state1->instants[state1->count], state2->instants,
+			sizeof(TCentroidInst) * state2->count);
+		state1->count += state2->count;
+	}
+	if (state2->seqstate)
+	{
+		tcentroid_state_check_duration(state1, false);
+		Datum (*func)(Datum, Datum) = state1->hasz ?
+			&datum_sum_double4 : &datum_sum_double3;
+		state1->seqstate = temporal_tagg_combinefn(fcinfo, state1->seqstate,
+			state2->seqstate, func, false);
+	}
+	PG_RETURN_POINTER(state1);
 }
 
 /*****************************************************************************/
+/* Centroid serialization functions for parallel aggregation */
 
-/* Centroid final function */
+PG_FUNCTION_INFO_V1(tpoint_tcentroid_serialize);
 
-TemporalI *
-tpointinst_tcentroid_finalfn(TemporalInst **instants, int count)
+PGDLLEXPORT Datum
+tpoint_tcentroid_serialize(PG_FUNCTION_ARGS)
 {
-	TemporalInst **newinstants = palloc(sizeof(TemporalInst *) * count);
-	for (int i = 0; i < count; i++)
+	TCentroidState *state = (TCentroidState *) PG_GETARG_POINTER(0);
+	tcentroid_state_compact(state);
+	StringInfoData buf;
+	pq_begintypsend(&buf);
+	pq_sendint32(&buf, (uint32) state->srid);
+	pq_sendbyte(&buf, state->hasz ? 1 : 0);
+	pq_sendint32(&buf, (uint32) state->count);
+	for (int i = 0; i < state->count; i++)
 	{
-		TemporalInst *inst = instants[i];
-		Datum value = 0;
-		assert(inst->valuetypid == type_oid(T_DOUBLE4) || 
-			inst->valuetypid == type_oid(T_DOUBLE3));
-		if (inst->valuetypid == type_oid(T_DOUBLE4))
-		{
-			double4 *value4 = (double4 *)DatumGetPointer(temporalinst_value(inst));
-			assert(value4->d != 0);
-			double valuea = value4->a / value4->d;
-			double valueb = value4->b / value4->d;
-			double valuec = value4->c / value4->d;
-			value = call_function3(LWGEOM_makepoint, Float8GetDatum(valuea),
-				Float8GetDatum(valueb), Float8GetDatum(valuec));
-		}
-		else if (inst->valuetypid == type_oid(T_DOUBLE3))
+		TCentroidInst *inst = &state->instants[i];
+		pq_sendint64(&buf, inst->t);
+		pq_sendfloat8(&buf, inst->x);
+		pq_sendfloat8(&buf, inst->y);
+		pq_sendfloat8(&buf, inst->z);
+		pq_sendfloat8(&buf, inst->count);
+	}
+	pq_sendbyte(&buf, state->seqstate ? 1 : 0);
+	if (state->seqstate)
+	{
+		skiplist_unspill(fcinfo, state->seqstate);
+		aggstate_write(state->seqstate, &buf);
+	}
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tcentroid_deserialize);
+
+PGDLLEXPORT Datum
+tpoint_tcentroid_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_P(0);
+	StringInfoData buf =
+	{
+		.cursor = 0,
+		.data = VARDATA(data),
+		.len = VARSIZE(data) - VARHDRSZ,
+		.maxlen = VARSIZE(data) - VARHDRSZ
+	};
+	int32_t srid = (int32_t) pq_getmsgint(&buf, 4);
+	bool hasz = pq_getmsgbyte(&buf) != 0;
+	TCentroidState *result = tcentroid_state_make(fcinfo, srid, hasz);
+	int count = pq_getmsgint(&buf, 4);
+	if (count > 0)
+	{
+		tcentroid_state_reserve(result, count);
+		for (int i = 0; i < count; i++)
 		{
-			double3 *value3 = (double3 *)DatumGetPointer(temporalinst_value(inst));
-			assert(value3->c != 0);
-			double valuea = value3->a / value3->c;
-			double valueb = value3->b / value3->c;
-			value = call_function2(LWGEOM_makepoint, Float8GetDatum(valuea),
-				Float8GetDatum(valueb));
+			TCentroidInst *inst = &result->instants[i];
+			inst->t = (TimestampTz) pq_getmsgint64(&buf);
+			inst->x = pq_getmsgfloat8(&buf);
+			inst->y = pq_getmsgfloat8(&buf);
+			inst->z = pq_getmsgfloat8(&buf);
+			inst->count = pq_getmsgfloat8(&buf);
 		}
-		newinstants[i] = temporalinst_make(value, inst->t, type_oid(T_GEOMETRY));
-		pfree(DatumGetPointer(value));
+		result->count = count;
 	}
-	TemporalI *result = temporali_from_temporalinstarr(newinstants, count);
+	if (pq_getmsgbyte(&buf))
+		result->seqstate = aggstate_read(fcinfo, &buf);
+	pq_getmsgend(&buf);
+	PG_RETURN_POINTER(result);
+}
 
-	for (int i = 0; i < count; i++)
-		pfree(newinstants[i]);
-	pfree(newinstants);
+/*****************************************************************************/
+
+/* Centroid final function */
+
+static TemporalI *
+tpointinst_tcentroid_finalfn(TCentroidState *state)
+{
+	tcentroid_state_compact(state);
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * state->count);
+	for (int i = 0; i < state->count; i++)
+	{
+		TCentroidInst *inst = &state->instants[i];
+		LWPOINT *lwpoint = state->hasz ?
+			lwpoint_make3dz(state->srid, inst->x / inst->count,
+				inst->y / inst->count, inst->z / inst->count) :
+			lwpoint_make2d(state->srid, inst->x / inst->count,
+				inst->y / inst->count);
+		GSERIALIZED *gs = geometry_serialize((LWGEOM *) lwpoint);
+		instants[i] = temporalinst_make(PointerGetDatum(gs), inst->t,
+			type_oid(T_GEOMETRY));
+		pfree(gs);
+		lwpoint_free(lwpoint);
+	}
+	TemporalI *result = temporali_from_temporalinstarr(instants, state->count);
+
+	for (int i = 0; i < state->count; i++)
+		pfree(instants[i]);
+	pfree(instants);
 	
 	return result;
 }
 
-TemporalS *
+static TemporalS *
 tpointseq_tcentroid_finalfn(TemporalSeq **sequences, int count)
 {
 	TemporalSeq **newsequences = palloc(sizeof(TemporalSeq *) * count);
@@ -464,27 +626,430 @@ PGDLLEXPORT Datum
 tpoint_tcentroid_finalfn(PG_FUNCTION_ARGS)
 {
 	/* The final function is strict, we do not need to test for null values */
-	SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
-	if (state->length == 0)
+	TCentroidState *state = (TCentroidState *) PG_GETARG_POINTER(0);
+	if (state->count > 0)
+		PG_RETURN_POINTER(tpointinst_tcentroid_finalfn(state));
+	if (! state->seqstate || state->seqstate->length == 0)
 		PG_RETURN_NULL();
+	skiplist_unspill(fcinfo, state->seqstate);
 
-	Temporal **values = skiplist_values(state);
-	Temporal *result = NULL;
-	assert(values[0]->duration == TEMPORALINST ||
-		values[0]->duration == TEMPORALSEQ);
-	if (values[0]->duration == TEMPORALINST)
-		result = (Temporal *)tpointinst_tcentroid_finalfn(
-			(TemporalInst **)values, state->length);
-	else if (values[0]->duration == TEMPORALSEQ)
-		result = (Temporal *)tpointseq_tcentroid_finalfn(
-			(TemporalSeq **)values, state->length);
-
-	int32_t srid = ((struct GeoAggregateState *) state->extra)->srid;
-	Temporal *sridresult = tpoint_set_srid_internal(result, srid);
+	Temporal **values = skiplist_values(state->seqstate);
+	assert(values[0]->duration == TEMPORALSEQ);
+	Temporal *result = (Temporal *)tpointseq_tcentroid_finalfn(
+		(TemporalSeq **)values, state->seqstate->length);
+	Temporal *sridresult = tpoint_set_srid_internal(result, state->srid);
 	pfree(values);
 	pfree(result);
 
 	PG_RETURN_POINTER(sridresult);
 }
 
+/*****************************************************************************
+ * Aggregate building a temporal point sequence from (point, timestamp) rows
+ *****************************************************************************/
+
+/*
+ * Transition function of the aggregate for temporal points, the points
+ * are validated as in the constructors of temporal points. The SRID and 
+ * the dimensionality of all the points are verified when the sequence is
+ * constructed in the final function.
+ */
+
+PG_FUNCTION_INFO_V1(tpoint_tseq_agg_transfn);
+
+PGDLLEXPORT Datum
+tpoint_tseq_agg_transfn(PG_FUNCTION_ARGS)
+{
+	InstArr *state = PG_ARGISNULL(0) ? NULL : (InstArr *) PG_GETARG_POINTER(0);
+	/* Rows with a null point or a null timestamp are ignored */
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+	{
+		if (! state)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state);
+	}
+	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+	ensure_point_type(gs);
+	ensure_non_empty(gs);
+	ensure_has_not_M(gs);
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(2);
+	Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+	state = instarr_append(fcinfo, state, PointerGetDatum(gs), t, valuetypid);
+	PG_FREE_IF_COPY(gs, 1);
+	PG_RETURN_POINTER(state);
+}
+
+/*****************************************************************************
+ * Spatiotemporal density
+ *****************************************************************************/
+
+/*
+ * State of the density aggregation. The time spent by the temporal points in
+ * each cell of a regular grid of the plane and each time bucket is kept in
+ * a hash table whose key is the index of the cell and of the bucket, so that
+ * only the cells that are actually traversed are stored. Each segment is
+ * split at the grid lines and the bucket boundaries it crosses and the time
+ * between two consecutive splits is added to the cell and the bucket of the
+ * middle of the piece.
+ */
+typedef struct
+{
+	int64 x;					/* Column of the cell */
+	int64 y;					/* Row of the cell */
+	int64 bucket;				/* Time bucket */
+} TDensityKey;
+
+typedef struct
+{
+	TDensityKey key;
+	double seconds;
+} TDensityEntry;
+
+typedef struct
+{
+	int32_t srid;
+	double gridsize;
+	TimestampTz origin;
+	int64 step;
+	HTAB *cells;
+} TDensityState;
+
+#define TDENSITY_INITIAL_CELLS 1024
+
+static TDensityState *
+tdensity_state_make(FunctionCallInfo fcinfo, int32_t srid, double gridsize,
+	TimestampTz origin, int64 step)
+{
+	MemoryContext ctx;
+	if (! AggCheckCallContext(fcinfo, &ctx))
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Operation not supported")));
+	TDensityState *result = MemoryContextAllocZero(ctx, sizeof(TDensityState));
+	result->srid = srid;
+	result->gridsize = gridsize;
+	result->origin = origin;
+	result->step = step;
+	HASHCTL hashctl;
+	memset(&hashctl, 0, sizeof(HASHCTL));
+	hashctl.keysize = sizeof(TDensityKey);
+	hashctl.entrysize = sizeof(TDensityEntry);
+	hashctl.hcxt = ctx;
+	result->cells = hash_create("tdensity cells", TDENSITY_INITIAL_CELLS,
+		&hashctl, HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	return result;
+}
+
+static void
+tdensity_state_check(TDensityState *state, int32_t srid, double gridsize,
+	TimestampTz origin, int64 step)
+{
+	if (state->srid != srid)
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Geometries must have the same SRID for temporal aggregation")));
+	if (state->gridsize != gridsize || state->origin != origin ||
+		state->step != step)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The grid and the buckets must be the same for all values")));
+}
+
+static void
+tdensity_state_add(TDensityState *state, TDensityKey *key, double seconds)
+{
+	bool found;
+	TDensityEntry *entry = (TDensityEntry *) hash_search(state->cells, key,
+		HASH_ENTER, &found);
+	if (found)
+		entry->seconds += seconds;
+	else
+		entry->seconds = seconds;
+}
+
+static int
+double_cmp(const void *a, const void *b)
+{
+	double d1 = *(const double *) a;
+	double d2 = *(const double *) b;
+	return (d1 < d2) ? -1 : ((d1 > d2) ? 1 : 0);
+}
+
+/*
+ * Fractions of the interval [v1, v2] at which the value crosses a multiple
+ * of size, they are stored in the array given as first argument
+ */
+static int
+tdensity_crossings(double *result, double v1, double v2, double size)
+{
+	if (v1 == v2)
+		return 0;
+	int64 i1 = (int64) floor(v1 / size);
+	int64 i2 = (int64) floor(v2 / size);
+	int64 lower = Min(i1, i2), upper = Max(i1, i2);
+	int k = 0;
+	for (int64 i = lower + 1; i <= upper; i++)
+		result[k++] = ((double) i * size - v1) / (v2 - v1);
+	return k;
+}
+
+/*
+ * Add the time spent by a point moving from p1 at t1 to p2 at t2, which are
+ * equal for stepwise sequences, to the cells and buckets it traverses
+ */
+static void
+tdensity_state_add_segment(TDensityState *state, POINT2D *p1, POINT2D *p2,
+	TimestampTz t1, TimestampTz t2)
+{
+	double gridsize = state->gridsize;
+	int64 b1 = timestamp_grid_bucket(t1, state->origin, state->step);
+	int64 b2 = timestamp_grid_bucket(t2, state->origin, state->step);
+	int64 nx = Abs((int64) floor(p2->x / gridsize) -
+		(int64) floor(p1->x / gridsize));
+	int64 ny = Abs((int64) floor(p2->y / gridsize) -
+		(int64) floor(p1->y / gridsize));
+	double *fractions = palloc(sizeof(double) * (nx + ny + (b2 - b1) + 2));
+	int count = 0;
+	fractions[count++] = 0.0;
+	count += tdensity_crossings(&fractions[count], p1->x, p2->x, gridsize);
+	count += tdensity_crossings(&fractions[count], p1->y, p2->y, gridsize);
+	double duration = (double) (t2 - t1);
+	for (int64 b = b1 + 1; b <= b2; b++)
+		fractions[count++] =
+			(double) (state->origin + b * state->step - t1) / duration;
+	fractions[count++] = 1.0;
+	qsort(fractions, count, sizeof(double), &double_cmp);
+
+	for (int i = 1; i < count; i++)
+	{
+		if (fractions[i] <= fractions[i - 1])
+			continue;
+		double mid = (fractions[i - 1] + fractions[i]) / 2;
+		TDensityKey key;
+		key.x = (int64) floor((p1->x + (p2->x - p1->x) * mid) / gridsize);
+		key.y = (int64) floor((p1->y + (p2->y - p1->y) * mid) / gridsize);
+		key.bucket = timestamp_grid_bucket(t1 + (TimestampTz) (duration * mid),
+			state->origin, state->step);
+		tdensity_state_add(state, &key,
+			(fractions[i] - fractions[i - 1]) * duration / USECS_PER_SEC);
+	}
+	pfree(fractions);
+}
+
+static void
+tdensity_state_add_seq(TDensityState *state, TemporalSeq *seq)
+{
+	if (seq->count == 1)
+		return;
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	POINT2D p1 = datum_get_point2d(temporalinst_value(inst1));
+	for (int i = 1; i < seq->count; i++)
+	{
+		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
+		POINT2D p2 = datum_get_point2d(temporalinst_value(inst2));
+		tdensity_state_add_segment(state, &p1, linear ? &p2 : &p1,
+			inst1->t, inst2->t);
+		inst1 = inst2;
+		p1 = p2;
+	}
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tdensity_transfn);
+/*
+ * Temporal points of instant or instant set duration do not spend time in
+ * any cell and thus do not contribute to the density
+ */
+PGDLLEXPORT Datum
+tpoint_tdensity_transfn(PG_FUNCTION_ARGS)
+{
+	TDensityState *state = PG_ARGISNULL(0) ? NULL :
+		(TDensityState *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2) || PG_ARGISNULL(3) ||
+		(PG_NARGS() > 4 && PG_ARGISNULL(4)))
+	{
+		if (! state)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state);
+	}
+	Temporal *temp = PG_GETARG_TEMPORAL(1);
+	double gridsize = PG_GETARG_FLOAT8(2);
+	if (gridsize <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The grid size must be positive")));
+	int64 step = interval_grid_step(PG_GETARG_INTERVAL_P(3));
+	TimestampTz origin = (PG_NARGS() > 4) ? PG_GETARG_TIMESTAMPTZ(4) :
+		BUCKETCOUNT_DEFAULT_ORIGIN;
+	int32_t srid = tpoint_srid_internal(temp);
+	if (state)
+		tdensity_state_check(state, srid, gridsize, origin, step);
+	else
+		state = tdensity_state_make(fcinfo, srid, gridsize, origin, step);
+
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALSEQ)
+		tdensity_state_add_seq(state, (TemporalSeq *) temp);
+	else if (temp->duration == TEMPORALS)
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		for (int i = 0; i < ts->count; i++)
+			tdensity_state_add_seq(state, temporals_seq_n(ts, i));
+	}
+	PG_FREE_IF_COPY(temp, 1);
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tdensity_combinefn);
+
+PGDLLEXPORT Datum
+tpoint_tdensity_combinefn(PG_FUNCTION_ARGS)
+{
+	TDensityState *state1 = PG_ARGISNULL(0) ? NULL :
+		(TDensityState *) PG_GETARG_POINTER(0);
+	TDensityState *state2 = PG_ARGISNULL(1) ? NULL :
+		(TDensityState *) PG_GETARG_POINTER(1);
+	if (! state1 || ! state2)
+	{
+		if (! state1 && ! state2)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state1 ? state1 : state2);
+	}
+	tdensity_state_check(state1, state2->srid, state2->gridsize,
+		state2->origin, state2->step);
+	HASH_SEQ_STATUS status;
+	hash_seq_init(&status, state2->cells);
+	TDensityEntry *entry;
+	while ((entry = (TDensityEntry *) hash_seq_search(&status)) != NULL)
+		tdensity_state_add(state1, &entry->key, entry->seconds);
+	PG_RETURN_POINTER(state1);
+}
+
+/*
+ * The state is serialized as the parameters of the grid and the buckets
+ * followed by the number of entries and the key and the time of each entry
+ */
+
+PG_FUNCTION_INFO_V1(tpoint_tdensity_serialize);
+
+PGDLLEXPORT Datum
+tpoint_tdensity_serialize(PG_FUNCTION_ARGS)
+{
+	TDensityState *state = (TDensityState *) PG_GETARG_POINTER(0);
+	StringInfoData buf;
+	pq_begintypsend(&buf);
+	pq_sendint32(&buf, (uint32) state->srid);
+	pq_sendfloat8(&buf, state->gridsize);
+	pq_sendint64(&buf, (uint64) state->origin);
+	pq_sendint64(&buf, (uint64) state->step);
+	pq_sendint64(&buf, (uint64) hash_get_num_entries(state->cells));
+	HASH_SEQ_STATUS status;
+	hash_seq_init(&status, state->cells);
+	TDensityEntry *entry;
+	while ((entry = (TDensityEntry *) hash_seq_search(&status)) != NULL)
+	{
+		pq_sendint64(&buf, (uint64) entry->key.x);
+		pq_sendint64(&buf, (uint64) entry->key.y);
+		pq_sendint64(&buf, (uint64) entry->key.bucket);
+		pq_sendfloat8(&buf, entry->seconds);
+	}
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tdensity_deserialize);
+
+PGDLLEXPORT Datum
+tpoint_tdensity_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_P(0);
+	StringInfoData buf =
+	{
+		.cursor = 0,
+		.data = VARDATA(data),
+		.len = VARSIZE(data) - VARHDRSZ,
+		.maxlen = VARSIZE(data) - VARHDRSZ
+	};
+	int32_t srid = (int32_t) pq_getmsgint(&buf, 4);
+	double gridsize = pq_getmsgfloat8(&buf);
+	TimestampTz origin = (TimestampTz) pq_getmsgint64(&buf);
+	int64 step = pq_getmsgint64(&buf);
+	int64 count = pq_getmsgint64(&buf);
+	if (gridsize <= 0 || step <= 0 || count < 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+			errmsg("Invalid serialized state for temporal aggregation")));
+	TDensityState *result = tdensity_state_make(fcinfo, srid, gridsize,
+		origin, step);
+	for (int64 i = 0; i < count; i++)
+	{
+		TDensityKey key;
+		key.x = pq_getmsgint64(&buf);
+		key.y = pq_getmsgint64(&buf);
+		key.bucket = pq_getmsgint64(&buf);
+		tdensity_state_add(result, &key, pq_getmsgfloat8(&buf));
+	}
+	pq_getmsgend(&buf);
+	PG_RETURN_POINTER(result);
+}
+
+static int
+tdensity_entry_cmp(const void *a, const void *b)
+{
+	const TDensityKey *key1 = &(*(TDensityEntry * const *) a)->key;
+	const TDensityKey *key2 = &(*(TDensityEntry * const *) b)->key;
+	if (key1->bucket != key2->bucket)
+		return (key1->bucket < key2->bucket) ? -1 : 1;
+	if (key1->y != key2->y)
+		return (key1->y < key2->y) ? -1 : 1;
+	if (key1->x != key2->x)
+		return (key1->x < key2->x) ? -1 : 1;
+	return 0;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tdensity_finalfn);
+/*
+ * Returns an array of (cell, bucket, seconds) records ordered by bucket and
+ * cell, where the cell is the square polygon of the grid
+ */
+PGDLLEXPORT Datum
+tpoint_tdensity_finalfn(PG_FUNCTION_ARGS)
+{
+	/* The final function is strict, we do not need to test for null values */
+	TDensityState *state = (TDensityState *) PG_GETARG_POINTER(0);
+	int count = (int) hash_get_num_entries(state->cells);
+	if (count == 0)
+		PG_RETURN_NULL();
+	TDensityEntry **entries = palloc(sizeof(TDensityEntry *) * count);
+	HASH_SEQ_STATUS status;
+	hash_seq_init(&status, state->cells);
+	int k = 0;
+	TDensityEntry *entry;
+	while ((entry = (TDensityEntry *) hash_seq_search(&status)) != NULL)
+		entries[k++] = entry;
+	qsort(entries, count, sizeof(TDensityEntry *), &tdensity_entry_cmp);
+
+	Oid elemtype = get_element_type(get_fn_expr_rettype(fcinfo->flinfo));
+	if (elemtype == InvalidOid)
+		ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			errmsg("Could not determine the result type of the density")));
+	TupleDesc tupdesc = lookup_rowtype_tupdesc(elemtype, -1);
+	Datum *cells = palloc(sizeof(Datum) * count);
+	double gridsize = state->gridsize;
+	for (int i = 0; i < count; i++)
+	{
+		TDensityKey *key = &entries[i]->key;
+		LWPOLY *poly = lwpoly_construct_envelope(state->srid,
+			key->x * gridsize, key->y * gridsize,
+			(key->x + 1) * gridsize, (key->y + 1) * gridsize);
+		Datum values[3];
+		bool isnull[3] = {false, false, false};
+		values[0] = PointerGetDatum(geometry_serialize((LWGEOM *) poly));
+		values[1] = TimestampTzGetDatum(state->origin + key->bucket * state->step);
+		values[2] = Float8GetDatum(entries[i]->seconds);
+		HeapTuple tuple = heap_form_tuple(tupdesc, values, isnull);
+		cells[i] = HeapTupleGetDatum(tuple);
+		lwpoly_free(poly);
+	}
+	ReleaseTupleDesc(tupdesc);
+	ArrayType *result = construct_array(cells, count, elemtype, -1, false, 'd');
+	pfree(entries); pfree(cells);
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+
 /*****************************************************************************/
+
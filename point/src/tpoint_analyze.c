@@ -33,6 +33,7 @@
 
 #include <assert.h>
 #include <access/htup_details.h>
+#include <access/tuptoaster.h>
 #include <executor/spi.h>
 #include <float.h>
 
@@ -849,7 +850,9 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 	int notnull_cnt = 0;			/* # not null rows in the sample */
 	int null_cnt = 0;				/* # null rows in the sample */
 	int	slot_idx = 0;				/* slot for storing the statistics */
+	int rows_cnt = 0;				/* # rows read from the sample */
 	double total_width = 0;			/* # of bytes used by sample */
+	double fetched_bytes = 0;		/* # of bytes fetched from the sample */
 	ND_BOX sum;						/* Sum of extents of sample boxes */
 	const ND_BOX **sample_boxes;	/* ND_BOXes for each of the sample features */
 	ND_BOX sample_extent;			/* Extent of the raw sample */
@@ -890,15 +893,18 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 	for (i = 0; i < sample_rows; i++)
 	{
 		Datum value;
-		Temporal *temp;
-		GSERIALIZED *traj;
+		STBOX box;
 		Period period;
 		PeriodBound period_lower,
 				period_upper;
 		GBOX gbox;
 		ND_BOX *nd_box;
 		bool is_null;
-		bool is_copy;
+
+		/* Stop when the maximum number of bytes to fetch has been reached */
+		if (notnull_cnt > 0 && analyze_detoast_limit_reached(fetched_bytes))
+			break;
+		rows_cnt++;
 
 		value = fetchfunc(stats, i, &is_null);
 
@@ -909,18 +915,16 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 			continue;
 		}
 
-		/* Get temporal point */
-		temp = DatumGetTemporal(value);
-
-		/* TO VERIFY */
-		is_copy = VARATT_IS_EXTENDED(temp);
-
 		/* How many bytes does this sample use? */
-		total_width += VARSIZE(temp);
+		total_width += toast_raw_datum_size(value);
 
-		/* Get trajectory and period from temporal point */
-		traj = (GSERIALIZED *) DatumGetPointer(tpoint_values_internal(temp));
-		temporal_period(&period, temp);
+		/* 
+		 * Get the bounding box of the temporal point fetching only the 
+		 * required slices of the value instead of its trajectory 
+		 */
+		memset(&box, 0, sizeof(STBOX));
+		fetched_bytes += temporal_bbox_slice(value, &box);
+		period_set(&period, box.tmin, box.tmax, true, true);
 
 		/* Remember time bounds and length for further usage in histograms */
 		period_deserialize(&period, &period_lower, &period_upper);
@@ -929,12 +933,13 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 		time_lengths[notnull_cnt] = period_to_secs(period_upper.val, 
 			period_lower.val);
 
-		/* Read the bounds from the trajectory. */
-		if (LW_FAILURE == gserialized_get_gbox_p(traj, &gbox))
-		{
-			/* Skip empties too. */
-			continue;
-		}
+		/* Convert the bounding box into a GBOX */
+		memset(&gbox, 0, sizeof(GBOX));
+		gbox.xmin = box.xmin; gbox.xmax = box.xmax;
+		gbox.ymin = box.ymin; gbox.ymax = box.ymax;
+		gbox.zmin = box.zmin; gbox.zmax = box.zmax;
+		FLAGS_SET_Z(gbox.flags, MOBDB_FLAGS_GET_Z(box.flags));
+		FLAGS_SET_GEODETIC(gbox.flags, MOBDB_FLAGS_GET_GEODETIC(box.flags));
 
 		/* Check bounds for validity (finite and not NaN) */
 		if (! gbox_is_valid(&gbox))
@@ -944,7 +949,7 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 
 		/* If we're in 2D/3D mode, zero out the higher dimensions for "safety" 
 		 * If we're in 3D mode set ndims to 3 */
-		if (! MOBDB_FLAGS_GET_Z(temp->flags))
+		if (! MOBDB_FLAGS_GET_Z(box.flags))
 			gbox.zmin = gbox.zmax = gbox.mmin = gbox.mmax = 0.0;
 		else
 		{
@@ -976,11 +981,6 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 		/* Increment our "good feature" count */
 		notnull_cnt++;
 
-		/* Free up memory if our sample temporal point was copied */
-		if (is_copy)
-			pfree(temp);
-		pfree(traj);
-
 		/* Give backend a chance of interrupting us */
 		vacuum_delay_point();
 	}
@@ -990,7 +990,7 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 	{
 		stats->stats_valid = true;
 		/* Do the simple null-frac and width stats */
-		stats->stanullfrac = (float4) null_cnt / (float4) sample_rows;
+		stats->stanullfrac = (float4) null_cnt / (float4) rows_cnt;
 		stats->stawidth = (int) (total_width / notnull_cnt);
 
 		/* Estimate that non-null values are unique */
@@ -998,10 +998,10 @@ tpoint_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 
 		/* Compute statistics for spatial dimension */
 		/* 2D Mode */
-		gserialized_compute_stats(stats, sample_rows, (int) total_rows, notnull_cnt,
+		gserialized_compute_stats(stats, rows_cnt, (int) total_rows, notnull_cnt,
 			sample_boxes, &sum, &sample_extent, &slot_idx, 2);
 		/* ND Mode */
-		gserialized_compute_stats(stats, sample_rows, (int) total_rows, notnull_cnt,
+		gserialized_compute_stats(stats, rows_cnt, (int) total_rows, notnull_cnt,
 			sample_boxes, &sum, &sample_extent, &slot_idx, ndims);
 
 		/* Compute statistics for time dimension */
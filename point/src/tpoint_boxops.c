@@ -22,12 +22,14 @@
 #include "tpoint_boxops.h"
 
 #include <assert.h>
+#include <math.h>
 #include <utils/builtins.h>
 #include <utils/timestamp.h>
 
 #include "timestampset.h"
 #include "periodset.h"
 #include "temporaltypes.h"
+#include "oidcache.h"
 #include "temporal_util.h"
 #include "tpoint.h"
 #include "stbox.h"
@@ -365,7 +367,7 @@ same_stbox_stbox(PG_FUNCTION_ARGS)
 
 /* Expand the first box with the second one */
 
-static void
+void
 stbox_expand(STBOX *box1, const STBOX *box2)
 {
 	box1->xmin = Min(box1->xmin, box2->xmin);
@@ -530,6 +532,111 @@ tpoint_expand_temporal(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Longitude/latitude boxes for geodetic values
+ * The boxes of geodetic values are geocentric boxes on the unit sphere, which
+ * are large cubes for thin and long trajectories. The functions below project
+ * such a box radially onto the sphere and return the longitude/latitude box
+ * in degrees that contains the projection of every point of the box. When
+ * the box crosses the antimeridian, the maximum longitude is set beyond 180,
+ * e.g., [170, 190] instead of splitting the box in [170, 180] and [-180, -170].
+ *****************************************************************************/
+
+/*
+ * Angle in degrees of the point (x, y) relative to the angle c, normalized
+ * to (-180, 180]
+ */
+static double
+stbox_latlon_angle(double x, double y, double c)
+{
+	double result = atan2(y, x) * 180.0 / M_PI - c;
+	if (result <= -180.0)
+		result += 360.0;
+	else if (result > 180.0)
+		result -= 360.0;
+	return result;
+}
+
+void
+stbox_latlon_internal(STBOX *result, const STBOX *box)
+{
+	double dx, dy, rmin, rmax, c, d, dmin, dmax;
+
+	/* Minimum and maximum distance of the XY rectangle to the Z axis */
+	dx = box->xmin > 0 ? box->xmin : (box->xmax < 0 ? -box->xmax : 0);
+	dy = box->ymin > 0 ? box->ymin : (box->ymax < 0 ? -box->ymax : 0);
+	rmin = hypot(dx, dy);
+	rmax = hypot(Max(fabs(box->xmin), fabs(box->xmax)),
+		Max(fabs(box->ymin), fabs(box->ymax)));
+
+	/* Latitude is increasing in z and decreasing in the distance to the axis
+	 * for positive z, and conversely for negative z */
+	result->ymin = atan2(box->zmin, box->zmin >= 0 ? rmax : rmin) * 180.0 / M_PI;
+	result->ymax = atan2(box->zmax, box->zmax >= 0 ? rmin : rmax) * 180.0 / M_PI;
+
+	/* Longitude is unbounded when the rectangle contains the Z axis, 
+	 * otherwise it is given by the corners of the rectangle */
+	if (rmin == 0)
+	{
+		result->xmin = -180.0;
+		result->xmax = 180.0;
+	}
+	else
+	{
+		c = atan2((box->ymin + box->ymax) / 2, (box->xmin + box->xmax) / 2) * 
+			180.0 / M_PI;
+		dmin = dmax = stbox_latlon_angle(box->xmin, box->ymin, c);
+		d = stbox_latlon_angle(box->xmin, box->ymax, c);
+		dmin = Min(dmin, d); dmax = Max(dmax, d);
+		d = stbox_latlon_angle(box->xmax, box->ymin, c);
+		dmin = Min(dmin, d); dmax = Max(dmax, d);
+		d = stbox_latlon_angle(box->xmax, box->ymax, c);
+		dmin = Min(dmin, d); dmax = Max(dmax, d);
+		result->xmin = c + dmin;
+		if (result->xmin < -180.0)
+			result->xmin += 360.0;
+		else if (result->xmin >= 180.0)
+			result->xmin -= 360.0;
+		result->xmax = result->xmin + (dmax - dmin);
+	}
+	result->zmin = result->zmax = 0;
+	result->tmin = box->tmin;
+	result->tmax = box->tmax;
+	result->flags = 0;
+	MOBDB_FLAGS_SET_X(result->flags, true);
+	MOBDB_FLAGS_SET_T(result->flags, MOBDB_FLAGS_GET_T(box->flags));
+}
+
+PG_FUNCTION_INFO_V1(stbox_latlon);
+
+PGDLLEXPORT Datum
+stbox_latlon(PG_FUNCTION_ARGS)
+{
+	STBOX *box = PG_GETARG_STBOX_P(0);
+	if (! MOBDB_FLAGS_GET_X(box->flags) || ! MOBDB_FLAGS_GET_GEODETIC(box->flags))
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+			errmsg("The box must be geodetic and have XY dimension")));
+
+	STBOX *result = palloc0(sizeof(STBOX));
+	stbox_latlon_internal(result, box);
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_latlon);
+
+PGDLLEXPORT Datum
+tpoint_latlon(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	STBOX box;
+	memset(&box, 0, sizeof(STBOX));
+	temporal_bbox(&box, temp);
+	STBOX *result = palloc0(sizeof(STBOX));
+	stbox_latlon_internal(result, &box);
+	PG_FREE_IF_COPY(temp, 0);	
+	PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************
  * overlaps
  *****************************************************************************/
@@ -955,3 +1062,111 @@ same_bbox_tpoint_tpoint(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Split a temporal point into several bounding boxes
+ * A single bounding box of a long trip is mostly empty space. Splitting the
+ * temporal point into boxes of at most a given number of segments allows to 
+ * index the boxes, e.g., in a GiST index on an unnested stbox[], which
+ * drastically reduces the false positives of the index.
+ *****************************************************************************/
+
+/* Bounding box of the instants of a sequence between two positions */
+
+static void
+tpointseq_stbox_range(STBOX *box, TemporalSeq *seq, int from, int to)
+{
+	TemporalInst *inst = temporalseq_inst_n(seq, from);
+	tpointinst_make_stbox(box, temporalinst_value(inst), inst->t);
+	for (int i = from + 1; i <= to; i++)
+	{
+		STBOX box1;
+		memset(&box1, 0, sizeof(STBOX));
+		inst = temporalseq_inst_n(seq, i);
+		tpointinst_make_stbox(&box1, temporalinst_value(inst), inst->t);
+		stbox_expand(box, &box1);
+	}
+}
+
+static int
+tpointseq_stboxes(STBOX *result, TemporalSeq *seq, int n)
+{
+	if (seq->count == 1)
+	{
+		tpointseq_stbox_range(&result[0], seq, 0, 0);
+		return 1;
+	}
+	int k = 0;
+	for (int i = 0; i < seq->count - 1; i += n)
+		tpointseq_stbox_range(&result[k++], seq, i, 
+			Min(i + n, seq->count - 1));
+	return k;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_stboxes);
+
+PGDLLEXPORT Datum
+tpoint_stboxes(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	int n = PG_GETARG_INT32(1);
+	if (n <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The number of segments per box must be positive")));
+
+	STBOX *boxes;
+	int count = 0;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+	{
+		boxes = palloc0(sizeof(STBOX));
+		temporalinst_bbox(&boxes[0], (TemporalInst *)temp);
+		count = 1;
+	}
+	else if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *)temp;
+		boxes = palloc0(sizeof(STBOX) * ((ti->count + n - 1) / n));
+		for (int i = 0; i < ti->count; i += n)
+		{
+			TemporalInst *inst = temporali_inst_n(ti, i);
+			tpointinst_make_stbox(&boxes[count], temporalinst_value(inst), inst->t);
+			for (int j = i + 1; j < Min(i + n, ti->count); j++)
+			{
+				STBOX box1;
+				memset(&box1, 0, sizeof(STBOX));
+				inst = temporali_inst_n(ti, j);
+				tpointinst_make_stbox(&box1, temporalinst_value(inst), inst->t);
+				stbox_expand(&boxes[count], &box1);
+			}
+			count++;
+		}
+	}
+	else if (temp->duration == TEMPORALSEQ)
+	{
+		TemporalSeq *seq = (TemporalSeq *)temp;
+		boxes = palloc0(sizeof(STBOX) * (seq->count / n + 1));
+		count = tpointseq_stboxes(boxes, seq, n);
+	}
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *)temp;
+		int maxcount = 0;
+		for (int i = 0; i < ts->count; i++)
+			maxcount += temporals_seq_n(ts, i)->count / n + 1;
+		boxes = palloc0(sizeof(STBOX) * maxcount);
+		for (int i = 0; i < ts->count; i++)
+			count += tpointseq_stboxes(&boxes[count], temporals_seq_n(ts, i), n);
+	}
+
+	Datum *values = palloc(sizeof(Datum) * count);
+	for (int i = 0; i < count; i++)
+		values[i] = PointerGetDatum(&boxes[i]);
+	ArrayType *result = construct_array(values, count, type_oid(T_STBOX),
+		sizeof(STBOX), false, 'd');
+	pfree(values); pfree(boxes);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
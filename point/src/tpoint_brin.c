@@ -0,0 +1,110 @@
+/*****************************************************************************
+ *
+ * tpoint_brin.c
+ *	  BRIN index for temporal points.
+ *
+ * A block range is summarized by the STBOX of all the values in the range.
+ * The generic functions are defined in the file temporal_brin.c.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "tpoint_brin.h"
+
+#include "temporaltypes.h"
+#include "oidcache.h"
+#include "temporal_brin.h"
+#include "tpoint.h"
+#include "tpoint_boxops.h"
+#include "tpoint_gist.h"
+
+/*****************************************************************************/
+
+static bool
+brin_stbox_contains(const void *box1, const void *box2)
+{
+	return contains_stbox_stbox_internal((STBOX *) box1, (STBOX *) box2);
+}
+
+static void
+brin_stbox_expand(void *box1, const void *box2)
+{
+	adjust_stbox((STBOX *) box1, (STBOX *) box2);
+}
+
+PG_FUNCTION_INFO_V1(brin_stbox_opcinfo);
+
+PGDLLEXPORT Datum
+brin_stbox_opcinfo(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(brin_bbox_opcinfo(type_oid(T_STBOX)));
+}
+
+PG_FUNCTION_INFO_V1(brin_tpoint_add_value);
+
+PGDLLEXPORT Datum
+brin_tpoint_add_value(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	if (PG_GETARG_BOOL(3))
+		PG_RETURN_BOOL(brin_bbox_add_null(column));
+	Temporal *temp = PG_GETARG_TEMPORAL(2);
+	STBOX box;
+	memset(&box, 0, sizeof(STBOX));
+	temporal_bbox(&box, temp);
+	bool result = brin_bbox_add_value(column, &box, sizeof(STBOX),
+		&brin_stbox_contains, &brin_stbox_expand);
+	PG_FREE_IF_COPY(temp, 2);
+	PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(brin_tpoint_consistent);
+
+PGDLLEXPORT Datum
+brin_tpoint_consistent(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey key = (ScanKey) PG_GETARG_POINTER(2);
+	bool result;
+	if (brin_bbox_null_consistent(column, key, &result))
+		PG_RETURN_BOOL(result);
+
+	/* Transform the query into a box */
+	STBOX query;
+	memset(&query, 0, sizeof(STBOX));
+	if (key->sk_subtype == type_oid(T_GEOMETRY) || 
+		key->sk_subtype == type_oid(T_GEOGRAPHY))
+	{
+		if (!geo_to_stbox_internal(&query, 
+				(GSERIALIZED *) PG_DETOAST_DATUM(key->sk_argument)))
+			PG_RETURN_BOOL(false);
+	}
+	else if (key->sk_subtype == type_oid(T_STBOX))
+		query = *DatumGetSTboxP(key->sk_argument);
+	else if (temporal_type_oid(key->sk_subtype))
+		temporal_bbox(&query, DatumGetTemporal(key->sk_argument));
+	else
+		elog(ERROR, "unrecognized strategy number: %d", key->sk_strategy);
+
+	/* The summary of the range behaves as an internal node of a GiST */
+	result = gist_internal_consistent_stbox(
+		DatumGetSTboxP(column->bv_values[0]), &query, key->sk_strategy);
+	PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(brin_stbox_union);
+
+PGDLLEXPORT Datum
+brin_stbox_union(PG_FUNCTION_ARGS)
+{
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	brin_bbox_union(col_a, col_b, sizeof(STBOX), &brin_stbox_expand);
+	PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
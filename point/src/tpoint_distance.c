@@ -12,6 +12,11 @@
 
 #include "tpoint_distance.h"
 
+#include <float.h>
+#include <math.h>
+
+#include "period.h"
+#include "timeops.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
@@ -46,6 +51,322 @@ geog_distance(Datum geog1, Datum geog2)
 		Float8GetDatum(0.0), BoolGetDatum(true));
 }
 
+/*
+ * Value of the mobilitydb.geodetic_fast_path parameter. When it is set,
+ * the distances involving temporal geography points are computed on the
+ * sphere of mean radius of the WGS 84 ellipsoid instead of on the spheroid.
+ * The relative error of the spherical distance with respect to the geodesic
+ * distance on the spheroid is below SPHERE_REL_ERROR. The values of the
+ * segments of the sequences are then interpolated on great circles of the
+ * sphere, see geogpoint_interpolate.
+ */
+bool geodetic_fast_path = false;
+
+/*
+ * Great circle distance between two geographic points given in degrees,
+ * computed with the haversine formula
+ */
+double
+geog_point_distance_sphere(const POINT2D *p1, const POINT2D *p2)
+{
+	double lat1 = p1->y * M_PI / 180.0;
+	double lat2 = p2->y * M_PI / 180.0;
+	double sindlat = sin((lat2 - lat1) / 2.0);
+	double sindlon = sin((p2->x - p1->x) * M_PI / 360.0);
+	double a = sindlat * sindlat + cos(lat1) * cos(lat2) * sindlon * sindlon;
+	return 2.0 * SPHERE_MEAN_RADIUS * asin(Min(1.0, sqrt(a)));
+}
+
+/* Distance between two geography points on the sphere */
+
+Datum
+geog_distance_sphere(Datum geog1, Datum geog2)
+{
+	POINT2D p1 = datum_get_point2d(geog1);
+	POINT2D p2 = datum_get_point2d(geog2);
+	return Float8GetDatum(geog_point_distance_sphere(&p1, &p2));
+}
+
+/*
+ * Project in place geographic points given in degrees onto an
+ * equirectangular plane, in meters, centered on the first point and scaled
+ * at the mean latitude of the points. The projection is accurate for points
+ * that are close to each other, e.g., the two ends of a short segment.
+ */
+void
+geog_points_local_plane(POINT2D *points, int count)
+{
+	double lon0 = points[0].x, lat0 = points[0].y, meanlat = 0.0;
+	for (int i = 0; i < count; i++)
+		meanlat += points[i].y;
+	meanlat /= count;
+	double ky = SPHERE_MEAN_RADIUS * M_PI / 180.0;
+	double kx = ky * cos(meanlat * M_PI / 180.0);
+	for (int i = 0; i < count; i++)
+	{
+		double dlon = points[i].x - lon0;
+		/* Take the shortest way around the antimeridian */
+		if (dlon > 180.0)
+			dlon -= 360.0;
+		else if (dlon < -180.0)
+			dlon += 360.0;
+		points[i].x = dlon * kx;
+		points[i].y = (points[i].y - lat0) * ky;
+	}
+}
+
+/*
+ * Great circle segments between geographic points. The two ends of the 
+ * segment are converted once into unit vectors so that the points of the 
+ * segment are obtained by spherical linear interpolation of these vectors,
+ * which only requires a few multiplications and trigonometric functions 
+ * instead of projecting the segment with PostGIS.
+ */
+
+/* Unit vector of a geographic point given in degrees */
+
+static void
+geog_point_unit_vector(double lon, double lat, double *v)
+{
+	double rlon = lon * M_PI / 180.0;
+	double rlat = lat * M_PI / 180.0;
+	double coslat = cos(rlat);
+	v[0] = coslat * cos(rlon);
+	v[1] = coslat * sin(rlon);
+	v[2] = sin(rlat);
+}
+
+/*
+ * Initialize a great circle segment from its two ends. Returns false when
+ * the two ends are antipodal, in which case the great circle joining them 
+ * is not defined.
+ */
+bool
+geog_segment_init(GeogSegment *seg, Datum value1, Datum value2, bool hasz)
+{
+	if (hasz)
+	{
+		seg->p1 = datum_get_point3dz(value1);
+		seg->p2 = datum_get_point3dz(value2);
+	}
+	else
+	{
+		POINT2D p1 = datum_get_point2d(value1);
+		POINT2D p2 = datum_get_point2d(value2);
+		seg->p1.x = p1.x; seg->p1.y = p1.y; seg->p1.z = 0.0;
+		seg->p2.x = p2.x; seg->p2.y = p2.y; seg->p2.z = 0.0;
+	}
+	seg->hasz = hasz;
+	geog_point_unit_vector(seg->p1.x, seg->p1.y, seg->a);
+	geog_point_unit_vector(seg->p2.x, seg->p2.y, seg->b);
+	/* The normal of the plane of the great circle, whose norm is the sine
+	 * of the angle between the two ends */
+	seg->n[0] = seg->a[1] * seg->b[2] - seg->a[2] * seg->b[1];
+	seg->n[1] = seg->a[2] * seg->b[0] - seg->a[0] * seg->b[2];
+	seg->n[2] = seg->a[0] * seg->b[1] - seg->a[1] * seg->b[0];
+	double cosomega = seg->a[0] * seg->b[0] + seg->a[1] * seg->b[1] + 
+		seg->a[2] * seg->b[2];
+	seg->sinomega = sqrt(seg->n[0] * seg->n[0] + seg->n[1] * seg->n[1] + 
+		seg->n[2] * seg->n[2]);
+	seg->omega = atan2(seg->sinomega, cosomega);
+	if (seg->sinomega < GEOG_SEGMENT_MIN_SINE && cosomega < 0)
+		return false;
+	if (seg->sinomega >= GEOG_SEGMENT_MIN_SINE)
+		for (int i = 0; i < 3; i++)
+			seg->n[i] /= seg->sinomega;
+	return true;
+}
+
+/*
+ * Unit vector of the point of a great circle segment at a fraction of its
+ * length and its derivative with respect to the fraction, if requested
+ */
+static void
+geog_segment_vector(const GeogSegment *seg, double fraction, double *v,
+	double *dv)
+{
+	double ka, kb, dka, dkb;
+	if (seg->sinomega < GEOG_SEGMENT_MIN_SINE)
+	{
+		/* The two ends are equal up to the precision of the computation */
+		ka = 1.0 - fraction; kb = fraction;
+		dka = -1.0; dkb = 1.0;
+	}
+	else
+	{
+		ka = sin((1.0 - fraction) * seg->omega) / seg->sinomega;
+		kb = sin(fraction * seg->omega) / seg->sinomega;
+		dka = - seg->omega * cos((1.0 - fraction) * seg->omega) / seg->sinomega;
+		dkb = seg->omega * cos(fraction * seg->omega) / seg->sinomega;
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		v[i] = ka * seg->a[i] + kb * seg->b[i];
+		if (dv)
+			dv[i] = dka * seg->a[i] + dkb * seg->b[i];
+	}
+}
+
+/* Point of a great circle segment at a fraction of its length */
+
+POINT3DZ
+geog_segment_point(const GeogSegment *seg, double fraction)
+{
+	double v[3];
+	geog_segment_vector(seg, fraction, v, NULL);
+	POINT3DZ result;
+	result.x = atan2(v[1], v[0]) * 180.0 / M_PI;
+	result.y = atan2(v[2], sqrt(v[0] * v[0] + v[1] * v[1])) * 180.0 / M_PI;
+	result.z = seg->p1.z + (seg->p2.z - seg->p1.z) * fraction;
+	return result;
+}
+
+/*
+ * Fraction of the length of a great circle segment at which is located the
+ * projection of a point onto the great circle. The fraction is outside of
+ * [0, 1] when the projection is outside of the segment. The distance in 
+ * meters between the point and the great circle is returned in the last
+ * argument.
+ */
+double
+geog_segment_locate(const GeogSegment *seg, const POINT2D *p, double *dist)
+{
+	double v[3];
+	geog_point_unit_vector(p->x, p->y, v);
+	if (seg->sinomega < GEOG_SEGMENT_MIN_SINE)
+	{
+		double d = (v[0] - seg->a[0]) * (v[0] - seg->a[0]) + 
+			(v[1] - seg->a[1]) * (v[1] - seg->a[1]) + 
+			(v[2] - seg->a[2]) * (v[2] - seg->a[2]);
+		*dist = 2.0 * SPHERE_MEAN_RADIUS * asin(Min(1.0, sqrt(d) / 2.0));
+		return 0.0;
+	}
+	double h = v[0] * seg->n[0] + v[1] * seg->n[1] + v[2] * seg->n[2];
+	*dist = SPHERE_MEAN_RADIUS * asin(Min(1.0, fabs(h)));
+	/* Angle between the start of the segment and the projection of the 
+	 * point, whose sign is positive in the direction of the segment */
+	double proj[3];
+	for (int i = 0; i < 3; i++)
+		proj[i] = v[i] - h * seg->n[i];
+	double cosangle = seg->a[0] * proj[0] + seg->a[1] * proj[1] + 
+		seg->a[2] * proj[2];
+	double sinangle = 
+		(seg->a[1] * proj[2] - seg->a[2] * proj[1]) * seg->n[0] +
+		(seg->a[2] * proj[0] - seg->a[0] * proj[2]) * seg->n[1] +
+		(seg->a[0] * proj[1] - seg->a[1] * proj[0]) * seg->n[2];
+	return atan2(sinangle, cosangle) / seg->omega;
+}
+
+/*
+ * Determine whether two great circle segments traversed during the same
+ * period are at the same location at the same instant and return in the
+ * last argument the fraction of the period at which this happens. The
+ * fraction is first estimated by linearly interpolating the unit vectors
+ * and then refined with Gauss-Newton iterations on the squared distance 
+ * between the two moving points.
+ */
+bool
+geog_segments_intersect(const GeogSegment *seg1, const GeogSegment *seg2,
+	double *fraction)
+{
+	double d0[3], dv[3], a = 0.0, b = 0.0;
+	for (int i = 0; i < 3; i++)
+	{
+		d0[i] = seg1->a[i] - seg2->a[i];
+		dv[i] = (seg1->b[i] - seg1->a[i]) - (seg2->b[i] - seg2->a[i]);
+		a += dv[i] * dv[i];
+		b += d0[i] * dv[i];
+	}
+	if (a == 0.0)
+		/* Parallel segments */
+		return false;
+	double f = Max(0.0, Min(1.0, - b / a));
+	double v1[3], v2[3], dv1[3], dv2[3], g[3], dg[3];
+	for (int iter = 0; iter < GEOG_SEGMENT_MAX_ITER; iter++)
+	{
+		geog_segment_vector(seg1, f, v1, dv1);
+		geog_segment_vector(seg2, f, v2, dv2);
+		double num = 0.0, denom = 0.0;
+		for (int i = 0; i < 3; i++)
+		{
+			g[i] = v1[i] - v2[i];
+			dg[i] = dv1[i] - dv2[i];
+			num += g[i] * dg[i];
+			denom += dg[i] * dg[i];
+		}
+		if (denom == 0.0)
+			break;
+		double step = num / denom;
+		f -= step;
+		if (fabs(step) < EPSILON * EPSILON)
+			break;
+	}
+	if (f <= EPSILON || f >= 1.0 - EPSILON)
+		return false;
+	/* Verify that the two points coincide at the fraction found */
+	geog_segment_vector(seg1, f, v1, NULL);
+	geog_segment_vector(seg2, f, v2, NULL);
+	double dist = sqrt((v1[0] - v2[0]) * (v1[0] - v2[0]) + 
+		(v1[1] - v2[1]) * (v1[1] - v2[1]) + (v1[2] - v2[2]) * (v1[2] - v2[2]));
+	if (dist * SPHERE_MEAN_RADIUS > GEOG_SEGMENT_TOLERANCE)
+		return false;
+	if (seg1->hasz)
+	{
+		double z1 = seg1->p1.z + (seg1->p2.z - seg1->p1.z) * f;
+		double z2 = seg2->p1.z + (seg2->p2.z - seg2->p1.z) * f;
+		if (fabs(z1 - z2) > EPSILON)
+			return false;
+	}
+	*fraction = f;
+	return true;
+}
+
+/*
+ * Interpolate a geography point on the great circle segment joining two 
+ * geography points. The segment of the last call is kept so that the 
+ * successive interpolations on the same segment, e.g., when synchronizing
+ * two sequences, do not recompute the unit vectors of its ends. Returns 
+ * false when the segment is not defined.
+ */
+bool
+geogpoint_interpolate(Datum value1, Datum value2, double fraction, 
+	Datum *result)
+{
+	static GeogSegment segment;
+	static bool valid = false;
+	GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(value1);
+	bool hasz = (bool) FLAGS_GET_Z(gs->flags);
+	if (hasz)
+	{
+		POINT3DZ p1 = datum_get_point3dz(value1);
+		POINT3DZ p2 = datum_get_point3dz(value2);
+		if (! valid || ! segment.hasz || 
+			p1.x != segment.p1.x || p1.y != segment.p1.y || 
+			p1.z != segment.p1.z || p2.x != segment.p2.x || 
+			p2.y != segment.p2.y || p2.z != segment.p2.z)
+			valid = geog_segment_init(&segment, value1, value2, true);
+	}
+	else
+	{
+		POINT2D p1 = datum_get_point2d(value1);
+		POINT2D p2 = datum_get_point2d(value2);
+		if (! valid || segment.hasz || 
+			p1.x != segment.p1.x || p1.y != segment.p1.y || 
+			p2.x != segment.p2.x || p2.y != segment.p2.y)
+			valid = geog_segment_init(&segment, value1, value2, false);
+	}
+	if (! valid)
+		return false;
+	POINT3DZ p = geog_segment_point(&segment, fraction);
+	LWPOINT *lwpoint = hasz ? 
+		lwpoint_make3dz(gserialized_get_srid(gs), p.x, p.y, p.z) :
+		lwpoint_make2d(gserialized_get_srid(gs), p.x, p.y);
+	FLAGS_SET_GEODETIC(lwpoint->flags, true);
+	*result = PointerGetDatum(geometry_serialize((LWGEOM *) lwpoint));
+	lwpoint_free(lwpoint);
+	return true;
+}
+
 /*****************************************************************************/
  
 /* Distance between temporal sequence point and a geometry/geography point */
@@ -66,6 +387,16 @@ distance_tpointseq_geo1(TemporalInst **result,
 	}
 	double fraction;
 	ensure_point_base_type(inst1->valuetypid);
+	/* Short geography segments are located on a local plane in fast mode */
+	POINT2D points[3];
+	bool localplane = false;
+	if (inst1->valuetypid == type_oid(T_GEOGRAPHY) && geodetic_fast_path)
+	{
+		points[0] = datum_get_point2d(value1);
+		points[1] = datum_get_point2d(value2);
+		localplane = geog_point_distance_sphere(&points[0], &points[1]) <=
+			LOCAL_PLANE_MAX_LENGTH;
+	}
 	if (inst1->valuetypid == type_oid(T_GEOMETRY))
 	{
 		/* The trajectory is a line */
@@ -74,6 +405,18 @@ distance_tpointseq_geo1(TemporalInst **result,
 			traj, point));
 		pfree(DatumGetPointer(traj)); 
 	}
+	else if (localplane)
+	{
+		/* Locate the point on the segment projected onto a local plane */
+		points[2] = datum_get_point2d(point);
+		geog_points_local_plane(points, 3);
+		double dx = points[1].x - points[0].x;
+		double dy = points[1].y - points[0].y;
+		double len2 = dx * dx + dy * dy;
+		fraction = ((points[2].x - points[0].x) * dx +
+			(points[2].y - points[0].y) * dy) / len2;
+		fraction = Max(0.0, Min(1.0, fraction));
+	}
 	else
 	{
 		/* The trajectory is a line */
@@ -163,78 +506,443 @@ distance_tpoints_geo(TemporalS *ts, Datum point,
 	return result;
 }
 
-/* 
- * Find the single timestamptz at which two temporal point segments are at the
- * minimum distance. This function is used for computing temporal distance.
- * The function assumes that the two segments are not both constants.
+/*
+ * Find the fraction of two segments of temporal points, given by the
+ * coordinates of their start and end points, at which the points are at the
+ * minimum distance. Returns false if the segments are parallel or if the
+ * minimum is not reached strictly inside the segments.
  */
-bool
-tpointseq_min_dist_at_timestamp(TemporalInst *start1, TemporalInst *end1, 
-	TemporalInst *start2, TemporalInst *end2, TimestampTz *t)
+static bool
+tpoint_min_dist_at_fraction(const double *p1, const double *p2,
+	const double *p3, const double *p4, bool hasz, double *fraction)
 {
-	double denum, fraction;
-	if (MOBDB_FLAGS_GET_Z(start1->flags)) /* 3D */
-	{
-		POINT3DZ p1 = datum_get_point3dz(temporalinst_value(start1));
-		POINT3DZ p2 = datum_get_point3dz(temporalinst_value(end1));
-		POINT3DZ p3 = datum_get_point3dz(temporalinst_value(start2));
-		POINT3DZ p4 = datum_get_point3dz(temporalinst_value(end2));
-		/* The following basically computes d/dx (Euclidean distance) = 0.
-		   To reduce problems related to floating point arithmetic, t1 and t2
-		   are shifted, respectively, to 0 and 1 before computing d/dx */
-		double dx1 = p2.x - p1.x;
-		double dy1 = p2.y - p1.y;
-		double dz1 = p2.z - p1.z;
-		double dx2 = p4.x - p3.x;
-		double dy2 = p4.y - p3.y;
-		double dz2 = p4.z - p3.z;
-		
-		double f1 = p3.x * (dx1 - dx2);
-		double f2 = p1.x * (dx2 - dx1);
-		double f3 = p3.y * (dy1 - dy2);
-		double f4 = p1.y * (dy2 - dy1);
-		double f5 = p3.z * (dz1 - dz2);
-		double f6 = p1.z * (dz2 - dz1);
+	double denum;
+	/* The following basically computes d/dx (Euclidean distance) = 0.
+	   To reduce problems related to floating point arithmetic, t1 and t2
+	   are shifted, respectively, to 0 and 1 before computing d/dx */
+	double dx1 = p2[0] - p1[0];
+	double dy1 = p2[1] - p1[1];
+	double dx2 = p4[0] - p3[0];
+	double dy2 = p4[1] - p3[1];
+
+	double f1 = p3[0] * (dx1 - dx2);
+	double f2 = p1[0] * (dx2 - dx1);
+	double f3 = p3[1] * (dy1 - dy2);
+	double f4 = p1[1] * (dy2 - dy1);
+	if (hasz) /* 3D */
+	{
+		double dz1 = p2[2] - p1[2];
+		double dz2 = p4[2] - p3[2];
+		double f5 = p3[2] * (dz1 - dz2);
+		double f6 = p1[2] * (dz2 - dz1);
 
 		denum = dx1*(dx1-2*dx2) + dy1*(dy1-2*dy2) + dz1*(dz1-2*dz2) + 
 			dx2*dx2 + dy2*dy2 + dz2*dz2;
 		if (denum == 0)
 			return false;
 
-		fraction = (f1 + f2 + f3 + f4 + f5 + f6) / denum;
+		*fraction = (f1 + f2 + f3 + f4 + f5 + f6) / denum;
 	}
 	else /* 2D */
 	{
-		POINT2D p1 = datum_get_point2d(temporalinst_value(start1));
-		POINT2D p2 = datum_get_point2d(temporalinst_value(end1));
-		POINT2D p3 = datum_get_point2d(temporalinst_value(start2));
-		POINT2D p4 = datum_get_point2d(temporalinst_value(end2));
-		/* The following basically computes d/dx (Euclidean distance) = 0.
-		   To reduce problems related to floating point arithmetic, t1 and t2
-		   are shifted, respectively, to 0 and 1 before computing d/dx */
-		double dx1 = p2.x - p1.x;
-		double dy1 = p2.y - p1.y;
-		double dx2 = p4.x - p3.x;
-		double dy2 = p4.y - p3.y;
-		
-		double f1 = p3.x * (dx1 - dx2);
-		double f2 = p1.x * (dx2 - dx1);
-		double f3 = p3.y * (dy1 - dy2);
-		double f4 = p1.y * (dy2 - dy1);
-
 		denum = dx1*(dx1-2*dx2) + dy1*(dy1-2*dy2) + dy2*dy2 + dx2*dx2;
 		/* If the segments are parallel */
 		if (denum == 0)
 			return false;
 
-		fraction = (f1 + f2 + f3 + f4) / denum;
+		*fraction = (f1 + f2 + f3 + f4) / denum;
 	}
-	if (fraction <= EPSILON || fraction >= (1.0 - EPSILON))
+	if (*fraction <= EPSILON || *fraction >= (1.0 - EPSILON))
+		return false;
+	return true;
+}
+
+/* Decode the coordinates of a temporal point instant */
+
+static void
+tpointinst_coords(TemporalInst *inst, bool hasz, double *coords)
+{
+	if (hasz)
+	{
+		POINT3DZ p = datum_get_point3dz(temporalinst_value(inst));
+		coords[0] = p.x; coords[1] = p.y; coords[2] = p.z;
+	}
+	else
+	{
+		POINT2D p = datum_get_point2d(temporalinst_value(inst));
+		coords[0] = p.x; coords[1] = p.y;
+	}
+}
+
+/* 
+ * Find the single timestamptz at which two temporal point segments are at the
+ * minimum distance. This function is used for computing temporal distance.
+ * The function assumes that the two segments are not both constants.
+ */
+bool
+tpointseq_min_dist_at_timestamp(TemporalInst *start1, TemporalInst *end1, 
+	TemporalInst *start2, TemporalInst *end2, TimestampTz *t)
+{
+	bool hasz = MOBDB_FLAGS_GET_Z(start1->flags);
+	double p1[3], p2[3], p3[3], p4[3], fraction;
+	tpointinst_coords(start1, hasz, p1);
+	tpointinst_coords(end1, hasz, p2);
+	tpointinst_coords(start2, hasz, p3);
+	tpointinst_coords(end2, hasz, p4);
+	if (!tpoint_min_dist_at_fraction(p1, p2, p3, p4, hasz, &fraction))
 		return false;
 	*t = start1->t + (long) ((double)(end1->t - start1->t) * fraction);
 	return true;
 }
 
+/*****************************************************************************
+ * Distance kernel for temporal geometry points with linear interpolation
+ *
+ * The coordinates of the sequences are decoded once into contiguous arrays
+ * of doubles. The distance is then computed in closed form at each
+ * synchronization timestamp and at the turning points between them, instead
+ * of lifting the PostGIS distance function over interpolated geometries.
+ *****************************************************************************/
+
+/* Decode the timestamps and coordinates of a temporal point sequence */
+
+static void
+tpointseq_coords(TemporalSeq *seq, bool hasz, TimestampTz *times,
+	double *coords)
+{
+	int dim = hasz ? 3 : 2;
+	for (int i = 0; i < seq->count; i++)
+	{
+		TemporalInst *inst = temporalseq_inst_n(seq, i);
+		times[i] = inst->t;
+		tpointinst_coords(inst, hasz, &coords[dim * i]);
+	}
+}
+
+/*
+ * Coordinates of a decoded sequence at a timestamp. The argument pos is the
+ * segment from which the search starts, it is advanced to the segment
+ * containing the timestamp so that successive calls with increasing
+ * timestamps scan the sequence only once.
+ */
+static void
+tpointseq_coords_at_timestamp(const TimestampTz *times, const double *coords,
+	int count, int dim, int *pos, TimestampTz t, double *result)
+{
+	int i = *pos;
+	while (i < count - 1 && times[i + 1] <= t)
+		i++;
+	*pos = i;
+	const double *start = &coords[dim * i];
+	if (i == count - 1 || times[i] == t)
+	{
+		for (int d = 0; d < dim; d++)
+			result[d] = start[d];
+		return;
+	}
+	const double *end = &coords[dim * (i + 1)];
+	double ratio = (double) (t - times[i]) / (double) (times[i + 1] - times[i]);
+	for (int d = 0; d < dim; d++)
+		result[d] = start[d] + (end[d] - start[d]) * ratio;
+}
+
+/* Euclidean distance between two points given by their coordinates */
+
+static double
+coords_distance(const double *p1, const double *p2, int dim)
+{
+	double result = 0;
+	for (int d = 0; d < dim; d++)
+		result += (p2[d] - p1[d]) * (p2[d] - p1[d]);
+	return sqrt(result);
+}
+
+/*
+ * Walk the synchronization timestamps of two temporal geometry point
+ * sequences during their common period and compute the distance at each of
+ * them and at the turning points between them. If instants is not NULL the
+ * distance instants are stored in it and their number is returned. The
+ * minimum distance and the first timestamp at which it is reached are
+ * returned in the last arguments, when the instants are not requested the
+ * walk stops as soon as the distance is less than or equal to stopdist.
+ */
+static int
+distance_tpointseq_tpointseq1(TemporalSeq *seq1, TemporalSeq *seq2, 
+	bool hasz, Period *inter, TemporalInst **instants, double stopdist,
+	double *mindist, TimestampTz *mint)
+{
+	int dim = hasz ? 3 : 2;
+	int count1 = seq1->count, count2 = seq2->count;
+	TimestampTz *times1 = palloc(sizeof(TimestampTz) * (count1 + count2));
+	TimestampTz *times2 = times1 + count1;
+	double *coords1 = palloc(sizeof(double) * dim * (count1 + count2));
+	double *coords2 = coords1 + dim * count1;
+	tpointseq_coords(seq1, hasz, times1, coords1);
+	tpointseq_coords(seq2, hasz, times2, coords2);
+
+	double p1[3], p2[3], prev1[3], prev2[3], dist;
+	TimestampTz t = inter->lower, prevt = 0; /* make compiler quiet */
+	int i = 0, j = 0, k = 0;
+	bool first = true;
+	*mindist = DBL_MAX;
+	while (true)
+	{
+		tpointseq_coords_at_timestamp(times1, coords1, count1, dim, &i, t, p1);
+		tpointseq_coords_at_timestamp(times2, coords2, count2, dim, &j, t, p2);
+		/* If not the first timestamp compute the distance at the potential
+		   turning point before adding the new instant */
+		double fraction;
+		if (!first && 
+			tpoint_min_dist_at_fraction(prev1, p1, prev2, p2, hasz, &fraction))
+		{
+			TimestampTz intertime = prevt + (long) ((double)(t - prevt) * fraction);
+			double ratio = (double) (intertime - prevt) / (double) (t - prevt);
+			double inter1[3], inter2[3];
+			for (int d = 0; d < dim; d++)
+			{
+				inter1[d] = prev1[d] + (p1[d] - prev1[d]) * ratio;
+				inter2[d] = prev2[d] + (p2[d] - prev2[d]) * ratio;
+			}
+			dist = coords_distance(inter1, inter2, dim);
+			if (instants != NULL)
+				instants[k++] = temporalinst_make(Float8GetDatum(dist),
+					intertime, FLOAT8OID);
+			if (dist < *mindist)
+			{
+				*mindist = dist;
+				*mint = intertime;
+			}
+		}
+		dist = coords_distance(p1, p2, dim);
+		if (instants != NULL)
+			instants[k++] = temporalinst_make(Float8GetDatum(dist), t, FLOAT8OID);
+		if (dist < *mindist)
+		{
+			*mindist = dist;
+			*mint = t;
+		}
+		if (timestamp_cmp_internal(t, inter->upper) == 0 ||
+			(instants == NULL && *mindist <= stopdist))
+			break;
+		first = false;
+		memcpy(prev1, p1, sizeof(double) * dim);
+		memcpy(prev2, p2, sizeof(double) * dim);
+		prevt = t;
+		/* Next synchronization timestamp */
+		t = inter->upper;
+		if (i < count1 - 1 && timestamp_cmp_internal(times1[i + 1], t) < 0)
+			t = times1[i + 1];
+		if (j < count2 - 1 && timestamp_cmp_internal(times2[j + 1], t) < 0)
+			t = times2[j + 1];
+	}
+	pfree(times1); pfree(coords1);
+	return k;
+}
+
+static TemporalSeq *
+distance_tpointseq_tpointseq(TemporalSeq *seq1, TemporalSeq *seq2, bool hasz)
+{
+	/* Test whether the bounding period of the two temporal values overlap */
+	Period *inter = intersection_period_period_internal(&seq1->period, 
+		&seq2->period);
+	if (inter == NULL)
+		return NULL;
+
+	/* Each synchronization timestamp may be preceded by a turning point */
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * 
+		(seq1->count + seq2->count) * 2);
+	double mindist;
+	TimestampTz mint;
+	int count = distance_tpointseq_tpointseq1(seq1, seq2, hasz, inter,
+		instants, 0, &mindist, &mint);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, count, 
+		inter->lower_inc, inter->upper_inc, true, true);
+	for (int i = 0; i < count; i++)
+		pfree(instants[i]);
+	pfree(instants); pfree(inter);
+	return result;
+}
+
+static TemporalS *
+distance_tpoints_tpointseq(TemporalS *ts, TemporalSeq *seq, bool hasz)
+{
+	/* Test whether the bounding period of the two temporal values overlap */
+	Period p;
+	temporals_period(&p, ts);
+	if (!overlaps_period_period_internal(&seq->period, &p))
+		return NULL;
+	
+	int n;
+	temporals_find_timestamp(ts, seq->period.lower, &n);
+	/* We are sure that n < ts->count due to the bounding period test above */
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * (ts->count - n));
+	int k = 0;
+	for (int i = n; i < ts->count; i++)
+	{
+		TemporalSeq *seq1 = temporals_seq_n(ts, i);
+		TemporalSeq *seq2 = distance_tpointseq_tpointseq(seq1, seq, hasz);
+		if (seq2 != NULL)
+			sequences[k++] = seq2;
+		if (timestamp_cmp_internal(seq->period.upper, seq1->period.upper) < 0 ||
+			(timestamp_cmp_internal(seq->period.upper, seq1->period.upper) == 0 &&
+			(!seq->period.upper_inc || seq1->period.upper_inc)))
+			break;
+	}
+	if (k == 0)
+	{
+		pfree(sequences);
+		return NULL;
+	}
+	
+	TemporalS *result = temporals_from_temporalseqarr(sequences, k,
+		true, false);
+	for (int i = 0; i < k; i++) 
+		pfree(sequences[i]);
+	pfree(sequences);
+	return result;
+}
+
+static TemporalS *
+distance_tpoints_tpoints(TemporalS *ts1, TemporalS *ts2, bool hasz)
+{
+	/* Test whether the bounding period of the two temporal values overlap */
+	Period p1, p2;
+	temporals_period(&p1, ts1);
+	temporals_period(&p2, ts2);
+	if (!overlaps_period_period_internal(&p1, &p2))
+		return NULL;
+	
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * 
+		(ts1->count + ts2->count));
+	int i = 0, j = 0, k = 0;
+	while (i < ts1->count && j < ts2->count)
+	{
+		TemporalSeq *seq1 = temporals_seq_n(ts1, i);
+		TemporalSeq *seq2 = temporals_seq_n(ts2, j);
+		TemporalSeq *seq = distance_tpointseq_tpointseq(seq1, seq2, hasz);
+		if (seq != NULL)
+			sequences[k++] = seq;
+		int cmp = timestamp_cmp_internal(seq1->period.upper, seq2->period.upper);
+		if (cmp == 0)
+		{
+			if (!seq1->period.upper_inc && seq2->period.upper_inc)
+				cmp = -1;
+			else if (seq1->period.upper_inc && !seq2->period.upper_inc)
+				cmp = 1;
+		}
+		if (cmp == 0)
+		{
+			i++; j++;
+		}
+		else if (cmp < 0)
+			i++; 
+		else 
+			j++;
+	}
+	if (k == 0)
+	{
+		pfree(sequences); 
+		return NULL;
+	}
+	
+	TemporalS *result = temporals_from_temporalseqarr(sequences, k,
+		true, false);
+	for (i = 0; i < k; i++)
+		pfree(sequences[i]);
+	pfree(sequences); 
+	return result;
+}
+
+/*
+ * Lower bound of the distance between two temporal points given by the
+ * distance between the spatial extent of their bounding boxes
+ */
+static double
+stbox_min_dist(const STBOX *box1, const STBOX *box2, bool hasz)
+{
+	double dx = Max(0, Max(box1->xmin - box2->xmax, box2->xmin - box1->xmax));
+	double dy = Max(0, Max(box1->ymin - box2->ymax, box2->ymin - box1->ymax));
+	double dz = hasz ?
+		Max(0, Max(box1->zmin - box2->zmax, box2->zmin - box1->zmax)) : 0;
+	return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/* N-th sequence of a temporal sequence or sequence set */
+
+static TemporalSeq *
+tpoint_seq_n(Temporal *temp, int n)
+{
+	if (temp->duration == TEMPORALSEQ)
+		return (TemporalSeq *) temp;
+	return temporals_seq_n((TemporalS *) temp, n);
+}
+
+/*
+ * Minimum distance between two temporal geometry point sequences or sequence
+ * sets and the first timestamp at which it is reached, without computing the
+ * temporal distance. The pairs of sequences whose bounding boxes are farther
+ * apart than maxdist or than the best distance found so far are skipped, and 
+ * the search stops as soon as a distance less than or equal to stopdist is
+ * found. The minimum distance is DBL_MAX if all pairs were skipped. Returns
+ * false if the temporal points do not overlap in time.
+ */
+bool
+tpoint_min_dist_kernel(Temporal *temp1, Temporal *temp2, double maxdist,
+	double stopdist, double *mindist, TimestampTz *mint)
+{
+	bool hasz = MOBDB_FLAGS_GET_Z(temp1->flags);
+	int count1 = (temp1->duration == TEMPORALSEQ) ? 1 : ((TemporalS *) temp1)->count;
+	int count2 = (temp2->duration == TEMPORALSEQ) ? 1 : ((TemporalS *) temp2)->count;
+	bool overlap = false;
+	*mindist = DBL_MAX;
+	int i = 0, j = 0;
+	while (i < count1 && j < count2)
+	{
+		TemporalSeq *seq1 = tpoint_seq_n(temp1, i);
+		TemporalSeq *seq2 = tpoint_seq_n(temp2, j);
+		Period *inter = intersection_period_period_internal(&seq1->period, 
+			&seq2->period);
+		if (inter != NULL)
+		{
+			overlap = true;
+			double boxdist = stbox_min_dist(temporalseq_bbox_ptr(seq1),
+				temporalseq_bbox_ptr(seq2), hasz);
+			if (boxdist <= maxdist && boxdist < *mindist)
+			{
+				double dist;
+				TimestampTz t;
+				distance_tpointseq_tpointseq1(seq1, seq2, hasz, inter, NULL,
+					stopdist, &dist, &t);
+				if (dist < *mindist)
+				{
+					*mindist = dist;
+					*mint = t;
+				}
+			}
+			pfree(inter);
+			if (*mindist <= stopdist)
+				break;
+		}
+		int cmp = timestamp_cmp_internal(seq1->period.upper, seq2->period.upper);
+		if (cmp == 0)
+		{
+			if (!seq1->period.upper_inc && seq2->period.upper_inc)
+				cmp = -1;
+			else if (seq1->period.upper_inc && !seq2->period.upper_inc)
+				cmp = 1;
+		}
+		if (cmp == 0)
+		{
+			i++; j++;
+		}
+		else if (cmp < 0)
+			i++; 
+		else 
+			j++;
+	}
+	return overlap;
+}
+
 /*****************************************************************************
  * Temporal distance
  *****************************************************************************/
@@ -266,7 +974,7 @@ distance_geo_tpoint(PG_FUNCTION_ARGS)
 			func = &geom_distance2d;
 	}
 	else
-		func = &geog_distance;
+		func = geodetic_fast_path ? &geog_distance_sphere : &geog_distance;
 
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
@@ -316,7 +1024,7 @@ distance_tpoint_geo(PG_FUNCTION_ARGS)
 			func = &geom_distance2d;
 	}
 	else
-		func = &geog_distance;
+		func = geodetic_fast_path ? &geog_distance_sphere : &geog_distance;
 
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
@@ -340,9 +1048,43 @@ distance_tpoint_geo(PG_FUNCTION_ARGS)
 
 /*****************************************************************************/
 
+/*
+ * Returns true if the distance between the two temporal points can be
+ * computed with the kernel on the decoded coordinates, that is, if they are
+ * temporal geometry point sequences or sequence sets with linear 
+ * interpolation
+ */
+bool
+tpoint_distance_kernel(Temporal *temp1, Temporal *temp2)
+{
+	return temp1->valuetypid == type_oid(T_GEOMETRY) &&
+		MOBDB_FLAGS_GET_LINEAR(temp1->flags) && 
+		MOBDB_FLAGS_GET_LINEAR(temp2->flags) &&
+		(temp1->duration == TEMPORALSEQ || temp1->duration == TEMPORALS) &&
+		(temp2->duration == TEMPORALSEQ || temp2->duration == TEMPORALS);
+}
+
 Temporal *
 distance_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2)
 {
+	/* Temporal geometry points with linear interpolation use the distance
+	 * kernel on the decoded coordinates */
+	if (tpoint_distance_kernel(temp1, temp2))
+	{
+		bool hasz = MOBDB_FLAGS_GET_Z(temp1->flags);
+		if (temp1->duration == TEMPORALSEQ && temp2->duration == TEMPORALSEQ)
+			return (Temporal *)distance_tpointseq_tpointseq(
+				(TemporalSeq *)temp1, (TemporalSeq *)temp2, hasz);
+		if (temp1->duration == TEMPORALS && temp2->duration == TEMPORALSEQ)
+			return (Temporal *)distance_tpoints_tpointseq(
+				(TemporalS *)temp1, (TemporalSeq *)temp2, hasz);
+		if (temp1->duration == TEMPORALSEQ && temp2->duration == TEMPORALS)
+			return (Temporal *)distance_tpoints_tpointseq(
+				(TemporalS *)temp2, (TemporalSeq *)temp1, hasz);
+		return (Temporal *)distance_tpoints_tpoints(
+			(TemporalS *)temp1, (TemporalS *)temp2, hasz);
+	}
+
 	Datum (*func)(Datum, Datum);
 	if (temp1->valuetypid == type_oid(T_GEOMETRY))
 	{
@@ -363,6 +1105,29 @@ distance_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2)
 	return result;
 }
 
+/*
+ * Nearest approach distance between two temporal points and the first 
+ * timestamp at which it is reached. Returns false if the temporal points do
+ * not overlap in time. The temporal distance is only computed when the
+ * kernel on the decoded coordinates cannot be used.
+ */
+bool
+NAD_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2, double *mindist,
+	TimestampTz *mint)
+{
+	if (tpoint_distance_kernel(temp1, temp2))
+		return tpoint_min_dist_kernel(temp1, temp2, DBL_MAX, 0, mindist, mint);
+
+	Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
+	if (dist == NULL)
+		return false;
+	*mindist = DatumGetFloat8(temporal_min_value_internal(dist));
+	Temporal *atmin = temporal_at_min_internal(dist);
+	*mint = temporal_start_timestamp_internal(atmin);
+	pfree(dist); pfree(atmin);
+	return true;
+}
+
 PG_FUNCTION_INFO_V1(distance_tpoint_tpoint);
 
 PGDLLEXPORT Datum
@@ -12,6 +12,7 @@
 
 #include "tpoint_gist.h"
 
+#include <math.h>
 #include <utils/timestamp.h>
 #include <access/gist.h>
 
@@ -20,6 +21,7 @@
 #include "tpoint.h"
 #include "tpoint_boxops.h"
 #include "tpoint_posops.h"
+#include "temporal_gist.h"
 
 /* Minimum accepted ratio of split */
 #define LIMIT_RATIO 0.3
@@ -33,6 +35,18 @@
 #define FLOAT8_MAX(a,b)  (FLOAT8_GT(a, b) ? (a) : (b))
 #define FLOAT8_MIN(a,b)  (FLOAT8_LT(a, b) ? (a) : (b))
 
+/*
+ * Values of the mobilitydb.index_time_weight, mobilitydb.index_time_unit,
+ * and mobilitydb.index_use_z parameters, which tune how the penalty and 
+ * picksplit methods weigh the time dimension with respect to the spatial
+ * ones and whether they take the Z dimension into account. The parameters
+ * only change the shape of the tree and not its keys, and thus they can 
+ * be changed at any time without changing the results of the queries.
+ */
+double index_time_weight = 1.0;
+int index_time_unit = 0;
+bool index_use_z = true;
+
 /*****************************************************************************
  * Leaf-level consistent method for temporal points using a stbox
  *****************************************************************************/
@@ -132,7 +146,7 @@ index_leaf_consistent_stbox(STBOX *key, STBOX *query, StrategyNumber strategy)
  * in the pg_amop table.
  *****************************************************************************/
 
-static bool
+bool
 gist_internal_consistent_stbox(STBOX *key, STBOX *query, StrategyNumber strategy)
 {
 	bool retval;
@@ -207,6 +221,22 @@ gist_internal_consistent_stbox(STBOX *key, STBOX *query, StrategyNumber strategy
  * GiST consistent method for temporal points
  *****************************************************************************/
 
+/*
+ * Convert a geometry, geography, or temporal point query into a box. 
+ * Returns false for an empty geometry, in which case all dimensions of the 
+ * box are set to infinity.
+ */
+bool
+tpoint_query_box(void *box, Datum query, Oid subtype)
+{
+	if (temporal_type_oid(subtype))
+		return temporal_query_box(box, query, subtype);
+	GSERIALIZED *gs = (GSERIALIZED *) PG_DETOAST_DATUM(query);
+	bool result = geo_to_stbox_internal((STBOX *) box, gs);
+	POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(query));
+	return result;
+}
+
 /*
  * Determine whether a recheck is necessary depending on the strategy
  */
@@ -240,6 +270,7 @@ PG_FUNCTION_INFO_V1(gist_tpoint_consistent);
 PGDLLEXPORT Datum
 gist_tpoint_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
 	StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
 	Oid subtype = PG_GETARG_OID(3);
@@ -257,11 +288,13 @@ gist_tpoint_consistent(PG_FUNCTION_ARGS)
 	 * Transform the query into a box initializing the dimensions that must
 	 * not be taken into account by the operators to infinity.
 	 */
-	if (subtype == type_oid(T_GEOMETRY) || subtype == type_oid(T_GEOGRAPHY))
+	if (subtype == type_oid(T_GEOMETRY) || subtype == type_oid(T_GEOGRAPHY) ||
+		temporal_type_oid(subtype))
 	{
 		/* Since function gist_tpoint_consistent is strict, query is not NULL */
-		if (!geo_to_stbox_internal(&query, PG_GETARG_GSERIALIZED_P(1)))
-			PG_RETURN_BOOL(false);										  
+		if (!index_query_box(fcinfo->flinfo, PG_GETARG_DATUM(1), subtype,
+				&tpoint_query_box, sizeof(STBOX), &query))
+			PG_RETURN_BOOL(false);
 	}
 	else if (subtype == type_oid(T_STBOX))
 	{
@@ -270,14 +303,6 @@ gist_tpoint_consistent(PG_FUNCTION_ARGS)
 			PG_RETURN_BOOL(false);
 		memcpy(&query, box, sizeof(STBOX));
 	}
-	else if (temporal_type_oid(subtype))
-	{
-		Temporal *temp = PG_GETARG_TEMPORAL(1);
-		if (temp == NULL)
-			PG_RETURN_BOOL(false);
-		temporal_bbox(&query, temp);
-		PG_FREE_IF_COPY(temp, 1);
-	}
 	else
 		elog(ERROR, "unrecognized strategy number: %d", strategy);
 	
@@ -289,6 +314,78 @@ gist_tpoint_consistent(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(result);
 }
 
+/*****************************************************************************
+ * Distance method
+ *****************************************************************************/
+
+/*
+ * Minimum distance between the spatial dimensions of two boxes. If the
+ * query has a time dimension, the distance is infinite when the boxes do
+ * not overlap in time, since the nearest approach distance is then NULL.
+ */
+static double
+stbox_distance(const STBOX *key, const STBOX *query)
+{
+	if (MOBDB_FLAGS_GET_T(query->flags) &&
+		(timestamp_cmp_internal(key->tmin, query->tmax) > 0 ||
+		 timestamp_cmp_internal(query->tmin, key->tmax) > 0))
+		return get_float8_infinity();
+
+	double dx = 0.0, dy = 0.0, dz = 0.0;
+	if (key->xmax < query->xmin)
+		dx = query->xmin - key->xmax;
+	else if (query->xmax < key->xmin)
+		dx = key->xmin - query->xmax;
+	if (key->ymax < query->ymin)
+		dy = query->ymin - key->ymax;
+	else if (query->ymax < key->ymin)
+		dy = key->ymin - query->ymax;
+	if (MOBDB_FLAGS_GET_Z(key->flags) && MOBDB_FLAGS_GET_Z(query->flags))
+	{
+		if (key->zmax < query->zmin)
+			dz = query->zmin - key->zmax;
+		else if (query->zmax < key->zmin)
+			dz = key->zmin - query->zmax;
+	}
+	return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/*
+ * The GiST distance method for temporal points. The distance between the
+ * bounding boxes is a lower bound of the nearest approach distance and
+ * thus the result must always be rechecked, also for leaf entries.
+ */
+PG_FUNCTION_INFO_V1(gist_tpoint_distance);
+
+PGDLLEXPORT Datum
+gist_tpoint_distance(PG_FUNCTION_ARGS)
+{
+	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	Oid subtype = PG_GETARG_OID(3);
+	bool *recheck = (bool *) PG_GETARG_POINTER(4);
+	STBOX *key = (STBOX *)DatumGetPointer(entry->key), 
+		query;
+
+	*recheck = true;
+
+	if (key == NULL)
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	/* Transform the query into a box */
+	memset(&query, 0, sizeof(STBOX));
+	if (subtype == type_oid(T_GEOMETRY) || temporal_type_oid(subtype))
+	{
+		/* The nearest approach distance to an empty geometry is NULL */
+		if (!index_query_box(fcinfo->flinfo, PG_GETARG_DATUM(1), subtype,
+				&tpoint_query_box, sizeof(STBOX), &query))
+			PG_RETURN_FLOAT8(get_float8_infinity());
+	}
+	else
+		elog(ERROR, "unrecognized strategy number: %d", PG_GETARG_UINT16(2));
+
+	PG_RETURN_FLOAT8(stbox_distance(key, &query));
+}
+
 /*****************************************************************************
  * Union method
  *****************************************************************************/
@@ -296,7 +393,7 @@ gist_tpoint_consistent(PG_FUNCTION_ARGS)
 /*
  * Increase STBOX b to include addon.
  */
-static void
+void
 adjust_stbox(STBOX *b, const STBOX *addon)
 {
 	if (FLOAT8_LT(b->xmax, addon->xmax))
@@ -363,13 +460,40 @@ rt_stbox_union(STBOX *n, const STBOX *a, const STBOX *b)
 	n->tmin = timestamp_cmp_internal(a->tmin, b->tmin) < 0 ? a->tmin : b->tmin;
 }
 
+/*
+ * Size of the time dimension of a box for the penalty and picksplit methods,
+ * that is, its extent in the time unit given by the parameters raised to
+ * the time weight. A time unit of 0 keeps the extent in microseconds.
+ */
+static double
+index_time_size(TimestampTz tmin, TimestampTz tmax)
+{
+	double result = (double) (tmax - tmin);
+	if (index_time_unit > 0)
+		result /= (double) index_time_unit * USECS_PER_SEC;
+	if (index_time_weight != 1.0)
+		result = pow(result, index_time_weight);
+	return result;
+}
+
 /*
  * Size of a stbox for penalty-calculation purposes.
  * The result can be +Infinity, but not NaN.
+ *
+ * Only the dimensions present in the box are taken into account. Otherwise,
+ * the size of a box without Z dimension (or without X or T dimension) is
+ * always zero, all penalties are equal, and every new entry is inserted into
+ * the first subtree, which makes index creation very slow and produces
+ * badly clustered pages.
  */
 static double
 size_stbox(const STBOX *box)
 {
+	bool hasx = MOBDB_FLAGS_GET_X(box->flags),
+		hasz = MOBDB_FLAGS_GET_Z(box->flags) && index_use_z,
+		hast = MOBDB_FLAGS_GET_T(box->flags);
+	double result = 1.0;
+
 	/*
 	 * Check for zero-width cases.  Note that we define the size of a zero-
 	 * by-infinity box as zero.  It's important to special-case this somehow,
@@ -377,9 +501,10 @@ size_stbox(const STBOX *box)
 	 *
 	 * The less-than cases should not happen, but if they do, say "zero".
 	 */
-	if (FLOAT8_LE(box->xmax, box->xmin) || FLOAT8_LE(box->ymax, box->ymin) ||
-		FLOAT8_LE(box->zmax, box->zmin) ||
-		timestamp_cmp_internal(box->tmax, box->tmin) <= 0)
+	if ((hasx && (FLOAT8_LE(box->xmax, box->xmin) ||
+			FLOAT8_LE(box->ymax, box->ymin))) ||
+		(hasz && FLOAT8_LE(box->zmax, box->zmin)) ||
+		(hast && timestamp_cmp_internal(box->tmax, box->tmin) <= 0))
 		return 0.0;
 	
 	/*
@@ -387,10 +512,16 @@ size_stbox(const STBOX *box)
 	 * and a non-NaN is infinite.  Note the previous check eliminated the
 	 * possibility that the low fields are NaNs.
 	 */
-	if (isnan(box->xmax) || isnan(box->ymax) || isnan(box->zmax))
+	if ((hasx && (isnan(box->xmax) || isnan(box->ymax))) ||
+		(hasz && isnan(box->zmax)))
 		return get_float8_infinity();
-	return (box->xmax - box->xmin) * (box->ymax - box->ymin) * 
-		(box->zmax - box->zmin) * (box->tmax - box->tmin);
+	if (hasx)
+		result *= (box->xmax - box->xmin) * (box->ymax - box->ymin);
+	if (hasz)
+		result *= (box->zmax - box->zmin);
+	if (hast)
+		result *= index_time_size(box->tmin, box->tmax);
+	return result;
 }
 
 /*
@@ -401,9 +532,24 @@ static double
 stbox_penalty(const STBOX *original, const STBOX *new)
 {
 	STBOX			unionbox;
+
+	/*
+	 * Fast path for the common case on the upper levels of the tree where
+	 * the new box is already contained in the original one
+	 */
+	if (FLOAT8_LE(original->xmin, new->xmin) &&
+		FLOAT8_GE(original->xmax, new->xmax) &&
+		FLOAT8_LE(original->ymin, new->ymin) &&
+		FLOAT8_GE(original->ymax, new->ymax) &&
+		FLOAT8_LE(original->zmin, new->zmin) &&
+		FLOAT8_GE(original->zmax, new->zmax) &&
+		timestamp_cmp_internal(original->tmin, new->tmin) <= 0 &&
+		timestamp_cmp_internal(original->tmax, new->tmax) >= 0)
+		return 0.0;
 	
 	memset(&unionbox, 0, sizeof(STBOX));
 	rt_stbox_union(&unionbox, original, new);
+	unionbox.flags = original->flags;
 	return size_stbox(&unionbox) - size_stbox(original);
 }
 
@@ -625,6 +771,11 @@ g_stbox_consider_split(ConsiderSplitContext *context, int dimNum,
 			range = context->boundingBox.tmax - context->boundingBox.tmin;
 		
 		overlap = (float4) ((leftUpper - rightLower) / range);
+
+		/* The ranges are compared across dimensions in comparable units */
+		if (dimNum == 3)
+			range = index_time_size(context->boundingBox.tmin,
+				context->boundingBox.tmax);
 		
 		/* If there is no previous selection, select this */
 		if (context->first)
@@ -763,9 +914,9 @@ gist_tpoint_picksplit(PG_FUNCTION_ARGS)
 			adjust_stbox(&context.boundingBox, box);
 	}
 
-	/* Determine whether there is a Z dimension */
+	/* Determine whether the Z dimension must be considered */
 	box = (STBOX *)DatumGetPointer(entryvec->vector[FirstOffsetNumber].key);
-	hasz = MOBDB_FLAGS_GET_Z(box->flags);
+	hasz = MOBDB_FLAGS_GET_Z(box->flags) && index_use_z;
 	
 	/*
 	 * Iterate over axes for optimal split searching.
@@ -1132,6 +1283,21 @@ gist_tpoint_same(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Fetch method for boxes
+ * The keys of an index on a stbox column are the values themselves, which
+ * enables index-only scans
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(gist_stbox_fetch);
+
+PGDLLEXPORT Datum
+gist_stbox_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	PG_RETURN_POINTER(entry);
+}
+
 /*****************************************************************************
  * GiST Compress methods for temporal points
  *****************************************************************************/
@@ -1155,4 +1321,121 @@ gist_tpoint_compress(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(entry);
 }
 
+/*****************************************************************************
+ * GiST methods for geodetic temporal points using longitude/latitude boxes
+ *
+ * The keys of these indexes are the longitude/latitude/time boxes obtained
+ * by projecting the geocentric boxes of the values onto the sphere, which
+ * are much tighter than the geocentric boxes for thin trajectories. Keys 
+ * crossing the antimeridian have a maximum longitude beyond 180, and thus
+ * the union, penalty, picksplit, and same methods of the geocentric index
+ * can be used unchanged. Since the projection of a box contains the
+ * projection of any point in it, the keys of two boxes overlap whenever 
+ * the boxes overlap, and all spatial strategies reduce to an overlap test
+ * followed by a recheck.
+ *****************************************************************************/
+
+/*
+ * Overlap test between longitude/latitude boxes, where the longitudes of
+ * the query are also tested shifted by one turn on both sides
+ */
+static bool
+overlaps_latlon_internal(const STBOX *key, const STBOX *query)
+{
+	if (MOBDB_FLAGS_GET_X(query->flags))
+	{
+		if (key->ymax < query->ymin || key->ymin > query->ymax)
+			return false;
+		if ((key->xmax < query->xmin || key->xmin > query->xmax) &&
+			(key->xmax < query->xmin + 360.0 || key->xmin > query->xmax + 360.0) &&
+			(key->xmax < query->xmin - 360.0 || key->xmin > query->xmax - 360.0))
+			return false;
+	}
+	if (MOBDB_FLAGS_GET_T(query->flags))
+		if (key->tmax < query->tmin || key->tmin > query->tmax)
+			return false;
+	return true;
+}
+
+PG_FUNCTION_INFO_V1(gist_tgeogpoint_latlon_consistent);
+
+PGDLLEXPORT Datum
+gist_tgeogpoint_latlon_consistent(PG_FUNCTION_ARGS)
+{
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
+	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+	Oid subtype = PG_GETARG_OID(3);
+	bool *recheck = (bool *) PG_GETARG_POINTER(4), result;
+	STBOX *key = (STBOX *)DatumGetPointer(entry->key), 
+		box, query;
+
+	*recheck = true;
+
+	if (key == NULL)
+		PG_RETURN_BOOL(false);
+
+	memset(&box, 0, sizeof(STBOX));
+	if (subtype == type_oid(T_GEOGRAPHY) || temporal_type_oid(subtype))
+	{
+		if (!index_query_box(fcinfo->flinfo, PG_GETARG_DATUM(1), subtype,
+				&tpoint_query_box, sizeof(STBOX), &box))
+			PG_RETURN_BOOL(false);
+	}
+	else if (subtype == type_oid(T_STBOX))
+		memcpy(&box, PG_GETARG_STBOX_P(1), sizeof(STBOX));
+	else
+		elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+	/* Map the spatial dimension of the query to longitude/latitude */
+	if (MOBDB_FLAGS_GET_X(box.flags))
+		stbox_latlon_internal(&query, &box);
+	else
+		memcpy(&query, &box, sizeof(STBOX));
+
+	switch (strategy)
+	{
+		case RTOverlapStrategyNumber:
+		case RTContainedByStrategyNumber:
+		case RTContainsStrategyNumber:
+		case RTSameStrategyNumber:
+			result = overlaps_latlon_internal(key, &query);
+			break;
+		default:
+			/* The remaining strategies only consider the time dimension */
+			if (GIST_LEAF(entry))
+				result = index_leaf_consistent_stbox(key, &query, strategy);
+			else
+				result = gist_internal_consistent_stbox(key, &query, strategy);
+			break;
+	}
+	PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(gist_tgeogpoint_latlon_compress);
+
+PGDLLEXPORT Datum
+gist_tgeogpoint_latlon_compress(PG_FUNCTION_ARGS)
+{
+	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	if (entry->leafkey)
+	{
+		GISTENTRY *retval = palloc(sizeof(GISTENTRY));
+		Temporal *temp = DatumGetTemporal(entry->key);
+		STBOX box, *key = palloc0(sizeof(STBOX));
+		memset(&box, 0, sizeof(STBOX));
+		temporal_bbox(&box, temp);
+		stbox_latlon_internal(key, &box);
+		/* Absorb the rounding errors of the trigonometric functions */
+		key->xmin -= EPSILON;
+		key->xmax += EPSILON;
+		key->ymin -= EPSILON;
+		key->ymax += EPSILON;
+		gistentryinit(*retval, PointerGetDatum(key), entry->rel, entry->page, 
+			entry->offset, false);
+		PG_RETURN_POINTER(retval);
+	}
+	PG_RETURN_POINTER(entry);
+}
+
 /*****************************************************************************/
@@ -22,6 +22,39 @@
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
 
+/*****************************************************************************
+ * Construction of the instants of the input functions
+ *****************************************************************************/
+
+/**
+* Return an instant of temporal geometric point with the given SRID and 
+* dimension. The instants read by the input functions are copies of this 
+* template where only the timestamp and the coordinates are overwritten, 
+* which avoids serializing a new point for every instant.
+*/
+static TemporalInst *
+tpointinst_template(int32 srid, bool hasz)
+{
+	LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, 0, 0, 0) :
+		lwpoint_make2d(srid, 0, 0);
+	GSERIALIZED *gs = geometry_serialize((LWGEOM *) lwpoint);
+	TemporalInst *result = temporalinst_make(PointerGetDatum(gs), 0, 
+		type_oid(T_GEOMETRY));
+	lwpoint_free(lwpoint);
+	pfree(gs);
+	return result;
+}
+
+/**
+* Return a pointer to the coordinates of the point of an instant
+*/
+static inline double *
+tpointinst_coords(TemporalInst *inst)
+{
+	return (double *) ((char *) inst + double_pad(sizeof(TemporalInst)) + 
+		offsetof(GSERIALIZED, data) + 8);
+}
+
 /*****************************************************************************
  * Input in MFJSON format 
  *****************************************************************************/
@@ -77,8 +110,11 @@ findMemberByName(json_object *poObj, const char *pszName )
 	return NULL;
 }
 
-static Datum
-parse_mfjson_coord(json_object *poObj)
+/**
+* Read the coordinates of a point into the array and return their number
+*/
+static int
+parse_mfjson_coord(json_object *poObj, double *coords)
 {
 	if (json_type_array != json_object_get_type(poObj))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
@@ -92,225 +128,150 @@ parse_mfjson_coord(json_object *poObj)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
 			errmsg("Too many coordinates in MFJSON string")));
 
-	double x, y, z;
-	Datum result;
-	json_object *poObjCoord = NULL;
-
-	/* Read X coordinate */
-	poObjCoord = json_object_array_get_idx(poObj, 0);
-	x = json_object_get_double(poObjCoord);
-
-	/* Read Y coordinate */
-	poObjCoord = json_object_array_get_idx(poObj, 1);
-	y = json_object_get_double(poObjCoord);
+	for (int i = 0; i < numcoord; i++)
+		coords[i] = json_object_get_double(json_object_array_get_idx(poObj, i));
+	return numcoord;
+}
 
-	if (numcoord == 3)
-	{
-		/* Read Z coordinate */
-		poObjCoord = json_object_array_get_idx(poObj, 2);
-		z = json_object_get_double(poObjCoord);
-		result = call_function3(LWGEOM_makepoint, Float8GetDatum(x),
-			Float8GetDatum(y), Float8GetDatum(z));
-	}
-	else 
-		result = call_function2(LWGEOM_makepoint, Float8GetDatum(x),
-			Float8GetDatum(y));
-	return result;
+/**
+* Read a timestamp in ISO 8601 format 
+*
+* The maximum length of a datetime is 32 characters, e.g.,
+*  "2019-08-06T18:35:48.021455+02:30" 
+*/
+static TimestampTz
+parse_mfjson_datetime(json_object *poObj)
+{
+	char str[33];
+	const char *strdatetime = json_object_get_string(poObj);
+	if (!strdatetime || strlen(strdatetime) < 11 || strlen(strdatetime) > 32)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+			errmsg("Invalid 'datetimes' value in MFJSON string")));
+	strcpy(str, strdatetime);
+	/* Replace 'T' by ' ' before converting to timestamptz */
+	str[10] = ' ';
+	return call_input(TIMESTAMPTZOID, str);
 }
 
-/* TODO MAKE POSSIBLE TO CALL THIS FUNCTION */
-static Datum *
-parse_mfjson_points(json_object *mfjson, int *count)
+/**
+* Return the member of the MFJSON object, which must be an array when 
+* isarray is true
+*/
+static json_object *
+parse_mfjson_member(json_object *mfjson, const char *name, bool isarray)
 {
-	json_object *mfjsonTmp = mfjson;
-	json_object *coordinates = NULL;
-	coordinates = findMemberByName(mfjsonTmp, "coordinates");
-	if (coordinates == NULL)
+	json_object *result = findMemberByName(mfjson, name);
+	if (result == NULL)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Unable to find 'coordinates' in MFJSON string")));
-	if (json_object_get_type(coordinates) != json_type_array)
+			errmsg("Unable to find '%s' in MFJSON string", name)));
+	if (isarray && json_object_get_type(result) != json_type_array)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Invalid 'coordinates' array in MFJSON string")));
+			errmsg("Invalid '%s' array in MFJSON string", name)));
+	return result;
+}
 
+/**
+* Read the instants given by the 'coordinates' and 'datetimes' arrays of 
+* the MFJSON object. Both arrays are traversed in lockstep and each pair 
+* is written directly into a copy of a template instant, so that no 
+* intermediate arrays of points and timestamps are built. The instants 
+* are allocated in a single chunk pointed to by the first element of the 
+* returned array.
+*/
+static TemporalInst **
+tpointinstarr_from_mfjson(json_object *mfjson, int32 srid, int *count)
+{
+	json_object *coordinates = parse_mfjson_member(mfjson, "coordinates", true);
+	json_object *datetimes = parse_mfjson_member(mfjson, "datetimes", true);
 	int numpoints = json_object_array_length(coordinates);
 	if (numpoints < 1)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
 			errmsg("Invalid value of 'coordinates' array in MFJSON string")));
-	
-	Datum *values = palloc(sizeof(Datum) * numpoints);
-	for (int i = 0; i < numpoints; ++i)
+	if (numpoints != json_object_array_length(datetimes))
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+			errmsg("Distinct number of elements in 'coordinates' and 'datetimes' arrays")));
+
+	/* The dimension of the first point determines the one of the template */
+	double coords[3];
+	int ndims = parse_mfjson_coord(json_object_array_get_idx(coordinates, 0), 
+		coords);
+	TemporalInst *tmpl = tpointinst_template(srid, ndims == 3);
+	size_t instsize = VARSIZE(tmpl);
+	char *chunk = palloc(instsize * numpoints);
+	TemporalInst **result = palloc(sizeof(TemporalInst *) * numpoints);
+	for (int i = 0; i < numpoints; i++)
 	{
-		json_object *coords = NULL;
-		coords = json_object_array_get_idx(coordinates, i);
-		values[i] = parse_mfjson_coord(coords);
+		if (i > 0 && parse_mfjson_coord(json_object_array_get_idx(coordinates, i),
+				coords) != ndims)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+				errmsg("Mixed 2D and 3D coordinates in MFJSON string")));
+		TemporalInst *inst = (TemporalInst *) (chunk + i * instsize);
+		memcpy(inst, tmpl, instsize);
+		memcpy(tpointinst_coords(inst), coords, sizeof(double) * ndims);
+		inst->t = parse_mfjson_datetime(json_object_array_get_idx(datetimes, i));
+		result[i] = inst;
 	}
+	pfree(tmpl);
 	*count = numpoints;
-	return values;
+	return result;
 }
-/* */
 
-static TimestampTz *
-parse_mfjson_datetimes(json_object *mfjson, int *count)
+/**
+* Read the bounds of a sequence
+*/
+static void
+parse_mfjson_bounds(json_object *mfjson, bool *lower_inc, bool *upper_inc)
 {
-	json_object *datetimes = NULL;
-	datetimes = findMemberByName(mfjson, "datetimes");
-	if (datetimes == NULL)
-			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-				errmsg("Unable to find 'datetimes' in MFJSON string")));
-	if (json_object_get_type(datetimes) != json_type_array)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Invalid 'datetimes' array in MFJSON string")));
-
-	int numdates = json_object_array_length(datetimes);
-	if (numdates < 1)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Invalid value of 'datetimes' array in MFJSON string")));
-	
-	TimestampTz *times = palloc(sizeof(TimestampTz) * numdates);
-	for (int i = 0; i < numdates; i++)
-	{
-		char datetime[33];
-		json_object* datevalue = NULL;
-		datevalue = json_object_array_get_idx(datetimes, i);
-		const char *strdatevalue = json_object_get_string(datevalue);
-		if (strdatevalue)
-		{
-			strcpy(datetime, strdatevalue);
-			/* Replace 'T' by ' ' before converting to timestamptz */
-			datetime[10] = ' ';
-			times[i] = call_input(TIMESTAMPTZOID, datetime);
-		}
-	}
-	*count = numdates;
-	return times;
+	*lower_inc = (bool) json_object_get_boolean(
+		parse_mfjson_member(mfjson, "lower_inc", false));
+	*upper_inc = (bool) json_object_get_boolean(
+		parse_mfjson_member(mfjson, "upper_inc", false));
 }
 
 /*****************************************************************************/
 
 static TemporalInst *
-tpointinst_from_mfjson(json_object *mfjson)
+tpointinst_from_mfjson(json_object *mfjson, int32 srid)
 {
-	/* Get coordinates */
-	json_object *coordinates = findMemberByName(mfjson, "coordinates");
-	if (coordinates == NULL)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Unable to find 'coordinates' in MFJSON string")));
-	Datum value = parse_mfjson_coord(coordinates);
-
-	/* Get datetimes 
-	 * The maximum length of a datetime is 32 characters, e.g.,
-	 *  "2019-08-06T18:35:48.021455+02:30" 
-	 */
-	char str[33];
-	json_object *datetimes = findMemberByName(mfjson, "datetimes");
-	if (datetimes == NULL)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Unable to find 'datetimes' in MFJSON string")));
-	const char *strdatetimes = json_object_get_string(datetimes);
-	if (!strdatetimes)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Invalid 'datetimes' value in MFJSON string")));
-	strcpy(str, strdatetimes);
-	/* Replace 'T' by ' ' before converting to timestamptz */
-	str[10] = ' ';
-	TimestampTz t = call_input(TIMESTAMPTZOID, str);
-	TemporalInst *result = temporalinst_make(value, t, type_oid(T_GEOMETRY));
-	pfree(DatumGetPointer(value));
+	double coords[3];
+	int ndims = parse_mfjson_coord(
+		parse_mfjson_member(mfjson, "coordinates", false), coords);
+	TemporalInst *result = tpointinst_template(srid, ndims == 3);
+	memcpy(tpointinst_coords(result), coords, sizeof(double) * ndims);
+	result->t = parse_mfjson_datetime(
+		parse_mfjson_member(mfjson, "datetimes", false));
 	return result;
 }
 
 static TemporalI *
-tpointi_from_mfjson(json_object *mfjson)
+tpointi_from_mfjson(json_object *mfjson, int32 srid)
 {
-	Datum *values;
-
-	/* Get coordinates */
-	int numpoints;
-	values = parse_mfjson_points(mfjson, &numpoints);
-
-	/* Get datetimes */
-	int numdates;
-	TimestampTz *times = parse_mfjson_datetimes(mfjson, &numdates);
-
-	if (numpoints != numdates)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Distinct number of elements in 'coordinates' and 'datetimes' arrays")));
-
-	/* Construct the temporal point */
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * numpoints);
-	for (int i = 0; i < numpoints; i++)
-		instants[i] = temporalinst_make(values[i], times[i], type_oid(T_GEOMETRY));
-	TemporalI *result = temporali_from_temporalinstarr(instants, numpoints);
-
-	for (int i = 0; i < numpoints; i++)
-	{
-		pfree(instants[i]);
-		pfree(DatumGetPointer(values[i]));
-	}
+	int count;
+	TemporalInst **instants = tpointinstarr_from_mfjson(mfjson, srid, &count);
+	TemporalI *result = temporali_from_temporalinstarr(instants, count);
+	pfree(instants[0]);
 	pfree(instants);
 	return result;
 }
 
 static TemporalSeq *
-tpointseq_from_mfjson(json_object *mfjson, bool linear)
+tpointseq_from_mfjson(json_object *mfjson, int32 srid, bool linear)
 {
-	Datum *values;
-
-	/* Get coordinates */
-	int numpoints;
-	values = parse_mfjson_points(mfjson, &numpoints);
-
-	/* Get datetimes */
-	int numdates;
-	TimestampTz *times = parse_mfjson_datetimes(mfjson, &numdates);
-
-	if (numpoints != numdates)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Distinct number of elements in 'coordinates' and 'datetimes' arrays")));
-
-	json_object *lowerinc = NULL;
-	lowerinc = findMemberByName(mfjson, "lower_inc");
-	if (lowerinc == NULL)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Unable to find 'lower_inc' in MFJSON string")));
-	bool lower_inc = (bool) json_object_get_boolean(lowerinc);
-
-	json_object *upperinc = NULL;
-	upperinc = findMemberByName(mfjson, "upper_inc");
-	if (upperinc == NULL)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Unable to find 'upper_inc' in MFJSON string")));
-	bool upper_inc = (bool) json_object_get_boolean(upperinc);
-
-	/* Construct the temporal point */
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * numpoints);
-	for (int i = 0; i < numpoints; i++)
-		instants[i] = temporalinst_make(values[i], times[i], type_oid(T_GEOMETRY));
-	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, numpoints, 
+	int count;
+	TemporalInst **instants = tpointinstarr_from_mfjson(mfjson, srid, &count);
+	bool lower_inc, upper_inc;
+	parse_mfjson_bounds(mfjson, &lower_inc, &upper_inc);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, count, 
 		lower_inc, upper_inc, linear, true);
-
-	for (int i = 0; i < numpoints; i++)
-	{
-		pfree(instants[i]);
-		pfree(DatumGetPointer(values[i]));
-	}
+	pfree(instants[0]);
 	pfree(instants);
-	pfree(values);
-	pfree(times);
 	return result;
 }
 
 static TemporalS *
-tpoints_from_mfjson(json_object *mfjson, bool linear)
+tpoints_from_mfjson(json_object *mfjson, int32 srid, bool linear)
 {
-	json_object *seqs = NULL;
-	seqs = findMemberByName(mfjson, "sequences");
-	if (seqs == NULL)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Unable to find 'sequences' in MFJSON string")));
-	if (json_object_get_type(seqs) != json_type_array)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-			errmsg("Invalid 'sequences' array in MFJSON string")));
+	json_object *seqs = parse_mfjson_member(mfjson, "sequences", true);
 	int numseqs = json_object_array_length(seqs);
 	if (numseqs < 1)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
@@ -318,54 +279,8 @@ tpoints_from_mfjson(json_object *mfjson, bool linear)
 
 	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * numseqs);
 	for (int i = 0; i < numseqs; i++)
-	{
-		Datum *values;
-		TimestampTz *times;
-
-		json_object* seqvalue = NULL;
-		seqvalue = json_object_array_get_idx(seqs, i);
-
-		/* Get coordinates */
-		int numpoints;
-		values = parse_mfjson_points(seqvalue, &numpoints);
-		
-		/* Get datetimes */
-		int numdates;
-		times = parse_mfjson_datetimes(seqvalue, &numdates);
-
-		if (numpoints != numdates)
-			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-				errmsg("Distinct number of elements in 'coordinates' and 'datetimes'")));
-
-		json_object *lowerinc = NULL;
-		lowerinc = findMemberByName(seqvalue, "lower_inc");
-		if (lowerinc == NULL)
-			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-				errmsg("Unable to find 'lower_inc' in MFJSON string")));
-		bool lower_inc = (bool) json_object_get_boolean(lowerinc);
-
-		json_object *upperinc = NULL;
-		upperinc = findMemberByName(seqvalue, "upper_inc");
-		if (upperinc == NULL)
-			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
-				errmsg("Unable to find 'upper_inc' in MFJSON string")));
-		bool upper_inc = (bool) json_object_get_boolean(upperinc);
-
-		/* Construct the temporal point */
-		TemporalInst **instants = palloc(sizeof(TemporalInst *) * numpoints);
-		for (int j = 0; j < numpoints; j++)
-			instants[j] = temporalinst_make(values[j], times[j], type_oid(T_GEOMETRY));
-		sequences[i] = temporalseq_from_temporalinstarr(instants, numpoints, 
-			lower_inc, upper_inc, linear, true);
-		for (int j = 0; j < numpoints; j++)
-		{
-			pfree(instants[j]);
-			pfree(DatumGetPointer(values[j]));
-		}
-		pfree(instants);
-		pfree(values);
-		pfree(times);
-	}
+		sequences[i] = tpointseq_from_mfjson(json_object_array_get_idx(seqs, i),
+			srid, linear);
 	TemporalS *result = temporals_from_temporalseqarr(sequences, numseqs, 
 		linear, true);
 	for (int i = 0; i < numseqs; i++)
@@ -379,10 +294,10 @@ PG_FUNCTION_INFO_V1(tpoint_from_mfjson);
 PGDLLEXPORT Datum
 tpoint_from_mfjson(PG_FUNCTION_ARGS)
 {
-	Temporal *temp;
+	Temporal *temp = NULL;
 	text *mfjson_input;
 	char *mfjson;
-	char *srs = NULL;
+	int32 srid = SRID_UNKNOWN;
 
 	/* Get the mfjson stream */
 	mfjson_input = PG_GETARG_TEXT_P(0);
@@ -395,6 +310,7 @@ tpoint_from_mfjson(PG_FUNCTION_ARGS)
 	json_object *poObjInterp1 = NULL;
 	json_object *poObjDates = NULL;
 	json_object *poObjSrs = NULL;
+	json_object *poObjSeqs = NULL;
 
 	/* Begin to parse json */
 	jstok = json_tokener_new();
@@ -409,6 +325,7 @@ tpoint_from_mfjson(PG_FUNCTION_ARGS)
 			errmsg("Error while processing MFJSON string")));
 	}
 	json_tokener_free(jstok);
+	pfree(mfjson);
 	
 	/*
 	 * Ensure that it is a moving point
@@ -423,6 +340,29 @@ tpoint_from_mfjson(PG_FUNCTION_ARGS)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
 			errmsg("Invalid 'type' value in MFJSON string")));
 
+	/* 
+	 * Parse crs so that the SRID is set while reading the instants 
+	 */
+	poObjSrs = findMemberByName(poObj, "crs");
+	if (poObjSrs != NULL)
+	{
+		json_object *poObjSrsType = findMemberByName(poObjSrs, "type");
+		if (poObjSrsType != NULL)
+		{
+			json_object *poObjSrsProps = findMemberByName(poObjSrs, "properties");
+			if (poObjSrsProps)
+			{
+				json_object *poNameURL = findMemberByName(poObjSrsProps, "name");
+				if (poNameURL)
+				{
+					const char *pszName = json_object_get_string(poNameURL);
+					if (pszName)
+						srid = getSRIDbySRS(pszName);
+				}
+			}
+		}
+	}
+
 	/*
 	 * Determine duration of temporal point and dispatch to the 
 	 *  corresponding parse function 
@@ -451,67 +391,37 @@ tpoint_from_mfjson(PG_FUNCTION_ARGS)
 			poObjDates = findMemberByName(poObj, "datetimes");
 			if (poObjDates != NULL &&
 				json_object_get_type(poObjDates) == json_type_array)
-				temp = (Temporal *)tpointi_from_mfjson(poObj);
+				temp = (Temporal *)tpointi_from_mfjson(poObj, srid);
 			else
-				temp = (Temporal *)tpointinst_from_mfjson(poObj);
+				temp = (Temporal *)tpointinst_from_mfjson(poObj, srid);
 		}
 		else if (strcmp(pszInterp, "Stepwise") == 0)
 		{
-			json_object *poObjSeqs = findMemberByName(poObj, "sequences");
+			poObjSeqs = findMemberByName(poObj, "sequences");
 			if (poObjSeqs != NULL)
-				temp = (Temporal *)tpoints_from_mfjson(poObj, false);
+				temp = (Temporal *)tpoints_from_mfjson(poObj, srid, false);
 			else
-				temp = (Temporal *)tpointseq_from_mfjson(poObj, false);
+				temp = (Temporal *)tpointseq_from_mfjson(poObj, srid, false);
 		}
 		else if (strcmp(pszInterp, "Linear") == 0)
 		{
-			json_object *poObjSeqs = findMemberByName(poObj, "sequences");
+			poObjSeqs = findMemberByName(poObj, "sequences");
 			if (poObjSeqs != NULL)
-				temp = (Temporal *)tpoints_from_mfjson(poObj, true);
+				temp = (Temporal *)tpoints_from_mfjson(poObj, srid, true);
 			else
-				temp = (Temporal *)tpointseq_from_mfjson(poObj, true);
+				temp = (Temporal *)tpointseq_from_mfjson(poObj, srid, true);
 		}
 		else
 			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
 				errmsg("Invalid MFJSON string")));
 	}
 
-	/* Parse crs and set SRID of temporal point */
-	poObjSrs = findMemberByName(poObj, "crs");
-	if (poObjSrs != NULL)
-	{
-		json_object *poObjSrsType = findMemberByName(poObjSrs, "type");
-		if (poObjSrsType != NULL)
-		{
-			json_object *poObjSrsProps = findMemberByName(poObjSrs, "properties");
-			if (poObjSrsProps)
-			{
-				json_object *poNameURL = findMemberByName(poObjSrsProps, "name");
-				if (poNameURL)
-				{
-					const char *pszName = json_object_get_string(poNameURL);
-					if (pszName)
-					{
-						srs = palloc(strlen(pszName) + 1);
-						strcpy(srs, pszName);
-					}
-				}
-			}
-		}
-	}
-	Temporal *result;
-	if (srs)
-	{
-		result = tpoint_set_srid_internal(temp, getSRIDbySRS(srs));
-		pfree(srs);
-		pfree(temp);
-	}
-	else
-		result = temp;
+	/* Release the JSON document allocated by json-c */
+	json_object_put(poObj);
 
-	if (result == NULL)
+	if (temp == NULL)
 		PG_RETURN_NULL();
-	PG_RETURN_POINTER(result);
+	PG_RETURN_POINTER(temp);
 }
 
 /*****************************************************************************
@@ -676,6 +586,44 @@ tpoint_type_from_wkb_state(wkb_parse_state *s, uint8_t wkb_type)
 	}
 }
 
+/**
+* Parse count instants of the current dimension. The instants are 
+* allocated in a single chunk pointed to by the first element of the 
+* returned array. They are obtained by copying a template instant that
+* contains a serialized point with the SRID and the dimension of the WKB, 
+* and then overwriting its timestamp and coordinates in place.
+*/
+static TemporalInst **
+tpointinstarr_from_wkb_state(wkb_parse_state *s, int count)
+{
+	/* Count the dimensions. */
+	uint32_t ndims = (s->has_z) ? 3 : 2;
+	if (count < 1)
+		elog(ERROR, "Invalid number of instants in the WKB!");
+	/* Does the data we want to read exist? */
+	size_t size = count * ((ndims * WKB_DOUBLE_SIZE) + WKB_TIMESTAMP_SIZE);
+	wkb_parse_state_check(s, size);
+	/* Create the template instant */
+	TemporalInst *tmpl = tpointinst_template(
+		s->has_srid ? s->srid : SRID_UNKNOWN, s->has_z);
+	/* Parse the instants */
+	size_t instsize = VARSIZE(tmpl);
+	char *chunk = palloc(instsize * count);
+	TemporalInst **result = palloc(sizeof(TemporalInst *) * count);
+	for (int i = 0; i < count; i++)
+	{
+		TemporalInst *inst = (TemporalInst *) (chunk + i * instsize);
+		memcpy(inst, tmpl, instsize);
+		double *coords = tpointinst_coords(inst);
+		for (uint32_t j = 0; j < ndims; j++)
+			coords[j] = double_from_wkb_state(s);
+		inst->t = timestamp_from_wkb_state(s);
+		result[i] = inst;
+	}
+	pfree(tmpl);
+	return result;
+}
+
 /**
 * TemporalInst
 * Read a WKB Temporal, starting just after the endian byte,
@@ -687,86 +635,21 @@ tpoint_type_from_wkb_state(wkb_parse_state *s, uint8_t wkb_type)
 static TemporalInst * 
 tpointinst_from_wkb_state(wkb_parse_state *s)
 {
-	double x, y, z;
-	/* Count the dimensions. */
-	uint32_t ndims = (s->has_z) ? 3 : 2;
-	/* Does the data we want to read exist? */
-	size_t size = (ndims * WKB_DOUBLE_SIZE) + WKB_TIMESTAMP_SIZE;
-	wkb_parse_state_check(s, size);
-	/* Parse the coordinates and create the point */
-	Datum value = 0;
-	if (s->has_z)
-	{
-		x = double_from_wkb_state(s);
-		y = double_from_wkb_state(s);
-		z = double_from_wkb_state(s);
-		value = call_function3(LWGEOM_makepoint, Float8GetDatum(x),
-			Float8GetDatum(y), Float8GetDatum(z));
-
-	}
-	else 
-	{
-		x = double_from_wkb_state(s);
-		y = double_from_wkb_state(s);
-		value = call_function2(LWGEOM_makepoint, Float8GetDatum(x),
-			Float8GetDatum(y));
-	}
-	TimestampTz t = timestamp_from_wkb_state(s);
-	if (s->has_srid)
-	{
-		GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value);
-		gserialized_set_srid(gs, s->srid);
-	}
-	TemporalInst *result = temporalinst_make(value, t, type_oid(T_GEOMETRY));
-	pfree(DatumGetPointer(value));
+	TemporalInst **instants = tpointinstarr_from_wkb_state(s, 1);
+	TemporalInst *result = instants[0];
+	pfree(instants);
 	return result;
 }
 
 static TemporalI * 
 tpointi_from_wkb_state(wkb_parse_state *s)
 {
-	/* Count the dimensions. */
-	uint32_t ndims = (s->has_z) ? 3 : 2;
 	/* Get the number of instants. */
 	int count = integer_from_wkb_state(s);
-	/* Does the data we want to read exist? */
-	size_t size = count * ((ndims * WKB_DOUBLE_SIZE) + WKB_TIMESTAMP_SIZE);
-	wkb_parse_state_check(s, size);
 	/* Parse the instants */
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
-	for (int i = 0; i < count; i++)
-	{
-		double x, y, z;
-		/* Parse the coordinates and create the point */
-		Datum value = 0;
-		if (s->has_z)
-		{
-			x = double_from_wkb_state(s);
-			y = double_from_wkb_state(s);
-			z = double_from_wkb_state(s);
-			value = call_function3(LWGEOM_makepoint, Float8GetDatum(x),
-				Float8GetDatum(y), Float8GetDatum(z));
-
-		}
-		else 
-		{
-			x = double_from_wkb_state(s);
-			y = double_from_wkb_state(s);
-			value = call_function2(LWGEOM_makepoint, Float8GetDatum(x),
-				Float8GetDatum(y));
-		}
-		TimestampTz t = timestamp_from_wkb_state(s);
-		if (s->has_srid)
-		{
-			GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value);
-			gserialized_set_srid(gs, s->srid);
-		}
-		instants[i] = temporalinst_make(value, t, type_oid(T_GEOMETRY));
-		pfree(DatumGetPointer(value));
-	}
+	TemporalInst **instants = tpointinstarr_from_wkb_state(s, count);
 	TemporalI *result = temporali_from_temporalinstarr(instants, count); 
-	for (int i = 0; i < count; i++)
-		pfree(instants[i]);
+	pfree(instants[0]);
 	pfree(instants);
 	return result;
 }
@@ -787,53 +670,17 @@ tpoint_bounds_from_wkb_state(uint8_t wkb_bounds, bool *lower_inc, bool *upper_in
 static TemporalSeq * 
 tpointseq_from_wkb_state(wkb_parse_state *s)
 {
-	/* Count the dimensions. */
-	uint32_t ndims = (s->has_z) ? 3 : 2;
 	/* Get the number of instants. */
 	int count = integer_from_wkb_state(s);
 	/* Get the period bounds */
 	uint8_t wkb_bounds = (uint8_t) byte_from_wkb_state(s);
 	bool lower_inc, upper_inc;
 	tpoint_bounds_from_wkb_state(wkb_bounds, &lower_inc, &upper_inc);
-	/* Does the data we want to read exist? */
-	size_t size = count * ((ndims * WKB_DOUBLE_SIZE) + WKB_TIMESTAMP_SIZE);
-	wkb_parse_state_check(s, size);
 	/* Parse the instants */
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
-	for (int i = 0; i < count; i++)
-	{
-		double x, y, z;
-		/* Parse the coordinates and create the point */
-		Datum value = 0;
-		if (s->has_z)
-		{
-			x = double_from_wkb_state(s);
-			y = double_from_wkb_state(s);
-			z = double_from_wkb_state(s);
-			value = call_function3(LWGEOM_makepoint, Float8GetDatum(x),
-				Float8GetDatum(y), Float8GetDatum(z));
-
-		}
-		else 
-		{
-			x = double_from_wkb_state(s);
-			y = double_from_wkb_state(s);
-			value = call_function2(LWGEOM_makepoint, Float8GetDatum(x),
-				Float8GetDatum(y));
-		}
-		TimestampTz t = timestamp_from_wkb_state(s);
-		if (s->has_srid)
-		{
-			GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value);
-			gserialized_set_srid(gs, s->srid);
-		}
-		instants[i] = temporalinst_make(value, t, type_oid(T_GEOMETRY));
-		pfree(DatumGetPointer(value));
-	}
+	TemporalInst **instants = tpointinstarr_from_wkb_state(s, count);
 	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, count, 
 		lower_inc, upper_inc, s->linear, true); 
-	for (int i = 0; i < count; i++)
-		pfree(instants[i]);
+	pfree(instants[0]);
 	pfree(instants);
 	return result;
 }
@@ -841,8 +688,6 @@ tpointseq_from_wkb_state(wkb_parse_state *s)
 static TemporalS * 
 tpoints_from_wkb_state(wkb_parse_state *s)
 {
-	/* Count the dimensions. */
-	uint32_t ndims = (s->has_z) ? 3 : 2;
 	/* Get the number of sequences. */
 	int count = integer_from_wkb_state(s);
 	/* Parse the sequences */
@@ -855,45 +700,11 @@ tpoints_from_wkb_state(wkb_parse_state *s)
 		uint8_t wkb_bounds = (uint8_t) byte_from_wkb_state(s);
 		bool lower_inc, upper_inc;
 		tpoint_bounds_from_wkb_state(wkb_bounds, &lower_inc, &upper_inc);
-		/* Does the data we want to read exist? */
-		size_t size = countinst * ((ndims * WKB_DOUBLE_SIZE) + WKB_TIMESTAMP_SIZE);
-		wkb_parse_state_check(s, size);
 		/* Parse the instants */
-		TemporalInst **instants = palloc(sizeof(TemporalInst *) * countinst);
-		for (int j = 0; j < countinst; j++)
-		{
-			double x, y, z;
-			/* Parse the coordinates and create the point */
-			Datum value = 0;
-			if (s->has_z)
-			{
-				x = double_from_wkb_state(s);
-				y = double_from_wkb_state(s);
-				z = double_from_wkb_state(s);
-				value = call_function3(LWGEOM_makepoint, Float8GetDatum(x),
-					Float8GetDatum(y), Float8GetDatum(z));
-
-			}
-			else 
-			{
-				x = double_from_wkb_state(s);
-				y = double_from_wkb_state(s);
-				value = call_function2(LWGEOM_makepoint, Float8GetDatum(x),
-					Float8GetDatum(y));
-			}
-			TimestampTz t = timestamp_from_wkb_state(s);
-			if (s->has_srid)
-			{
-				GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value);
-				gserialized_set_srid(gs, s->srid);
-			}
-			instants[j] = temporalinst_make(value, t, type_oid(T_GEOMETRY));
-			pfree(DatumGetPointer(value));
-		}
+		TemporalInst **instants = tpointinstarr_from_wkb_state(s, countinst);
 		sequences[i] = temporalseq_from_temporalinstarr(instants, countinst,
 			lower_inc, upper_inc, s->linear, true); 
-		for (int j = 0; j < countinst; j++)
-			pfree(instants[j]);
+		pfree(instants[0]);
 		pfree(instants);
 	}
 	TemporalS *result = temporals_from_temporalseqarr(sequences, count, 
@@ -1,7 +1,7 @@
 /*****************************************************************************
  *
  * tpoint_out.c
- *	  Output of temporal points in WKT, EWKT and MF-JSON format
+ *	  Output of temporal points in WKT, EWKT, MF-JSON, WKB, MVT and columnar format
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  *		Universite Libre de Bruxelles
@@ -14,7 +14,12 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/array.h>
 #include <utils/builtins.h>
+#include <utils/datetime.h>
 
 #include "temporaltypes.h"
 #include "oidcache.h"
@@ -44,6 +49,25 @@ static char *
 wkt_out(Oid type, Datum value)
 {
 	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value);
+	/* Fast path for the non-empty points composing temporal points, which
+	 * are printed as lwgeom_to_wkt does without deserializing them */
+	if (gserialized_get_type(gs) == POINTTYPE && ! gserialized_is_empty(gs))
+	{
+		char *result = palloc(sizeof("POINT Z (,,)") + 
+			3 * OUT_DOUBLE_BUFFER_SIZE);
+		if (! FLAGS_GET_Z(gs->flags))
+		{
+			POINT2D pt = datum_get_point2d(value);
+			sprintf(result, "POINT(%.*g %.*g)", DBL_DIG, pt.x, DBL_DIG, pt.y);
+		}
+		else
+		{
+			POINT3DZ pt = datum_get_point3dz(value);
+			sprintf(result, "POINT Z (%.*g %.*g %.*g)", DBL_DIG, pt.x, 
+				DBL_DIG, pt.y, DBL_DIG, pt.z);
+		}
+		return result;
+	}
 	LWGEOM *geom = lwgeom_from_gserialized(gs);
 	size_t len;
 	char *wkt = lwgeom_to_wkt(geom, WKT_ISO, DBL_DIG, &len);
@@ -319,18 +343,48 @@ datetimes_mfjson_size(int npoints)
 	return sizeof("\"2019-08-06T18:35:48.021455+02:30\",") * npoints + sizeof("[],");
 }
 
+/*
+ * Write a quoted timestamptz in ISO format, e.g., 
+ * "2019-08-06T18:35:48.021455+02:30", where the separator between the date 
+ * and the time parts is a 'T' when tsep is true and a space otherwise. 
+ * The timestamp is encoded directly rather than through the output 
+ * function, which avoids the function call and the allocation per instant 
+ * and does not depend on the DateStyle setting.
+ */
 static size_t
-datetimes_mfjson_buf(char *output, TemporalInst *inst)
+timestamp_mfjson_buf(char *output, TimestampTz t, bool tsep)
 {
 	char *ptr = output;
-	char *t = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(inst->t));
-	/* Replace ' ' by 'T' as separator between date and time parts */
-	t[10] = 'T';
-	ptr += sprintf(ptr, "\"%s\"", t);
-	pfree(t);
+	*ptr++ = '"';
+	if (TIMESTAMP_IS_NOBEGIN(t))
+		ptr += sprintf(ptr, "%s", EARLY);
+	else if (TIMESTAMP_IS_NOEND(t))
+		ptr += sprintf(ptr, "%s", LATE);
+	else
+	{
+		struct pg_tm tt, *tm = &tt;
+		fsec_t fsec;
+		int tz;
+		const char *tzn;
+		if (timestamp2tm(t, &tz, tm, &fsec, &tzn, NULL) != 0)
+			ereport(ERROR, (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+				errmsg("timestamp out of range")));
+		EncodeDateTime(tm, fsec, true, tz, tzn, USE_ISO_DATES, ptr);
+		if (tsep)
+			ptr[10] = 'T';
+		ptr += strlen(ptr);
+	}
+	*ptr++ = '"';
+	*ptr = '\0';
 	return (ptr - output);
 }
 
+static size_t
+datetimes_mfjson_buf(char *output, TemporalInst *inst)
+{
+	return timestamp_mfjson_buf(output, inst->t, true);
+}
+
 /*
  * Handle SRS
  */
@@ -387,10 +441,11 @@ bbox_mfjson_buf(char *output, STBOX *bbox, int hasz, int precision)
 		ptr += sprintf(ptr, "\"bbox\":[%.*f,%.*f,%.*f,%.*f,%.*f,%.*f],",
 			precision, bbox->xmin, precision, bbox->ymin, precision, bbox->zmin,
 			precision, bbox->xmax, precision, bbox->ymax, precision, bbox->zmax);
-	char *begin = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(bbox->tmin));
-	char *end = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(bbox->tmax));
-	ptr += sprintf(ptr, "\"period\":{\"begin\":\"%s\",\"end\":\"%s\"}},", begin, end);
-	pfree(begin); pfree(end);
+	ptr += sprintf(ptr, "\"period\":{\"begin\":");
+	ptr += timestamp_mfjson_buf(ptr, (TimestampTz) bbox->tmin, false);
+	ptr += sprintf(ptr, ",\"end\":");
+	ptr += timestamp_mfjson_buf(ptr, (TimestampTz) bbox->tmax, false);
+	ptr += sprintf(ptr, "}},");
 	return (ptr - output);
 }
 
@@ -1379,3 +1434,440 @@ tpoint_as_hexewkb(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Output in Mapbox Vector Tile (MVT) format
+ * The temporal point is clipped to the bounds of the tile extended with the
+ * buffer and its coordinates are transformed into the integer coordinates of
+ * the tile, with the y axis pointing down. The timestamps of the vertices,
+ * in seconds since the Unix epoch, are returned in an array aligned with the
+ * vertices of the geometry, as expected by the trip layers of map renderers.
+ * Consecutive vertices of a sequence that fall on the same tile coordinates
+ * are collapsed, keeping the first and the last vertex of each run so that
+ * the stops are preserved.
+ *****************************************************************************/
+
+typedef struct
+{
+	double		xmin;
+	double		ymax;
+	double		xscale;		/* Tile units per unit of the x axis */
+	double		yscale;		/* Tile units per unit of the y axis */
+} MvtTransform;
+
+static POINT4D
+mvt_transform_point(Datum value, const MvtTransform *tr)
+{
+	POINT2D p = datum_get_point2d(value);
+	POINT4D result;
+	result.x = rint((p.x - tr->xmin) * tr->xscale);
+	result.y = rint((tr->ymax - p.y) * tr->yscale);
+	result.z = result.m = 0;
+	return result;
+}
+
+static Datum
+mvt_timestamp(TimestampTz t)
+{
+	return Float8GetDatum((double) t / USECS_PER_SEC +
+		((POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * SECS_PER_DAY));
+}
+
+/*
+ * Append the vertices of a temporal sequence point to the point array and
+ * their timestamps to the array of times, which already contains count
+ * elements. Returns the new number of elements of the array of times.
+ */
+static int
+tpointseq_as_mvtgeom1(POINTARRAY *pa, Datum *times, int count,
+	TemporalSeq *seq, const MvtTransform *tr)
+{
+	POINT4D *points = palloc(sizeof(POINT4D) * seq->count);
+	for (int i = 0; i < seq->count; i++)
+		points[i] = mvt_transform_point(
+			temporalinst_value(temporalseq_inst_n(seq, i)), tr);
+	int last = 0;
+	for (int i = 0; i < seq->count; i++)
+	{
+		if (i > 0 && i < seq->count - 1 &&
+			points[i].x == points[last].x && points[i].y == points[last].y &&
+			points[i].x == points[i + 1].x && points[i].y == points[i + 1].y)
+			continue;
+		ptarray_append_point(pa, &points[i], LW_TRUE);
+		times[count++] = mvt_timestamp(temporalseq_inst_n(seq, i)->t);
+		last = i;
+	}
+	/* Instantaneous sequence output as a degenerate line */
+	if (seq->count == 1)
+	{
+		ptarray_append_point(pa, &points[0], LW_TRUE);
+		times[count] = times[count - 1];
+		count++;
+	}
+	pfree(points);
+	return count;
+}
+
+static LWGEOM *
+tpointseq_as_mvtgeom(Datum *times, int *count, TemporalSeq *seq, int srid,
+	const MvtTransform *tr)
+{
+	POINTARRAY *pa = ptarray_construct_empty(false, false, seq->count);
+	*count = tpointseq_as_mvtgeom1(pa, times, *count, seq, tr);
+	return lwline_as_lwgeom(lwline_construct(srid, NULL, pa));
+}
+
+PG_FUNCTION_INFO_V1(tpoint_as_mvtgeom);
+/**
+ * @brief Returns the geometry of the temporal point in the coordinates of a
+ * vector tile together with the timestamps of its vertices
+ */
+PGDLLEXPORT Datum
+tpoint_as_mvtgeom(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	STBOX *bounds = PG_GETARG_STBOX_P(1);
+	int32 extent = PG_GETARG_INT32(2);
+	int32 buffer = PG_GETARG_INT32(3);
+	bool clip = PG_GETARG_BOOL(4);
+	if (! MOBDB_FLAGS_GET_X(bounds->flags) || bounds->xmax <= bounds->xmin ||
+		bounds->ymax <= bounds->ymin)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The bounds of the tile must have a positive width and height")));
+	if (extent <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The extent of the tile must be positive")));
+	if (buffer < 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The buffer of the tile cannot be negative")));
+
+	MvtTransform tr;
+	tr.xmin = bounds->xmin;
+	tr.ymax = bounds->ymax;
+	tr.xscale = extent / (bounds->xmax - bounds->xmin);
+	tr.yscale = extent / (bounds->ymax - bounds->ymin);
+
+	/* Clip the temporal point to the bounds extended with the buffer */
+	Temporal *temp1 = temp;
+	if (clip)
+	{
+		STBOX box;
+		memcpy(&box, bounds, sizeof(STBOX));
+		box.xmin -= buffer / tr.xscale;
+		box.xmax += buffer / tr.xscale;
+		box.ymin -= buffer / tr.yscale;
+		box.ymax += buffer / tr.yscale;
+		MOBDB_FLAGS_SET_Z(box.flags, false);
+		temp1 = tpoint_at_stbox_internal(temp, &box);
+		if (temp1 == NULL)
+		{
+			PG_FREE_IF_COPY(temp, 0);
+			PG_RETURN_NULL();
+		}
+	}
+
+	int srid = tpoint_srid_internal(temp1);
+	/* One more time per sequence for the instantaneous ones */
+	int maxcount = (temp1->duration == TEMPORALS) ?
+		((TemporalS *) temp1)->totalcount + ((TemporalS *) temp1)->count :
+		(temp1->duration == TEMPORALSEQ) ? ((TemporalSeq *) temp1)->count :
+		(temp1->duration == TEMPORALI) ? ((TemporalI *) temp1)->count : 1;
+	Datum *times = palloc(sizeof(Datum) * maxcount);
+	int count = 0;
+	LWGEOM *lwgeom;
+	ensure_valid_duration(temp1->duration);
+	if (temp1->duration == TEMPORALINST)
+	{
+		TemporalInst *inst = (TemporalInst *) temp1;
+		POINT4D p = mvt_transform_point(temporalinst_value(inst), &tr);
+		lwgeom = lwpoint_as_lwgeom(lwpoint_make2d(srid, p.x, p.y));
+		times[count++] = mvt_timestamp(inst->t);
+	}
+	else if (temp1->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *) temp1;
+		LWGEOM **points = palloc(sizeof(LWGEOM *) * ti->count);
+		for (int i = 0; i < ti->count; i++)
+		{
+			TemporalInst *inst = temporali_inst_n(ti, i);
+			POINT4D p = mvt_transform_point(temporalinst_value(inst), &tr);
+			points[i] = lwpoint_as_lwgeom(lwpoint_make2d(srid, p.x, p.y));
+			times[count++] = mvt_timestamp(inst->t);
+		}
+		lwgeom = lwcollection_as_lwgeom(lwcollection_construct(MULTIPOINTTYPE,
+			srid, NULL, ti->count, points));
+	}
+	else if (temp1->duration == TEMPORALSEQ)
+	{
+		TemporalSeq *seq = (TemporalSeq *) temp1;
+		if (seq->count == 1)
+		{
+			TemporalInst *inst = temporalseq_inst_n(seq, 0);
+			POINT4D p = mvt_transform_point(temporalinst_value(inst), &tr);
+			lwgeom = lwpoint_as_lwgeom(lwpoint_make2d(srid, p.x, p.y));
+			times[count++] = mvt_timestamp(inst->t);
+		}
+		else
+			lwgeom = tpointseq_as_mvtgeom(times, &count, seq, srid, &tr);
+	}
+	else /* temp1->duration == TEMPORALS */
+	{
+		/* Instantaneous sequences are output as lines with two equal vertices
+		 * since a vector tile feature cannot mix lines and points */
+		TemporalS *ts = (TemporalS *) temp1;
+		LWGEOM **lines = palloc(sizeof(LWGEOM *) * ts->count);
+		for (int i = 0; i < ts->count; i++)
+			lines[i] = tpointseq_as_mvtgeom(times, &count,
+				temporals_seq_n(ts, i), srid, &tr);
+		lwgeom = lwcollection_as_lwgeom(lwcollection_construct(MULTILINETYPE,
+			srid, NULL, ts->count, lines));
+	}
+
+	TupleDesc tupdesc;
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+	tupdesc = BlessTupleDesc(tupdesc);
+	Datum values[2];
+	bool nulls[2] = {false, false};
+	values[0] = PointerGetDatum(geometry_serialize(lwgeom));
+	values[1] = PointerGetDatum(construct_array(times, count, FLOAT8OID,
+		sizeof(float8), FLOAT8PASSBYVAL, 'd'));
+	HeapTuple tuple = heap_form_tuple(tupdesc, values, nulls);
+
+	lwgeom_free(lwgeom);
+	pfree(times);
+	if (temp1 != temp)
+		pfree(temp1);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Output in columnar binary format
+ *
+ * A set of temporal points is written as the buffers of a columnar record
+ * batch so that a client can map them without parsing, e.g., with
+ * numpy.frombuffer or as the buffers of Arrow arrays. The values are in the
+ * byte order of the server and every buffer starts at a multiple of 8 bytes
+ * from the beginning of the data
+ * - the header (see ColumnarHeader)
+ * - int32 offsets of the first sequence of each temporal value, followed
+ *   by the number of sequences
+ * - int32 offsets of the first instant of each sequence, followed by the
+ *   number of instants
+ * - int64 timestamps in microseconds since 1970-01-01 00:00:00+00
+ * - float8 x, y, and optionally z coordinates
+ * Instants and the instants of instant sets are written as sequences of
+ * one instant.
+ *****************************************************************************/
+
+#define COLUMNAR_MAGIC		"MDBC"
+#define COLUMNAR_VERSION	1
+#define COLUMNAR_HASZ		0x01
+#define COLUMNAR_GEODETIC	0x02
+#define COLUMNAR_ALIGN(len)	TYPEALIGN(8, (len))
+
+typedef struct
+{
+	char		magic[4];	/* COLUMNAR_MAGIC */
+	int32		version;	/* COLUMNAR_VERSION */
+	int32		flags;		/* COLUMNAR_HASZ and COLUMNAR_GEODETIC */
+	int32		srid;		/* SRID of the temporal points */
+	int32		nvalues;	/* Number of temporal values */
+	int32		nseqs;		/* Number of sequences */
+	int32		ninsts;		/* Number of instants */
+	int32		reserved;	/* Padding, always 0 */
+} ColumnarHeader;
+
+/* Position of the next element of each buffer of the output */
+
+typedef struct
+{
+	char	   *seqoffs;	/* Offsets of the sequences */
+	char	   *times;		/* Timestamps */
+	char	   *x;			/* X coordinates */
+	char	   *y;			/* Y coordinates */
+	char	   *z;			/* Z coordinates, NULL if the points are 2D */
+	int32		nseqs;		/* Number of sequences written */
+	int32		ninsts;		/* Number of instants written */
+} ColumnarWriter;
+
+/*
+ * The buffers are not necessarily aligned since the data of a bytea starts
+ * after its 4-byte header, hence the values are copied with memcpy
+ */
+static void
+tpointinst_to_columnar(ColumnarWriter *writer, TemporalInst *inst)
+{
+	int64 t = inst->t +
+		((POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY);
+	memcpy(writer->times, &t, sizeof(int64));
+	writer->times += sizeof(int64);
+	if (writer->z == NULL)
+	{
+		POINT2D pt = datum_get_point2d(temporalinst_value(inst));
+		memcpy(writer->x, &pt.x, sizeof(double));
+		memcpy(writer->y, &pt.y, sizeof(double));
+	}
+	else
+	{
+		POINT3DZ pt = datum_get_point3dz(temporalinst_value(inst));
+		memcpy(writer->x, &pt.x, sizeof(double));
+		memcpy(writer->y, &pt.y, sizeof(double));
+		memcpy(writer->z, &pt.z, sizeof(double));
+		writer->z += sizeof(double);
+	}
+	writer->x += sizeof(double);
+	writer->y += sizeof(double);
+	writer->ninsts++;
+}
+
+/* Start a new sequence at the current instant */
+
+static void
+columnar_start_seq(ColumnarWriter *writer)
+{
+	memcpy(writer->seqoffs, &writer->ninsts, sizeof(int32));
+	writer->seqoffs += sizeof(int32);
+	writer->nseqs++;
+}
+
+static void
+tpointseq_to_columnar(ColumnarWriter *writer, TemporalSeq *seq)
+{
+	columnar_start_seq(writer);
+	for (int i = 0; i < seq->count; i++)
+		tpointinst_to_columnar(writer, temporalseq_inst_n(seq, i));
+}
+
+static void
+tpoint_to_columnar(ColumnarWriter *writer, Temporal *temp)
+{
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+	{
+		columnar_start_seq(writer);
+		tpointinst_to_columnar(writer, (TemporalInst *)temp);
+	}
+	else if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *)temp;
+		for (int i = 0; i < ti->count; i++)
+		{
+			columnar_start_seq(writer);
+			tpointinst_to_columnar(writer, temporali_inst_n(ti, i));
+		}
+	}
+	else if (temp->duration == TEMPORALSEQ)
+		tpointseq_to_columnar(writer, (TemporalSeq *)temp);
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *)temp;
+		for (int i = 0; i < ts->count; i++)
+			tpointseq_to_columnar(writer, temporals_seq_n(ts, i));
+	}
+}
+
+/* Number of sequences and of instants of a temporal point in columnar format */
+
+static void
+tpoint_columnar_counts(Temporal *temp, int *nseqs, int *ninsts)
+{
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+	{
+		*nseqs += 1;
+		*ninsts += 1;
+	}
+	else if (temp->duration == TEMPORALI)
+	{
+		*nseqs += ((TemporalI *)temp)->count;
+		*ninsts += ((TemporalI *)temp)->count;
+	}
+	else if (temp->duration == TEMPORALSEQ)
+	{
+		*nseqs += 1;
+		*ninsts += ((TemporalSeq *)temp)->count;
+	}
+	else /* temp->duration == TEMPORALS */
+	{
+		*nseqs += ((TemporalS *)temp)->count;
+		*ninsts += ((TemporalS *)temp)->totalcount;
+	}
+}
+
+PG_FUNCTION_INFO_V1(tpointarr_as_columnar);
+/**
+ * @brief Output a temporal point array in columnar binary format
+ */
+PGDLLEXPORT Datum
+tpointarr_as_columnar(PG_FUNCTION_ARGS)
+{
+	ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+	int count;
+	Temporal **temparr = temporalarr_extract(array, &count);
+	if (count == 0)
+	{
+		PG_FREE_IF_COPY(array, 0);
+		PG_RETURN_NULL();
+	}
+	int nseqs = 0, ninsts = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (i > 0)
+		{
+			ensure_same_srid_tpoint(temparr[0], temparr[i]);
+			ensure_same_dimensionality_tpoint(temparr[0], temparr[i]);
+		}
+		tpoint_columnar_counts(temparr[i], &nseqs, &ninsts);
+	}
+	bool hasz = MOBDB_FLAGS_GET_Z(temparr[0]->flags);
+
+	/* Compute the position of the buffers */
+	size_t valpos = COLUMNAR_ALIGN(sizeof(ColumnarHeader));
+	size_t seqpos = valpos + COLUMNAR_ALIGN(sizeof(int32) * (count + 1));
+	size_t timepos = seqpos + COLUMNAR_ALIGN(sizeof(int32) * (nseqs + 1));
+	size_t xpos = timepos + sizeof(int64) * ninsts;
+	size_t ypos = xpos + sizeof(double) * ninsts;
+	size_t zpos = ypos + sizeof(double) * ninsts;
+	size_t size = hasz ? zpos + sizeof(double) * ninsts : zpos;
+	bytea *result = palloc0(VARHDRSZ + size);
+	SET_VARSIZE(result, VARHDRSZ + size);
+	char *data = VARDATA(result);
+
+	ColumnarHeader header;
+	memset(&header, 0, sizeof(ColumnarHeader));
+	memcpy(header.magic, COLUMNAR_MAGIC, 4);
+	header.version = COLUMNAR_VERSION;
+	header.flags = (hasz ? COLUMNAR_HASZ : 0) |
+		(MOBDB_FLAGS_GET_GEODETIC(temparr[0]->flags) ? COLUMNAR_GEODETIC : 0);
+	header.srid = tpoint_srid_internal(temparr[0]);
+	header.nvalues = count;
+	header.nseqs = nseqs;
+	header.ninsts = ninsts;
+	memcpy(data, &header, sizeof(ColumnarHeader));
+
+	ColumnarWriter writer;
+	writer.seqoffs = data + seqpos;
+	writer.times = data + timepos;
+	writer.x = data + xpos;
+	writer.y = data + ypos;
+	writer.z = hasz ? data + zpos : NULL;
+	writer.nseqs = writer.ninsts = 0;
+	for (int i = 0; i < count; i++)
+	{
+		memcpy(data + valpos + sizeof(int32) * i, &writer.nseqs, sizeof(int32));
+		tpoint_to_columnar(&writer, temparr[i]);
+	}
+	/* Close the offset buffers */
+	memcpy(data + valpos + sizeof(int32) * count, &writer.nseqs, sizeof(int32));
+	memcpy(writer.seqoffs, &writer.ninsts, sizeof(int32));
+
+	pfree(temparr);
+	PG_FREE_IF_COPY(array, 0);
+	PG_RETURN_BYTEA_P(result);
+}
+
+/*****************************************************************************/
@@ -12,6 +12,9 @@
 
 #include "tpoint_parser.h"
 
+#include <ctype.h>
+#include <math.h>
+
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "tpoint.h"
@@ -240,16 +243,142 @@ stbox_parse(char **str)
 	return result;
 }
 
+/*****************************************************************************
+ * Fast path for geometry points in WKT format
+ *****************************************************************************/
+
+/*
+ * Parse a coordinate of a point in WKT format. Non-finite values are left
+ * to the input function of PostGIS.
+ */
+static bool
+coord_parse_fast(char **str, double *result)
+{
+	while (**str == ' ' || **str == '\t' || **str == '\n' || **str == '\r')
+		(*str)++;
+	if (! isdigit((unsigned char) **str) && **str != '-' && **str != '+' &&
+		**str != '.')
+		return false;
+	char *end;
+	errno = 0;
+	*result = strtod(*str, &end);
+	if (end == *str || errno != 0 || ! isfinite(*result))
+		return false;
+	*str = end;
+	return true;
+}
+
+/*
+ * Parse a 2D or 3D geometry point in WKT format followed by the '@' that
+ * precedes the timestamp of an instant, e.g., 'POINT(1 2)@', 'POINT Z(1 2 3)@'
+ * or 'SRID=4326;POINT(1 2)@', without calling the input function of PostGIS.
+ * Returns false without consuming the input if the value is not in this 
+ * form, e.g., for empty or measured points or for (E)WKB input, so that it
+ * is parsed by the input function of PostGIS.
+ */
+static bool
+geompoint_parse_fast(char **str, int *srid, bool *hasz, double *coords)
+{
+	char *cur = *str;
+	int ncoords = 0;
+	*srid = SRID_UNKNOWN;
+	*hasz = false;
+	if (strncasecmp(cur, "SRID=", 5) == 0)
+	{
+		cur += 5;
+		if (! isdigit((unsigned char) *cur))
+			return false;
+		*srid = 0;
+		while (isdigit((unsigned char) *cur))
+			*srid = *srid * 10 + *cur++ - '0';
+		if (*cur++ != ';')
+			return false;
+	}
+	if (strncasecmp(cur, "POINT", 5) != 0)
+		return false;
+	cur += 5;
+	p_whitespace(&cur);
+	if (*cur == 'Z' || *cur == 'z')
+	{
+		*hasz = true;
+		cur++;
+		p_whitespace(&cur);
+	}
+	if (*cur++ != '(')
+		return false;
+	while (ncoords < 3 && coord_parse_fast(&cur, &coords[ncoords]))
+		ncoords++;
+	p_whitespace(&cur);
+	if (ncoords < 2 || (*hasz && ncoords != 3) || *cur++ != ')')
+		return false;
+	p_whitespace(&cur);
+	if (*cur++ != '@')
+		return false;
+	/* PostGIS reads a point with three coordinates as a 3D point */
+	*hasz = (ncoords == 3);
+	*str = cur;
+	return true;
+}
+
+/*
+ * Construct an instant of a geometry point by writing the point directly
+ * in its serialized form
+ */
+static TemporalInst *
+geompointinst_make(const double *coords, bool hasz, int srid, TimestampTz t)
+{
+	/* Header, type, number of points, and up to three coordinates */
+	double buf[8];
+	GSERIALIZED *gs = (GSERIALIZED *) buf;
+	int ncoords = hasz ? 3 : 2;
+	size_t size = offsetof(GSERIALIZED, data) + 8 + ncoords * sizeof(double);
+	memset(gs, 0, size);
+	SET_VARSIZE(gs, size);
+	gserialized_set_srid(gs, srid);
+	FLAGS_SET_Z(gs->flags, hasz);
+	uint32_t *header = (uint32_t *) gs->data;
+	header[0] = POINTTYPE;
+	header[1] = 1;
+	memcpy(gs->data + 8, coords, ncoords * sizeof(double));
+	return temporalinst_make(PointerGetDatum(gs), t, type_oid(T_GEOMETRY));
+}
+
 /*****************************************************************************/
 
 static TemporalInst *
 tpointinst_parse(char **str, Oid basetype, bool end, int *tpoint_srid) 
 {
 	p_whitespace(str);
+	/* Geometry points in WKT format do not need the input function */
+	double coords[3];
+	bool hasz;
+	int geo_srid;
+	if (basetype == type_oid(T_GEOMETRY) &&
+		geompoint_parse_fast(str, &geo_srid, &hasz, coords))
+	{
+		if (*tpoint_srid != SRID_UNKNOWN && geo_srid != SRID_UNKNOWN && 
+			*tpoint_srid != geo_srid)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
+				errmsg("Geometry SRID (%d) does not match temporal type SRID (%d)", 
+				geo_srid, *tpoint_srid)));
+		if (*tpoint_srid == SRID_UNKNOWN)
+			*tpoint_srid = geo_srid;
+		TimestampTz t = timestamp_parse(str);
+		if (end)
+		{
+			/* Ensure there is no more input */
+			p_whitespace(str);
+			if (**str != 0)
+				ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
+					errmsg("Could not parse temporal value")));
+		}
+		return geompointinst_make(coords, hasz, *tpoint_srid, t);
+	}
+
 	/* The next instruction will throw an exception if it fails */
 	Datum geo = basetype_parse(str, basetype); 
 	GSERIALIZED *gs = (GSERIALIZED *)PG_DETOAST_DATUM(geo);
-	int geo_srid = gserialized_get_srid(gs);
+	geo_srid = gserialized_get_srid(gs);
 	ensure_point_type(gs);
 	ensure_non_empty(gs);
 	ensure_has_not_M(gs);
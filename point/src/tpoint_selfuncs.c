@@ -14,6 +14,7 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 
 #include "period.h"
 #include "temporal_selfuncs.h"
@@ -843,6 +844,157 @@ calc_geo_selectivity(VariableStatData *vardata, const STBOX *box, CachedOp op)
 	return selectivity;
 }
 
+/*
+ * This function returns an estimate of the join selectivity of the bounding
+ * box operators between two spatial columns by looking at the data in their
+ * ND_STATS structures. 
+ *
+ * To get our estimate, we iterate over the cells of the smaller histogram,
+ * and for each of them we sum the values of the cells of the other histogram
+ * that overlap it, pro-rated by the proportion of the overlap. The sum is
+ * scaled up to the size of the tables and divided by the largest possible
+ * join size, that is, the product of the number of non-NULL rows of both
+ * tables.
+ *
+ * This function is based on PostGIS function estimate_join_selectivity in 
+ * file gserialized_estimate.c
+ */
+static float8
+calc_geo_joinsel(VariableStatData *vardata1, VariableStatData *vardata2)
+{
+	ND_STATS *s1, *s2, *stats_tmp;
+	AttStatsSlot sslot;
+	int ndims1, ndims2, ndims;
+	double ntuples_max, ntuples_not_null1, ntuples_not_null2;
+	ND_IBOX ibox1, ibox2;
+	int at1[ND_DIMS], at2[ND_DIMS];
+	double min1[ND_DIMS], cellsize1[ND_DIMS];
+	double min2[ND_DIMS], cellsize2[ND_DIMS];
+	int d; /* counter */
+	double val = 0.0;
+	float8 selectivity;
+
+	/* Get the statistics of both sides and clone them */
+	if (!(HeapTupleIsValid(vardata1->statsTuple) &&
+		  get_attstatsslot(&sslot, vardata1->statsTuple, STATISTIC_KIND_ND, 
+			InvalidOid, ATTSTATSSLOT_NUMBERS)))
+		return -1;
+	s1 = palloc(sizeof(float4) * sslot.nnumbers);
+	memcpy(s1, sslot.numbers, sizeof(float4) * sslot.nnumbers);
+	free_attstatsslot(&sslot);
+
+	if (!(HeapTupleIsValid(vardata2->statsTuple) &&
+		  get_attstatsslot(&sslot, vardata2->statsTuple, STATISTIC_KIND_ND, 
+			InvalidOid, ATTSTATSSLOT_NUMBERS)))
+	{
+		pfree(s1);
+		return -1;
+	}
+	s2 = palloc(sizeof(float4) * sslot.nnumbers);
+	memcpy(s2, sslot.numbers, sizeof(float4) * sslot.nnumbers);
+	free_attstatsslot(&sslot);
+
+	/* Drive the summation loop with the smaller histogram */
+	if (s1->histogram_cells > s2->histogram_cells)
+	{
+		stats_tmp = s1;
+		s1 = s2;
+		s2 = stats_tmp;
+	}
+
+	/* The largest possible join size */
+	ntuples_not_null1 = s1->table_features * 
+		(s1->not_null_features / s1->sample_features);
+	ntuples_not_null2 = s2->table_features * 
+		(s2->not_null_features / s2->sample_features);
+	ntuples_max = ntuples_not_null1 * ntuples_not_null2;
+
+	ndims1 = (int) s1->ndims;
+	ndims2 = (int) s2->ndims;
+	ndims = Max(ndims1, ndims2);
+
+	/* If the extents do not intersect the join is very very selective */
+	if (! nd_box_intersects(&(s1->extent), &(s2->extent), ndims))
+	{
+		pfree(s1); pfree(s2);
+		return 0.0;
+	}
+
+	/* Find the cells of the smaller histogram that overlap the larger one */
+	if (! nd_box_overlap(s1, &(s2->extent), &ibox1))
+	{
+		pfree(s1); pfree(s2);
+		return FALLBACK_ND_JOINSEL;
+	}
+
+	/* Work out some measurements of the histograms */
+	for (d = 0; d < ndims1; d++)
+	{
+		at1[d] = ibox1.min[d];
+		min1[d] = s1->extent.min[d];
+		cellsize1[d] = (s1->extent.max[d] - min1[d]) / s1->size[d];
+	}
+	for (d = 0; d < ndims2; d++)
+	{
+		min2[d] = s2->extent.min[d];
+		cellsize2[d] = (s2->extent.max[d] - min2[d]) / s2->size[d];
+	}
+
+	/* For each affected cell of s1 */
+	do
+	{
+		double val1;
+		ND_BOX nd_cell1;
+		memset(&nd_cell1, 0, sizeof(ND_BOX));
+		for (d = 0; d < ndims1; d++)
+		{
+			nd_cell1.min[d] = (float4) (min1[d] + (at1[d]+0) * cellsize1[d]);
+			nd_cell1.max[d] = (float4) (min1[d] + (at1[d]+1) * cellsize1[d]);
+		}
+
+		/* Find the cells of s2 that the cell of s1 overlaps */
+		nd_box_overlap(s2, &nd_cell1, &ibox2);
+		for (d = 0; d < ndims2; d++)
+			at2[d] = ibox2.min[d];
+
+		val1 = s1->value[nd_stats_value_index(s1, at1)];
+
+		/* For each overlapped cell of s2 */
+		do
+		{
+			double ratio2, val2;
+			ND_BOX nd_cell2;
+			memset(&nd_cell2, 0, sizeof(ND_BOX));
+			for (d = 0; d < ndims2; d++)
+			{
+				nd_cell2.min[d] = (float4) (min2[d] + (at2[d]+0) * cellsize2[d]);
+				nd_cell2.max[d] = (float4) (min2[d] + (at2[d]+1) * cellsize2[d]);
+			}
+
+			/* Multiply the cell counts, scaled by the overlap ratio */
+			ratio2 = nd_box_ratio_overlaps(&nd_cell1, &nd_cell2, ndims);
+			val2 = s2->value[nd_stats_value_index(s2, at2)];
+			val += val1 * (val2 * ratio2);
+		}
+		while (nd_increment(&ibox2, ndims2, at2));
+	}
+	while (nd_increment(&ibox1, ndims1, at1));
+
+	/* Scale the cell count up to a full table estimate */
+	val *= (s1->table_features / s1->sample_features);
+	val *= (s2->table_features / s2->sample_features);
+	selectivity = val / ntuples_max;
+	pfree(s1); pfree(s2);
+
+	/* Guard against over-estimates and crazy numbers */
+	if (isnan(selectivity) || ! isfinite(selectivity) || selectivity < 0.0)
+		selectivity = FALLBACK_ND_JOINSEL;
+	else if (selectivity > 1.0)
+		selectivity = 1.0;
+
+	return selectivity;
+}
+
 /*****************************************************************************/
 
 PG_FUNCTION_INFO_V1(tpoint_sel);
@@ -964,7 +1116,73 @@ PG_FUNCTION_INFO_V1(tpoint_joinsel);
 PGDLLEXPORT Datum
 tpoint_joinsel(PG_FUNCTION_ARGS)
 {
-	PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+	PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+	Oid operator = PG_GETARG_OID(1);
+	List *args = (List *) PG_GETARG_POINTER(2);
+	SpecialJoinInfo *sjinfo = (SpecialJoinInfo *) PG_GETARG_POINTER(4);
+	VariableStatData vardata1, vardata2, *left, *right;
+	bool join_is_reversed;
+	Selectivity selec, spatialsel, timesel;
+	CachedOp cachedOp;
+
+	/*
+	 * Get enumeration value associated to the operator
+	 */
+	bool found = tpoint_cachedop(operator, &cachedOp);
+	/* In the case of unknown operator */
+	if (!found)
+		PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+	get_join_variables(root, args, sjinfo, &vardata1, &vardata2,
+		&join_is_reversed);
+	/* Ensure that left is the left argument of the operator */
+	left = join_is_reversed ? &vardata2 : &vardata1;
+	right = join_is_reversed ? &vardata1 : &vardata2;
+
+	/* Enable the multiplication of the selectivity of the spatial and time 
+	 * dimensions since either may be missing */
+	selec = 1.0;
+	found = false;
+
+	/*
+	 * Estimate selectivity for the spatial dimension. The statistics 
+	 * currently collected do not allow us to differentiate between the
+	 * position operators, which use the default selectivity.
+	 */
+	if (cachedOp == OVERLAPS_OP || cachedOp == CONTAINS_OP ||
+		cachedOp == CONTAINED_OP || cachedOp == SAME_OP)
+	{
+		spatialsel = calc_geo_joinsel(left, right);
+		if (spatialsel >= 0.0)
+		{
+			selec *= spatialsel;
+			found = true;
+		}
+	}
+	/*
+	 * Estimate selectivity for the time dimension when both sides are 
+	 * temporal points. The period statistics of geometries and boxes are 
+	 * not available.
+	 */
+	if (temporal_type_oid(left->vartype) && temporal_type_oid(right->vartype))
+	{
+		timesel = temporals_joinsel(left, right, cachedOp);
+		if (timesel >= 0.0)
+		{
+			selec *= timesel;
+			found = true;
+		}
+	}
+
+	ReleaseVariableStats(vardata1);
+	ReleaseVariableStats(vardata2);
+
+	/* Use default selectivity if the statistics are not available */
+	if (!found)
+		PG_RETURN_FLOAT8(default_tpoint_selectivity(cachedOp));
+
+	CLAMP_PROBABILITY(selec);
+	PG_RETURN_FLOAT8(selec);
 }
 
 /*****************************************************************************/
@@ -14,6 +14,10 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <libpq/pqformat.h>
 #include <utils/builtins.h>
 #include <utils/timestamp.h>
 
@@ -22,6 +26,8 @@
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_expanded.h"
+#include "temporal_boxops.h"
 #include "lifting.h"
 #include "tnumber_mathfuncs.h"
 #include "tpoint.h"
@@ -64,6 +70,15 @@ ensure_same_dimensionality_tpoint_gs(Temporal *temp, GSERIALIZED *gs)
 			errmsg("The temporal point and the geometry must be of the same dimensionality")));
 }
 
+void
+ensure_same_geodetic_tpoint_stbox(Temporal *temp, STBOX *box)
+{
+	if (MOBDB_FLAGS_GET_X(box->flags) &&
+		MOBDB_FLAGS_GET_GEODETIC(temp->flags) != MOBDB_FLAGS_GET_GEODETIC(box->flags))
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The temporal point and the box must be both planar or both geodetic")));
+}
+
 void
 ensure_has_Z_tpoint(Temporal *temp)
 {
@@ -158,16 +173,9 @@ gs_get_point3dz(GSERIALIZED *gs)
 POINT3DZ
 datum_get_point3dz(Datum geom)
 {
-	GSERIALIZED *gs = (GSERIALIZED *)PointerGetDatum(geom);
-	// POINT3DZ *point = (POINT3DZ *)((uint8_t*)gs->data + 8);
-	// return *point;
-	LWGEOM *lwgeom = lwgeom_from_gserialized(gs);
-	LWPOINT* lwpoint = lwgeom_as_lwpoint(lwgeom);
-	POINT3DZ point = getPoint3dz(lwpoint->point, 0);
-	lwgeom_free(lwgeom);
-	POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(geom));
-	return point;
-
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(geom);
+	POINT3DZ *point = (POINT3DZ *)((uint8_t*)gs->data + 8);
+	return *point;
 }
 
 /* Compare two points from serialized geometries */
@@ -195,32 +203,173 @@ datum_point_eq(Datum geopoint1, Datum geopoint2)
 	}
 }
 
-static Datum
-datum_setprecision(Datum value, Datum size)
+/*
+ * Hash value of a point computed from its coordinates, which is consistent
+ * with the equality of points above
+ */
+uint32
+datum_point_hash(Datum geopoint)
 {
-	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value);
-	int srid = gserialized_get_srid(gs);
-	LWPOINT *lwpoint;
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(geopoint);
+	uint32 result;
 	if (FLAGS_GET_Z(gs->flags))
 	{
 		POINT3DZ point = gs_get_point3dz(gs);
-		double x = DatumGetFloat8(datum_round(Float8GetDatum(point.x), size));
-		double y = DatumGetFloat8(datum_round(Float8GetDatum(point.y), size));
-		double z = DatumGetFloat8(datum_round(Float8GetDatum(point.z), size));
-		lwpoint = lwpoint_make3dz(srid, x, y, z);
+		result = double_hash(point.x);
+		result = (result << 5) - result + double_hash(point.y);
+		result = (result << 5) - result + double_hash(point.z);
 	}
 	else
 	{
 		POINT2D point = gs_get_point2d(gs);
-		double x = DatumGetFloat8(datum_round(Float8GetDatum(point.x), size));
-		double y = DatumGetFloat8(datum_round(Float8GetDatum(point.y), size));
-		lwpoint = lwpoint_make2d(srid, x, y);
+		result = double_hash(point.x);
+		result = (result << 5) - result + double_hash(point.y);
 	}
-	Datum result = PointerGetDatum(geometry_serialize((LWGEOM *)lwpoint));
-	pfree(lwpoint);
 	return result;
 }
 
+/*
+ * Get the 2D bounding box of a geometry. Returns false if the geometry is
+ * empty, in which case no segment can overlap it.
+ */
+bool
+geo_get_gbox2d(Datum geo, GBOX *box)
+{
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(geo);
+	return gserialized_get_gbox_p(gs, box) == LW_SUCCESS;
+}
+
+/*
+ * Determine whether the 2D bounding box of the segment defined by two
+ * points overlaps the bounding box of a geometry. When it does not, the
+ * segment cannot intersect the geometry and the expensive computation of
+ * the intersection with GEOS can be avoided.
+ */
+bool
+geopoint_segment_overlaps_gbox2d(Datum start, Datum end, const GBOX *box)
+{
+	POINT2D p1 = datum_get_point2d(start);
+	POINT2D p2 = datum_get_point2d(end);
+	return Max(p1.x, p2.x) >= box->xmin && Min(p1.x, p2.x) <= box->xmax &&
+		Max(p1.y, p2.y) >= box->ymin && Min(p1.y, p2.y) <= box->ymax;
+}
+
+/* Round the coordinates of a serialized point in place, which keeps its 
+ * SRID and flags, without building an LWGEOM */
+
+static void
+point_setprecision_inplace(GSERIALIZED *gs, Datum size)
+{
+	double *coords = (double *)((uint8_t*)gs->data + 8);
+	int ncoords = FLAGS_GET_Z(gs->flags) ? 3 : 2;
+	for (int i = 0; i < ncoords; i++)
+		coords[i] = DatumGetFloat8(datum_round(Float8GetDatum(coords[i]), size));
+}
+
+/* Round the coordinates of a point. The coordinates are rounded in a copy of
+ * the serialized point */
+
+static Datum
+datum_setprecision(Datum value, Datum size)
+{
+	GSERIALIZED *gs = gserialized_copy((GSERIALIZED *)DatumGetPointer(value));
+	point_setprecision_inplace(gs, size);
+	return PointerGetDatum(gs);
+}
+
+/*
+ * Flags of the extended WKB format of PostGIS, copied from file
+ * liblwgeom_internal.h
+ */
+#define WKB_POINTTYPE	1
+#define WKBZOFFSET		0x80000000
+#define WKBSRIDFLAG		0x20000000
+
+/*
+ * Write a geometry point in the extended WKB format produced by the send
+ * function of PostGIS, preceded by its length, without going through the 
+ * fmgr nor building an intermediate LWGEOM
+ */
+void
+geompoint_write(Datum value, StringInfo buf)
+{
+	GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(value);
+	int32 srid = gserialized_get_srid(gs);
+	bool hasz = FLAGS_GET_Z(gs->flags);
+	uint32 type = WKB_POINTTYPE;
+	if (hasz)
+		type |= WKBZOFFSET;
+	if (srid != SRID_UNKNOWN)
+		type |= WKBSRIDFLAG;
+	int size = 1 + sizeof(uint32) + (srid != SRID_UNKNOWN ? sizeof(int32) : 0) +
+		(hasz ? 3 : 2) * sizeof(double);
+	pq_sendint32(buf, (uint32) size);
+	/* The WKB is written in the machine byte order as done by PostGIS */
+	appendStringInfoChar(buf, getMachineEndian());
+	appendBinaryStringInfo(buf, (char *) &type, sizeof(uint32));
+	if (srid != SRID_UNKNOWN)
+		appendBinaryStringInfo(buf, (char *) &srid, sizeof(int32));
+	if (hasz)
+	{
+		POINT3DZ point = gs_get_point3dz(gs);
+		appendBinaryStringInfo(buf, (char *) &point, sizeof(POINT3DZ));
+	}
+	else
+	{
+		POINT2D point = gs_get_point2d(gs);
+		appendBinaryStringInfo(buf, (char *) &point, sizeof(POINT2D));
+	}
+}
+
+/*
+ * Read a geometry point written in the extended WKB format in the machine 
+ * byte order. Returns false without consuming the buffer if the WKB is not 
+ * such a point, in which case the receive function of PostGIS must be used.
+ */
+bool
+geompoint_read(StringInfo buf, Datum *result)
+{
+	const char *wkb = buf->data + buf->cursor;
+	int len = buf->len - buf->cursor;
+	uint32 type;
+	int32 srid = SRID_UNKNOWN;
+	int pos = 1 + sizeof(uint32);
+	LWPOINT *lwpoint;
+
+	if (len < pos || wkb[0] != getMachineEndian())
+		return false;
+	memcpy(&type, wkb + 1, sizeof(uint32));
+	if ((type & ~(WKBZOFFSET | WKBSRIDFLAG)) != WKB_POINTTYPE)
+		return false;
+	bool hasz = (type & WKBZOFFSET) != 0;
+	if (type & WKBSRIDFLAG)
+	{
+		if (len < pos + (int) sizeof(int32))
+			return false;
+		memcpy(&srid, wkb + pos, sizeof(int32));
+		pos += sizeof(int32);
+	}
+	if (len != pos + (hasz ? 3 : 2) * (int) sizeof(double))
+		return false;
+
+	if (hasz)
+	{
+		POINT3DZ point;
+		memcpy(&point, wkb + pos, sizeof(POINT3DZ));
+		lwpoint = lwpoint_make3dz(srid, point.x, point.y, point.z);
+	}
+	else
+	{
+		POINT2D point;
+		memcpy(&point, wkb + pos, sizeof(POINT2D));
+		lwpoint = lwpoint_make2d(srid, point.x, point.y);
+	}
+	*result = PointerGetDatum(geometry_serialize((LWGEOM *) lwpoint));
+	lwpoint_free(lwpoint);
+	buf->cursor = buf->len;
+	return true;
+}
+
 /* Serialize a geometry */
 
 GSERIALIZED *
@@ -234,12 +383,6 @@ geometry_serialize(LWGEOM *geom)
 
 /* Call to PostGIS external functions */
 
-static Datum
-datum_transform(Datum value, Datum srid)
-{
-	return call_function2(transform, value, srid);
-}
-
 static Datum
 geog_to_geom(Datum value)
 {
@@ -324,96 +467,292 @@ tpoint_srid(PG_FUNCTION_ARGS)
 
 /* TemporalInst */
 
-static TemporalInst *
+static void
 tpointinst_set_srid(TemporalInst *inst, int32 srid)
 {
-	TemporalInst *result = temporalinst_copy(inst);
-	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(temporalinst_value(result));
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(temporalinst_value(inst));
 	gserialized_set_srid(gs, srid);
-	return result;
 }
 
-static TemporalI *
+static void
 tpointi_set_srid(TemporalI *ti, int32 srid)
 {
-	TemporalI *result = temporali_copy(ti);
 	for (int i = 0; i < ti->count; i++)
-	{
-		TemporalInst *inst = temporali_inst_n(result, i);
-		GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(temporalinst_value(inst));
-		gserialized_set_srid(gs, srid);
-	}
-	return result;
+		tpointinst_set_srid(temporali_inst_n(ti, i), srid);
 }
 
-static TemporalSeq *
+static void
 tpointseq_set_srid(TemporalSeq *seq, int32 srid)
 {
-	TemporalSeq *result = temporalseq_copy(seq);
 	for (int i = 0; i < seq->count; i++)
-	{
-		TemporalInst *inst = temporalseq_inst_n(result, i);
-		GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(temporalinst_value(inst));
-		gserialized_set_srid(gs, srid);
-	}
-	return result;
+		tpointinst_set_srid(temporalseq_inst_n(seq, i), srid);
 }
 
-static TemporalS *
+static void
 tpoints_set_srid(TemporalS *ts, int32 srid)
 {
-	TemporalS *result = temporals_copy(ts);
 	for (int i = 0; i < ts->count; i++)
-	{
-		TemporalSeq *seq = temporals_seq_n(result, i);
-		for (int j = 0; j < seq->count; j++)
-		{
-			TemporalInst *inst = temporalseq_inst_n(seq, j);
-			GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(temporalinst_value(inst));
-			gserialized_set_srid(gs, srid);
-		}
-	}
-	return result;
+		tpointseq_set_srid(temporals_seq_n(ts, i), srid);
 }
 
-Temporal *
-tpoint_set_srid_internal(Temporal *temp, int32 srid)
+/* Set the SRID of a temporal point, overwriting the value */
+
+void
+tpoint_set_srid_inplace(Temporal *temp, int32 srid)
 {
-	Temporal *result = NULL;
 	if (temp->duration == TEMPORALINST)
-		result = (Temporal *)tpointinst_set_srid((TemporalInst *)temp, srid);
+		tpointinst_set_srid((TemporalInst *)temp, srid);
 	else if (temp->duration == TEMPORALI)
-		result = (Temporal *)tpointi_set_srid((TemporalI *)temp, srid);
+		tpointi_set_srid((TemporalI *)temp, srid);
 	else if (temp->duration == TEMPORALSEQ)
-		result = (Temporal *)tpointseq_set_srid((TemporalSeq *)temp, srid);
+		tpointseq_set_srid((TemporalSeq *)temp, srid);
 	else if (temp->duration == TEMPORALS)
-		result = (Temporal *)tpoints_set_srid((TemporalS *)temp, srid);
+		tpoints_set_srid((TemporalS *)temp, srid);
+}
 
-	assert(result != NULL);
+Temporal *
+tpoint_set_srid_internal(Temporal *temp, int32 srid)
+{
+	Temporal *result = temporal_copy(temp);
+	tpoint_set_srid_inplace(result, srid);
 	return result;
 }
 
 PG_FUNCTION_INFO_V1(tpoint_set_srid);
 
+/* The SRID is set in place in an expanded value, see temporal_expanded.c */
+
 PGDLLEXPORT Datum
 tpoint_set_srid(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	ExpandedTemporal *et = temporal_expand_rw(PG_GETARG_DATUM(0));
 	int32 srid = PG_GETARG_INT32(1);
-	Temporal *result = tpoint_set_srid_internal(temp, srid) ;
-	PG_FREE_IF_COPY(temp, 0);
-	PG_RETURN_POINTER(result);
+	tpoint_set_srid_inplace(et->temp, srid);
+	PG_RETURN_EXPANDED_TEMPORAL(et);
 }
 
 /*****************************************************************************/
 
+/*
+ * Cache of the projections used for transforming temporal points, kept in
+ * backend memory for the lifetime of the backend. Each entry keeps the
+ * projections of a pair of source and target SRIDs. When the cache is full
+ * the entries are replaced in a round-robin fashion.
+ */
+#define PROJ_CACHE_SIZE 8
+
+typedef struct
+{
+	int32 srid_from;
+	int32 srid_to;
+	projPJ pj_from;
+	projPJ pj_to;
+} ProjCacheItem;
+
+static ProjCacheItem proj_cache[PROJ_CACHE_SIZE];
+static int proj_cache_count = 0;
+static int proj_cache_next = 0;
+
+static projPJ
+tpoint_make_projection(int32 srid)
+{
+	char *srs = getSRSbySRID(srid, false);
+	if (srs == NULL)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("Cannot find SRID (%d) in spatial_ref_sys", srid)));
+	projPJ result = lwproj_from_string(srs);
+	if (result == NULL)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("Could not form projection from 'srid=%d' to 'proj4text=%s'",
+				srid, srs)));
+	pfree(srs);
+	return result;
+}
+
+static void
+tpoint_get_projections(int32 srid_from, int32 srid_to, projPJ *pj_from,
+	projPJ *pj_to)
+{
+	for (int i = 0; i < proj_cache_count; i++)
+	{
+		if (proj_cache[i].srid_from == srid_from &&
+			proj_cache[i].srid_to == srid_to)
+		{
+			*pj_from = proj_cache[i].pj_from;
+			*pj_to = proj_cache[i].pj_to;
+			return;
+		}
+	}
+	/* Build the projections before evicting an entry since this may fail */
+	projPJ from = tpoint_make_projection(srid_from);
+	projPJ to = tpoint_make_projection(srid_to);
+	ProjCacheItem *item;
+	if (proj_cache_count < PROJ_CACHE_SIZE)
+		item = &proj_cache[proj_cache_count++];
+	else
+	{
+		item = &proj_cache[proj_cache_next];
+		proj_cache_next = (proj_cache_next + 1) % PROJ_CACHE_SIZE;
+		pj_free(item->pj_from);
+		pj_free(item->pj_to);
+	}
+	item->srid_from = srid_from;
+	item->srid_to = srid_to;
+	item->pj_from = *pj_from = from;
+	item->pj_to = *pj_to = to;
+}
+
+/*
+ * Transform an array of temporal geometry point instants into another
+ * spatial reference system. The coordinates of all the instants are
+ * transformed with a single call to PROJ and a single point is serialized
+ * per instant.
+ */
+static void
+tgeompointinstarr_transform(TemporalInst **result, TemporalInst **instants,
+	int count, int32 srid)
+{
+	int32 srid_from = tpoint_srid_internal((Temporal *) instants[0]);
+	if (srid_from == SRID_UNKNOWN)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("Input geometry has unknown (%d) SRID", SRID_UNKNOWN)));
+	if (srid == SRID_UNKNOWN)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("%d is an invalid target SRID", SRID_UNKNOWN)));
+	/* Nothing to transform */
+	if (srid_from == srid)
+	{
+		for (int i = 0; i < count; i++)
+			result[i] = temporalinst_copy(instants[i]);
+		return;
+	}
+
+	projPJ pj_from, pj_to;
+	tpoint_get_projections(srid_from, srid, &pj_from, &pj_to);
+	bool hasz = MOBDB_FLAGS_GET_Z(instants[0]->flags);
+	double *x = palloc(sizeof(double) * count);
+	double *y = palloc(sizeof(double) * count);
+	double *z = hasz ? palloc(sizeof(double) * count) : NULL;
+	for (int i = 0; i < count; i++)
+	{
+		GSERIALIZED *gs = (GSERIALIZED *) DatumGetPointer(
+			temporalinst_value(instants[i]));
+		if (hasz)
+		{
+			POINT3DZ point = gs_get_point3dz(gs);
+			x[i] = point.x; y[i] = point.y; z[i] = point.z;
+		}
+		else
+		{
+			POINT2D point = gs_get_point2d(gs);
+			x[i] = point.x; y[i] = point.y;
+		}
+	}
+	/* PROJ expects and returns geographic coordinates in radians */
+	if (pj_is_latlong(pj_from))
+		for (int i = 0; i < count; i++)
+		{
+			x[i] *= DEG_TO_RAD;
+			y[i] *= DEG_TO_RAD;
+		}
+	int error = pj_transform(pj_from, pj_to, count, 1, x, y, z);
+	if (error != 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("Transform error: %s", pj_strerrno(error))));
+	if (pj_is_latlong(pj_to))
+		for (int i = 0; i < count; i++)
+		{
+			x[i] *= RAD_TO_DEG;
+			y[i] *= RAD_TO_DEG;
+		}
+
+	for (int i = 0; i < count; i++)
+	{
+		LWPOINT *lwpoint = hasz ? lwpoint_make3dz(srid, x[i], y[i], z[i]) :
+			lwpoint_make2d(srid, x[i], y[i]);
+		GSERIALIZED *gs = geometry_serialize((LWGEOM *) lwpoint);
+		result[i] = temporalinst_make(PointerGetDatum(gs), instants[i]->t,
+			type_oid(T_GEOMETRY));
+		pfree(gs);
+		lwpoint_free(lwpoint);
+	}
+	pfree(x); pfree(y);
+	if (hasz)
+		pfree(z);
+}
+
 /* Transform a temporal geometry point into another spatial reference system */
 
 TemporalInst *
 tgeompointinst_transform(TemporalInst *inst, Datum srid)
 {
-	return tfunc2_temporalinst(inst, srid, &datum_transform,
-		type_oid(T_GEOMETRY));
+	TemporalInst *result;
+	tgeompointinstarr_transform(&result, &inst, 1, DatumGetInt32(srid));
+	return result;
+}
+
+static TemporalI *
+tgeompointi_transform(TemporalI *ti, int32 srid)
+{
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
+	for (int i = 0; i < ti->count; i++)
+		instants[i] = temporali_inst_n(ti, i);
+	tgeompointinstarr_transform(instants, instants, ti->count, srid);
+	TemporalI *result = temporali_from_temporalinstarr(instants, ti->count);
+	for (int i = 0; i < ti->count; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	return result;
+}
+
+static TemporalSeq *
+tgeompointseq_transform(TemporalSeq *seq, int32 srid)
+{
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	for (int i = 0; i < seq->count; i++)
+		instants[i] = temporalseq_inst_n(seq, i);
+	tgeompointinstarr_transform(instants, instants, seq->count, srid);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants,
+		seq->count, seq->period.lower_inc, seq->period.upper_inc,
+		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
+	for (int i = 0; i < seq->count; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	return result;
+}
+
+static TemporalS *
+tgeompoints_transform(TemporalS *ts, int32 srid)
+{
+	/* The instants of all the sequences are transformed at once */
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ts->totalcount);
+	int k = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		for (int j = 0; j < seq->count; j++)
+			instants[k++] = temporalseq_inst_n(seq, j);
+	}
+	tgeompointinstarr_transform(instants, instants, k, srid);
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+	k = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		sequences[i] = temporalseq_from_temporalinstarr(&instants[k],
+			seq->count, seq->period.lower_inc, seq->period.upper_inc,
+			MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
+		k += seq->count;
+	}
+	TemporalS *result = temporals_from_temporalseqarr(sequences, ts->count,
+		MOBDB_FLAGS_GET_LINEAR(ts->flags), true);
+	for (int i = 0; i < k; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	for (int i = 0; i < ts->count; i++)
+		pfree(sequences[i]);
+	pfree(sequences);
+	return result;
 }
 
 PG_FUNCTION_INFO_V1(tpoint_transform);
@@ -422,9 +761,18 @@ PGDLLEXPORT Datum
 tpoint_transform(PG_FUNCTION_ARGS)
 {
 	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	Datum srid = PG_GETARG_DATUM(1);
-	Temporal *result = tfunc2_temporal(temp, srid, &datum_transform,
-		type_oid(T_GEOMETRY));
+	int32 srid = PG_GETARG_INT32(1);
+	Temporal *result = NULL;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+		result = (Temporal *)tgeompointinst_transform((TemporalInst *)temp,
+			Int32GetDatum(srid));
+	else if (temp->duration == TEMPORALI)
+		result = (Temporal *)tgeompointi_transform((TemporalI *)temp, srid);
+	else if (temp->duration == TEMPORALSEQ)
+		result = (Temporal *)tgeompointseq_transform((TemporalSeq *)temp, srid);
+	else if (temp->duration == TEMPORALS)
+		result = (Temporal *)tgeompoints_transform((TemporalS *)temp, srid);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_RETURN_POINTER(result);
 }
@@ -489,21 +837,83 @@ tgeogpoint_to_tgeompoint(PG_FUNCTION_ARGS)
 
 PG_FUNCTION_INFO_V1(tpoint_setprecision);
 
+/*
+ * The coordinates of a temporal instant or a temporal instant set that is
+ * a read-write expanded value are rounded in place. Otherwise the result is
+ * built anew, since the rounding may make redundant some instants of a 
+ * sequence, and it is returned as an expanded value. See temporal_expanded.c
+ */
 PGDLLEXPORT Datum
 tpoint_setprecision(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	Datum size = PG_GETARG_DATUM(1);
-	Temporal *result = tfunc2_temporal(temp, size, &datum_setprecision,
+	ExpandedTemporal *et = temporal_get_expanded_rw(PG_GETARG_DATUM(0));
+	if (et != NULL && et->temp->duration == TEMPORALINST)
+	{
+		TemporalInst *inst = (TemporalInst *) et->temp;
+		point_setprecision_inplace(
+			(GSERIALIZED *) DatumGetPointer(temporalinst_value(inst)), size);
+		PG_RETURN_EXPANDED_TEMPORAL(et);
+	}
+	if (et != NULL && et->temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *) et->temp;
+		TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
+		for (int i = 0; i < ti->count; i++)
+		{
+			instants[i] = temporali_inst_n(ti, i);
+			point_setprecision_inplace((GSERIALIZED *) DatumGetPointer(
+				temporalinst_value(instants[i])), size);
+		}
+		temporali_make_bbox(temporali_bbox_ptr(ti), instants, ti->count);
+		pfree(instants);
+		PG_RETURN_EXPANDED_TEMPORAL(et);
+	}
+
+	Temporal *temp = et != NULL ? et->temp : PG_GETARG_TEMPORAL(0);
+	ExpandedTemporal *result = expanded_temporal_make();
+	MemoryContext oldcxt = MemoryContextSwitchTo(result->hdr.eoh_context);
+	result->temp = tfunc2_temporal(temp, size, &datum_setprecision,
 		temp->valuetypid);
-	PG_FREE_IF_COPY(temp, 0);
-	PG_RETURN_POINTER(result);
+	MemoryContextSwitchTo(oldcxt);
+	if (et != NULL)
+		/* The argument is dead once the result is built */
+		DeleteExpandedObject(PG_GETARG_DATUM(0));
+	else
+		PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_EXPANDED_TEMPORAL(result);
 }
 
 /*****************************************************************************
  * Trajectory functions.
  *****************************************************************************/
 
+/* Construct a point array from the coordinates of serialized points, which
+ * are read directly without deserializing the points */
+
+static POINTARRAY *
+pointarr_to_ptarray(Datum *points, int count, bool hasz)
+{
+	POINTARRAY *pa = ptarray_construct(hasz, false, (uint32_t) count);
+	POINT4D p;
+	p.z = p.m = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		if (hasz)
+		{
+			POINT3DZ p3d = datum_get_point3dz(points[i]);
+			p.x = p3d.x; p.y = p3d.y; p.z = p3d.z;
+		}
+		else
+		{
+			POINT2D p2d = datum_get_point2d(points[i]);
+			p.x = p2d.x; p.y = p2d.y;
+		}
+		ptarray_set_point4d(pa, (uint32_t) i, &p);
+	}
+	return pa;
+}
+
 /* Compute the trajectory from the points of two consecutive instants with
  * linear interpolation. The functions are called during normalization for
  * determining whether three consecutive points are collinear, for computing
@@ -512,14 +922,15 @@ tpoint_setprecision(PG_FUNCTION_ARGS)
 Datum
 geompoint_trajectory(Datum value1, Datum value2)
 {
-	GSERIALIZED *gs1 = (GSERIALIZED *)DatumGetPointer(value1);
-	GSERIALIZED *gs2 = (GSERIALIZED *)DatumGetPointer(value2);
-	LWGEOM *geoms[2];
-	geoms[0] = lwgeom_from_gserialized(gs1);
-	geoms[1] = lwgeom_from_gserialized(gs2);
-	LWGEOM *traj = (LWGEOM *)lwline_from_lwgeom_array(geoms[0]->srid, 2, geoms);
-	GSERIALIZED *result = geometry_serialize(traj);
-	lwgeom_free(geoms[0]); lwgeom_free(geoms[1]); lwgeom_free(traj);
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(value1);
+	Datum points[2];
+	points[0] = value1;
+	points[1] = value2;
+	POINTARRAY *pa = pointarr_to_ptarray(points, 2,
+		(bool) FLAGS_GET_Z(gs->flags));
+	LWLINE *traj = lwline_construct(gserialized_get_srid(gs), NULL, pa);
+	GSERIALIZED *result = geometry_serialize((LWGEOM *) traj);
+	lwline_free(traj);
 	return PointerGetDatum(result);
 }
 
@@ -542,22 +953,20 @@ geogpoint_trajectory(Datum value1, Datum value2)
 static Datum
 pointarr_make_trajectory(Datum *points, int count, bool linear)
 {
-	LWGEOM **lwpoints = palloc(sizeof(LWGEOM *) * count);
-	for (int i = 0; i < count; i++)
-	{
-		GSERIALIZED *gs = (GSERIALIZED *)PointerGetDatum(points[i]);
-		lwpoints[i] = lwgeom_from_gserialized(gs);
-	}
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(points[0]);
+	int srid = gserialized_get_srid(gs);
+	POINTARRAY *pa = pointarr_to_ptarray(points, count,
+		(bool) FLAGS_GET_Z(gs->flags));
 	LWGEOM *geom;
 	if (linear)
-		geom = (LWGEOM *) lwline_from_lwgeom_array(lwpoints[0]->srid, (uint32_t) count, lwpoints);
+		geom = (LWGEOM *) lwline_construct(srid, NULL, pa);
 	else
-		geom = (LWGEOM *) lwcollection_construct(MULTIPOINTTYPE, lwpoints[0]->srid,
-			NULL, (uint32_t) count, lwpoints);
+	{
+		geom = (LWGEOM *) lwmpoint_construct(srid, pa);
+		ptarray_free(pa);
+	}
 	Datum result = PointerGetDatum(geometry_serialize(geom));
-	for (int i = 0; i < count; i++)
-		lwgeom_free(lwpoints[i]);
-	pfree(lwpoints); pfree(geom);
+	lwgeom_free(geom);
 	return result;
 }
 
@@ -634,13 +1043,31 @@ tpointseq_make_trajectory(TemporalInst **instants, int count, bool linear)
 	return result;	
 }
 
-/* Get the precomputed trajectory of a tpointseq */
+/* Compute the trajectory of a tpointseq that does not store it */
+
+static Datum
+tpointseq_compute_trajectory(TemporalSeq *seq)
+{
+	TemporalInst **instants = temporalseq_instants(seq);
+	Datum result = tpointseq_make_trajectory(instants, seq->count, 
+		MOBDB_FLAGS_GET_LINEAR(seq->flags));
+	pfree(instants);
+	return result;
+}
+
+/* Get the precomputed trajectory of a tpointseq 
+ * If the trajectory is not stored in the sequence it is computed in the
+ * current memory context, which is reset together with the rest of the
+ * intermediate results of the query. Therefore, as for a stored trajectory,
+ * the result must not be freed by the calling function. */
 
 Datum
 tpointseq_trajectory(TemporalSeq *seq)
 {
-	void *traj = (char *)(&seq->offsets[seq->count + 2]) + 	/* start of data */
-			seq->offsets[seq->count + 1];					/* offset */
+	if (! MOBDB_FLAGS_GET_TRAJ(seq->flags))
+		return tpointseq_compute_trajectory(seq);
+	void *traj = TEMPORAL_DATA_PTR(seq->offsets, seq->flags, seq->count + 2) + /* start of data */
+			TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, seq->count + 1);		/* offset */
 	return PointerGetDatum(traj);
 }
 
@@ -723,8 +1150,10 @@ tpointseq_trajectory_append(TemporalSeq *seq, TemporalInst *inst, bool replace)
 Datum
 tpointseq_trajectory_copy(TemporalSeq *seq)
 {
-	void *traj = (char *)(&seq->offsets[seq->count + 2]) + 	/* start of data */
-			seq->offsets[seq->count + 1];					/* offset */
+	if (! MOBDB_FLAGS_GET_TRAJ(seq->flags))
+		return tpointseq_compute_trajectory(seq);
+	void *traj = TEMPORAL_DATA_PTR(seq->offsets, seq->flags, seq->count + 2) + /* start of data */
+			TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, seq->count + 1);		/* offset */
 	return PointerGetDatum(gserialized_copy(traj));
 }
 
@@ -881,26 +1310,92 @@ tpoint_trajectory(PG_FUNCTION_ARGS)
  * Length functions
  *****************************************************************************/
 
+/*
+ * Planar length of the segments of a temporal point sequence, computed in a
+ * single pass on the coordinates of the instants. The length of the segment
+ * ending at the i-th instant is stored in lengths[i - 1]. The computation
+ * is the one of the PostGIS function ST_3DLength, so that the sum of the
+ * lengths is equal to the length of the trajectory of a geometry point.
+ */
+static void
+tpointseq_segment_lengths(TemporalSeq *seq, double *lengths)
+{
+	GSERIALIZED *gs = (GSERIALIZED *)DatumGetPointer(
+		temporalinst_value(temporalseq_inst_n(seq, 0)));
+	if (MOBDB_FLAGS_GET_Z(seq->flags))
+	{
+		POINT3DZ frm = gs_get_point3dz(gs);
+		for (int i = 1; i < seq->count; i++)
+		{
+			gs = (GSERIALIZED *)DatumGetPointer(
+				temporalinst_value(temporalseq_inst_n(seq, i)));
+			POINT3DZ to = gs_get_point3dz(gs);
+			lengths[i - 1] = sqrt(((frm.x - to.x) * (frm.x - to.x)) +
+				((frm.y - to.y) * (frm.y - to.y)) +
+				((frm.z - to.z) * (frm.z - to.z)));
+			frm = to;
+		}
+	}
+	else
+	{
+		POINT2D frm = gs_get_point2d(gs);
+		for (int i = 1; i < seq->count; i++)
+		{
+			gs = (GSERIALIZED *)DatumGetPointer(
+				temporalinst_value(temporalseq_inst_n(seq, i)));
+			POINT2D to = gs_get_point2d(gs);
+			lengths[i - 1] = sqrt(((frm.x - to.x) * (frm.x - to.x)) +
+				((frm.y - to.y) * (frm.y - to.y)));
+			frm = to;
+		}
+	}
+}
+
+/* Length traversed by the temporal geography point computed on the sphere */
+
+static double
+tgeogpointseq_length_sphere(TemporalSeq *seq)
+{
+	double result = 0.0;
+	POINT2D p1 = datum_get_point2d(temporalinst_value(temporalseq_inst_n(seq, 0)));
+	for (int i = 1; i < seq->count; i++)
+	{
+		POINT2D p2 = datum_get_point2d(temporalinst_value(temporalseq_inst_n(seq, i)));
+		result += geog_point_distance_sphere(&p1, &p2);
+		p1 = p2;
+	}
+	return result;
+}
+
 /* Length traversed by the temporal point */
 
 static double
 tpointseq_length(TemporalSeq *seq)
 {
 	assert(MOBDB_FLAGS_GET_LINEAR(seq->flags));
+	ensure_point_base_type(seq->valuetypid);
+	if (seq->count == 1)
+		return 0;
+	double result = 0.0;
+	if (seq->valuetypid == type_oid(T_GEOMETRY))
+	{
+		/* Sum the lengths of the segments rather than measuring the trajectory */
+		double *lengths = palloc(sizeof(double) * (seq->count - 1));
+		tpointseq_segment_lengths(seq, lengths);
+		for (int i = 0; i < seq->count - 1; i++)
+			result += lengths[i];
+		pfree(lengths);
+		return result;
+	}
+	if (geodetic_fast_path)
+		return tgeogpointseq_length_sphere(seq);
 	Datum traj = tpointseq_trajectory(seq);
 	GSERIALIZED *gstraj = (GSERIALIZED *)DatumGetPointer(traj);
 	if (gserialized_get_type(gstraj) == POINTTYPE)
 		return 0;
-	
 	/* We are sure that the trajectory is a line */
-	double result = 0.0;
-	ensure_point_base_type(seq->valuetypid);
-	if (seq->valuetypid == type_oid(T_GEOMETRY))
-		/* The next function call works for 2D and 3D */
-		result = DatumGetFloat8(call_function1(LWGEOM_length_linestring, traj));
-	else if (seq->valuetypid == type_oid(T_GEOGRAPHY))
-		result = DatumGetFloat8(call_function2(geography_length, traj,
-			BoolGetDatum(true)));
+	result = DatumGetFloat8(call_function2(geography_length, traj,
+		BoolGetDatum(true)));
 	return result;
 }
 
@@ -990,27 +1485,18 @@ tpointseq_cumulative_length(TemporalSeq *seq, double prevlength)
 	else
 	/* Linear interpolation */
 	{
-		TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
-		Datum value1 = temporalinst_value(inst1);
+		double *lengths = palloc(sizeof(double) * (seq->count - 1));
+		tpointseq_segment_lengths(seq, lengths);
 		double length = prevlength;
-		instants[0] = temporalinst_make(Float8GetDatum(length), inst1->t,
-				FLOAT8OID);
+		instants[0] = temporalinst_make(Float8GetDatum(length),
+			seq->period.lower, FLOAT8OID);
 		for (int i = 1; i < seq->count; i++)
 		{
-			TemporalInst *inst2 = temporalseq_inst_n(seq, i);
-			Datum value2 = temporalinst_value(inst2);
-			if (datum_ne(value1, value2, inst1->valuetypid))
-			{
-				Datum line = geompoint_trajectory(value1, value2);
-				/* The next function works for 2D and 3D */
-				length += DatumGetFloat8(call_function1(LWGEOM_length_linestring, line));	
-				pfree(DatumGetPointer(line));
-			}
-			instants[i] = temporalinst_make(Float8GetDatum(length), inst2->t,
-				FLOAT8OID);
-			inst1 = inst2;
-			value1 = value2;
+			length += lengths[i - 1];
+			instants[i] = temporalinst_make(Float8GetDatum(length),
+				temporalseq_inst_n(seq, i)->t, FLOAT8OID);
 		}
+		pfree(lengths);
 	}
 	TemporalSeq *result = temporalseq_from_temporalinstarr(instants,
 		seq->count, seq->period.lower_inc, seq->period.upper_inc,
@@ -1093,6 +1579,14 @@ tpointseq_speed(TemporalSeq *seq)
 		TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
 		Datum value1 = temporalinst_value(inst1);
 		double speed;
+		ensure_point_base_type(seq->valuetypid);
+		/* The lengths of the segments of geometry points are computed at once */
+		double *lengths = NULL;
+		if (seq->valuetypid == type_oid(T_GEOMETRY))
+		{
+			lengths = palloc(sizeof(double) * (seq->count - 1));
+			tpointseq_segment_lengths(seq, lengths);
+		}
 		for (int i = 0; i < seq->count - 1; i++)
 		{
 			TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
@@ -1101,16 +1595,16 @@ tpointseq_speed(TemporalSeq *seq)
 				speed = 0;
 			else
 			{
-				Datum traj = geompoint_trajectory(value1, value2);
-				double length = 0.0; /* Make compiler quiet */
-				ensure_point_base_type(seq->valuetypid);
-				if (seq->valuetypid == type_oid(T_GEOMETRY))
-					/* The next function works for 2D and 3D */
-					length = DatumGetFloat8(call_function1(LWGEOM_length_linestring, traj));
-				else if (seq->valuetypid == type_oid(T_GEOGRAPHY))
+				double length;
+				if (lengths != NULL)
+					length = lengths[i];
+				else
+				{
+					Datum traj = geompoint_trajectory(value1, value2);
 					length = DatumGetFloat8(call_function2(geography_length, traj,
 						BoolGetDatum(true)));
-				pfree(DatumGetPointer(traj));
+					pfree(DatumGetPointer(traj));
+				}
 				speed = length / ((double)(inst2->t - inst1->t) / 1000000);
 			}
 			instants[i] = temporalinst_make(Float8GetDatum(speed), inst1->t,
@@ -1120,6 +1614,8 @@ tpointseq_speed(TemporalSeq *seq)
 		}			
 		instants[seq->count - 1] = temporalinst_make(Float8GetDatum(speed),
 			seq->period.upper, FLOAT8OID);
+		if (lengths != NULL)
+			pfree(lengths);
 	}
 	/* The resulting sequence has stepwise interpolation */
 	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, seq->count,
@@ -1626,11 +2122,18 @@ tpointi_at_geometry(TemporalI *ti, Datum geom)
  */
 static TemporalSeq **
 tpointseq_at_geometry1(TemporalInst *inst1, TemporalInst *inst2, bool linear,
-	bool lower_inc, bool upper_inc, Datum geom, int *count)
+	bool lower_inc, bool upper_inc, Datum geom, const GBOX *box, int *count)
 {
 	Datum value1 = temporalinst_value(inst1);
 	Datum value2 = temporalinst_value(inst2);
 
+	/* The bounding box of the segment does not overlap the geometry */
+	if (! geopoint_segment_overlaps_gbox2d(value1, value2, box))
+	{
+		*count = 0;
+		return NULL;
+	}
+
 	/* Constant segment or stepwise interpolation */
 	bool equal = datum_point_eq(value1, value2);
 	if (equal || ! linear)
@@ -1753,6 +2256,12 @@ tpointseq_at_geometry2(TemporalSeq *seq, Datum geom, int *count)
 	}
 
 	/* Temporal sequence has at least 2 instants */
+	GBOX box;
+	if (! geo_get_gbox2d(geom, &box))
+	{
+		*count = 0;
+		return NULL;
+	}
 	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
 	TemporalSeq ***sequences = palloc(sizeof(TemporalSeq *) * (seq->count - 1));
 	int *countseqs = palloc0(sizeof(int) * (seq->count - 1));
@@ -1764,7 +2273,7 @@ tpointseq_at_geometry2(TemporalSeq *seq, Datum geom, int *count)
 		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
 		bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
 		sequences[i] = tpointseq_at_geometry1(inst1, inst2, linear,
-			lower_inc, upper_inc, geom, &countseqs[i]);
+			lower_inc, upper_inc, geom, &box, &countseqs[i]);
 		totalseqs += countseqs[i];
 		inst1 = inst2;
 		lower_inc = true;
@@ -1994,109 +2503,1019 @@ tpointseq_minus_geometry(TemporalSeq *seq, Datum geom)
 	return result;
 }
 
-static TemporalS *
-tpoints_minus_geometry(TemporalS *ts, GSERIALIZED *gs, STBOX *box2)
+static TemporalS *
+tpoints_minus_geometry(TemporalS *ts, GSERIALIZED *gs, STBOX *box2)
+{
+	/* Singleton sequence set */
+	if (ts->count == 1)
+		return tpointseq_minus_geometry(temporals_seq_n(ts, 0),
+			PointerGetDatum(gs));
+
+	TemporalSeq ***sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+	int *countseqs = palloc0(sizeof(int) * ts->count);
+	int totalseqs = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		/* Bounding box test */
+		STBOX *box1 = temporalseq_bbox_ptr(seq);
+		if (!overlaps_stbox_stbox_internal(box1, box2))
+		{
+			sequences[i] = palloc(sizeof(TemporalSeq *));
+			sequences[i][0] = temporalseq_copy(seq);
+			countseqs[i] = 1;
+			totalseqs ++;
+		}
+		else
+		{
+			sequences[i] = tpointseq_minus_geometry1(seq, PointerGetDatum(gs),
+				&countseqs[i]);
+			totalseqs += countseqs[i];
+		}
+	}
+	if (totalseqs == 0)
+	{
+		pfree(sequences); pfree(countseqs);
+		return NULL;
+	}
+
+	TemporalSeq **allsequences = palloc(sizeof(TemporalSeq *) * totalseqs);
+	int k = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		for (int j = 0; j < countseqs[i]; j++)
+			allsequences[k++] = sequences[i][j];
+		if (countseqs[i] != 0)
+			pfree(sequences[i]);
+	}
+	TemporalS *result = temporals_from_temporalseqarr(allsequences, totalseqs,
+		MOBDB_FLAGS_GET_LINEAR(ts->flags), true);
+
+	for (int i = 0; i < totalseqs; i++)
+		pfree(allsequences[i]);
+	pfree(allsequences); pfree(sequences); pfree(countseqs);
+
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_minus_geometry);
+
+PGDLLEXPORT Datum
+tpoint_minus_geometry(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
+	ensure_same_srid_tpoint_gs(temp, gs);
+	ensure_same_dimensionality_tpoint_gs(temp, gs);
+	/* Bounding box test */
+	STBOX box1, box2;
+	memset(&box1, 0, sizeof(STBOX));
+	memset(&box2, 0, sizeof(STBOX));
+	if (!geo_to_stbox_internal(&box2, gs))
+	{
+		Temporal *copy = temporal_copy(temp) ;
+		PG_FREE_IF_COPY(temp, 0);
+		PG_FREE_IF_COPY(gs, 1);
+		PG_RETURN_POINTER(copy);
+	}
+	temporal_bbox(&box1, temp);
+	if (!overlaps_stbox_stbox_internal(&box1, &box2))
+	{
+		Temporal *copy = temporal_copy(temp) ;
+		PG_FREE_IF_COPY(temp, 0);
+		PG_FREE_IF_COPY(gs, 1);
+		PG_RETURN_POINTER(copy);
+	}
+
+	Temporal *result = NULL;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+		result = (Temporal *)tpointinst_minus_geometry((TemporalInst *)temp,
+			PointerGetDatum(gs));
+	else if (temp->duration == TEMPORALI)
+		result = (Temporal *)tpointi_minus_geometry((TemporalI *)temp,
+			PointerGetDatum(gs));
+	else if (temp->duration == TEMPORALSEQ)
+		result = (Temporal *)tpointseq_minus_geometry((TemporalSeq *)temp,
+			PointerGetDatum(gs));
+	else if (temp->duration == TEMPORALS)
+		result = (Temporal *)tpoints_minus_geometry((TemporalS *)temp, gs, &box2);
+
+	PG_FREE_IF_COPY(temp, 0);
+	PG_FREE_IF_COPY(gs, 1);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Restriction to a spatiotemporal box
+ * The segments are clipped against the box with the Liang-Barsky algorithm
+ * directly on the coordinates of the points, without calling GEOS
+ *****************************************************************************/
+
+/* Determine whether a point is contained in the spatial extent of a box */
+
+static bool
+stbox_contains_point(const STBOX *box, Datum value, bool hasz)
+{
+	if (hasz)
+	{
+		POINT3DZ p = datum_get_point3dz(value);
+		return box->xmin <= p.x && p.x <= box->xmax &&
+			box->ymin <= p.y && p.y <= box->ymax &&
+			box->zmin <= p.z && p.z <= box->zmax;
+	}
+	POINT2D p = datum_get_point2d(value);
+	return box->xmin <= p.x && p.x <= box->xmax &&
+		box->ymin <= p.y && p.y <= box->ymax;
+}
+
+/*
+ * Clip the fractions [u0, u1] of a segment along one dimension, where the 
+ * coordinate of the segment is start + u * delta. Returns false when no 
+ * part of the segment is between the bounds.
+ */
+static bool
+segment_clip_dim(double start, double delta, double min, double max,
+	double *u0, double *u1)
+{
+	if (delta == 0)
+		return min <= start && start <= max;
+	double f1 = (min - start) / delta;
+	double f2 = (max - start) / delta;
+	if (delta < 0)
+	{
+		double tmp = f1;
+		f1 = f2;
+		f2 = tmp;
+	}
+	if (f1 > *u0)
+		*u0 = f1;
+	if (f2 < *u1)
+		*u1 = f2;
+	return *u0 <= *u1;
+}
+
+/*
+ * Restrict a segment of a temporal point to the spatial extent of a box.
+ * Since the box is convex the result is at most one sequence.
+ */
+static TemporalSeq *
+tpointseq_at_stbox1(TemporalInst *inst1, TemporalInst *inst2, bool linear,
+	bool lower_inc, bool upper_inc, const STBOX *box, bool hasz)
+{
+	Datum value1 = temporalinst_value(inst1);
+	Datum value2 = temporalinst_value(inst2);
+	TemporalInst *instants[2];
+	TemporalSeq *result = NULL;
+
+	/* Stepwise interpolation, the value of the segment is value1 except for 
+	 * an inclusive upper bound whose value is value2 */
+	if (! linear)
+	{
+		bool inside1 = stbox_contains_point(box, value1, hasz);
+		bool inside2 = upper_inc && stbox_contains_point(box, value2, hasz);
+		if (inside1)
+		{
+			instants[0] = inst1;
+			instants[1] = inside2 ? inst2 :
+				temporalinst_make(value1, inst2->t, inst1->valuetypid);
+			result = temporalseq_from_temporalinstarr(instants, 2,
+				lower_inc, inside2, linear, false);
+			if (! inside2)
+				pfree(instants[1]);
+		}
+		else if (inside2)
+			result = temporalseq_from_temporalinstarr(&inst2, 1,
+				true, true, linear, false);
+		return result;
+	}
+
+	/* Linear interpolation */
+	double u0 = 0.0, u1 = 1.0;
+	bool clipped;
+	if (hasz)
+	{
+		POINT3DZ p1 = datum_get_point3dz(value1);
+		POINT3DZ p2 = datum_get_point3dz(value2);
+		clipped = segment_clip_dim(p1.x, p2.x - p1.x, box->xmin, box->xmax, &u0, &u1) &&
+			segment_clip_dim(p1.y, p2.y - p1.y, box->ymin, box->ymax, &u0, &u1) &&
+			segment_clip_dim(p1.z, p2.z - p1.z, box->zmin, box->zmax, &u0, &u1);
+	}
+	else
+	{
+		POINT2D p1 = datum_get_point2d(value1);
+		POINT2D p2 = datum_get_point2d(value2);
+		clipped = segment_clip_dim(p1.x, p2.x - p1.x, box->xmin, box->xmax, &u0, &u1) &&
+			segment_clip_dim(p1.y, p2.y - p1.y, box->ymin, box->ymax, &u0, &u1);
+	}
+	if (! clipped)
+		return NULL;
+
+	double duration = (double)(inst2->t - inst1->t);
+	TimestampTz t1 = inst1->t + (long) (duration * u0);
+	TimestampTz t2 = inst1->t + (long) (duration * u1);
+	bool lower_inc1 = timestamp_cmp_internal(t1, inst1->t) == 0 ?
+		lower_inc : true;
+	bool upper_inc1 = timestamp_cmp_internal(t2, inst2->t) == 0 ?
+		upper_inc : true;
+	/* Restriction at timestamp done to avoid floating point imprecision */
+	if (timestamp_cmp_internal(t1, t2) == 0)
+	{
+		/* The intersection is an exclusive bound of the segment */
+		if (! lower_inc1 || ! upper_inc1)
+			return NULL;
+		instants[0] = temporalseq_at_timestamp1(inst1, inst2, linear, t1);
+		result = temporalseq_from_temporalinstarr(instants, 1,
+			true, true, linear, false);
+		pfree(instants[0]);
+		return result;
+	}
+	instants[0] = temporalseq_at_timestamp1(inst1, inst2, linear, t1);
+	instants[1] = temporalseq_at_timestamp1(inst1, inst2, linear, t2);
+	result = temporalseq_from_temporalinstarr(instants, 2,
+		lower_inc1, upper_inc1, linear, false);
+	pfree(instants[0]); pfree(instants[1]);
+	return result;
+}
+
+/*
+ * Restrict a temporal sequence point to the spatial extent of a box. 
+ * The resulting sequences are added to the array and their number is 
+ * returned.
+ */
+static int
+tpointseq_at_stbox2(TemporalSeq **result, TemporalSeq *seq, const STBOX *box,
+	bool hasz)
+{
+	/* Instantaneous sequence */
+	if (seq->count == 1)
+	{
+		if (! stbox_contains_point(box, 
+				temporalinst_value(temporalseq_inst_n(seq, 0)), hasz))
+			return 0;
+		result[0] = temporalseq_copy(seq);
+		return 1;
+	}
+
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	bool lower_inc = seq->period.lower_inc;
+	int k = 0;
+	for (int i = 0; i < seq->count - 1; i++)
+	{
+		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
+		bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
+		TemporalSeq *seq1 = tpointseq_at_stbox1(inst1, inst2, linear,
+			lower_inc, upper_inc, box, hasz);
+		if (seq1 != NULL)
+			result[k++] = seq1;
+		inst1 = inst2;
+		lower_inc = true;
+	}
+	return k;
+}
+
+static TemporalI *
+tpointi_at_stbox(TemporalI *ti, const STBOX *box, bool hasz)
+{
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
+	int k = 0;
+	for (int i = 0; i < ti->count; i++)
+	{
+		TemporalInst *inst = temporali_inst_n(ti, i);
+		if (stbox_contains_point(box, temporalinst_value(inst), hasz))
+			instants[k++] = inst;
+	}
+	TemporalI *result = NULL;
+	if (k != 0)
+		result = temporali_from_temporalinstarr(instants, k);
+	/* We do not need to pfree the instants */
+	pfree(instants);
+	return result;
+}
+
+static TemporalS *
+tpoints_at_stbox(TemporalS *ts, const STBOX *box, bool hasz)
+{
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->totalcount);
+	int k = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		/* Bounding box test on the sequence */
+		STBOX *box1 = temporalseq_bbox_ptr(seq);
+		if (contains_stbox_stbox_internal(box, box1))
+			sequences[k++] = temporalseq_copy(seq);
+		else if (overlaps_stbox_stbox_internal(box, box1))
+			k += tpointseq_at_stbox2(&sequences[k], seq, box, hasz);
+	}
+	TemporalS *result = NULL;
+	if (k != 0)
+		result = temporals_from_temporalseqarr(sequences, k,
+			MOBDB_FLAGS_GET_LINEAR(ts->flags), true);
+	for (int i = 0; i < k; i++)
+		pfree(sequences[i]);
+	pfree(sequences);
+	return result;
+}
+
+/*
+ * Restrict a temporal point to a spatiotemporal box. The temporal point is
+ * first restricted to the period of the box, if any, and then to its 
+ * spatial extent, if any.
+ */
+Temporal *
+tpoint_at_stbox_internal(Temporal *temp, STBOX *box)
+{
+	/* Restriction to the temporal dimension */
+	Temporal *temp1 = temp;
+	if (MOBDB_FLAGS_GET_T(box->flags))
+	{
+		Period p;
+		period_set(&p, box->tmin, box->tmax, true, true);
+		temp1 = temporal_at_period_internal(temp, &p);
+		if (temp1 == NULL)
+			return NULL;
+	}
+	if (! MOBDB_FLAGS_GET_X(box->flags))
+		return (temp1 == temp) ? temporal_copy(temp) : temp1;
+
+	/* Bounding box test on the spatial dimensions */
+	STBOX box1, box2;
+	memcpy(&box1, box, sizeof(STBOX));
+	MOBDB_FLAGS_SET_T(box1.flags, false);
+	memset(&box2, 0, sizeof(STBOX));
+	temporal_bbox(&box2, temp1);
+	bool hasz = MOBDB_FLAGS_GET_Z(box->flags) && MOBDB_FLAGS_GET_Z(temp->flags);
+	Temporal *result = NULL;
+	if (contains_stbox_stbox_internal(&box1, &box2))
+		result = (temp1 == temp) ? temporal_copy(temp) : temp1;
+	else if (overlaps_stbox_stbox_internal(&box1, &box2))
+	{
+		ensure_valid_duration(temp1->duration);
+		if (temp1->duration == TEMPORALINST)
+			result = stbox_contains_point(&box1, 
+				temporalinst_value((TemporalInst *)temp1), hasz) ?
+				(Temporal *)temporalinst_copy((TemporalInst *)temp1) : NULL;
+		else if (temp1->duration == TEMPORALI)
+			result = (Temporal *)tpointi_at_stbox((TemporalI *)temp1,
+				&box1, hasz);
+		else if (temp1->duration == TEMPORALSEQ)
+		{
+			TemporalSeq *seq = (TemporalSeq *)temp1;
+			TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * seq->count);
+			int count = tpointseq_at_stbox2(sequences, seq, &box1, hasz);
+			if (count != 0)
+				result = (Temporal *)temporals_from_temporalseqarr(sequences,
+					count, MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
+			for (int i = 0; i < count; i++)
+				pfree(sequences[i]);
+			pfree(sequences);
+		}
+		else if (temp1->duration == TEMPORALS)
+			result = (Temporal *)tpoints_at_stbox((TemporalS *)temp1, 
+				&box1, hasz);
+	}
+	if (temp1 != temp && temp1 != result)
+		pfree(temp1);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_at_stbox);
+
+PGDLLEXPORT Datum
+tpoint_at_stbox(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	STBOX *box = PG_GETARG_STBOX_P(1);
+	ensure_same_geodetic_tpoint_stbox(temp, box);
+	Temporal *result = tpoint_at_stbox_internal(temp, box);
+	PG_FREE_IF_COPY(temp, 0);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Restrict a temporal point to the complement of a spatiotemporal box, 
+ * which is the complement of the time during which the temporal point 
+ * is in the box
+ */
+PG_FUNCTION_INFO_V1(tpoint_minus_stbox);
+
+PGDLLEXPORT Datum
+tpoint_minus_stbox(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	STBOX *box = PG_GETARG_STBOX_P(1);
+	ensure_same_geodetic_tpoint_stbox(temp, box);
+	Temporal *result = NULL;
+	Temporal *at = tpoint_at_stbox_internal(temp, box);
+	if (at == NULL)
+		result = temporal_copy(temp);
+	else
+	{
+		PeriodSet *ps = temporal_get_time_internal(at);
+		result = temporal_minus_periodset_internal(temp, ps);
+		pfree(at); pfree(ps);
+	}
+	PG_FREE_IF_COPY(temp, 0);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Tiling
+ * A temporal point is split into pieces according to a spatial grid of cells
+ * of size xsize * ysize with origin (0, 0) and to a grid of time buckets.
+ * The sequences are traversed only once: each segment is split at the
+ * timestamps at which it crosses a grid line or a bucket bound, and the
+ * consecutive parts that are in the same tile are merged into a piece.
+ * The tile of a part is the one of its middle point, and a piece starts at
+ * the instant at which the temporal point enters the tile.
+ *****************************************************************************/
+
+/* Tile of the grid */
+
+typedef struct
+{
+	int32		x;			/* Column of the cell */
+	int32		y;			/* Row of the cell */
+	TimestampTz	bucket;		/* Start of the time bucket */
+} TpointTile;
+
+/* Pieces of the temporal point returned by the function */
+
+typedef struct
+{
+	int			count;		/* Number of pieces */
+	int			maxcount;	/* Size of the arrays */
+	int			pos;		/* Next piece to return */
+	TpointTile *tiles;		/* Tile of each piece */
+	Temporal  **pieces;		/* Pieces of the temporal point */
+} TpointTileState;
+
+/* Grid definition shared by the functions below */
+
+typedef struct
+{
+	double		xsize;
+	double		ysize;
+	TimestampTz	origin;
+	int64		step;
+} TpointTileGrid;
+
+static void
+tpoint_tile_set(TpointTile *tile, Datum value, TimestampTz t,
+	const TpointTileGrid *grid)
+{
+	POINT2D p = datum_get_point2d(value);
+	double x = floor(p.x / grid->xsize);
+	double y = floor(p.y / grid->ysize);
+	if (x < PG_INT32_MIN || x > PG_INT32_MAX || y < PG_INT32_MIN ||
+		y > PG_INT32_MAX)
+		ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+			errmsg("Too many cells in the grid")));
+	tile->x = (int32) x;
+	tile->y = (int32) y;
+	TimestampTz bucket = timestamp_grid_ceil(t, grid->origin, grid->step);
+	tile->bucket = (bucket == t) ? t : bucket - grid->step;
+}
+
+static bool
+tpoint_tile_eq(const TpointTile *tile1, const TpointTile *tile2)
+{
+	return tile1->x == tile2->x && tile1->y == tile2->y &&
+		tile1->bucket == tile2->bucket;
+}
+
+static void
+tpoint_tile_add(TpointTileState *state, const TpointTile *tile, Temporal *piece)
+{
+	if (state->count == state->maxcount)
+	{
+		state->maxcount *= 2;
+		state->tiles = repalloc(state->tiles, sizeof(TpointTile) * state->maxcount);
+		state->pieces = repalloc(state->pieces, sizeof(Temporal *) * state->maxcount);
+	}
+	state->tiles[state->count] = *tile;
+	state->pieces[state->count++] = piece;
+}
+
+/* Add a timestamp to a growable array */
+
+static void
+timestamparr_add(TimestampTz **times, int *count, int *maxcount, TimestampTz t)
+{
+	if (*count == *maxcount)
+	{
+		*maxcount *= 2;
+		*times = repalloc(*times, sizeof(TimestampTz) * (*maxcount));
+	}
+	(*times)[(*count)++] = t;
+}
+
+/*
+ * Add to the array the timestamps at which the segment of one coordinate
+ * from a1 to a2 crosses a grid line
+ */
+static void
+tpoint_tile_crossings(TimestampTz **times, int *count, int *maxcount,
+	double a1, double a2, double size, TimestampTz t1, TimestampTz t2)
+{
+	if (a1 == a2)
+		return;
+	double duration = (double) (t2 - t1);
+	double n1 = floor(Min(a1, a2) / size) + 1;
+	double n2 = ceil(Max(a1, a2) / size) - 1;
+	for (double n = n1; n <= n2; n++)
+	{
+		double fraction = (n * size - a1) / (a2 - a1);
+		TimestampTz t = t1 + (TimestampTz) (duration * fraction);
+		if (t1 < t && t < t2)
+			timestamparr_add(times, count, maxcount, t);
+	}
+}
+
+/*
+ * Timestamps strictly inside a segment at which the segment must be split.
+ * The timestamps are sorted and without duplicates. Returns their number.
+ */
+static int
+tpointseq_tile_splits(TimestampTz **times, int *maxcount, TemporalInst *inst1,
+	TemporalInst *inst2, bool linear, const TpointTileGrid *grid)
+{
+	int count = 0;
+	/* Bounds of the time buckets */
+	TimestampTz t = timestamp_grid_ceil(inst1->t, grid->origin, grid->step);
+	if (t == inst1->t)
+		t += grid->step;
+	for (; t < inst2->t; t += grid->step)
+		timestamparr_add(times, &count, maxcount, t);
+	/* Grid lines, only crossed with linear interpolation */
+	if (linear)
+	{
+		POINT2D p1 = datum_get_point2d(temporalinst_value(inst1));
+		POINT2D p2 = datum_get_point2d(temporalinst_value(inst2));
+		tpoint_tile_crossings(times, &count, maxcount, p1.x, p2.x,
+			grid->xsize, inst1->t, inst2->t);
+		tpoint_tile_crossings(times, &count, maxcount, p1.y, p2.y,
+			grid->ysize, inst1->t, inst2->t);
+	}
+	if (count > 1)
+	{
+		timestamp_sort(*times, count);
+		count = timestamp_remove_duplicates(*times, count);
+	}
+	return count;
+}
+
+/*
+ * Add a piece composed of the instants to the state. With stepwise
+ * interpolation and an exclusive upper bound the last instant takes the
+ * value of the previous one.
+ */
+static void
+tpointseq_tile_piece(TpointTileState *state, const TpointTile *tile,
+	TemporalInst **instants, int count, bool lower_inc, bool upper_inc,
+	bool linear)
+{
+	TemporalInst *last = instants[count - 1];
+	TemporalInst *last1 = last;
+	if (! linear && ! upper_inc && count > 1)
+	{
+		last1 = temporalinst_make(temporalinst_value(instants[count - 2]),
+			last->t, last->valuetypid);
+		instants[count - 1] = last1;
+	}
+	TemporalSeq *piece = temporalseq_from_temporalinstarr(instants, count,
+		lower_inc, upper_inc, linear, true);
+	tpoint_tile_add(state, tile, (Temporal *) piece);
+	if (last1 != last)
+	{
+		pfree(last1);
+		instants[count - 1] = last;
+	}
+}
+
+static void
+tpointseq_tile(TpointTileState *state, TemporalSeq *seq,
+	const TpointTileGrid *grid)
+{
+	TpointTile tile, tile1;
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	if (seq->count == 1)
+	{
+		tpoint_tile_set(&tile, temporalinst_value(inst1), inst1->t, grid);
+		tpoint_tile_add(state, &tile, (Temporal *) temporalseq_copy(seq));
+		return;
+	}
+
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	int maxtimes = 16;
+	TimestampTz *times = palloc(sizeof(TimestampTz) * maxtimes);
+	int maxcount = seq->count;
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * maxcount);
+	instants[0] = temporalinst_copy(inst1);
+	int k = 1;
+	bool lower_inc = seq->period.lower_inc;
+	bool started = false;
+	for (int i = 0; i < seq->count - 1; i++)
+	{
+		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
+		int count = tpointseq_tile_splits(&times, &maxtimes, inst1, inst2,
+			linear, grid);
+		for (int j = 0; j <= count; j++)
+		{
+			TimestampTz t1 = (j == 0) ? inst1->t : times[j - 1];
+			TimestampTz t2 = (j == count) ? inst2->t : times[j];
+			TimestampTz middle = t1 + (t2 - t1) / 2;
+			Datum value = temporalseq_value_at_timestamp1(inst1, inst2,
+				linear, middle);
+			tpoint_tile_set(&tile1, value, middle, grid);
+			pfree(DatumGetPointer(value));
+			if (! started)
+			{
+				tile = tile1;
+				started = true;
+			}
+			else if (! tpoint_tile_eq(&tile, &tile1))
+			{
+				/* The previous piece ends at t1, which starts the next one */
+				tpointseq_tile_piece(state, &tile, instants, k, lower_inc,
+					false, linear);
+				for (int l = 0; l < k - 1; l++)
+					pfree(instants[l]);
+				instants[0] = instants[k - 1];
+				k = 1;
+				lower_inc = true;
+				tile = tile1;
+			}
+			if (k == maxcount)
+			{
+				maxcount *= 2;
+				instants = repalloc(instants, sizeof(TemporalInst *) * maxcount);
+			}
+			instants[k++] = (j == count) ? temporalinst_copy(inst2) :
+				temporalseq_at_timestamp1(inst1, inst2, linear, t2);
+		}
+		inst1 = inst2;
+	}
+
+	/* With stepwise interpolation the last instant may be in another tile */
+	bool upper_inc = seq->period.upper_inc;
+	TemporalInst *last = instants[k - 1];
+	if (! linear && upper_inc)
+	{
+		tpoint_tile_set(&tile1, temporalinst_value(last), last->t, grid);
+		if (! tpoint_tile_eq(&tile, &tile1))
+		{
+			tpointseq_tile_piece(state, &tile, instants, k, lower_inc,
+				false, linear);
+			for (int l = 0; l < k - 1; l++)
+				pfree(instants[l]);
+			instants[0] = last;
+			k = 1;
+			lower_inc = true;
+			tile = tile1;
+		}
+	}
+	tpointseq_tile_piece(state, &tile, instants, k, lower_inc, upper_inc,
+		linear);
+	for (int l = 0; l < k; l++)
+		pfree(instants[l]);
+	pfree(instants);
+	pfree(times);
+}
+
+/* Consecutive instants in the same tile are merged into a piece */
+
+static void
+tpointi_tile(TpointTileState *state, TemporalI *ti, const TpointTileGrid *grid)
+{
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
+	TpointTile tile, tile1;
+	int k = 0;
+	for (int i = 0; i < ti->count; i++)
+	{
+		TemporalInst *inst = temporali_inst_n(ti, i);
+		tpoint_tile_set(&tile1, temporalinst_value(inst), inst->t, grid);
+		if (k > 0 && ! tpoint_tile_eq(&tile, &tile1))
+		{
+			tpoint_tile_add(state, &tile,
+				(Temporal *) temporali_from_temporalinstarr(instants, k));
+			k = 0;
+		}
+		tile = tile1;
+		instants[k++] = inst;
+	}
+	tpoint_tile_add(state, &tile,
+		(Temporal *) temporali_from_temporalinstarr(instants, k));
+	/* We do not need to pfree the instants */
+	pfree(instants);
+}
+
+static TpointTileState *
+tpoint_tile_internal(Temporal *temp, const TpointTileGrid *grid)
+{
+	TpointTileState *state = palloc0(sizeof(TpointTileState));
+	state->maxcount = 16;
+	state->tiles = palloc(sizeof(TpointTile) * state->maxcount);
+	state->pieces = palloc(sizeof(Temporal *) * state->maxcount);
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+	{
+		TemporalInst *inst = (TemporalInst *) temp;
+		TpointTile tile;
+		tpoint_tile_set(&tile, temporalinst_value(inst), inst->t, grid);
+		tpoint_tile_add(state, &tile, (Temporal *) temporalinst_copy(inst));
+	}
+	else if (temp->duration == TEMPORALI)
+		tpointi_tile(state, (TemporalI *) temp, grid);
+	else if (temp->duration == TEMPORALSEQ)
+		tpointseq_tile(state, (TemporalSeq *) temp, grid);
+	else if (temp->duration == TEMPORALS)
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		for (int i = 0; i < ts->count; i++)
+			tpointseq_tile(state, temporals_seq_n(ts, i), grid);
+	}
+	return state;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_tile);
+/**
+ * @brief Split a temporal point into pieces according to a spatial grid and
+ * a grid of time buckets. Returns the identifier of the cell, the start of
+ * the time bucket, and the piece. The identifier of a cell combines its
+ * column in the upper 32 bits and its row in the lower 32 bits.
+ */
+PGDLLEXPORT Datum
+tpoint_tile(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		Temporal *temp = PG_GETARG_TEMPORAL(0);
+		TpointTileGrid grid;
+		grid.xsize = PG_GETARG_FLOAT8(1);
+		grid.ysize = PG_GETARG_FLOAT8(2);
+		grid.step = interval_grid_step(PG_GETARG_INTERVAL_P(3));
+		grid.origin = PG_GETARG_TIMESTAMPTZ(4);
+		if (grid.xsize <= 0 || grid.ysize <= 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("The size of the cells must be positive")));
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		funcctx->user_fctx = tpoint_tile_internal(temp, &grid);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	TpointTileState *state = (TpointTileState *) funcctx->user_fctx;
+	if (state->pos == state->count)
+		SRF_RETURN_DONE(funcctx);
+
+	TpointTile *tile = &state->tiles[state->pos];
+	Datum values[3];
+	bool nulls[3] = {false, false, false};
+	values[0] = Int64GetDatum((int64) (((uint64) (uint32) tile->x << 32) |
+		(uint32) tile->y));
+	values[1] = TimestampTzGetDatum(tile->bucket);
+	values[2] = PointerGetDatum(state->pieces[state->pos]);
+	state->pos++;
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************
+ * Stop detection
+ * A stop is a maximal part of a sequence during which the temporal point
+ * stays within a disk of radius maxradius for at least minduration. The
+ * sequences are scanned once with a sliding window of instants whose
+ * bounding box is maintained with monotonic queues of the instants with the
+ * minimum and maximum coordinates. The points of the window are within
+ * maxradius of the center of the box when its half diagonal is at most
+ * maxradius. When the next instant does not fit into a window that lasts
+ * at least minduration the window is output as a stop and a new window
+ * starts at that instant, otherwise the window slides forward.
+ *****************************************************************************/
+
+/* Monotonic queue of the positions of the instants of the window */
+
+typedef struct
+{
+	int			first;
+	int			last;
+	int		   *pos;
+} StopQueue;
+
+/* Stops of the temporal point returned by the function */
+
+typedef struct
+{
+	int			count;		/* Number of stops */
+	int			maxcount;	/* Size of the arrays */
+	int			pos;		/* Next stop to return */
+	Period	  **periods;	/* Period of each stop */
+	Datum	   *centroids;	/* Time-weighted centroid of each stop */
+} TpointStopState;
+
+/*
+ * Add the position i at the end of the queue, removing the positions whose
+ * value is not better than the one of i. The value at the first position of
+ * the queue is then the minimum (or the maximum) of the window.
+ */
+static void
+stop_queue_push(StopQueue *queue, const double *values, int i, bool max)
+{
+	while (queue->last > queue->first &&
+		(max ? values[queue->pos[queue->last - 1]] <= values[i] :
+			values[queue->pos[queue->last - 1]] >= values[i]))
+		queue->last--;
+	queue->pos[queue->last++] = i;
+}
+
+static void
+stop_queue_pop(StopQueue *queue, int start)
 {
-	/* Singleton sequence set */
-	if (ts->count == 1)
-		return tpointseq_minus_geometry(temporals_seq_n(ts, 0),
-			PointerGetDatum(gs));
+	while (queue->pos[queue->first] < start)
+		queue->first++;
+}
 
-	TemporalSeq ***sequences = palloc(sizeof(TemporalSeq *) * ts->count);
-	int *countseqs = palloc0(sizeof(int) * ts->count);
-	int totalseqs = 0;
-	for (int i = 0; i < ts->count; i++)
+static void
+tpoint_stops_add(TpointStopState *state, int32 srid, const double *x,
+	const double *y, const TimestampTz *times, int start, int end,
+	bool linear)
+{
+	/* Time-weighted centroid of the instants of the window */
+	double cx = 0, cy = 0;
+	for (int i = start; i < end; i++)
 	{
-		TemporalSeq *seq = temporals_seq_n(ts, i);
-		/* Bounding box test */
-		STBOX *box1 = temporalseq_bbox_ptr(seq);
-		if (!overlaps_stbox_stbox_internal(box1, box2))
-		{
-			sequences[i] = palloc(sizeof(TemporalSeq *));
-			sequences[i][0] = temporalseq_copy(seq);
-			countseqs[i] = 1;
-			totalseqs ++;
-		}
-		else
-		{
-			sequences[i] = tpointseq_minus_geometry1(seq, PointerGetDatum(gs),
-				&countseqs[i]);
-			totalseqs += countseqs[i];
-		}
+		double w = (double) (times[i + 1] - times[i]);
+		cx += w * (linear ? (x[i] + x[i + 1]) / 2 : x[i]);
+		cy += w * (linear ? (y[i] + y[i + 1]) / 2 : y[i]);
 	}
-	if (totalseqs == 0)
+	double duration = (double) (times[end] - times[start]);
+	LWPOINT *lwpoint = lwpoint_make2d(srid, cx / duration, cy / duration);
+	if (state->count == state->maxcount)
 	{
-		pfree(sequences); pfree(countseqs);
-		return NULL;
+		state->maxcount *= 2;
+		state->periods = repalloc(state->periods,
+			sizeof(Period *) * state->maxcount);
+		state->centroids = repalloc(state->centroids,
+			sizeof(Datum) * state->maxcount);
 	}
+	state->periods[state->count] = period_make(times[start], times[end],
+		true, true);
+	state->centroids[state->count++] =
+		PointerGetDatum(geometry_serialize((LWGEOM *) lwpoint));
+	lwpoint_free(lwpoint);
+}
 
-	TemporalSeq **allsequences = palloc(sizeof(TemporalSeq *) * totalseqs);
-	int k = 0;
-	for (int i = 0; i < ts->count; i++)
+static void
+tpointseq_stops(TpointStopState *state, TemporalSeq *seq, double maxradius,
+	int64 minduration)
+{
+	int n = seq->count;
+	if (n < 2)
+		return;
+	int32 srid = tpoint_srid_internal((Temporal *) seq);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	double *x = palloc(sizeof(double) * n);
+	double *y = palloc(sizeof(double) * n);
+	TimestampTz *times = palloc(sizeof(TimestampTz) * n);
+	for (int i = 0; i < n; i++)
 	{
-		for (int j = 0; j < countseqs[i]; j++)
-			allsequences[k++] = sequences[i][j];
-		if (countseqs[i] != 0)
-			pfree(sequences[i]);
+		TemporalInst *inst = temporalseq_inst_n(seq, i);
+		POINT2D p = datum_get_point2d(temporalinst_value(inst));
+		x[i] = p.x;
+		y[i] = p.y;
+		times[i] = inst->t;
 	}
-	TemporalS *result = temporals_from_temporalseqarr(allsequences, totalseqs,
-		MOBDB_FLAGS_GET_LINEAR(ts->flags), true);
-
-	for (int i = 0; i < totalseqs; i++)
-		pfree(allsequences[i]);
-	pfree(allsequences); pfree(sequences); pfree(countseqs);
+	/* Queues of the minimum and maximum x and y in the window */
+	StopQueue queues[4];
+	for (int k = 0; k < 4; k++)
+	{
+		queues[k].first = queues[k].last = 0;
+		queues[k].pos = palloc(sizeof(int) * n);
+	}
+	double diameter2 = 4 * maxradius * maxradius;
+	int start = 0;
+	for (int i = 0; i < n; i++)
+	{
+		stop_queue_push(&queues[0], x, i, false);
+		stop_queue_push(&queues[1], x, i, true);
+		stop_queue_push(&queues[2], y, i, false);
+		stop_queue_push(&queues[3], y, i, true);
+		while (true)
+		{
+			double dx = x[queues[1].pos[queues[1].first]] -
+				x[queues[0].pos[queues[0].first]];
+			double dy = y[queues[3].pos[queues[3].first]] -
+				y[queues[2].pos[queues[2].first]];
+			if (dx * dx + dy * dy <= diameter2)
+				break;
+			if (i - 1 > start && times[i - 1] - times[start] >= minduration)
+			{
+				/* The window before instant i is a stop */
+				tpoint_stops_add(state, srid, x, y, times, start, i - 1, linear);
+				start = i;
+				for (int k = 0; k < 4; k++)
+				{
+					queues[k].first = queues[k].last = 0;
+					queues[k].pos[queues[k].last++] = i;
+				}
+				break;
+			}
+			start++;
+			for (int k = 0; k < 4; k++)
+				stop_queue_pop(&queues[k], start);
+		}
+	}
+	if (n - 1 > start && times[n - 1] - times[start] >= minduration)
+		tpoint_stops_add(state, srid, x, y, times, start, n - 1, linear);
 
-	return result;
+	for (int k = 0; k < 4; k++)
+		pfree(queues[k].pos);
+	pfree(x); pfree(y); pfree(times);
 }
 
-PG_FUNCTION_INFO_V1(tpoint_minus_geometry);
-
+PG_FUNCTION_INFO_V1(tpoint_stops);
+/**
+ * @brief Returns the stops of a temporal point, that is, the periods during
+ * which it stays within a distance of a point for at least a duration,
+ * together with the time-weighted centroid of the stop
+ */
 PGDLLEXPORT Datum
-tpoint_minus_geometry(PG_FUNCTION_ARGS)
+tpoint_stops(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	GSERIALIZED *gs = PG_GETARG_GSERIALIZED_P(1);
-	ensure_same_srid_tpoint_gs(temp, gs);
-	ensure_same_dimensionality_tpoint_gs(temp, gs);
-	/* Bounding box test */
-	STBOX box1, box2;
-	memset(&box1, 0, sizeof(STBOX));
-	memset(&box2, 0, sizeof(STBOX));
-	if (!geo_to_stbox_internal(&box2, gs))
-	{
-		Temporal *copy = temporal_copy(temp) ;
-		PG_FREE_IF_COPY(temp, 0);
-		PG_FREE_IF_COPY(gs, 1);
-		PG_RETURN_POINTER(copy);
-	}
-	temporal_bbox(&box1, temp);
-	if (!overlaps_stbox_stbox_internal(&box1, &box2))
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
 	{
-		Temporal *copy = temporal_copy(temp) ;
-		PG_FREE_IF_COPY(temp, 0);
-		PG_FREE_IF_COPY(gs, 1);
-		PG_RETURN_POINTER(copy);
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		Temporal *temp = PG_GETARG_TEMPORAL(0);
+		double maxradius = PG_GETARG_FLOAT8(1);
+		Interval *interval = PG_GETARG_INTERVAL_P(2);
+		if (maxradius < 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("The radius cannot be negative")));
+		if (interval->month != 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("The interval cannot have a month component")));
+		int64 minduration = interval->time +
+			(int64) interval->day * USECS_PER_DAY;
+		if (minduration < 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("The duration cannot be negative")));
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		TpointStopState *state = palloc0(sizeof(TpointStopState));
+		state->maxcount = 16;
+		state->periods = palloc(sizeof(Period *) * state->maxcount);
+		state->centroids = palloc(sizeof(Datum) * state->maxcount);
+		/* Instants and instant sets do not stay anywhere for a duration */
+		ensure_valid_duration(temp->duration);
+		if (temp->duration == TEMPORALSEQ)
+			tpointseq_stops(state, (TemporalSeq *) temp, maxradius,
+				minduration);
+		else if (temp->duration == TEMPORALS)
+		{
+			TemporalS *ts = (TemporalS *) temp;
+			for (int i = 0; i < ts->count; i++)
+				tpointseq_stops(state, temporals_seq_n(ts, i), maxradius,
+					minduration);
+		}
+		funcctx->user_fctx = state;
+		MemoryContextSwitchTo(oldcontext);
 	}
 
-	Temporal *result = NULL;
-	ensure_valid_duration(temp->duration);
-	if (temp->duration == TEMPORALINST)
-		result = (Temporal *)tpointinst_minus_geometry((TemporalInst *)temp,
-			PointerGetDatum(gs));
-	else if (temp->duration == TEMPORALI)
-		result = (Temporal *)tpointi_minus_geometry((TemporalI *)temp,
-			PointerGetDatum(gs));
-	else if (temp->duration == TEMPORALSEQ)
-		result = (Temporal *)tpointseq_minus_geometry((TemporalSeq *)temp,
-			PointerGetDatum(gs));
-	else if (temp->duration == TEMPORALS)
-		result = (Temporal *)tpoints_minus_geometry((TemporalS *)temp, gs, &box2);
-
-	PG_FREE_IF_COPY(temp, 0);
-	PG_FREE_IF_COPY(gs, 1);
-	if (result == NULL)
-		PG_RETURN_NULL();
-	PG_RETURN_POINTER(result);
+	funcctx = SRF_PERCALL_SETUP();
+	TpointStopState *state = (TpointStopState *) funcctx->user_fctx;
+	if (state->pos == state->count)
+		SRF_RETURN_DONE(funcctx);
+
+	Datum values[2];
+	bool nulls[2] = {false, false};
+	values[0] = PeriodGetDatum(state->periods[state->pos]);
+	values[1] = state->centroids[state->pos];
+	state->pos++;
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
 }
 
 /*****************************************************************************
@@ -2386,14 +3805,10 @@ NAI_tpoint_tpoint(PG_FUNCTION_ARGS)
 	ensure_same_srid_tpoint(temp1, temp2);
 	ensure_same_dimensionality_tpoint(temp1, temp2);
 	TemporalInst *result = NULL;
-	Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
-	if (dist != NULL)
-	{
-		Temporal *mindist = temporal_at_min_internal(dist);
-		TimestampTz t = temporal_start_timestamp_internal(mindist);
+	double mindist;
+	TimestampTz t;
+	if (NAD_tpoint_tpoint_internal(temp1, temp2, &mindist, &t))
 		result = temporal_at_timestamp_internal(temp1, t);
-		pfree(dist); pfree(mindist);		
-	}
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -2490,19 +3905,14 @@ NAD_tpoint_tpoint(PG_FUNCTION_ARGS)
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	ensure_same_srid_tpoint(temp1, temp2);
 	ensure_same_dimensionality_tpoint(temp1, temp2);
-	Temporal *dist = distance_tpoint_tpoint_internal(temp1, temp2);
-	if (dist == NULL)
-	{
-		PG_FREE_IF_COPY(temp1, 0);
-		PG_FREE_IF_COPY(temp2, 1);
-		PG_RETURN_NULL();
-	}
-
-	Datum result = temporal_min_value_internal(dist);
-	pfree(dist);
+	double mindist;
+	TimestampTz t;
+	bool found = NAD_tpoint_tpoint_internal(temp1, temp2, &mindist, &t);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
-	PG_RETURN_DATUM(result);
+	if (!found)
+		PG_RETURN_NULL();
+	PG_RETURN_FLOAT8(mindist);
 }
 
 /*****************************************************************************
@@ -3116,3 +4526,338 @@ geo_to_tpoint(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Simplification of a temporal point with a generalization of the
+ * Douglas-Peucker algorithm. An intermediate instant is kept if its
+ * distance to the segment joining the instants kept before and after it
+ * is greater than the distance tolerance. When a speed tolerance is given,
+ * the instants of a segment are also kept if the speed of the original
+ * sequence at one of them differs from the speed of the simplified segment
+ * by more than the speed tolerance.
+ *****************************************************************************/
+
+static POINT3DZ
+tpointinst_point3dz(TemporalInst *inst, bool hasz)
+{
+	POINT3DZ result;
+	if (hasz)
+		result = datum_get_point3dz(temporalinst_value(inst));
+	else
+	{
+		POINT2D p = datum_get_point2d(temporalinst_value(inst));
+		result.x = p.x;
+		result.y = p.y;
+		result.z = 0;
+	}
+	return result;
+}
+
+static double
+point3dz_dist_to_segm(POINT3DZ *p, POINT3DZ *p1, POINT3DZ *p2)
+{
+	double dx = p2->x - p1->x, dy = p2->y - p1->y, dz = p2->z - p1->z;
+	double len2 = dx * dx + dy * dy + dz * dz;
+	double ratio = (len2 == 0) ? 0 :
+		((p->x - p1->x) * dx + (p->y - p1->y) * dy + (p->z - p1->z) * dz) / len2;
+	if (ratio < 0)
+		ratio = 0;
+	else if (ratio > 1)
+		ratio = 1;
+	double x = p->x - (p1->x + ratio * dx);
+	double y = p->y - (p1->y + ratio * dy);
+	double z = p->z - (p1->z + ratio * dz);
+	return sqrt(x * x + y * y + z * z);
+}
+
+/* Speed in units per second between two instants */
+static double
+point3dz_speed(POINT3DZ *p1, POINT3DZ *p2, TimestampTz t1, TimestampTz t2)
+{
+	double dx = p2->x - p1->x, dy = p2->y - p1->y, dz = p2->z - p1->z;
+	return sqrt(dx * dx + dy * dy + dz * dz) /
+		((double) (t2 - t1) / 1000000.0);
+}
+
+static TemporalSeq *
+tpointseq_simplify(TemporalSeq *seq, double eps_dist, bool withspeed,
+	double eps_speed)
+{
+	/* Stepwise sequences are not simplified since their trajectory is
+	 * the set of points and not the polyline joining them */
+	if (seq->count < 3 || ! MOBDB_FLAGS_GET_LINEAR(seq->flags))
+		return temporalseq_copy(seq);
+
+	bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+	POINT3DZ *points = palloc(sizeof(POINT3DZ) * seq->count);
+	for (int i = 0; i < seq->count; i++)
+		points[i] = tpointinst_point3dz(temporalseq_inst_n(seq, i), hasz);
+	bool *keep = palloc0(sizeof(bool) * seq->count);
+	keep[0] = keep[seq->count - 1] = true;
+	/* Stack of the pairs of instants whose intermediate instants must be
+	 * examined, there are at most count - 1 pairs at the same time */
+	int *stack = palloc(sizeof(int) * 2 * seq->count);
+	int top = 0;
+	stack[top++] = 0;
+	stack[top++] = seq->count - 1;
+	while (top > 0)
+	{
+		int i2 = stack[--top];
+		int i1 = stack[--top];
+		double speed_segm = 0;
+		if (withspeed)
+			speed_segm = point3dz_speed(&points[i1], &points[i2],
+				temporalseq_inst_n(seq, i1)->t, temporalseq_inst_n(seq, i2)->t);
+		int split = -1;
+		double maxdist = -1, maxdelta = 0;
+		for (int i = i1 + 1; i < i2; i++)
+		{
+			double dist = point3dz_dist_to_segm(&points[i], &points[i1],
+				&points[i2]);
+			if (dist > maxdist)
+			{
+				maxdist = dist;
+				split = i;
+			}
+			if (withspeed)
+			{
+				double delta = fabs(point3dz_speed(&points[i - 1], &points[i],
+					temporalseq_inst_n(seq, i - 1)->t,
+					temporalseq_inst_n(seq, i)->t) - speed_segm);
+				if (delta > maxdelta)
+					maxdelta = delta;
+			}
+		}
+		if (split > 0 && (maxdist > eps_dist ||
+			(withspeed && maxdelta > eps_speed)))
+		{
+			keep[split] = true;
+			stack[top++] = i1;
+			stack[top++] = split;
+			stack[top++] = split;
+			stack[top++] = i2;
+		}
+	}
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	int k = 0;
+	for (int i = 0; i < seq->count; i++)
+	{
+		if (keep[i])
+			instants[k++] = temporalseq_inst_n(seq, i);
+	}
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, k,
+		seq->period.lower_inc, seq->period.upper_inc, true, true);
+	pfree(instants);
+	pfree(stack);
+	pfree(keep);
+	pfree(points);
+	return result;
+}
+
+static TemporalS *
+tpoints_simplify(TemporalS *ts, double eps_dist, bool withspeed,
+	double eps_speed)
+{
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+	for (int i = 0; i < ts->count; i++)
+		sequences[i] = tpointseq_simplify(temporals_seq_n(ts, i), eps_dist,
+			withspeed, eps_speed);
+	TemporalS *result = temporals_from_temporalseqarr(sequences, ts->count,
+		MOBDB_FLAGS_GET_LINEAR(ts->flags), true);
+	for (int i = 0; i < ts->count; i++)
+		pfree(sequences[i]);
+	pfree(sequences);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(tpoint_simplify);
+
+PGDLLEXPORT Datum
+tpoint_simplify(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	double eps_dist = PG_GETARG_FLOAT8(1);
+	bool withspeed = PG_NARGS() > 2;
+	double eps_speed = withspeed ? PG_GETARG_FLOAT8(2) : 0;
+	if (eps_dist < 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The distance tolerance cannot be negative")));
+	if (eps_speed < 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The speed tolerance cannot be negative")));
+
+	Temporal *result;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI)
+		result = temporal_copy(temp);
+	else if (temp->duration == TEMPORALSEQ)
+		result = (Temporal *)tpointseq_simplify((TemporalSeq *)temp, 
+			eps_dist, withspeed, eps_speed);
+	else /* temp->duration == TEMPORALS */
+		result = (Temporal *)tpoints_simplify((TemporalS *)temp, 
+			eps_dist, withspeed, eps_speed);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Simplification pyramid for rendering at several scales. The level i of
+ * the pyramid is the simplification with the distance tolerance
+ * tolerance * 2^(i-1). All the levels are obtained from a single run of the
+ * Douglas-Peucker algorithm, which computes the importance of each instant,
+ * that is, the largest tolerance for which it is kept. Since an instant is
+ * only examined if the instant that split its interval is kept, its
+ * importance is bounded by the one of that instant.
+ *****************************************************************************/
+
+static double *
+tpointseq_simplify_importance(TemporalSeq *seq)
+{
+	bool hasz = MOBDB_FLAGS_GET_Z(seq->flags);
+	POINT3DZ *points = palloc(sizeof(POINT3DZ) * seq->count);
+	for (int i = 0; i < seq->count; i++)
+		points[i] = tpointinst_point3dz(temporalseq_inst_n(seq, i), hasz);
+	double *result = palloc0(sizeof(double) * seq->count);
+	result[0] = result[seq->count - 1] = DBL_MAX;
+	/* Stack of the pairs of instants whose intermediate instants must be
+	 * examined together with the importance of the instant that split them */
+	int *stack = palloc(sizeof(int) * 2 * seq->count);
+	double *bound = palloc(sizeof(double) * seq->count);
+	int top = 0;
+	stack[2 * top] = 0;
+	stack[2 * top + 1] = seq->count - 1;
+	bound[top++] = DBL_MAX;
+	while (top > 0)
+	{
+		top--;
+		int i1 = stack[2 * top];
+		int i2 = stack[2 * top + 1];
+		double maxbound = bound[top];
+		int split = -1;
+		double maxdist = -1;
+		for (int i = i1 + 1; i < i2; i++)
+		{
+			double dist = point3dz_dist_to_segm(&points[i], &points[i1],
+				&points[i2]);
+			if (dist > maxdist)
+			{
+				maxdist = dist;
+				split = i;
+			}
+		}
+		if (split > 0)
+		{
+			result[split] = Min(maxdist, maxbound);
+			stack[2 * top] = i1;
+			stack[2 * top + 1] = split;
+			bound[top++] = result[split];
+			stack[2 * top] = split;
+			stack[2 * top + 1] = i2;
+			bound[top++] = result[split];
+		}
+	}
+	pfree(bound);
+	pfree(stack);
+	pfree(points);
+	return result;
+}
+
+/*
+ * Simplify a temporal sequence point for each level of the pyramid, the 
+ * resulting sequences are stored in the array given as first argument
+ */
+static void
+tpointseq_simplify_pyramid(TemporalSeq **result, TemporalSeq *seq,
+	double tolerance, int levels)
+{
+	/* Stepwise sequences are not simplified, as in tpointseq_simplify */
+	if (seq->count < 3 || ! MOBDB_FLAGS_GET_LINEAR(seq->flags))
+	{
+		for (int l = 0; l < levels; l++)
+			result[l] = temporalseq_copy(seq);
+		return;
+	}
+
+	double *importance = tpointseq_simplify_importance(seq);
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	double eps = tolerance;
+	for (int l = 0; l < levels; l++)
+	{
+		int k = 0;
+		for (int i = 0; i < seq->count; i++)
+		{
+			if (importance[i] > eps)
+				instants[k++] = temporalseq_inst_n(seq, i);
+		}
+		result[l] = temporalseq_from_temporalinstarr(instants, k,
+			seq->period.lower_inc, seq->period.upper_inc, true, true);
+		eps *= 2;
+	}
+	pfree(instants);
+	pfree(importance);
+}
+
+PG_FUNCTION_INFO_V1(tpoint_simplify_pyramid);
+/**
+ * @brief Returns the array of the simplifications of the temporal point
+ * with the distance tolerances tolerance, 2 * tolerance, 4 * tolerance, ...
+ */
+PGDLLEXPORT Datum
+tpoint_simplify_pyramid(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	double tolerance = PG_GETARG_FLOAT8(1);
+	int levels = PG_GETARG_INT32(2);
+	if (tolerance <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The distance tolerance must be positive")));
+	if (levels < 1)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The number of levels must be positive")));
+
+	Temporal **pyramid = palloc(sizeof(Temporal *) * levels);
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI)
+	{
+		for (int l = 0; l < levels; l++)
+			pyramid[l] = temp;
+	}
+	else if (temp->duration == TEMPORALSEQ)
+		tpointseq_simplify_pyramid((TemporalSeq **) pyramid,
+			(TemporalSeq *) temp, tolerance, levels);
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		/* sequences[i * levels + l] is the level l of the sequence i */
+		TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) *
+			ts->count * levels);
+		for (int i = 0; i < ts->count; i++)
+			tpointseq_simplify_pyramid(&sequences[i * levels],
+				temporals_seq_n(ts, i), tolerance, levels);
+		TemporalSeq **sequences1 = palloc(sizeof(TemporalSeq *) * ts->count);
+		for (int l = 0; l < levels; l++)
+		{
+			for (int i = 0; i < ts->count; i++)
+				sequences1[i] = sequences[i * levels + l];
+			pyramid[l] = (Temporal *) temporals_from_temporalseqarr(sequences1,
+				ts->count, MOBDB_FLAGS_GET_LINEAR(ts->flags), true);
+		}
+		for (int i = 0; i < ts->count * levels; i++)
+			pfree(sequences[i]);
+		pfree(sequences1);
+		pfree(sequences);
+	}
+	ArrayType *result = temporalarr_to_array(pyramid, levels);
+	if (temp->duration == TEMPORALSEQ || temp->duration == TEMPORALS)
+	{
+		for (int l = 0; l < levels; l++)
+			pfree(pyramid[l]);
+	}
+	pfree(pyramid);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
@@ -25,9 +25,12 @@
 
 #include "tpoint_spatialrels.h"
 
+#include <catalog/pg_collation.h>
+
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_profile.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
 #include "tpoint_distance.h"
@@ -167,6 +170,23 @@ geog_dwithin(Datum geog1, Datum geog2, Datum dist)
 		BoolGetDatum(true));
 }
 
+/*
+ * Dwithin between two geography points computed on the sphere. The distance
+ * on the spheroid is only computed when the spherical distance is too close
+ * to the threshold to decide given the error bound of the approximation.
+ */
+Datum
+geog_dwithin_sphere(Datum geog1, Datum geog2, Datum dist)
+{
+	double d = DatumGetFloat8(dist);
+	double sphdist = DatumGetFloat8(geog_distance_sphere(geog1, geog2));
+	if (sphdist <= d * (1.0 - SPHERE_REL_ERROR))
+		return BoolGetDatum(true);
+	if (sphdist > d * (1.0 + SPHERE_REL_ERROR))
+		return BoolGetDatum(false);
+	return geog_dwithin(geog1, geog2, dist);
+}
+
 /*****************************************************************************
  * Generic dwithin functions when both temporal points are moving
  * The functions suppose that the temporal points are synchronized
@@ -248,12 +268,76 @@ dwithin_tpoints_tpoints(TemporalS *ts1, TemporalS *ts2, Datum d,
  * this, they have the same timeframe and they are of the same duration.
  *****************************************************************************/
 
+/* 
+ * Returns the PostGIS function implementing the spatial relationship if it 
+ * uses the PostGIS prepared geometry cache. The last argument states whether
+ * the arguments of the PostGIS function are swapped.
+ */
+static PGFunction
+geom_prepared_function(Datum (*func)(Datum, Datum), bool *swap)
+{
+	*swap = false;
+	if (func == &geom_contains)
+		return contains;
+	if (func == &geom_containsproperly)
+		return containsproperly;
+	if (func == &geom_covers)
+		return covers;
+	if (func == &geom_coveredby)
+		return coveredby;
+	if (func == &geom_intersects2d)
+		return intersects;
+	if (func == &geom_within)
+	{
+		*swap = true;
+		return contains;
+	}
+	return NULL;
+}
+
+/* 
+ * Call a PostGIS function using the FmgrInfo of the calling function.
+ * PostGIS keeps its prepared geometry cache in fn_extra, and thus when the
+ * geometry argument is constant, e.g., the polygon of a geofence joined 
+ * with many temporal points, the geometry is only indexed once instead of 
+ * once for each row.
+ */
 static Datum
-spatialrel_tpoint_geo(Temporal *temp, Datum geo,
+call_function2_flinfo(FmgrInfo *flinfo, PGFunction func, Datum arg1, Datum arg2)
+{
+	FunctionCallInfoData fcinfo;
+	InitFunctionCallInfoData(fcinfo, flinfo, 2, DEFAULT_COLLATION_OID, NULL, NULL);
+	fcinfo.arg[0] = arg1;
+	fcinfo.argnull[0] = false;
+	fcinfo.arg[1] = arg2;
+	fcinfo.argnull[1] = false;
+	MOBDB_STAT_INC(STAT_FUNCTION_CALLOUTS);
+	MOBDB_PROFILE_BEGIN(start);
+	Datum result = (*func) (&fcinfo);
+	MOBDB_PROFILE_END("prepared_spatialrel", start);
+	if (fcinfo.isnull)
+		elog(ERROR, "function %p returned NULL", (void *) func);
+	return result;
+}
+
+static Datum
+spatialrel_tpoint_geo(FunctionCallInfo fcinfo, Temporal *temp, Datum geo,
 	Datum (*func)(Datum, Datum), bool invert)
 {
+	MOBDB_STAT_INC(STAT_SPATIALREL_CALLS);
 	Datum traj = tpoint_trajectory_internal(temp);
-	Datum result = invert ? func(geo, traj) : func(traj, geo);
+	bool swap;
+	PGFunction pgfunc = geom_prepared_function(func, &swap);
+	Datum result;
+	if (pgfunc != NULL && fcinfo->flinfo != NULL)
+	{
+		Datum arg1 = invert ? geo : traj;
+		Datum arg2 = invert ? traj : geo;
+		result = swap ? call_function2_flinfo(fcinfo->flinfo, pgfunc, arg2, arg1) :
+			call_function2_flinfo(fcinfo->flinfo, pgfunc, arg1, arg2);
+	}
+	else
+		result = invert ? func(geo, traj) : func(traj, geo);
 	pfree(DatumGetPointer(traj));
 	return result;
 }
@@ -262,6 +346,7 @@ static Datum
 spatialrel3_tpoint_geo(Temporal *temp, Datum geo, Datum param,
 	Datum (*func)(Datum, Datum, Datum), bool invert)
 {
+	MOBDB_STAT_INC(STAT_SPATIALREL_CALLS);
 	Datum traj = tpoint_trajectory_internal(temp);
 	Datum result = invert ? func(geo, traj, param) : func(traj, geo, param);
 	pfree(DatumGetPointer(traj));
@@ -272,6 +357,7 @@ static Datum
 spatialrel_tpoint_tpoint(Temporal *temp1, Temporal *temp2,
 	Datum (*func)(Datum, Datum))
 {
+	MOBDB_STAT_INC(STAT_SPATIALREL_CALLS);
 	Datum traj1 = tpoint_trajectory_internal(temp1);
 	Datum traj2 = tpoint_trajectory_internal(temp2);
 	Datum result = func(traj1, traj2);
@@ -283,6 +369,7 @@ static Datum
 spatialrel3_tpoint_tpoint(Temporal *temp1, Temporal *temp2, Datum param,
 	Datum (*func)(Datum, Datum, Datum))
 {
+	MOBDB_STAT_INC(STAT_SPATIALREL_CALLS);
 	Datum traj1 = tpoint_trajectory_internal(temp1);
 	Datum traj2 = tpoint_trajectory_internal(temp2);
 	Datum result = func(traj1, traj2, param);
@@ -290,6 +377,191 @@ spatialrel3_tpoint_tpoint(Temporal *temp1, Temporal *temp2, Datum param,
 	return result;
 }
 
+/*****************************************************************************
+ * Intersection of the trajectories of two temporal geometry points
+ * The trajectories are not built, instead their segments are swept in 
+ * increasing order of their minimum x value, and each segment is only tested
+ * against the segments of the other trajectory whose x extent reaches it and
+ * whose y extent overlaps with it. Instants and stepwise sequences contribute
+ * degenerate segments whose two points are equal.
+ *****************************************************************************/
+
+typedef struct
+{
+	double xmin, xmax, ymin, ymax;	/* bounding box of the segment */
+	POINT2D p1, p2;					/* end points of the segment */
+} TrajSegment;
+
+static void
+trajsegment_set(TrajSegment *seg, POINT2D p1, POINT2D p2)
+{
+	seg->p1 = p1;
+	seg->p2 = p2;
+	seg->xmin = Min(p1.x, p2.x);
+	seg->xmax = Max(p1.x, p2.x);
+	seg->ymin = Min(p1.y, p2.y);
+	seg->ymax = Max(p1.y, p2.y);
+}
+
+/* Add the segments of a temporal sequence to the array */
+
+static int
+tpointseq_trajsegments(TemporalSeq *seq, TrajSegment *segs)
+{
+	POINT2D p1 = datum_get_point2d(temporalinst_value(temporalseq_inst_n(seq, 0)));
+	if (seq->count == 1)
+	{
+		trajsegment_set(&segs[0], p1, p1);
+		return 1;
+	}
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	int k = 0;
+	if (! linear)
+		trajsegment_set(&segs[k++], p1, p1);
+	for (int i = 1; i < seq->count; i++)
+	{
+		POINT2D p2 = datum_get_point2d(temporalinst_value(temporalseq_inst_n(seq, i)));
+		if (linear)
+			trajsegment_set(&segs[k++], p1, p2);
+		else
+			trajsegment_set(&segs[k++], p2, p2);
+		p1 = p2;
+	}
+	return k;
+}
+
+/* Segments of the trajectory of a temporal point */
+
+static TrajSegment *
+tpoint_trajsegments(Temporal *temp, int *count)
+{
+	TrajSegment *result;
+	int k = 0;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST) 
+	{
+		POINT2D p = datum_get_point2d(temporalinst_value((TemporalInst *) temp));
+		result = palloc(sizeof(TrajSegment));
+		trajsegment_set(&result[k++], p, p);
+	}
+	else if (temp->duration == TEMPORALI) 
+	{
+		TemporalI *ti = (TemporalI *) temp;
+		result = palloc(sizeof(TrajSegment) * ti->count);
+		for (int i = 0; i < ti->count; i++)
+		{
+			POINT2D p = datum_get_point2d(temporalinst_value(temporali_inst_n(ti, i)));
+			trajsegment_set(&result[k++], p, p);
+		}
+	}
+	else if (temp->duration == TEMPORALSEQ) 
+	{
+		TemporalSeq *seq = (TemporalSeq *) temp;
+		result = palloc(sizeof(TrajSegment) * seq->count);
+		k = tpointseq_trajsegments(seq, result);
+	}
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		result = palloc(sizeof(TrajSegment) * ts->totalcount);
+		for (int i = 0; i < ts->count; i++)
+			k += tpointseq_trajsegments(temporals_seq_n(ts, i), &result[k]);
+	}
+	*count = k;
+	return result;
+}
+
+static int
+trajsegment_cmp(const void *s1, const void *s2)
+{
+	double x1 = ((const TrajSegment *) s1)->xmin;
+	double x2 = ((const TrajSegment *) s2)->xmin;
+	return (x1 < x2) ? -1 : ((x1 > x2) ? 1 : 0);
+}
+
+/* Orientation of the point r with respect to the line from p to q */
+
+static double
+point2d_orient(const POINT2D *p, const POINT2D *q, const POINT2D *r)
+{
+	return (q->x - p->x) * (r->y - p->y) - (q->y - p->y) * (r->x - p->x);
+}
+
+/* Determine whether the point r collinear with p and q lies between them */
+
+static bool
+point2d_on_segment(const POINT2D *p, const POINT2D *q, const POINT2D *r)
+{
+	return Min(p->x, q->x) <= r->x && r->x <= Max(p->x, q->x) &&
+		Min(p->y, q->y) <= r->y && r->y <= Max(p->y, q->y);
+}
+
+/* Determine whether two closed segments, possibly degenerate, intersect */
+
+static bool
+trajsegment_intersects(const TrajSegment *s1, const TrajSegment *s2)
+{
+	double o1 = point2d_orient(&s1->p1, &s1->p2, &s2->p1);
+	double o2 = point2d_orient(&s1->p1, &s1->p2, &s2->p2);
+	double o3 = point2d_orient(&s2->p1, &s2->p2, &s1->p1);
+	double o4 = point2d_orient(&s2->p1, &s2->p2, &s1->p2);
+	if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) &&
+		((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0)))
+		return true;
+	return (o1 == 0 && point2d_on_segment(&s1->p1, &s1->p2, &s2->p1)) ||
+		(o2 == 0 && point2d_on_segment(&s1->p1, &s1->p2, &s2->p2)) ||
+		(o3 == 0 && point2d_on_segment(&s2->p1, &s2->p2, &s1->p1)) ||
+		(o4 == 0 && point2d_on_segment(&s2->p1, &s2->p2, &s1->p2));
+}
+
+static bool
+intersects_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2)
+{
+	int count1, count2;
+	TrajSegment *segs1 = tpoint_trajsegments(temp1, &count1);
+	TrajSegment *segs2 = tpoint_trajsegments(temp2, &count2);
+	qsort(segs1, count1, sizeof(TrajSegment), &trajsegment_cmp);
+	qsort(segs2, count2, sizeof(TrajSegment), &trajsegment_cmp);
+	/* Indexes of the segments of each trajectory already swept whose 
+	 * x extent may still reach the next segments */
+	int *active1 = palloc(sizeof(int) * (count1 + count2));
+	int *active2 = active1 + count1;
+	int nactive1 = 0, nactive2 = 0, i = 0, j = 0;
+	bool result = false;
+	while (! result && (i < count1 || j < count2))
+	{
+		bool first = (j == count2 || (i < count1 && segs1[i].xmin <= segs2[j].xmin));
+		TrajSegment *seg = first ? &segs1[i] : &segs2[j];
+		TrajSegment *others = first ? segs2 : segs1;
+		int *active = first ? active2 : active1;
+		int *nactive = first ? &nactive2 : &nactive1;
+		/* Remove the segments of the other trajectory ending before the 
+		 * current one starts and test the remaining ones */
+		int k = 0;
+		for (int l = 0; l < *nactive; l++)
+		{
+			TrajSegment *other = &others[active[l]];
+			if (other->xmax < seg->xmin)
+				continue;
+			active[k++] = active[l];
+			if (other->ymax >= seg->ymin && other->ymin <= seg->ymax &&
+				trajsegment_intersects(seg, other))
+			{
+				result = true;
+				break;
+			}
+		}
+		if (! result)
+			*nactive = k;
+		if (first)
+			active1[nactive1++] = i++;
+		else
+			active2[nactive2++] = j++;
+	}
+	pfree(segs1); pfree(segs2); pfree(active1);
+	return result;
+}
+
 /*****************************************************************************
  * Temporal contains
  *****************************************************************************/
@@ -309,7 +581,7 @@ contains_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_contains, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -331,7 +603,7 @@ contains_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_contains, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -381,7 +653,7 @@ containsproperly_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_containsproperly, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -403,7 +675,7 @@ containsproperly_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_containsproperly, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -459,7 +731,7 @@ covers_geo_tpoint(PG_FUNCTION_ARGS)
 		func = &geom_covers;
 	else if (temp->valuetypid == type_oid(T_GEOGRAPHY))
 		func = &geog_covers;
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		func, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -487,7 +759,7 @@ covers_tpoint_geo(PG_FUNCTION_ARGS)
 		func = &geom_covers;
 	else if (temp->valuetypid == type_oid(T_GEOGRAPHY))
 		func = &geog_covers;
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		func, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -551,7 +823,7 @@ coveredby_geo_tpoint(PG_FUNCTION_ARGS)
 		func = &geom_coveredby;
 	else if (temp->valuetypid == type_oid(T_GEOGRAPHY))
 		func = &geog_coveredby;
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		func, false);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -579,7 +851,7 @@ coveredby_tpoint_geo(PG_FUNCTION_ARGS)
 		func = &geom_coveredby;
 	else if (temp->valuetypid == type_oid(T_GEOGRAPHY))
 		func = &geog_coveredby;
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		func, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -637,7 +909,7 @@ crosses_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_crosses, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -659,7 +931,7 @@ crosses_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_crosses, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -709,7 +981,7 @@ disjoint_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_disjoint, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -731,7 +1003,7 @@ disjoint_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_disjoint, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -781,7 +1053,7 @@ equals_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_equals, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -803,7 +1075,7 @@ equals_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_equals, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -864,7 +1136,7 @@ intersects_geo_tpoint(PG_FUNCTION_ARGS)
 	}
 	else if (temp->valuetypid == type_oid(T_GEOGRAPHY))
 		func = &geog_intersects;
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		func, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -897,7 +1169,7 @@ intersects_tpoint_geo(PG_FUNCTION_ARGS)
 	}
 	else if (temp->valuetypid == type_oid(T_GEOGRAPHY))
 		func = &geog_intersects;
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs),
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs),
 		func, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -922,13 +1194,17 @@ intersects_tpoint_tpoint(PG_FUNCTION_ARGS)
 		PG_RETURN_NULL();
 	}
 
-	Datum (*func)(Datum, Datum) = NULL;
 	ensure_point_base_type(temp1->valuetypid);
+	Datum result;
+	/* The trajectories of temporal geometry points are intersected
+	 * directly from their segments */
 	if (temp1->valuetypid == type_oid(T_GEOMETRY))
-		func = &geom_intersects2d;
-	else if (temp1->valuetypid == type_oid(T_GEOGRAPHY))
-		func = &geog_intersects;
-	Datum result = spatialrel_tpoint_tpoint(inter1, inter2, func);
+	{
+		MOBDB_STAT_INC(STAT_SPATIALREL_CALLS);
+		result = BoolGetDatum(intersects_tpoint_tpoint_internal(inter1, inter2));
+	}
+	else
+		result = spatialrel_tpoint_tpoint(inter1, inter2, &geog_intersects);
 
 	pfree(inter1); pfree(inter2); 
 	PG_FREE_IF_COPY(temp1, 0);
@@ -955,7 +1231,7 @@ overlaps_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_overlaps, true);			
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -977,7 +1253,7 @@ overlaps_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_overlaps, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -1027,7 +1303,7 @@ touches_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_touches, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -1049,7 +1325,7 @@ touches_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_touches, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -1099,7 +1375,7 @@ within_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_within, true);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -1121,7 +1397,7 @@ within_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_within, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -1234,6 +1510,23 @@ dwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
 	Datum dist = PG_GETARG_DATUM(2);
 	ensure_same_srid_tpoint(temp1, temp2);
 	ensure_same_dimensionality_tpoint(temp1, temp2);
+	/* Temporal geometry points with linear interpolation are tested with 
+	 * the distance kernel, which does not synchronize them, skips the pairs
+	 * of sequences whose bounding boxes are too far apart, and stops at the
+	 * first instant at which the points are within the distance */
+	if (tpoint_distance_kernel(temp1, temp2))
+	{
+		double d = DatumGetFloat8(dist), mindist;
+		TimestampTz t;
+		bool overlap = tpoint_min_dist_kernel(temp1, temp2, d, d, 
+			&mindist, &t);
+		PG_FREE_IF_COPY(temp1, 0);
+		PG_FREE_IF_COPY(temp2, 1);
+		if (!overlap)
+			PG_RETURN_NULL();
+		PG_RETURN_BOOL(mindist <= d);
+	}
+
 	Temporal *sync1, *sync2;
 	/* Returns false if the temporal points do not intersect in time 
 	 * The last parameter crossing must be set to false */
@@ -1291,7 +1584,7 @@ relate_geo_tpoint(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(temp, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_relate, false);
 	PG_FREE_IF_COPY(gs, 0);
 	PG_FREE_IF_COPY(temp, 1);
@@ -1313,7 +1606,7 @@ relate_tpoint_geo(PG_FUNCTION_ARGS)
 		PG_FREE_IF_COPY(gs, 1);
 		PG_RETURN_NULL();
 	}
-	Datum result = spatialrel_tpoint_geo(temp, PointerGetDatum(gs), 
+	Datum result = spatialrel_tpoint_geo(fcinfo, temp, PointerGetDatum(gs), 
 		&geom_relate, false);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(gs, 1);
@@ -78,9 +78,11 @@
 
 #include "temporaltypes.h"
 #include "oidcache.h"
+#include "doublen.h"
 #include "tpoint.h"
 #include "tpoint_boxops.h"
 #include "tpoint_gist.h"
+#include "temporal_gist.h"
 
 /*****************************************************************************/
 
@@ -383,6 +385,117 @@ overAfter8D(CubeSTbox *cube_stbox, STBOX *query)
 	return (cube_stbox->left.tmin >= query->tmin);
 }
 
+/*
+ * Transform the queries into bounding boxes initializing the dimensions
+ * that must not be taken into account for the operators to infinity.
+ * This transformation is done once for all the nodes of an inner tuple.
+ */
+static STBOX *
+spgist_tpoint_queries(FmgrInfo *flinfo, ScanKey scankeys, int nkeys)
+{
+	STBOX *queries = (STBOX *) palloc0(sizeof(STBOX) * nkeys);
+	int i;
+	for (i = 0; i < nkeys; i++)
+	{
+		StrategyNumber strategy = scankeys[i].sk_strategy;
+		Oid subtype = scankeys[i].sk_subtype;
+		
+		if (subtype == type_oid(T_GEOMETRY) || subtype == type_oid(T_GEOGRAPHY) ||
+			temporal_type_oid(subtype))
+			/* We do not test the return value of the next function since
+			   if the result is false all dimensions of the box have been 
+			   initialized to +-infinity */
+			index_query_box(flinfo, scankeys[i].sk_argument, subtype,
+				&tpoint_query_box, sizeof(STBOX), &queries[i]);
+		else if (subtype == type_oid(T_STBOX))
+			memcpy(&queries[i], DatumGetSTboxP(scankeys[i].sk_argument), sizeof(STBOX));
+		else
+			elog(ERROR, "Unrecognized strategy number: %d", strategy);
+	}
+	return queries;
+}
+
+/*
+ * Can any box in cube_stbox satisfy all the scan keys?
+ */
+static bool
+consistent8D(CubeSTbox *cube_stbox, STBOX *queries, ScanKey scankeys,
+	int nkeys)
+{
+	bool flag = true;
+	int i;
+	for (i = 0; i < nkeys; i++)
+	{
+		StrategyNumber strategy = scankeys[i].sk_strategy;
+		switch (strategy)
+		{
+			case RTOverlapStrategyNumber:
+			case RTContainedByStrategyNumber:
+				flag = overlap8D(cube_stbox, &queries[i]);
+				break;
+			case RTContainsStrategyNumber:
+			case RTSameStrategyNumber:
+				flag = contain8D(cube_stbox, &queries[i]);
+				break;
+			case RTLeftStrategyNumber:
+				flag = !overRight8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverLeftStrategyNumber:
+				flag = !right8D(cube_stbox, &queries[i]);
+				break;
+			case RTRightStrategyNumber:
+				flag = !overLeft8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverRightStrategyNumber:
+				flag = !left8D(cube_stbox, &queries[i]);
+				break;
+			case RTFrontStrategyNumber:
+				flag = !overBack8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverFrontStrategyNumber:
+				flag = !back8D(cube_stbox, &queries[i]);
+				break;
+			case RTBackStrategyNumber:
+				flag = !overFront8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverBackStrategyNumber:
+				flag = !front8D(cube_stbox, &queries[i]);
+				break;
+			case RTAboveStrategyNumber:
+				flag = !overBelow8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverAboveStrategyNumber:
+				flag = !below8D(cube_stbox, &queries[i]);
+				break;
+			case RTBelowStrategyNumber:
+				flag = !overAbove8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverBelowStrategyNumber:
+				flag = !above8D(cube_stbox, &queries[i]);
+				break;
+			case RTAfterStrategyNumber:
+				flag = !overBefore8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverAfterStrategyNumber:
+				flag = !before8D(cube_stbox, &queries[i]);
+				break;
+			case RTBeforeStrategyNumber:
+				flag = !overAfter8D(cube_stbox, &queries[i]);
+				break;
+			case RTOverBeforeStrategyNumber:
+				flag = !after8D(cube_stbox, &queries[i]);
+				break;
+			default:
+				elog(ERROR, "unrecognized strategy: %d", strategy);
+		}
+
+		/* If any check is failed, we have found our answer. */
+		if (!flag)
+			break;
+	}
+	return flag;
+}
+
 /*****************************************************************************
  * SP-GiST config functions
  *****************************************************************************/
@@ -529,6 +642,7 @@ PG_FUNCTION_INFO_V1(spgist_tpoint_inner_consistent);
 PGDLLEXPORT Datum
 spgist_tpoint_inner_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
 	spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
 	int	i;
@@ -558,31 +672,10 @@ spgist_tpoint_inner_consistent(PG_FUNCTION_ARGS)
 		cube_stbox = initCubeSTbox();
 
 	/*
-	 * Transform the queries into bounding boxes initializing the dimensions
-	 * that must not be taken into account for the operators to infinity.
-	 * This transformation is done here to avoid doing it for all octants
-	 * in the loop below.
+	 * Transform the queries into bounding boxes. This transformation is done
+	 * here to avoid doing it for all octants in the loop below.
 	 */
-	queries = (STBOX *) palloc0(sizeof(STBOX) * in->nkeys);
-	for (i = 0; i < in->nkeys; i++)
-	{
-		StrategyNumber strategy = in->scankeys[i].sk_strategy;
-		Oid subtype = in->scankeys[i].sk_subtype;
-		
-		if (subtype == type_oid(T_GEOMETRY) || subtype == type_oid(T_GEOGRAPHY))
-			/* We do not test the return value of the next function since
-			   if the result is false all dimensions of the box have been 
-			   initialized to +-infinity */
-			geo_to_stbox_internal(&queries[i], 
-				(GSERIALIZED*)PG_DETOAST_DATUM(in->scankeys[i].sk_argument));
-		else if (subtype == type_oid(T_STBOX))
-			memcpy(&queries[i], DatumGetSTboxP(in->scankeys[i].sk_argument), sizeof(STBOX));
-		else if (temporal_type_oid(subtype))
-			temporal_bbox(&queries[i],
-				DatumGetTemporal(in->scankeys[i].sk_argument));
-		else
-			elog(ERROR, "Unrecognized strategy number: %d", strategy);
-	}
+	queries = spgist_tpoint_queries(fcinfo->flinfo, in->scankeys, in->nkeys);
 
 	/* Allocate enough memory for nodes */
 	out->nNodes = 0;
@@ -599,76 +692,8 @@ spgist_tpoint_inner_consistent(PG_FUNCTION_ARGS)
 	for (octant = 0; octant < in->nNodes; octant++)
 	{
 		CubeSTbox *next_cube_stbox = nextCubeSTbox(cube_stbox, centroid, (uint8) octant);
-		bool flag = true;
-		for (i = 0; i < in->nkeys; i++)
-		{
-			StrategyNumber strategy = in->scankeys[i].sk_strategy;
-			switch (strategy)
-			{
-				case RTOverlapStrategyNumber:
-				case RTContainedByStrategyNumber:
-					flag = overlap8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTContainsStrategyNumber:
-				case RTSameStrategyNumber:
-					flag = contain8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTLeftStrategyNumber:
-					flag = !overRight8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverLeftStrategyNumber:
-					flag = !right8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTRightStrategyNumber:
-					flag = !overLeft8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverRightStrategyNumber:
-					flag = !left8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTFrontStrategyNumber:
-					flag = !overBack8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverFrontStrategyNumber:
-					flag = !back8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTBackStrategyNumber:
-					flag = !overFront8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverBackStrategyNumber:
-					flag = !front8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTAboveStrategyNumber:
-					flag = !overBelow8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverAboveStrategyNumber:
-					flag = !below8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTBelowStrategyNumber:
-					flag = !overAbove8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverBelowStrategyNumber:
-					flag = !above8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTAfterStrategyNumber:
-					flag = !overBefore8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverAfterStrategyNumber:
-					flag = !before8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTBeforeStrategyNumber:
-					flag = !overAfter8D(next_cube_stbox, &queries[i]);
-					break;
-				case RTOverBeforeStrategyNumber:
-					flag = !after8D(next_cube_stbox, &queries[i]);
-					break;
-				default:
-					elog(ERROR, "unrecognized strategy: %d", strategy);
-			}
-
-			/* If any check is failed, we have found our answer. */
-			if (!flag)
-				break;
-		}
+		bool flag = consistent8D(next_cube_stbox, queries, in->scankeys,
+			in->nkeys);
 
 		if (flag)
 		{
@@ -694,6 +719,270 @@ spgist_tpoint_inner_consistent(PG_FUNCTION_ARGS)
 	PG_RETURN_VOID();
 }
 
+/*****************************************************************************
+ * SP-GiST kd-tree functions
+ *
+ * As for the oct-tree, the boxes are seen as points in 8-dimensional space,
+ * the coordinates being numbered 0 to 7 in the order xmin, xmax, ymin, ymax,
+ * zmin, zmax, tmin, and tmax. However, each inner tuple splits the space in
+ * two on a single coordinate, so that all the nodes of the inner tuples are
+ * populated and the picksplit function only needs to sort one array of
+ * coordinates. The prefix of an inner tuple is a double2 value whose first
+ * component is the split coordinate and the second one the split value.
+ *
+ * The spatial extent and the time extent of the boxes are not comparable,
+ * thus the axis is chosen in a round-robin fashion according to the level
+ * among the dimensions present in the boxes. For the chosen axis, the 
+ * coordinate with the largest spread, either the minimum or the maximum
+ * one, is used for splitting. The traversal values are the same CubeSTbox
+ * values as for the oct-tree and thus the consistent functions are shared.
+ *****************************************************************************/
+
+/* Value of the given coordinate of a box seen as an 8D point */
+static double
+kdCoord8D(const STBOX *box, int coord)
+{
+	switch (coord)
+	{
+		case 0: return box->xmin;
+		case 1: return box->xmax;
+		case 2: return box->ymin;
+		case 3: return box->ymax;
+		case 4: return box->zmin;
+		case 5: return box->zmax;
+		case 6: return (double) box->tmin;
+		default: return (double) box->tmax;
+	}
+}
+
+/* Node of the inner tuple in which a box must be stored */
+static int
+kdNode8D(const double2 *split, const STBOX *box)
+{
+	return (kdCoord8D(box, (int) split->a) > split->b) ? 1 : 0;
+}
+
+/*
+ * Calculate the next traversal value from the split of the inner tuple and
+ * the node. The bounds are only restricted for the split coordinate.
+ */
+static CubeSTbox *
+nextKdCubeSTbox(CubeSTbox *cube_stbox, const double2 *split, int node)
+{
+	CubeSTbox *next_cube_stbox = (CubeSTbox *) palloc(sizeof(CubeSTbox));
+	int coord = (int) split->a;
+	double value = split->b;
+
+	memcpy(next_cube_stbox, cube_stbox, sizeof(CubeSTbox));
+	
+	/* The even coordinates are the lower corner, the odd ones the upper one */
+	STBOX *corner = (coord % 2 == 0) ? &next_cube_stbox->left :
+		&next_cube_stbox->right;
+	switch (coord / 2)
+	{
+		case 0:
+			if (node)
+				corner->xmin = value;
+			else
+				corner->xmax = value;
+			break;
+		case 1:
+			if (node)
+				corner->ymin = value;
+			else
+				corner->ymax = value;
+			break;
+		case 2:
+			if (node)
+				corner->zmin = value;
+			else
+				corner->zmax = value;
+			break;
+		default:
+			if (node)
+				corner->tmin = (TimestampTz) value;
+			else
+				corner->tmax = (TimestampTz) value;
+			break;
+	}
+	return next_cube_stbox;
+}
+
+PG_FUNCTION_INFO_V1(spgist_tpoint_kdtree_config);
+
+PGDLLEXPORT Datum
+spgist_tpoint_kdtree_config(PG_FUNCTION_ARGS)
+{
+	spgConfigOut *cfg = (spgConfigOut *) PG_GETARG_POINTER(1);
+
+	cfg->prefixType = type_oid(T_DOUBLE2);	/* Split coordinate and value */
+	cfg->labelType = VOIDOID;	/* We don't need node labels. */
+	cfg->leafType = type_oid(T_STBOX);
+	cfg->canReturnData = false;
+	cfg->longValuesOK = false;
+
+	PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(spgist_tpoint_kdtree_choose);
+
+PGDLLEXPORT Datum
+spgist_tpoint_kdtree_choose(PG_FUNCTION_ARGS)
+{
+	spgChooseIn *in = (spgChooseIn *) PG_GETARG_POINTER(0);
+	spgChooseOut *out = (spgChooseOut *) PG_GETARG_POINTER(1);
+	double2 *split = DatumGetDouble2P(in->prefixDatum);
+	STBOX *box = DatumGetSTboxP(in->leafDatum);
+
+	out->resultType = spgMatchNode;
+	out->result.matchNode.restDatum = PointerGetDatum(box);
+
+	/* nodeN will be set by core, when allTheSame. */
+	if (!in->allTheSame)
+		out->result.matchNode.nodeN = kdNode8D(split, box);
+
+	PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(spgist_tpoint_kdtree_picksplit);
+
+PGDLLEXPORT Datum
+spgist_tpoint_kdtree_picksplit(PG_FUNCTION_ARGS)
+{
+	spgPickSplitIn *in = (spgPickSplitIn *) PG_GETARG_POINTER(0);
+	spgPickSplitOut *out = (spgPickSplitOut *) PG_GETARG_POINTER(1);
+	STBOX *box = DatumGetSTboxP(in->datums[0]);
+	double *lows = palloc(sizeof(double) * in->nTuples);
+	double *highs = palloc(sizeof(double) * in->nTuples);
+	int axes[4], naxes = 0, axis, coord, median, i;
+	double2 *split;
+
+	/* Determine the axes present in the boxes, the Z axis is only split 
+	   when the mobilitydb.index_use_z parameter is set */
+	if (MOBDB_FLAGS_GET_X(box->flags))
+	{
+		axes[naxes++] = 0;
+		axes[naxes++] = 1;
+	}
+	if (MOBDB_FLAGS_GET_Z(box->flags) && index_use_z)
+		axes[naxes++] = 2;
+	if (MOBDB_FLAGS_GET_T(box->flags))
+		axes[naxes++] = 3;
+	axis = (naxes == 0) ? 0 : axes[in->level % naxes];
+
+	/* Choose the coordinate of the axis with the largest spread */
+	for (i = 0; i < in->nTuples; i++)
+	{
+		box = DatumGetSTboxP(in->datums[i]);
+		lows[i] = kdCoord8D(box, axis * 2);
+		highs[i] = kdCoord8D(box, axis * 2 + 1);
+	}
+	qsort(lows, (size_t) in->nTuples, sizeof(double), compareDoubles);
+	qsort(highs, (size_t) in->nTuples, sizeof(double), compareDoubles);
+	median = in->nTuples / 2;
+	split = palloc(sizeof(double2));
+	if (highs[in->nTuples - 1] - highs[0] > lows[in->nTuples - 1] - lows[0])
+	{
+		coord = axis * 2 + 1;
+		double2_set(split, (double) coord, highs[median]);
+	}
+	else
+	{
+		coord = axis * 2;
+		double2_set(split, (double) coord, lows[median]);
+	}
+
+	/* Fill the output */
+	out->hasPrefix = true;
+	out->prefixDatum = PointerGetDatum(split);
+
+	out->nNodes = 2;
+	out->nodeLabels = NULL;		/* We don't need node labels. */
+
+	out->mapTuplesToNodes = palloc(sizeof(int) * in->nTuples);
+	out->leafTupleDatums = palloc(sizeof(Datum) * in->nTuples);
+
+	for (i = 0; i < in->nTuples; i++)
+	{
+		box = DatumGetSTboxP(in->datums[i]);
+		out->leafTupleDatums[i] = STboxPGetDatum(box);
+		out->mapTuplesToNodes[i] = kdNode8D(split, box);
+	}
+
+	pfree(lows); pfree(highs);
+
+	PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(spgist_tpoint_kdtree_inner_consistent);
+
+PGDLLEXPORT Datum
+spgist_tpoint_kdtree_inner_consistent(PG_FUNCTION_ARGS)
+{
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
+	spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
+	spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
+	int	i, node;
+	MemoryContext old_ctx;
+	CubeSTbox *cube_stbox;
+	double2 *split = DatumGetDouble2P(in->prefixDatum);
+	STBOX *queries;
+
+	if (in->allTheSame)
+	{
+		/* Report that all nodes should be visited */
+		out->nNodes = in->nNodes;
+		out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
+		for (i = 0; i < in->nNodes; i++)
+			out->nodeNumbers[i] = i;
+
+		PG_RETURN_VOID();
+	}
+	
+	/*
+	 * We are saving the traversal value or initialize it an unbounded one, if
+	 * we have just begun to walk the tree.
+	 */
+	if (in->traversalValue)
+		cube_stbox = in->traversalValue;
+	else
+		cube_stbox = initCubeSTbox();
+
+	queries = spgist_tpoint_queries(fcinfo->flinfo, in->scankeys, in->nkeys);
+
+	/* Allocate enough memory for nodes */
+	out->nNodes = 0;
+	out->nodeNumbers = (int *) palloc(sizeof(int) * in->nNodes);
+	out->traversalValues = (void **) palloc(sizeof(void *) * in->nNodes);
+
+	/*
+	 * We switch memory context, because we want to allocate memory for new
+	 * traversal values and pass these pieces of memory to further call of
+	 * this function.
+	 */
+	old_ctx = MemoryContextSwitchTo(in->traversalMemoryContext);
+
+	for (node = 0; node < in->nNodes; node++)
+	{
+		CubeSTbox *next_cube_stbox = nextKdCubeSTbox(cube_stbox, split, node);
+		if (consistent8D(next_cube_stbox, queries, in->scankeys, in->nkeys))
+		{
+			out->traversalValues[out->nNodes] = next_cube_stbox;
+			out->nodeNumbers[out->nNodes] = node;
+			out->nNodes++;
+		}
+		else
+			pfree(next_cube_stbox);
+	}
+
+	/* Switch after */
+	MemoryContextSwitchTo(old_ctx);
+
+	pfree(queries);
+	
+	PG_RETURN_VOID();
+}
+
 /*****************************************************************************
  * SP-GiST leaf-level consistency function
  *****************************************************************************/
@@ -703,6 +992,7 @@ PG_FUNCTION_INFO_V1(spgist_tpoint_leaf_consistent);
 PGDLLEXPORT Datum
 spgist_tpoint_leaf_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgLeafConsistentIn *in = (spgLeafConsistentIn *) PG_GETARG_POINTER(0);
 	spgLeafConsistentOut *out = (spgLeafConsistentOut *) PG_GETARG_POINTER(1);
 	STBOX *key = DatumGetSTboxP(in->leafDatum);
@@ -725,10 +1015,11 @@ spgist_tpoint_leaf_consistent(PG_FUNCTION_ARGS)
 		/* Update the recheck flag according to the strategy */
 		out->recheck |= index_tpoint_recheck(strategy);	
 
-		if (subtype == type_oid(T_GEOMETRY) || subtype == type_oid(T_GEOGRAPHY))
+		if (subtype == type_oid(T_GEOMETRY) || subtype == type_oid(T_GEOGRAPHY) ||
+			temporal_type_oid(subtype))
 		{
-			GSERIALIZED *gs = (GSERIALIZED*)PG_DETOAST_DATUM(in->scankeys[i].sk_argument);
-			if (!geo_to_stbox_internal(&query, gs))
+			if (!index_query_box(fcinfo->flinfo, in->scankeys[i].sk_argument,
+					subtype, &tpoint_query_box, sizeof(STBOX), &query))
 				res = false;
 			else
 				res = index_leaf_consistent_stbox(key, &query, strategy);
@@ -739,12 +1030,6 @@ spgist_tpoint_leaf_consistent(PG_FUNCTION_ARGS)
 			memcpy(&query, box, sizeof(STBOX));
 			res = index_leaf_consistent_stbox(key, &query, strategy);
 		}
-		else if (temporal_type_oid(subtype))
-		{
-			temporal_bbox(&query,
-				DatumGetTemporal(in->scankeys[i].sk_argument));
-			res = index_leaf_consistent_stbox(key, &query, strategy);
-		}
 		else
 			elog(ERROR, "unrecognized strategy: %d", strategy);
 
@@ -20,6 +20,9 @@
 
 #include "tpoint_tempspatialrels.h"
 
+#include <funcapi.h>
+#include <access/htup_details.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
@@ -28,10 +31,60 @@
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_parallel.h"
 #include "lifting.h"
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
 #include "tpoint_spatialrels.h"
+#include "tpoint_distance.h"
+
+/*****************************************************************************
+ * Bounding box tests on the sequences of a temporal point
+ *****************************************************************************/
+
+/*
+ * Determine whether the 2D bounding box of a temporal sequence point overlaps
+ * the bounding box of a geometry expanded by a distance. The test only reads
+ * the bounding box precomputed in the sequence and does not visit its 
+ * instants, which enables skipping whole sequences of a sequence set.
+ */
+static bool
+tpointseq_overlaps_gbox2d(TemporalSeq *seq, const GBOX *box, double dist)
+{
+	STBOX *seqbox = temporalseq_bbox_ptr(seq);
+	return seqbox->xmin <= box->xmax + dist && box->xmin <= seqbox->xmax + dist &&
+		seqbox->ymin <= box->ymax + dist && box->ymin <= seqbox->ymax + dist;
+}
+
+/*
+ * Determine whether the 2D bounding boxes of two temporal sequence points
+ * expanded by a distance overlap
+ */
+static bool
+tpointseq_overlaps_tpointseq2d(TemporalSeq *seq1, TemporalSeq *seq2, 
+	double dist)
+{
+	STBOX *box1 = temporalseq_bbox_ptr(seq1);
+	STBOX *box2 = temporalseq_bbox_ptr(seq2);
+	return box1->xmin <= box2->xmax + dist && box2->xmin <= box1->xmax + dist &&
+		box1->ymin <= box2->ymax + dist && box2->ymin <= box1->ymax + dist;
+}
+
+/*
+ * Construct a temporal sequence with a constant value and the period of 
+ * the sequence
+ */
+static TemporalSeq *
+temporalseq_constant(TemporalSeq *seq, Datum value, Oid valuetypid)
+{
+	TemporalInst *instants[2];
+	instants[0] = temporalinst_make(value, seq->period.lower, valuetypid);
+	instants[1] = temporalinst_make(value, seq->period.upper, valuetypid);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, 2,
+		seq->period.lower_inc, seq->period.upper_inc, false, false);
+	pfree(instants[0]); pfree(instants[1]);
+	return result;
+}
 
 /*****************************************************************************
  * Generic functions for computing the temporal spatial relationships 
@@ -151,13 +204,17 @@ tpointseq_intersection_instants(TemporalInst *inst1, TemporalInst *inst2,
 
 static TemporalSeq **
 tspatialrel_tpointseq_geo1(TemporalInst *inst1, TemporalInst *inst2, bool linear,
-	Datum geo, bool lower_inc, bool upper_inc, Datum (*func)(Datum, Datum), 
-	Oid valuetypid, int *count, bool invert)
+	Datum geo, const GBOX *box, bool lower_inc, bool upper_inc,
+	Datum (*func)(Datum, Datum), Oid valuetypid, int *count, bool invert)
 {
 	Datum value1 = temporalinst_value(inst1);
 	Datum value2 = temporalinst_value(inst2);
-	/* Constant segment or stepwise interpolation */
-	if (datum_point_eq(value1, value2) || ! linear)
+	/* Constant segment, stepwise interpolation, or segment whose bounding
+	 * box does not overlap the one of the geometry. In the latter case all
+	 * the points of the segment lie in the exterior of the geometry and thus
+	 * the relationship is the same for all of them */
+	if (datum_point_eq(value1, value2) || ! linear ||
+		box == NULL || ! geopoint_segment_overlaps_gbox2d(value1, value2, box))
 	{	
 		TemporalSeq **result = palloc(sizeof(TemporalSeq *));
 		TemporalInst *instants[2];
@@ -309,30 +366,65 @@ tspatialrel_tpointseq_geo2(TemporalSeq *seq, Datum geo,
 		return result;		
 	}
 	
+	/* An empty geometry has no bounding box, which is signaled by a NULL box */
+	GBOX gbox;
+	GBOX *box = geo_get_gbox2d(geo, &gbox) ? &gbox : NULL;
+	/* When the bounding boxes do not overlap the whole sequence lies in the
+	 * exterior of the geometry and the relationship is constant */
+	if (box != NULL && ! tpointseq_overlaps_gbox2d(seq, box, 0.0))
+	{
+		Datum value1 = temporalinst_value(temporalseq_inst_n(seq, 0));
+		Datum value = invert ? func(geo, value1) : func(value1, geo);
+		TemporalSeq **result = palloc(sizeof(TemporalSeq *));
+		result[0] = temporalseq_constant(seq, value, valuetypid);
+		FREE_DATUM(value, valuetypid);
+		*count = 1;
+		return result;
+	}
 	TemporalSeq ***sequences = palloc(sizeof(TemporalSeq *) * seq->count);
 	int *countseqs = palloc0(sizeof(int) * seq->count);
 	int totalseqs = 0;
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
 	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
 	bool lower_inc = seq->period.lower_inc;
-	for (int i = 0; i < seq->count - 1; i++)
-	{
-		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
-		bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false;
-		sequences[i] = tspatialrel_tpointseq_geo1(inst1, inst2, 
-			MOBDB_FLAGS_GET_LINEAR(seq->flags), geo, 
-			lower_inc, upper_inc, func, valuetypid, &countseqs[i], invert);
-		totalseqs += countseqs[i];
+	int i = 0, l = 0;
+	while (i < seq->count - 1)
+	{
+		/* Find the run of consecutive linear segments starting at i whose
+		 * bounding boxes do not overlap the one of the geometry. All these
+		 * segments lie in the exterior of the geometry and thus the 
+		 * relationship is constant for the whole run */
+		int j = i;
+		if (linear && box != NULL)
+		{
+			while (j < seq->count - 1 && ! geopoint_segment_overlaps_gbox2d(
+					temporalinst_value(temporalseq_inst_n(seq, j)),
+					temporalinst_value(temporalseq_inst_n(seq, j + 1)), box))
+				j++;
+		}
+		bool run = (j > i);
+		if (! run)
+			j = i + 1;
+		TemporalInst *inst2 = temporalseq_inst_n(seq, j);
+		bool upper_inc = (j == seq->count - 1) ? seq->period.upper_inc : false;
+		/* A run is computed as a single segment with stepwise interpolation,
+		 * that is, with the value of the relationship at its start */
+		sequences[l] = tspatialrel_tpointseq_geo1(inst1, inst2, linear && ! run,
+			geo, box, lower_inc, upper_inc, func, valuetypid, &countseqs[l], 
+			invert);
+		totalseqs += countseqs[l++];
 		inst1 = inst2;
 		lower_inc = true;
+		i = j;
 	}
 	TemporalSeq **result = palloc(sizeof(TemporalSeq *) * totalseqs);
 	int k = 0;
-	for (int i = 0; i < seq->count; i++)
+	for (int m = 0; m < l; m++)
 	{
-		for (int j = 0; j < countseqs[i]; j++)
-			result[k++] = sequences[i][j];
-		if (countseqs[i] != 0)
-			pfree(sequences[i]);
+		for (int n = 0; n < countseqs[m]; n++)
+			result[k++] = sequences[m][n];
+		if (countseqs[m] != 0)
+			pfree(sequences[m]);
 	}
 
 	*count = totalseqs;
@@ -670,6 +762,17 @@ tdwithin_tpointseq_geo1(TemporalSeq *seq, Datum geo, Datum dist, int *count)
 		*count = 1;
 		return result;
 	}
+
+	/* Bounding box test, which avoids computing the buffer */
+	GBOX box;
+	if (geo_get_gbox2d(geo, &box) &&
+		! tpointseq_overlaps_gbox2d(seq, &box, DatumGetFloat8(dist)))
+	{
+		TemporalSeq **result = palloc(sizeof(TemporalSeq *));
+		result[0] = temporalseq_constant(seq, BoolGetDatum(false), BOOLOID);
+		*count = 1;
+		return result;
+	}
 	
 	/* Restrict to the buffered geometry */
 	TemporalInst *instants[2];
@@ -856,7 +959,7 @@ tdwithin_tpoint_geo_internal(Temporal *temp, GSERIALIZED *gs, Datum dist)
 			Datum geom = call_function1(geometry_from_geography, 
 				PointerGetDatum(gs));
 			result = (Temporal *)tdwithin_tpoints_geo(ts1,
-				PointerGetDatum(gs), dist);
+				geom, dist);
 			pfree(ts1); pfree(DatumGetPointer(geom));
 		}
 	}
@@ -950,7 +1053,7 @@ tgeompoint '[POINT(4 3)@2000-01-04, POINT(5 3)@2000-01-05]', 1)
 
 static int
 tdwithin_tpointseq_tpointseq1(Datum sv1, Datum ev1, Datum sv2, Datum ev2, 
-	TimestampTz lower, TimestampTz upper, double d, bool hasz,
+	TimestampTz lower, TimestampTz upper, double d, bool hasz, bool geodetic,
 	Datum (*func)(Datum, Datum, Datum), TimestampTz *t1, TimestampTz *t2)
 {
 	/* To reduce problems related to floating point arithmetic, lower and upper
@@ -958,7 +1061,9 @@ tdwithin_tpointseq_tpointseq1(Datum sv1, Datum ev1, Datum sv2, Datum ev2,
 	   of the quadratic equation */
 	double duration = upper - lower;
 	long double a, b, c;
-	if (hasz) /* 3D */
+	/* In fast mode geography segments are projected onto a local plane */
+	bool localplane = geodetic && geodetic_fast_path;
+	if (hasz && ! localplane) /* 3D */
 	{
 		POINT3DZ p1 = datum_get_point3dz(sv1);
 		POINT3DZ p2 = datum_get_point3dz(ev1);
@@ -1004,10 +1109,14 @@ tdwithin_tpointseq_tpointseq1(Datum sv1, Datum ev1, Datum sv2, Datum ev2,
 	}
 	else /* 2D */
 	{
-		POINT2D p1 = datum_get_point2d(sv1);
-		POINT2D p2 = datum_get_point2d(ev1);
-		POINT2D p3 = datum_get_point2d(sv2);
-		POINT2D p4 = datum_get_point2d(ev2);
+		POINT2D points[4];
+		points[0] = datum_get_point2d(sv1);
+		points[1] = datum_get_point2d(ev1);
+		points[2] = datum_get_point2d(sv2);
+		points[3] = datum_get_point2d(ev2);
+		if (localplane)
+			geog_points_local_plane(points, 4);
+		POINT2D p1 = points[0], p2 = points[1], p3 = points[2], p4 = points[3];
 		/* per1 functions
 		 * x(t) = a1 * t + c1
 		 * y(t) = a2 * t + c2 */
@@ -1111,6 +1220,7 @@ tdwithin_tpointseq_tpointseq2(TemporalSeq **result,
 	Datum sv2 = temporalinst_value(start2);
 	Datum ev2 = temporalinst_value(end2);
 	bool hasz = MOBDB_FLAGS_GET_Z(start1->flags);
+	bool geodetic = MOBDB_FLAGS_GET_GEODETIC(start1->flags);
 	TemporalInst *instants[2];
 	Datum datum_true = BoolGetDatum(true);
 	Datum datum_false = BoolGetDatum(false);
@@ -1152,7 +1262,7 @@ tdwithin_tpointseq_tpointseq2(TemporalSeq **result,
 	Datum sev1 = linear1 ? ev1 : sv1;
 	Datum sev2 = linear2 ? ev2 : sv2;
 	int solutions = tdwithin_tpointseq_tpointseq1(sv1, sev1, sv2, sev2,
-		lower, upper, DatumGetFloat8(d), hasz, func, &t1, &t2);
+		lower, upper, DatumGetFloat8(d), hasz, geodetic, func, &t1, &t2);
 
 	/* No instant is returned */
 	int k;
@@ -1306,6 +1416,15 @@ tdwithin_tpointseq_tpointseq3(TemporalSeq **result, TemporalSeq *seq1, TemporalS
 		return 1;
 	}
 
+	/* Bounding box test, the distance between geodetic points is not
+	 * expressed in the units of their bounding boxes */
+	if (! MOBDB_FLAGS_GET_GEODETIC(seq1->flags) &&
+		! tpointseq_overlaps_tpointseq2d(seq1, seq2, DatumGetFloat8(d)))
+	{
+		result[0] = temporalseq_constant(seq1, BoolGetDatum(false), BOOLOID);
+		return 1;
+	}
+
 	int k = 0;
 	TemporalInst *start1 = temporalseq_inst_n(seq1, 0);
 	TemporalInst *start2 = temporalseq_inst_n(seq2, 0);
@@ -2094,25 +2213,16 @@ tdwithin_tpoint_geo(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
-PG_FUNCTION_INFO_V1(tdwithin_tpoint_tpoint);
+/* Returns NULL if the temporal points do not intersect in time */
 
-PGDLLEXPORT Datum
-tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
+Temporal *
+tdwithin_tpoint_tpoint_internal(Temporal *temp1, Temporal *temp2, Datum dist)
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	Datum dist = PG_GETARG_DATUM(2);
-	ensure_same_srid_tpoint(temp1, temp2);
-	ensure_same_dimensionality_tpoint(temp1, temp2);
 	Temporal *sync1, *sync2;
 	/* Return false if the temporal points do not intersect in time
 	   The last parameter crossing must be set to false  */
 	if (!synchronize_temporal_temporal(temp1, temp2, &sync1, &sync2, false))
-	{
-		PG_FREE_IF_COPY(temp1, 0);
-		PG_FREE_IF_COPY(temp2, 1);
-		PG_RETURN_NULL();
-	}
+		return NULL;
 
 	Datum (*func)(Datum, Datum, Datum) = NULL;
 	ensure_point_base_type(temp1->valuetypid);
@@ -2124,7 +2234,7 @@ tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
 			func = &geom_dwithin2d;
 	}
 	else if (temp1->valuetypid == type_oid(T_GEOGRAPHY))
-		func = &geog_dwithin;
+		func = geodetic_fast_path ? &geog_dwithin_sphere : &geog_dwithin;
 
 	Temporal *result = NULL;
 	ensure_valid_duration(sync1->duration);
@@ -2144,11 +2254,524 @@ tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
 			(TemporalS *)sync1, (TemporalS *)sync2, dist, func);
 
 	pfree(sync1); pfree(sync2); 
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(tdwithin_tpoint_tpoint);
+
+PGDLLEXPORT Datum
+tdwithin_tpoint_tpoint(PG_FUNCTION_ARGS)
+{
+	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
+	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
+	Datum dist = PG_GETARG_DATUM(2);
+	ensure_same_srid_tpoint(temp1, temp2);
+	ensure_same_dimensionality_tpoint(temp1, temp2);
+	Temporal *result = tdwithin_tpoint_tpoint_internal(temp1, temp2, dist);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
+	if (result == NULL)
+		PG_RETURN_NULL();
 	PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Temporal dwithin between all pairs of an array of temporal points
+ *
+ * The bounding boxes of the temporal points are swept in increasing order of
+ * their start timestamp. The boxes whose period ended before the start of the
+ * current one are removed from the active list, and the current box is only
+ * compared with the active boxes whose spatial extent is within the distance
+ * of its own. The temporal dwithin is thus only computed for the pairs of
+ * temporal points that may be within the distance.
+ *****************************************************************************/
+
+/* Temporal point in the sweep */
+
+typedef struct
+{
+	int			idx;		/* Position of the temporal point in the array */
+	STBOX		box;		/* Bounding box of the temporal point */
+} TpointSweepItem;
+
+/* Contacts between the temporal points returned by the function */
+
+typedef struct
+{
+	int			count;		/* Number of contacts */
+	int			pos;		/* Next contact to return */
+	Datum	   *ids1;		/* Identifier of the first temporal point */
+	Datum	   *ids2;		/* Identifier of the second temporal point */
+	PeriodSet **periods;	/* Periods at which they are within the distance */
+} TdwithinPairsState;
+
+static int
+tpoint_sweep_cmp(const void *a, const void *b)
+{
+	const TpointSweepItem *item1 = (const TpointSweepItem *) a;
+	const TpointSweepItem *item2 = (const TpointSweepItem *) b;
+	return timestamp_cmp_internal(item1->box.tmin, item2->box.tmin);
+}
+
+/* Returns true if the spatial extents of the boxes are within the distance
+ * on each dimension */
+
+static bool
+stbox_dwithin_spatial(const STBOX *box1, const STBOX *box2, double d, 
+	bool hasz)
+{
+	if (box1->xmin - box2->xmax > d || box2->xmin - box1->xmax > d ||
+		box1->ymin - box2->ymax > d || box2->ymin - box1->ymax > d)
+		return false;
+	if (hasz && (box1->zmin - box2->zmax > d || box2->zmin - box1->zmax > d))
+		return false;
+	return true;
+}
+
+/*
+ * Coordinates of the temporal points decoded for the filtering kernel. The
+ * instants of all temporal points are stored in the same arrays, those of
+ * each sequence being contiguous. Instants and instant sets are decoded as
+ * one sequence per instant.
+ */
+typedef struct
+{
+	TimestampTz *t;			/* Timestamps of the instants */
+	double	   *x;			/* Coordinates of the instants */
+	double	   *y;
+	double	   *z;			/* NULL for 2D points */
+	int		   *seqs;		/* First instant of each sequence, with a sentinel */
+	bool	   *linear;		/* Interpolation of each sequence */
+	int		   *first;		/* First sequence of each temporal point, with a sentinel */
+} TpointCoords;
+
+/* Argument of the filtering kernel */
+
+typedef struct
+{
+	const TpointCoords *coords;
+	const int  *idx1;		/* Candidate pairs of temporal points */
+	const int  *idx2;
+	double		dist2;		/* Square of the distance */
+	bool	   *keep;		/* Whether the pair may be within the distance */
+} TdwithinFilter;
+
+static void
+tpoint_coords_add_inst(TpointCoords *coords, int *ninsts, TemporalInst *inst)
+{
+	int n = (*ninsts)++;
+	coords->t[n] = inst->t;
+	if (coords->z != NULL)
+	{
+		POINT3DZ p = datum_get_point3dz(temporalinst_value(inst));
+		coords->x[n] = p.x; coords->y[n] = p.y; coords->z[n] = p.z;
+	}
+	else
+	{
+		POINT2D p = datum_get_point2d(temporalinst_value(inst));
+		coords->x[n] = p.x; coords->y[n] = p.y;
+	}
+}
+
+static void
+tpoint_coords_add_seq(TpointCoords *coords, int *ninsts, int *nseqs,
+	TemporalSeq *seq)
+{
+	coords->linear[*nseqs] = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	coords->seqs[(*nseqs)++] = *ninsts;
+	for (int i = 0; i < seq->count; i++)
+		tpoint_coords_add_inst(coords, ninsts, temporalseq_inst_n(seq, i));
+}
+
+/* Decode the coordinates of the temporal points in the backend */
+
+static TpointCoords *
+tpoint_coords_decode(Temporal **temparr, int count, bool hasz)
+{
+	int totalinsts = 0, totalseqs = 0;
+	for (int i = 0; i < count; i++)
+	{
+		Temporal *temp = temparr[i];
+		ensure_valid_duration(temp->duration);
+		if (temp->duration == TEMPORALINST)
+		{
+			totalinsts++; totalseqs++;
+		}
+		else if (temp->duration == TEMPORALI)
+		{
+			totalinsts += ((TemporalI *)temp)->count;
+			totalseqs += ((TemporalI *)temp)->count;
+		}
+		else if (temp->duration == TEMPORALSEQ)
+		{
+			totalinsts += ((TemporalSeq *)temp)->count;
+			totalseqs++;
+		}
+		else if (temp->duration == TEMPORALS)
+		{
+			totalinsts += ((TemporalS *)temp)->totalcount;
+			totalseqs += ((TemporalS *)temp)->count;
+		}
+	}
+
+	TpointCoords *result = palloc(sizeof(TpointCoords));
+	result->t = palloc(sizeof(TimestampTz) * totalinsts);
+	result->x = palloc(sizeof(double) * totalinsts);
+	result->y = palloc(sizeof(double) * totalinsts);
+	result->z = hasz ? palloc(sizeof(double) * totalinsts) : NULL;
+	result->seqs = palloc(sizeof(int) * (totalseqs + 1));
+	result->linear = palloc(sizeof(bool) * totalseqs);
+	result->first = palloc(sizeof(int) * (count + 1));
+	int ninsts = 0, nseqs = 0;
+	for (int i = 0; i < count; i++)
+	{
+		Temporal *temp = temparr[i];
+		result->first[i] = nseqs;
+		if (temp->duration == TEMPORALINST)
+		{
+			result->linear[nseqs] = false;
+			result->seqs[nseqs++] = ninsts;
+			tpoint_coords_add_inst(result, &ninsts, (TemporalInst *)temp);
+		}
+		else if (temp->duration == TEMPORALI)
+		{
+			TemporalI *ti = (TemporalI *)temp;
+			for (int j = 0; j < ti->count; j++)
+			{
+				result->linear[nseqs] = false;
+				result->seqs[nseqs++] = ninsts;
+				tpoint_coords_add_inst(result, &ninsts, temporali_inst_n(ti, j));
+			}
+		}
+		else if (temp->duration == TEMPORALSEQ)
+			tpoint_coords_add_seq(result, &ninsts, &nseqs, (TemporalSeq *)temp);
+		else if (temp->duration == TEMPORALS)
+		{
+			TemporalS *ts = (TemporalS *)temp;
+			for (int j = 0; j < ts->count; j++)
+				tpoint_coords_add_seq(result, &ninsts, &nseqs,
+					temporals_seq_n(ts, j));
+		}
+	}
+	result->first[count] = nseqs;
+	result->seqs[nseqs] = ninsts;
+	return result;
+}
+
+/*
+ * Position at timestamp t of the segment of a sequence starting at instant
+ * i, where last is the last instant of the sequence. The position of a
+ * stepwise segment at its end is the value of its start.
+ */
+static void
+tpoint_coords_pos(const TpointCoords *coords, int i, int last, bool linear,
+	TimestampTz t, double *p)
+{
+	p[0] = coords->x[i];
+	p[1] = coords->y[i];
+	p[2] = coords->z != NULL ? coords->z[i] : 0.0;
+	if (! linear || i == last || t == coords->t[i])
+		return;
+	double ratio = (double) (t - coords->t[i]) / 
+		(double) (coords->t[i + 1] - coords->t[i]);
+	p[0] += (coords->x[i + 1] - coords->x[i]) * ratio;
+	p[1] += (coords->y[i + 1] - coords->y[i]) * ratio;
+	if (coords->z != NULL)
+		p[2] += (coords->z[i + 1] - coords->z[i]) * ratio;
+}
+
+/* Minimum squared norm of the vectors on the segment from r1 to r2 */
+
+static double
+tpoint_coords_min_dist2(const double *r1, const double *r2)
+{
+	double d[3] = {r2[0] - r1[0], r2[1] - r1[1], r2[2] - r1[2]};
+	double dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+	double s = 0.0;
+	if (dd > 0.0)
+	{
+		s = - (r1[0] * d[0] + r1[1] * d[1] + r1[2] * d[2]) / dd;
+		s = Max(0.0, Min(1.0, s));
+	}
+	double r[3] = {r1[0] + s * d[0], r1[1] + s * d[1], r1[2] + s * d[2]};
+	return r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+}
+
+/*
+ * Returns true if the two sequences may be within the distance during
+ * their common period. Both sequences are linear functions of time between
+ * the union of their timestamps, and thus so is the vector between them,
+ * whose minimum norm on each of these intervals is computed in closed form.
+ * The bounds of the sequences are considered inclusive.
+ */
+static bool
+tpoint_coords_seq_dwithin(const TpointCoords *coords, int seq1, int seq2,
+	double dist2)
+{
+	int first1 = coords->seqs[seq1], last1 = coords->seqs[seq1 + 1] - 1;
+	int first2 = coords->seqs[seq2], last2 = coords->seqs[seq2 + 1] - 1;
+	bool linear1 = coords->linear[seq1], linear2 = coords->linear[seq2];
+	TimestampTz lower = Max(coords->t[first1], coords->t[first2]);
+	TimestampTz upper = Min(coords->t[last1], coords->t[last2]);
+	if (lower > upper)
+		return false;
+
+	/* Segments containing the start of the common period */
+	int i = first1, j = first2;
+	while (i < last1 - 1 && coords->t[i + 1] <= lower)
+		i++;
+	while (j < last2 - 1 && coords->t[j + 1] <= lower)
+		j++;
+	double p1[3], p2[3], r1[3], r2[3];
+	for (;;)
+	{
+		int inext = Min(i + 1, last1), jnext = Min(j + 1, last2);
+		TimestampTz u = Max(lower, Max(coords->t[i], coords->t[j]));
+		TimestampTz v = Min(upper, Min(coords->t[inext], coords->t[jnext]));
+		tpoint_coords_pos(coords, i, last1, linear1, u, p1);
+		tpoint_coords_pos(coords, j, last2, linear2, u, p2);
+		for (int k = 0; k < 3; k++)
+			r1[k] = p1[k] - p2[k];
+		tpoint_coords_pos(coords, i, last1, linear1, v, p1);
+		tpoint_coords_pos(coords, j, last2, linear2, v, p2);
+		for (int k = 0; k < 3; k++)
+			r2[k] = p1[k] - p2[k];
+		if (tpoint_coords_min_dist2(r1, r2) <= dist2)
+			return true;
+		if (v >= upper)
+			break;
+		if (coords->t[inext] == v && i < last1 - 1)
+			i++;
+		if (coords->t[jnext] == v && j < last2 - 1)
+			j++;
+	}
+	/* The positions at the end of the common period, which differ from the
+	 * end of the last segments for stepwise sequences */
+	int inext = Min(i + 1, last1), jnext = Min(j + 1, last2);
+	if (coords->t[inext] == upper)
+		i = inext;
+	if (coords->t[jnext] == upper)
+		j = jnext;
+	tpoint_coords_pos(coords, i, last1, linear1, upper, p1);
+	tpoint_coords_pos(coords, j, last2, linear2, upper, p2);
+	for (int k = 0; k < 3; k++)
+		r1[k] = p1[k] - p2[k];
+	return tpoint_coords_min_dist2(r1, r1) <= dist2;
+}
+
+/* Returns true if the two temporal points may be within the distance */
+
+static bool
+tpoint_coords_dwithin(const TpointCoords *coords, int idx1, int idx2,
+	double dist2)
+{
+	int seq1 = coords->first[idx1], end1 = coords->first[idx1 + 1];
+	int seq2 = coords->first[idx2], end2 = coords->first[idx2 + 1];
+	while (seq1 < end1 && seq2 < end2)
+	{
+		if (tpoint_coords_seq_dwithin(coords, seq1, seq2, dist2))
+			return true;
+		/* Advance the sequence that ends first */
+		if (coords->t[coords->seqs[seq1 + 1] - 1] <= 
+				coords->t[coords->seqs[seq2 + 1] - 1])
+			seq1++;
+		else
+			seq2++;
+	}
+	return false;
+}
+
+/* Kernel filtering the candidate pairs, which may run in a thread */
+
+static void
+tdwithin_filter_kernel(void *arg, int start, int end)
+{
+	TdwithinFilter *filter = (TdwithinFilter *) arg;
+	for (int i = start; i < end; i++)
+		filter->keep[i] = tpoint_coords_dwithin(filter->coords,
+			filter->idx1[i], filter->idx2[i], filter->dist2);
+}
+
+/*
+ * Compute the contacts between all pairs of temporal points. The sweep of
+ * the bounding boxes collects the candidate pairs. For temporal geometry
+ * points, the candidate pairs are then filtered by a numeric kernel over
+ * the decoded coordinates, which runs in the pool of threads, so that the
+ * temporal dwithin, which allocates memory and calls PostGIS, is only
+ * computed in the backend for the pairs that may be within the distance.
+ */
+
+static TdwithinPairsState *
+tdwithin_pairs1(Datum *ids, Temporal **temparr, int count, Datum dist)
+{
+	double d = DatumGetFloat8(dist);
+	TdwithinPairsState *state = palloc0(sizeof(TdwithinPairsState));
+	if (count < 2)
+		return state;
+
+	TpointSweepItem *items = palloc0(sizeof(TpointSweepItem) * count);
+	for (int i = 0; i < count; i++)
+	{
+		ensure_same_srid_tpoint(temparr[0], temparr[i]);
+		ensure_same_dimensionality_tpoint(temparr[0], temparr[i]);
+		items[i].idx = i;
+		temporal_bbox(&items[i].box, temparr[i]);
+	}
+	bool hasz = MOBDB_FLAGS_GET_Z(temparr[0]->flags);
+	qsort(items, count, sizeof(TpointSweepItem), &tpoint_sweep_cmp);
+
+	/* Collect the candidate pairs */
+	int ncands = 0, maxcands = count;
+	int *idx1 = palloc(sizeof(int) * maxcands);
+	int *idx2 = palloc(sizeof(int) * maxcands);
+	int *active = palloc(sizeof(int) * count);
+	int nactive = 0;
+	for (int i = 0; i < count; i++)
+	{
+		STBOX *box = &items[i].box;
+		/* Remove the active boxes that ended before the current one starts */
+		int k = 0;
+		for (int j = 0; j < nactive; j++)
+		{
+			if (timestamp_cmp_internal(items[active[j]].box.tmax, box->tmin) >= 0)
+				active[k++] = active[j];
+		}
+		nactive = k;
+		for (int j = 0; j < nactive; j++)
+		{
+			TpointSweepItem *item = &items[active[j]];
+			if (!stbox_dwithin_spatial(&item->box, box, d, hasz))
+				continue;
+			if (ncands == maxcands)
+			{
+				maxcands *= 2;
+				idx1 = repalloc(idx1, sizeof(int) * maxcands);
+				idx2 = repalloc(idx2, sizeof(int) * maxcands);
+			}
+			idx1[ncands] = Min(item->idx, items[i].idx);
+			idx2[ncands++] = Max(item->idx, items[i].idx);
+		}
+		active[nactive++] = i;
+	}
+	pfree(items); pfree(active);
+
+	/* Filter the candidate pairs of temporal geometry points */
+	bool *keep = palloc(sizeof(bool) * Max(ncands, 1));
+	if (temparr[0]->valuetypid == type_oid(T_GEOMETRY))
+	{
+		TdwithinFilter filter;
+		filter.coords = tpoint_coords_decode(temparr, count, hasz);
+		filter.idx1 = idx1;
+		filter.idx2 = idx2;
+		/* The filter must not discard pairs because of rounding errors */
+		double slack = (d + EPSILON) * (1.0 + EPSILON);
+		filter.dist2 = slack * slack;
+		filter.keep = keep;
+		parallel_for(ncands, 64, &tdwithin_filter_kernel, &filter);
+		TpointCoords *coords = (TpointCoords *) filter.coords;
+		pfree(coords->t); pfree(coords->x); pfree(coords->y);
+		if (coords->z != NULL)
+			pfree(coords->z);
+		pfree(coords->seqs); pfree(coords->linear); pfree(coords->first);
+		pfree(coords);
+	}
+	else
+		memset(keep, true, sizeof(bool) * Max(ncands, 1));
+
+	int maxcount = count;
+	state->ids1 = palloc(sizeof(Datum) * maxcount);
+	state->ids2 = palloc(sizeof(Datum) * maxcount);
+	state->periods = palloc(sizeof(PeriodSet *) * maxcount);
+
+	/* The temporal dwithin of each pair is computed in a temporary context */
+	MemoryContext paircxt = AllocSetContextCreate(CurrentMemoryContext,
+		"tdwithin pairs", ALLOCSET_DEFAULT_SIZES);
+	for (int i = 0; i < ncands; i++)
+	{
+		if (! keep[i])
+			continue;
+		MemoryContext oldcxt = MemoryContextSwitchTo(paircxt);
+		PeriodSet *ps = NULL;
+		Temporal *tdwithin = tdwithin_tpoint_tpoint_internal(temparr[idx1[i]],
+			temparr[idx2[i]], dist);
+		if (tdwithin != NULL)
+		{
+			Temporal *attrue = temporal_at_value_internal(tdwithin,
+				BoolGetDatum(true));
+			if (attrue != NULL)
+			{
+				MemoryContextSwitchTo(oldcxt);
+				ps = temporal_get_time_internal(attrue);
+			}
+		}
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextReset(paircxt);
+		if (ps == NULL)
+			continue;
+		if (state->count == maxcount)
+		{
+			maxcount *= 2;
+			state->ids1 = repalloc(state->ids1, sizeof(Datum) * maxcount);
+			state->ids2 = repalloc(state->ids2, sizeof(Datum) * maxcount);
+			state->periods = repalloc(state->periods, 
+				sizeof(PeriodSet *) * maxcount);
+		}
+		state->ids1[state->count] = ids[idx1[i]];
+		state->ids2[state->count] = ids[idx2[i]];
+		state->periods[state->count++] = ps;
+	}
+	MemoryContextDelete(paircxt);
+	pfree(idx1); pfree(idx2); pfree(keep);
+	return state;
+}
+
+PG_FUNCTION_INFO_V1(tdwithin_pairs);
+
+PGDLLEXPORT Datum
+tdwithin_pairs(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext = 
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		ArrayType *idarr = PG_GETARG_ARRAYTYPE_P(0);
+		ArrayType *temparr = PG_GETARG_ARRAYTYPE_P(1);
+		Datum dist = PG_GETARG_DATUM(2);
+		if (DatumGetFloat8(dist) < 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+				errmsg("The distance cannot be negative")));
+		int count1, count2;
+		Datum *ids = datumarr_extract(idarr, &count1);
+		Temporal **temps = temporalarr_extract(temparr, &count2);
+		if (count1 != count2)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+				errmsg("The arrays of identifiers and of temporal points must have the same length")));
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		funcctx->user_fctx = tdwithin_pairs1(ids, temps, count1, dist);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	TdwithinPairsState *state = (TdwithinPairsState *) funcctx->user_fctx;
+	if (state->pos == state->count)
+		SRF_RETURN_DONE(funcctx);
+
+	Datum values[3];
+	bool nulls[3] = {false, false, false};
+	values[0] = state->ids1[state->pos];
+	values[1] = state->ids2[state->pos];
+	values[2] = PointerGetDatum(state->periods[state->pos]);
+	state->pos++;
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
 /*****************************************************************************
  * Temporal relate
  *****************************************************************************/
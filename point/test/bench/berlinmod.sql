@@ -0,0 +1,259 @@
+/*****************************************************************************
+ *
+ * berlinmod.sql
+ *	  Benchmark workload in the style of the BerlinMOD benchmark
+ *
+ * The data generator simulates vehicles that drive every day from their
+ * home node to their work node in the morning and back in the evening,
+ * along a path through random waypoints at varying speeds. The size of the
+ * data is controlled by the scale factor, which is read from the setting
+ * bench.scale_factor, e.g., by setting PGOPTIONS='-c bench.scale_factor=0.1'.
+ * As in BerlinMOD, the number of vehicles is 2000 * sqrt(scale factor) and
+ * the number of days is 28 * sqrt(scale factor). The default scale factor
+ * of 0.005 generates 141 vehicles during 2 days.
+ *
+ * The query mix consists of range queries (spatial, temporal, and
+ * spatiotemporal), nearest-neighbour queries, aggregate queries, and
+ * spatiotemporal joins. Each query is run for several query parameters.
+ * The latency of each execution is stored in table bench_berlinmod_runs,
+ * the EXPLAIN (ANALYZE, BUFFERS) output of the first execution of each
+ * query in table bench_berlinmod_plans, and the latency percentiles of
+ * each query in table bench_berlinmod_summary.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE OR REPLACE FUNCTION berlinmod_scale_factor()
+	RETURNS float AS $$
+BEGIN
+	RETURN coalesce(nullif(current_setting('bench.scale_factor', true), ''),
+		'0.005')::float;
+END;
+$$ LANGUAGE 'plpgsql';
+
+-------------------------------------------------------------------------------
+-- Data generator
+-------------------------------------------------------------------------------
+
+/* Size of the square in which the vehicles move, in meters */
+CREATE OR REPLACE FUNCTION berlinmod_extent()
+	RETURNS float AS $$
+BEGIN
+	RETURN 50000;
+END;
+$$ LANGUAGE 'plpgsql' IMMUTABLE;
+
+CREATE OR REPLACE FUNCTION berlinmod_random_point()
+	RETURNS geometry AS $$
+BEGIN
+	RETURN ST_MakePoint(random() * berlinmod_extent(),
+		random() * berlinmod_extent());
+END;
+$$ LANGUAGE 'plpgsql';
+
+/*
+ * Trip from the source to the destination through a number of random
+ * waypoints close to the line joining them. The speed of the vehicle
+ * varies randomly between 20 and 100 km/h and a position is recorded
+ * every 10 seconds.
+ */
+CREATE OR REPLACE FUNCTION berlinmod_trip(source geometry, dest geometry,
+	start timestamptz, nwaypoints int)
+	RETURNS tgeompoint AS $$
+DECLARE
+	waypoints geometry[];
+	instants tgeompoint[];
+	p1 geometry;
+	p2 geometry;
+	t timestamptz;
+	speed float;
+	dist float;
+	nsteps int;
+	frac float;
+BEGIN
+	waypoints = array_append(waypoints, source);
+	FOR i IN 1..nwaypoints LOOP
+		frac = i::float / (nwaypoints + 1);
+		waypoints = array_append(waypoints, ST_MakePoint(
+			ST_X(source) + frac * (ST_X(dest) - ST_X(source)) + (random() - 0.5) * 1000,
+			ST_Y(source) + frac * (ST_Y(dest) - ST_Y(source)) + (random() - 0.5) * 1000));
+	END LOOP;
+	waypoints = array_append(waypoints, dest);
+	t = start;
+	instants = array_append(instants, tgeompointinst(source, t));
+	FOR i IN 1..array_length(waypoints, 1) - 1 LOOP
+		p1 = waypoints[i];
+		p2 = waypoints[i + 1];
+		/* Speed in meters per second */
+		speed = (20 + random() * 80) / 3.6;
+		dist = ST_Distance(p1, p2);
+		nsteps = greatest(1, ceil(dist / (speed * 10))::int);
+		FOR j IN 1..nsteps LOOP
+			t = t + (dist / speed / nsteps) * interval '1 second';
+			instants = array_append(instants, tgeompointinst(
+				ST_LineInterpolatePoint(ST_MakeLine(p1, p2), j::float / nsteps), t));
+		END LOOP;
+	END LOOP;
+	RETURN tgeompointseq(instants);
+END;
+$$ LANGUAGE 'plpgsql' STRICT;
+
+CREATE OR REPLACE FUNCTION berlinmod_generate(scalefactor float)
+	RETURNS void AS $$
+DECLARE
+	nvehicles int;
+	ndays int;
+BEGIN
+	nvehicles = round(2000 * sqrt(scalefactor));
+	ndays = greatest(1, round(28 * sqrt(scalefactor)));
+	RAISE NOTICE 'Generating % vehicles during % days', nvehicles, ndays;
+
+	DROP TABLE IF EXISTS Vehicles, Trips, QueryPoints, QueryRegions,
+		QueryInstants, QueryPeriods;
+
+	CREATE TABLE Vehicles AS
+	SELECT v AS VehId, 'B-' || lpad(v::text, 4, '0') AS Licence,
+		berlinmod_random_point() AS Home, berlinmod_random_point() AS Work
+	FROM generate_series(1, nvehicles) v;
+
+	CREATE TABLE Trips AS
+	SELECT row_number() OVER (ORDER BY VehId, d, dir) AS TripId, VehId,
+		CASE WHEN dir = 1 THEN berlinmod_trip(Home, Work,
+			'2007-05-28'::timestamptz + d * interval '1 day' +
+			interval '7 hours' + random() * interval '2 hours', 5)
+		ELSE berlinmod_trip(Work, Home,
+			'2007-05-28'::timestamptz + d * interval '1 day' +
+			interval '16 hours' + random() * interval '2 hours', 5)
+		END AS Trip
+	FROM Vehicles, generate_series(0, ndays - 1) d, generate_series(1, 2) dir;
+	ALTER TABLE Trips ADD PRIMARY KEY (TripId);
+	CREATE INDEX Trips_Trip_gist_idx ON Trips USING gist(Trip);
+
+	/* Query parameters */
+	CREATE TABLE QueryPoints AS
+	SELECT i AS Id, berlinmod_random_point() AS Geom
+	FROM generate_series(1, 10) i;
+	CREATE TABLE QueryRegions AS
+	SELECT i AS Id, ST_Buffer(berlinmod_random_point(), 1000 + random() * 4000) AS Geom
+	FROM generate_series(1, 10) i;
+	CREATE TABLE QueryInstants AS
+	SELECT i AS Id, '2007-05-28'::timestamptz +
+		random() * ndays * interval '1 day' AS Instant
+	FROM generate_series(1, 10) i;
+	CREATE TABLE QueryPeriods AS
+	SELECT i AS Id, period(Instant, Instant + random() * interval '2 hours') AS Period
+	FROM QueryInstants i;
+
+	ANALYZE Vehicles;
+	ANALYZE Trips;
+END;
+$$ LANGUAGE 'plpgsql' STRICT;
+
+-------------------------------------------------------------------------------
+-- Query mix
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS bench_berlinmod_queries;
+CREATE TABLE bench_berlinmod_queries(name text, kind text, query text);
+INSERT INTO bench_berlinmod_queries VALUES
+/* Range queries */
+('region_trips', 'range',
+	'SELECT count(*) FROM Trips t, QueryRegions r WHERE r.Id = %s AND '
+	't.Trip && r.Geom AND intersects(t.Trip, r.Geom)'),
+('period_trips', 'range',
+	'SELECT count(*) FROM Trips t, QueryPeriods p WHERE p.Id = %s AND '
+	't.Trip && stbox(p.Period)'),
+('region_period_trips', 'range',
+	'SELECT count(*) FROM Trips t, QueryRegions r, QueryPeriods p '
+	'WHERE r.Id = %1$s AND p.Id = %1$s AND t.Trip && stbox(r.Geom, p.Period) '
+	'AND intersects(atPeriod(t.Trip, p.Period), r.Geom)'),
+('position_at_instant', 'range',
+	'SELECT count(valueAtTimestamp(t.Trip, i.Instant)) FROM Trips t, '
+	'QueryInstants i WHERE i.Id = %s AND t.Trip && stbox(i.Instant)'),
+/* Nearest-neighbour queries */
+('nearest_trips', 'knn',
+	'SELECT t.TripId FROM Trips t, QueryPoints p WHERE p.Id = %s '
+	'ORDER BY t.Trip |=| p.Geom LIMIT 10'),
+/* Aggregate queries */
+('extent', 'aggregate', 'SELECT extent(Trip) FROM Trips WHERE %s = %1$s'),
+('distance_per_vehicle', 'aggregate',
+	'SELECT VehId, sum(length(Trip)) FROM Trips WHERE %s = %1$s '
+	'GROUP BY VehId'),
+('vehicles_in_period', 'aggregate',
+	'SELECT tcount(atPeriod(t.Trip, p.Period)) FROM Trips t, QueryPeriods p '
+	'WHERE p.Id = %s AND t.Trip && stbox(p.Period)'),
+/* Spatiotemporal joins */
+('close_trips', 'join',
+	'SELECT count(*) FROM Trips t1, Trips t2, QueryPeriods p '
+	'WHERE p.Id = %s AND t1.TripId < t2.TripId AND t1.Trip && stbox(p.Period) '
+	'AND t2.Trip && stbox(p.Period) AND t1.Trip && expandSpatial(t2.Trip, 100) '
+	'AND dwithin(atPeriod(t1.Trip, p.Period), atPeriod(t2.Trip, p.Period), 100)');
+
+-------------------------------------------------------------------------------
+-- Driver
+-------------------------------------------------------------------------------
+
+DROP TABLE IF EXISTS bench_berlinmod_runs;
+CREATE TABLE bench_berlinmod_runs(name text, param int, ms float,
+	scale_factor float, run timestamptz DEFAULT now());
+DROP TABLE IF EXISTS bench_berlinmod_plans;
+CREATE TABLE bench_berlinmod_plans(name text, param int, plan text,
+	scale_factor float, run timestamptz DEFAULT now());
+
+CREATE OR REPLACE FUNCTION berlinmod_run(scalefactor float)
+	RETURNS void AS $$
+DECLARE
+	rec record;
+	param int;
+	query text;
+	start timestamptz;
+	plan text;
+	line text;
+BEGIN
+	FOR rec IN SELECT * FROM bench_berlinmod_queries ORDER BY kind, name LOOP
+		FOR param IN 1..10 LOOP
+			query = format(rec.query, param);
+			IF param = 1 THEN
+				plan = '';
+				FOR line IN EXECUTE 'EXPLAIN (ANALYZE, BUFFERS) ' || query LOOP
+					plan = plan || line || E'\n';
+				END LOOP;
+				INSERT INTO bench_berlinmod_plans(name, param, plan, scale_factor)
+				VALUES (rec.name, param, plan, scalefactor);
+			END IF;
+			start = clock_timestamp();
+			EXECUTE query;
+			INSERT INTO bench_berlinmod_runs(name, param, ms, scale_factor)
+			VALUES (rec.name, param,
+				extract(epoch FROM clock_timestamp() - start) * 1000, scalefactor);
+		END LOOP;
+	END LOOP;
+END;
+$$ LANGUAGE 'plpgsql' STRICT;
+
+-------------------------------------------------------------------------------
+
+SELECT berlinmod_generate(berlinmod_scale_factor());
+SELECT berlinmod_run(berlinmod_scale_factor());
+
+DROP TABLE IF EXISTS bench_berlinmod_summary;
+CREATE TABLE bench_berlinmod_summary AS
+SELECT q.kind, r.name, r.scale_factor, count(*) AS runs,
+	percentile_cont(0.5) WITHIN GROUP (ORDER BY ms) AS p50_ms,
+	percentile_cont(0.9) WITHIN GROUP (ORDER BY ms) AS p90_ms,
+	percentile_cont(0.99) WITHIN GROUP (ORDER BY ms) AS p99_ms,
+	max(ms) AS max_ms
+FROM bench_berlinmod_runs r, bench_berlinmod_queries q
+WHERE r.name = q.name
+GROUP BY q.kind, r.name, r.scale_factor;
+
+SELECT kind, name, scale_factor, runs, round(p50_ms::numeric, 3) AS p50_ms,
+	round(p90_ms::numeric, 3) AS p90_ms, round(p99_ms::numeric, 3) AS p99_ms
+FROM bench_berlinmod_summary
+ORDER BY kind, name;
+
+-------------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+/*****************************************************************************
+ *
+ * micro.sql
+ *	  Micro-benchmarks of the core functions of temporal points
+ *
+ * The benchmarks use the functions and the results table defined in the
+ * file test/bench/micro.sql, which must be executed before this one.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+/* Pairs of sequences with an increasing number of instants */
+DROP TABLE IF EXISTS bench_tgeompointseq;
+CREATE TABLE bench_tgeompointseq AS
+SELECT n AS size,
+	tgeompointseq(array_agg(tgeompointinst(
+		ST_MakePoint(i * 10 + random() * 5, random() * 100),
+		'2000-01-01'::timestamptz + i * interval '1 minute') ORDER BY i)) AS seq1,
+	tgeompointseq(array_agg(tgeompointinst(
+		ST_MakePoint(i * 10 + random() * 5, random() * 100),
+		'2000-01-01'::timestamptz + i * interval '1 minute' +
+		interval '30 seconds') ORDER BY i)) AS seq2
+FROM unnest(ARRAY[10, 100, 1000, 10000]) n, generate_series(1, n) i
+GROUP BY n;
+
+-------------------------------------------------------------------------------
+
+/* Temporal dwithin of two sequences */
+SELECT bench_run('tdwithin(tgeompointseq)', size,
+	pg_column_size(seq1) + pg_column_size(seq2),
+	format('SELECT count(tdwithin(seq1, seq2, 20)) FROM bench_tgeompointseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	format('SELECT count(seq1) FROM bench_tgeompointseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	greatest(10, 100000 / size))
+FROM bench_tgeompointseq ORDER BY size;
+
+/* Distance of two sequences */
+SELECT bench_run('tgeompointseq <-> tgeompointseq', size,
+	pg_column_size(seq1) + pg_column_size(seq2),
+	format('SELECT count(seq1 <-> seq2) FROM bench_tgeompointseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	format('SELECT count(seq1) FROM bench_tgeompointseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	greatest(10, 100000 / size))
+FROM bench_tgeompointseq ORDER BY size;
+
+-------------------------------------------------------------------------------
+
+SELECT kernel, size, iterations, round(ns_per_op::numeric, 1) AS ns_per_op,
+	bytes
+FROM bench_micro
+WHERE kernel LIKE '%tgeompoint%'
+ORDER BY kernel, size;
+
+-------------------------------------------------------------------------------
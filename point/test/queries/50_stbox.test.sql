@@ -138,6 +138,20 @@ SELECT stbox_cmp(stbox 'STBOX ZT((1,2,3,2001-01-04), (1,2,3,2001-01-04))', stbox
 
 -------------------------------------------------------------------------------
 
+SELECT zorderKey(stbox 'STBOX((1.0, 2.0), (3.0, 4.0))', stbox 'STBOX((0, 0), (10, 10))');
+SELECT hilbertKey(stbox 'STBOX((1.0, 2.0), (3.0, 4.0))', stbox 'STBOX((0, 0), (10, 10))');
+SELECT zorderKey(stbox 'STBOX Z((1.0, 2.0, 3.0), (3.0, 4.0, 6.0))', stbox 'STBOX((0, 0), (10, 10))');
+SELECT hilbertKey(stbox 'STBOX T((1.0, 2.0, 2001-01-01), (3.0, 4.0, 2001-01-02))', stbox 'STBOX T((0, 0, 2001-01-01), (10, 10, 2001-02-01))');
+SELECT array_agg(k ORDER BY zorderKey(b, stbox 'STBOX((0, 0), (4, 4))')) FROM (VALUES
+(1, stbox 'STBOX((0, 0), (1, 1))'), (2, stbox 'STBOX((0, 3), (1, 4))'),
+(3, stbox 'STBOX((3, 3), (4, 4))'), (4, stbox 'STBOX((3, 0), (4, 1))')) t(k, b);
+SELECT array_agg(k ORDER BY hilbertKey(b, stbox 'STBOX((0, 0), (4, 4))')) FROM (VALUES
+(1, stbox 'STBOX((0, 0), (1, 1))'), (2, stbox 'STBOX((0, 3), (1, 4))'),
+(3, stbox 'STBOX((3, 3), (4, 4))'), (4, stbox 'STBOX((3, 0), (4, 1))')) t(k, b);
+SELECT hilbertKey(stbox 'STBOX((1.0, 2.0), (3.0, 4.0))', stbox 'STBOX T(( , , 2001-01-01), ( , , 2001-01-02))');
+
+-------------------------------------------------------------------------------
+
 SELECT count(*) FROM tbl_stbox t1, tbl_stbox t2 where t1.b = t2.b;
 SELECT count(*) FROM tbl_stbox t1, tbl_stbox t2 where t1.b <> t2.b;
 SELECT count(*) FROM tbl_stbox t1, tbl_stbox t2 where t1.b < t2.b;
@@ -8,6 +8,8 @@ SELECT asText(tgeompoint 'Point(1 1)@2012-01-01 08:00:00');
 SELECT asText(tgeompoint '  Point(2 2)@2012-01-01 08:00:00  ');
 SELECT asText(tgeogpoint 'Point(1 1)@2012-01-01 08:00:00');
 SELECT asText(tgeogpoint '  Point(2 2) @ 2012-01-01 08:00:00  ');
+SELECT asEWKT(tgeompoint 'SRID=5676;Point Z (1 1 1)@2012-01-01 08:00:00');
+SELECT asText(tgeompoint 'point z(1.5 -2 3e2) @ 2012-01-01 08:00:00');
 /* Errors */
 SELECT tgeompoint 'TRUE@2012-01-01 08:00:00';
 SELECT tgeogpoint 'ABC@2012-01-01 08:00:00';
@@ -522,6 +524,13 @@ SELECT asText(appendInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-
 SELECT asText(appendInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', tgeompoint 'Point(3 3 3)@2000-01-03'));
 SELECT asText(appendInstant(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', tgeompoint 'SRID=5676;Point(3 3)@2000-01-03'));
 
+SELECT asText(appendInstants(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', ARRAY[tgeompoint 'Point(3 1)@2000-01-03', tgeompoint 'Point(4 2)@2000-01-04']));
+SELECT asText(appendInstants(tgeogpoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02], [Point(3 3)@2000-01-03]}', ARRAY[tgeogpoint 'Point(4 1)@2000-01-04']));
+/* Errors */
+SELECT asText(appendInstants(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', ARRAY[tgeompoint 'SRID=5676;Point(3 3)@2000-01-03']));
+
+SELECT t, ST_AsText(vals[1]), ST_AsText(vals[2]) FROM tsync(ARRAY[tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-03]', tgeompoint '[Point(1 0)@2000-01-02, Point(1 1)@2000-01-03]']);
+
 -------------------------------------------------------------------------------
 -- Accessor functions
 -------------------------------------------------------------------------------
@@ -543,6 +552,12 @@ SELECT memSize(tgeogpoint 'Point(1.5 1.5)@2000-01-01');
 SELECT memSize(tgeogpoint '{Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03}');
 SELECT memSize(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]');
 SELECT memSize(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}');
+SELECT isCompressed(compress(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'));
+SELECT compress(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}') = tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}';
+SELECT compress(tgeompoint '[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03]') = tgeompoint '[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03]';
+SELECT compress(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]') = tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]';
+SELECT memSize(compress(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]')) < memSize(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]');
+SELECT compress(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}') && stbox 'STBOX T((3, 3, 2000-01-04), (4, 4, 2000-01-06))';
 
 SELECT stbox(tgeompoint 'Point(1 1)@2000-01-01');
 SELECT stbox(tgeogpoint 'Point(1.5 1.5)@2000-01-01');
@@ -957,6 +972,10 @@ SELECT st_astext(valueAtTimestamp(tgeogpoint 'Point(1.5 1.5)@2000-01-01', timest
 SELECT st_astext(valueAtTimestamp(tgeogpoint '{Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03}', timestamptz '2000-01-01'));
 SELECT st_astext(valueAtTimestamp(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]', timestamptz '2000-01-01'));
 SELECT st_astext(valueAtTimestamp(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}', timestamptz '2000-01-01'));
+SET mobilitydb.geodetic_fast_path = on;
+SELECT st_astext(valueAtTimestamp(tgeogpoint '[Point(0 0)@2000-01-01, Point(0 2)@2000-01-03]', timestamptz '2000-01-02'));
+SELECT asText(atValue(tgeogpoint '[Point(0 0)@2000-01-01, Point(0 2)@2000-01-03]', geography 'Point(0 1)'));
+RESET mobilitydb.geodetic_fast_path;
 
 SELECT asText(minusTimestamp(tgeompoint 'Point(1 1)@2000-01-01', timestamptz '2000-01-01'));
 SELECT asText(minusTimestamp(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}', timestamptz '2000-01-01'));
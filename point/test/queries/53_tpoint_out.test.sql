@@ -73,5 +73,19 @@ SELECT asBinary(tgeompoint 'Point(1 1)@2000-01-01');
 SELECT asEWKB(tgeompoint 'SRID=4326;Point(1 1)@2000-01-01');
 SELECT asHexEWKB(tgeompoint 'SRID=4326;Point(1 1)@2000-01-01');
 
+SELECT asText(geom) FROM asMVTGeom(tgeompoint '[Point(0 0)@2000-01-01, Point(10 10)@2000-01-02, Point(20 20)@2000-01-04]', stbox 'STBOX((0,0),(20,20))', 20, 0);
+SELECT times FROM asMVTGeom(tgeompoint '[Point(0 0)@2000-01-01, Point(10 10)@2000-01-02, Point(20 20)@2000-01-04]', stbox 'STBOX((0,0),(20,20))', 20, 0);
+SELECT asText(geom) FROM asMVTGeom(tgeompoint '[Point(0 0)@2000-01-01, Point(0.2 0.1)@2000-01-02, Point(0.1 0.3)@2000-01-03, Point(5 5)@2000-01-04]', stbox 'STBOX((0,0),(10,10))', 10, 0);
+SELECT times FROM asMVTGeom(tgeompoint '[Point(0 0)@2000-01-01, Point(0.2 0.1)@2000-01-02, Point(0.1 0.3)@2000-01-03, Point(5 5)@2000-01-04]', stbox 'STBOX((0,0),(10,10))', 10, 0);
+SELECT geom IS NULL FROM asMVTGeom(tgeompoint '[Point(0 0)@2000-01-01, Point(10 10)@2000-01-02, Point(20 20)@2000-01-04]', stbox 'STBOX((100,100),(110,110))', 10, 0);
+/* Errors */
+SELECT asMVTGeom(tgeompoint '[Point(0 0)@2000-01-01, Point(10 10)@2000-01-02, Point(20 20)@2000-01-04]', stbox 'STBOX((0,0),(20,20))', 0, 0);
+
+SELECT asColumnar(ARRAY[tgeompoint 'Point(1.5 2.5)@2000-01-01']);
+SELECT length(asColumnar(ARRAY[tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02]', tgeompoint '{Point(3 3)@2000-01-03, Point(4 4)@2000-01-04}']));
+SELECT length(asColumnar(ARRAY[tgeogpoint '{[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02],[Point(3 3 3)@2000-01-03]}']));
+/* Errors */
+SELECT asColumnar(ARRAY[tgeompoint 'Point(1 1)@2000-01-01', tgeompoint 'Point(1 1 1)@2000-01-01']);
+
 -------------------------------------------------------------------------------
 
@@ -27,6 +27,8 @@ SELECT asEWKT(setSRID(tgeogpoint 'Point(1.5 1.5 1.5)@2000-01-01', 4269));
 SELECT asEWKT(setSRID(tgeogpoint '{Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03}', 4269));
 SELECT asEWKT(setSRID(tgeogpoint '[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03]', 4269));
 SELECT asEWKT(setSRID(tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}', 4269));
+SELECT asEWKT(setPrecision(setSRID(tgeompoint '{Point(1.123 1.123)@2000-01-01, Point(2.123 2.123)@2000-01-02}', 5676), 1));
+SELECT asEWKT(shift(setPrecision(setSRID(tgeompoint '[Point(1.01 1.01)@2000-01-01, Point(1.02 1.02)@2000-01-02, Point(1.03 1.03)@2000-01-03]', 5676), 1), '1 day'));
 
 SELECT startValue(transform(setSRID(tgeompoint 'Point(1 1 1)@2000-01-01', 5676), 4326)) = st_transform(geometry 'SRID=5676;Point(1 1 1)', 4326);
 SELECT startValue(transform(setSRID(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}', 5676), 4326)) = st_transform(geometry 'SRID=5676;Point(1 1 1)', 4326);
@@ -99,6 +101,13 @@ SELECT ST_AsText(trajectory(tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2
 SELECT ST_AsText(trajectory(tgeompoint '{[Point(1 1)@2001-01-01], [Point(1 1)@2001-02-01], [Point(1 1)@2001-03-01]}'));
 SELECT ST_AsText(trajectory(tgeogpoint '{[Point(1 1)@2001-01-01], [Point(1 1)@2001-02-01], [Point(1 1)@2001-03-01]}'));
 
+-- Trajectory computed on demand
+SET mobilitydb.precompute_trajectory = off;
+SELECT ST_AsText(trajectory(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]'));
+SELECT ST_AsText(trajectory(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'));
+SELECT round(length(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]')::numeric, 6);
+RESET mobilitydb.precompute_trajectory;
+
 --------------------------------------------------------
 
 -- 2D
@@ -114,6 +123,9 @@ SELECT round(length(tgeogpoint '[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-
 SELECT round(length(tgeogpoint '{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}')::numeric, 6);
 SELECT round(length(tgeogpoint 'Interp=Stepwise;[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03]')::numeric, 6);
 SELECT round(length(tgeogpoint 'Interp=Stepwise;{[Point(1.5 1.5)@2000-01-01, Point(2.5 2.5)@2000-01-02, Point(1.5 1.5)@2000-01-03],[Point(3.5 3.5)@2000-01-04, Point(3.5 3.5)@2000-01-05]}')::numeric, 6);
+SET mobilitydb.geodetic_fast_path = on;
+SELECT round(length(tgeogpoint '[Point(0 0)@2000-01-01, Point(0 1)@2000-01-02, Point(1 1)@2000-01-03]')::numeric, 6);
+RESET mobilitydb.geodetic_fast_path;
 -- 3D
 SELECT round(length(tgeompoint 'Point(1 1 1)@2000-01-01')::numeric, 6);
 SELECT round(length(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}')::numeric, 6);
@@ -322,6 +334,23 @@ SELECT asText(minusGeometry(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 1)@2000
 SELECT minusGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Linestring(1 1,2 2)');
 SELECT minusGeometry(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Linestring(1 1 1,2 2 2)');
 
+SELECT asText(atStbox(tgeompoint '[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05]', stbox 'STBOX((1.0, 1.0), (2.0, 2.0))'));
+SELECT asText(atStbox(tgeompoint 'Interp=Stepwise;[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(5 5)@2000-01-03]', stbox 'STBOX((1.0, 1.0), (2.0, 2.0))'));
+SELECT asText(atStbox(tgeompoint '[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05]', stbox 'STBOX T((1.0, 1.0, 2000-01-02), (3.0, 3.0, 2000-01-04))'));
+SELECT asText(minusStbox(tgeompoint '[Point(0 0)@2000-01-01, Point(4 4)@2000-01-05]', stbox 'STBOX((1.0, 1.0), (2.0, 2.0))'));
+
+SELECT asText(piece) FROM tile(tgeompoint '[Point(0.5 0.5)@2000-01-01, Point(2.5 0.5)@2000-01-03]', 1, 1, '1 day');
+SELECT tile_id FROM tile(tgeompoint '[Point(0.5 0.5)@2000-01-01, Point(2.5 0.5)@2000-01-03]', 1, 1, '1 day');
+SELECT asText(piece) FROM tile(tgeompoint 'Interp=Stepwise;[Point(0.5 0.5)@2000-01-01, Point(1.5 0.5)@2000-01-01 12:00]', 1, 1, '1 day');
+SELECT asText(piece) FROM tile(tgeompoint '{Point(0.5 0.5)@2000-01-01, Point(0.7 0.7)@2000-01-01 06:00, Point(1.5 0.5)@2000-01-01 12:00}', 1, 1, '1 day');
+/* Errors */
+SELECT tile(tgeompoint 'Point(1 1)@2000-01-01', 0, 1, '1 day');
+
+SELECT period, ST_AsText(centroid) FROM stops(tgeompoint '[Point(0 0)@2000-01-01 00:00, Point(1 0)@2000-01-01 00:10, Point(0 1)@2000-01-01 00:20, Point(10 10)@2000-01-01 00:30, Point(10 11)@2000-01-01 00:40]', 1, '15 minutes');
+SELECT period, ST_AsText(centroid) FROM stops(tgeompoint '{[Point(0 0)@2000-01-01, Point(0 0)@2000-01-02], [Point(5 5)@2000-01-03, Point(5 5.5)@2000-01-04, Point(9 9)@2000-01-05]}', 1, '1 day');
+/* Errors */
+SELECT stops(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02]', -1, '1 day');
+
 --------------------------------------------------------
 
 SELECT asText(NearestApproachInstant(tgeompoint 'Point(1 1)@2000-01-01', geometry 'Linestring(0 0,3 3)'));
@@ -963,6 +992,15 @@ SELECT asText((tgeogpoint '{Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@20
 SELECT asText((tgeogpoint '[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03]'::geography)::tgeogpoint);
 SELECT asText((tgeogpoint '{[Point(1.5 1.5 1.5)@2000-01-01, Point(2.5 2.5 2.5)@2000-01-02, Point(1.5 1.5 1.5)@2000-01-03],[Point(3.5 3.5 3.5)@2000-01-04, Point(3.5 3.5 3.5)@2000-01-05]}'::geography)::tgeogpoint);
 
+SELECT asText(simplify(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0.1)@2000-01-02, Point(2 0)@2000-01-03]', 0.5));
+SELECT asText(simplify(tgeompoint '[Point(0 0)@2000-01-01, Point(1.9 0)@2000-01-02, Point(2 0)@2000-01-03]', 0.5, 0.5 / 1e5));
+SELECT array_length(simplifyPyramid(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0.5)@2000-01-02, Point(2 0)@2000-01-03, Point(3 3)@2000-01-04, Point(4 0)@2000-01-05]', 0.25, 4), 1);
+SELECT asText(pyramidLevel(simplifyPyramid(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0.5)@2000-01-02, Point(2 0)@2000-01-03, Point(3 3)@2000-01-04, Point(4 0)@2000-01-05]', 0.25, 4), 0.25, 0.1));
+SELECT asText(pyramidLevel(simplifyPyramid(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0.5)@2000-01-02, Point(2 0)@2000-01-03, Point(3 3)@2000-01-04, Point(4 0)@2000-01-05]', 0.25, 4), 0.25, 0.6));
+SELECT asText(pyramidLevel(simplifyPyramid(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0.5)@2000-01-02, Point(2 0)@2000-01-03, Point(3 3)@2000-01-04, Point(4 0)@2000-01-05]', 0.25, 4), 0.25, 100));
+SELECT asText(pyramidLevel(simplifyPyramid(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 0.5)@2000-01-02, Point(2 0)@2000-01-03],[Point(3 3)@2000-01-04, Point(4 0)@2000-01-05]}', 0.25, 2), 0.25, 0.6));
+SELECT simplifyPyramid(tgeompoint '[Point(0 0)@2000-01-01, Point(1 0.5)@2000-01-02, Point(2 0)@2000-01-03, Point(3 3)@2000-01-04, Point(4 0)@2000-01-05]', 0, 4);
+
 -------------------------------------------------------------------------------
 
 /* Errors */
@@ -973,6 +1011,7 @@ SELECT geometry 'MULTIPOINT M (1 1 946767600,1 1 946681200)'::tgeompoint;
 SELECT geometry 'LINESTRING M (1 1 946767600,1 1 946681200)'::tgeompoint;
 SELECT geometry 'GEOMETRYCOLLECTION M (LINESTRING M (1 1 946681200,2 2 946767600),
 POLYGON M((1 1 946681200,1 2 946681200,2 2 946681200,2 1 946681200,1 1 946681200)))'::tgeompoint;
+SELECT simplify(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02]', -1);
 
 -------------------------------------------------------------------------------
 
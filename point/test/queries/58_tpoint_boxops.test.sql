@@ -28,6 +28,9 @@ SELECT tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@200
 SELECT tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]'::stbox;
 SELECT tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}'::stbox;
 
+SELECT unnest(stboxes(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]'));
+SELECT array_length(stboxes(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', 2), 1);
+
 SELECT tgeogpoint 'Point(1 1)@2000-01-01'::stbox;
 SELECT tgeogpoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03}'::stbox;
 SELECT tgeogpoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]'::stbox;
@@ -74,6 +77,13 @@ SELECT expandTemporal(tgeogpoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02,
 SELECT expandTemporal(tgeogpoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]', '1 day');
 SELECT expandTemporal(tgeogpoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', '1 day');
 
+SELECT latLonBox(stbox 'GEODSTBOX((1.0, 0.0, 0.0), (1.0, 0.0, 0.0))');
+SELECT latLonBox(stbox 'GEODSTBOX((0.6, 0.6, 0.5), (0.7, 0.7, 0.55))');
+SELECT latLonBox(stbox 'GEODSTBOX T((-1.0, -0.1, 0.0, 2000-01-01), (-0.9, 0.1, 0.1, 2000-01-02))');
+SELECT latLonBox(stbox 'GEODSTBOX((-0.1, -0.1, 0.9), (0.1, 0.1, 1.0))');
+/* Errors */
+SELECT latLonBox(stbox 'STBOX((1.0, 2.0), (1.0, 2.0))');
+
 -------------------------------------------------------------------------------
 
 SELECT stbox 'STBOX((1.0, 1.0), (2.0, 2.0))' && stbox 'STBOX T((1.0, 2.0, 2000-01-01), (1.0, 2.0, 2000-01-01))';
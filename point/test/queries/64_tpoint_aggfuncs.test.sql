@@ -24,3 +24,15 @@ SELECT asText(tcentroid(temp)) FROM (VALUES
   ('Point(2 2 2)@2000-01-01')) t(temp);
 
 -------------------------------------------------------------------------------
+
+SELECT ST_AsText(cell), bucket, seconds FROM unnest((SELECT tdensity(temp, 10, interval '1 day') FROM (VALUES
+  (tgeompoint '[Point(5 5)@2000-01-01, Point(15 5)@2000-01-02 12:00]')) t(temp)));
+SELECT ST_AsText(cell), bucket, seconds FROM unnest((SELECT tdensity(temp, 1, interval '1 hour', timestamptz '2000-01-01') FROM (VALUES
+  (tgeompoint 'Interp=Stepwise;[Point(0.5 0.5)@2000-01-01 00:30, Point(2.5 0.5)@2000-01-01 02:00]'),
+  (tgeompoint '{[Point(0.5 0.5)@2000-01-01 00:00, Point(0.5 0.5)@2000-01-01 00:30]}')) t(temp)));
+
+/* Errors */
+SELECT tdensity(temp, 0, interval '1 day') FROM (VALUES
+  (tgeompoint '[Point(5 5)@2000-01-01, Point(15 5)@2000-01-02]')) t(temp);
+
+-------------------------------------------------------------------------------
@@ -887,6 +887,13 @@ SELECT intersects(tgeompoint '{Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Poi
 SELECT intersects(tgeompoint '[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03]', tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}');
 SELECT intersects(tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}', tgeompoint '{[Point(1 1)@2000-01-01, Point(2 2)@2000-01-02, Point(1 1)@2000-01-03],[Point(3 3)@2000-01-04, Point(3 3)@2000-01-05]}');
 
+SELECT intersects(tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-02]', tgeompoint '[Point(0 2)@2000-01-01, Point(2 0)@2000-01-02]');
+SELECT intersects(tgeompoint '[Point(0 0)@2000-01-01, Point(2 0)@2000-01-02]', tgeompoint '[Point(0 1)@2000-01-01, Point(2 1)@2000-01-02]');
+SELECT intersects(tgeompoint '[Point(0 0)@2000-01-01, Point(2 0)@2000-01-02]', tgeompoint '[Point(1 0)@2000-01-01, Point(3 0)@2000-01-02]');
+SELECT intersects(tgeompoint '[Point(0 0)@2000-01-01, Point(1 1)@2000-01-02, Point(0 2)@2000-01-03]', tgeompoint '[Point(2 0)@2000-01-01, Point(1 1)@2000-01-02, Point(2 2)@2000-01-03]');
+SELECT intersects(tgeompoint 'Interp=Stepwise;[Point(1 0)@2000-01-01, Point(3 0)@2000-01-02]', tgeompoint '[Point(2 -1)@2000-01-01, Point(2 1)@2000-01-02]');
+SELECT intersects(tgeompoint '{[Point(0 0)@2000-01-01, Point(1 0)@2000-01-02], [Point(5 5)@2000-01-03, Point(6 6)@2000-01-04]}', tgeompoint '[Point(6 5)@2000-01-03, Point(5 6)@2000-01-04]');
+
 SELECT intersects(tgeompoint 'Point(1 1 1)@2000-01-01', tgeompoint 'Point(1 1 1)@2000-01-01');
 SELECT intersects(tgeompoint '{Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03}', tgeompoint 'Point(1 1 1)@2000-01-01');
 SELECT intersects(tgeompoint '[Point(1 1 1)@2000-01-01, Point(2 2 2)@2000-01-02, Point(1 1 1)@2000-01-03]', tgeompoint 'Point(1 1 1)@2000-01-01');
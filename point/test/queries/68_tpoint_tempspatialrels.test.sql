@@ -1101,6 +1101,11 @@ SELECT tdwithin(tgeompoint '[Point(0 0)@2000-01-01, Point(2 2)@2000-01-05]',
 SELECT tdwithin(tgeompoint '[Point(1 0)@2000-01-01, Point(1 4)@2000-01-05]', 
 	tgeompoint 'Interp=Stepwise;[Point(1 2)@2000-01-01, Point(1 3)@2000-01-05]', 1);
 
+SET mobilitydb.geodetic_fast_path = on;
+SELECT tdwithin(tgeogpoint '[Point(0 0)@2000-01-01, Point(0 1)@2000-01-02]', 
+	tgeogpoint '[Point(0 0.001)@2000-01-01, Point(0 1.001)@2000-01-02]', 100);
+RESET mobilitydb.geodetic_fast_path;
+
 /* Errors */
 SELECT tdwithin(geometry 'SRID=5676;Point(1 1)', tgeompoint 'Point(1 1)@2000-01-01', 2);
 SELECT tdwithin(tgeompoint 'Point(1 1)@2000-01-01', geometry 'SRID=5676;Point(1 1)', 2);
@@ -127,6 +127,32 @@ SELECT count(*) FROM tbl_tgeogpoint, tbl_geogpoint
 SELECT count(*) FROM tbl_tgeogpoint t1, tbl_tgeogpoint t2
 	WHERE tdwithin(t1.temp, t2.temp, 10) IS NOT NULL;
 
+WITH pairs AS (
+	SELECT (tdwithinPairs(array_agg(k::bigint ORDER BY k), array_agg(temp ORDER BY k), 10)).*
+	FROM tbl_tgeompoint WHERE temp IS NOT NULL ),
+brute AS (
+	SELECT t1.k::bigint AS id1, t2.k::bigint AS id2,
+		getTime(atValue(tdwithin(t1.temp, t2.temp, 10), true)) AS periods
+	FROM tbl_tgeompoint t1, tbl_tgeompoint t2
+	WHERE t1.k < t2.k AND getTime(atValue(tdwithin(t1.temp, t2.temp, 10), true)) IS NOT NULL )
+SELECT count(*) FROM (
+	(SELECT * FROM pairs EXCEPT SELECT * FROM brute) UNION ALL
+	(SELECT * FROM brute EXCEPT SELECT * FROM pairs) ) t;
+
+SET mobilitydb.max_threads = 4;
+WITH pairs AS (
+	SELECT (tdwithinPairs(array_agg(k::bigint ORDER BY k), array_agg(temp ORDER BY k), 10)).*
+	FROM tbl_tgeompoint WHERE temp IS NOT NULL ),
+brute AS (
+	SELECT t1.k::bigint AS id1, t2.k::bigint AS id2,
+		getTime(atValue(tdwithin(t1.temp, t2.temp, 10), true)) AS periods
+	FROM tbl_tgeompoint t1, tbl_tgeompoint t2
+	WHERE t1.k < t2.k AND getTime(atValue(tdwithin(t1.temp, t2.temp, 10), true)) IS NOT NULL )
+SELECT count(*) FROM (
+	(SELECT * FROM pairs EXCEPT SELECT * FROM brute) UNION ALL
+	(SELECT * FROM brute EXCEPT SELECT * FROM pairs) ) t;
+RESET mobilitydb.max_threads;
+
 -------------------------------------------------------------------------------
 -- trelate (2 arguments returns text)
 -------------------------------------------------------------------------------
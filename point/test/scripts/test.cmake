@@ -19,3 +19,22 @@ foreach(file ${geom_testfiles})
 	set_tests_properties(${TESTNAME} PROPERTIES RESOURCE_LOCK DBLOCK)
 endforeach()
 
+
+if (WITH_BENCHMARK)
+	add_test(
+		NAME bench_micro_tpoint
+		WORKING_DIRECTORY ${PROJECT_SOURCE_DIR}/test
+		COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh run_passfail ${CMAKE_BINARY_DIR} bench_micro_tpoint "../point/test/bench/micro.sql"
+	)
+	set_tests_properties(bench_micro_tpoint PROPERTIES FIXTURES_REQUIRED DB)
+	set_tests_properties(bench_micro_tpoint PROPERTIES RESOURCE_LOCK DBLOCK)
+	set_tests_properties(bench_micro_tpoint PROPERTIES DEPENDS bench_micro)
+
+	add_test(
+		NAME bench_berlinmod
+		WORKING_DIRECTORY ${PROJECT_SOURCE_DIR}/test
+		COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh run_passfail ${CMAKE_BINARY_DIR} bench_berlinmod "../point/test/bench/berlinmod.sql"
+	)
+	set_tests_properties(bench_berlinmod PROPERTIES FIXTURES_REQUIRED DB)
+	set_tests_properties(bench_berlinmod PROPERTIES RESOURCE_LOCK DBLOCK)
+endif ()
@@ -1,10 +1,25 @@
 /*****************************************************************************
  *
- * spgiststat.c
- *		Function belonging to the initial implementation of SP-GiST taken from
- *		https://www.postgresql.org/message-id/29780.1324160816@sss.pgh.pa.us
+ * indexesstat.c
+ *		Diagnostic functions reporting the structure of the GiST and SP-GiST
+ *		indexes of time types and temporal types
  *
- * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse, 
+ * The function spgiststat belongs to the initial implementation of SP-GiST
+ * taken from
+ * https://www.postgresql.org/message-id/29780.1324160816@sss.pgh.pa.us
+ *
+ * The functions gist_index_stats and spgist_index_stats traverse the tree
+ * of an index and report for each level its number of pages and tuples.
+ * For GiST, the level 0 is the root, and the fill ratio of the pages and the
+ * overlap and dead space of the keys in each page are also reported. The
+ * overlap of a page is the sum of the volumes of the pairwise intersections
+ * of its keys divided by the sum of the volumes of its keys. The dead space
+ * of a page is the fraction of the volume of the union of its keys that is
+ * not covered by any key, estimated by inclusion-exclusion up to pairwise
+ * intersections. The volume of a key is the product of the extents of its
+ * dimensions, where the time dimension is expressed in seconds.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  * 		Universite Libre de Bruxelles
  * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -12,13 +27,23 @@
  *****************************************************************************/
 
 #include <postgres.h>
+#include <access/gist_private.h>
 #include <access/hash.h>
 #include <access/heapam.h>
+#include <access/htup_details.h>
+#include <access/spgist_private.h>
 #include <catalog/namespace.h>
+#include <funcapi.h>
 #include <utils/builtins.h>
 #include <utils/rel.h>
 #include <utils/varlena.h>
-// #include <access/spgist_private.h>
+
+#include "temporal.h"
+#include "timetypes.h"
+#include "oidcache.h"
+#ifdef WITH_POSTGIS
+#include "tpoint.h"
+#endif
 
 /* These definitions are taken from <catalog/pg_am.h> */
 #define GIST_AM_OID 783
@@ -27,50 +52,6 @@
 /* This definition is taken from <catalog/pg_class.h> */
 #define		  RELKIND_INDEX			  'i'	/* secondary index */
 
-/* These definition are taken from <access/spgist_private.h> */
-
-/*
- * Contents of page special space on SPGiST index pages
- */
-typedef struct SpGistPageOpaqueData
-{
-	uint16		flags;			/* see bit definitions below */
-	uint16		nRedirection;	/* number of redirection tuples on page */
-	uint16		nPlaceholder;	/* number of placeholder tuples on page */
-	/* note there's no count of either LIVE or DEAD tuples ... */
-	uint16		spgist_page_id; /* for identification of SP-GiST indexes */
-} SpGistPageOpaqueData;
-
-typedef SpGistPageOpaqueData *SpGistPageOpaque;
-
-typedef struct SpGistInnerTupleData
-{
-	unsigned int tupstate:2,	/* LIVE/REDIRECT/DEAD/PLACEHOLDER */
-				allTheSame:1,	/* all nodes in tuple are equivalent */
-				nNodes:13,		/* number of nodes within inner tuple */
-				prefixSize:16;	/* size of prefix, or 0 if none */
-	uint16		size;			/* total size of inner tuple */
-	/* On most machines there will be a couple of wasted bytes here */
-	/* prefix datum follows, then nodes */
-} SpGistInnerTupleData;
-
-typedef SpGistInnerTupleData *SpGistInnerTuple;
-
-/* Flag bits in page special space */
-#define SPGIST_META			(1<<0)
-#define SPGIST_DELETED		(1<<1)	/* never set, but keep for afterwards
-									 * compatibility */
-#define SPGIST_LEAF			(1<<2)
-#define SPGIST_NULLS		(1<<3)
-
-#define SpGistPageGetOpaque(page) ((SpGistPageOpaque) PageGetSpecialPointer(page))
-#define SpGistPageIsMeta(page) (SpGistPageGetOpaque(page)->flags & SPGIST_META)
-#define SpGistPageIsDeleted(page) (SpGistPageGetOpaque(page)->flags & SPGIST_DELETED)
-#define SpGistPageIsLeaf(page) (SpGistPageGetOpaque(page)->flags & SPGIST_LEAF)
-#define SpGistPageStoresNulls(page) (SpGistPageGetOpaque(page)->flags & SPGIST_NULLS)
-
-#define SPGIST_ROOT_BLKNO		 (1)	/* root for normal entries */
-
 #define IS_INDEX(r) ((r)->rd_rel->relkind == RELKIND_INDEX)
 #define IS_GIST(r) ((r)->rd_rel->relam == GIST_AM_OID)
 #define IS_SPGIST(r) ((r)->rd_rel->relam == SPGIST_AM_OID)
@@ -103,7 +84,7 @@ spgiststat(PG_FUNCTION_ARGS)
 				nInnerRedirect = 0;
 
 	relvar = makeRangeVarFromNameList(textToQualifiedNameList(name));
-	index = relation_openrv(relvar, AccessExclusiveLock);
+	index = relation_openrv(relvar, AccessShareLock);
 
 	if (!IS_INDEX(index) || !IS_SPGIST(index))
 		elog(ERROR, "relation \"%s\" is not an SPGiST index",
@@ -173,7 +154,7 @@ spgiststat(PG_FUNCTION_ARGS)
 		UnlockReleaseBuffer(buffer);
 	}
 
-	index_close(index, AccessExclusiveLock);
+	index_close(index, AccessShareLock);
 
 	totalPages--;			   /* discount metapage */
 
@@ -202,4 +183,474 @@ spgiststat(PG_FUNCTION_ARGS)
 			 nLeafRedirect, nInnerRedirect);
 
 	PG_RETURN_TEXT_P(CStringGetTextDatum(res));
-}
\ No newline at end of file
+}
+
+/*****************************************************************************
+ * Generic functions
+ *****************************************************************************/
+
+/* Statistics of a level of an index */
+
+typedef struct
+{
+	int32 pages;
+	int64 tuples;				/* Leaf tuples for SP-GiST */
+	int64 innertuples;			/* Only for SP-GiST */
+	int64 nodes;				/* Only for SP-GiST */
+	int64 allthesame;			/* Only for SP-GiST */
+	double fill;				/* Sum of the fill ratios of the pages */
+	double overlap;				/* Sum of the overlaps of the pages */
+	double deadspace;			/* Sum of the dead spaces of the pages */
+} IndexLevelStats;
+
+typedef struct
+{
+	int count;
+	int pos;
+	IndexLevelStats *levels;
+} IndexStatsState;
+
+static IndexLevelStats *
+index_stats_level(IndexStatsState *state, int level)
+{
+	if (level >= state->count)
+	{
+		int count = level + 1;
+		state->levels = state->levels == NULL ?
+			palloc0(sizeof(IndexLevelStats) * count) :
+			repalloc(state->levels, sizeof(IndexLevelStats) * count);
+		memset(&state->levels[state->count], 0,
+			sizeof(IndexLevelStats) * (count - state->count));
+		state->count = count;
+	}
+	return &state->levels[level];
+}
+
+static Relation
+index_stats_open(Oid relid, Oid amoid, const char *amname)
+{
+	Relation index = index_open(relid, AccessShareLock);
+	if (!IS_INDEX(index) || index->rd_rel->relam != amoid)
+		ereport(ERROR, (errcode(ERRCODE_WRONG_OBJECT_TYPE),
+			errmsg("relation \"%s\" is not a %s index",
+				RelationGetRelationName(index), amname)));
+	return index;
+}
+
+/*****************************************************************************
+ * GiST indexes
+ *****************************************************************************/
+
+/* Key of a GiST index as a box of up to four dimensions */
+
+typedef struct
+{
+	int ndims;
+	double min[4];
+	double max[4];
+} IndexBox;
+
+/* Transform the key of a GiST index into a box */
+
+static void
+index_key_box(IndexBox *box, Datum key, Oid keytype)
+{
+	box->ndims = 0;
+	if (keytype == type_oid(T_PERIOD))
+	{
+		Period *p = DatumGetPeriod(key);
+		box->min[0] = (double) p->lower / USECS_PER_SEC;
+		box->max[0] = (double) p->upper / USECS_PER_SEC;
+		box->ndims = 1;
+	}
+	else if (keytype == type_oid(T_TBOX))
+	{
+		TBOX *tbox = DatumGetTboxP(key);
+		if (MOBDB_FLAGS_GET_X(tbox->flags))
+		{
+			box->min[box->ndims] = tbox->xmin;
+			box->max[box->ndims++] = tbox->xmax;
+		}
+		if (MOBDB_FLAGS_GET_T(tbox->flags))
+		{
+			box->min[box->ndims] = (double) tbox->tmin / USECS_PER_SEC;
+			box->max[box->ndims++] = (double) tbox->tmax / USECS_PER_SEC;
+		}
+	}
+#ifdef WITH_POSTGIS
+	else if (keytype == type_oid(T_STBOX))
+	{
+		STBOX *stbox = DatumGetSTboxP(key);
+		if (MOBDB_FLAGS_GET_X(stbox->flags))
+		{
+			box->min[box->ndims] = stbox->xmin;
+			box->max[box->ndims++] = stbox->xmax;
+			box->min[box->ndims] = stbox->ymin;
+			box->max[box->ndims++] = stbox->ymax;
+			if (MOBDB_FLAGS_GET_Z(stbox->flags) ||
+				MOBDB_FLAGS_GET_GEODETIC(stbox->flags))
+			{
+				box->min[box->ndims] = stbox->zmin;
+				box->max[box->ndims++] = stbox->zmax;
+			}
+		}
+		if (MOBDB_FLAGS_GET_T(stbox->flags))
+		{
+			box->min[box->ndims] = (double) stbox->tmin / USECS_PER_SEC;
+			box->max[box->ndims++] = (double) stbox->tmax / USECS_PER_SEC;
+		}
+	}
+#endif
+	else
+		ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			errmsg("unsupported key type of the GiST index: %s",
+				format_type_be(keytype))));
+}
+
+static double
+index_box_volume(const IndexBox *box)
+{
+	double result = 1.0;
+	for (int i = 0; i < box->ndims; i++)
+		result *= box->max[i] - box->min[i];
+	return result;
+}
+
+static double
+index_box_inter_volume(const IndexBox *box1, const IndexBox *box2)
+{
+	double result = 1.0;
+	for (int i = 0; i < box1->ndims && i < box2->ndims; i++)
+	{
+		double extent = Min(box1->max[i], box2->max[i]) -
+			Max(box1->min[i], box2->min[i]);
+		if (extent <= 0)
+			return 0.0;
+		result *= extent;
+	}
+	return result;
+}
+
+/* Accumulate the overlap and the dead space of the keys of a page */
+
+static void
+gist_page_key_stats(IndexLevelStats *stats, IndexBox *boxes, int count)
+{
+	if (count == 0)
+		return;
+	IndexBox unionbox = boxes[0];
+	double sumvolume = 0.0, sumoverlap = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		for (int k = 0; k < unionbox.ndims; k++)
+		{
+			unionbox.min[k] = Min(unionbox.min[k], boxes[i].min[k]);
+			unionbox.max[k] = Max(unionbox.max[k], boxes[i].max[k]);
+		}
+		sumvolume += index_box_volume(&boxes[i]);
+		for (int j = i + 1; j < count; j++)
+			sumoverlap += index_box_inter_volume(&boxes[i], &boxes[j]);
+	}
+	if (sumvolume > 0)
+		stats->overlap += sumoverlap / sumvolume;
+	double unionvolume = index_box_volume(&unionbox);
+	if (unionvolume > 0)
+		stats->deadspace += Max(0.0,
+			1.0 - (sumvolume - sumoverlap) / unionvolume);
+}
+
+/*
+ * Traverse a GiST index level by level starting from the root and collect
+ * the statistics of each level
+ */
+static IndexStatsState *
+gist_index_stats1(Relation index)
+{
+	IndexStatsState *state = palloc0(sizeof(IndexStatsState));
+	TupleDesc tupdesc = RelationGetDescr(index);
+	Oid keytype = TupleDescAttr(tupdesc, 0)->atttypid;
+	int maxcount = 64, count = 1, level = 0;
+	BlockNumber *blocks = palloc(sizeof(BlockNumber) * maxcount);
+	blocks[0] = GIST_ROOT_BLKNO;
+	IndexBox *boxes = palloc(sizeof(IndexBox) * MaxIndexTuplesPerPage);
+	while (count > 0)
+	{
+		IndexLevelStats *stats = index_stats_level(state, level);
+		int nextmaxcount = 64, nextcount = 0;
+		BlockNumber *nextblocks = palloc(sizeof(BlockNumber) * nextmaxcount);
+		for (int i = 0; i < count; i++)
+		{
+			CHECK_FOR_INTERRUPTS();
+			Buffer buffer = ReadBuffer(index, blocks[i]);
+			LockBuffer(buffer, GIST_SHARE);
+			Page page = BufferGetPage(buffer);
+			if (PageIsNew(page) || GistPageIsDeleted(page))
+			{
+				UnlockReleaseBuffer(buffer);
+				continue;
+			}
+			bool leaf = GistPageIsLeaf(page);
+			int usable = BufferGetPageSize(buffer) - SizeOfPageHeaderData -
+				MAXALIGN(sizeof(GISTPageOpaqueData));
+			stats->pages++;
+			stats->fill += 1.0 - (double) PageGetExactFreeSpace(page) / usable;
+			OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+			int nboxes = 0;
+			for (OffsetNumber off = FirstOffsetNumber; off <= maxoff; off++)
+			{
+				ItemId iid = PageGetItemId(page, off);
+				if (ItemIdIsDead(iid))
+					continue;
+				IndexTuple itup = (IndexTuple) PageGetItem(page, iid);
+				bool isnull;
+				Datum key = index_getattr(itup, 1, tupdesc, &isnull);
+				if (! isnull)
+					index_key_box(&boxes[nboxes++], key, keytype);
+				stats->tuples++;
+				if (! leaf)
+				{
+					if (nextcount == nextmaxcount)
+					{
+						nextmaxcount *= 2;
+						nextblocks = repalloc(nextblocks,
+							sizeof(BlockNumber) * nextmaxcount);
+					}
+					nextblocks[nextcount++] =
+						ItemPointerGetBlockNumber(&(itup->t_tid));
+				}
+			}
+			gist_page_key_stats(stats, boxes, nboxes);
+			UnlockReleaseBuffer(buffer);
+		}
+		pfree(blocks);
+		blocks = nextblocks;
+		count = nextcount;
+		level++;
+	}
+	pfree(blocks); pfree(boxes);
+	return state;
+}
+
+PG_FUNCTION_INFO_V1(gist_index_stats);
+/**
+ * @brief Returns, for each level of a GiST index of a time type or a
+ * 		temporal type, the number of pages and tuples, and the average fill
+ * 		ratio, overlap and dead space of its pages
+ */
+PGDLLEXPORT Datum
+gist_index_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		Relation index = index_stats_open(PG_GETARG_OID(0), GIST_AM_OID,
+			"GiST");
+		funcctx->user_fctx = gist_index_stats1(index);
+		index_close(index, AccessShareLock);
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	IndexStatsState *state = (IndexStatsState *) funcctx->user_fctx;
+	/* Skip the levels without pages, e.g., the last one */
+	while (state->pos < state->count && state->levels[state->pos].pages == 0)
+		state->pos++;
+	if (state->pos == state->count)
+		SRF_RETURN_DONE(funcctx);
+
+	IndexLevelStats *stats = &state->levels[state->pos];
+	Datum values[7];
+	bool nulls[7] = {false, false, false, false, false, false, false};
+	values[0] = Int32GetDatum(state->pos);
+	values[1] = Int32GetDatum(stats->pages);
+	values[2] = Int64GetDatum(stats->tuples);
+	values[3] = Float8GetDatum((double) stats->tuples / stats->pages);
+	values[4] = Float8GetDatum(stats->fill / stats->pages);
+	values[5] = Float8GetDatum(stats->overlap / stats->pages);
+	values[6] = Float8GetDatum(stats->deadspace / stats->pages);
+	state->pos++;
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************
+ * SP-GiST indexes
+ *****************************************************************************/
+
+/* Tuple of an SP-GiST index to visit */
+
+typedef struct
+{
+	BlockNumber blkno;
+	OffsetNumber offnum;
+	int level;
+} SpGistVisit;
+
+/*
+ * Traverse an SP-GiST index starting from the root and collect the number
+ * of inner and leaf tuples of each level. Since several levels of the tree
+ * may be stored in the same page, the number of pages is not reported.
+ */
+static IndexStatsState *
+spgist_index_stats1(Relation index)
+{
+	IndexStatsState *state = palloc0(sizeof(IndexStatsState));
+	int maxcount = 64, count = 0;
+	SpGistVisit *stack = palloc(sizeof(SpGistVisit) * maxcount);
+	stack[count].blkno = SPGIST_ROOT_BLKNO;
+	stack[count].offnum = InvalidOffsetNumber;
+	stack[count++].level = 0;
+	while (count > 0)
+	{
+		CHECK_FOR_INTERRUPTS();
+		SpGistVisit visit = stack[--count];
+		IndexLevelStats *stats = index_stats_level(state, visit.level);
+		Buffer buffer = ReadBuffer(index, visit.blkno);
+		LockBuffer(buffer, BUFFER_LOCK_SHARE);
+		Page page = BufferGetPage(buffer);
+		if (PageIsNew(page) || SpGistPageIsDeleted(page))
+		{
+			UnlockReleaseBuffer(buffer);
+			continue;
+		}
+
+		if (visit.offnum == InvalidOffsetNumber)
+		{
+			/* The root is a leaf page whose tuples are not chained */
+			if (SpGistPageIsLeaf(page))
+			{
+				OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+				for (OffsetNumber off = FirstOffsetNumber; off <= maxoff; off++)
+				{
+					SpGistLeafTuple lt = (SpGistLeafTuple) PageGetItem(page,
+						PageGetItemId(page, off));
+					if (lt->tupstate == SPGIST_LIVE)
+						stats->tuples++;
+				}
+				UnlockReleaseBuffer(buffer);
+				continue;
+			}
+			visit.offnum = FirstOffsetNumber;
+		}
+
+		if (SpGistPageIsLeaf(page))
+		{
+			/* Follow the chain of leaf tuples */
+			OffsetNumber off = visit.offnum;
+			while (off != InvalidOffsetNumber)
+			{
+				SpGistLeafTuple lt = (SpGistLeafTuple) PageGetItem(page,
+					PageGetItemId(page, off));
+				if (lt->tupstate == SPGIST_REDIRECT)
+				{
+					SpGistDeadTuple dt = (SpGistDeadTuple) lt;
+					visit.blkno = ItemPointerGetBlockNumber(&dt->pointer);
+					visit.offnum = ItemPointerGetOffsetNumber(&dt->pointer);
+					stack[count++] = visit;
+					break;
+				}
+				if (lt->tupstate != SPGIST_LIVE)
+					break;
+				stats->tuples++;
+				off = lt->nextOffset;
+			}
+		}
+		else
+		{
+			SpGistInnerTuple it = (SpGistInnerTuple) PageGetItem(page,
+				PageGetItemId(page, visit.offnum));
+			if (it->tupstate == SPGIST_REDIRECT)
+			{
+				SpGistDeadTuple dt = (SpGistDeadTuple) it;
+				visit.blkno = ItemPointerGetBlockNumber(&dt->pointer);
+				visit.offnum = ItemPointerGetOffsetNumber(&dt->pointer);
+				stack[count++] = visit;
+			}
+			else if (it->tupstate == SPGIST_LIVE)
+			{
+				stats->innertuples++;
+				stats->nodes += it->nNodes;
+				if (it->allTheSame)
+					stats->allthesame++;
+				if (count + it->nNodes >= maxcount)
+				{
+					while (count + it->nNodes >= maxcount)
+						maxcount *= 2;
+					stack = repalloc(stack, sizeof(SpGistVisit) * maxcount);
+				}
+				int i;
+				SpGistNodeTuple node;
+				SGITITERATE(it, i, node)
+				{
+					if (! ItemPointerIsValid(&node->t_tid))
+						continue;
+					stack[count].blkno = ItemPointerGetBlockNumber(&node->t_tid);
+					stack[count].offnum = ItemPointerGetOffsetNumber(&node->t_tid);
+					stack[count++].level = visit.level + 1;
+				}
+			}
+		}
+		UnlockReleaseBuffer(buffer);
+	}
+	pfree(stack);
+	return state;
+}
+
+PG_FUNCTION_INFO_V1(spgist_index_stats);
+/**
+ * @brief Returns, for each level of an SP-GiST index of a time type or a
+ * 		temporal type, the number of inner and leaf tuples, the average
+ * 		number of nodes of the inner tuples, and the number of inner tuples
+ * 		whose nodes are all the same
+ */
+PGDLLEXPORT Datum
+spgist_index_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		Relation index = index_stats_open(PG_GETARG_OID(0), SPGIST_AM_OID,
+			"SP-GiST");
+		funcctx->user_fctx = spgist_index_stats1(index);
+		index_close(index, AccessShareLock);
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	IndexStatsState *state = (IndexStatsState *) funcctx->user_fctx;
+	if (state->pos == state->count)
+		SRF_RETURN_DONE(funcctx);
+
+	IndexLevelStats *stats = &state->levels[state->pos];
+	Datum values[5];
+	bool nulls[5] = {false, false, false, false, false};
+	values[0] = Int32GetDatum(state->pos);
+	values[1] = Int64GetDatum(stats->innertuples);
+	values[2] = Int64GetDatum(stats->tuples);
+	if (stats->innertuples > 0)
+		values[3] = Float8GetDatum((double) stats->nodes / stats->innertuples);
+	else
+		nulls[3] = true;
+	values[4] = Int64GetDatum(stats->allthesame);
+	state->pos++;
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*****************************************************************************/
@@ -71,6 +71,21 @@
 #include "temporaltypes.h"
 #include "temporal_util.h"
 
+#ifdef WITH_STATS
+/* Number of instants of a temporal value for the performance counters */
+static int
+temporal_stat_instants(Temporal *temp)
+{
+	if (temp->duration == TEMPORALINST)
+		return 1;
+	if (temp->duration == TEMPORALI)
+		return ((TemporalI *) temp)->count;
+	if (temp->duration == TEMPORALSEQ)
+		return ((TemporalSeq *) temp)->count;
+	return ((TemporalS *) temp)->totalcount;
+}
+#endif
+
 /*****************************************************************************
  * Functions where the argument is a temporal type. 
  * The funcion is applied to the composing instants.
@@ -104,21 +119,19 @@ tfunc1_temporali(TemporalI *ti, Datum (*func)(Datum), Oid valuetypid)
 TemporalSeq *
 tfunc1_temporalseq(TemporalSeq *seq, Datum (*func)(Datum), Oid valuetypid)
 {
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags) && 
+		linear_interpolation(valuetypid);
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, valuetypid, seq->count, linear, true);
 	for (int i = 0; i < seq->count; i++)
 	{
 		TemporalInst *inst = temporalseq_inst_n(seq, i);
-		instants[i] = tfunc1_temporalinst(inst, func, valuetypid);
+		Datum value = func(temporalinst_value(inst));
+		temporalseq_build_append(&builder, value, inst->t);
+		FREE_DATUM(value, valuetypid);
 	}
-	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags) && 
-		linear_interpolation(valuetypid);
-	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, 
-		seq->count, seq->period.lower_inc, seq->period.upper_inc, 
-		linear, true);
-	for (int i = 0; i < seq->count; i++)
-		pfree(instants[i]);
-	pfree(instants);
-	return result;
+	return temporalseq_build_finish(&builder, seq->period.lower_inc, 
+		seq->period.upper_inc);
 }
 
 TemporalS *
@@ -147,6 +160,8 @@ tfunc1_temporals(TemporalS *ts, Datum (*func)(Datum), Oid valuetypid)
 Temporal *
 tfunc1_temporal(Temporal *temp, Datum (*func)(Datum), Oid valuetypid)
 {
+	MOBDB_STAT_INC(STAT_LIFTED_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST)
@@ -197,21 +212,19 @@ TemporalSeq *
 tfunc2_temporalseq(TemporalSeq *seq, Datum param,
     Datum (*func)(Datum, Datum), Oid valuetypid)
 {
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags) && 
+		linear_interpolation(valuetypid);
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, valuetypid, seq->count, linear, true);
 	for (int i = 0; i < seq->count; i++)
 	{
 		TemporalInst *inst = temporalseq_inst_n(seq, i);
-		instants[i] = tfunc2_temporalinst(inst, param, func, valuetypid);
+		Datum value = func(temporalinst_value(inst), param);
+		temporalseq_build_append(&builder, value, inst->t);
+		FREE_DATUM(value, valuetypid);
 	}
-	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags) && 
-		linear_interpolation(valuetypid);
-	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, 
-		seq->count, seq->period.lower_inc, seq->period.upper_inc, 
-		linear, true);
-	for (int i = 0; i < seq->count; i++)
-		pfree(instants[i]);
-	pfree(instants);
-	return result;
+	return temporalseq_build_finish(&builder, seq->period.lower_inc, 
+		seq->period.upper_inc);
 }
 
 TemporalS *
@@ -242,6 +255,8 @@ Temporal *
 tfunc2_temporal(Temporal *temp, Datum param,
     Datum (*func)(Datum, Datum), Oid valuetypid)
 {
+	MOBDB_STAT_INC(STAT_LIFTED_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST)
@@ -299,20 +314,19 @@ TemporalSeq *
 tfunc2_temporalseq_base(TemporalSeq *seq, Datum value, 
 	Datum (*func)(Datum, Datum), Oid valuetypid, bool invert)
 {
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, valuetypid, seq->count, 
+		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
 	for (int i = 0; i < seq->count; i++)
 	{
 		TemporalInst *inst = temporalseq_inst_n(seq, i);
-		instants[i] = tfunc2_temporalinst_base(inst, value, func, 
-			valuetypid, invert);
+		Datum value1 = temporalinst_value(inst);
+		Datum resvalue = invert ? func(value, value1) : func(value1, value);
+		temporalseq_build_append(&builder, resvalue, inst->t);
+		FREE_DATUM(resvalue, valuetypid);
 	}
-	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, 
-		seq->count, seq->period.lower_inc, seq->period.upper_inc, 
-		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
-	for (int i = 0; i < seq->count; i++)
-		pfree(instants[i]);
-	pfree(instants);
-	return result;
+	return temporalseq_build_finish(&builder, seq->period.lower_inc, 
+		seq->period.upper_inc);
 }
 
 TemporalS *
@@ -342,6 +356,8 @@ Temporal *
 tfunc2_temporal_base(Temporal *temp, Datum d, 
 	Datum (*func)(Datum, Datum), Oid valuetypid, bool invert)
 {
+	MOBDB_STAT_INC(STAT_LIFTED_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST)
@@ -476,20 +492,21 @@ tfunc4_temporalseq_base(TemporalSeq *seq, Datum value,
 	Datum (*func)(Datum, Datum, Oid, Oid), Oid datumtypid, 
 	Oid valuetypid, bool invert)
 {
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, valuetypid, seq->count, 
+		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
 	for (int i = 0; i < seq->count; i++)
 	{
 		TemporalInst *inst = temporalseq_inst_n(seq, i);
-		instants[i] = tfunc4_temporalinst_base(inst, value, func, 
-			datumtypid, valuetypid, invert);
+		Datum value1 = temporalinst_value(inst);
+		Datum resvalue = invert ? 
+			func(value, value1, datumtypid, seq->valuetypid) : 
+			func(value1, value, seq->valuetypid, datumtypid);
+		temporalseq_build_append(&builder, resvalue, inst->t);
+		FREE_DATUM(resvalue, valuetypid);
 	}
-	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, 
-		seq->count, seq->period.lower_inc, seq->period.upper_inc, 
-		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
-	for (int i = 0; i < seq->count; i++)
-		pfree(instants[i]);
-	pfree(instants);
-	return result;
+	return temporalseq_build_finish(&builder, seq->period.lower_inc, 
+		seq->period.upper_inc);
 }
 
 TemporalS *
@@ -521,6 +538,8 @@ tfunc4_temporal_base(Temporal *temp, Datum value,
 	Datum (*func)(Datum, Datum, Oid, Oid), Oid datumtypid, 
 	Oid valuetypid, bool inverted)
 {
+	MOBDB_STAT_INC(STAT_LIFTED_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST)
@@ -1235,6 +1254,9 @@ sync_tfunc2_temporal_temporal(Temporal *temp1, Temporal *temp2,
 	Datum (*func)(Datum, Datum), Oid valuetypid, bool linear,
 	bool (*interpoint)(TemporalInst *, TemporalInst *, TemporalInst *, TemporalInst *, TimestampTz *))
 {
+	MOBDB_STAT_INC(STAT_SYNC_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp1) +
+		temporal_stat_instants(temp2));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp1->duration);
 	ensure_valid_duration(temp2->duration);
@@ -1791,6 +1813,9 @@ sync_tfunc3_temporal_temporal(Temporal *temp1, Temporal *temp2,
 	Datum param, Datum (*func)(Datum, Datum, Datum), Oid valuetypid, bool linear,
 	bool (*interpoint)(TemporalInst *, TemporalInst *, TemporalInst *, TemporalInst *, TimestampTz *))
 {
+	MOBDB_STAT_INC(STAT_SYNC_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp1) +
+		temporal_stat_instants(temp2));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp1->duration);
 	ensure_valid_duration(temp2->duration);
@@ -2349,6 +2374,9 @@ sync_tfunc4_temporal_temporal(Temporal *temp1, Temporal *temp2,
 	Datum (*func)(Datum, Datum, Oid, Oid), Oid valuetypid, bool linear,
 	bool (*interpoint)(TemporalInst *, TemporalInst *, TemporalInst *, TemporalInst *, TimestampTz *))
 {
+	MOBDB_STAT_INC(STAT_SYNC_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp1) +
+		temporal_stat_instants(temp2));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp1->duration);
 	ensure_valid_duration(temp2->duration);
@@ -2763,6 +2791,9 @@ Temporal *
 sync_tfunc2_temporal_temporal_cross(Temporal *temp1, Temporal *temp2,
 	Datum (*func)(Datum, Datum), Oid valuetypid)
 {
+	MOBDB_STAT_INC(STAT_SYNC_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp1) +
+		temporal_stat_instants(temp2));
 	Temporal *result = NULL;
 	ensure_valid_duration(temp1->duration);
 	ensure_valid_duration(temp2->duration);
@@ -3171,6 +3202,9 @@ Temporal *
 sync_tfunc3_temporal_temporal_cross(Temporal *temp1, Temporal *temp2,
 	Datum param, Datum (*func)(Datum, Datum, Datum), Oid valuetypid)
 {
+	MOBDB_STAT_INC(STAT_SYNC_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp1) +
+		temporal_stat_instants(temp2));
 
 	Temporal *result = NULL;
 	ensure_valid_duration(temp1->duration);
@@ -3583,6 +3617,9 @@ Temporal *
 sync_tfunc4_temporal_temporal_cross(Temporal *temp1, Temporal *temp2,
 	Datum (*func)(Datum, Datum, Oid, Oid), Oid valuetypid)
 {
+	MOBDB_STAT_INC(STAT_SYNC_CALLS);
+	MOBDB_STAT_ADD(STAT_LIFTED_INSTANTS, temporal_stat_instants(temp1) +
+		temporal_stat_instants(temp2));
 	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
 		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
 	Temporal *result = NULL;
@@ -3657,3 +3694,161 @@ sync_tfunc4_temporal_temporal_cross(Temporal *temp1, Temporal *temp2,
 
 /*****************************************************************************/
 
+/*****************************************************************************
+ * Functions with an arbitrary number of temporal arguments
+ * The arguments are synchronized in a single merge pass and the function is 
+ * applied to the values of all the arguments at each synchronized timestamp.
+ * This avoids constructing the intermediate results of a chain of binary 
+ * lifted functions when evaluating an expression combining several temporal 
+ * values. No crossing or turning point is added between the synchronized
+ * timestamps and thus, for linear interpolation, the function must vary 
+ * linearly between them when its arguments do, as is the case for a linear
+ * combination.
+ *****************************************************************************/
+
+TemporalSeq *
+sync_tfuncn_temporalseq(TemporalSeq **seqs, int count, Datum param,
+	Datum (*func)(Datum *, int, Datum), Oid valuetypid, bool linear)
+{
+	/* Intersection of the periods */
+	TimestampTz lower = seqs[0]->period.lower, upper = seqs[0]->period.upper;
+	bool lower_inc = seqs[0]->period.lower_inc, 
+		upper_inc = seqs[0]->period.upper_inc;
+	int maxcount = seqs[0]->count;
+	for (int i = 1; i < count; i++)
+	{
+		Period *p = &seqs[i]->period;
+		int cmp = timestamp_cmp_internal(p->lower, lower);
+		if (cmp > 0)
+		{
+			lower = p->lower;
+			lower_inc = p->lower_inc;
+		}
+		else if (cmp == 0)
+			lower_inc &= p->lower_inc;
+		cmp = timestamp_cmp_internal(p->upper, upper);
+		if (cmp < 0)
+		{
+			upper = p->upper;
+			upper_inc = p->upper_inc;
+		}
+		else if (cmp == 0)
+			upper_inc &= p->upper_inc;
+		maxcount += seqs[i]->count;
+	}
+	int cmp = timestamp_cmp_internal(lower, upper);
+	if (cmp > 0 || (cmp == 0 && (!lower_inc || !upper_inc)))
+		return NULL;
+
+	/* Segment of each argument containing the current timestamp */
+	int *segs = palloc0(sizeof(int) * count);
+	Datum *values = palloc(sizeof(Datum) * count);
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, valuetypid, maxcount, linear, true);
+	TimestampTz t = lower;
+	while (true)
+	{
+		TimestampTz next = upper;
+		for (int i = 0; i < count; i++)
+		{
+			TemporalSeq *seq = seqs[i];
+			while (segs[i] < seq->count - 1 && timestamp_cmp_internal(
+					temporalseq_inst_n(seq, segs[i] + 1)->t, t) <= 0)
+				segs[i]++;
+			TemporalInst *inst1 = temporalseq_inst_n(seq, segs[i]);
+			if (segs[i] == seq->count - 1)
+				values[i] = temporalinst_value_copy(inst1);
+			else
+			{
+				TemporalInst *inst2 = temporalseq_inst_n(seq, segs[i] + 1);
+				values[i] = temporalseq_value_at_timestamp1(inst1, inst2,
+					MOBDB_FLAGS_GET_LINEAR(seq->flags), t);
+				if (timestamp_cmp_internal(inst2->t, next) < 0)
+					next = inst2->t;
+			}
+		}
+		Datum value = func(values, count, param);
+		temporalseq_build_append(&builder, value, t);
+		FREE_DATUM(value, valuetypid);
+		for (int i = 0; i < count; i++)
+			FREE_DATUM(values[i], seqs[i]->valuetypid);
+		if (timestamp_cmp_internal(t, upper) >= 0)
+			break;
+		t = next;
+	}
+	pfree(segs); pfree(values);
+	return temporalseq_build_finish(&builder, lower_inc, upper_inc);
+}
+
+/*
+ * The arguments are transformed into sequence sets and the sequences of
+ * all of them are traversed simultaneously, advancing at each step the
+ * argument whose current sequence ends first. The result is a sequence set 
+ * or NULL if the arguments do not intersect.
+ */
+TemporalS *
+sync_tfuncn_temporal(Temporal **temps, int count, Datum param,
+	Datum (*func)(Datum *, int, Datum), Oid valuetypid, bool linear)
+{
+	TemporalS **ts = palloc(sizeof(TemporalS *) * count);
+	int totalcount = 0;
+	for (int i = 0; i < count; i++)
+	{
+		Temporal *temp = temps[i];
+		ensure_valid_duration(temp->duration);
+		bool linear1 = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+		if (temp->duration == TEMPORALINST)
+			ts[i] = temporalinst_to_temporals((TemporalInst *)temp, linear1);
+		else if (temp->duration == TEMPORALI)
+			ts[i] = temporali_to_temporals((TemporalI *)temp, linear1);
+		else if (temp->duration == TEMPORALSEQ)
+			ts[i] = temporalseq_to_temporals((TemporalSeq *)temp);
+		else /* temp->duration == TEMPORALS */
+			ts[i] = (TemporalS *)temp;
+		totalcount += ts[i]->count;
+	}
+
+	int *n = palloc0(sizeof(int) * count);
+	TemporalSeq **seqs = palloc(sizeof(TemporalSeq *) * count);
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * totalcount);
+	int k = 0;
+	while (true)
+	{
+		for (int i = 0; i < count; i++)
+			seqs[i] = temporals_seq_n(ts[i], n[i]);
+		TemporalSeq *seq = sync_tfuncn_temporalseq(seqs, count, param, func,
+			valuetypid, linear);
+		if (seq != NULL)
+			sequences[k++] = seq;
+		/* Advance the argument whose current sequence ends first */
+		int j = 0;
+		for (int i = 1; i < count; i++)
+		{
+			int cmp = timestamp_cmp_internal(seqs[i]->period.upper, 
+				seqs[j]->period.upper);
+			if (cmp < 0 || (cmp == 0 && !seqs[i]->period.upper_inc && 
+					seqs[j]->period.upper_inc))
+				j = i;
+		}
+		if (++n[j] == ts[j]->count)
+			break;
+	}
+
+	for (int i = 0; i < count; i++)
+		if (ts[i] != (TemporalS *)temps[i])
+			pfree(ts[i]);
+	pfree(ts); pfree(n); pfree(seqs);
+	if (k == 0)
+	{
+		pfree(sequences);
+		return NULL;
+	}
+	TemporalS *result = temporals_from_temporalseqarr(sequences, k,
+		linear, true);
+	for (int i = 0; i < k; i++)
+		pfree(sequences[i]);
+	pfree(sequences);
+	return result;
+}
+
+/*****************************************************************************/
@@ -15,7 +15,9 @@
 #include <access/heapam.h>
 #include <access/htup_details.h>
 #include <catalog/namespace.h>
+#include <utils/inval.h>
 #include <utils/rel.h>
+#include <utils/syscache.h>
 
 #include "temporaltypes.h"
 
@@ -95,21 +97,29 @@ const char *_op_names[] =
  * Functions for the Oid cache
  *****************************************************************************/
 
-/* Global variables */
+/* Global variables 
+ * The type Oids are needed by almost every function while the operator Oids
+ * are only needed by the selectivity functions. The two caches are thus
+ * populated independently so that the first query in a backend does not pay
+ * for reading the operator cache from the catalog unless it needs it. */
 
-bool _ready = false;
+bool _type_ready = false;
+bool _op_ready = false;
 Oid _type_oids[sizeof(_type_names) / sizeof(char *)];
 Oid _op_oids[sizeof(_op_names) / sizeof(char *)]
 	[sizeof(_type_names) / sizeof(char *)]
 	[sizeof(_type_names) / sizeof(char *)];
 
+static void populate_types_cache(void);
+static void populate_opers_cache(void);
+
 /* Fetch in the cache the oid of a type */
 
 Oid 
 type_oid(CachedType t) 
 {
-	if (!_ready)
-		populate_oidcache();
+	if (!_type_ready)
+		populate_types_cache();
 	return _type_oids[t];
 }
 
@@ -118,11 +128,33 @@ type_oid(CachedType t)
 Oid 
 oper_oid(CachedOp op, CachedType lt, CachedType rt)
 {
-	if (!_ready)
-		populate_oidcache();
+	if (!_op_ready)
+		populate_opers_cache();
 	return _op_oids[op][lt][rt];
 }
 
+/* Invalidate the cache when the catalog entries of types or operators 
+ * change, e.g., when the extension is dropped, recreated, or updated */
+
+static void
+invalidate_oidcache(Datum arg, int cacheid, uint32 hashvalue)
+{
+	if (cacheid == TYPEOID)
+		_type_ready = false;
+	_op_ready = false;
+}
+
+static void
+register_oidcache_callbacks(void)
+{
+	static bool registered = false;
+	if (registered)
+		return;
+	CacheRegisterSyscacheCallback(TYPEOID, invalidate_oidcache, (Datum) 0);
+	CacheRegisterSyscacheCallback(OPEROID, invalidate_oidcache, (Datum) 0);
+	registered = true;
+}
+
 /* Populate the oid cache */
 
 static void 
@@ -138,8 +170,37 @@ populate_types()
 	}
 }
 
-void 
-populate_oidcache() 
+static void 
+populate_opers(void)
+{
+	bzero(_op_oids, sizeof(_op_oids));
+	/*
+	 * This fetches the pre-computed operator cache from the catalog where
+	 * it is stored in a table. See the fill_opcache function below.
+	 */
+	Oid catalog = RelnameGetRelid("pg_temporal_opcache");
+	Relation rel = heap_open(catalog, AccessShareLock);
+	TupleDesc tupDesc = rel->rd_att;
+	ScanKeyData scandata;
+	HeapScanDesc scan = heap_beginscan_catalog(rel, 0, &scandata);
+	HeapTuple tuple = heap_getnext(scan, ForwardScanDirection);
+	while (HeapTupleIsValid(tuple))
+	{
+		bool isnull = false;
+		int32 i = DatumGetInt32(heap_getattr(tuple, 1, tupDesc, &isnull));
+		int32 j = DatumGetInt32(heap_getattr(tuple, 2, tupDesc, &isnull));
+		int32 k = DatumGetInt32(heap_getattr(tuple, 3, tupDesc, &isnull));
+		_op_oids[i][j][k] = DatumGetObjectId(heap_getattr(tuple, 4, tupDesc, &isnull));
+		tuple = heap_getnext(scan, ForwardScanDirection);
+	}
+	heap_endscan(scan);
+	heap_close(rel, AccessShareLock);
+}
+
+/* Run the function with the public schema in the search path */
+
+static void 
+populate_with_search_path(void (*func)(void)) 
 {
 	Oid namespaceId = LookupNamespaceNoError("public") ;
 	OverrideSearchPath* overridePath = GetOverrideSearchPath(CurrentMemoryContext);
@@ -148,33 +209,7 @@ populate_oidcache()
 
 	PG_TRY();
 	{
-
-		populate_types();
-		bzero(_op_oids, sizeof(_op_oids));
-
-		/*
-		 * This fetches the pre-computed operator cache from the catalog where
-		 * it is stored in a table. See the fill_opcache function below.
-		 */
-		Oid catalog = RelnameGetRelid("pg_temporal_opcache");
-		Relation rel = heap_open(catalog, AccessShareLock);
-		TupleDesc tupDesc = rel->rd_att;
-		ScanKeyData scandata;
-		HeapScanDesc scan = heap_beginscan_catalog(rel, 0, &scandata);
-		HeapTuple tuple = heap_getnext(scan, ForwardScanDirection);
-		while (HeapTupleIsValid(tuple))
-		{
-			bool isnull = false;
-			int32 i = DatumGetInt32(heap_getattr(tuple, 1, tupDesc, &isnull));
-			int32 j = DatumGetInt32(heap_getattr(tuple, 2, tupDesc, &isnull));
-			int32 k = DatumGetInt32(heap_getattr(tuple, 3, tupDesc, &isnull));
-			_op_oids[i][j][k] = DatumGetObjectId(heap_getattr(tuple, 4, tupDesc, &isnull));
-			tuple = heap_getnext(scan, ForwardScanDirection);
-		}
-		heap_endscan(scan);
-		heap_close(rel, AccessShareLock);
-		_ready = true;
-
+		func();
 		PopOverrideSearchPath() ;
 	}
 	PG_CATCH();
@@ -185,6 +220,31 @@ populate_oidcache()
 	PG_END_TRY();
 }
 
+static void 
+populate_types_cache(void) 
+{
+	register_oidcache_callbacks();
+	populate_with_search_path(&populate_types);
+	_type_ready = true;
+}
+
+static void 
+populate_opers_cache(void) 
+{
+	register_oidcache_callbacks();
+	populate_with_search_path(&populate_opers);
+	_op_ready = true;
+}
+
+void 
+populate_oidcache() 
+{
+	if (!_type_ready)
+		populate_types_cache();
+	if (!_op_ready)
+		populate_opers_cache();
+}
+
 /*
  * This function is run during the CREATE EXTENSION to pre-compute the 
  * opcache and store it as a table in the catalog.
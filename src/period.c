@@ -237,6 +237,23 @@ period_to_secs(TimestampTz v1, TimestampTz v2)
 	return result;
 }
 
+/*
+ * Returns true if two consecutive periods of an ordered and non-overlapping
+ * array are adjacent, which is the only case in which the normalization 
+ * of the array merges periods.
+ */
+bool
+periodarr_has_adjacent(Period **periods, int count)
+{
+	for (int i = 1; i < count; i++)
+	{
+		if (timestamp_cmp_internal(periods[i - 1]->upper, periods[i]->lower) == 0 &&
+			(periods[i - 1]->upper_inc || periods[i]->lower_inc))
+			return true;
+	}
+	return false;
+}
+
 /*
  * Normalize an array of periods
  * The input periods may overlap and may be non contiguous.
@@ -245,7 +262,15 @@ period_to_secs(TimestampTz v1, TimestampTz v2)
 Period **
 periodarr_normalize(Period **periods, int count, int *newcount)
 {
-	periodarr_sort(periods, count);
+	/* Sort the periods only if they are not already ordered */
+	for (int i = 1; i < count; i++)
+	{
+		if (period_cmp_internal(periods[i - 1], periods[i]) > 0)
+		{
+			periodarr_sort(periods, count);
+			break;
+		}
+	}
 	int count1 = 0;
 	Period **result = palloc(sizeof(Period *) * count);
 	Period *current = periods[0];
@@ -337,6 +362,27 @@ period_super_union(Period *p1, Period *p2)
 	return period_make(result_lower, result_upper, 
 		result_lower_inc, result_upper_inc);
 }
+
+/*
+ * Expand the first period with the second one, that is, set the first 
+ * period to the smallest period that contains both of them
+ */
+void
+period_expand(Period *p1, const Period *p2)
+{
+	if (period_cmp_bounds(p1->lower, p2->lower, true, true, 
+		p1->lower_inc, p2->lower_inc) > 0)
+	{
+		p1->lower = p2->lower;
+		p1->lower_inc = p2->lower_inc;
+	}
+	if (period_cmp_bounds(p1->upper, p2->upper, false, false, 
+		p1->upper_inc, p2->upper_inc) < 0)
+	{
+		p1->upper = p2->upper;
+		p1->upper_inc = p2->upper_inc;
+	}
+}
  
 /*****************************************************************************
  * Input/output functions
@@ -705,6 +751,29 @@ period_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(period_cmp_internal(p1, p2));	
 }
 
+static int
+period_sortsupport_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	return period_cmp_internal(DatumGetPeriod(x), DatumGetPeriod(y));
+}
+
+/* The abbreviated key of a period is its lower bound */
+static uint64
+period_sortkey(Datum d)
+{
+	return timestamp_sortkey(DatumGetPeriod(d)->lower);
+}
+
+PG_FUNCTION_INFO_V1(period_sortsupport);
+
+PGDLLEXPORT Datum
+period_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+	sortsupport_abbrev_init(ssup, &period_sortsupport_cmp, &period_sortkey);
+	PG_RETURN_VOID();
+}
+
 /* inequality operators using the period_cmp function */
 bool
 period_lt_internal(Period *p1, Period *p2)
@@ -30,32 +30,38 @@
 /* 
  * The memory structure of a PeriodSet with, e.g., 3 periods is as follows
  *
- *  --------------------------------------------------------------------
- *	( PeriodSet | offset_0 | offset_1 | offset_2 | offset_3 | )_X | ...
  *	--------------------------------------------------------------------
+ *	( PeriodSet )_X | ( Period_0 )_X | ( Period_1 )_X | ( Period_2 )_X | ...
  *	--------------------------------------------------------------------
- *	(( Period_0 )_Y | ( Period_1 )_Y | ( Period_2 )_Y | ( bbox )_Y )_X |
- *	--------------------------------------------------------------------
+ *	----------------
+ *	( bbox )_X |
+ *	----------------
+ *
+ * where the X are unused bytes added for double padding. Since all the
+ * periods have the same size they are stored contiguously without an array
+ * of offsets.
  *
- * where the X are unused bytes added for double padding, the Y are unused bytes 
- * added for int4 padding, offset_0 to offset_2 are offsets for the corresponding 
- * periods, and offset_3 is the offset for the bounding box which is a Period.
+ * The values written by previous versions of the extension have an array of
+ * count + 1 offsets between the header and the periods. These offsets are
+ * always equal to the position of the periods in the array and thus the
+ * only difference between both layouts is the position of the first period,
+ * which is found from the size of the value.
  */
- 
-/* Pointer to array of offsets of the PeriodSet */
 
-static size_t *
-periodset_offsets_ptr(PeriodSet *ps)
-{
-	return (size_t *) (((char *)ps) + sizeof(PeriodSet));
-}
+/* Size of a PeriodSet with the given number of periods */
+
+#define PERIODSET_SIZE(count) \
+	(double_pad(sizeof(PeriodSet)) + double_pad(sizeof(Period)) * ((count) + 1))
 
 /* Pointer to the first period */
 
 static char * 
 periodset_data_ptr(PeriodSet *ps)
 {
-	return (char *)ps + double_pad(sizeof(PeriodSet) + 
+	if (VARSIZE(ps) == PERIODSET_SIZE(ps->count))
+		return ((char *) ps) + double_pad(sizeof(PeriodSet));
+	/* Layout with an array of offsets */
+	return ((char *) ps) + double_pad(sizeof(PeriodSet) +
 		sizeof(size_t) * (ps->count + 1));
 }
 
@@ -64,8 +70,8 @@ periodset_data_ptr(PeriodSet *ps)
 Period *
 periodset_per_n(PeriodSet *ps, int index)
 {
-	size_t *offsets = periodset_offsets_ptr(ps);
-	return (Period *) (periodset_data_ptr(ps) + offsets[index]);
+	return (Period *) (periodset_data_ptr(ps) +
+		double_pad(sizeof(Period)) * index);
 }
 
 /* Bounding box of a PeriodSet */
@@ -73,9 +79,7 @@ periodset_per_n(PeriodSet *ps, int index)
 Period *
 periodset_bbox(PeriodSet *ps) 
 {
-	size_t *offsets = periodset_offsets_ptr(ps);
-	assert(offsets[ps->count] != 0);
-	return (Period *)(periodset_data_ptr(ps) + offsets[ps->count]);
+	return periodset_per_n(ps, ps->count);
 }
 
 /* Construct a PeriodSet from an array of Period */
@@ -83,7 +87,6 @@ periodset_bbox(PeriodSet *ps)
 PeriodSet *
 periodset_from_periodarr_internal(Period **periods, int count, bool normalize)
 {
-	Period bbox;
 	/* Test the validity of the periods */
 	for (int i = 0; i < count - 1; i++)
 	{
@@ -94,33 +97,27 @@ periodset_from_periodarr_internal(Period **periods, int count, bool normalize)
 				errmsg("Invalid value for period set")));
 	}
 
+	/* The periods are ordered and do not overlap, they only need to be
+	 * normalized if two consecutive ones are adjacent */
+	bool normalized = normalize && count > 1 &&
+		periodarr_has_adjacent(periods, count);
 	Period **newperiods = periods;
 	int newcount = count;
-	if (normalize && count > 1)
+	if (normalized)
 		newperiods = periodarr_normalize(periods, count, &newcount);
-	size_t memsize = double_pad(sizeof(Period)) * (newcount + 1);
-	/* Array of pointers containing the pointers to the component Period,
-	   and a pointer to the bbox */
-	size_t pdata = double_pad(sizeof(PeriodSet) + (newcount + 1) * sizeof(size_t));
-	PeriodSet *result = palloc0(pdata + memsize);
-	SET_VARSIZE(result, pdata + memsize);
+	PeriodSet *result = palloc0(PERIODSET_SIZE(newcount));
+	SET_VARSIZE(result, PERIODSET_SIZE(newcount));
 	result->count = newcount;
-
-	size_t *offsets = periodset_offsets_ptr(result);
-	size_t pos = 0;	
+	char *data = periodset_data_ptr(result);
 	for (int i = 0; i < newcount; i++)
-	{
-		memcpy(((char *) result) + pdata + pos, newperiods[i], sizeof(Period));
-		offsets[i] = pos;
-		pos += double_pad(sizeof(Period));
-	}
+		memcpy(data + double_pad(sizeof(Period)) * i, newperiods[i],
+			sizeof(Period));
 	/* Precompute the bounding box */
-	period_set(&bbox, newperiods[0]->lower, newperiods[newcount - 1]->upper,
-		newperiods[0]->lower_inc, newperiods[newcount - 1]->upper_inc);
-	offsets[newcount] = pos;
-	memcpy(((char *) result) + pdata + pos, &bbox, sizeof(Period));
+	period_set(periodset_bbox(result), newperiods[0]->lower,
+		newperiods[newcount - 1]->upper, newperiods[0]->lower_inc,
+		newperiods[newcount - 1]->upper_inc);
 	/* Normalize */
-	if (normalize && count > 1)
+	if (normalized)
 	{
 		for (int i = 0; i < newcount; i++)
 			pfree(newperiods[i]);
@@ -137,6 +134,81 @@ periodset_copy(PeriodSet *ps)
 	return result;
 }
 
+/*
+ * Construction of a PeriodSet from periods given in increasing order of
+ * their lower bound, as produced by the set operations. The result is
+ * allocated once for the maximum number of periods and the periods are
+ * written directly into it, merging each new period with the last one when
+ * they overlap or are adjacent. Empty periods are skipped.
+ */
+
+void
+periodset_build_init(PeriodSetBuilder *builder, int maxcount)
+{
+	builder->ps = palloc0(PERIODSET_SIZE(maxcount));
+	builder->data = ((char *) builder->ps) + double_pad(sizeof(PeriodSet));
+	builder->maxcount = maxcount;
+	builder->count = 0;
+}
+
+void
+periodset_build_append(PeriodSetBuilder *builder, TimestampTz lower,
+	TimestampTz upper, bool lower_inc, bool upper_inc)
+{
+	int cmp = timestamp_cmp_internal(lower, upper);
+	if (cmp > 0 || (cmp == 0 && (! lower_inc || ! upper_inc)))
+		return;
+
+	if (builder->count > 0)
+	{
+		Period *last = (Period *) (builder->data +
+			double_pad(sizeof(Period)) * (builder->count - 1));
+		cmp = timestamp_cmp_internal(lower, last->upper);
+		if (cmp < 0 || (cmp == 0 && (lower_inc || last->upper_inc)))
+		{
+			cmp = timestamp_cmp_internal(upper, last->upper);
+			if (cmp > 0 || (cmp == 0 && upper_inc))
+			{
+				last->upper = upper;
+				last->upper_inc = upper_inc;
+			}
+			return;
+		}
+	}
+
+	assert(builder->count < builder->maxcount);
+	Period *p = (Period *) (builder->data +
+		double_pad(sizeof(Period)) * builder->count);
+	period_set(p, lower, upper, lower_inc, upper_inc);
+	builder->count++;
+}
+
+/*
+ * Finish the construction of the PeriodSet. The periods are already at
+ * their place and only the bounding box is added after them. Returns NULL
+ * if no period was appended.
+ */
+PeriodSet *
+periodset_build_finish(PeriodSetBuilder *builder)
+{
+	PeriodSet *result = builder->ps;
+	int count = builder->count;
+	if (count == 0)
+	{
+		pfree(result);
+		return NULL;
+	}
+
+	SET_VARSIZE(result, PERIODSET_SIZE(count));
+	result->count = count;
+	/* Precompute the bounding box */
+	Period *first = periodset_per_n(result, 0);
+	Period *last = periodset_per_n(result, count - 1);
+	period_set(periodset_bbox(result), first->lower, last->upper,
+		first->lower_inc, last->upper_inc);
+	return result;
+}
+
 /*
  * Binary search of a timestamptz in a periodset.
  * If the timestamp is found, the position of the period is returned in pos.
@@ -149,19 +221,21 @@ periodset_copy(PeriodSet *ps)
  * 2)				 t^ 							=> result = 1
  * 3)							 t^ 				=> result = 2
  * 4)										  t^	=> result = 3
+ *
+ * As for timestamp sets, the binary search stops when at most
+ * TIME_SEARCH_BLOCK periods remain, which are then scanned without branches.
  */
 
 bool 
 periodset_find_timestamp(PeriodSet *ps, TimestampTz t, int *pos) 
 {
+	char *data = periodset_data_ptr(ps);
 	int first = 0;
 	int last = ps->count - 1;
-	int middle = 0; /* make compiler quiet */
-	Period *p = NULL; /* make compiler quiet */
-	while (first <= last) 
+	while (last - first >= TIME_SEARCH_BLOCK) 
 	{
-		middle = (first + last)/2;
-		p = periodset_per_n(ps, middle);
+		int middle = (first + last)/2;
+		Period *p = (Period *) (data + double_pad(sizeof(Period)) * middle);
 		if (contains_period_timestamp_internal(p, t))
 		{
 			*pos = middle;
@@ -172,10 +246,17 @@ periodset_find_timestamp(PeriodSet *ps, TimestampTz t, int *pos)
 		else
 			first = middle + 1;
 	}
-	if (timestamp_cmp_internal(t, p->upper) >= 0)
-		middle++;
-	*pos = middle;
-	return false;
+	/* Count the periods of the block that are before the timestamp */
+	int before = 0;
+	for (int i = first; i <= last; i++)
+	{
+		Period *p = (Period *) (data + double_pad(sizeof(Period)) * i);
+		before += (p->upper < t) | ((p->upper == t) & ! p->upper_inc);
+	}
+	*pos = first + before;
+	return (*pos <= last &&
+		contains_period_timestamp_internal(
+			(Period *) (data + double_pad(sizeof(Period)) * *pos), t));
 }
 
 /*****************************************************************************
@@ -150,6 +150,10 @@ CREATE FUNCTION period_cmp(period, period)
 	RETURNS int4
 	AS 'MODULE_PATHNAME', 'period_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION period_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'period_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR = (
 	PROCEDURE = period_eq,
@@ -195,7 +199,8 @@ CREATE OPERATOR CLASS period_ops
 	OPERATOR	3	= ,
 	OPERATOR	4	>= ,
 	OPERATOR	5	> ,
-	FUNCTION	1	period_cmp(period, period);
+	FUNCTION	1	period_cmp(period, period),
+	FUNCTION	2	period_sortsupport(internal);
 
 /******************************************************************************/
 
@@ -1460,4 +1460,126 @@ CREATE OPERATOR * (
 	COMMUTATOR = *
 );
 
+/*****************************************************************************
+ * Distance
+ *****************************************************************************/
+
+CREATE FUNCTION temporal_distance(timestamptz, timestampset)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestamp_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestamptz, period)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestamp_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestamptz, periodset)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestamp_periodset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestamptz, RIGHTARG = timestampset,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestamptz, RIGHTARG = period,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestamptz, RIGHTARG = periodset,
+	COMMUTATOR = <->
+);
+
+CREATE FUNCTION temporal_distance(timestampset, timestamptz)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestampset_timestamp'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(timestampset, period)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestampset_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestampset, RIGHTARG = timestamptz,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestampset, RIGHTARG = period,
+	COMMUTATOR = <->
+);
+
+CREATE FUNCTION temporal_distance(period, timestamptz)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_period_timestamp'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, timestampset)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_period_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, period)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_period_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, periodset)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_period_periodset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = period, RIGHTARG = timestamptz,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = period, RIGHTARG = timestampset,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = period, RIGHTARG = period,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = period, RIGHTARG = periodset,
+	COMMUTATOR = <->
+);
+
+CREATE FUNCTION temporal_distance(periodset, timestamptz)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_periodset_timestamp'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(periodset, period)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_periodset_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = periodset, RIGHTARG = timestamptz,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = periodset, RIGHTARG = period,
+	COMMUTATOR = <->
+);
+
+/*****************************************************************************
+ * Overlapping pairs of two arrays of periods
+ *****************************************************************************/
+
+CREATE FUNCTION overlapsPairs(ids1 bigint[], periods1 period[],
+		ids2 bigint[], periods2 period[], OUT id1 bigint, OUT id2 bigint)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'overlaps_pairs'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+	COST 1000;
+
 /*****************************************************************************/
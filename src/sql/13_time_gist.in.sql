@@ -38,6 +38,10 @@ CREATE FUNCTION gist_period_fetch(internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION gist_timestampset_distance(internal, timestampset, smallint, oid, internal)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'gist_timeset_distance'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR CLASS gist_timestampset_ops
 	DEFAULT FOR TYPE timestampset USING gist AS
@@ -73,13 +77,17 @@ CREATE OPERATOR CLASS gist_timestampset_ops
 	OPERATOR	31		#&> (timestampset, timestampset),
 	OPERATOR	31		#&> (timestampset, period),
 	OPERATOR	31		#&> (timestampset, periodset),
+	-- distance
+	OPERATOR	25		<-> (timestampset, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+	OPERATOR	25		<-> (timestampset, period) FOR ORDER BY pg_catalog.float_ops,
 	-- functions
 	FUNCTION	1	gist_timestampset_consistent(internal, timestampset, smallint, oid, internal),
 	FUNCTION	2	gist_period_union(internal, internal),
 	FUNCTION	3	gist_timestampset_compress(internal),
 	FUNCTION	5	gist_period_penalty(internal, internal, internal),
 	FUNCTION	6	gist_period_picksplit(internal, internal),
-	FUNCTION	7	gist_period_same(period, period, internal);
+	FUNCTION	7	gist_period_same(period, period, internal),
+	FUNCTION	8	gist_timestampset_distance(internal, timestampset, smallint, oid, internal);
 	
 /******************************************************************************/
 
@@ -91,6 +99,10 @@ CREATE FUNCTION gist_period_compress(internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'gist_period_compress'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_period_distance(internal, period, smallint, oid, internal)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'gist_period_distance'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR CLASS gist_period_ops
 	DEFAULT FOR TYPE period USING gist AS
@@ -127,6 +139,9 @@ CREATE OPERATOR CLASS gist_period_ops
 	OPERATOR	31		#&> (period, timestampset),
 	OPERATOR	31		#&> (period, period),
 	OPERATOR	31		#&> (period, periodset),
+	-- distance
+	OPERATOR	25		<-> (period, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+	OPERATOR	25		<-> (period, period) FOR ORDER BY pg_catalog.float_ops,
 	-- functions
 	FUNCTION	1	gist_period_consistent(internal, period, smallint, oid, internal),
 	FUNCTION	2	gist_period_union(internal, internal),
@@ -134,22 +149,43 @@ CREATE OPERATOR CLASS gist_period_ops
 	FUNCTION	5	gist_period_penalty(internal, internal, internal),
 	FUNCTION	6	gist_period_picksplit(internal, internal),
 	FUNCTION	7	gist_period_same(period, period, internal),
+	FUNCTION	8	gist_period_distance(internal, period, smallint, oid, internal),
 	FUNCTION	9	gist_period_fetch(internal);
 	
 /******************************************************************************/
 
 CREATE FUNCTION gist_periodset_consistent(internal, periodset, smallint, oid, internal)
 	RETURNS bool
-	AS 'MODULE_PATHNAME', 'gist_period_consistent'
+	AS 'MODULE_PATHNAME', 'gist_periodset_consistent'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_periodset_union(internal, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
 CREATE FUNCTION gist_periodset_compress(internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'gist_periodset_compress'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_periodset_penalty(internal, internal, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION gist_periodset_picksplit(internal, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION gist_periodset_same(periodset, periodset, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+CREATE FUNCTION gist_periodset_distance(internal, periodset, smallint, oid, internal)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'gist_periodset_distance'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR CLASS gist_periodset_ops
 	DEFAULT FOR TYPE periodset USING gist AS
-	STORAGE period,
+	STORAGE periodset,
 	-- overlaps
 	OPERATOR	3		&& (periodset, timestampset),
 	OPERATOR	3		&& (periodset, period),
@@ -182,12 +218,16 @@ CREATE OPERATOR CLASS gist_periodset_ops
 	OPERATOR	31		#&> (periodset, timestampset),
 	OPERATOR	31		#&> (periodset, period),
 	OPERATOR	31		#&> (periodset, periodset),
+	-- distance
+	OPERATOR	25		<-> (periodset, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+	OPERATOR	25		<-> (periodset, period) FOR ORDER BY pg_catalog.float_ops,
 	-- functions
 	FUNCTION	1	gist_periodset_consistent(internal, periodset, smallint, oid, internal),
-	FUNCTION	2	gist_period_union(internal, internal),
+	FUNCTION	2	gist_periodset_union(internal, internal),
 	FUNCTION	3	gist_periodset_compress(internal),
-	FUNCTION	5	gist_period_penalty(internal, internal, internal),
-	FUNCTION	6	gist_period_picksplit(internal, internal),
-	FUNCTION	7	gist_period_same(period, period, internal);
+	FUNCTION	5	gist_periodset_penalty(internal, internal, internal),
+	FUNCTION	6	gist_periodset_picksplit(internal, internal),
+	FUNCTION	7	gist_periodset_same(periodset, periodset, internal),
+	FUNCTION	8	gist_periodset_distance(internal, periodset, smallint, oid, internal);
 
 /******************************************************************************/
@@ -115,6 +115,10 @@ CREATE FUNCTION tbox_cmp(tbox, tbox)
 	RETURNS int4
 	AS 'MODULE_PATHNAME', 'tbox_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbox_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'tbox_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR = (
 	LEFTARG = tbox, RIGHTARG = tbox,
@@ -162,6 +166,20 @@ CREATE OPERATOR CLASS tbox_ops
 	OPERATOR	3	= ,
 	OPERATOR	4	>= ,
 	OPERATOR	5	> ,
-	FUNCTION	1	tbox_cmp(tbox, tbox);
+	FUNCTION	1	tbox_cmp(tbox, tbox),
+	FUNCTION	2	tbox_sortsupport(internal);
+
+/*****************************************************************************
+ * Space-filling curves
+ *****************************************************************************/
+
+CREATE FUNCTION zorderKey(tbox, tbox)
+	RETURNS bigint
+	AS 'MODULE_PATHNAME', 'tbox_zorder_key'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION hilbertKey(tbox, tbox)
+	RETURNS bigint
+	AS 'MODULE_PATHNAME', 'tbox_hilbert_key'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 /*****************************************************************************/
@@ -414,6 +414,56 @@ CREATE FUNCTION appendInstant(ttext, ttext)
 	AS 'MODULE_PATHNAME', 'temporal_append_instant'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION appendInstants(tbool, tbool[])
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_append_instants'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(tint, tint[])
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_append_instants'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(tfloat, tfloat[])
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_append_instants'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION appendInstants(ttext, ttext[])
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_append_instants'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION merge(tbool[])
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tbool[], policy text)
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tint[])
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tint[], policy text)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tfloat[])
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(tfloat[], policy text)
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(ttext[])
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION merge(ttext[], policy text)
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_merge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /******************************************************************************
  * Accessor functions
  ******************************************************************************/
@@ -469,6 +519,87 @@ CREATE FUNCTION memSize(ttext)
 	AS 'MODULE_PATHNAME', 'temporal_mem_size'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION formatVersion(tbool)
+	RETURNS int
+	AS 'MODULE_PATHNAME', 'temporal_format_version'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION formatVersion(tint)
+	RETURNS int
+	AS 'MODULE_PATHNAME', 'temporal_format_version'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION formatVersion(tfloat)
+	RETURNS int
+	AS 'MODULE_PATHNAME', 'temporal_format_version'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION formatVersion(ttext)
+	RETURNS int
+	AS 'MODULE_PATHNAME', 'temporal_format_version'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION upgrade(tbool)
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_upgrade'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION upgrade(tint)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_upgrade'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION upgrade(tfloat)
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_upgrade'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION upgrade(ttext)
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_upgrade'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tbool)
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tint)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(tfloat)
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION compress(ttext)
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_compress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION decompress(tbool)
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_decompress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION decompress(tint)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_decompress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION decompress(tfloat)
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_decompress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION decompress(ttext)
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_decompress'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION isCompressed(tbool)
+	RETURNS boolean
+	AS 'MODULE_PATHNAME', 'temporal_is_compressed'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION isCompressed(tint)
+	RETURNS boolean
+	AS 'MODULE_PATHNAME', 'temporal_is_compressed'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION isCompressed(tfloat)
+	RETURNS boolean
+	AS 'MODULE_PATHNAME', 'temporal_is_compressed'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION isCompressed(ttext)
+	RETURNS boolean
+	AS 'MODULE_PATHNAME', 'temporal_is_compressed'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 -- values is a reserved word in SQL
 CREATE FUNCTION getValue(tbool)
 	RETURNS boolean
@@ -560,6 +691,14 @@ CREATE FUNCTION minValue(ttext)
 	RETURNS text
 	AS 'MODULE_PATHNAME', 'temporal_min_value'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION minValue(tint, period)
+	RETURNS integer
+	AS 'MODULE_PATHNAME', 'tnumber_min_value_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION minValue(tfloat, period)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'tnumber_min_value_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE FUNCTION maxValue(tint)
 	RETURNS integer
@@ -573,6 +712,14 @@ CREATE FUNCTION maxValue(ttext)
 	RETURNS text
 	AS 'MODULE_PATHNAME', 'temporal_max_value'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION maxValue(tint, period)
+	RETURNS integer
+	AS 'MODULE_PATHNAME', 'tnumber_max_value_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION maxValue(tfloat, period)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'tnumber_max_value_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 -- timestamp is a reserved word in SQL
 CREATE FUNCTION getTimestamp(tbool)
@@ -797,6 +944,27 @@ CREATE FUNCTION instants(ttext)
 	AS 'MODULE_PATHNAME', 'temporal_instants'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION unnestInstants(tbool, OUT t timestamptz, OUT value boolean,
+		OUT seqno integer)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporal_unnest'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(tint, OUT t timestamptz, OUT value integer,
+		OUT seqno integer)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporal_unnest'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(tfloat, OUT t timestamptz, OUT value float,
+		OUT seqno integer)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporal_unnest'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION unnestInstants(ttext, OUT t timestamptz, OUT value text,
+		OUT seqno integer)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporal_unnest'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION numTimestamps(tbool)
 	RETURNS integer
 	AS 'MODULE_PATHNAME', 'temporal_num_timestamps'
@@ -1059,10 +1227,91 @@ CREATE FUNCTION minusMax(ttext)
 	AS 'MODULE_PATHNAME', 'temporal_minus_max'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+-------------------------------------------------------------------------------
+-- Restriction functions returning the time
+-------------------------------------------------------------------------------
+
+/* whenAtValue(temp, v) is equivalent to getTime(atValue(temp, v)), 
+   whenAtRange(temp, r) to getTime(atRange(temp, r)), and whenGt(temp, v) to 
+   whenTrue(temp #> v), but the time is computed without constructing the
+   intermediate temporal values */
+
+CREATE FUNCTION whenAtValue(tbool, boolean)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'temporal_when_at_value'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenAtValue(tint, integer)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'temporal_when_at_value'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenAtValue(tfloat, float)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'temporal_when_at_value'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenAtValue(ttext, text)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'temporal_when_at_value'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenTrue(tbool)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tbool_when_true'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenAtRange(tint, intrange)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_at_range'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenAtRange(tfloat, floatrange)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_at_range'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenLt(tint, integer)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_lt'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenLt(tfloat, float)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_lt'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenLe(tint, integer)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_le'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenLe(tfloat, float)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_le'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenGt(tint, integer)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_gt'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenGt(tfloat, float)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_gt'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION whenGe(tint, integer)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_ge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION whenGe(tfloat, float)
+	RETURNS periodset
+	AS 'MODULE_PATHNAME', 'tnumber_when_ge'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /*****************************************************************************
  * Ever/Always Comparison Functions 
  *****************************************************************************/
 
+CREATE FUNCTION temporal_ever_sel(internal, oid, internal, integer)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'temporal_ever_sel'
+	LANGUAGE C IMMUTABLE STRICT;
+
 CREATE FUNCTION ever_eq(tbool, boolean)
 	RETURNS boolean
 	AS 'MODULE_PATHNAME', 'temporal_ever_eq'
@@ -1084,25 +1333,25 @@ CREATE OPERATOR ?= (
 	LEFTARG = tbool, RIGHTARG = boolean,
 	PROCEDURE = ever_eq,
 	NEGATOR = %<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?= (
 	LEFTARG = tint, RIGHTARG = integer,
 	PROCEDURE = ever_eq,
 	NEGATOR = %<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?= (
 	LEFTARG = tfloat, RIGHTARG = float,
 	PROCEDURE = ever_eq,
 	NEGATOR = %<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?= (
 	LEFTARG = ttext, RIGHTARG = text,
 	PROCEDURE = ever_eq,
 	NEGATOR = %<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_eq(tbool, boolean)
@@ -1126,25 +1375,25 @@ CREATE OPERATOR %= (
 	LEFTARG = tbool, RIGHTARG = boolean,
 	PROCEDURE = always_eq,
 	NEGATOR = ?<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %= (
 	LEFTARG = tint, RIGHTARG = integer,
 	PROCEDURE = always_eq,
 	NEGATOR = ?<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %= (
 	LEFTARG = tfloat, RIGHTARG = float,
 	PROCEDURE = always_eq,
 	NEGATOR = ?<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %= (
 	LEFTARG = ttext, RIGHTARG = text,
 	PROCEDURE = always_eq,
 	NEGATOR = ?<>,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION ever_ne(tbool, boolean)
@@ -1168,25 +1417,25 @@ CREATE OPERATOR ?<> (
 	LEFTARG = tbool, RIGHTARG = boolean,
 	PROCEDURE = ever_ne,
 	NEGATOR = %=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<> (
 	LEFTARG = tint, RIGHTARG = integer,
 	PROCEDURE = ever_ne,
 	NEGATOR = %=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<> (
 	LEFTARG = tfloat, RIGHTARG = float,
 	PROCEDURE = ever_ne,
 	NEGATOR = %=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR ?<> (
 	LEFTARG = ttext, RIGHTARG = text,
 	PROCEDURE = ever_ne,
 	NEGATOR = %=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 CREATE FUNCTION always_ne(tbool, boolean)
@@ -1210,25 +1459,25 @@ CREATE OPERATOR %<> (
 	LEFTARG = tbool, RIGHTARG = boolean,
 	PROCEDURE = always_ne,
 	NEGATOR = ?=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<> (
 	LEFTARG = tint, RIGHTARG = integer,
 	PROCEDURE = always_ne,
 	NEGATOR = ?=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<> (
 	LEFTARG = tfloat, RIGHTARG = float,
 	PROCEDURE = always_ne,
 	NEGATOR = ?=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 CREATE OPERATOR %<> (
 	LEFTARG = ttext, RIGHTARG = text,
 	PROCEDURE = always_ne,
 	NEGATOR = ?=,
-	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+	RESTRICT = temporal_ever_sel, JOIN = scalarltjoinsel
 );
 
 /*****************************************************************************
@@ -1546,6 +1795,23 @@ CREATE FUNCTION valueAtTimestamp(ttext, timestamptz)
 	AS 'MODULE_PATHNAME', 'temporal_value_at_timestamp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION valuesAtTimestampSet(tbool, timestampset)
+	RETURNS boolean[]
+	AS 'MODULE_PATHNAME', 'temporal_values_at_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION valuesAtTimestampSet(tint, timestampset)
+	RETURNS integer[]
+	AS 'MODULE_PATHNAME', 'temporal_values_at_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION valuesAtTimestampSet(tfloat, timestampset)
+	RETURNS float[]
+	AS 'MODULE_PATHNAME', 'temporal_values_at_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION valuesAtTimestampSet(ttext, timestampset)
+	RETURNS text[]
+	AS 'MODULE_PATHNAME', 'temporal_values_at_timestampset'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION atTimestampSet(tbool, timestampset)
 	RETURNS tbool
 	AS 'MODULE_PATHNAME', 'temporal_at_timestampset'
@@ -1716,6 +1982,93 @@ CREATE FUNCTION intersectsPeriodSet(ttext, periodset)
 	AS 'MODULE_PATHNAME', 'temporal_intersects_periodset'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION tsample(tbool, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_sample'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(tint, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_sample'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(tfloat, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_sample'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsample(ttext, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_sample'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tbucket(tbool, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_bucket'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbucket(tint, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_bucket'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbucket(tfloat, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_bucket'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbucket(ttext, interval,
+	origin timestamptz DEFAULT '2000-01-03 00:00:00+00')
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_bucket'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tsync(tbool[], mode text DEFAULT 'union',
+		OUT t timestamptz, OUT vals boolean[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tint[], mode text DEFAULT 'union',
+		OUT t timestamptz, OUT vals integer[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tfloat[], mode text DEFAULT 'union',
+		OUT t timestamptz, OUT vals float[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(ttext[], mode text DEFAULT 'union',
+		OUT t timestamptz, OUT vals text[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tbool[], interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT t timestamptz, OUT vals boolean[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync_grid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tint[], interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT t timestamptz, OUT vals integer[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync_grid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(tfloat[], interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT t timestamptz, OUT vals float[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync_grid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tsync(ttext[], interval,
+		origin timestamptz DEFAULT '2000-01-03 00:00:00+00',
+		OUT t timestamptz, OUT vals text[])
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'temporalarr_sync_grid'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION integral(tint)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'tnumber_integral'
@@ -1725,6 +2078,15 @@ CREATE FUNCTION integral(tfloat)
 	AS 'MODULE_PATHNAME', 'tnumber_integral'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+CREATE FUNCTION integral(tint, period)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'tnumber_integral_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION integral(tfloat, period)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'tnumber_integral_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 CREATE FUNCTION twAvg(tint)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'tnumber_twavg'
@@ -1733,6 +2095,14 @@ CREATE FUNCTION twAvg(tfloat)
 	RETURNS float
 	AS 'MODULE_PATHNAME', 'tnumber_twavg'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION twAvg(tint, period)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'tnumber_twavg_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION twAvg(tfloat, period)
+	RETURNS float
+	AS 'MODULE_PATHNAME', 'tnumber_twavg_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 	
 /******************************************************************************
  * Comparison functions and B-tree indexing
@@ -1766,6 +2136,10 @@ CREATE FUNCTION tbool_cmp(tbool, tbool)
 	RETURNS integer
 	AS 'MODULE_PATHNAME', 'temporal_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tbool_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'temporal_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR < (
 	LEFTARG = tbool, RIGHTARG = tbool,
@@ -1817,7 +2191,8 @@ CREATE OPERATOR CLASS tbool_ops
 		OPERATOR	3	=,
 		OPERATOR	4	>=,
 		OPERATOR	5	>,
-		FUNCTION	1	tbool_cmp(tbool, tbool);
+		FUNCTION	1	tbool_cmp(tbool, tbool),
+		FUNCTION	2	tbool_sortsupport(internal);
 
 /*****************************************************************************/
 
@@ -1849,6 +2224,10 @@ CREATE FUNCTION tint_cmp(tint, tint)
 	RETURNS integer
 	AS 'MODULE_PATHNAME', 'temporal_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tint_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'temporal_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR < (
 	LEFTARG = tint, RIGHTARG = tint,
@@ -1900,7 +2279,8 @@ CREATE OPERATOR CLASS tint_ops
 		OPERATOR	3	=,
 		OPERATOR	4	>=,
 		OPERATOR	5	>,
-		FUNCTION	1	tint_cmp(tint, tint);
+		FUNCTION	1	tint_cmp(tint, tint),
+		FUNCTION	2	tint_sortsupport(internal);
 
 /*****************************************************************************/
 
@@ -1932,6 +2312,10 @@ CREATE FUNCTION tfloat_cmp(tfloat, tfloat)
 	RETURNS integer
 	AS 'MODULE_PATHNAME', 'temporal_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tfloat_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'temporal_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR < (
 	LEFTARG = tfloat, RIGHTARG = tfloat,
@@ -1983,7 +2367,8 @@ CREATE OPERATOR CLASS tfloat_ops
 		OPERATOR	3	=,
 		OPERATOR	4	>=,
 		OPERATOR	5	>,
-		FUNCTION	1	tfloat_cmp(tfloat, tfloat);
+		FUNCTION	1	tfloat_cmp(tfloat, tfloat),
+		FUNCTION	2	tfloat_sortsupport(internal);
 		
 /******************************************************************************/
 
@@ -2015,6 +2400,10 @@ CREATE FUNCTION ttext_cmp(ttext, ttext)
 	RETURNS integer
 	AS 'MODULE_PATHNAME', 'temporal_cmp'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ttext_sortsupport(internal)
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'temporal_sortsupport'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR < (
 	LEFTARG = ttext, RIGHTARG = ttext,
@@ -2066,7 +2455,8 @@ CREATE OPERATOR CLASS ttext_ops
 		OPERATOR	3	=,
 		OPERATOR	4	>=,
 		OPERATOR	5	>,
-		FUNCTION	1	ttext_cmp(ttext, ttext);
+		FUNCTION	1	ttext_cmp(ttext, ttext),
+		FUNCTION	2	ttext_sortsupport(internal);
 
 /******************************************************************************/
 
@@ -2105,3 +2495,14 @@ CREATE OPERATOR CLASS hash_ttext_ops
     FUNCTION    1   ttext_hash(ttext);
 
 /******************************************************************************/
+
+/******************************************************************************
+ * Incremental refresh of the statistics
+ ******************************************************************************/
+
+CREATE FUNCTION mergePeriodStats(rel regclass, max_blocks integer DEFAULT 1024)
+	RETURNS bigint
+	AS 'MODULE_PATHNAME', 'merge_period_stats'
+	LANGUAGE C VOLATILE STRICT PARALLEL UNSAFE;
+
+/******************************************************************************/
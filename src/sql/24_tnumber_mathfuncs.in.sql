@@ -466,4 +466,11 @@ CREATE FUNCTION degrees(tfloat)
 	AS 'MODULE_PATHNAME', 'temporal_degrees'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
+/* tfloat weighted sum */
+
+CREATE FUNCTION weightedSum(tfloat[], weights float[])
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'tfloat_weighted_sum'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
 /******************************************************************************/
@@ -1273,4 +1273,84 @@ CREATE OPERATOR #&> (
 	RESTRICT = temporal_sel, JOIN = tnumber_joinsel
 );
 
+/*****************************************************************************
+ * Distance on the time dimension
+ *****************************************************************************/
+
+CREATE FUNCTION temporal_distance(timestamptz, tint)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestamp_temporal'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, tint)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_period_temporal'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(tint, timestamptz)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_temporal_timestamp'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(tint, period)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_temporal_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestamptz, RIGHTARG = tint,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = period, RIGHTARG = tint,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = tint, RIGHTARG = timestamptz,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = tint, RIGHTARG = period,
+	COMMUTATOR = <->
+);
+
+CREATE FUNCTION temporal_distance(timestamptz, tfloat)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_timestamp_temporal'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(period, tfloat)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_period_temporal'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(tfloat, timestamptz)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_temporal_timestamp'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION temporal_distance(tfloat, period)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'distance_temporal_period'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = timestamptz, RIGHTARG = tfloat,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = period, RIGHTARG = tfloat,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = tfloat, RIGHTARG = timestamptz,
+	COMMUTATOR = <->
+);
+CREATE OPERATOR <-> (
+	PROCEDURE = temporal_distance,
+	LEFTARG = tfloat, RIGHTARG = period,
+	COMMUTATOR = <->
+);
+
 /*****************************************************************************/
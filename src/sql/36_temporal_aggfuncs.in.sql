@@ -82,6 +82,14 @@ CREATE FUNCTION tcount_combinefn(internal, internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'temporal_tcount_combinefn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_mtransfn(internal, tbool)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invtransfn(internal, tbool)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tbool_tand_transfn(internal, tbool)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'tbool_tand_transfn'
@@ -114,6 +122,10 @@ CREATE AGGREGATE tcount(tbool) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tcount_mtransfn,
+	MINVFUNC = tcount_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tagg_finalfn,
 	PARALLEL = SAFE
 );
 CREATE AGGREGATE tand(tbool) (
@@ -165,6 +177,22 @@ CREATE FUNCTION tcount_transfn(internal, tint)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_mtransfn(internal, tint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invtransfn(internal, tint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_mtransfn(internal, tint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tnumber_tavg_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_invtransfn(internal, tint)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tnumber_tavg_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tavg_transfn(internal, tint)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'tnumber_tavg_transfn'
@@ -177,6 +205,14 @@ CREATE FUNCTION tavg_finalfn(internal)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'tnumber_tavg_finalfn'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tint_tsum_mfinalfn(internal)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'tint_tsum_mfinalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tfloat_tsum_mfinalfn(internal)
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'tfloat_tsum_mfinalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE AGGREGATE tmin(tint) (
 	SFUNC = tint_tmin_transfn,
@@ -203,6 +239,10 @@ CREATE AGGREGATE tsum(tint) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tavg_mtransfn,
+	MINVFUNC = tavg_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tsum_mfinalfn,
 	PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tint) (
@@ -212,6 +252,10 @@ CREATE AGGREGATE tcount(tint) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tcount_mtransfn,
+	MINVFUNC = tcount_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tagg_finalfn,
 	PARALLEL = SAFE
 );
 CREATE AGGREGATE tavg(tint) (
@@ -221,6 +265,10 @@ CREATE AGGREGATE tavg(tint) (
 	FINALFUNC = tavg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tavg_mtransfn,
+	MINVFUNC = tavg_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tavg_finalfn,
 	PARALLEL = SAFE
 );
 
@@ -252,6 +300,22 @@ CREATE FUNCTION tcount_transfn(internal, tfloat)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_mtransfn(internal, tfloat)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invtransfn(internal, tfloat)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_mtransfn(internal, tfloat)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tnumber_tavg_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tavg_invtransfn(internal, tfloat)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'tnumber_tavg_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION tfloat_tagg_finalfn(internal)
 	RETURNS tfloat
 	AS 'MODULE_PATHNAME', 'temporal_tagg_finalfn'
@@ -286,6 +350,10 @@ CREATE AGGREGATE tsum(tfloat) (
 	FINALFUNC = tfloat_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tavg_mtransfn,
+	MINVFUNC = tavg_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tfloat_tsum_mfinalfn,
 	PARALLEL = SAFE
 );
 CREATE AGGREGATE tcount(tfloat) (
@@ -295,6 +363,10 @@ CREATE AGGREGATE tcount(tfloat) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tcount_mtransfn,
+	MINVFUNC = tcount_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tagg_finalfn,
 	PARALLEL = SAFE
 );
 CREATE AGGREGATE tavg(tfloat) (
@@ -304,6 +376,10 @@ CREATE AGGREGATE tavg(tfloat) (
 	FINALFUNC = tavg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tavg_mtransfn,
+	MINVFUNC = tavg_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tavg_finalfn,
 	PARALLEL = SAFE
 );
  
@@ -329,6 +405,14 @@ CREATE FUNCTION tcount_transfn(internal, ttext)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'temporal_tcount_transfn'
 	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_mtransfn(internal, ttext)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_mtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_invtransfn(internal, ttext)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_invtransfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
 CREATE FUNCTION ttext_tagg_finalfn(internal)
 	RETURNS ttext
 	AS 'MODULE_PATHNAME', 'temporal_tagg_finalfn'
@@ -359,6 +443,256 @@ CREATE AGGREGATE tcount(ttext) (
 	FINALFUNC = tint_tagg_finalfn,
 	SERIALFUNC = tagg_serialize,
 	DESERIALFUNC = tagg_deserialize,
+	MSFUNC = tcount_mtransfn,
+	MINVFUNC = tcount_invtransfn,
+	MSTYPE = internal,
+	MFINALFUNC = tint_tagg_finalfn,
+	PARALLEL = SAFE
+);
+
+/*****************************************************************************/
+
+/*****************************************************************************
+ * Aggregate building a temporal sequence from (value, timestamp) rows
+ *****************************************************************************/
+
+CREATE FUNCTION tseq_agg_combinefn(internal, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_combinefn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tseq_agg_serialize(internal)
+	RETURNS bytea
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_serialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tseq_agg_deserialize(bytea, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_deserialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tseq_agg_transfn(internal, boolean, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tbool_tseq_agg_finalfn(internal)
+	RETURNS tbool
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tseq_agg(boolean, timestamptz) (
+	SFUNC = tseq_agg_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tseq_agg_combinefn,
+	FINALFUNC = tbool_tseq_agg_finalfn,
+	SERIALFUNC = tseq_agg_serialize,
+	DESERIALFUNC = tseq_agg_deserialize,
+	PARALLEL = SAFE
+);
+
+CREATE FUNCTION tseq_agg_transfn(internal, integer, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tint_tseq_agg_finalfn(internal)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tseq_agg(integer, timestamptz) (
+	SFUNC = tseq_agg_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tseq_agg_combinefn,
+	FINALFUNC = tint_tseq_agg_finalfn,
+	SERIALFUNC = tseq_agg_serialize,
+	DESERIALFUNC = tseq_agg_deserialize,
+	PARALLEL = SAFE
+);
+
+CREATE FUNCTION tseq_agg_transfn(internal, float, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tfloat_tseq_agg_finalfn(internal)
+	RETURNS tfloat
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tseq_agg(float, timestamptz) (
+	SFUNC = tseq_agg_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tseq_agg_combinefn,
+	FINALFUNC = tfloat_tseq_agg_finalfn,
+	SERIALFUNC = tseq_agg_serialize,
+	DESERIALFUNC = tseq_agg_deserialize,
+	PARALLEL = SAFE
+);
+
+CREATE FUNCTION tseq_agg_transfn(internal, text, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION ttext_tseq_agg_finalfn(internal)
+	RETURNS ttext
+	AS 'MODULE_PATHNAME', 'temporal_tseq_agg_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE AGGREGATE tseq_agg(text, timestamptz) (
+	SFUNC = tseq_agg_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tseq_agg_combinefn,
+	FINALFUNC = ttext_tseq_agg_finalfn,
+	SERIALFUNC = tseq_agg_serialize,
+	DESERIALFUNC = tseq_agg_deserialize,
+	PARALLEL = SAFE
+);
+
+/* Merge of temporal fragments */
+
+CREATE AGGREGATE merge_agg(tbool) (
+	SFUNC = array_append,
+	STYPE = tbool[],
+	FINALFUNC = merge,
+	PARALLEL = SAFE
+);
+CREATE AGGREGATE merge_agg(tint) (
+	SFUNC = array_append,
+	STYPE = tint[],
+	FINALFUNC = merge,
+	PARALLEL = SAFE
+);
+CREATE AGGREGATE merge_agg(tfloat) (
+	SFUNC = array_append,
+	STYPE = tfloat[],
+	FINALFUNC = merge,
+	PARALLEL = SAFE
+);
+CREATE AGGREGATE merge_agg(ttext) (
+	SFUNC = array_append,
+	STYPE = ttext[],
+	FINALFUNC = merge,
+	PARALLEL = SAFE
+);
+
+/* Temporal count per time bucket */
+
+CREATE FUNCTION tcount_buckets_combinefn(internal, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_combinefn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE FUNCTION tcount_buckets_finalfn(internal)
+	RETURNS tint
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_finalfn'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tcount_buckets_serialize(internal)
+	RETURNS bytea
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_serialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION tcount_buckets_deserialize(bytea, internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_deserialize'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION tcount_buckets_transfn(internal, tbool, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tbool, interval) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tbool, interval, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tbool, interval, timestamptz) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tint, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tint, interval) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tint, interval, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tint, interval, timestamptz) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tfloat, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tfloat, interval) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, tfloat, interval, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(tfloat, interval, timestamptz) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, ttext, interval)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(ttext, interval) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
+	PARALLEL = SAFE
+);
+CREATE FUNCTION tcount_buckets_transfn(internal, ttext, interval, timestamptz)
+	RETURNS internal
+	AS 'MODULE_PATHNAME', 'temporal_tcount_buckets_transfn'
+	LANGUAGE C IMMUTABLE PARALLEL SAFE;
+CREATE AGGREGATE tcount_buckets(ttext, interval, timestamptz) (
+	SFUNC = tcount_buckets_transfn,
+	STYPE = internal,
+	COMBINEFUNC = tcount_buckets_combinefn,
+	FINALFUNC = tcount_buckets_finalfn,
+	SERIALFUNC = tcount_buckets_serialize,
+	DESERIALFUNC = tcount_buckets_deserialize,
 	PARALLEL = SAFE
 );
 
@@ -81,6 +81,10 @@ CREATE FUNCTION gist_tint_compress(internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'gist_tnumber_compress'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tint_distance(internal, tint, smallint, oid, internal)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'gist_tnumber_distance'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR CLASS gist_tint_ops
 	DEFAULT FOR TYPE tint USING gist AS
@@ -141,13 +145,17 @@ CREATE OPERATOR CLASS gist_tint_ops
 	OPERATOR	31		#&> (tint, tbox),
 	OPERATOR	31		#&> (tint, tint),
 	OPERATOR	31		#&> (tint, tfloat),
+	-- distance
+	OPERATOR	25		<-> (tint, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+	OPERATOR	25		<-> (tint, period) FOR ORDER BY pg_catalog.float_ops,
 	-- functions
 	FUNCTION	1	gist_tint_consistent(internal, tint, smallint, oid, internal),
 	FUNCTION	2	gist_tbox_union(internal, internal),
 	FUNCTION	3	gist_tint_compress(internal),
 	FUNCTION	5	gist_tbox_penalty(internal, internal, internal),
 	FUNCTION	6	gist_tbox_picksplit(internal, internal),
-	FUNCTION	7	gist_tbox_same(tbox, tbox, internal);
+	FUNCTION	7	gist_tbox_same(tbox, tbox, internal),
+	FUNCTION	8	gist_tint_distance(internal, tint, smallint, oid, internal);
 
 /******************************************************************************/
 
@@ -159,6 +167,10 @@ CREATE FUNCTION gist_tfloat_compress(internal)
 	RETURNS internal
 	AS 'MODULE_PATHNAME', 'gist_tnumber_compress'
 	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tfloat_distance(internal, tfloat, smallint, oid, internal)
+	RETURNS float8
+	AS 'MODULE_PATHNAME', 'gist_tnumber_distance'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
 
 CREATE OPERATOR CLASS gist_tfloat_ops
 	DEFAULT FOR TYPE tfloat USING gist AS
@@ -219,13 +231,66 @@ CREATE OPERATOR CLASS gist_tfloat_ops
 	OPERATOR	31		#&> (tfloat, tbox),
 	OPERATOR	31		#&> (tfloat, tint),
 	OPERATOR	31		#&> (tfloat, tfloat),
+	-- distance
+	OPERATOR	25		<-> (tfloat, timestamptz) FOR ORDER BY pg_catalog.float_ops,
+	OPERATOR	25		<-> (tfloat, period) FOR ORDER BY pg_catalog.float_ops,
 	-- functions
 	FUNCTION	1	gist_tfloat_consistent(internal, tfloat, smallint, oid, internal),
 	FUNCTION	2	gist_tbox_union(internal, internal),
 	FUNCTION	3	gist_tfloat_compress(internal),
 	FUNCTION	5	gist_tbox_penalty(internal, internal, internal),
 	FUNCTION	6	gist_tbox_picksplit(internal, internal),
-	FUNCTION	7	gist_tbox_same(tbox, tbox, internal);
+	FUNCTION	7	gist_tbox_same(tbox, tbox, internal),
+	FUNCTION	8	gist_tfloat_distance(internal, tfloat, smallint, oid, internal);
+
+/******************************************************************************/
+
+CREATE FUNCTION gist_tbox_consistent(internal, tbox, smallint, oid, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME', 'gist_tnumber_consistent'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION gist_tbox_fetch(internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE; 
+
+/*
+ * Since the keys are the indexed values, this operator class supports
+ * index-only scans, e.g., on a table (id, box) of precomputed bounding boxes
+ */
+CREATE OPERATOR CLASS gist_tbox_ops
+	DEFAULT FOR TYPE tbox USING gist AS
+	-- strictly left
+	OPERATOR	1		<< (tbox, tbox),
+	-- overlaps or left
+	OPERATOR	2		&< (tbox, tbox),
+	-- overlaps
+	OPERATOR	3		&& (tbox, tbox),
+	-- overlaps or right
+	OPERATOR	4		&> (tbox, tbox),
+	-- strictly right
+	OPERATOR	5		>> (tbox, tbox),
+	-- same
+	OPERATOR	6		~= (tbox, tbox),
+	-- contains
+	OPERATOR	7		@> (tbox, tbox),
+	-- contained by
+	OPERATOR	8		<@ (tbox, tbox),
+	-- overlaps or before
+	OPERATOR	28		&<# (tbox, tbox),
+	-- strictly before
+	OPERATOR	29		<<# (tbox, tbox),
+	-- strictly after
+	OPERATOR	30		#>> (tbox, tbox),
+	-- overlaps or after
+	OPERATOR	31		#&> (tbox, tbox),
+	-- functions
+	FUNCTION	1	gist_tbox_consistent(internal, tbox, smallint, oid, internal),
+	FUNCTION	2	gist_tbox_union(internal, internal),
+	FUNCTION	5	gist_tbox_penalty(internal, internal, internal),
+	FUNCTION	6	gist_tbox_picksplit(internal, internal),
+	FUNCTION	7	gist_tbox_same(tbox, tbox, internal),
+	FUNCTION	9	gist_tbox_fetch(internal);
 
 /******************************************************************************/
 
@@ -0,0 +1,315 @@
+/*****************************************************************************
+ *
+ * temporal_brin.sql
+ *		BRIN index for time types and temporal numbers
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse, 
+ * 		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION brin_period_opcinfo(internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_timestampset_add_value(internal, internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_period_add_value(internal, internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_periodset_add_value(internal, internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_period_consistent(internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_period_union(internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS brin_timestampset_ops
+	DEFAULT FOR TYPE timestampset USING brin AS
+	STORAGE period,
+	-- overlaps
+	OPERATOR	3		&& (timestampset, timestampset),
+	OPERATOR	3		&& (timestampset, period),
+	OPERATOR	3		&& (timestampset, periodset),
+	-- contains
+	OPERATOR	7		@> (timestampset, timestamptz),
+	OPERATOR	7		@> (timestampset, timestampset),
+	-- contained by
+	OPERATOR	8		<@ (timestampset, timestampset),
+	OPERATOR	8		<@ (timestampset, period),
+	OPERATOR	8		<@ (timestampset, periodset),
+	-- overlaps or before
+	OPERATOR	28		&<# (timestampset, timestamptz),
+	OPERATOR	28		&<# (timestampset, timestampset),
+	OPERATOR	28		&<# (timestampset, period),
+	OPERATOR	28		&<# (timestampset, periodset),
+	-- strictly before
+	OPERATOR	29		<<# (timestampset, timestamptz),
+	OPERATOR	29		<<# (timestampset, timestampset),
+	OPERATOR	29		<<# (timestampset, period),
+	OPERATOR	29		<<# (timestampset, periodset),
+	-- strictly after
+	OPERATOR	30		#>> (timestampset, timestamptz),
+	OPERATOR	30		#>> (timestampset, timestampset),
+	OPERATOR	30		#>> (timestampset, period),
+	OPERATOR	30		#>> (timestampset, periodset),
+	-- overlaps or after
+	OPERATOR	31		#&> (timestampset, timestamptz),
+	OPERATOR	31		#&> (timestampset, timestampset),
+	OPERATOR	31		#&> (timestampset, period),
+	OPERATOR	31		#&> (timestampset, periodset),
+	-- functions
+	FUNCTION	1	brin_period_opcinfo(internal),
+	FUNCTION	2	brin_timestampset_add_value(internal, internal, internal, internal),
+	FUNCTION	3	brin_period_consistent(internal, internal, internal),
+	FUNCTION	4	brin_period_union(internal, internal, internal);
+
+/******************************************************************************/
+
+CREATE OPERATOR CLASS brin_period_ops
+	DEFAULT FOR TYPE period USING brin AS
+	STORAGE period,
+	-- overlaps
+	OPERATOR	3		&& (period, timestampset),
+	OPERATOR	3		&& (period, period),
+	OPERATOR	3		&& (period, periodset),
+	-- contains
+	OPERATOR	7		@> (period, timestamptz),
+	OPERATOR	7		@> (period, timestampset),
+	OPERATOR	7		@> (period, period),
+	OPERATOR	7		@> (period, periodset),
+	-- contained by
+	OPERATOR	8		<@ (period, period),
+	OPERATOR	8		<@ (period, periodset),
+	-- overlaps or before
+	OPERATOR	28		&<# (period, timestamptz),
+	OPERATOR	28		&<# (period, timestampset),
+	OPERATOR	28		&<# (period, period),
+	OPERATOR	28		&<# (period, periodset),
+	-- strictly before
+	OPERATOR	29		<<# (period, timestamptz),
+	OPERATOR	29		<<# (period, timestampset),
+	OPERATOR	29		<<# (period, period),
+	OPERATOR	29		<<# (period, periodset),
+	-- strictly after
+	OPERATOR	30		#>> (period, timestamptz),
+	OPERATOR	30		#>> (period, timestampset),
+	OPERATOR	30		#>> (period, period),
+	OPERATOR	30		#>> (period, periodset),
+	-- overlaps or after
+	OPERATOR	31		#&> (period, timestamptz),
+	OPERATOR	31		#&> (period, timestampset),
+	OPERATOR	31		#&> (period, period),
+	OPERATOR	31		#&> (period, periodset),
+	-- functions
+	FUNCTION	1	brin_period_opcinfo(internal),
+	FUNCTION	2	brin_period_add_value(internal, internal, internal, internal),
+	FUNCTION	3	brin_period_consistent(internal, internal, internal),
+	FUNCTION	4	brin_period_union(internal, internal, internal);
+
+/******************************************************************************/
+
+CREATE OPERATOR CLASS brin_periodset_ops
+	DEFAULT FOR TYPE periodset USING brin AS
+	STORAGE period,
+	-- overlaps
+	OPERATOR	3		&& (periodset, timestampset),
+	OPERATOR	3		&& (periodset, period),
+	OPERATOR	3		&& (periodset, periodset),
+	-- contains
+	OPERATOR	7		@> (periodset, timestamptz),
+	OPERATOR	7		@> (periodset, timestampset),
+	OPERATOR	7		@> (periodset, period),
+	OPERATOR	7		@> (periodset, periodset),
+	-- contained by
+	OPERATOR	8		<@ (periodset, period),
+	OPERATOR	8		<@ (periodset, periodset),
+	-- overlaps or before
+	OPERATOR	28		&<# (periodset, timestamptz),
+	OPERATOR	28		&<# (periodset, timestampset),
+	OPERATOR	28		&<# (periodset, period),
+	OPERATOR	28		&<# (periodset, periodset),
+	-- strictly before
+	OPERATOR	29		<<# (periodset, timestamptz),
+	OPERATOR	29		<<# (periodset, timestampset),
+	OPERATOR	29		<<# (periodset, period),
+	OPERATOR	29		<<# (periodset, periodset),
+	-- strictly after
+	OPERATOR	30		#>> (periodset, timestamptz),
+	OPERATOR	30		#>> (periodset, timestampset),
+	OPERATOR	30		#>> (periodset, period),
+	OPERATOR	30		#>> (periodset, periodset),
+	-- overlaps or after
+	OPERATOR	31		#&> (periodset, timestamptz),
+	OPERATOR	31		#&> (periodset, timestampset),
+	OPERATOR	31		#&> (periodset, period),
+	OPERATOR	31		#&> (periodset, periodset),
+	-- functions
+	FUNCTION	1	brin_period_opcinfo(internal),
+	FUNCTION	2	brin_periodset_add_value(internal, internal, internal, internal),
+	FUNCTION	3	brin_period_consistent(internal, internal, internal),
+	FUNCTION	4	brin_period_union(internal, internal, internal);
+
+/******************************************************************************/
+
+CREATE FUNCTION brin_tbox_opcinfo(internal)
+	RETURNS internal
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_tnumber_add_value(internal, internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_tnumber_consistent(internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION brin_tbox_union(internal, internal, internal)
+	RETURNS bool
+	AS 'MODULE_PATHNAME'
+	LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS brin_tint_ops
+	DEFAULT FOR TYPE tint USING brin AS
+	STORAGE tbox,
+	-- strictly left
+	OPERATOR	1		<< (tint, intrange),
+	OPERATOR	1		<< (tint, tbox),
+	OPERATOR	1		<< (tint, tint),
+	OPERATOR	1		<< (tint, tfloat),
+	-- overlaps or left
+	OPERATOR	2		&< (tint, intrange),
+	OPERATOR	2		&< (tint, tbox),
+	OPERATOR	2		&< (tint, tint),
+	OPERATOR	2		&< (tint, tfloat),
+	-- overlaps
+	OPERATOR	3		&& (tint, intrange),
+	OPERATOR	3		&& (tint, tbox),
+	OPERATOR	3		&& (tint, tint),
+	OPERATOR	3		&& (tint, tfloat),
+	-- overlaps or right
+	OPERATOR	4		&> (tint, intrange),
+	OPERATOR	4		&> (tint, tbox),
+	OPERATOR	4		&> (tint, tint),
+	OPERATOR	4		&> (tint, tfloat),
+	-- strictly right
+	OPERATOR	5		>> (tint, intrange),
+	OPERATOR	5		>> (tint, tbox),
+	OPERATOR	5		>> (tint, tint),
+	OPERATOR	5		>> (tint, tfloat),
+	-- same
+	OPERATOR	6		~= (tint, intrange),
+	OPERATOR	6		~= (tint, tbox),
+	OPERATOR	6		~= (tint, tint),
+	OPERATOR	6		~= (tint, tfloat),
+	-- contains
+	OPERATOR	7		@> (tint, intrange),
+	OPERATOR	7		@> (tint, tbox),
+	OPERATOR	7		@> (tint, tint),
+	OPERATOR	7		@> (tint, tfloat),
+	-- contained by
+	OPERATOR	8		<@ (tint, intrange),
+	OPERATOR	8		<@ (tint, tbox),
+	OPERATOR	8		<@ (tint, tint),
+	OPERATOR	8		<@ (tint, tfloat),
+	-- overlaps or before
+	OPERATOR	28		&<# (tint, tbox),
+	OPERATOR	28		&<# (tint, tint),
+	OPERATOR	28		&<# (tint, tfloat),
+	-- strictly before
+	OPERATOR	29		<<# (tint, tbox),
+	OPERATOR	29		<<# (tint, tint),
+	OPERATOR	29		<<# (tint, tfloat),
+	-- strictly after
+	OPERATOR	30		#>> (tint, tbox),
+	OPERATOR	30		#>> (tint, tint),
+	OPERATOR	30		#>> (tint, tfloat),
+	-- overlaps or after
+	OPERATOR	31		#&> (tint, tbox),
+	OPERATOR	31		#&> (tint, tint),
+	OPERATOR	31		#&> (tint, tfloat),
+	-- functions
+	FUNCTION	1	brin_tbox_opcinfo(internal),
+	FUNCTION	2	brin_tnumber_add_value(internal, internal, internal, internal),
+	FUNCTION	3	brin_tnumber_consistent(internal, internal, internal),
+	FUNCTION	4	brin_tbox_union(internal, internal, internal);
+
+/******************************************************************************/
+
+CREATE OPERATOR CLASS brin_tfloat_ops
+	DEFAULT FOR TYPE tfloat USING brin AS
+	STORAGE tbox,
+	-- strictly left
+	OPERATOR	1		<< (tfloat, floatrange),
+	OPERATOR	1		<< (tfloat, tbox),
+	OPERATOR	1		<< (tfloat, tint),
+	OPERATOR	1		<< (tfloat, tfloat),
+	-- overlaps or left
+	OPERATOR	2		&< (tfloat, floatrange),
+	OPERATOR	2		&< (tfloat, tbox),
+	OPERATOR	2		&< (tfloat, tint),
+	OPERATOR	2		&< (tfloat, tfloat),
+	-- overlaps
+	OPERATOR	3		&& (tfloat, floatrange),
+	OPERATOR	3		&& (tfloat, tbox),
+	OPERATOR	3		&& (tfloat, tint),
+	OPERATOR	3		&& (tfloat, tfloat),
+	-- overlaps or right
+	OPERATOR	4		&> (tfloat, floatrange),
+	OPERATOR	4		&> (tfloat, tbox),
+	OPERATOR	4		&> (tfloat, tint),
+	OPERATOR	4		&> (tfloat, tfloat),
+	-- strictly right
+	OPERATOR	5		>> (tfloat, floatrange),
+	OPERATOR	5		>> (tfloat, tbox),
+	OPERATOR	5		>> (tfloat, tint),
+	OPERATOR	5		>> (tfloat, tfloat),
+	-- same
+	OPERATOR	6		~= (tfloat, floatrange),
+	OPERATOR	6		~= (tfloat, tbox),
+	OPERATOR	6		~= (tfloat, tint),
+	OPERATOR	6		~= (tfloat, tfloat),
+	-- contains
+	OPERATOR	7		@> (tfloat, floatrange),
+	OPERATOR	7		@> (tfloat, tbox),
+	OPERATOR	7		@> (tfloat, tint),
+	OPERATOR	7		@> (tfloat, tfloat),
+	-- contained by
+	OPERATOR	8		<@ (tfloat, floatrange),
+	OPERATOR	8		<@ (tfloat, tbox),
+	OPERATOR	8		<@ (tfloat, tint),
+	OPERATOR	8		<@ (tfloat, tfloat),
+	-- overlaps or before
+	OPERATOR	28		&<# (tfloat, tbox),
+	OPERATOR	28		&<# (tfloat, tint),
+	OPERATOR	28		&<# (tfloat, tfloat),
+	-- strictly before
+	OPERATOR	29		<<# (tfloat, tbox),
+	OPERATOR	29		<<# (tfloat, tint),
+	OPERATOR	29		<<# (tfloat, tfloat),
+	-- strictly after
+	OPERATOR	30		#>> (tfloat, tbox),
+	OPERATOR	30		#>> (tfloat, tint),
+	OPERATOR	30		#>> (tfloat, tfloat),
+	-- overlaps or after
+	OPERATOR	31		#&> (tfloat, tbox),
+	OPERATOR	31		#&> (tfloat, tint),
+	OPERATOR	31		#&> (tfloat, tfloat),
+	-- functions
+	FUNCTION	1	brin_tbox_opcinfo(internal),
+	FUNCTION	2	brin_tnumber_add_value(internal, internal, internal, internal),
+	FUNCTION	3	brin_tnumber_consistent(internal, internal, internal),
+	FUNCTION	4	brin_tbox_union(internal, internal, internal);
+
+/******************************************************************************/
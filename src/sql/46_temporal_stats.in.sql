@@ -0,0 +1,32 @@
+/*****************************************************************************
+ *
+ * temporal_stats.sql
+ *		Per-backend performance counters and profile
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse, 
+ * 		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION mobilitydb_stats(OUT name text, OUT value bigint)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'mobilitydb_stats'
+	LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION mobilitydb_stats_reset()
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'mobilitydb_stats_reset'
+	LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+CREATE FUNCTION mobilitydb_profile(OUT name text, OUT calls bigint,
+		OUT total_time float8)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'mobilitydb_profile'
+	LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION mobilitydb_profile_reset()
+	RETURNS void
+	AS 'MODULE_PATHNAME', 'mobilitydb_profile_reset'
+	LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+/*****************************************************************************/
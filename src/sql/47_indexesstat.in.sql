@@ -0,0 +1,27 @@
+/*****************************************************************************
+ *
+ * indexesstat.sql
+ *		Diagnostic functions reporting the structure of the GiST and SP-GiST
+ *		indexes of time types and temporal types
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ * 		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION gist_index_stats(rel regclass, OUT level integer,
+		OUT pages integer, OUT tuples bigint, OUT avg_tuples float,
+		OUT fill float, OUT overlap float, OUT dead_space float)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'gist_index_stats'
+	LANGUAGE C VOLATILE STRICT;
+CREATE FUNCTION spgist_index_stats(rel regclass, OUT level integer,
+		OUT inner_tuples bigint, OUT leaf_tuples bigint, OUT avg_nodes float,
+		OUT all_the_same bigint)
+	RETURNS SETOF record
+	AS 'MODULE_PATHNAME', 'spgist_index_stats'
+	LANGUAGE C VOLATILE STRICT;
+
+/*****************************************************************************/
@@ -0,0 +1,25 @@
+/*****************************************************************************
+ *
+ * temporal_ingest.sql
+ *		Batched ingestion of instants into temporal columns
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse, 
+ * 		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+CREATE FUNCTION ingestFlush(staging regclass, target regclass, keycol name,
+		tempcol name, batch_size integer DEFAULT 10000)
+	RETURNS bigint
+	AS 'MODULE_PATHNAME', 'ingest_flush'
+	LANGUAGE C VOLATILE STRICT PARALLEL UNSAFE;
+CREATE FUNCTION ingestStart(staging regclass, target regclass, keycol name,
+		tempcol name, flush_interval integer DEFAULT 1000,
+		batch_size integer DEFAULT 10000)
+	RETURNS integer
+	AS 'MODULE_PATHNAME', 'ingest_start'
+	LANGUAGE C VOLATILE STRICT PARALLEL UNSAFE;
+
+/*****************************************************************************/
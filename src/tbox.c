@@ -318,6 +318,26 @@ tbox_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(cmp);
 }
 
+static int
+tbox_sortsupport_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	return tbox_cmp_internal(DatumGetTboxP(x), DatumGetTboxP(y));
+}
+
+/*
+ * No abbreviated keys are used since the component compared first depends
+ * on the dimensions of both boxes, which may vary from one box to another
+ */
+PG_FUNCTION_INFO_V1(tbox_sortsupport);
+
+PGDLLEXPORT Datum
+tbox_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+	sortsupport_abbrev_init(ssup, &tbox_sortsupport_cmp, NULL);
+	PG_RETURN_VOID();
+}
+
 PG_FUNCTION_INFO_V1(tbox_lt);
 
 PGDLLEXPORT Datum
@@ -398,5 +418,51 @@ tbox_ne(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(! tbox_eq_internal(box1, box2));
 }
 
-/*****************************************************************************/
+/*****************************************************************************
+ * Space-filling curves
+ *****************************************************************************/
 
+/*
+ * Key of the box in a space-filling curve covering the extent. The key is
+ * computed from the center of the box in the dimensions shared by the box
+ * and the extent.
+ */
+static int64
+tbox_spacefill_key(const TBOX *box, const TBOX *extent, bool hilbert)
+{
+	double coords[2];
+	int n = 0;
+	if (MOBDB_FLAGS_GET_X(box->flags) && MOBDB_FLAGS_GET_X(extent->flags))
+		coords[n++] = spacefill_coord((box->xmin + box->xmax) / 2, 
+			extent->xmin, extent->xmax);
+	if (MOBDB_FLAGS_GET_T(box->flags) && MOBDB_FLAGS_GET_T(extent->flags))
+		coords[n++] = spacefill_coord(((double) box->tmin + 
+			(double) box->tmax) / 2, (double) extent->tmin, 
+			(double) extent->tmax);
+	if (n == 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The box and the extent must have at least one common dimension")));
+	return spacefill_key(coords, n, hilbert);
+}
+
+PG_FUNCTION_INFO_V1(tbox_zorder_key);
+
+PGDLLEXPORT Datum
+tbox_zorder_key(PG_FUNCTION_ARGS)
+{
+	TBOX *box = PG_GETARG_TBOX_P(0);
+	TBOX *extent = PG_GETARG_TBOX_P(1);
+	PG_RETURN_INT64(tbox_spacefill_key(box, extent, false));
+}
+
+PG_FUNCTION_INFO_V1(tbox_hilbert_key);
+
+PGDLLEXPORT Datum
+tbox_hilbert_key(PG_FUNCTION_ARGS)
+{
+	TBOX *box = PG_GETARG_TBOX_P(0);
+	TBOX *extent = PG_GETARG_TBOX_P(1);
+	PG_RETURN_INT64(tbox_spacefill_key(box, extent, true));
+}
+
+/*****************************************************************************/
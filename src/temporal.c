@@ -17,6 +17,7 @@
 #include <access/htup_details.h>
 #include <access/tuptoaster.h>
 #include <catalog/namespace.h>
+#include <funcapi.h>
 #include <libpq/pqformat.h>
 #include <utils/builtins.h>
 #include <utils/fmgroids.h>
@@ -24,9 +25,13 @@
 #include <utils/rel.h>
 #include <utils/timestamp.h>
 
+#include "period.h"
+#include "timeops.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_expanded.h"
+#include "temporal_compress.h"
 #include "temporal_boxops.h"
 #include "temporal_parser.h"
 #include "rangetypes_ext.h"
@@ -138,6 +143,23 @@ temporal_copy(Temporal *temp)
 	return result;
 }
 
+/*
+ * Returns true if the two temporal values have the same binary representation,
+ * in which case they are equal. This is the common case when comparing values
+ * built in the same way, e.g., when deduplicating re-ingested data. The values
+ * may be equal even if the result is false, e.g., when only one of them has
+ * a precomputed trajectory or their padding bytes differ, so that the caller
+ * must then compare them value by value.
+ */
+bool
+temporal_identical(const void *t1, const void *t2)
+{
+	if (t1 == t2)
+		return true;
+	size_t size = VARSIZE(t1);
+	return size == VARSIZE(t2) && memcmp(t1, t2, size) == 0;
+}
+
 /* 
  * intersection two temporal values
  * Returns false if the values do not overlap on time
@@ -438,6 +460,13 @@ base_oid_from_temporal(Oid temptypid)
  * Trajectory functions
  *****************************************************************************/
 
+/* 
+ * Value of the mobilitydb.precompute_trajectory parameter. When it is
+ * disabled the trajectory is not stored in the temporal point sequences 
+ * and is computed on demand.
+ */
+bool precompute_trajectory = true;
+
 /**
  * @brief Returns true if the temporal type corresponding to the Oid of the 
  *		base type has its trajectory precomputed 
@@ -446,8 +475,8 @@ bool
 type_has_precomputed_trajectory(Oid valuetypid) 
 {
 #ifdef WITH_POSTGIS
-	if (valuetypid == type_oid(T_GEOMETRY) || 
-		valuetypid == type_oid(T_GEOGRAPHY))
+	if (precompute_trajectory && (valuetypid == type_oid(T_GEOMETRY) || 
+		valuetypid == type_oid(T_GEOGRAPHY)))
 		return true;
 #endif
 	return false;
@@ -1036,6 +1065,256 @@ temporal_append_instant(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+PG_FUNCTION_INFO_V1(temporal_append_instants);
+/**
+ * @brief Append an array of instants with increasing timestamps to the end
+ * 		of a temporal value, which is copied only once
+ */
+PGDLLEXPORT Datum
+temporal_append_instants(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+	int count;
+	TemporalInst **instants = (TemporalInst **)temporalarr_extract(array, &count);
+	for (int i = 0; i < count; i++)
+	{
+		if (instants[i]->duration != TEMPORALINST) 
+			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), 
+				errmsg("The second argument must be an array of instants")));
+		assert(temp->valuetypid == instants[i]->valuetypid);
+	}
+
+	Temporal *result = NULL;
+	ensure_valid_duration(temp->duration);
+	if (count == 0)
+		result = temporal_copy(temp);
+	else if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI) 
+	{
+		int n = (temp->duration == TEMPORALINST) ? 1 : ((TemporalI *)temp)->count;
+		TemporalInst **allinstants = palloc(sizeof(TemporalInst *) * (n + count));
+		if (temp->duration == TEMPORALINST)
+			allinstants[0] = (TemporalInst *)temp;
+		else
+			for (int i = 0; i < n; i++)
+				allinstants[i] = temporali_inst_n((TemporalI *)temp, i);
+		memcpy(&allinstants[n], instants, sizeof(TemporalInst *) * count);
+		result = (Temporal *)temporali_from_temporalinstarr(allinstants, n + count);
+		pfree(allinstants);
+	}
+	else if (temp->duration == TEMPORALSEQ) 
+		result = (Temporal *)temporalseq_append_instants((TemporalSeq *)temp,
+			instants, count);
+	else if (temp->duration == TEMPORALS) 
+		result = (Temporal *)temporals_append_instants((TemporalS *)temp,
+			instants, count);
+
+	pfree(instants);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_FREE_IF_COPY(array, 1);
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Merge function
+ ****************************************************************************/
+
+/* 
+ * Position of the next sequence of a fragment in the heap used for merging
+ * the fragments by start time
+ */
+typedef struct
+{
+	TemporalS  *ts;		/* Fragment */
+	int			next;	/* Position of the next sequence of the fragment */
+} TemporalMergeItem;
+
+static bool
+temporal_merge_lt(TemporalMergeItem *item1, TemporalMergeItem *item2)
+{
+	return period_cmp_internal(&temporals_seq_n(item1->ts, item1->next)->period,
+		&temporals_seq_n(item2->ts, item2->next)->period) < 0;
+}
+
+static void
+temporal_merge_siftdown(TemporalMergeItem *heap, int count, int i)
+{
+	while (true)
+	{
+		int min = i, left = 2 * i + 1, right = 2 * i + 2;
+		if (left < count && temporal_merge_lt(&heap[left], &heap[min]))
+			min = left;
+		if (right < count && temporal_merge_lt(&heap[right], &heap[min]))
+			min = right;
+		if (min == i)
+			return;
+		TemporalMergeItem item = heap[i];
+		heap[i] = heap[min];
+		heap[min] = item;
+		i = min;
+	}
+}
+
+/* Comparator of the fragments by their bounding period */
+
+static int
+temporals_period_cmp(const void *ts1, const void *ts2)
+{
+	return period_cmp_internal(&(*(TemporalS **) ts1)->period, 
+		&(*(TemporalS **) ts2)->period);
+}
+
+/*
+ * Merge an array of temporal values into a single one. When the fragments
+ * overlap in time, the value of the fragment that comes first or last in 
+ * the array is kept at the timestamps they share, depending on the argument
+ * last. The sequences of the fragments are then merged by start time with a
+ * heap of the fragments and the result is normalized once.
+ */
+TemporalS *
+temporal_merge_internal(Temporal **temparr, int count, bool last)
+{
+	/* Determine the interpolation and transform the fragments into
+	 * sequence sets */
+	Oid valuetypid = temparr[0]->valuetypid;
+	bool linear = linear_interpolation(valuetypid);
+	bool hasseq = false;
+	for (int i = 0; i < count; i++)
+	{
+		ensure_valid_duration(temparr[i]->duration);
+		if (temparr[i]->duration == TEMPORALSEQ || 
+			temparr[i]->duration == TEMPORALS)
+		{
+			bool linear1 = MOBDB_FLAGS_GET_LINEAR(temparr[i]->flags);
+			if (hasseq && linear1 != linear)
+				ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+					errmsg("Input sequences must have the same interpolation")));
+			linear = linear1;
+			hasseq = true;
+		}
+	}
+	TemporalS **frags = palloc(sizeof(TemporalS *) * count);
+	for (int i = 0; i < count; i++)
+	{
+		Temporal *temp = temparr[i];
+		if (temp->duration == TEMPORALINST)
+			frags[i] = temporalinst_to_temporals((TemporalInst *)temp, linear);
+		else if (temp->duration == TEMPORALI)
+			frags[i] = temporali_to_temporals((TemporalI *)temp, linear);
+		else if (temp->duration == TEMPORALSEQ)
+			frags[i] = temporalseq_to_temporals((TemporalSeq *)temp);
+		else /* temp->duration == TEMPORALS */
+			frags[i] = (TemporalS *)temp;
+	}
+
+	/* Test whether the bounding periods of the fragments overlap */
+	TemporalS **sorted = palloc(sizeof(TemporalS *) * count);
+	memcpy(sorted, frags, sizeof(TemporalS *) * count);
+	qsort(sorted, count, sizeof(TemporalS *), temporals_period_cmp);
+	bool overlap = false;
+	for (int i = 1; i < count && !overlap; i++)
+		overlap = overlaps_period_period_internal(&sorted[i - 1]->period,
+			&sorted[i]->period);
+	pfree(sorted);
+
+	/* Remove from each fragment the time covered by the fragments that 
+	 * take precedence over it */
+	TemporalS **pieces = frags;
+	if (overlap)
+	{
+		pieces = palloc(sizeof(TemporalS *) * count);
+		PeriodSet *covered = NULL;
+		for (int j = 0; j < count; j++)
+		{
+			int i = last ? count - 1 - j : j;
+			PeriodSet *ps = temporals_get_time(frags[i]);
+			if (covered == NULL)
+			{
+				pieces[i] = frags[i];
+				covered = ps;
+				continue;
+			}
+			pieces[i] = temporals_minus_periodset(frags[i], covered);
+			PeriodSet *newcovered = union_periodset_periodset_internal(covered, ps);
+			pfree(covered); pfree(ps);
+			covered = newcovered;
+		}
+		pfree(covered);
+	}
+
+	/* Merge the sequences of the fragments by start time */
+	TemporalMergeItem *heap = palloc(sizeof(TemporalMergeItem) * count);
+	int heapcount = 0, totalcount = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (pieces[i] == NULL)
+			continue;
+		heap[heapcount].ts = pieces[i];
+		heap[heapcount++].next = 0;
+		totalcount += pieces[i]->count;
+	}
+	for (int i = heapcount / 2 - 1; i >= 0; i--)
+		temporal_merge_siftdown(heap, heapcount, i);
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * totalcount);
+	int k = 0;
+	while (heapcount > 0)
+	{
+		sequences[k++] = temporals_seq_n(heap[0].ts, heap[0].next);
+		if (++heap[0].next == heap[0].ts->count)
+			heap[0] = heap[--heapcount];
+		temporal_merge_siftdown(heap, heapcount, 0);
+	}
+	TemporalS *result = temporals_from_temporalseqarr(sequences, k, linear, 
+		true);
+
+	for (int i = 0; i < count; i++)
+	{
+		if (pieces != frags && pieces[i] != NULL && pieces[i] != frags[i])
+			pfree(pieces[i]);
+		if (frags[i] != (TemporalS *)temparr[i])
+			pfree(frags[i]);
+	}
+	if (pieces != frags)
+		pfree(pieces);
+	pfree(frags); pfree(heap); pfree(sequences);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_merge);
+/**
+ * @brief Merge an array of temporal values, the optional second argument
+ * 		states whether the first or the last value in the array is kept
+ * 		where they overlap
+ */
+PGDLLEXPORT Datum
+temporal_merge(PG_FUNCTION_ARGS)
+{
+	ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+	bool last = true;
+	if (PG_NARGS() > 1)
+	{
+		char *policy = text_to_cstring(PG_GETARG_TEXT_P(1));
+		if (pg_strcasecmp(policy, "first") == 0)
+			last = false;
+		else if (pg_strcasecmp(policy, "last") != 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+				errmsg("The merge policy must be either 'first' or 'last'")));
+		pfree(policy);
+	}
+	int count;
+	Temporal **temparr = temporalarr_extract(array, &count);
+	if (count == 0)
+	{
+		pfree(temparr);
+		PG_FREE_IF_COPY(array, 0);
+		PG_RETURN_NULL();
+	}
+	TemporalS *result = temporal_merge_internal(temparr, count, last);
+	pfree(temparr);
+	PG_FREE_IF_COPY(array, 0);
+	PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************
  * Cast functions
  *****************************************************************************/
@@ -1059,17 +1338,35 @@ tint_to_tfloat_internal(Temporal *temp)
 	return result;
 }
 
+/**
+ * @brief Cast the temporal integer value as a temporal float value,
+ *		overwriting the value (dispatch function)
+ */
+void
+tint_to_tfloat_inplace(Temporal *temp)
+{
+	if (temp->duration == TEMPORALINST) 
+		tintinst_to_tfloatinst_inplace((TemporalInst *)temp);
+	else if (temp->duration == TEMPORALI) 
+		tinti_to_tfloati_inplace((TemporalI *)temp);
+	else if (temp->duration == TEMPORALSEQ) 
+		tintseq_to_tfloatseq_inplace((TemporalSeq *)temp);
+	else if (temp->duration == TEMPORALS) 
+		tints_to_tfloats_inplace((TemporalS *)temp);
+}
+
 PG_FUNCTION_INFO_V1(tint_to_tfloat);
 /**
  * @brief Cast the temporal integer value as a temporal float value
+ *
+ * The cast is done in place in an expanded value, see temporal_expanded.c
  */
 PGDLLEXPORT Datum
 tint_to_tfloat(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	Temporal *result = tint_to_tfloat_internal(temp);
-	PG_FREE_IF_COPY(temp, 0);
-	PG_RETURN_POINTER(result);
+	ExpandedTemporal *et = temporal_expand_rw(PG_GETARG_DATUM(0));
+	tint_to_tfloat_inplace(et->temp);
+	PG_RETURN_EXPANDED_TEMPORAL(et);
 }
 
 
@@ -1123,6 +1420,120 @@ temporal_period(Period *p, Temporal *temp)
 		temporals_period(p, (TemporalS *)temp);
 }
 
+/* Size of the fixed part of the temporal types that is fetched when only the
+ * bounding period of a temporal instant or sequence is needed */
+#define TEMPORAL_HEADER_SLICE	(offsetof(TemporalSeq, offsets) - VARHDRSZ)
+
+/**
+ * @brief Returns the bounding period of a possibly toasted temporal value 
+ * 		without detoasting it completely when possible
+ * @note The timestamp of a temporal instant and the period of a temporal 
+ * 		sequence are located in the fixed part of the structure. In these 
+ * 		cases only the first bytes of the value are fetched.
+ */
+void
+temporal_period_slice(Datum tempdatum, Period *p)
+{
+	Temporal *temp = (Temporal *) DatumGetPointer(tempdatum);
+	if (VARATT_IS_EXTENDED(temp))
+		temp = (Temporal *) PG_DETOAST_DATUM_SLICE(tempdatum, 0, 
+			TEMPORAL_HEADER_SLICE);
+	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALSEQ)
+		temporal_period(p, temp);
+	else
+	{
+		Temporal *full = DatumGetTemporal(tempdatum);
+		temporal_period(p, full);
+		if (full != (Temporal *) DatumGetPointer(tempdatum))
+			pfree(full);
+	}
+	if (temp != (Temporal *) DatumGetPointer(tempdatum))
+		pfree(temp);
+}
+
+/**
+ * @brief Copy in the second argument the bounding box of a possibly toasted
+ * 		temporal value fetching only the slices of the value containing its 
+ * 		header, its offsets, and its bounding box when possible
+ * @return Number of bytes of the value that have been fetched
+ * @note The bounding box of the temporal values of duration distinct from
+ * 		TemporalInst is located after the data, or after the fixed part of 
+ * 		the compressed values. Since a temporal instant is
+ * 		small and does not store its bounding box, it is fetched completely.
+ */
+size_t
+temporal_bbox_slice(Datum tempdatum, void *box)
+{
+	Temporal *temp = (Temporal *) DatumGetPointer(tempdatum);
+	if (! VARATT_IS_EXTENDED(temp))
+	{
+		temporal_bbox(box, temp);
+		return VARSIZE(temp);
+	}
+
+	Temporal *header = (Temporal *) PG_DETOAST_DATUM_SLICE(tempdatum, 0, 
+		TEMPORAL_HEADER_SLICE);
+	size_t result;
+	if (header->duration == TEMPORALINST)
+	{
+		Temporal *full = DatumGetTemporal(tempdatum);
+		temporal_bbox(box, full);
+		result = VARSIZE(full);
+		pfree(full);
+	}
+	else
+	{
+		/* Fetch the fixed part and the offsets to locate the bounding box */
+		size_t fixedsize;
+		int32 count, noffsets;
+		if (header->duration == TEMPORALI)
+		{
+			fixedsize = offsetof(TemporalI, offsets);
+			count = ((TemporalI *) header)->count;
+			noffsets = count + 1;
+		}
+		else if (header->duration == TEMPORALSEQ)
+		{
+			fixedsize = offsetof(TemporalSeq, offsets);
+			count = ((TemporalSeq *) header)->count;
+			noffsets = count + 2;
+		}
+		else
+		{
+			fixedsize = offsetof(TemporalS, offsets);
+			count = ((TemporalS *) header)->count;
+			noffsets = count + 1;
+		}
+		size_t bboxsize = temporal_bbox_size(header->valuetypid);
+		size_t bboxoffset;
+		if (MOBDB_FLAGS_GET_COMPRESSED(header->flags))
+		{
+			/* The bounding box of a compressed value follows the fixed part */
+			bboxoffset = fixedsize;
+			result = 0;
+		}
+		else
+		{
+			size_t datasize = fixedsize + 
+				TEMPORAL_OFFSETS_SIZE(header->flags, noffsets);
+			struct varlena *prefix = PG_DETOAST_DATUM_SLICE(tempdatum, 0, 
+				datasize - VARHDRSZ);
+			void *offsets = (char *) prefix + fixedsize;
+			bboxoffset = datasize + 
+				TEMPORAL_OFFSET_GET(offsets, header->flags, count);
+			result = VARSIZE(prefix);
+			pfree(prefix);
+		}
+		struct varlena *bbox = PG_DETOAST_DATUM_SLICE(tempdatum, 
+			bboxoffset - VARHDRSZ, bboxsize);
+		memcpy(box, VARDATA(bbox), bboxsize);
+		result += VARSIZE(bbox);
+		pfree(bbox);
+	}
+	pfree(header);
+	return result;
+}
+
 PG_FUNCTION_INFO_V1(temporal_to_period);
 /**
  * @brief Returns the bounding period on which the temporal value is defined
@@ -1130,10 +1541,8 @@ PG_FUNCTION_INFO_V1(temporal_to_period);
 PGDLLEXPORT Datum
 temporal_to_period(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	Period *result = (Period *) palloc(sizeof(Period));
-	temporal_period(result, temp);
-	PG_FREE_IF_COPY(temp, 0);
+	temporal_period_slice(PG_GETARG_DATUM(0), result);
 	PG_RETURN_PERIOD(result);
 }
 
@@ -1327,6 +1736,127 @@ temporal_mem_size(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(result);
 }
 
+PG_FUNCTION_INFO_V1(temporal_format_version);
+/**
+ * @brief Returns the version of the on-disk format of the temporal value
+ */
+PGDLLEXPORT Datum
+temporal_format_version(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	int result = 2;
+	if (temp->duration != TEMPORALINST)
+		result = TEMPORAL_FORMAT_VERSION(temp->flags);
+	if (temp->duration == TEMPORALS)
+	{
+		/* The sequences may have been written in version 1 even if the 
+		 * sequence set has been written in version 2 */
+		TemporalS *ts = (TemporalS *) temp;
+		for (int i = 0; i < ts->count && result == 2; i++)
+			result = TEMPORAL_FORMAT_VERSION(temporals_seq_n(ts, i)->flags);
+	}
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_INT32(result);
+}
+
+/*
+ * Rewrite a temporal sequence written in version 1 of the on-disk format 
+ * in version 2. The instants are kept as they are.
+ */
+static TemporalSeq *
+temporalseq_upgrade(TemporalSeq *seq)
+{
+	if (MOBDB_FLAGS_GET_OFFSETS32(seq->flags))
+		return temporalseq_copy(seq);
+	TemporalInst **instants = temporalseq_instants(seq);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, 
+		seq->count, seq->period.lower_inc, seq->period.upper_inc, 
+		MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
+	pfree(instants);
+	return result;
+}
+
+/**
+ * @brief Returns the temporal value written in the current version of the
+ * 		on-disk format, i.e., with 32-bit offsets
+ * @note The values written by previous releases are read without conversion.
+ * 		This function allows to rewrite them to reduce their size, e.g., with
+ * 		UPDATE tbl SET temp = upgrade(temp).
+ */
+Temporal *
+temporal_upgrade_internal(Temporal *temp)
+{
+	Temporal *result;
+	if (temp->duration == TEMPORALINST)
+		result = temporal_copy(temp);
+	else if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *) temp;
+		if (MOBDB_FLAGS_GET_OFFSETS32(ti->flags))
+			result = temporal_copy(temp);
+		else
+		{
+			TemporalInst **instants = temporali_instants(ti);
+			result = (Temporal *) temporali_from_temporalinstarr(instants, 
+				ti->count);
+			pfree(instants);
+		}
+	}
+	else if (temp->duration == TEMPORALSEQ)
+		result = (Temporal *) temporalseq_upgrade((TemporalSeq *) temp);
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+		for (int i = 0; i < ts->count; i++)
+			sequences[i] = temporalseq_upgrade(temporals_seq_n(ts, i));
+		result = (Temporal *) temporals_from_temporalseqarr(sequences, 
+			ts->count, MOBDB_FLAGS_GET_LINEAR(ts->flags), false);
+		for (int i = 0; i < ts->count; i++)
+			pfree(sequences[i]);
+		pfree(sequences);
+	}
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_upgrade);
+/**
+ * @brief Returns the temporal value written in the current version of the
+ * 		on-disk format
+ */
+PGDLLEXPORT Datum
+temporal_upgrade(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Temporal *result = temporal_upgrade_internal(temp);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_POINTER(result);
+}
+
+/**
+ * @brief Returns the distinct values taken by the temporal value as a sorted
+ *		array of datums that point into the temporal value (dispatch function)
+ */
+Datum *
+temporal_values1(Temporal *temp, int *count)
+{
+	Datum *result = NULL;	/* make the compiler quiet */
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+	{
+		result = palloc(sizeof(Datum));
+		result[0] = temporalinst_value((TemporalInst *)temp);
+		*count = 1;
+	}
+	else if (temp->duration == TEMPORALI)
+		result = temporali_values1((TemporalI *)temp, count);
+	else if (temp->duration == TEMPORALSEQ)
+		result = temporalseq_values1((TemporalSeq *)temp, count);
+	else if (temp->duration == TEMPORALS)
+		result = temporals_values1((TemporalS *)temp, count);
+	return result;
+}
+
 /**
  * @brief Returns the values taken by the temporal value (dispatch function)
  */
@@ -1671,50 +2201,137 @@ temporal_max_value(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_timespan);
-/**
- * @brief Returns the timespan of the temporal value
+/* 
+ * Minimum and maximum values of the temporal number restricted to a 
+ * period. Returns false if the restriction is empty.
  */
-PGDLLEXPORT Datum
-temporal_timespan(PG_FUNCTION_ARGS)
+static bool
+tnumber_minmax_period_internal(Temporal *temp, Period *p, double *min,
+	double *max)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	Datum result = 0;
+	bool found = true;
 	ensure_valid_duration(temp->duration);
-	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI) 
+	if (temp->duration == TEMPORALINST)
 	{
-		Interval *interval = (Interval *) palloc(sizeof(Interval));
-		interval->month = interval->day =  0;
-		interval->time = (TimeOffset) 0;
-		result = PointerGetDatum(interval);
+		found = temporalinst_intersects_period((TemporalInst *)temp, p);
+		*min = *max = datum_double(temporalinst_value((TemporalInst *)temp),
+			temp->valuetypid);
 	}
-	else if (temp->duration == TEMPORALSEQ) 
-		result = temporalseq_timespan((TemporalSeq *)temp);
-	else if (temp->duration == TEMPORALS) 
-		result = temporals_timespan((TemporalS *)temp);
-	PG_FREE_IF_COPY(temp, 0);
-	PG_RETURN_DATUM(result);
+	else if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = temporali_at_period((TemporalI *)temp, p);
+		found = ti != NULL;
+		if (found)
+		{
+			*min = datum_double(temporali_min_value(ti), temp->valuetypid);
+			*max = datum_double(temporali_max_value(ti), temp->valuetypid);
+			pfree(ti);
+		}
+	}
+	else if (temp->duration == TEMPORALSEQ)
+		tnumberseq_minmax_period((TemporalSeq *)temp, p, min, max);
+	else if (temp->duration == TEMPORALS)
+		found = tnumbers_minmax_period((TemporalS *)temp, p, min, max);
+	return found;
 }
 
-PG_FUNCTION_INFO_V1(temporal_num_sequences);
+PG_FUNCTION_INFO_V1(tnumber_min_value_period);
 /**
- * @brief Returns the number of sequences of the temporal sequence (set) value
+ * @brief Returns the minimum value of the temporal numeric value restricted
+ * to a period, or NULL if the restriction is empty. Long sequences compute
+ * it from their block summary without restricting the value.
  */
 PGDLLEXPORT Datum
-temporal_num_sequences(PG_FUNCTION_ARGS)
+tnumber_min_value_period(PG_FUNCTION_ARGS)
 {
+	Period *p = PG_GETARG_PERIOD(1);
+	/* Bounding period test without detoasting the whole value */
+	Period p1;
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	if (!overlaps_period_period_internal(&p1, p))
+		PG_RETURN_NULL();
 	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	if (temp->duration != TEMPORALSEQ && temp->duration != TEMPORALS)
-		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-			errmsg("Input must be a temporal sequence (set)")));
-
-	int result = 1;
-	if (temp->duration == TEMPORALS)
-		result = ((TemporalS *)temp)->count;
+	Oid valuetypid = temp->valuetypid;
+	double min, max;
+	bool found = tnumber_minmax_period_internal(temp, p, &min, &max);
 	PG_FREE_IF_COPY(temp, 0);
-	PG_RETURN_INT32(result);
-}
-
+	if (!found)
+		PG_RETURN_NULL();
+	if (valuetypid == INT4OID)
+		PG_RETURN_INT32((int) min);
+	PG_RETURN_FLOAT8(min);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_max_value_period);
+/**
+ * @brief Returns the maximum value of the temporal numeric value restricted
+ * to a period, or NULL if the restriction is empty
+ */
+PGDLLEXPORT Datum
+tnumber_max_value_period(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(1);
+	/* Bounding period test without detoasting the whole value */
+	Period p1;
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	if (!overlaps_period_period_internal(&p1, p))
+		PG_RETURN_NULL();
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Oid valuetypid = temp->valuetypid;
+	double min, max;
+	bool found = tnumber_minmax_period_internal(temp, p, &min, &max);
+	PG_FREE_IF_COPY(temp, 0);
+	if (!found)
+		PG_RETURN_NULL();
+	if (valuetypid == INT4OID)
+		PG_RETURN_INT32((int) max);
+	PG_RETURN_FLOAT8(max);
+}
+
+PG_FUNCTION_INFO_V1(temporal_timespan);
+/**
+ * @brief Returns the timespan of the temporal value
+ */
+PGDLLEXPORT Datum
+temporal_timespan(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Datum result = 0;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI) 
+	{
+		Interval *interval = (Interval *) palloc(sizeof(Interval));
+		interval->month = interval->day =  0;
+		interval->time = (TimeOffset) 0;
+		result = PointerGetDatum(interval);
+	}
+	else if (temp->duration == TEMPORALSEQ) 
+		result = temporalseq_timespan((TemporalSeq *)temp);
+	else if (temp->duration == TEMPORALS) 
+		result = temporals_timespan((TemporalS *)temp);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_DATUM(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_num_sequences);
+/**
+ * @brief Returns the number of sequences of the temporal sequence (set) value
+ */
+PGDLLEXPORT Datum
+temporal_num_sequences(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	if (temp->duration != TEMPORALSEQ && temp->duration != TEMPORALS)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("Input must be a temporal sequence (set)")));
+
+	int result = 1;
+	if (temp->duration == TEMPORALS)
+		result = ((TemporalS *)temp)->count;
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_INT32(result);
+}
+
 PG_FUNCTION_INFO_V1(temporal_start_sequence);
 /**
  * @brief Returns the start sequence of the temporal sequence (set) value
@@ -1888,6 +2505,112 @@ temporal_end_instant(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*
+ * Temporal value kept across calls in fn_extra. When the value is stored 
+ * out of line, its detoasted copy is kept together with the toast pointer
+ * that identifies it, so that successive calls on the same value, e.g., in
+ * a LATERAL join or in a loop of a PL/pgSQL function, only detoast it once.
+ */
+typedef struct 
+{
+	struct varatt_external toast_pointer;	/* Identifies the cached value */
+	Temporal *temp;		/* Detoasted value allocated in fn_mcxt */
+} TemporalCache;
+
+/*
+ * Get the temporal value from the cache if it is the one stored out of line
+ * given as first argument, or detoast it and keep it in the cache otherwise.
+ * Values that are not stored out of line are detoasted as usual, and the
+ * argument tofree states whether the result must be freed by the caller. 
+ * The argument loaded states whether a new value was put in the cache, in
+ * which case the state derived from the previous value must be reset.
+ */
+static Temporal *
+temporal_get_cached(FunctionCallInfo fcinfo, TemporalCache *cache,
+	bool *tofree, bool *loaded)
+{
+	struct varlena *raw = (struct varlena *) DatumGetPointer(PG_GETARG_DATUM(0));
+	*tofree = *loaded = false;
+	if (! VARATT_IS_EXTERNAL_ONDISK(raw))
+	{
+		Temporal *temp = PG_GETARG_TEMPORAL(0);
+		*tofree = ((Pointer) temp != (Pointer) raw);
+		return temp;
+	}
+
+	struct varatt_external toast_pointer;
+	VARATT_EXTERNAL_GET_POINTER(toast_pointer, raw);
+	if (cache->temp == NULL || memcmp(&toast_pointer, &cache->toast_pointer,
+		sizeof(struct varatt_external)) != 0)
+	{
+		MemoryContext oldcontext = MemoryContextSwitchTo(fcinfo->flinfo->fn_mcxt);
+		Temporal *temp = temporal_detoast_uncompressed(PG_GETARG_DATUM(0));
+		MemoryContextSwitchTo(oldcontext);
+		if (cache->temp != NULL)
+			pfree(cache->temp);
+		cache->temp = temp;
+		cache->toast_pointer = toast_pointer;
+		*loaded = true;
+	}
+	return cache->temp;
+}
+
+/*
+ * State of the functions instantN and timestampN kept across calls in 
+ * fn_extra. For temporal sequence sets, the cumulative counts of the
+ * distinct instants or timestamps of the sequences of a value stored out
+ * of line are computed once, so that the following calls for the same 
+ * value find the sequence with a binary search.
+ */
+typedef struct 
+{
+	TemporalCache value;	/* Value of the last call */
+	int *counts;		/* Cumulative counts of the sequences, if any */
+} TemporalCountsCache;
+
+/*
+ * Get the temporal sequence set given as first argument and the cumulative 
+ * counts of its sequences computed by the function, or NULL if the value is
+ * not stored out of line, in which case it is read sequentially. 
+ */
+static Temporal *
+temporal_get_counts(FunctionCallInfo fcinfo, 
+	void (*func)(TemporalS *, int *), bool *tofree, int **counts)
+{
+	*counts = NULL;
+	if (fcinfo->flinfo == NULL)
+	{
+		Temporal *temp = PG_GETARG_TEMPORAL(0);
+		*tofree = ((Pointer) temp != DatumGetPointer(PG_GETARG_DATUM(0)));
+		return temp;
+	}
+	TemporalCountsCache *cache = (TemporalCountsCache *) fcinfo->flinfo->fn_extra;
+	if (cache == NULL)
+	{
+		cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+			sizeof(TemporalCountsCache));
+		fcinfo->flinfo->fn_extra = cache;
+	}
+	bool loaded;
+	Temporal *temp = temporal_get_cached(fcinfo, &cache->value, tofree, &loaded);
+	if (loaded)
+	{
+		if (cache->counts != NULL)
+			pfree(cache->counts);
+		cache->counts = NULL;
+		if (temp->duration == TEMPORALS)
+		{
+			TemporalS *ts = (TemporalS *) temp;
+			cache->counts = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt,
+				sizeof(int) * ts->count);
+			func(ts, cache->counts);
+		}
+	}
+	if (temp == cache->value.temp)
+		*counts = cache->counts;
+	return temp;
+}
+
 PG_FUNCTION_INFO_V1(temporal_instant_n);
 /**
  * @brief Returns the n-th instant of the temporal value 
@@ -1895,7 +2618,10 @@ PG_FUNCTION_INFO_V1(temporal_instant_n);
 PGDLLEXPORT Datum
 temporal_instant_n(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	bool tofree;
+	int *counts;
+	Temporal *temp = temporal_get_counts(fcinfo, &temporals_instant_counts,
+		&tofree, &counts);
 	int n = PG_GETARG_INT32(1); /* Assume 1-based */
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
@@ -1920,12 +2646,15 @@ temporal_instant_n(PG_FUNCTION_ARGS)
 	{
 		if (n >= 1 && n <= ((TemporalS *)temp)->totalcount)
 		{
-			TemporalInst *inst = temporals_instant_n((TemporalS *)temp, n);
+			TemporalInst *inst = (counts != NULL) ?
+				temporals_instant_n_counts((TemporalS *)temp, counts, n) :
+				temporals_instant_n((TemporalS *)temp, n);
 			if (inst != NULL)
 				result = (Temporal *)temporalinst_copy(inst);
 		}
 	}
-	PG_FREE_IF_COPY(temp, 0);
+	if (tofree)
+		pfree(temp);
 	if (result == NULL) 
 		PG_RETURN_NULL();
 	PG_RETURN_POINTER(result);
@@ -1953,6 +2682,100 @@ temporal_instants(PG_FUNCTION_ARGS)
 	PG_RETURN_ARRAYTYPE_P(result);
 }
 
+/*
+ * State of the function returning the instants of a temporal value as rows.
+ * The temporal value is detoasted once and traversed in place, without
+ * building an array of instants.
+ */
+typedef struct
+{
+	Temporal   *temp;		/* Temporal value */
+	int			i;			/* Current sequence of a sequence set */
+	int			j;			/* Next instant of the current component */
+} TemporalUnnestState;
+
+PG_FUNCTION_INFO_V1(temporal_unnest);
+/**
+ * @brief Returns the instants of the temporal value as a set of rows 
+ * (timestamp, value, sequence number), the sequence number being null for
+ * instant and instant set durations
+ */
+PGDLLEXPORT Datum
+temporal_unnest(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		TemporalUnnestState *state = palloc0(sizeof(TemporalUnnestState));
+		state->temp = PG_GETARG_TEMPORAL(0);
+		ensure_valid_duration(state->temp->duration);
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		funcctx->user_fctx = state;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	TemporalUnnestState *state = (TemporalUnnestState *) funcctx->user_fctx;
+	Temporal *temp = state->temp;
+	TemporalInst *inst = NULL;
+	int seqno = 0;
+	if (temp->duration == TEMPORALINST)
+	{
+		if (state->j == 0)
+			inst = (TemporalInst *)temp;
+	}
+	else if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *)temp;
+		if (state->j < ti->count)
+			inst = temporali_inst_n(ti, state->j);
+	}
+	else if (temp->duration == TEMPORALSEQ)
+	{
+		TemporalSeq *seq = (TemporalSeq *)temp;
+		if (state->j < seq->count)
+		{
+			inst = temporalseq_inst_n(seq, state->j);
+			seqno = 1;
+		}
+	}
+	else if (temp->duration == TEMPORALS)
+	{
+		TemporalS *ts = (TemporalS *)temp;
+		while (state->i < ts->count)
+		{
+			TemporalSeq *seq = temporals_seq_n(ts, state->i);
+			if (state->j < seq->count)
+			{
+				inst = temporalseq_inst_n(seq, state->j);
+				seqno = state->i + 1;
+				break;
+			}
+			state->i++;
+			state->j = 0;
+		}
+	}
+	if (inst == NULL)
+		SRF_RETURN_DONE(funcctx);
+	state->j++;
+
+	Datum values[3];
+	bool nulls[3] = {false, false, false};
+	values[0] = TimestampTzGetDatum(inst->t);
+	values[1] = temporalinst_value(inst);
+	values[2] = Int32GetDatum(seqno);
+	nulls[2] = (seqno == 0);
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
 /**
  * @brief Returns the start timestamp of the temporal value (dispatch function)
  */
@@ -2036,7 +2859,10 @@ PG_FUNCTION_INFO_V1(temporal_timestamp_n);
 PGDLLEXPORT Datum
 temporal_timestamp_n(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	bool tofree;
+	int *counts;
+	Temporal *temp = temporal_get_counts(fcinfo, &temporals_timestamp_counts,
+		&tofree, &counts);
 	int n = PG_GETARG_INT32(1); /* Assume 1-based */
 	TimestampTz result;
 	bool found = false;
@@ -2066,8 +2892,11 @@ temporal_timestamp_n(PG_FUNCTION_ARGS)
 		}
 	}
 	else if (temp->duration == TEMPORALS)
-		found = temporals_timestamp_n((TemporalS *)temp, n, &result);
-	PG_FREE_IF_COPY(temp, 0);
+		found = (counts != NULL) ?
+			temporals_timestamp_n_counts((TemporalS *)temp, counts, n, &result) :
+			temporals_timestamp_n((TemporalS *)temp, n, &result);
+	if (tofree)
+		pfree(temp);
 	if (!found) 
 		PG_RETURN_NULL();
 	PG_RETURN_TIMESTAMPTZ(result);
@@ -2095,33 +2924,67 @@ temporal_timestamps(PG_FUNCTION_ARGS)
 	PG_RETURN_ARRAYTYPE_P(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_shift);
 /**
- * @brief Shift the time span of the temporal value by an interval
+ * @brief Shift the time span of the temporal value by an interval, 
+ *		overwriting the value (dispatch function)
  */
-PGDLLEXPORT Datum
-temporal_shift(PG_FUNCTION_ARGS)
+void
+temporal_shift_inplace(Temporal *temp, Interval *interval)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	Interval *interval = PG_GETARG_INTERVAL_P(1);
-	Temporal *result = false;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST) 
-		result = (Temporal *)temporalinst_shift((TemporalInst *)temp, interval);
+		temporalinst_shift_inplace((TemporalInst *)temp, interval);
 	else if (temp->duration == TEMPORALI) 
-		result = (Temporal *)temporali_shift((TemporalI *)temp, interval);
+		temporali_shift_inplace((TemporalI *)temp, interval);
 	else if (temp->duration == TEMPORALSEQ) 
-		result = (Temporal *)temporalseq_shift((TemporalSeq *)temp, interval);
+		temporalseq_shift_inplace((TemporalSeq *)temp, interval);
 	else if (temp->duration == TEMPORALS) 
-		result = (Temporal *)temporals_shift((TemporalS *)temp, interval);
-	PG_FREE_IF_COPY(temp, 0);
-	PG_RETURN_POINTER(result);
+		temporals_shift_inplace((TemporalS *)temp, interval);
+}
+
+PG_FUNCTION_INFO_V1(temporal_shift);
+/**
+ * @brief Shift the time span of the temporal value by an interval
+ *
+ * The value is shifted in place in an expanded value, see 
+ * temporal_expanded.c
+ */
+PGDLLEXPORT Datum
+temporal_shift(PG_FUNCTION_ARGS)
+{
+	ExpandedTemporal *et = temporal_expand_rw(PG_GETARG_DATUM(0));
+	Interval *interval = PG_GETARG_INTERVAL_P(1);
+	temporal_shift_inplace(et->temp, interval);
+	PG_RETURN_EXPANDED_TEMPORAL(et);
 }
 
 /*****************************************************************************
  * Ever/always comparison operators
  *****************************************************************************/
 
+/**
+ * @brief Sets the output arguments to the value extent of the precomputed 
+ *		bounding box of a temporal number and to the value as a double.
+ *		Returns false for temporal values that are not temporal numbers and
+ *		for temporal instants, for which the bounding box test is not cheaper
+ *		than the comparison itself.
+ * @note The extent bounds are the infimum and the supremum of the values, 
+ *		they may not be reached in linear sequences with exclusive bounds
+ */
+static bool
+tnumber_value_extent(const Temporal *temp, Datum value, double *xmin,
+	double *xmax, double *d)
+{
+	if (temp->duration == TEMPORALINST ||
+		(temp->valuetypid != INT4OID && temp->valuetypid != FLOAT8OID))
+		return false;
+	TBOX *box = temporal_bbox_ptr(temp);
+	*xmin = box->xmin;
+	*xmax = box->xmax;
+	*d = datum_double(value, temp->valuetypid);
+	return true;
+}
+
 /**
  * @brief Returns true if the temporal value is ever equal to a value (internal 
  *		function)
@@ -2129,8 +2992,19 @@ temporal_shift(PG_FUNCTION_ARGS)
 bool
 temporal_ever_eq_internal(Temporal *temp, Datum value)
 {
-	bool result = false;
 	ensure_valid_duration(temp->duration);
+	/* Bounding box test */
+	double xmin, xmax, d;
+	if (tnumber_value_extent(temp, value, &xmin, &xmax, &d))
+	{
+		if (d < xmin || xmax < d)
+			return false;
+		/* A constant value or a linear sequence taking the value in between */
+		if (xmin == xmax || (temp->duration == TEMPORALSEQ &&
+			MOBDB_FLAGS_GET_LINEAR(temp->flags) && xmin < d && d < xmax))
+			return true;
+	}
+	bool result = false;
 	if (temp->duration == TEMPORALINST) 
 		result = temporalinst_ever_eq((TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI) 
@@ -2164,8 +3038,12 @@ temporal_ever_eq(PG_FUNCTION_ARGS)
 bool
 temporal_always_eq_internal(Temporal *temp, Datum value)
 {
-	bool result = false;
 	ensure_valid_duration(temp->duration);
+	/* The bounding box test is enough to test the predicate */
+	double xmin, xmax, d;
+	if (tnumber_value_extent(temp, value, &xmin, &xmax, &d))
+		return xmin == xmax && d == xmin;
+	bool result = false;
 	if (temp->duration == TEMPORALINST)
 		result = temporalinst_always_eq((TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI)
@@ -2231,8 +3109,12 @@ temporal_always_ne(PG_FUNCTION_ARGS)
 bool
 temporal_ever_lt_internal(Temporal *temp, Datum value)
 {
-	bool result = false;
 	ensure_valid_duration(temp->duration);
+	/* The bounding box test is enough to test the predicate */
+	double xmin, xmax, d;
+	if (tnumber_value_extent(temp, value, &xmin, &xmax, &d))
+		return xmin < d;
+	bool result = false;
 	if (temp->duration == TEMPORALINST)
 		result = temporalinst_ever_lt((TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI)
@@ -2266,8 +3148,17 @@ temporal_ever_lt(PG_FUNCTION_ARGS)
 bool
 temporal_always_lt_internal(Temporal *temp, Datum value)
 {
-	bool result = false;
 	ensure_valid_duration(temp->duration);
+	/* Bounding box test, the maximum value may not be reached */
+	double xmin, xmax, d;
+	if (tnumber_value_extent(temp, value, &xmin, &xmax, &d))
+	{
+		if (xmax < d)
+			return true;
+		if (d < xmax)
+			return false;
+	}
+	bool result = false;
 	if (temp->duration == TEMPORALINST)
 		result = temporalinst_always_lt((TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI)
@@ -2301,8 +3192,17 @@ temporal_always_lt(PG_FUNCTION_ARGS)
 bool
 temporal_ever_le_internal(Temporal *temp, Datum value)
 {
-	bool result = false;
 	ensure_valid_duration(temp->duration);
+	/* Bounding box test, the minimum value may not be reached */
+	double xmin, xmax, d;
+	if (tnumber_value_extent(temp, value, &xmin, &xmax, &d))
+	{
+		if (d < xmin)
+			return false;
+		if (xmin < d)
+			return true;
+	}
+	bool result = false;
 	if (temp->duration == TEMPORALINST)
 		result = temporalinst_ever_le((TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI)
@@ -2337,8 +3237,12 @@ temporal_ever_le(PG_FUNCTION_ARGS)
 bool
 temporal_always_le_internal(Temporal *temp, Datum value)
 {
-	bool result = false;
 	ensure_valid_duration(temp->duration);
+	/* The bounding box test is enough to test the predicate */
+	double xmin, xmax, d;
+	if (tnumber_value_extent(temp, value, &xmin, &xmax, &d))
+		return xmax <= d;
+	bool result = false;
 	if (temp->duration == TEMPORALINST)
 		result = temporalinst_always_le((TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI)
@@ -2433,16 +3337,9 @@ temporal_always_ge(PG_FUNCTION_ARGS)
  *****************************************************************************/
 
 
-PG_FUNCTION_INFO_V1(temporal_at_value);
-/**
- * @brief Restricts the temporal value to a value
- */
-PGDLLEXPORT Datum
-temporal_at_value(PG_FUNCTION_ARGS)
+Temporal *
+temporal_at_value_internal(Temporal *temp, Datum value)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	Datum value = PG_GETARG_ANYDATUM(1);
-	Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST) 
@@ -2457,6 +3354,20 @@ temporal_at_value(PG_FUNCTION_ARGS)
 	else if (temp->duration == TEMPORALS) 
 		result = (Temporal *)temporals_at_value(
 			(TemporalS *)temp, value);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_at_value);
+/**
+ * @brief Restricts the temporal value to a value
+ */
+PGDLLEXPORT Datum
+temporal_at_value(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Datum value = PG_GETARG_ANYDATUM(1);
+	Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+	Temporal *result = temporal_at_value_internal(temp, value);
 	PG_FREE_IF_COPY(temp, 0);
 	FREE_DATUM(value, valuetypid);
 	if (result == NULL)
@@ -2610,46 +3521,239 @@ tnumber_at_range(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
-PG_FUNCTION_INFO_V1(tnumber_minus_range);
+/*****************************************************************************
+ * Restriction functions returning the time
+ * These functions return the time of the restriction of the temporal value,
+ * e.g., getTime(atRange(temp, range)), computing its periods directly
+ * without constructing the restriction.
+ *****************************************************************************/
+
+/* Initialize a builder for the periods of the time of the temporal value */
+
+static void
+temporal_when_build_init(PeriodSetBuilder *builder, Temporal *temp)
+{
+	int maxcount = 1;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALI)
+		maxcount = ((TemporalI *)temp)->count;
+	else if (temp->duration == TEMPORALSEQ)
+		maxcount = ((TemporalSeq *)temp)->count + 1;
+	else if (temp->duration == TEMPORALS)
+		maxcount = ((TemporalS *)temp)->totalcount + 
+			((TemporalS *)temp)->count;
+	periodset_build_init(builder, maxcount);
+}
+
 /**
- * @brief Restricts the temporal value to the complement of a range of values
+ * @brief Returns the time during which the temporal value is equal to the 
+ *		value (dispatch function)
  */
-PGDLLEXPORT Datum
-tnumber_minus_range(PG_FUNCTION_ARGS)
+PeriodSet *
+temporal_when_at_value_internal(Temporal *temp, Datum value)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	RangeType *range = PG_GETARG_RANGE_P(1);
-	Temporal *result = NULL;
-	ensure_valid_duration(temp->duration);
+	PeriodSetBuilder builder;
+	temporal_when_build_init(&builder, temp);
 	if (temp->duration == TEMPORALINST) 
-		result = (Temporal *)tnumberinst_minus_range(
-			(TemporalInst *)temp, range);
+		temporalinst_when_at_value(&builder, (TemporalInst *)temp, value);
 	else if (temp->duration == TEMPORALI) 
-		result = (Temporal *)tnumberi_minus_range(
-			(TemporalI *)temp, range);
+		temporali_when_at_value(&builder, (TemporalI *)temp, value);
 	else if (temp->duration == TEMPORALSEQ) 
-		result = (Temporal *)tnumberseq_minus_range(
-			(TemporalSeq *)temp, range);
+		temporalseq_when_at_value(&builder, (TemporalSeq *)temp, value);
 	else if (temp->duration == TEMPORALS) 
-		result = (Temporal *)tnumbers_minus_range(
-			(TemporalS *)temp, range);
+		temporals_when_at_value(&builder, (TemporalS *)temp, value);
+	return periodset_build_finish(&builder);
+}
+
+/**
+ * @brief Returns the time during which the temporal value is in the range 
+ *		(dispatch function)
+ */
+PeriodSet *
+tnumber_when_at_range_internal(Temporal *temp, RangeType *range)
+{
+	PeriodSetBuilder builder;
+	temporal_when_build_init(&builder, temp);
+	if (temp->duration == TEMPORALINST) 
+		tnumberinst_when_at_range(&builder, (TemporalInst *)temp, range);
+	else if (temp->duration == TEMPORALI) 
+		tnumberi_when_at_range(&builder, (TemporalI *)temp, range);
+	else if (temp->duration == TEMPORALSEQ) 
+		tnumberseq_when_at_range(&builder, (TemporalSeq *)temp, range);
+	else if (temp->duration == TEMPORALS) 
+		tnumbers_when_at_range(&builder, (TemporalS *)temp, range);
+	return periodset_build_finish(&builder);
+}
+
+PG_FUNCTION_INFO_V1(temporal_when_at_value);
+/**
+ * @brief Returns the time during which the temporal value is equal to the
+ *		value
+ */
+PGDLLEXPORT Datum
+temporal_when_at_value(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Datum value = PG_GETARG_ANYDATUM(1);
+	Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+	PeriodSet *result = temporal_when_at_value_internal(temp, value);
 	PG_FREE_IF_COPY(temp, 0);
-	PG_FREE_IF_COPY(range, 1);
+	FREE_DATUM(value, valuetypid);
 	if (result == NULL)
 		PG_RETURN_NULL();
 	PG_RETURN_POINTER(result);
 }
 
-PG_FUNCTION_INFO_V1(tnumber_at_ranges);
+PG_FUNCTION_INFO_V1(tbool_when_true);
 /**
- * @brief Restricts the temporal value to an array of range values
+ * @brief Returns the time during which the temporal boolean is true
  */
 PGDLLEXPORT Datum
-tnumber_at_ranges(PG_FUNCTION_ARGS)
+tbool_when_true(PG_FUNCTION_ARGS)
 {
 	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
-	int count;
+	PeriodSet *result = temporal_when_at_value_internal(temp, 
+		BoolGetDatum(true));
+	PG_FREE_IF_COPY(temp, 0);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_when_at_range);
+/**
+ * @brief Returns the time during which the temporal number is in the range
+ */
+PGDLLEXPORT Datum
+tnumber_when_at_range(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	RangeType *range = PG_GETARG_RANGE_P(1);
+	PeriodSet *result = tnumber_when_at_range_internal(temp, range);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_FREE_IF_COPY(range, 1);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Returns the time during which the comparison of the temporal number and 
+ * the value is true. The comparison is transformed into a range with an
+ * infinite bound, e.g., temp #> value into (value, +inf).
+ */
+static Datum
+tnumber_when_cmp(FunctionCallInfo fcinfo, bool greater, bool inclusive)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Datum value = PG_GETARG_DATUM(1);
+	Oid rangetypid = (temp->valuetypid == INT4OID) ?
+		type_oid(T_INTRANGE) : type_oid(T_FLOATRANGE);
+	TypeCacheEntry *typcache = lookup_type_cache(rangetypid, 
+		TYPECACHE_RANGE_INFO);
+	RangeBound lower, upper;
+	lower.lower = true;
+	upper.lower = false;
+	lower.val = upper.val = value;
+	lower.infinite = ! greater;
+	lower.inclusive = greater && inclusive;
+	upper.infinite = greater;
+	upper.inclusive = ! greater && inclusive;
+	RangeType *range = make_range(typcache, &lower, &upper, false);
+	PeriodSet *result = tnumber_when_at_range_internal(temp, range);
+	pfree(range);
+	PG_FREE_IF_COPY(temp, 0);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_when_lt);
+/**
+ * @brief Returns the time during which the temporal number is less than
+ *		the value
+ */
+PGDLLEXPORT Datum
+tnumber_when_lt(PG_FUNCTION_ARGS)
+{
+	return tnumber_when_cmp(fcinfo, false, false);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_when_le);
+/**
+ * @brief Returns the time during which the temporal number is less than
+ *		or equal to the value
+ */
+PGDLLEXPORT Datum
+tnumber_when_le(PG_FUNCTION_ARGS)
+{
+	return tnumber_when_cmp(fcinfo, false, true);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_when_gt);
+/**
+ * @brief Returns the time during which the temporal number is greater than
+ *		the value
+ */
+PGDLLEXPORT Datum
+tnumber_when_gt(PG_FUNCTION_ARGS)
+{
+	return tnumber_when_cmp(fcinfo, true, false);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_when_ge);
+/**
+ * @brief Returns the time during which the temporal number is greater than
+ *		or equal to the value
+ */
+PGDLLEXPORT Datum
+tnumber_when_ge(PG_FUNCTION_ARGS)
+{
+	return tnumber_when_cmp(fcinfo, true, true);
+}
+
+/*****************************************************************************/
+
+PG_FUNCTION_INFO_V1(tnumber_minus_range);
+/**
+ * @brief Restricts the temporal value to the complement of a range of values
+ */
+PGDLLEXPORT Datum
+tnumber_minus_range(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	RangeType *range = PG_GETARG_RANGE_P(1);
+	Temporal *result = NULL;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST) 
+		result = (Temporal *)tnumberinst_minus_range(
+			(TemporalInst *)temp, range);
+	else if (temp->duration == TEMPORALI) 
+		result = (Temporal *)tnumberi_minus_range(
+			(TemporalI *)temp, range);
+	else if (temp->duration == TEMPORALSEQ) 
+		result = (Temporal *)tnumberseq_minus_range(
+			(TemporalSeq *)temp, range);
+	else if (temp->duration == TEMPORALS) 
+		result = (Temporal *)tnumbers_minus_range(
+			(TemporalS *)temp, range);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_FREE_IF_COPY(range, 1);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_at_ranges);
+/**
+ * @brief Restricts the temporal value to an array of range values
+ */
+PGDLLEXPORT Datum
+tnumber_at_ranges(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	ArrayType *array = PG_GETARG_ARRAYTYPE_P(1);
+	int count;
 	RangeType **ranges = rangearr_extract(array, &count);
 	if (count == 0)
 	{
@@ -2907,6 +4011,21 @@ temporal_minus_timestamp(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*
+ * State of the function valueAtTimestamp kept across calls in fn_extra.
+ * Successive calls are frequently made on the same temporal value with
+ * increasing timestamps, e.g., in a LATERAL join. The positions found by
+ * the last call are used as a starting point for the next search. The 
+ * positions are validated before being used, so they are kept whatever the
+ * storage of the value.
+ */
+typedef struct 
+{
+	TemporalCache value;	/* Value of the last call */
+	int seqpos;			/* Sequence found by the last call */
+	int instpos;		/* Instant or segment found by the last call */
+} ValueAtTimestampCache;
+
 PG_FUNCTION_INFO_V1(temporal_value_at_timestamp);
 /**
  * @brief Returns the value taken by the temporal value at a timestamp 
@@ -2914,25 +4033,105 @@ PG_FUNCTION_INFO_V1(temporal_value_at_timestamp);
 PGDLLEXPORT Datum
 temporal_value_at_timestamp(PG_FUNCTION_ARGS)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
 	bool found = false;
 	Datum result = 0;
+	/* Direct function calls have no state across calls */
+	if (fcinfo->flinfo == NULL)
+	{
+		Temporal *temp = PG_GETARG_TEMPORAL(0);
+		ensure_valid_duration(temp->duration);
+		if (temp->duration == TEMPORALINST) 
+			found = temporalinst_value_at_timestamp((TemporalInst *)temp, t, &result);
+		else if (temp->duration == TEMPORALI) 
+			found = temporali_value_at_timestamp((TemporalI *)temp, t, &result);
+		else if (temp->duration == TEMPORALSEQ) 
+			found = temporalseq_value_at_timestamp((TemporalSeq *)temp, t, &result);
+		else if (temp->duration == TEMPORALS) 
+			found = temporals_value_at_timestamp((TemporalS *)temp, t, &result);
+		PG_FREE_IF_COPY(temp, 0);
+		if (!found)
+			PG_RETURN_NULL();
+		PG_RETURN_DATUM(result);
+	}
+
+	ValueAtTimestampCache *cache = (ValueAtTimestampCache *) fcinfo->flinfo->fn_extra;
+	if (cache == NULL)
+	{
+		cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+			sizeof(ValueAtTimestampCache));
+		fcinfo->flinfo->fn_extra = cache;
+	}
+	bool tofree, loaded;
+	Temporal *temp = temporal_get_cached(fcinfo, &cache->value, &tofree, &loaded);
+	if (loaded)
+		cache->seqpos = cache->instpos = 0;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST) 
 		found = temporalinst_value_at_timestamp((TemporalInst *)temp, t, &result);
 	else if (temp->duration == TEMPORALI) 
-		found = temporali_value_at_timestamp((TemporalI *)temp, t, &result);
+		found = temporali_value_at_timestamp_hint((TemporalI *)temp, t,
+			&cache->instpos, &result);
 	else if (temp->duration == TEMPORALSEQ) 
-		found = temporalseq_value_at_timestamp((TemporalSeq *)temp, t, &result);
+		found = temporalseq_value_at_timestamp_hint((TemporalSeq *)temp, t,
+			&cache->instpos, &result);
 	else if (temp->duration == TEMPORALS) 
-		found = temporals_value_at_timestamp((TemporalS *)temp, t, &result);
-	PG_FREE_IF_COPY(temp, 0);
+		found = temporals_value_at_timestamp_hint((TemporalS *)temp, t,
+			&cache->seqpos, &cache->instpos, &result);
+	if (tofree)
+		pfree(temp);
 	if (!found)
 		PG_RETURN_NULL();
 	PG_RETURN_DATUM(result);
 }
 
+PG_FUNCTION_INFO_V1(temporal_values_at_timestampset);
+/**
+ * @brief Returns the values taken by the temporal value at the timestamps
+ * of a timestamp set, with a null element for each timestamp at which the 
+ * temporal value is not defined
+ */
+PGDLLEXPORT Datum
+temporal_values_at_timestampset(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+	Datum *values = palloc(sizeof(Datum) * ts->count);
+	bool *nulls = palloc(sizeof(bool) * ts->count);
+	memset(nulls, true, sizeof(bool) * ts->count);
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST) 
+		temporalinst_values_at_timestampset((TemporalInst *)temp, ts,
+			values, nulls);
+	else if (temp->duration == TEMPORALI) 
+		temporali_values_at_timestampset((TemporalI *)temp, ts,
+			values, nulls);
+	else if (temp->duration == TEMPORALSEQ) 
+		temporalseq_values_at_timestampset((TemporalSeq *)temp, ts,
+			values, nulls);
+	else if (temp->duration == TEMPORALS) 
+		temporals_values_at_timestampset((TemporalS *)temp, ts,
+			values, nulls);
+
+	int16 elmlen;
+	bool elmbyval;
+	char elmalign;
+	get_typlenbyvalalign(temp->valuetypid, &elmlen, &elmbyval, &elmalign);
+	int dims[1] = {ts->count};
+	int lbs[1] = {1};
+	ArrayType *result = construct_md_array(values, nulls, 1, dims, lbs,
+		temp->valuetypid, elmlen, elmbyval, elmalign);
+	for (int i = 0; i < ts->count; i++)
+	{
+		if (! nulls[i])
+			FREE_DATUM(values[i], temp->valuetypid);
+	}
+	pfree(values); pfree(nulls);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_FREE_IF_COPY(ts, 1);
+	PG_RETURN_POINTER(result);
+}
+
 PG_FUNCTION_INFO_V1(temporal_at_timestampset);
 /**
  * @brief Restricts the temporal value to a timestamp set
@@ -2993,15 +4192,13 @@ temporal_minus_timestampset(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_at_period);
 /**
  * @brief Restricts the temporal value to a period
+ *		(dispatch function)
  */
-PGDLLEXPORT Datum
-temporal_at_period(PG_FUNCTION_ARGS)
+Temporal *
+temporal_at_period_internal(Temporal *temp, Period *p)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	Period *p = PG_GETARG_PERIOD(1);
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST) 
@@ -3016,6 +4213,24 @@ temporal_at_period(PG_FUNCTION_ARGS)
 	else if (temp->duration == TEMPORALS) 
 		result = (Temporal *)temporals_at_period(
 			(TemporalS *)temp, p);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_at_period);
+/**
+ * @brief Restricts the temporal value to a period
+ */
+PGDLLEXPORT Datum
+temporal_at_period(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(1);
+	/* Bounding period test without detoasting the whole value */
+	Period p1;
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	if (!overlaps_period_period_internal(&p1, p))
+		PG_RETURN_NULL();
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Temporal *result = temporal_at_period_internal(temp, p);
 	PG_FREE_IF_COPY(temp, 0);
 	if (result == NULL)
 		PG_RETURN_NULL();	
@@ -3105,15 +4320,13 @@ temporal_at_periodset(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
-PG_FUNCTION_INFO_V1(temporal_minus_periodset);
 /**
  * @brief Restricts the temporal value to the complement of a period set
+ *		(dispatch function)
  */
-PGDLLEXPORT Datum
-temporal_minus_periodset(PG_FUNCTION_ARGS)
+Temporal *
+temporal_minus_periodset_internal(Temporal *temp, PeriodSet *ps)
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
-	PeriodSet *ps = PG_GETARG_PERIODSET(1);
 	Temporal *result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST) 
@@ -3128,6 +4341,19 @@ temporal_minus_periodset(PG_FUNCTION_ARGS)
 	else if (temp->duration == TEMPORALS) 
 		result = (Temporal *)temporals_minus_periodset(
 			(TemporalS *)temp, ps);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_minus_periodset);
+/**
+ * @brief Restricts the temporal value to the complement of a period set
+ */
+PGDLLEXPORT Datum
+temporal_minus_periodset(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	PeriodSet *ps = PG_GETARG_PERIODSET(1);
+	Temporal *result = temporal_minus_periodset_internal(temp, ps);
 	PG_FREE_IF_COPY(temp, 0);
 	PG_FREE_IF_COPY(ps, 1);
 	if (result == NULL)
@@ -3229,6 +4455,587 @@ temporal_intersects_periodset(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(result);
 }
 
+/*****************************************************************************
+ * Sampling functions
+ *
+ * The temporal value is sampled at the timestamps of a grid defined by an
+ * origin and a step. The sequences are traversed only once, merging their
+ * instants with the grid instead of searching the segment of each grid
+ * timestamp.
+ *****************************************************************************/
+
+/*
+ * Step in microseconds of a grid defined by an interval
+ */
+int64
+interval_grid_step(Interval *interval)
+{
+	if (interval->month != 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The interval cannot have a month component")));
+	int64 step = interval->time + (int64) interval->day * USECS_PER_DAY;
+	if (step <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The interval must be positive")));
+	return step;
+}
+
+/*
+ * Smallest timestamp of the grid that is greater than or equal to t
+ */
+TimestampTz
+timestamp_grid_ceil(TimestampTz t, TimestampTz origin, int64 step)
+{
+	int64 rem = (t - origin) % step;
+	if (rem < 0)
+		rem += step;
+	return (rem == 0) ? t : t + (step - rem);
+}
+
+/*
+ * Index of the bucket [origin + i * step, origin + (i + 1) * step) of the
+ * grid containing t
+ */
+int64
+timestamp_grid_bucket(TimestampTz t, TimestampTz origin, int64 step)
+{
+	int64 diff = t - origin;
+	int64 result = diff / step;
+	if (diff % step < 0)
+		result--;
+	return result;
+}
+
+/*
+ * Maximum number of grid timestamps contained in a period
+ */
+static int
+period_grid_count(Period *p, TimestampTz origin, int64 step)
+{
+	TimestampTz t = timestamp_grid_ceil(p->lower, origin, step);
+	if (t > p->upper)
+		return 0;
+	return (int) ((p->upper - t) / step) + 1;
+}
+
+/*
+ * Sample a temporal sequence at the grid timestamps, the instants obtained
+ * are stored in the array given as first argument, which must be large
+ * enough. Returns the number of instants.
+ */
+static int
+temporalseq_sample1(TemporalInst **result, TemporalSeq *seq,
+	TimestampTz origin, int64 step)
+{
+	TimestampTz t = timestamp_grid_ceil(seq->period.lower, origin, step);
+	if (t == seq->period.lower && ! seq->period.lower_inc)
+		t += step;
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	if (seq->count == 1)
+	{
+		if (t != inst1->t)
+			return 0;
+		result[0] = temporalinst_copy(inst1);
+		return 1;
+	}
+
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	TemporalInst *inst2 = temporalseq_inst_n(seq, 1);
+	int i = 1, k = 0;
+	while (t < seq->period.upper ||
+		(seq->period.upper_inc && t == seq->period.upper))
+	{
+		/* The upper bound of the sequence ensures that i < seq->count */
+		while (inst2->t < t)
+		{
+			inst1 = inst2;
+			inst2 = temporalseq_inst_n(seq, ++i);
+		}
+		result[k++] = temporalseq_at_timestamp1(inst1, inst2, linear, t);
+		t += step;
+	}
+	return k;
+}
+
+/*
+ * Keep the instants of an instant set that are on the grid
+ */
+static TemporalI *
+temporali_sample(TemporalI *ti, TimestampTz origin, int64 step)
+{
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
+	int k = 0;
+	for (int i = 0; i < ti->count; i++)
+	{
+		TemporalInst *inst = temporali_inst_n(ti, i);
+		if (timestamp_grid_ceil(inst->t, origin, step) == inst->t)
+			instants[k++] = inst;
+	}
+	TemporalI *result = (k == 0) ? NULL :
+		temporali_from_temporalinstarr(instants, k);
+	pfree(instants);
+	return result;
+}
+
+static TemporalI *
+temporalseq_sample(TemporalSeq *seq, TimestampTz origin, int64 step)
+{
+	int count = period_grid_count(&seq->period, origin, step);
+	if (count == 0)
+		return NULL;
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
+	int k = temporalseq_sample1(instants, seq, origin, step);
+	TemporalI *result = (k == 0) ? NULL :
+		temporali_from_temporalinstarr(instants, k);
+	for (int i = 0; i < k; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	return result;
+}
+
+static TemporalI *
+temporals_sample(TemporalS *ts, TimestampTz origin, int64 step)
+{
+	int count = 0;
+	for (int i = 0; i < ts->count; i++)
+		count += period_grid_count(&temporals_seq_n(ts, i)->period, origin, step);
+	if (count == 0)
+		return NULL;
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
+	int k = 0;
+	for (int i = 0; i < ts->count; i++)
+		k += temporalseq_sample1(&instants[k], temporals_seq_n(ts, i),
+			origin, step);
+	TemporalI *result = (k == 0) ? NULL :
+		temporali_from_temporalinstarr(instants, k);
+	for (int i = 0; i < k; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	return result;
+}
+
+/*
+ * Step function whose value in each bucket [t, t + step) of the grid is the
+ * value of the temporal sequence at the start of the bucket. The last bucket
+ * is truncated to the upper bound of the sequence.
+ */
+static TemporalSeq *
+temporalseq_bucket(TemporalSeq *seq, TimestampTz origin, int64 step)
+{
+	int count = period_grid_count(&seq->period, origin, step);
+	if (count == 0)
+		return NULL;
+	/* One more instant for the end of the last bucket */
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * (count + 1));
+	int k = temporalseq_sample1(instants, seq, origin, step);
+	if (k == 0)
+	{
+		pfree(instants);
+		return NULL;
+	}
+	bool upper_inc = true;
+	TemporalInst *last = instants[k - 1];
+	if (last->t != seq->period.upper)
+	{
+		Datum value = temporalinst_value(last);
+		instants[k++] = temporalinst_make(value, seq->period.upper,
+			last->valuetypid);
+		upper_inc = seq->period.upper_inc;
+	}
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, k,
+		true, upper_inc, false, true);
+	for (int i = 0; i < k; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	return result;
+}
+
+static TemporalS *
+temporals_bucket(TemporalS *ts, TimestampTz origin, int64 step)
+{
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+	int k = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporalseq_bucket(temporals_seq_n(ts, i),
+			origin, step);
+		if (seq != NULL)
+			sequences[k++] = seq;
+	}
+	TemporalS *result = (k == 0) ? NULL :
+		temporals_from_temporalseqarr(sequences, k, false, true);
+	for (int i = 0; i < k; i++)
+		pfree(sequences[i]);
+	pfree(sequences);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(temporal_sample);
+/**
+ * @brief Returns the values taken by the temporal value at the timestamps
+ * of a grid defined by an interval and an origin
+ */
+PGDLLEXPORT Datum
+temporal_sample(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Interval *interval = PG_GETARG_INTERVAL_P(1);
+	TimestampTz origin = PG_GETARG_TIMESTAMPTZ(2);
+	int64 step = interval_grid_step(interval);
+	Temporal *result = NULL;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+	{
+		TemporalInst *inst = (TemporalInst *)temp;
+		if (timestamp_grid_ceil(inst->t, origin, step) == inst->t)
+			result = (Temporal *)temporalinst_copy(inst);
+	}
+	else if (temp->duration == TEMPORALI) 
+		result = (Temporal *)temporali_sample((TemporalI *)temp, origin, step);
+	else if (temp->duration == TEMPORALSEQ) 
+		result = (Temporal *)temporalseq_sample((TemporalSeq *)temp, origin, step);
+	else if (temp->duration == TEMPORALS) 
+		result = (Temporal *)temporals_sample((TemporalS *)temp, origin, step);
+	PG_FREE_IF_COPY(temp, 0);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_bucket);
+/**
+ * @brief Returns the step function whose value in each bucket of a grid
+ * defined by an interval and an origin is the value of the temporal value
+ * at the start of the bucket
+ */
+PGDLLEXPORT Datum
+temporal_bucket(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Interval *interval = PG_GETARG_INTERVAL_P(1);
+	TimestampTz origin = PG_GETARG_TIMESTAMPTZ(2);
+	int64 step = interval_grid_step(interval);
+	Temporal *result = NULL;
+	ensure_valid_duration(temp->duration);
+	/* Instantaneous durations have no bucket to fill and are sampled */
+	if (temp->duration == TEMPORALINST)
+	{
+		TemporalInst *inst = (TemporalInst *)temp;
+		if (timestamp_grid_ceil(inst->t, origin, step) == inst->t)
+			result = (Temporal *)temporalinst_copy(inst);
+	}
+	else if (temp->duration == TEMPORALI) 
+		result = (Temporal *)temporali_sample((TemporalI *)temp, origin, step);
+	else if (temp->duration == TEMPORALSEQ) 
+		result = (Temporal *)temporalseq_bucket((TemporalSeq *)temp, origin, step);
+	else if (temp->duration == TEMPORALS) 
+		result = (Temporal *)temporals_bucket((TemporalS *)temp, origin, step);
+	PG_FREE_IF_COPY(temp, 0);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Synchronization of an array of temporal values
+ *
+ * The temporal values are traversed with one forward cursor each. The
+ * timestamps of the rows are either obtained by merging the timestamps of
+ * the instants under the cursors or given by a grid. Before computing the
+ * values of a row, the cursors are moved to the first instant at or after
+ * its timestamp, from which the value at the timestamp is obtained without
+ * searching the segment containing it.
+ *****************************************************************************/
+
+/* Cursor on the instants of a temporal value */
+
+typedef struct
+{
+	Temporal   *temp;		/* Temporal value */
+	int			i;			/* Current sequence of a sequence set */
+	int			j;			/* Current instant of the current component */
+} TsyncCursor;
+
+/* State of the function returning the synchronized rows */
+
+typedef struct
+{
+	int			count;		/* Number of temporal values */
+	TsyncCursor *cursors;	/* Cursors on the temporal values */
+	bool		intersection;	/* Only rows where all values are defined */
+	int64		step;		/* Step of the grid, 0 for merging the timestamps */
+	TimestampTz	t;			/* Next timestamp of the grid */
+	TimestampTz	end;		/* Last timestamp of the grid */
+	Oid			valuetypid;	/* Base type of the temporal values */
+	int16		typlen;		/* Storage of the base type */
+	bool		typbyval;
+	char		typalign;
+} TsyncState;
+
+/*
+ * Returns the instant under the cursor or NULL at the end of the temporal
+ * value, and sets seq to the current sequence for sequence durations
+ */
+static TemporalInst *
+tsync_cursor_inst(TsyncCursor *cursor, TemporalSeq **seq)
+{
+	Temporal *temp = cursor->temp;
+	*seq = NULL;
+	if (temp->duration == TEMPORALINST)
+		return (cursor->j == 0) ? (TemporalInst *)temp : NULL;
+	if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = (TemporalI *)temp;
+		return (cursor->j < ti->count) ? temporali_inst_n(ti, cursor->j) : NULL;
+	}
+	if (temp->duration == TEMPORALSEQ)
+		*seq = (TemporalSeq *)temp;
+	else
+	{
+		TemporalS *ts = (TemporalS *)temp;
+		if (cursor->i == ts->count)
+			return NULL;
+		*seq = temporals_seq_n(ts, cursor->i);
+	}
+	return (cursor->j < (*seq)->count) ? 
+		temporalseq_inst_n(*seq, cursor->j) : NULL;
+}
+
+/* Moves the cursor, which is not at the end, to the next instant */
+
+static void
+tsync_cursor_next(TsyncCursor *cursor)
+{
+	cursor->j++;
+	if (cursor->temp->duration == TEMPORALS)
+	{
+		TemporalSeq *seq = temporals_seq_n((TemporalS *)cursor->temp, cursor->i);
+		if (cursor->j == seq->count)
+		{
+			cursor->i++;
+			cursor->j = 0;
+		}
+	}
+}
+
+/* Moves the cursor to the first instant at or after the timestamp */
+
+static void
+tsync_cursor_skip(TsyncCursor *cursor, TimestampTz t)
+{
+	TemporalSeq *seq;
+	TemporalInst *inst;
+	while ((inst = tsync_cursor_inst(cursor, &seq)) != NULL && inst->t < t)
+		tsync_cursor_next(cursor);
+}
+
+/*
+ * Value of the temporal value at the timestamp, where the cursor is at the
+ * first instant at or after the timestamp. Returns false if the temporal
+ * value is not defined at the timestamp. The cursor is not moved.
+ */
+static bool
+tsync_cursor_value(TsyncCursor *cursor, TimestampTz t, Datum *result)
+{
+	TsyncCursor c = *cursor;
+	TemporalSeq *seq;
+	TemporalInst *inst;
+	bool found = false;
+	/* An instant at the timestamp may be excluded by a bound of its 
+	 * sequence, in which case the next sequence may start at it */
+	while ((inst = tsync_cursor_inst(&c, &seq)) != NULL && inst->t == t)
+	{
+		if (seq == NULL || 
+			((c.j > 0 || seq->period.lower_inc) && 
+			 (c.j < seq->count - 1 || seq->period.upper_inc)))
+		{
+			*result = temporalinst_value(inst);
+			return true;
+		}
+		found = true;
+		tsync_cursor_next(&c);
+	}
+	if (found || inst == NULL || seq == NULL || c.j == 0)
+		return false;
+	/* The timestamp is strictly inside the segment ending at the cursor */
+	*result = temporalseq_value_at_timestamp1(temporalseq_inst_n(seq, c.j - 1),
+		inst, MOBDB_FLAGS_GET_LINEAR(seq->flags), t);
+	return true;
+}
+
+static TsyncState *
+tsync_state_make(ArrayType *array)
+{
+	int count;
+	Temporal **temparr = temporalarr_extract(array, &count);
+	if (count == 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The array must contain at least one temporal value")));
+	TsyncState *result = palloc0(sizeof(TsyncState));
+	result->count = count;
+	result->cursors = palloc0(sizeof(TsyncCursor) * count);
+	for (int i = 0; i < count; i++)
+	{
+		ensure_valid_duration(temparr[i]->duration);
+		result->cursors[i].temp = temparr[i];
+	}
+	result->valuetypid = temparr[0]->valuetypid;
+	get_typlenbyvalalign(result->valuetypid, &result->typlen,
+		&result->typbyval, &result->typalign);
+	pfree(temparr);
+	return result;
+}
+
+/* Returns the next row of the synchronized values */
+
+static Datum
+tsync_next(FunctionCallInfo fcinfo, FuncCallContext *funcctx)
+{
+	TsyncState *state = (TsyncState *) funcctx->user_fctx;
+	Datum *values = palloc(sizeof(Datum) * state->count);
+	bool *nulls = palloc(sizeof(bool) * state->count);
+	for (;;)
+	{
+		TimestampTz t = 0;
+		if (state->step == 0)
+		{
+			/* Smallest timestamp under the cursors */
+			bool found = false;
+			for (int i = 0; i < state->count; i++)
+			{
+				TemporalSeq *seq;
+				TemporalInst *inst = tsync_cursor_inst(&state->cursors[i], &seq);
+				if (inst != NULL && (! found || inst->t < t))
+				{
+					t = inst->t;
+					found = true;
+				}
+			}
+			if (! found)
+				SRF_RETURN_DONE(funcctx);
+		}
+		else
+		{
+			if (state->t > state->end)
+				SRF_RETURN_DONE(funcctx);
+			t = state->t;
+			state->t += state->step;
+			for (int i = 0; i < state->count; i++)
+				tsync_cursor_skip(&state->cursors[i], t);
+		}
+
+		int defined = 0;
+		for (int i = 0; i < state->count; i++)
+		{
+			nulls[i] = ! tsync_cursor_value(&state->cursors[i], t, &values[i]);
+			if (! nulls[i])
+				defined++;
+		}
+		if (state->step == 0)
+			for (int i = 0; i < state->count; i++)
+				tsync_cursor_skip(&state->cursors[i], t + 1);
+		if (defined == 0 || (state->intersection && defined < state->count))
+			continue;
+
+		int dims[1] = {state->count};
+		int lbs[1] = {1};
+		ArrayType *array = construct_md_array(values, nulls, 1, dims, lbs,
+			state->valuetypid, state->typlen, state->typbyval, state->typalign);
+		Datum result[2];
+		bool resnulls[2] = {false, false};
+		result[0] = TimestampTzGetDatum(t);
+		result[1] = PointerGetDatum(array);
+		HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, result, resnulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+}
+
+PG_FUNCTION_INFO_V1(temporalarr_sync);
+/**
+ * @brief Returns the values of an array of temporal values at the union of
+ * their timestamps as a set of rows (timestamp, array of values), a value 
+ * being null when the temporal value is not defined at the timestamp
+ *
+ * With the intersection mode, only the rows at which all temporal values
+ * are defined are returned.
+ */
+PGDLLEXPORT Datum
+temporalarr_sync(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+		char *mode = text_to_cstring(PG_GETARG_TEXT_PP(1));
+		bool intersection = false;
+		if (pg_strcasecmp(mode, "intersection") == 0)
+			intersection = true;
+		else if (pg_strcasecmp(mode, "union") != 0)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				errmsg("The mode must be either 'union' or 'intersection'")));
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		TsyncState *state = tsync_state_make(array);
+		state->intersection = intersection;
+		funcctx->user_fctx = state;
+		MemoryContextSwitchTo(oldcontext);
+	}
+	funcctx = SRF_PERCALL_SETUP();
+	return tsync_next(fcinfo, funcctx);
+}
+
+PG_FUNCTION_INFO_V1(temporalarr_sync_grid);
+/**
+ * @brief Returns the values of an array of temporal values at the timestamps
+ * of a grid defined by an interval and an origin as a set of rows
+ * (timestamp, array of values), a value being null when the temporal value
+ * is not defined at the timestamp
+ */
+PGDLLEXPORT Datum
+temporalarr_sync_grid(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+		Interval *interval = PG_GETARG_INTERVAL_P(1);
+		TimestampTz origin = PG_GETARG_TIMESTAMPTZ(2);
+		int64 step = interval_grid_step(interval);
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		TsyncState *state = tsync_state_make(array);
+		/* The grid covers the union of the timespans of the values */
+		Period p;
+		TimestampTz start = 0;
+		for (int i = 0; i < state->count; i++)
+		{
+			temporal_period(&p, state->cursors[i].temp);
+			if (i == 0 || p.lower < start)
+				start = p.lower;
+			if (i == 0 || p.upper > state->end)
+				state->end = p.upper;
+		}
+		state->step = step;
+		state->t = timestamp_grid_ceil(start, origin, step);
+		funcctx->user_fctx = state;
+		MemoryContextSwitchTo(oldcontext);
+	}
+	funcctx = SRF_PERCALL_SETUP();
+	return tsync_next(fcinfo, funcctx);
+}
+
 /*****************************************************************************
  * Local aggregate functions 
  *****************************************************************************/
@@ -3276,6 +5083,88 @@ tnumber_twavg(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8(result);
 }
 
+PG_FUNCTION_INFO_V1(tnumber_integral_period);
+/**
+ * @brief Returns the integral of the temporal numeric value restricted to
+ * a period, or NULL if the restriction is empty. Long sequences compute it 
+ * from their block summary without restricting the value.
+ */
+PGDLLEXPORT Datum
+tnumber_integral_period(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(1);
+	/* Bounding period test without detoasting the whole value */
+	Period p1;
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	if (!overlaps_period_period_internal(&p1, p))
+		PG_RETURN_NULL();
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	double result = 0.0;
+	bool found = true;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+		found = temporalinst_intersects_period((TemporalInst *)temp, p);
+	else if (temp->duration == TEMPORALI)
+		found = temporali_intersects_period((TemporalI *)temp, p);
+	else if (temp->duration == TEMPORALSEQ)
+		result = tnumberseq_integral_period((TemporalSeq *)temp, p);
+	else if (temp->duration == TEMPORALS)
+	{
+		found = temporals_intersects_period((TemporalS *)temp, p);
+		if (found)
+			result = tnumbers_integral_period((TemporalS *)temp, p);
+	}
+	PG_FREE_IF_COPY(temp, 0);
+	if (!found)
+		PG_RETURN_NULL();
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_twavg_period);
+/**
+ * @brief Returns the time-weighted average of the temporal numeric value
+ * restricted to a period, or NULL if the restriction is empty
+ */
+PGDLLEXPORT Datum
+tnumber_twavg_period(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(1);
+	/* Bounding period test without detoasting the whole value */
+	Period p1;
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	if (!overlaps_period_period_internal(&p1, p))
+		PG_RETURN_NULL();
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	double result = 0.0;
+	bool found = true;
+	ensure_valid_duration(temp->duration);
+	if (temp->duration == TEMPORALINST)
+		result = datum_double(temporalinst_value((TemporalInst *)temp), 
+			temp->valuetypid);
+	else if (temp->duration == TEMPORALI)
+	{
+		TemporalI *ti = temporali_at_period((TemporalI *)temp, p);
+		found = ti != NULL;
+		if (found)
+		{
+			result = tnumberi_twavg(ti);
+			pfree(ti);
+		}
+	}
+	else if (temp->duration == TEMPORALSEQ)
+		result = tnumberseq_twavg_period((TemporalSeq *)temp, p);
+	else if (temp->duration == TEMPORALS)
+	{
+		found = temporals_intersects_period((TemporalS *)temp, p);
+		if (found)
+			result = tnumbers_twavg_period((TemporalS *)temp, p);
+	}
+	PG_FREE_IF_COPY(temp, 0);
+	if (!found)
+		PG_RETURN_NULL();
+	PG_RETURN_FLOAT8(result);
+}
+
 /*****************************************************************************
  * Functions for defining B-tree index
  *****************************************************************************/
@@ -3290,6 +5179,10 @@ temporal_cmp_internal(const Temporal *t1, const Temporal *t2)
 {
 	assert(t1->valuetypid == t2->valuetypid);
 
+	/* Values with the same representation are equal */
+	if (temporal_identical(t1, t2))
+		return 0;
+
 	/* Compare bounding box */
 	union bboxunion box1, box2;
 	memset(&box1, 0, sizeof(bboxunion));
@@ -3358,6 +5251,58 @@ temporal_cmp(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(result);
 }
 
+static int
+temporal_sortsupport_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	Temporal *t1 = temporal_detoast_uncompressed(x);
+	Temporal *t2 = temporal_detoast_uncompressed(y);
+	int result = temporal_cmp_internal(t1, t2);
+	if (t1 != (Temporal *) DatumGetPointer(x))
+		pfree(t1);
+	if (t2 != (Temporal *) DatumGetPointer(y))
+		pfree(t2);
+	return result;
+}
+
+/*
+ * The abbreviated key of a temporal value is the component of its bounding
+ * box that is compared first, that is, the first timestamp for temporal
+ * booleans and texts, and the minimum value or the minimum x coordinate for
+ * temporal numbers and temporal points. Only the slices of the value 
+ * containing its header and its bounding box are fetched.
+ */
+static uint64
+temporal_sortkey(Datum d)
+{
+	Temporal *temp = (Temporal *) DatumGetPointer(d);
+	Temporal *header = VARATT_IS_EXTENDED(temp) ?
+		(Temporal *) PG_DETOAST_DATUM_SLICE(d, 0, TEMPORAL_HEADER_SLICE) :
+		temp;
+	Oid valuetypid = header->valuetypid;
+	if (header != temp)
+		pfree(header);
+	union bboxunion box;
+	memset(&box, 0, sizeof(bboxunion));
+	temporal_bbox_slice(d, &box);
+	if (valuetypid == BOOLOID || valuetypid == TEXTOID)
+		return timestamp_sortkey(box.p.lower);
+	if (valuetypid == INT4OID || valuetypid == FLOAT8OID)
+		return double_sortkey(box.b.xmin);
+	return double_sortkey(box.g.xmin);
+}
+
+PG_FUNCTION_INFO_V1(temporal_sortsupport);
+/**
+ * @brief Sort support for the B-tree comparison of temporal values
+ */
+PGDLLEXPORT Datum
+temporal_sortsupport(PG_FUNCTION_ARGS)
+{
+	SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+	sortsupport_abbrev_init(ssup, &temporal_sortsupport_cmp, &temporal_sortkey);
+	PG_RETURN_VOID();
+}
+
 /**
  * @brief Returns true if the two temporal values are equal 
  *		(internal function). The internal B-tree comparator 
@@ -3373,6 +5318,9 @@ temporal_eq_internal(Temporal *t1, Temporal *t2)
 	/* If both are of the same duration use the specific equality */
 	if (t1->duration == t2->duration)
 	{
+		/* Values with the same representation are equal */
+		if (temporal_identical(t1, t2))
+			return true;
 		if (t1->duration == TEMPORALINST) 
 			return temporalinst_eq((TemporalInst *)t1, (TemporalInst *)t2);
 		else if (t1->duration == TEMPORALI) 
@@ -3598,6 +5546,20 @@ temporal_hash_internal(const Temporal *temp)
 	return result;
 }
 
+/*
+ * Hash value kept across calls in fn_extra. When the value is stored out of
+ * line, its hash value is kept together with the toast pointer that 
+ * identifies it, so that successive calls on the same value, e.g., when the
+ * rows of a LATERAL join are grouped by the value, neither detoast it nor
+ * hash all its instants again.
+ */
+typedef struct 
+{
+	struct varatt_external toast_pointer;	/* Identifies the hashed value */
+	bool valid;			/* True if the hash value has been computed */
+	uint32 hash;		/* Hash value of the value */
+} TemporalHashCache;
+
 PG_FUNCTION_INFO_V1(temporal_hash);
 /**
  * @brief Returns the hash value of the temporal value
@@ -3605,9 +5567,33 @@ PG_FUNCTION_INFO_V1(temporal_hash);
 PGDLLEXPORT Datum 
 temporal_hash(PG_FUNCTION_ARGS)
 {
+	struct varlena *raw = (struct varlena *) DatumGetPointer(PG_GETARG_DATUM(0));
+	struct varatt_external toast_pointer;
+	TemporalHashCache *cache = NULL;
+	if (fcinfo->flinfo != NULL && VARATT_IS_EXTERNAL_ONDISK(raw))
+	{
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, raw);
+		cache = (TemporalHashCache *) fcinfo->flinfo->fn_extra;
+		if (cache == NULL)
+		{
+			cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+				sizeof(TemporalHashCache));
+			fcinfo->flinfo->fn_extra = cache;
+		}
+		else if (cache->valid && memcmp(&toast_pointer, &cache->toast_pointer,
+			sizeof(struct varatt_external)) == 0)
+			PG_RETURN_UINT32(cache->hash);
+	}
+
 	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	uint32 result = temporal_hash_internal(temp);
 	PG_FREE_IF_COPY(temp, 0);
+	if (cache != NULL)
+	{
+		cache->toast_pointer = toast_pointer;
+		cache->hash = result;
+		cache->valid = true;
+	}
 	PG_RETURN_UINT32(result);
 }
 
@@ -17,16 +17,22 @@
 #include <strings.h>
 #include <catalog/pg_collation.h>
 #include <libpq/pqformat.h>
+#include <miscadmin.h>
+#include <nodes/execnodes.h>
+#include <utils/memutils.h>
 #include <utils/timestamp.h>
-#include <executor/spi.h>
 
 #include "period.h"
+#include "periodset.h"
 #include "timeops.h"
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
 #include "temporal_boolops.h"
+#include "lifting.h"
 #include "doublen.h"
+#include "temporal_boxops.h"
+#include "temporal_profile.h"
 
 static TemporalInst **
 temporalinst_tagg(TemporalInst **instants1, int count1, TemporalInst **instants2, 
@@ -101,6 +107,31 @@ skiplist_free(FunctionCallInfo fcinfo, SkipList *list, int cur)
 	list->length --;
 }
 
+/*
+ * The temporal values kept in the skiplist are allocated in a generation
+ * memory context that is a child of the aggregation context. This avoids
+ * rounding up the size of the values to a power of 2 as done by the default
+ * allocator, and all the values are released in bulk when the aggregation
+ * context is reset at the end of the group.
+ */
+static Temporal *
+skiplist_value_copy(SkipList *list, Temporal *temp)
+{
+	Temporal *result = MemoryContextAlloc(list->ctx, VARSIZE(temp));
+	memcpy(result, temp, VARSIZE(temp));
+	list->memsize += VARSIZE(temp);
+	if (list->memsize > list->peakmemsize)
+		list->peakmemsize = list->memsize;
+	return result;
+}
+
+static void
+skiplist_value_free(SkipList *list, Temporal *temp)
+{
+	list->memsize -= VARSIZE(temp);
+	pfree(temp);
+}
+
 typedef enum
 {
 	BEFORE,
@@ -201,32 +232,33 @@ random_level()
 	return ffsl(~(random() & ((1l << SKIPLIST_MAXLEVEL) - 1)));
 }
 
-SkipList *
-skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
+/*
+ * Initialize the elements of the list with the values, which must be
+ * ordered and disjoint. Must be called in the aggregation context.
+ */
+static void
+skiplist_init(SkipList *list, Temporal **values, int count)
 {
-	assert(count > 0);
 	//FIXME: tail should be a constant (e.g. 1) but is not, for ease of construction
-
-	MemoryContext oldctx = set_aggregation_context(fcinfo);
 	int capacity = SKIPLIST_INITIAL_CAPACITY;
 	count += 2; /* Account for head and tail */
 	while (capacity <= count)
 		capacity <<= 1;
-	SkipList *result = palloc0(sizeof(SkipList));
-	result->elems = palloc0(sizeof(Elem) * capacity);
-	int height = (int) ceil(log2(count - 1));
-	result->capacity = capacity;
-	result->next = count;
-	result->length = count - 2;
-	result->extra = NULL;
-	result->extrasize = 0;
+	list->elems = palloc0(sizeof(Elem) * capacity);
+	int height = count > 2 ? (int) ceil(log2(count - 1)) : 1;
+	list->capacity = capacity;
+	list->next = count;
+	list->length = count - 2;
+	list->freed = NULL;
+	list->freecount = list->freecap = 0;
+	list->lastvalid = false;
 
 	/* Fill values first */
-	result->elems[0].value = NULL;
+	list->elems[0].value = NULL;
 	for (int i = 0; i < count - 2; i ++)
-		result->elems[i + 1].value = temporal_copy(values[i]);
-	result->elems[count - 1].value = NULL;
-	result->tail = count - 1;
+		list->elems[i + 1].value = skiplist_value_copy(list, values[i]);
+	list->elems[count - 1].value = NULL;
+	list->tail = count - 1;
 
 	/* Link the list in a balanced fashion */
 	for (int level = 0; level < height; level ++)
@@ -237,16 +269,33 @@ skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
 			int next = i + step < count ? i + step : count - 1;
 			if (i != count - 1)
 			{
-				result->elems[i].next[level] = next;
-				result->elems[i].height = level + 1;
+				list->elems[i].next[level] = next;
+				list->elems[i].height = level + 1;
 			}
 			else
 			{
-				result->elems[i].next[level] = - 1;
-				result->elems[i].height = height;
+				list->elems[i].next[level] = - 1;
+				list->elems[i].height = height;
 			}
 		}
 	}
+}
+
+/* An empty list, which is only used as the state of moving aggregates,
+   is obtained with a count of 0 */
+SkipList *
+skiplist_make(FunctionCallInfo fcinfo, Temporal **values, int count)
+{
+	assert(count >= 0);
+	MemoryContext oldctx = set_aggregation_context(fcinfo);
+	SkipList *result = palloc0(sizeof(SkipList));
+	result->extra = NULL;
+	result->extrasize = 0;
+	result->ctx = GenerationContextCreate(CurrentMemoryContext,
+		"Temporal aggregation values", SKIPLIST_BLOCKSIZE);
+	result->memsize = result->peakmemsize = 0;
+	result->spill = NULL;
+	skiplist_init(result, values, count);
 	unset_aggregation_context(oldctx);
 	return result;
 }
@@ -285,15 +334,200 @@ skiplist_values(SkipList *list)
 	return result;
 }
 
-void
-skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
-	int count, Datum (*func)(Datum, Datum), bool crossings)
+/*
+ * Compute for each level the last element before the tail, which are the
+ * elements that must be updated when appending new elements at the end
+ * of the list
+ */
+static void
+skiplist_set_last(SkipList *list)
+{
+	int cur = 0;
+	int height = list->elems[0].height;
+	for (int level = height - 1; level >= 0; level --)
+	{
+		while (list->elems[cur].next[level] != list->tail)
+			cur = list->elems[cur].next[level];
+		list->last[level] = cur;
+	}
+	list->lastvalid = true;
+}
+
+/*
+ * Append the values at the end of the list if they start after the last
+ * element of the list, which is the usual case when the input of the 
+ * aggregation is sorted by time. In this case no aggregation needs to be
+ * computed and the values are linked to the last element of each level in
+ * constant time. The height of the new elements is computed from the
+ * number of elements in the list instead of using random levels, which
+ * keeps the list balanced when all values are appended.
+ * Returns false if the values cannot be appended.
+ */
+static bool
+skiplist_append(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
+	int count)
+{
+	if (! list->lastvalid)
+		skiplist_set_last(list);
+	TimestampTz lower = (values[0]->duration == TEMPORALINST) ?
+		((TemporalInst *)values[0])->t : ((TemporalSeq *)values[0])->period.lower;
+	if (skiplist_elmpos(list, list->last[0], lower) != AFTER)
+		return false;
+
+	for (int i = 0; i < count; i ++)
+	{
+		int new = skiplist_alloc(fcinfo, list);
+		int rheight = ffs(list->length);
+		if (rheight > SKIPLIST_MAXLEVEL)
+			rheight = SKIPLIST_MAXLEVEL;
+		int height = list->elems[0].height;
+		if (rheight > height)
+		{
+			/* Grow head and tail as appropriate */
+			for (int level = height; level < rheight; level ++)
+			{
+				list->last[level] = 0;
+				list->elems[list->tail].next[level] = -1;
+			}
+			list->elems[0].height = rheight;
+			list->elems[list->tail].height = rheight;
+		}
+		Elem *newelm = &list->elems[new];
+		newelm->value = skiplist_value_copy(list, values[i]);
+		newelm->height = rheight;
+		for (int level = 0; level < rheight; level ++)
+		{
+			list->elems[list->last[level]].next[level] = new;
+			newelm->next[level] = list->tail;
+			list->last[level] = new;
+		}
+	}
+	return true;
+}
+
+/*
+ * Is the value of an instant of the state of a moving aggregate empty?
+ * The states of moving aggregates keep the number of values aggregated at
+ * each instant, which is the value itself for tcount and the second 
+ * component of the double2 values for tsum and tavg. This number only 
+ * changes at the bounds of the aggregated values, and thus is constant
+ * between two consecutive instants of the state.
+ */
+static bool
+aggvalue_empty(TemporalInst *inst)
+{
+	Datum value = temporalinst_value(inst);
+	if (inst->valuetypid == INT4OID)
+		return DatumGetInt32(value) == 0;
+	return ((double2 *) DatumGetPointer(value))->b == 0;
+}
+
+/*
+ * Restrict a sequence of the state of a moving aggregate to the periods
+ * where the number of values aggregated is not zero
+ */
+static int
+temporalseq_remove_empty(TemporalSeq **result, TemporalSeq *seq)
+{
+	if (seq->count == 1)
+	{
+		if (aggvalue_empty(temporalseq_inst_n(seq, 0)))
+			return 0;
+		result[0] = temporalseq_copy(seq);
+		return 1;
+	}
+
+	Period p;
+	int k = 0, start = -1;
+	for (int i = 0; i < seq->count - 1; i++)
+	{
+		bool empty = aggvalue_empty(temporalseq_inst_n(seq, i));
+		if (! empty && start == -1)
+			start = i;
+		else if (empty && start != -1)
+		{
+			period_set(&p, temporalseq_inst_n(seq, start)->t,
+				temporalseq_inst_n(seq, i)->t, 
+				start == 0 ? seq->period.lower_inc : true, false);
+			result[k++] = temporalseq_at_period(seq, &p);
+			start = -1;
+		}
+	}
+	TemporalInst *last = temporalseq_inst_n(seq, seq->count - 1);
+	bool upper_inc = seq->period.upper_inc && ! aggvalue_empty(last);
+	if (start != -1)
+	{
+		period_set(&p, temporalseq_inst_n(seq, start)->t, last->t, 
+			start == 0 ? seq->period.lower_inc : true, upper_inc);
+		result[k++] = temporalseq_at_period(seq, &p);
+	}
+	else if (upper_inc)
+		result[k++] = temporalseq_from_temporalinstarr(&last, 1, true, true,
+			MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
+	return k;
+}
+
+/*
+ * Remove the parts of the values of the state of a moving aggregate where
+ * the number of values aggregated is zero. The values are freed.
+ */
+static Temporal **
+aggstate_remove_empty(Temporal **values, int count, int *newcount)
+{
+	int k = 0;
+	Temporal **result;
+	if (values[0]->duration == TEMPORALINST)
+	{
+		result = palloc(sizeof(Temporal *) * count);
+		for (int i = 0; i < count; i++)
+		{
+			if (aggvalue_empty((TemporalInst *) values[i]))
+				pfree(values[i]);
+			else
+				result[k++] = values[i];
+		}
+	}
+	else
+	{
+		int maxcount = 0;
+		for (int i = 0; i < count; i++)
+			maxcount += ((TemporalSeq *) values[i])->count;
+		result = palloc(sizeof(Temporal *) * maxcount);
+		for (int i = 0; i < count; i++)
+		{
+			k += temporalseq_remove_empty((TemporalSeq **) &result[k],
+				(TemporalSeq *) values[i]);
+			pfree(values[i]);
+		}
+	}
+	pfree(values);
+	*newcount = k;
+	return result;
+}
+
+/*
+ * Splice the values into the list, aggregating them with the elements of
+ * the list that they overlap. When inverse is true the values are the 
+ * negated contribution of a value previously added to the state of a 
+ * moving aggregate, and the parts of the list where no value remains are
+ * removed.
+ */
+static void
+skiplist_splice1(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
+	int count, Datum (*func)(Datum, Datum), bool crossings, bool inverse)
 {
+	MOBDB_STAT_INC(STAT_SKIPLIST_SPLICES);
 	/*
 	 * O(count*log(n)) average (unless I'm mistaken)
 	 * O(n+count*log(n)) worst case (when period spans the whole list so everything has to be deleted) 
 	 */
+	/* Fast path when the values are after the last element of the list */
+	if (! inverse && skiplist_append(fcinfo, list, values, count))
+		return;
 	assert(list->length > 0);
+	/* The last elements of each level must be recomputed after splicing */
+	list->lastvalid = false;
+
 	int16 duration = skiplist_headval(list)->duration;
 	Period period;
 	if (duration == TEMPORALINST)
@@ -366,6 +600,9 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
 		height --;
 	}
 
+	if (inverse && spliced_count == 0)
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			errmsg("Cannot remove a value that was not aggregated")));
 	if (spliced_count != 0)
 	{
 		/* We are not in a gap, we need to compute the aggregation */
@@ -377,11 +614,13 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
 		else
 			newtemps = (Temporal **)temporalseq_tagg((TemporalSeq **)spliced, 
 				spliced_count, (TemporalSeq **)values, count, func, crossings, &newcount);
+		if (inverse)
+			newtemps = aggstate_remove_empty(newtemps, newcount, &newcount);
 		values = newtemps;
 		count = newcount;
 		/* We need to delete the spliced-out temporal values */
 		for (int i = 0; i < spliced_count; i ++)
-			pfree(spliced[i]);
+			skiplist_value_free(list, spliced[i]);
 		pfree(spliced);
 	}
 
@@ -399,9 +638,7 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
 		}
 		int new = skiplist_alloc(fcinfo, list);
 		Elem *newelm = &list->elems[new];
-		MemoryContext ctx = set_aggregation_context(fcinfo);
-		newelm->value = temporal_copy(values[i]);
-		unset_aggregation_context(ctx);
+		newelm->value = skiplist_value_copy(list, values[i]);
 		newelm->height = rheight;
 
 		for (int level = 0; level < rheight; level ++)
@@ -426,6 +663,157 @@ skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
 	}
 }
 
+/*****************************************************************************
+ * Spilling skiplists to disk
+ *****************************************************************************/
+
+/*
+ * When the size of the values of a skiplist exceeds work_mem, all its values
+ * but the last one are written as a sorted run to a temporary file and the
+ * list is rebuilt with the last value, which keeps the fast path of
+ * skiplist_append when the input is sorted by time. The runs are merged back
+ * into the list with the aggregation function of the splices before the
+ * values of the list are used, that is, in the final, serialize, and combine
+ * functions. This is only done in aggregate nodes, whose shutdown callback
+ * closes the temporary file, and thus neither for window aggregates nor for
+ * the states of moving aggregates, from which values must be removed.
+ */
+static bool
+skiplist_spill_needed(FunctionCallInfo fcinfo, SkipList *list)
+{
+	return list->memsize > (size_t) work_mem * 1024L && list->length > 1 &&
+		fcinfo->context && IsA(fcinfo->context, AggState);
+}
+
+/*
+ * The callback receives the spill rather than the list since the states of
+ * combine functions may be freed before the aggregate node is shut down
+ */
+static void
+skiplist_spill_shutdown(Datum arg)
+{
+	SkipListSpill *spill = (SkipListSpill *) DatumGetPointer(arg);
+	if (spill->file)
+	{
+		BufFileClose(spill->file);
+		spill->file = NULL;
+	}
+}
+
+static void
+skiplist_spill_read(BufFile *file, void *ptr, size_t size)
+{
+	if (BufFileRead(file, ptr, size) != size)
+		ereport(ERROR, (errcode_for_file_access(),
+			errmsg("could not read from temporary file: %m")));
+}
+
+static void
+skiplist_spill(FunctionCallInfo fcinfo, SkipList *list,
+	Datum (*func)(Datum, Datum), bool crossings)
+{
+	MemoryContext oldctx = set_aggregation_context(fcinfo);
+	SkipListSpill *spill = list->spill;
+	if (! spill)
+	{
+		spill = palloc0(sizeof(SkipListSpill));
+		spill->file = BufFileCreateTemp(false);
+		spill->func = func;
+		spill->crossings = crossings;
+		spill->capacity = SKIPLIST_INITIAL_RUNS;
+		spill->runs = palloc(sizeof(SkipListRun) * spill->capacity);
+		list->spill = spill;
+		AggRegisterCallback(fcinfo, skiplist_spill_shutdown,
+			PointerGetDatum(spill));
+	}
+	else if (spill->count == spill->capacity)
+	{
+		spill->capacity <<= 1;
+		spill->runs = repalloc(spill->runs, sizeof(SkipListRun) * spill->capacity);
+	}
+
+	/* Write all the values but the last one */
+	SkipListRun *run = &spill->runs[spill->count++];
+	BufFileTell(spill->file, &run->fileno, &run->offset);
+	run->count = list->length - 1;
+	int cur = list->elems[0].next[0];
+	for (int i = 0; i < run->count; i ++)
+	{
+		Temporal *value = list->elems[cur].value;
+		if (BufFileWrite(spill->file, value, VARSIZE(value)) != VARSIZE(value))
+			ereport(ERROR, (errcode_for_file_access(),
+				errmsg("could not write to temporary file: %m")));
+		cur = list->elems[cur].next[0];
+	}
+	MOBDB_STAT_INC(STAT_SKIPLIST_SPILLS);
+
+	/* Rebuild the list with the last value, releasing the memory of the 
+	   values and of the elements */
+	Temporal *last = palloc(VARSIZE(list->elems[cur].value));
+	memcpy(last, list->elems[cur].value, VARSIZE(list->elems[cur].value));
+	MemoryContextReset(list->ctx);
+	list->memsize = 0;
+	pfree(list->elems);
+	if (list->freed)
+		pfree(list->freed);
+	skiplist_init(list, &last, 1);
+	pfree(last);
+	unset_aggregation_context(oldctx);
+}
+
+/*
+ * Merge the runs spilled to disk, if any, into the list
+ */
+void
+skiplist_unspill(FunctionCallInfo fcinfo, SkipList *list)
+{
+	SkipListSpill *spill = list->spill;
+	if (! spill)
+		return;
+	list->spill = NULL;
+	for (int i = 0; i < spill->count; i ++)
+	{
+		SkipListRun *run = &spill->runs[i];
+		if (BufFileSeek(spill->file, run->fileno, run->offset, SEEK_SET) != 0)
+			ereport(ERROR, (errcode_for_file_access(),
+				errmsg("could not seek in temporary file: %m")));
+		Temporal **values = palloc(sizeof(Temporal *) * run->count);
+		for (int j = 0; j < run->count; j ++)
+		{
+			/* Read the header of the value to obtain its size */
+			uint32 header;
+			skiplist_spill_read(spill->file, &header, sizeof(uint32));
+			size_t size = VARSIZE(&header);
+			values[j] = palloc(size);
+			memcpy(values[j], &header, sizeof(uint32));
+			skiplist_spill_read(spill->file, (char *) values[j] + sizeof(uint32),
+				size - sizeof(uint32));
+		}
+		skiplist_splice1(fcinfo, list, values, run->count, spill->func,
+			spill->crossings, false);
+		for (int j = 0; j < run->count; j ++)
+			pfree(values[j]);
+		pfree(values);
+	}
+	/* The spill itself is released with the aggregation context */
+	BufFileClose(spill->file);
+	spill->file = NULL;
+	pfree(spill->runs);
+	spill->runs = NULL;
+	spill->count = 0;
+}
+
+void
+skiplist_splice(FunctionCallInfo fcinfo, SkipList *list, Temporal **values,
+	int count, Datum (*func)(Datum, Datum), bool crossings)
+{
+	MOBDB_PROFILE_BEGIN(start);
+	skiplist_splice1(fcinfo, list, values, count, func, crossings, false);
+	if (skiplist_spill_needed(fcinfo, list))
+		skiplist_spill(fcinfo, list, func, crossings);
+	MOBDB_PROFILE_END("skiplist_splice", start);
+}
+
 PG_FUNCTION_INFO_V1(sl_test);
 PGDLLEXPORT Datum
 sl_test(PG_FUNCTION_ARGS)
@@ -444,6 +832,16 @@ sl_test(PG_FUNCTION_ARGS)
 	PG_RETURN_INT32(0);
 }
 
+/* Report the memory used by the aggregation state for tuning purposes */
+static void
+skiplist_report(SkipList *list)
+{
+	ereport(DEBUG1, (errmsg("Temporal aggregation state: %d values, "
+		"%zu bytes, peak %zu bytes, %d runs spilled to disk", list->length,
+		list->memsize, list->peakmemsize,
+		list->spill ? list->spill->count : 0)));
+}
+
 /*****************************************************************************
  * Numeric aggregate functions on datums
  *****************************************************************************/
@@ -477,13 +875,13 @@ datum_max_float8(Datum l, Datum r)
 Datum
 datum_min_text(Datum l, Datum r)
 {
-	return text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) < 0 ? l : r;
+	return text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) < 0 ? l : r;
 }
 
 Datum
 datum_max_text(Datum l, Datum r)
 {
-	return text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) > 0 ? l : r;
+	return text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) > 0 ? l : r;
 }
 
 /* Get the sum of the two arguments */
@@ -525,43 +923,61 @@ datum_sum_double4(Datum l, Datum r)
  * Generic binary aggregate functions needed for parallelization
  *****************************************************************************/
 
-static void 
+/*
+ * The aggregate state is serialized in a compact binary format that simply
+ * copies the flat in-memory representation of the temporal values kept in
+ * the skiplist, which are always TemporalInst or TemporalSeq values. This
+ * avoids calling the send/receive functions of the base type for every
+ * instant, which requires SPI, and works for the internal types double2,
+ * double3, and double4 used by tavg and tcentroid. The format is a valid
+ * exchange format between the workers of the same server, it must not be
+ * used for any kind of persistent storage.
+ *
+ * The binary format is as follows
+ * - int32 number of temporal values
+ * - for each temporal value: int32 size followed by the bytes of the value
+ * - int32 size of the extra data followed by the bytes of the extra data
+ */
+void
 aggstate_write(SkipList *state, StringInfo buf)
 {
-	Temporal **values = skiplist_values(state);
 	pq_sendint32(buf, (uint32) state->length);
-	Oid valuetypid = InvalidOid;
-	if (state->length > 0)
-		valuetypid = values[0]->valuetypid;
-	pq_sendint32(buf, valuetypid);
-	for (int i = 0; i < state->length; i ++)
+	int cur = state->elems[0].next[0];
+	while (cur != state->tail)
 	{
-		SPI_connect();
-		temporal_write(values[i], buf);
-		SPI_finish();
+		Temporal *value = state->elems[cur].value;
+		pq_sendint32(buf, VARSIZE(value));
+		pq_sendbytes(buf, (char *) value, (int) VARSIZE(value));
+		cur = state->elems[cur].next[0];
 	}
-	pq_sendint64(buf, state->extrasize);
+	pq_sendint32(buf, (uint32) state->extrasize);
 	if (state->extra)
 		pq_sendbytes(buf, state->extra, (int) state->extrasize);
-	pfree(values);
 }
 
-static SkipList *
+SkipList *
 aggstate_read(FunctionCallInfo fcinfo, StringInfo buf)
 {
-	int size = pq_getmsgint(buf, 4);
-	Oid valuetypid = pq_getmsgint(buf, 4);
-	Temporal **values = palloc0(sizeof(Temporal *) * size);
-	for (int i = 0; i < size; i ++)
-		values[i] = temporal_read(buf, valuetypid);
-	SkipList *result = skiplist_make(fcinfo, values, size);
-	size_t extrasize = (size_t) pq_getmsgint64(buf);
+	int count = pq_getmsgint(buf, 4);
+	if (count <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+			errmsg("Invalid serialized state for temporal aggregation")));
+	Temporal **values = palloc(sizeof(Temporal *) * count);
+	for (int i = 0; i < count; i ++)
+	{
+		int size = pq_getmsgint(buf, 4);
+		/* Copy the value to ensure that it is properly aligned */
+		values[i] = palloc(size);
+		pq_copymsgbytes(buf, (char *) values[i], size);
+	}
+	SkipList *result = skiplist_make(fcinfo, values, count);
+	size_t extrasize = (size_t) pq_getmsgint(buf, 4);
 	if (extrasize)
 	{
 		const char *extra = pq_getmsgbytes(buf, (int) extrasize);
 		aggstate_set_extra(fcinfo, result, (void *)extra, extrasize);
 	}
-	for (int i = 0; i < size; i ++)
+	for (int i = 0; i < count; i ++)
 		pfree(values[i]);
 	pfree(values);
 	return result;
@@ -586,6 +1002,7 @@ PGDLLEXPORT Datum
 temporal_tagg_serialize(PG_FUNCTION_ARGS)
 {
 	SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
+	skiplist_unspill(fcinfo, state);
 	StringInfoData buf;
 	pq_begintypsend(&buf);
 	aggstate_write(state, &buf);
@@ -602,10 +1019,11 @@ temporal_tagg_deserialize(PG_FUNCTION_ARGS)
 	{
 		.cursor = 0,
 		.data = VARDATA(data),
-		.len = VARSIZE(data),
-		.maxlen = VARSIZE(data)
+		.len = VARSIZE(data) - VARHDRSZ,
+		.maxlen = VARSIZE(data) - VARHDRSZ
 	};
 	SkipList *result = aggstate_read(fcinfo, &buf);
+	pq_getmsgend(&buf);
 	PG_RETURN_POINTER(result);
 }
 
@@ -615,35 +1033,37 @@ temporal_tagg_deserialize(PG_FUNCTION_ARGS)
 
 /*
  * Transform a temporal type into a temporal integer for performing count
- * aggregation
+ * aggregation. The inverse transformation, used for removing a value from
+ * the state of a moving aggregate, yields a count of -1 instead of 1.
  */
  
 static TemporalInst *
-temporalinst_transform_tcount(TemporalInst *inst)
+temporalinst_transform_tcount(TemporalInst *inst, bool inverse)
 {
-	return temporalinst_make(Int32GetDatum(1), inst->t, INT4OID);
+	return temporalinst_make(Int32GetDatum(inverse ? -1 : 1), inst->t, INT4OID);
 }
 
 static TemporalInst **
-temporali_transform_tcount(TemporalI *ti)
+temporali_transform_tcount(TemporalI *ti, bool inverse)
 {
 	TemporalInst **result = palloc(sizeof(TemporalInst *) * ti->count);
 	for (int i = 0; i < ti->count; i++)
 	{
 		TemporalInst *inst = temporali_inst_n(ti, i);
-		result[i] = temporalinst_make(Int32GetDatum(1), inst->t, INT4OID);
+		result[i] = temporalinst_transform_tcount(inst, inverse);
 	}
 	return result;
 }
 
 static TemporalSeq *
-temporalseq_transform_tcount(TemporalSeq *seq)
+temporalseq_transform_tcount(TemporalSeq *seq, bool inverse)
 {
 	TemporalSeq *result;
+	Datum value = Int32GetDatum(inverse ? -1 : 1);
 	if (seq->count == 1)
 	{
-		TemporalInst *inst = temporalinst_make(Int32GetDatum(1), 
-			seq->period.lower, INT4OID); 
+		TemporalInst *inst = temporalinst_make(value, seq->period.lower, 
+			INT4OID); 
 		result = temporalseq_from_temporalinstarr(&inst, 1,
 			true, true, false, false);
 		pfree(inst);
@@ -651,10 +1071,8 @@ temporalseq_transform_tcount(TemporalSeq *seq)
 	}
 
 	TemporalInst *instants[2];
-	instants[0] = temporalinst_make(Int32GetDatum(1), seq->period.lower,
-		INT4OID); 
-	instants[1] = temporalinst_make(Int32GetDatum(1), seq->period.upper,
-		INT4OID); 
+	instants[0] = temporalinst_make(value, seq->period.lower, INT4OID); 
+	instants[1] = temporalinst_make(value, seq->period.upper, INT4OID); 
 	result = temporalseq_from_temporalinstarr(instants, 2,
 		seq->period.lower_inc, seq->period.upper_inc, false, false);
 	pfree(instants[0]); pfree(instants[1]); 
@@ -662,13 +1080,13 @@ temporalseq_transform_tcount(TemporalSeq *seq)
 }
 
 static TemporalSeq **
-temporals_transform_tcount(TemporalS *ts)
+temporals_transform_tcount(TemporalS *ts, bool inverse)
 {
 	TemporalSeq **result = palloc(sizeof(TemporalSeq *) * ts->count);
 	for (int i = 0; i < ts->count; i++)
 	{
 		TemporalSeq *seq = temporals_seq_n(ts, i);
-		result[i] = temporalseq_transform_tcount(seq);
+		result[i] = temporalseq_transform_tcount(seq, inverse);
 	}
 	return result;
 }
@@ -676,29 +1094,33 @@ temporals_transform_tcount(TemporalS *ts)
 /* Dispatch function */
 
 static Temporal **
-temporal_transform_tcount(Temporal *temp, int *count)
+temporal_transform_tcount(Temporal *temp, bool inverse, int *count)
 {
 	Temporal **result = NULL;
 	if (temp->duration == TEMPORALINST) 
 	{
 		result = palloc(sizeof(Temporal *));
-		result[0] = (Temporal *)temporalinst_transform_tcount((TemporalInst *)temp);
+		result[0] = (Temporal *)temporalinst_transform_tcount(
+			(TemporalInst *)temp, inverse);
 		*count = 1;
 	}
 	else if (temp->duration == TEMPORALI)
 	{
-		result = (Temporal **)temporali_transform_tcount((TemporalI *) temp);
+		result = (Temporal **)temporali_transform_tcount((TemporalI *) temp,
+			inverse);
 		*count = ((TemporalI *)temp)->count;
 	} 
 	else if (temp->duration == TEMPORALSEQ)
 	{
 		result = palloc(sizeof(Temporal *));
-		result[0] = (Temporal *)temporalseq_transform_tcount((TemporalSeq *) temp);
+		result[0] = (Temporal *)temporalseq_transform_tcount(
+			(TemporalSeq *) temp, inverse);
 		*count = 1;
 	}
 	else if (temp->duration == TEMPORALS)
 	{
-		result = (Temporal **)temporals_transform_tcount((TemporalS *) temp);
+		result = (Temporal **)temporals_transform_tcount((TemporalS *) temp,
+			inverse);
 		*count = ((TemporalS *)temp)->count;
 	}
 	assert(result != NULL);
@@ -709,40 +1131,44 @@ temporal_transform_tcount(Temporal *temp, int *count)
 
 /*
  * Transform a temporal number type into a temporal double2 type for 
- * performing average aggregation 
+ * performing average aggregation. The inverse transformation yields the
+ * pairs (-value, -1) instead of (value, 1).
  */
 
 static TemporalInst *
-tnumberinst_transform_tavg(TemporalInst *inst)
+tnumberinst_transform_tavg(TemporalInst *inst, bool inverse)
 {
 	double value = datum_double(temporalinst_value(inst), inst->valuetypid);
 	double2 dvalue;
-	double2_set(&dvalue, value, 1);
+	if (inverse)
+		double2_set(&dvalue, -value, -1);
+	else
+		double2_set(&dvalue, value, 1);
 	TemporalInst *result = temporalinst_make(PointerGetDatum(&dvalue), inst->t,
 		type_oid(T_DOUBLE2));
 	return result;
 }
 
 static TemporalInst **
-tnumberi_transform_tavg(TemporalI *ti)
+tnumberi_transform_tavg(TemporalI *ti, bool inverse)
 {
 	TemporalInst **result = palloc(sizeof(TemporalInst *) * ti->count);
 	for (int i = 0; i < ti->count; i++)
 	{
 		TemporalInst *inst = temporali_inst_n(ti, i);
-		result[i] = tnumberinst_transform_tavg(inst);
+		result[i] = tnumberinst_transform_tavg(inst, inverse);
 	}
 	return result;
 }
 
 static TemporalSeq *
-tnumberseq_transform_tavg(TemporalSeq *seq)
+tnumberseq_transform_tavg(TemporalSeq *seq, bool inverse)
 {
 	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
 	for (int i = 0; i < seq->count; i++)
 	{
 		TemporalInst *inst = temporalseq_inst_n(seq, i);
-		instants[i] = tnumberinst_transform_tavg(inst);
+		instants[i] = tnumberinst_transform_tavg(inst, inverse);
 	}
 	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, seq->count,
 		seq->period.lower_inc, seq->period.upper_inc,
@@ -755,13 +1181,13 @@ tnumberseq_transform_tavg(TemporalSeq *seq)
 }
 
 static TemporalSeq **
-tnumbers_transform_tavg(TemporalS *ts)
+tnumbers_transform_tavg(TemporalS *ts, bool inverse)
 {
 	TemporalSeq **result = palloc(sizeof(TemporalSeq *) * ts->count);
 	for (int i = 0; i < ts->count; i++)
 	{
 		TemporalSeq *seq = temporals_seq_n(ts, i);
-		result[i] = tnumberseq_transform_tavg(seq);
+		result[i] = tnumberseq_transform_tavg(seq, inverse);
 	}
 	return result;
 }
@@ -769,29 +1195,33 @@ tnumbers_transform_tavg(TemporalS *ts)
 /* Dispatch function  */
 
 static Temporal **
-tnumber_transform_tavg(Temporal *temp, int *count)
+tnumber_transform_tavg(Temporal *temp, bool inverse, int *count)
 {
 	Temporal **result = NULL;
 	if (temp->duration == TEMPORALINST) 
 	{
 		result = palloc(sizeof(Temporal *));
-		result[0] = (Temporal *)tnumberinst_transform_tavg((TemporalInst *)temp);
+		result[0] = (Temporal *)tnumberinst_transform_tavg(
+			(TemporalInst *)temp, inverse);
 		*count = 1;
 	}
 	else if (temp->duration == TEMPORALI)
 	{
-		result = (Temporal **)tnumberi_transform_tavg((TemporalI *) temp);
+		result = (Temporal **)tnumberi_transform_tavg((TemporalI *) temp,
+			inverse);
 		*count = ((TemporalI *)temp)->count;
 	} 
 	else if (temp->duration == TEMPORALSEQ)
 	{
 		result = palloc(sizeof(Temporal *));
-		result[0] = (Temporal *)tnumberseq_transform_tavg((TemporalSeq *) temp);
+		result[0] = (Temporal *)tnumberseq_transform_tavg((TemporalSeq *) temp,
+			inverse);
 		*count = 1;
 	} 
 	else if (temp->duration == TEMPORALS)
 	{
-		result = (Temporal **)tnumbers_transform_tavg((TemporalS *) temp);
+		result = (Temporal **)tnumbers_transform_tavg((TemporalS *) temp,
+			inverse);
 		*count = ((TemporalS *)temp)->count;
 	} 
 	assert(result != NULL);
@@ -933,22 +1363,11 @@ temporalseq_tagg1(TemporalSeq **result,	TemporalSeq *seq1, TemporalSeq *seq2,
 	/*
 	 * Compute the aggregation on the intersection of intervals
 	 */
-	TemporalSeq *syncseq1, *syncseq2;
-	synchronize_temporalseq_temporalseq(seq1, seq2, &syncseq1, &syncseq2, crossings);
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * syncseq1->count);
-	for (int i = 0; i < syncseq1->count; i++)
-	{
-		TemporalInst *inst1 = temporalseq_inst_n(syncseq1, i);
-		TemporalInst *inst2 = temporalseq_inst_n(syncseq2, i);
-		instants[i] = temporalinst_make(
-			func(temporalinst_value(inst1), temporalinst_value(inst2)),
-			inst1->t, inst1->valuetypid);
-	}
-	sequences[k++] = temporalseq_from_temporalinstarr(instants, syncseq1->count, 
-		lower_inc, upper_inc, MOBDB_FLAGS_GET_LINEAR(seq1->flags), true);
-	for (int i = 0; i < syncseq1->count; i++)
-		pfree(instants[i]);
-	pfree(instants); pfree(syncseq1); pfree(syncseq2);
+	bool linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
+	bool linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
+	sequences[k++] = sync_tfunc2_temporalseq_temporalseq(seq1, seq2, func,
+		seq1->valuetypid, linear1, (crossings && (linear1 || linear2)) ?
+		&tnumberseq_intersect_at_timestamp : NULL);
 	
 	/* Compute the aggregation on the period after the intersection 
 	 * of the intervals */
@@ -967,10 +1386,11 @@ temporalseq_tagg1(TemporalSeq **result,	TemporalSeq *seq1, TemporalSeq *seq2,
 	pfree(intersect); 
 
 	/* Normalization */
-	if (k == 1)
+	if (k == 1 || !temporalseqarr_has_adjacent(sequences, k))
 	{
-		result[0] = sequences[0];
-		return 1;
+		for (int i = 0; i < k; i++)
+			result[i] = sequences[i];
+		return k;
 	}
 	int l;
 	TemporalSeq **normsequences = temporalseqarr_normalize(sequences, k, &l);
@@ -1051,13 +1471,10 @@ temporalseq_tagg(TemporalSeq **sequences1, int count1, TemporalSeq **sequences2,
 		sequences[k++] = temporalseq_copy(sequences2[j++]);
 
 	/* Normalization */
-	if (k == 1)
+	if (k == 1 || !temporalseqarr_has_adjacent(sequences, k))
 	{
-		TemporalSeq **result = palloc(sizeof(TemporalSeq *));
-		result[0] = sequences[0];
-		pfree(sequences);
-		*newcount = 1;	
-		return result;
+		*newcount = k;
+		return sequences;
 	}
 	int l;
 	TemporalSeq **result = temporalseqarr_normalize(sequences, k, &l);
@@ -1197,10 +1614,14 @@ temporal_tagg_combinefn(FunctionCallInfo fcinfo, SkipList *state1,
 		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
 			errmsg("Cannot aggregate temporal values of different interpolation")));
 
+	skiplist_unspill(fcinfo, state2);
 	int count2 = state2->length;
 	Temporal **values2 = skiplist_values(state2);
 	skiplist_splice(fcinfo, state1, values2, count2, func, crossings);
 	pfree(values2);
+	/* The values of state2 have been copied into state1 */
+	MemoryContextDelete(state2->ctx);
+	state2->ctx = NULL;
 	return state1;
 }
 
@@ -1208,37 +1629,55 @@ temporal_tagg_combinefn(FunctionCallInfo fcinfo, SkipList *state1,
  * Extent
  *****************************************************************************/
 
+/*
+ * The extent aggregates only need the bounding box of the temporal values,
+ * which is obtained from the slices of the values containing it without
+ * detoasting them completely. Since the state is a box type of fixed size,
+ * it is updated in place when the functions are called as aggregates, and
+ * passed as is between parallel workers without the need of serialization
+ * functions.
+ */
+
+/*
+ * Returns a box in which the state value is expanded: the state itself
+ * when called in aggregate context, or a copy of it otherwise
+ */
+static void *
+extent_state(FunctionCallInfo fcinfo, void *state, size_t size)
+{
+	if (AggCheckCallContext(fcinfo, NULL))
+		return state;
+	void *result = palloc(size);
+	memcpy(result, state, size);
+	return result;
+}
+
 PG_FUNCTION_INFO_V1(temporal_extent_transfn);
 
 PGDLLEXPORT Datum 
 temporal_extent_transfn(PG_FUNCTION_ARGS)
 {
 	Period *p = PG_ARGISNULL(0) ? NULL : PG_GETARG_PERIOD(0);
-	Temporal *temp = PG_ARGISNULL(1) ? NULL : PG_GETARG_TEMPORAL(1);
-	Period p1, *result = NULL;
+	Period p1, *result;
 
 	/* Can't do anything with null inputs */
-	if (!p && !temp)
+	if (!p && PG_ARGISNULL(1))
 		PG_RETURN_NULL();
+	/* Non-null period and null temporal, return the period */
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(p);
+
+	temporal_bbox_slice(PG_GETARG_DATUM(1), &p1);
 	/* Null period and non-null temporal, return the bbox of the temporal */
 	if (!p)
 	{
 		result = palloc(sizeof(Period));
-		temporal_bbox(result, temp);
-		PG_RETURN_POINTER(result);
-	}
-	/* Non-null period and null temporal, return the period */
-	if (!temp)
-	{
-		result = palloc(sizeof(Period));
-		memcpy(result, p, sizeof(Period));
+		memcpy(result, &p1, sizeof(Period));
 		PG_RETURN_POINTER(result);
 	}
 
-	temporal_bbox(&p1, temp);
-	result = period_super_union(p, &p1);
-
-	PG_FREE_IF_COPY(temp, 1);
+	result = extent_state(fcinfo, p, sizeof(Period));
+	period_expand(result, &p1);
 	PG_RETURN_POINTER(result);
 }
 
@@ -1258,7 +1697,8 @@ temporal_extent_combinefn(PG_FUNCTION_ARGS)
 	if (p2 && !p1)
 		PG_RETURN_POINTER(p2);
 
-	result = period_super_union(p1, p2);
+	result = extent_state(fcinfo, p1, sizeof(Period));
+	period_expand(result, p2);
 	PG_RETURN_POINTER(result);
 }
 
@@ -1270,25 +1710,22 @@ PGDLLEXPORT Datum
 tnumber_extent_transfn(PG_FUNCTION_ARGS)
 {
 	TBOX *box = PG_ARGISNULL(0) ? NULL : PG_GETARG_TBOX_P(0);
-	Temporal *temp = PG_ARGISNULL(1) ? NULL : PG_GETARG_TEMPORAL(1);
-	TBOX box1, *result = NULL;
+	TBOX box1, *result;
 	memset(&box1, 0, sizeof(TBOX));
 
 	/* Can't do anything with null inputs */
-	if (!box && !temp)
+	if (!box && PG_ARGISNULL(1))
 		PG_RETURN_NULL();
+	/* Non-null box and null temporal, return the box */
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(box);
+
+	temporal_bbox_slice(PG_GETARG_DATUM(1), &box1);
 	/* Null box and non-null temporal, return the bbox of the temporal */
 	if (!box)
 	{
 		result = palloc(sizeof(TBOX));
-		temporal_bbox(result, temp);
-		PG_RETURN_POINTER(result);
-	}
-	/* Non-null box and null temporal, return the box */
-	if (!temp)
-	{
-		result = palloc(sizeof(TBOX));
-		memcpy(result, box, sizeof(TBOX));
+		memcpy(result, &box1, sizeof(TBOX));
 		PG_RETURN_POINTER(result);
 	}
 
@@ -1296,16 +1733,8 @@ tnumber_extent_transfn(PG_FUNCTION_ARGS)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				errmsg("Argument TBOX must have both X and T dimensions")));
 
-	temporal_bbox(&box1, temp);
-	result = palloc(sizeof(TBOX));
-	result->xmax = Max(box->xmax, box1.xmax);
-	result->tmax = Max(box->tmax, box1.tmax);
-	result->xmin = Min(box->xmin, box1.xmin);
-	result->tmin = Min(box->tmin, box1.tmin);
-	MOBDB_FLAGS_SET_X(result->flags, true);
-	MOBDB_FLAGS_SET_T(result->flags, true);
-
-	PG_FREE_IF_COPY(temp, 1);
+	result = extent_state(fcinfo, box, sizeof(TBOX));
+	tbox_expand(result, &box1);
 	PG_RETURN_POINTER(result);
 }
 
@@ -1330,14 +1759,8 @@ tnumber_extent_combinefn(PG_FUNCTION_ARGS)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				errmsg("Argument TBOX must have both X and T dimensions")));
 
-	result = palloc(sizeof(TBOX));
-	result->xmax = Max(box1->xmax, box2->xmax);
-	result->tmax = Max(box1->tmax, box2->tmax);
-	result->xmin = Min(box1->xmin, box2->xmin);
-	result->tmin = Min(box1->tmin, box2->tmin);
-	MOBDB_FLAGS_SET_X(result->flags, true);
-	MOBDB_FLAGS_SET_T(result->flags, true);
-
+	result = extent_state(fcinfo, box1, sizeof(TBOX));
+	tbox_expand(result, box2);
 	PG_RETURN_POINTER(result);
 }
 
@@ -1750,7 +2173,7 @@ temporal_tcount_transfn(PG_FUNCTION_ARGS)
 
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	int count;
-	Temporal **temporals = temporal_transform_tcount(temp, &count);
+	Temporal **temporals = temporal_transform_tcount(temp, false, &count);
 	if (state)
 	{
 		if (skiplist_headval(state)->duration != temporals[0]->duration)
@@ -1796,6 +2219,8 @@ temporal_tagg_finalfn(PG_FUNCTION_ARGS)
 	SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
 	if (state->length == 0)
 		PG_RETURN_NULL();
+	skiplist_report(state);
+	skiplist_unspill(fcinfo, state);
 
 	Temporal **values = skiplist_values(state);
 	Temporal *result = NULL;
@@ -1833,7 +2258,7 @@ tnumber_tavg_transfn(PG_FUNCTION_ARGS)
 
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	int count;
-	Temporal **temporals = tnumber_transform_tavg(temp, &count);
+	Temporal **temporals = tnumber_transform_tavg(temp, false, &count);
 	if (state)
 	{
 		if (skiplist_headval(state)->duration != temporals[0]->duration)
@@ -1875,19 +2300,32 @@ tnumber_tavg_combinefn(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
-/* Final function for tavg */
+/* 
+ * Final functions for the aggregates whose state keeps double2 values
+ * (sum, count), which return either the sum or the average
+ */
+
+static Datum
+double2_final_value(double2 *value, bool avg, Oid restypid)
+{
+	if (avg)
+		return Float8GetDatum(value->a / value->b);
+	if (restypid == INT4OID)
+		return Int32GetDatum((int) value->a);
+	return Float8GetDatum(value->a);
+}
 
 static TemporalI *
-temporalinst_tavg_finalfn(TemporalInst **instants, int count)
+temporalinst_double2_finalfn(TemporalInst **instants, int count, bool avg,
+	Oid restypid)
 {
 	TemporalInst **newinstants = palloc(sizeof(TemporalInst *) * count);
 	for (int i = 0; i < count; i++)
 	{
 		TemporalInst *inst = instants[i];
 		double2 *value = (double2 *)DatumGetPointer(temporalinst_value(inst));
-		double tavg = value->a / value->b;
-		newinstants[i] = temporalinst_make(Float8GetDatum(tavg), inst->t,
-			FLOAT8OID);
+		newinstants[i] = temporalinst_make(
+			double2_final_value(value, avg, restypid), inst->t, restypid);
 	}
 	TemporalI *result = temporali_from_temporalinstarr(newinstants, count);
 
@@ -1899,7 +2337,8 @@ temporalinst_tavg_finalfn(TemporalInst **instants, int count)
 }
 
 static TemporalS *
-temporalseq_tavg_finalfn(TemporalSeq **sequences, int count)
+temporalseq_double2_finalfn(TemporalSeq **sequences, int count, bool avg,
+	Oid restypid)
 {
 	TemporalSeq **newsequences = palloc(sizeof(TemporalSeq *) * count);
 	for (int i = 0; i < count; i++)
@@ -1910,9 +2349,8 @@ temporalseq_tavg_finalfn(TemporalSeq **sequences, int count)
 		{
 			TemporalInst *inst = temporalseq_inst_n(seq, j);
 			double2 *value2 = (double2 *)DatumGetPointer(temporalinst_value(inst));
-			double value = value2->a / value2->b;
-			instants[j] = temporalinst_make(Float8GetDatum(value), inst->t,
-				FLOAT8OID);
+			instants[j] = temporalinst_make(
+				double2_final_value(value2, avg, restypid), inst->t, restypid);
 		}
 		newsequences[i] = temporalseq_from_temporalinstarr(instants, 
 			seq->count, seq->period.lower_inc, seq->period.upper_inc, 
@@ -1931,28 +2369,610 @@ temporalseq_tavg_finalfn(TemporalSeq **sequences, int count)
 	return result;
 }
 
-PG_FUNCTION_INFO_V1(tnumber_tavg_finalfn);
-
-PGDLLEXPORT Datum
-tnumber_tavg_finalfn(PG_FUNCTION_ARGS)
+static Datum
+double2_tagg_finalfn(FunctionCallInfo fcinfo, bool avg, Oid restypid)
 {
 	/* The final function is strict, we do not need to test for null values */
 	SkipList *state = (SkipList *) PG_GETARG_POINTER(0);
 	if (state->length == 0)
 		PG_RETURN_NULL();
+	skiplist_report(state);
+	skiplist_unspill(fcinfo, state);
 
 	Temporal **values = skiplist_values(state);
 	Temporal *result = NULL;
 	assert(values[0]->duration == TEMPORALINST || 
 		values[0]->duration == TEMPORALSEQ);
 	if (values[0]->duration == TEMPORALINST)
-		result = (Temporal *)temporalinst_tavg_finalfn(
-			(TemporalInst **)values, state->length);
+		result = (Temporal *)temporalinst_double2_finalfn(
+			(TemporalInst **)values, state->length, avg, restypid);
 	else if (values[0]->duration == TEMPORALSEQ)
-		result = (Temporal *)temporalseq_tavg_finalfn(
-			(TemporalSeq **)values, state->length);
+		result = (Temporal *)temporalseq_double2_finalfn(
+			(TemporalSeq **)values, state->length, avg, restypid);
 	pfree(values);
 	PG_RETURN_POINTER(result);
 }
 
+PG_FUNCTION_INFO_V1(tnumber_tavg_finalfn);
+
+PGDLLEXPORT Datum
+tnumber_tavg_finalfn(PG_FUNCTION_ARGS)
+{
+	return double2_tagg_finalfn(fcinfo, true, FLOAT8OID);
+}
+
+/*****************************************************************************
+ * Moving aggregates
+ *****************************************************************************/
+
+/*
+ * The aggregates tcount, tsum, and tavg have a moving-aggregate variant
+ * that is used for window frames whose start moves, which removes the 
+ * rows leaving the frame from the state instead of recomputing the 
+ * aggregate for every frame. The value of a removed row is spliced into
+ * the skiplist with its negated contribution and the parts of the state
+ * where no value remains are removed. This requires that the state keeps
+ * the number of values aggregated at each instant, which is the case for
+ * tcount, and for tsum and tavg whose moving state keeps double2 values
+ * (sum, count). Since moving-aggregate transition functions must not 
+ * return null, the state of a frame without any value is an empty list.
+ */
+static SkipList *
+skiplist_moving_transfn(FunctionCallInfo fcinfo, SkipList *state,
+	Temporal **values, int count, Datum (*func)(Datum, Datum), bool inverse)
+{
+	if (! state)
+		return skiplist_make(fcinfo, values, count);
+	if (count == 0)
+		return state;
+	if (state->length == 0)
+	{
+		if (inverse)
+			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+				errmsg("Cannot remove a value that was not aggregated")));
+	}
+	else
+	{
+		Temporal *head = skiplist_headval(state);
+		if (head->duration != values[0]->duration)
+			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+				errmsg("Cannot aggregate temporal values of different duration")));
+		if (MOBDB_FLAGS_GET_LINEAR(head->flags) != 
+				MOBDB_FLAGS_GET_LINEAR(values[0]->flags))
+			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+				errmsg("Cannot aggregate temporal values of different interpolation")));
+	}
+	skiplist_splice1(fcinfo, state, values, count, func, false, inverse);
+	return state;
+}
+
+static Datum
+temporal_tcount_moving(FunctionCallInfo fcinfo, bool inverse)
+{
+	SkipList *state = PG_ARGISNULL(0) ? NULL : 
+		(SkipList *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(skiplist_moving_transfn(fcinfo, state, NULL, 0,
+			&datum_sum_int32, inverse));
+
+	Temporal *temp = PG_GETARG_TEMPORAL(1);
+	int count;
+	Temporal **temporals = temporal_transform_tcount(temp, inverse, &count);
+	state = skiplist_moving_transfn(fcinfo, state, temporals, count,
+		&datum_sum_int32, inverse);
+	for (int i = 0; i < count; i++)
+		pfree(temporals[i]);
+	pfree(temporals);
+	PG_FREE_IF_COPY(temp, 1);
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_mtransfn);
+
+PGDLLEXPORT Datum 
+temporal_tcount_mtransfn(PG_FUNCTION_ARGS)
+{
+	return temporal_tcount_moving(fcinfo, false);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_invtransfn);
+
+PGDLLEXPORT Datum 
+temporal_tcount_invtransfn(PG_FUNCTION_ARGS)
+{
+	return temporal_tcount_moving(fcinfo, true);
+}
+
+static Datum
+tnumber_tavg_moving(FunctionCallInfo fcinfo, bool inverse)
+{
+	SkipList *state = PG_ARGISNULL(0) ? NULL : 
+		(SkipList *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1))
+		PG_RETURN_POINTER(skiplist_moving_transfn(fcinfo, state, NULL, 0,
+			&datum_sum_double2, inverse));
+
+	Temporal *temp = PG_GETARG_TEMPORAL(1);
+	int count;
+	Temporal **temporals = tnumber_transform_tavg(temp, inverse, &count);
+	state = skiplist_moving_transfn(fcinfo, state, temporals, count,
+		&datum_sum_double2, inverse);
+	for (int i = 0; i < count; i++)
+		pfree(temporals[i]);
+	pfree(temporals);
+	PG_FREE_IF_COPY(temp, 1);
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_mtransfn);
+
+PGDLLEXPORT Datum 
+tnumber_tavg_mtransfn(PG_FUNCTION_ARGS)
+{
+	return tnumber_tavg_moving(fcinfo, false);
+}
+
+PG_FUNCTION_INFO_V1(tnumber_tavg_invtransfn);
+
+PGDLLEXPORT Datum 
+tnumber_tavg_invtransfn(PG_FUNCTION_ARGS)
+{
+	return tnumber_tavg_moving(fcinfo, true);
+}
+
+PG_FUNCTION_INFO_V1(tint_tsum_mfinalfn);
+
+PGDLLEXPORT Datum
+tint_tsum_mfinalfn(PG_FUNCTION_ARGS)
+{
+	return double2_tagg_finalfn(fcinfo, false, INT4OID);
+}
+
+PG_FUNCTION_INFO_V1(tfloat_tsum_mfinalfn);
+
+PGDLLEXPORT Datum
+tfloat_tsum_mfinalfn(PG_FUNCTION_ARGS)
+{
+	return double2_tagg_finalfn(fcinfo, false, FLOAT8OID);
+}
+
+/*****************************************************************************
+ * Aggregate building a temporal sequence from (value, timestamp) rows
+ *****************************************************************************/
+
+/*
+ * The state of the aggregate is an array of instants whose capacity is
+ * doubled when it is full, so that appending an instant has an amortized
+ * constant cost. The instants are only sorted in the final function when
+ * they were not appended in time order, which happens when the input rows
+ * are not ordered by time or when the states of parallel workers whose
+ * instants are interleaved in time are combined.
+ */
+
+static InstArr *
+instarr_make(FunctionCallInfo fcinfo)
+{
+	MemoryContext ctx = set_aggregation_context(fcinfo);
+	InstArr *result = palloc(sizeof(InstArr));
+	result->count = 0;
+	result->capacity = INSTARR_INITIAL_CAPACITY;
+	result->ordered = true;
+	result->instants = palloc(sizeof(TemporalInst *) * result->capacity);
+	unset_aggregation_context(ctx);
+	return result;
+}
+
+/* Append an instant that is already allocated in the aggregate context */
+static void
+instarr_append_inst(InstArr *state, TemporalInst *inst)
+{
+	if (state->count == state->capacity)
+	{
+		state->capacity *= 2;
+		state->instants = repalloc(state->instants, 
+			sizeof(TemporalInst *) * state->capacity);
+	}
+	if (state->count > 0 && 
+		timestamp_cmp_internal(state->instants[state->count - 1]->t, inst->t) >= 0)
+		state->ordered = false;
+	state->instants[state->count++] = inst;
+}
+
+/*
+ * Append the instant composed of the value and the timestamp to the state,
+ * creating the state if it is NULL
+ */
+InstArr *
+instarr_append(FunctionCallInfo fcinfo, InstArr *state, Datum value, 
+	TimestampTz t, Oid valuetypid)
+{
+	if (! state)
+		state = instarr_make(fcinfo);
+	MemoryContext ctx = set_aggregation_context(fcinfo);
+	instarr_append_inst(state, temporalinst_make(value, t, valuetypid));
+	unset_aggregation_context(ctx);
+	return state;
+}
+
+PG_FUNCTION_INFO_V1(temporal_tseq_agg_transfn);
+
+PGDLLEXPORT Datum
+temporal_tseq_agg_transfn(PG_FUNCTION_ARGS)
+{
+	InstArr *state = PG_ARGISNULL(0) ? NULL : (InstArr *) PG_GETARG_POINTER(0);
+	/* Rows with a null value or a null timestamp are ignored */
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2))
+	{
+		if (! state)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state);
+	}
+	Oid valuetypid = get_fn_expr_argtype(fcinfo->flinfo, 1);
+	Datum value = PG_GETARG_DATUM(1);
+	/* Ensure that a varlena value does not have a short or toasted header */
+	if (get_typlen_fast(valuetypid) == -1)
+		value = PointerGetDatum(PG_DETOAST_DATUM(value));
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(2);
+	state = instarr_append(fcinfo, state, value, t, valuetypid);
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tseq_agg_combinefn);
+
+PGDLLEXPORT Datum
+temporal_tseq_agg_combinefn(PG_FUNCTION_ARGS)
+{
+	InstArr *state1 = PG_ARGISNULL(0) ? NULL : (InstArr *) PG_GETARG_POINTER(0);
+	InstArr *state2 = PG_ARGISNULL(1) ? NULL : (InstArr *) PG_GETARG_POINTER(1);
+	if (! state1 || ! state2)
+	{
+		if (! state1 && ! state2)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state1 ? state1 : state2);
+	}
+	/* Both states are in the aggregate context, only the pointers are moved */
+	MemoryContext ctx = set_aggregation_context(fcinfo);
+	if (! state2->ordered)
+		state1->ordered = false;
+	for (int i = 0; i < state2->count; i++)
+		instarr_append_inst(state1, state2->instants[i]);
+	unset_aggregation_context(ctx);
+	PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tseq_agg_finalfn);
+
+PGDLLEXPORT Datum
+temporal_tseq_agg_finalfn(PG_FUNCTION_ARGS)
+{
+	/* The final function is strict, we do not need to test for null values */
+	InstArr *state = (InstArr *) PG_GETARG_POINTER(0);
+	if (state->count == 0)
+		PG_RETURN_NULL();
+	/* Sorting the instants in place leaves a valid state */
+	if (! state->ordered)
+	{
+		temporalinstarr_sort(state->instants, state->count);
+		state->ordered = true;
+	}
+	TemporalSeq *result = temporalseq_from_temporalinstarr(state->instants, 
+		state->count, true, true, 
+		linear_interpolation(state->instants[0]->valuetypid), true);
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * The state is serialized, as the one of the temporal aggregates above, by
+ * copying the flat representation of the instants. It consists of an int32
+ * with the number of instants followed by the int32 size and the bytes of 
+ * each instant.
+ */
+
+PG_FUNCTION_INFO_V1(temporal_tseq_agg_serialize);
+
+PGDLLEXPORT Datum
+temporal_tseq_agg_serialize(PG_FUNCTION_ARGS)
+{
+	InstArr *state = (InstArr *) PG_GETARG_POINTER(0);
+	StringInfoData buf;
+	pq_begintypsend(&buf);
+	pq_sendint32(&buf, (uint32) state->count);
+	for (int i = 0; i < state->count; i++)
+	{
+		TemporalInst *inst = state->instants[i];
+		pq_sendint32(&buf, VARSIZE(inst));
+		pq_sendbytes(&buf, (char *) inst, (int) VARSIZE(inst));
+	}
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(temporal_tseq_agg_deserialize);
+
+PGDLLEXPORT Datum
+temporal_tseq_agg_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_P(0);
+	StringInfoData buf =
+	{
+		.cursor = 0,
+		.data = VARDATA(data),
+		.len = VARSIZE(data) - VARHDRSZ,
+		.maxlen = VARSIZE(data) - VARHDRSZ
+	};
+	int count = pq_getmsgint(&buf, 4);
+	if (count < 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+			errmsg("Invalid serialized state for temporal aggregation")));
+	InstArr *result = instarr_make(fcinfo);
+	MemoryContext ctx = set_aggregation_context(fcinfo);
+	for (int i = 0; i < count; i++)
+	{
+		int size = pq_getmsgint(&buf, 4);
+		/* Copy the value to ensure that it is properly aligned */
+		TemporalInst *inst = palloc(size);
+		pq_copymsgbytes(&buf, (char *) inst, size);
+		instarr_append_inst(result, inst);
+	}
+	unset_aggregation_context(ctx);
+	pq_getmsgend(&buf);
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************
+ * Temporal count per time bucket
+ *****************************************************************************/
+
+/*
+ * The state of the aggregate is an array of counters of the consecutive 
+ * buckets [origin + i * step, origin + (i + 1) * step) that intersect the
+ * time of the values aggregated so far. Each value increments the counters of
+ * the buckets intersecting its period set, so that no temporal value is
+ * built until the final function.
+ */
+
+static BucketCount *
+bucketcount_make(FunctionCallInfo fcinfo, TimestampTz origin, int64 step)
+{
+	MemoryContext ctx = set_aggregation_context(fcinfo);
+	BucketCount *result = palloc(sizeof(BucketCount));
+	result->origin = origin;
+	result->step = step;
+	result->first = 0;
+	result->count = 0;
+	result->capacity = BUCKETCOUNT_INITIAL_CAPACITY;
+	result->counts = palloc0(sizeof(int32) * result->capacity);
+	unset_aggregation_context(ctx);
+	return result;
+}
+
+/* 
+ * Extend the array of counters of the state so that it covers the buckets
+ * from lower to upper 
+ */
+static void
+bucketcount_extend(BucketCount *state, int64 lower, int64 upper)
+{
+	if (state->count == 0)
+		state->first = lower;
+	int64 first = Min(state->first, lower);
+	int64 last = (state->count == 0) ? upper :
+		Max(state->first + state->count - 1, upper);
+	int64 count = last - first + 1;
+	if ((Size) count > MaxAllocSize / sizeof(int32))
+		ereport(ERROR, (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+			errmsg("Too many buckets, the interval is too small for the time span of the values")));
+	if (count > state->capacity)
+	{
+		int capacity = (int) Min(Max(count, (int64) state->capacity * 2),
+			(int64) (MaxAllocSize / sizeof(int32)));
+		state->counts = repalloc(state->counts, sizeof(int32) * capacity);
+		state->capacity = capacity;
+	}
+	/* Shift the existing counters when the array is extended to the left */
+	int shift = (int) (state->first - first);
+	if (shift > 0 && state->count > 0)
+		memmove(&state->counts[shift], state->counts, 
+			sizeof(int32) * state->count);
+	memset(state->counts, 0, sizeof(int32) * shift);
+	int end = shift + state->count;
+	memset(&state->counts[end], 0, sizeof(int32) * (count - end));
+	state->first = first;
+	state->count = (int) count;
+}
+
+/* Increment the counters of the buckets intersecting the period set */
+static void
+bucketcount_add_periodset(BucketCount *state, PeriodSet *ps)
+{
+	Period *p = periodset_per_n(ps, 0);
+	int64 lower = timestamp_grid_bucket(p->lower, state->origin, state->step);
+	p = periodset_per_n(ps, ps->count - 1);
+	int64 upper = timestamp_grid_bucket(p->upper, state->origin, state->step);
+	bucketcount_extend(state, lower, upper);
+	/* Last bucket incremented, a bucket is counted once per value */
+	int64 last = lower - 1;
+	for (int i = 0; i < ps->count; i++)
+	{
+		p = periodset_per_n(ps, i);
+		lower = timestamp_grid_bucket(p->lower, state->origin, state->step);
+		upper = timestamp_grid_bucket(p->upper, state->origin, state->step);
+		/* An exclusive upper bound at the start of a bucket does not 
+		 * intersect it */
+		if (upper > lower && ! p->upper_inc &&
+			state->origin + upper * state->step == p->upper)
+			upper--;
+		if (lower <= last)
+			lower = last + 1;
+		for (int64 j = lower; j <= upper; j++)
+			state->counts[j - state->first]++;
+		if (upper > last)
+			last = upper;
+	}
+}
+
+static void
+ensure_same_bucket_grid(BucketCount *state, TimestampTz origin, int64 step)
+{
+	if (state->origin != origin || state->step != step)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The interval and the origin of the buckets must be the same for all values")));
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_buckets_transfn);
+
+PGDLLEXPORT Datum
+temporal_tcount_buckets_transfn(PG_FUNCTION_ARGS)
+{
+	BucketCount *state = PG_ARGISNULL(0) ? NULL : 
+		(BucketCount *) PG_GETARG_POINTER(0);
+	if (PG_ARGISNULL(1) || PG_ARGISNULL(2) || 
+		(PG_NARGS() > 3 && PG_ARGISNULL(3)))
+	{
+		if (! state)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state);
+	}
+	Temporal *temp = PG_GETARG_TEMPORAL(1);
+	Interval *interval = PG_GETARG_INTERVAL_P(2);
+	int64 step = interval_grid_step(interval);
+	TimestampTz origin = (PG_NARGS() > 3) ? PG_GETARG_TIMESTAMPTZ(3) : 
+		BUCKETCOUNT_DEFAULT_ORIGIN;
+	if (! state)
+		state = bucketcount_make(fcinfo, origin, step);
+	else
+		ensure_same_bucket_grid(state, origin, step);
+	PeriodSet *ps = temporal_get_time_internal(temp);
+	bucketcount_add_periodset(state, ps);
+	pfree(ps);
+	PG_FREE_IF_COPY(temp, 1);
+	PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_buckets_combinefn);
+
+PGDLLEXPORT Datum
+temporal_tcount_buckets_combinefn(PG_FUNCTION_ARGS)
+{
+	BucketCount *state1 = PG_ARGISNULL(0) ? NULL : 
+		(BucketCount *) PG_GETARG_POINTER(0);
+	BucketCount *state2 = PG_ARGISNULL(1) ? NULL : 
+		(BucketCount *) PG_GETARG_POINTER(1);
+	if (! state1 || ! state2)
+	{
+		if (! state1 && ! state2)
+			PG_RETURN_NULL();
+		PG_RETURN_POINTER(state1 ? state1 : state2);
+	}
+	ensure_same_bucket_grid(state1, state2->origin, state2->step);
+	if (state2->count > 0)
+	{
+		bucketcount_extend(state1, state2->first, 
+			state2->first + state2->count - 1);
+		int shift = (int) (state2->first - state1->first);
+		for (int i = 0; i < state2->count; i++)
+			state1->counts[shift + i] += state2->counts[i];
+	}
+	PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_buckets_finalfn);
+/*
+ * The result is a step function whose value in each bucket is the number of
+ * values intersecting it. Consecutive buckets with a nonzero count form a 
+ * sequence, the buckets with a zero count are left undefined as in tcount.
+ */
+PGDLLEXPORT Datum
+temporal_tcount_buckets_finalfn(PG_FUNCTION_ARGS)
+{
+	/* The final function is strict, we do not need to test for null values */
+	BucketCount *state = (BucketCount *) PG_GETARG_POINTER(0);
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * 
+		(state->count / 2 + 1));
+	int k = 0, i = 0;
+	while (i < state->count)
+	{
+		if (state->counts[i] == 0)
+		{
+			i++;
+			continue;
+		}
+		int j = i;
+		while (j < state->count && state->counts[j] != 0)
+			j++;
+		TemporalSeqBuilder builder;
+		temporalseq_build_init(&builder, INT4OID, j - i + 1, false, true);
+		for (int l = i; l < j; l++)
+			temporalseq_build_append(&builder, Int32GetDatum(state->counts[l]),
+				state->origin + (state->first + l) * state->step);
+		temporalseq_build_append(&builder, Int32GetDatum(state->counts[j - 1]),
+			state->origin + (state->first + j) * state->step);
+		sequences[k++] = temporalseq_build_finish(&builder, true, false);
+		i = j;
+	}
+	if (k == 0)
+	{
+		pfree(sequences);
+		PG_RETURN_NULL();
+	}
+	TemporalS *result = temporals_from_temporalseqarr(sequences, k, false, 
+		false);
+	for (i = 0; i < k; i++)
+		pfree(sequences[i]);
+	pfree(sequences);
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * The state is serialized as the origin and the step of the buckets, the 
+ * index of the first bucket, the number of buckets and their counters
+ */
+
+PG_FUNCTION_INFO_V1(temporal_tcount_buckets_serialize);
+
+PGDLLEXPORT Datum
+temporal_tcount_buckets_serialize(PG_FUNCTION_ARGS)
+{
+	BucketCount *state = (BucketCount *) PG_GETARG_POINTER(0);
+	StringInfoData buf;
+	pq_begintypsend(&buf);
+	pq_sendint64(&buf, (uint64) state->origin);
+	pq_sendint64(&buf, (uint64) state->step);
+	pq_sendint64(&buf, (uint64) state->first);
+	pq_sendint32(&buf, (uint32) state->count);
+	for (int i = 0; i < state->count; i++)
+		pq_sendint32(&buf, (uint32) state->counts[i]);
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(temporal_tcount_buckets_deserialize);
+
+PGDLLEXPORT Datum
+temporal_tcount_buckets_deserialize(PG_FUNCTION_ARGS)
+{
+	bytea *data = PG_GETARG_BYTEA_P(0);
+	StringInfoData buf =
+	{
+		.cursor = 0,
+		.data = VARDATA(data),
+		.len = VARSIZE(data) - VARHDRSZ,
+		.maxlen = VARSIZE(data) - VARHDRSZ
+	};
+	TimestampTz origin = (TimestampTz) pq_getmsgint64(&buf);
+	int64 step = pq_getmsgint64(&buf);
+	int64 first = pq_getmsgint64(&buf);
+	int count = pq_getmsgint(&buf, 4);
+	if (step <= 0 || count < 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+			errmsg("Invalid serialized state for temporal aggregation")));
+	BucketCount *result = bucketcount_make(fcinfo, origin, step);
+	if (count > 0)
+	{
+		bucketcount_extend(result, first, first + count - 1);
+		for (int i = 0; i < count; i++)
+			result->counts[i] = (int32) pq_getmsgint(&buf, 4);
+	}
+	pq_getmsgend(&buf);
+	PG_RETURN_POINTER(result);
+}
+
 /*****************************************************************************/
@@ -62,13 +62,38 @@
  * 		- stavalues stores the length of the histogram of periods for the time dimension.
  * 		- numvalues contains the number of buckets in the histogram.
  *
+ * For temporal numbers of durations distinct from TemporalInst, an additional
+ * slot contains a two-dimensional histogram of the value and time dimensions,
+ * so that the correlation between both dimensions is taken into account when
+ * estimating the selectivity of the bounding box operators.
+ * - Slot 5
+ * 		- stakind contains the type of statistics which is STATISTIC_KIND_TBOX_HISTOGRAM.
+ * 		- staop contains InvalidOid.
+ * 		- stavalues stores the extent of the histogram as a TBOX.
+ * 		- stanumbers stores the number of cells in the value and time dimensions
+ * 		  followed by the fraction of the values in each cell.
+ *
  * Notice that some statistics may not be collected, for example, since there
  * are no most common values. In that case, the next statistics collected is
  * stored in the next available slot.
  *
  * In the case of temporal types having a Period as bounding box, that is,
- * tbool and ttext, no statistics are collected for the value dimension and
- * the statistics for the temporal part are stored in slots 1 and 2.
+ * tbool and ttext, the statistics for the temporal part are stored in slots
+ * 1 and 2 and the statistics for the value dimension are collected from the
+ * value sets of the temporal values, that is, from the distinct base values
+ * taken by each of them. They are used for estimating the selectivity of the
+ * ever and always comparison operators.
+ * - Slot 3
+ * 		- stakind contains the type of statistics which is STATISTIC_KIND_VALUE_MCELEM.
+ * 		- staop contains the "=" operator of the value dimension.
+ * 		- stavalues stores the most common base values of the value sets.
+ * 		- stanumbers stores the fractions of the temporal values taking each
+ * 		  of these base values, followed by the maximum fraction for the other
+ * 		  base values and the fraction of temporal values taking a single
+ * 		  base value.
+ *
+ * For TemporalInst columns of these types, the statistics of the value 
+ * dimension are collected as for temporal numbers.
  * 
  * Portions Copyright (c) 2020, Esteban Zimanyi, Mahmoud Sakr, Mohamed Bakli,
  * 		Universite Libre de Bruxelles
@@ -97,6 +122,7 @@
 #include "temporaltypes.h"
 #include "oidcache.h"
 #include "temporal_util.h"
+#include "temporal_compress.h"
 #include "temporal_analyze.h"
 
 /*
@@ -116,6 +142,25 @@
  */
 TemporalAnalyzeExtraData *temporal_extra_data;
 
+/*
+ * Value of the mobilitydb.analyze_detoast_limit parameter, that is, the 
+ * maximum number of kilobytes fetched from the sampled values when computing 
+ * the statistics of a column, or -1 for no limit. When the limit is reached, 
+ * the statistics are computed with the values read so far.
+ */
+int analyze_detoast_limit = -1;
+
+/*
+ * Returns true if the number of bytes fetched from the sampled values has
+ * reached the limit set by the mobilitydb.analyze_detoast_limit parameter
+ */
+bool
+analyze_detoast_limit_reached(double fetched_bytes)
+{
+	return analyze_detoast_limit >= 0 &&
+		fetched_bytes >= (double) analyze_detoast_limit * 1024.0;
+}
+
 /*****************************************************************************
  * Functions copied from files analyze.c and rangetypes_typanalyze.c since
  * they are not exported.
@@ -170,6 +215,18 @@ compare_mcvs(const void *a, const void *b)
 	return da - db;
 }
 
+/*
+ * qsort comparator for sorting ScalarMCVItems by decreasing count
+ */
+static int
+compare_mcv_counts(const void *a, const void *b)
+{
+	int da = ((const ScalarMCVItem *) a)->count;
+	int db = ((const ScalarMCVItem *) b)->count;
+
+	return db - da;
+}
+
 /*
  * Comparison function for sorting RangeBounds.
  */
@@ -749,7 +806,10 @@ compute_scalar_stats_mdb(VacAttrStats *stats, int values_cnt, bool is_varwidth,
  * In these functions the last argument valuestats determines whether
  * statistics are computed for the value dimension, that is, it is true for
  * temporal numbers. Otherwise, statistics are computed only for the temporal
- * dimension, that is, in the the case of temporal boolean and temporal text.
+ * dimension, that is, in the the case of temporal boolean and temporal text,
+ * apart from the most common values of their value sets. Since the value of
+ * a TemporalInst is a single base value, the statistics of the value 
+ * dimension are computed for all TemporalInst columns.
  *****************************************************************************/
 
 /* 
@@ -1062,6 +1122,198 @@ range_compute_stats(VacAttrStats *stats, int non_null_cnt, int *slot_idx,
 	MemoryContextSwitchTo(old_cxt);
 }
 
+/*
+ * Get the range of cells of a dimension of the histogram that are overlapped
+ * by the interval [min, max]
+ */
+static void
+tbox_hist_cells(double min, double max, double extmin, double cellsize,
+	int size, int *imin, int *imax)
+{
+	if (cellsize == 0.0)
+	{
+		*imin = *imax = 0;
+		return;
+	}
+	*imin = (int) floor((min - extmin) / cellsize);
+	*imax = (int) floor((max - extmin) / cellsize);
+	*imin = Max(0, Min(*imin, size - 1));
+	*imax = Max(0, Min(*imax, size - 1));
+}
+
+/*
+ * Get the fraction of the interval [min, max] that falls into the cell 
+ * [cellmin, cellmax]
+ */
+static double
+tbox_hist_ratio(double min, double max, double cellmin, double cellmax)
+{
+	double width = max - min;
+	/* An interval of width zero falls into a single cell */
+	if (width == 0.0)
+		return 1.0;
+	return Max(0.0, Min(max, cellmax) - Max(min, cellmin)) / width;
+}
+
+/* 
+ * Compute a two-dimensional histogram of the value and time dimensions of
+ * temporal numbers. The extent of the histogram is the union of the bounding
+ * boxes of the sample and each bounding box contributes to the cells it
+ * overlaps proportionally to the size of the overlap, as done by PostGIS in
+ * function compute_gserialized_stats of file gserialized_estimate.c.
+ */
+static void
+tbox_hist_compute_stats(VacAttrStats *stats, int non_null_cnt, int *slot_idx,
+	TBOX *boxes)
+{
+	TBOX *extent;
+	int vsize, tsize, i, j, k;
+	double vcellsize, tcellsize;
+	float4 *cells;
+	Datum *extent_values;
+	MemoryContext old_cxt;
+
+	/* There are no free slots left */
+	if (*slot_idx >= STATISTIC_NUM_SLOTS)
+		return;
+
+	/* Must copy the target values into anl_context */
+	old_cxt = MemoryContextSwitchTo(stats->anl_context);
+
+	/* Compute the extent of the histogram */
+	extent = palloc(sizeof(TBOX));
+	memcpy(extent, &boxes[0], sizeof(TBOX));
+	for (i = 1; i < non_null_cnt; i++)
+	{
+		extent->xmin = Min(extent->xmin, boxes[i].xmin);
+		extent->xmax = Max(extent->xmax, boxes[i].xmax);
+		extent->tmin = Min(extent->tmin, boxes[i].tmin);
+		extent->tmax = Max(extent->tmax, boxes[i].tmax);
+	}
+
+	/* Use as many cells per dimension as the statistics target, within reason */
+	vsize = tsize = Max(1, Min(stats->attr->attstattarget, TBOX_HIST_MAX_SIZE));
+	if (extent->xmax == extent->xmin)
+		vsize = 1;
+	if (extent->tmax == extent->tmin)
+		tsize = 1;
+	vcellsize = (extent->xmax - extent->xmin) / vsize;
+	tcellsize = ((double) extent->tmax - (double) extent->tmin) / tsize;
+
+	cells = palloc0(sizeof(float4) * (2 + vsize * tsize));
+	cells[0] = (float4) vsize;
+	cells[1] = (float4) tsize;
+
+	/* Distribute each box among the cells it overlaps */
+	for (i = 0; i < non_null_cnt; i++)
+	{
+		int vmin, vmax, tmin, tmax;
+		tbox_hist_cells(boxes[i].xmin, boxes[i].xmax, extent->xmin, vcellsize,
+			vsize, &vmin, &vmax);
+		tbox_hist_cells((double) boxes[i].tmin, (double) boxes[i].tmax,
+			(double) extent->tmin, tcellsize, tsize, &tmin, &tmax);
+		for (j = vmin; j <= vmax; j++)
+		{
+			double vratio = (vsize == 1) ? 1.0 :
+				tbox_hist_ratio(boxes[i].xmin, boxes[i].xmax,
+					extent->xmin + j * vcellsize, extent->xmin + (j + 1) * vcellsize);
+			for (k = tmin; k <= tmax; k++)
+			{
+				double tratio = (tsize == 1) ? 1.0 :
+					tbox_hist_ratio((double) boxes[i].tmin, (double) boxes[i].tmax,
+						(double) extent->tmin + k * tcellsize,
+						(double) extent->tmin + (k + 1) * tcellsize);
+				cells[2 + j * tsize + k] += (float4) (vratio * tratio / non_null_cnt);
+			}
+		}
+	}
+
+	extent_values = palloc(sizeof(Datum));
+	extent_values[0] = PointerGetDatum(extent);
+
+	stats->stakind[*slot_idx] = STATISTIC_KIND_TBOX_HISTOGRAM;
+	stats->staop[*slot_idx] = InvalidOid;
+	stats->stavalues[*slot_idx] = extent_values;
+	stats->numvalues[*slot_idx] = 1;
+	stats->statypid[*slot_idx] = type_oid(T_TBOX);
+	stats->statyplen[*slot_idx] = sizeof(TBOX);
+	stats->statypbyval[*slot_idx] = false;
+	stats->statypalign[*slot_idx] = 'd';
+	stats->stanumbers[*slot_idx] = cells;
+	stats->numnumbers[*slot_idx] = 2 + vsize * tsize;
+	(*slot_idx)++;
+
+	MemoryContextSwitchTo(old_cxt);
+}
+
+/*
+ * Compute the most common base values of the value sets of the sampled
+ * temporal values. Function derived from compute_array_stats of file
+ * array_typanalyze.c. Since the value sets are taken from a bounded sample,
+ * the base values are sorted and their occurrences are counted exactly
+ * instead of using the Lossy Counting algorithm.
+ */
+static void
+value_mcelem_compute_stats(VacAttrStats *stats, int non_null_cnt, 
+	int *slot_idx, Datum *values, int values_cnt, int single_cnt)
+{
+	Oid valuetypid = temporal_extra_data->value_type_id;
+	ScalarMCVItem *track;
+	int track_cnt = 0, num_mcelem, i;
+	Datum *mcelem_values;
+	float4 *mcelem_freqs;
+	MemoryContext old_cxt;
+
+	/* There are no free slots left */
+	if (*slot_idx >= STATISTIC_NUM_SLOTS || values_cnt == 0)
+		return;
+
+	/* Count the occurrences of each distinct base value */
+	datum_sort(values, values_cnt, valuetypid);
+	track = palloc(sizeof(ScalarMCVItem) * values_cnt);
+	for (i = 0; i < values_cnt; i++)
+	{
+		if (i == 0 || ! datum_eq(values[i - 1], values[i], valuetypid))
+		{
+			track[track_cnt].first = i;
+			track[track_cnt++].count = 0;
+		}
+		track[track_cnt - 1].count++;
+	}
+	qsort(track, track_cnt, sizeof(ScalarMCVItem), compare_mcv_counts);
+	num_mcelem = Min(track_cnt, stats->attr->attstattarget);
+
+	/* Must copy the target values into anl_context */
+	old_cxt = MemoryContextSwitchTo(stats->anl_context);
+	mcelem_values = palloc(sizeof(Datum) * num_mcelem);
+	mcelem_freqs = palloc(sizeof(float4) * (num_mcelem + 2));
+	for (i = 0; i < num_mcelem; i++)
+	{
+		mcelem_values[i] = datumCopy(values[track[i].first], 
+			temporal_extra_data->value_typbyval, 
+			temporal_extra_data->value_typlen);
+		mcelem_freqs[i] = (float4) track[i].count / (float4) non_null_cnt;
+	}
+	mcelem_freqs[num_mcelem] = (num_mcelem < track_cnt) ?
+		(float4) track[num_mcelem].count / (float4) non_null_cnt : 0.0;
+	mcelem_freqs[num_mcelem + 1] = (float4) single_cnt / (float4) non_null_cnt;
+	MemoryContextSwitchTo(old_cxt);
+
+	stats->stakind[*slot_idx] = STATISTIC_KIND_VALUE_MCELEM;
+	stats->staop[*slot_idx] = temporal_extra_data->value_eq_opr;
+	stats->stavalues[*slot_idx] = mcelem_values;
+	stats->numvalues[*slot_idx] = num_mcelem;
+	stats->statypid[*slot_idx] = valuetypid;
+	stats->statyplen[*slot_idx] = temporal_extra_data->value_typlen;
+	stats->statypbyval[*slot_idx] = temporal_extra_data->value_typbyval;
+	stats->statypalign[*slot_idx] = temporal_extra_data->value_typalign;
+	stats->stanumbers[*slot_idx] = mcelem_freqs;
+	stats->numnumbers[*slot_idx] = num_mcelem + 2;
+	(*slot_idx)++;
+
+	pfree(track);
+}
+
 /* 
  * Compute statistics for all durations distinct from TemporalInst.
  * Function derived from compute_range_stats of file rangetypes_typanalyze.c 
@@ -1080,9 +1332,16 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 		   *value_uppers;
 	PeriodBound *time_lowers,
 		   *time_uppers;
-	double total_width = 0;
+	TBOX *boxes;
+	int rows_cnt = 0;
+	double total_width = 0,
+		fetched_bytes = 0;
 	Oid 	rangetypid = 0; /* make compiler quiet */
 	TypeCacheEntry *typcache;
+	Datum *value_sets = NULL;
+	int value_sets_cnt = 0,
+		value_sets_size = 0,
+		single_cnt = 0;
 
 	temporal_extra_data = (TemporalAnalyzeExtraData *)stats->extra_data;
 
@@ -1098,6 +1357,7 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 		value_lowers = (RangeBound *) palloc(sizeof(RangeBound) * samplerows);
 		value_uppers = (RangeBound *) palloc(sizeof(RangeBound) * samplerows);
 		value_lengths = (float8 *) palloc(sizeof(float8) * samplerows);
+		boxes = (TBOX *) palloc(sizeof(TBOX) * samplerows);
 	}
 	time_lowers = (PeriodBound *) palloc(sizeof(PeriodBound) * samplerows);
 	time_uppers = (PeriodBound *) palloc(sizeof(PeriodBound) * samplerows);
@@ -1114,11 +1374,16 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 		Period period;
 		PeriodBound period_lower,
 				period_upper;
-		Temporal *temp;
+		union bboxunion box;
 	
 		/* Give backend a chance of interrupting us */
 		vacuum_delay_point();
 
+		/* Stop when the maximum number of bytes to fetch has been reached */
+		if (non_null_cnt > 0 && analyze_detoast_limit_reached(fetched_bytes))
+			break;
+		rows_cnt++;
+
 		value = fetchfunc(stats, i, &isnull);
 		if (isnull)
 		{
@@ -1127,15 +1392,21 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 			continue;
 		}
 
-		total_width += VARSIZE(value);
+		total_width += toast_raw_datum_size(value);
 
-		/* Get Temporal value */
-		temp = DatumGetTemporal(value);
+		/* Get the bounding box fetching only the required slices of the value */
+		memset(&box, 0, sizeof(union bboxunion));
+		fetched_bytes += temporal_bbox_slice(value, &box);
 
 		/* Remember bounds and length for further usage in histograms */
 		if (valuestats)
 		{
-			range = tnumber_value_range_internal(temp);
+			if (temporal_extra_data->value_type_id == INT4OID)
+				range = range_make(Int32GetDatum((int) box.b.xmin), 
+					Int32GetDatum((int) box.b.xmax), true, true, INT4OID);
+			else
+				range = range_make(Float8GetDatum(box.b.xmin), 
+					Float8GetDatum(box.b.xmax), true, true, FLOAT8OID);
 			range_deserialize(typcache, range, &range_lower, &range_upper, &isempty);
 			value_lowers[non_null_cnt] = range_lower;
 			value_uppers[non_null_cnt] = range_upper;
@@ -1146,8 +1417,32 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 			else if (temporal_extra_data->value_type_id == FLOAT8OID)
 				value_lengths[non_null_cnt] = DatumGetFloat8(range_upper.val) -
 					DatumGetFloat8(range_lower.val);
+			boxes[non_null_cnt] = box.b;
+			pfree(range);
+			period_set(&period, box.b.tmin, box.b.tmax, true, true);
+		}
+		else
+		{
+			period = box.p;
+			/* Remember the value set for the most common base values */
+			Temporal *temp = temporal_detoast_uncompressed(value);
+			int count;
+			Datum *values = temporal_values1(temp, &count);
+			fetched_bytes += toast_raw_datum_size(value);
+			if (count == 1)
+				single_cnt++;
+			if (value_sets_cnt + count > value_sets_size)
+			{
+				value_sets_size = Max(2 * value_sets_size, 
+					value_sets_cnt + count);
+				value_sets = value_sets == NULL ?
+					palloc(sizeof(Datum) * value_sets_size) :
+					repalloc(value_sets, sizeof(Datum) * value_sets_size);
+			}
+			memcpy(&value_sets[value_sets_cnt], values, sizeof(Datum) * count);
+			value_sets_cnt += count;
+			pfree(values);
 		}
-		temporal_period(&period, temp);
 		period_deserialize(&period, &period_lower, &period_upper);
 		time_lowers[non_null_cnt] = period_lower;
 		time_uppers[non_null_cnt] = period_upper;
@@ -1162,7 +1457,7 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 	{
 		stats->stats_valid = true;
 		/* Do the simple null-frac and width stats */
-		stats->stanullfrac = (float4) null_cnt / (float4) samplerows;
+		stats->stanullfrac = (float4) null_cnt / (float4) rows_cnt;
 		stats->stawidth = (int) (total_width / non_null_cnt);
 
 		/* Estimate that non-null values are unique */
@@ -1176,6 +1471,12 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 
 		period_compute_stats1(stats, non_null_cnt, &slot_idx,
 			time_lowers, time_uppers, time_lengths);
+
+		if (valuestats)
+			tbox_hist_compute_stats(stats, non_null_cnt, &slot_idx, boxes);
+		else
+			value_mcelem_compute_stats(stats, non_null_cnt, &slot_idx,
+				value_sets, value_sets_cnt, single_cnt);
 	}
 	else if (null_cnt > 0)
 	{
@@ -1194,7 +1495,10 @@ temps_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 	if (valuestats)
 	{
 		pfree(value_lowers); pfree(value_uppers); pfree(value_lengths);
+		pfree(boxes);
 	}
+	else if (value_sets != NULL)
+		pfree(value_sets);
 	pfree(time_lowers); pfree(time_uppers); pfree(time_lengths);
 }
 
@@ -1206,7 +1510,7 @@ void
 temporalinst_compute_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc,
 	int samplerows, double totalrows)
 {
-	return tempinst_compute_stats(stats, fetchfunc, samplerows, totalrows, false);
+	return tempinst_compute_stats(stats, fetchfunc, samplerows, totalrows, true);
 }
 
 void
@@ -12,7 +12,10 @@
 
 #include "temporal_boolops.h"
 
+#include <utils/timestamp.h>
+
 #include "temporaltypes.h"
+#include "timeops.h"
 #include "lifting.h"
 
 /*****************************************************************************
@@ -35,6 +38,154 @@ datum_or(Datum l, Datum r)
 	return BoolGetDatum(DatumGetBool(l) || DatumGetBool(r));
 }
 
+/*****************************************************************************
+ * Merge of temporal Booleans
+ *****************************************************************************/
+
+/*
+ * Apply a Boolean operation to two temporal Boolean sequences by merging 
+ * their streams of timestamps. Since temporal Booleans have stepwise 
+ * interpolation, the values of both sequences are known at each step of 
+ * the merge and thus the instants of the sequences need not be synchronized. 
+ * Only the instants where the value of the result changes are output, 
+ * which yields the result in normal form.
+ */
+static TemporalSeq *
+tboolseq_tboolseq_merge(TemporalSeq *seq1, TemporalSeq *seq2,
+	Datum (*func)(Datum, Datum))
+{
+	/* Test whether the bounding period of the two temporal values overlap */
+	Period *inter = intersection_period_period_internal(&seq1->period, 
+		&seq2->period);
+	if (inter == NULL)
+		return NULL;
+	/* The two sequences intersect at an instant */
+	if (timestamp_cmp_internal(inter->lower, inter->upper) == 0)
+	{
+		pfree(inter);
+		return sync_tfunc2_temporalseq_temporalseq(seq1, seq2, func, 
+			BOOLOID, false, NULL);
+	}
+
+	int i = Max(temporalseq_find_timestamp(seq1, inter->lower), 0);
+	int j = Max(temporalseq_find_timestamp(seq2, inter->lower), 0);
+	Datum value1 = temporalinst_value(temporalseq_inst_n(seq1, i));
+	Datum value2 = temporalinst_value(temporalseq_inst_n(seq2, j));
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * 
+		(seq1->count - i + seq2->count - j + 1));
+	TimestampTz t = inter->lower;
+	Datum value = func(value1, value2);
+	instants[0] = temporalinst_make(value, t, BOOLOID);
+	int k = 1;
+	while (true)
+	{
+		/* Find the next timestamp of the merged streams */
+		TimestampTz t1 = (i < seq1->count - 1) ? 
+			temporalseq_inst_n(seq1, i + 1)->t : DT_NOEND;
+		TimestampTz t2 = (j < seq2->count - 1) ? 
+			temporalseq_inst_n(seq2, j + 1)->t : DT_NOEND;
+		t = Min(t1, t2);
+		if (timestamp_cmp_internal(t, inter->upper) > 0 ||
+			(timestamp_cmp_internal(t, inter->upper) == 0 && 
+			 ! inter->upper_inc))
+			break;
+		if (t1 == t)
+			value1 = temporalinst_value(temporalseq_inst_n(seq1, ++i));
+		if (t2 == t)
+			value2 = temporalinst_value(temporalseq_inst_n(seq2, ++j));
+		Datum newvalue = func(value1, value2);
+		if (timestamp_cmp_internal(t, inter->upper) == 0)
+			break;
+		if (DatumGetBool(newvalue) != DatumGetBool(value))
+		{
+			value = newvalue;
+			instants[k++] = temporalinst_make(value, t, BOOLOID);
+		}
+	}
+	/* The value at an inclusive upper bound may differ from the previous 
+	   one, while it must be equal to it for an exclusive upper bound */
+	if (inter->upper_inc)
+		value = func(value1, value2);
+	instants[k++] = temporalinst_make(value, inter->upper, BOOLOID);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, k, 
+		inter->lower_inc, inter->upper_inc, false, true);
+	for (int l = 0; l < k; l++)
+		pfree(instants[l]);
+	pfree(instants); pfree(inter);
+	return result;
+}
+
+/*
+ * Apply a Boolean operation to two temporal Booleans.
+ * The merge of the timestamp streams is used when both values have 
+ * sequence or sequence set duration, and the generic synchronization 
+ * otherwise.
+ */
+static Temporal *
+tbool_tbool_merge(Temporal *temp1, Temporal *temp2, 
+	Datum (*func)(Datum, Datum))
+{
+	ensure_valid_duration(temp1->duration);
+	ensure_valid_duration(temp2->duration);
+	if ((temp1->duration != TEMPORALSEQ && temp1->duration != TEMPORALS) ||
+		(temp2->duration != TEMPORALSEQ && temp2->duration != TEMPORALS))
+		return sync_tfunc2_temporal_temporal(temp1, temp2, func, BOOLOID, 
+			false, NULL);
+	if (temp1->duration == TEMPORALSEQ && temp2->duration == TEMPORALSEQ)
+		return (Temporal *)tboolseq_tboolseq_merge((TemporalSeq *)temp1, 
+			(TemporalSeq *)temp2, func);
+
+	/* Test whether the bounding period of the two temporal values overlap */
+	Period p1, p2;
+	temporal_period(&p1, temp1);
+	temporal_period(&p2, temp2);
+	if (!overlaps_period_period_internal(&p1, &p2))
+		return NULL;
+
+	/* A sequence is merged as a sequence set composed of one sequence */
+	int count1 = temp1->duration == TEMPORALSEQ ? 1 : ((TemporalS *)temp1)->count;
+	int count2 = temp2->duration == TEMPORALSEQ ? 1 : ((TemporalS *)temp2)->count;
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * (count1 + count2));
+	int i = 0, j = 0, k = 0;
+	while (i < count1 && j < count2)
+	{
+		TemporalSeq *seq1 = temp1->duration == TEMPORALSEQ ? 
+			(TemporalSeq *)temp1 : temporals_seq_n((TemporalS *)temp1, i);
+		TemporalSeq *seq2 = temp2->duration == TEMPORALSEQ ? 
+			(TemporalSeq *)temp2 : temporals_seq_n((TemporalS *)temp2, j);
+		TemporalSeq *seq = tboolseq_tboolseq_merge(seq1, seq2, func);
+		if (seq != NULL)
+			sequences[k++] = seq;
+		int cmp = timestamp_cmp_internal(seq1->period.upper, seq2->period.upper);
+		if (cmp == 0)
+		{
+			if (!seq1->period.upper_inc && seq2->period.upper_inc)
+				cmp = -1;
+			else if (seq1->period.upper_inc && !seq2->period.upper_inc)
+				cmp = 1;
+		}
+		if (cmp == 0)
+		{
+			i++; j++;
+		}
+		else if (cmp < 0)
+			i++; 
+		else 
+			j++;
+	}
+	if (k == 0)
+	{
+		pfree(sequences); 
+		return NULL;
+	}
+	TemporalS *result = temporals_from_temporalseqarr(sequences, k,
+		false, false);
+	for (i = 0; i < k; i++)
+		pfree(sequences[i]);
+	pfree(sequences); 
+	return (Temporal *)result;
+}
+
 /*****************************************************************************
  * Temporal and
  *****************************************************************************/
@@ -72,8 +223,7 @@ tand_tbool_tbool(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	Temporal *result = sync_tfunc2_temporal_temporal(temp1, temp2, 
-		&datum_and, BOOLOID, false, NULL);
+	Temporal *result = tbool_tbool_merge(temp1, temp2, &datum_and);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -118,8 +268,7 @@ tor_tbool_tbool(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	Temporal *result = sync_tfunc2_temporal_temporal(temp1, temp2, 
-		&datum_or, BOOLOID, false, NULL);
+	Temporal *result = tbool_tbool_merge(temp1, temp2, &datum_or);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
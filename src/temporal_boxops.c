@@ -246,7 +246,7 @@ temporalinstarr_to_period(Period *period, TemporalInst **instants, int count,
 
 /* Expand the first box with the second one */
 
-static void
+void
 tbox_expand(TBOX *box1, const TBOX *box2)
 {
 	box1->xmin = Min(box1->xmin, box2->xmin);
@@ -909,11 +909,9 @@ PGDLLEXPORT Datum
 contains_bbox_period_temporal(PG_FUNCTION_ARGS) 
 {
 	Period *p = PG_GETARG_PERIOD(0);
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p1);
 	bool result = contains_period_period_internal(p, &p1);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -922,12 +920,10 @@ PG_FUNCTION_INFO_V1(contains_bbox_temporal_period);
 PGDLLEXPORT Datum
 contains_bbox_temporal_period(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	Period *p = PG_GETARG_PERIOD(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
 	bool result = contains_period_period_internal(&p1, p);
-	PG_FREE_IF_COPY(temp, 0);
 	PG_RETURN_BOOL(result);
 }
 
@@ -936,14 +932,10 @@ PG_FUNCTION_INFO_V1(contains_bbox_temporal_temporal);
 PGDLLEXPORT Datum
 contains_bbox_temporal_temporal(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	Period p1, p2;
-	temporal_period(&p1, temp1);
-	temporal_period(&p2, temp2);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p2);
 	bool result = contains_period_period_internal(&p1, &p2);
-	PG_FREE_IF_COPY(temp1, 0);
-	PG_FREE_IF_COPY(temp2, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -955,11 +947,9 @@ PGDLLEXPORT Datum
 contained_bbox_period_temporal(PG_FUNCTION_ARGS) 
 {
 	Period *p = PG_GETARG_PERIOD(0);
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p1);
 	bool result = contains_period_period_internal(&p1, p);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -968,12 +958,10 @@ PG_FUNCTION_INFO_V1(contained_bbox_temporal_period);
 PGDLLEXPORT Datum
 contained_bbox_temporal_period(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	Period *p = PG_GETARG_PERIOD(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
 	bool result = contains_period_period_internal(p, &p1);
-	PG_FREE_IF_COPY(temp, 0);
 	PG_RETURN_BOOL(result);
 }
 
@@ -982,14 +970,10 @@ PG_FUNCTION_INFO_V1(contained_bbox_temporal_temporal);
 PGDLLEXPORT Datum
 contained_bbox_temporal_temporal(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	Period p1, p2;
-	temporal_period(&p1, temp1);
-	temporal_period(&p2, temp2);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p2);
 	bool result = contains_period_period_internal(&p2, &p1);
-	PG_FREE_IF_COPY(temp1, 0);
-	PG_FREE_IF_COPY(temp2, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -1001,11 +985,9 @@ PGDLLEXPORT Datum
 overlaps_bbox_period_temporal(PG_FUNCTION_ARGS) 
 {
 	Period *p = PG_GETARG_PERIOD(0);
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p1);
 	bool result = overlaps_period_period_internal(p, &p1);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -1014,12 +996,10 @@ PG_FUNCTION_INFO_V1(overlaps_bbox_temporal_period);
 PGDLLEXPORT Datum
 overlaps_bbox_temporal_period(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	Period *p = PG_GETARG_PERIOD(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
 	bool result = overlaps_period_period_internal(&p1, p);
-	PG_FREE_IF_COPY(temp, 0);
 	PG_RETURN_BOOL(result);
 }
 
@@ -1028,14 +1008,10 @@ PG_FUNCTION_INFO_V1(overlaps_bbox_temporal_temporal);
 PGDLLEXPORT Datum
 overlaps_bbox_temporal_temporal(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	Period p1, p2;
-	temporal_period(&p1, temp1);
-	temporal_period(&p2, temp2);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p2);
 	bool result = overlaps_period_period_internal(&p1, &p2);
-	PG_FREE_IF_COPY(temp1, 0);
-	PG_FREE_IF_COPY(temp2, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -1047,11 +1023,9 @@ PGDLLEXPORT Datum
 same_bbox_period_temporal(PG_FUNCTION_ARGS) 
 {
 	Period *p = PG_GETARG_PERIOD(0);
-	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p1);
 	bool result = period_eq_internal(p, &p1);
-	PG_FREE_IF_COPY(temp, 1);
 	PG_RETURN_BOOL(result);
 }
 
@@ -1060,12 +1034,10 @@ PG_FUNCTION_INFO_V1(same_bbox_temporal_period);
 PGDLLEXPORT Datum
 same_bbox_temporal_period(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp = PG_GETARG_TEMPORAL(0);
 	Period *p = PG_GETARG_PERIOD(1);
 	Period p1;
-	temporal_period(&p1, temp);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
 	bool result = period_eq_internal(&p1, p);
-	PG_FREE_IF_COPY(temp, 0);
 	PG_RETURN_BOOL(result);
 }
 
@@ -1074,14 +1046,10 @@ PG_FUNCTION_INFO_V1(same_bbox_temporal_temporal);
 PGDLLEXPORT Datum
 same_bbox_temporal_temporal(PG_FUNCTION_ARGS) 
 {
-	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
-	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
 	Period p1, p2;
-	temporal_period(&p1, temp1);
-	temporal_period(&p2, temp2);
+	temporal_period_slice(PG_GETARG_DATUM(0), &p1);
+	temporal_period_slice(PG_GETARG_DATUM(1), &p2);
 	bool result = period_eq_internal(&p1, &p2);
-	PG_FREE_IF_COPY(temp1, 0);
-	PG_FREE_IF_COPY(temp2, 1);
 	PG_RETURN_BOOL(result);
 }
 
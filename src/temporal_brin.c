@@ -0,0 +1,343 @@
+/*****************************************************************************
+ *
+ * temporal_brin.c
+ *	  BRIN indexes for time types and temporal numbers.
+ *
+ * A block range is summarized by the bounding box of all the values in the
+ * range, that is, a period for the time types and a TBOX for the temporal
+ * numbers. These functions are based on those in the file brin_inclusion.c.
+ * The inclusion operator classes of PostgreSQL cannot be used since they
+ * require the summary to be of the same type as the indexed values.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_brin.h"
+
+#include <access/stratnum.h>
+#include <utils/rangetypes.h>
+#include <utils/typcache.h>
+
+#include "timetypes.h"
+#include "timestampset.h"
+#include "period.h"
+#include "periodset.h"
+#include "timeops.h"
+#include "time_gist.h"
+#include "oidcache.h"
+#include "temporal_boxops.h"
+#include "tnumber_gist.h"
+
+/*****************************************************************************
+ * Generic functions
+ *****************************************************************************/
+
+/*
+ * Information about the opclass: a single value of the storage type is
+ * stored for each block range
+ */
+BrinOpcInfo *
+brin_bbox_opcinfo(Oid storagetype)
+{
+	BrinOpcInfo *result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)));
+	result->oi_nstored = 1;
+	result->oi_opaque = NULL;
+	result->oi_typcache[0] = lookup_type_cache(storagetype, 0);
+	return result;
+}
+
+/*
+ * Record that a null value was found in the block range. Returns true if
+ * the summary was modified.
+ */
+bool
+brin_bbox_add_null(BrinValues *column)
+{
+	if (column->bv_hasnulls)
+		return false;
+	column->bv_hasnulls = true;
+	return true;
+}
+
+/*
+ * Expand the summary of the block range with the bounding box of a new
+ * value. Returns true if the summary was modified.
+ */
+bool
+brin_bbox_add_value(BrinValues *column, const void *box, size_t size,
+	bool (*contains)(const void *, const void *),
+	void (*expand)(void *, const void *))
+{
+	/* If the range was empty the summary is the box itself */
+	if (column->bv_allnulls)
+	{
+		void *summary = palloc(size);
+		memcpy(summary, box, size);
+		column->bv_values[0] = PointerGetDatum(summary);
+		column->bv_allnulls = false;
+		return true;
+	}
+
+	void *summary = DatumGetPointer(column->bv_values[0]);
+	if (contains(summary, box))
+		return false;
+	expand(summary, box);
+	return true;
+}
+
+/*
+ * Consistency for the scan keys IS NULL and IS NOT NULL. Returns true
+ * if the scan key has been handled, in which case the result is set.
+ */
+bool
+brin_bbox_null_consistent(BrinValues *column, ScanKey key, bool *result)
+{
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+			*result = column->bv_allnulls || column->bv_hasnulls;
+		else if (key->sk_flags & SK_SEARCHNOTNULL)
+			*result = ! column->bv_allnulls;
+		else
+			*result = false;
+		return true;
+	}
+	/* If the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+	{
+		*result = false;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * Merge the summary of the second block range into the first one
+ */
+void
+brin_bbox_union(BrinValues *col_a, BrinValues *col_b, size_t size,
+	void (*expand)(void *, const void *))
+{
+	/* Adjust "hasnulls" */
+	if (! col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		return;
+
+	/* If A has no values, just copy the summary of B */
+	if (col_a->bv_allnulls)
+	{
+		void *summary = palloc(size);
+		memcpy(summary, DatumGetPointer(col_b->bv_values[0]), size);
+		col_a->bv_values[0] = PointerGetDatum(summary);
+		col_a->bv_allnulls = false;
+		return;
+	}
+
+	expand(DatumGetPointer(col_a->bv_values[0]),
+		DatumGetPointer(col_b->bv_values[0]));
+}
+
+/*****************************************************************************
+ * BRIN methods for time types
+ *****************************************************************************/
+
+static bool
+brin_period_contains(const void *p1, const void *p2)
+{
+	return contains_period_period_internal((Period *) p1, (Period *) p2);
+}
+
+static void
+brin_period_expand(void *p1, const void *p2)
+{
+	period_expand((Period *) p1, (Period *) p2);
+}
+
+static Datum
+brin_period_add_value1(FunctionCallInfo fcinfo, Period *p)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	PG_RETURN_BOOL(brin_bbox_add_value(column, p, sizeof(Period),
+		&brin_period_contains, &brin_period_expand));
+}
+
+PG_FUNCTION_INFO_V1(brin_period_opcinfo);
+
+PGDLLEXPORT Datum
+brin_period_opcinfo(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(brin_bbox_opcinfo(type_oid(T_PERIOD)));
+}
+
+PG_FUNCTION_INFO_V1(brin_timestampset_add_value);
+
+PGDLLEXPORT Datum
+brin_timestampset_add_value(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	if (PG_GETARG_BOOL(3))
+		PG_RETURN_BOOL(brin_bbox_add_null(column));
+	TimestampSet *ts = PG_GETARG_TIMESTAMPSET(2);
+	return brin_period_add_value1(fcinfo, timestampset_bbox(ts));
+}
+
+PG_FUNCTION_INFO_V1(brin_period_add_value);
+
+PGDLLEXPORT Datum
+brin_period_add_value(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	if (PG_GETARG_BOOL(3))
+		PG_RETURN_BOOL(brin_bbox_add_null(column));
+	return brin_period_add_value1(fcinfo, PG_GETARG_PERIOD(2));
+}
+
+PG_FUNCTION_INFO_V1(brin_periodset_add_value);
+
+PGDLLEXPORT Datum
+brin_periodset_add_value(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	if (PG_GETARG_BOOL(3))
+		PG_RETURN_BOOL(brin_bbox_add_null(column));
+	PeriodSet *ps = PG_GETARG_PERIODSET(2);
+	return brin_period_add_value1(fcinfo, periodset_bbox(ps));
+}
+
+PG_FUNCTION_INFO_V1(brin_period_consistent);
+
+PGDLLEXPORT Datum
+brin_period_consistent(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey key = (ScanKey) PG_GETARG_POINTER(2);
+	bool result;
+	if (brin_bbox_null_consistent(column, key, &result))
+		PG_RETURN_BOOL(result);
+
+	/* Transform the query into a period */
+	Period *period, p;
+	if (key->sk_subtype == TIMESTAMPTZOID)
+	{
+		TimestampTz t = DatumGetTimestampTz(key->sk_argument);
+		period_set(&p, t, t, true, true);
+		period = &p;
+	}
+	else if (key->sk_subtype == type_oid(T_TIMESTAMPSET))
+		period = timestampset_bbox(DatumGetTimestampSet(key->sk_argument));
+	else if (key->sk_subtype == type_oid(T_PERIOD))
+		period = DatumGetPeriod(key->sk_argument);
+	else if (key->sk_subtype == type_oid(T_PERIODSET))
+		period = periodset_bbox(DatumGetPeriodSet(key->sk_argument));
+	else
+		elog(ERROR, "unrecognized strategy number: %d", key->sk_strategy);
+
+	/* The summary of the range behaves as an internal node of a GiST */
+	result = index_internal_consistent_period(
+		DatumGetPeriod(column->bv_values[0]), period, key->sk_strategy);
+	PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(brin_period_union);
+
+PGDLLEXPORT Datum
+brin_period_union(PG_FUNCTION_ARGS)
+{
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	brin_bbox_union(col_a, col_b, sizeof(Period), &brin_period_expand);
+	PG_RETURN_VOID();
+}
+
+/*****************************************************************************
+ * BRIN methods for temporal numbers
+ *****************************************************************************/
+
+static bool
+brin_tbox_contains(const void *box1, const void *box2)
+{
+	return contains_tbox_tbox_internal((TBOX *) box1, (TBOX *) box2);
+}
+
+static void
+brin_tbox_expand(void *box1, const void *box2)
+{
+	rt_tbox_union((TBOX *) box1, (TBOX *) box1, (TBOX *) box2);
+}
+
+PG_FUNCTION_INFO_V1(brin_tbox_opcinfo);
+
+PGDLLEXPORT Datum
+brin_tbox_opcinfo(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(brin_bbox_opcinfo(type_oid(T_TBOX)));
+}
+
+PG_FUNCTION_INFO_V1(brin_tnumber_add_value);
+
+PGDLLEXPORT Datum
+brin_tnumber_add_value(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	if (PG_GETARG_BOOL(3))
+		PG_RETURN_BOOL(brin_bbox_add_null(column));
+	Temporal *temp = PG_GETARG_TEMPORAL(2);
+	TBOX box;
+	memset(&box, 0, sizeof(TBOX));
+	temporal_bbox(&box, temp);
+	bool result = brin_bbox_add_value(column, &box, sizeof(TBOX),
+		&brin_tbox_contains, &brin_tbox_expand);
+	PG_FREE_IF_COPY(temp, 2);
+	PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(brin_tnumber_consistent);
+
+PGDLLEXPORT Datum
+brin_tnumber_consistent(PG_FUNCTION_ARGS)
+{
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey key = (ScanKey) PG_GETARG_POINTER(2);
+	bool result;
+	if (brin_bbox_null_consistent(column, key, &result))
+		PG_RETURN_BOOL(result);
+
+	/* Transform the query into a box */
+	TBOX query;
+	memset(&query, 0, sizeof(TBOX));
+	if (key->sk_subtype == type_oid(T_INTRANGE))
+		intrange_to_tbox_internal(&query, DatumGetRangeTypeP(key->sk_argument));
+	else if (key->sk_subtype == type_oid(T_FLOATRANGE))
+		floatrange_to_tbox_internal(&query, DatumGetRangeTypeP(key->sk_argument));
+	else if (key->sk_subtype == type_oid(T_TBOX))
+		query = *DatumGetTboxP(key->sk_argument);
+	else if (temporal_type_oid(key->sk_subtype))
+		temporal_bbox(&query, DatumGetTemporal(key->sk_argument));
+	else
+		elog(ERROR, "unrecognized strategy number: %d", key->sk_strategy);
+
+	/* The summary of the range behaves as an internal node of a GiST */
+	result = gist_internal_consistent_tbox(
+		DatumGetTboxP(column->bv_values[0]), &query, key->sk_strategy);
+	PG_RETURN_BOOL(result);
+}
+
+PG_FUNCTION_INFO_V1(brin_tbox_union);
+
+PGDLLEXPORT Datum
+brin_tbox_union(PG_FUNCTION_ARGS)
+{
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	brin_bbox_union(col_a, col_b, sizeof(TBOX), &brin_tbox_expand);
+	PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
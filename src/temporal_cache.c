@@ -0,0 +1,554 @@
+/*****************************************************************************
+ *
+ * temporal_cache.c
+ *	  Cache of the temporal values detoasted in the current transaction
+ *
+ * A query typically passes the same temporal column to several functions,
+ * e.g., trip && box, length(trip), and atPeriod(trip, p), and each of them
+ * fetches again from the TOAST table the same value stored out of line.
+ * The values fetched are kept in a small backend-local cache keyed by their
+ * TOAST pointer, so that the following calls for the same row only copy the
+ * cached value. The copy is needed since the functions free their detoasted
+ * arguments with PG_FREE_IF_COPY. A TOAST pointer is never reused for other
+ * contents while the value it points to may be visible, and the cache is 
+ * emptied at the end of each transaction. The size of the cache is given by 
+ * the setting mobilitydb.detoast_cache_size, the value 0 disabling it.
+ *
+ * When the extension is loaded with shared_preload_libraries, the values can
+ * also be kept across transactions and backends in a shared memory cache,
+ * whose size is given by the setting mobilitydb.shared_cache_size. This 
+ * avoids fetching from the TOAST tables the values read repeatedly by many
+ * sessions, such as the current trajectories of the moving objects tracked.
+ * The cache is shared by all the databases of the cluster, and thus the
+ * entries are keyed by the database and the TOAST pointer of the values.
+ * TOAST values are never modified, an update of a temporal value stores a
+ * new value with a new TOAST pointer. However, the identifiers of the TOAST
+ * values, as well as those of the TOAST tables, are taken from the OID
+ * counter of the cluster, and once the counter wraps around, the identifier
+ * of a value that has been deleted, e.g., by an update, a delete or a
+ * truncate followed by a vacuum, can be given to a new value. The cache
+ * thus follows the OID counter: the backends compare it to the largest value
+ * seen so far at the end of their transactions and when they access the
+ * cache, and all the entries are invalidated when the counter goes back.
+ * The sizes of the value stored in the TOAST pointer are also checked when
+ * looking up an entry. The shared cache is a set-associative cache: the key
+ * of a value determines a set of DETOAST_SHARED_WAYS entries, the least
+ * recently used of which is replaced when adding a value. The values are
+ * allocated in a dynamic shared area placed in the shared memory of the
+ * extension.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_cache.h"
+
+#include <miscadmin.h>
+#include <access/transam.h>
+#include <access/tuptoaster.h>
+#include <access/xact.h>
+#include <port/atomics.h>
+#include <storage/ipc.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+#include <utils/dsa.h>
+#include <utils/guc.h>
+#include <utils/memutils.h>
+
+#include "temporal_compress.h"
+#include "temporal_profile.h"
+#include "temporal_stats.h"
+
+/*****************************************************************************/
+
+/*
+ * Maximum number of values in the cache
+ */
+#define DETOAST_CACHE_ENTRIES  16
+
+typedef struct
+{
+	Oid			toastrelid;		/* TOAST table of the value */
+	Oid			valueid;		/* Identifier of the value in the table */
+	uint64		lastused;		/* Clock of the last access to the entry */
+	struct varlena *value;		/* Detoasted value, NULL if the entry is free */
+} DetoastCacheEntry;
+
+/* Maximum size in kilobytes of the values in the cache */
+int detoast_cache_size = 8192;
+
+static MemoryContext detoast_cache_context = NULL;
+static DetoastCacheEntry detoast_cache[DETOAST_CACHE_ENTRIES];
+static Size detoast_cache_bytes = 0;
+static uint64 detoast_cache_clock = 0;
+
+/*
+ * Number of entries of each set of the shared cache and average size of the
+ * values assumed for determining the number of sets
+ */
+#define DETOAST_SHARED_WAYS  4
+#define DETOAST_SHARED_VALUE_SIZE  (32 * 1024)
+
+typedef struct
+{
+	Oid			dbid;			/* Database of the value */
+	Oid			toastrelid;		/* TOAST table of the value */
+	Oid			valueid;		/* Identifier of the value in the table */
+	int32		rawsize;		/* Sizes of the value given by its pointer */
+	int32		extsize;
+	uint32		generation;		/* Generation in which the entry was added */
+	uint64		lastused;		/* Clock of the last access to the entry */
+	Size		size;			/* Size of the value, 0 if the entry is free */
+	dsa_pointer	value;			/* Detoasted value in the shared area */
+} DetoastSharedEntry;
+
+typedef struct
+{
+	LWLock	   *lock;			/* Protects the entries and the area */
+	int			tranche;		/* Tranche of the locks of the area */
+	int			nsets;			/* Number of sets of entries */
+	pg_atomic_uint64 clock;		/* Clock of the accesses to the entries */
+	pg_atomic_uint32 nextoid;	/* Largest value of the OID counter seen */
+	pg_atomic_uint32 generation;	/* Incremented when the counter wraps */
+	uint32		freedgen;		/* Generation of the entries in the area */
+	DetoastSharedEntry entries[FLEXIBLE_ARRAY_MEMBER];
+} DetoastSharedCache;
+
+/* Size in kilobytes of the shared cache */
+int shared_cache_size = 0;
+
+static DetoastSharedCache *detoast_shared = NULL;
+static dsa_area *detoast_shared_area = NULL;
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static void detoast_shared_check_oids(void);
+
+/*
+ * Remove all the values from the cache
+ */
+static void
+detoast_cache_reset(void)
+{
+	if (detoast_cache_bytes == 0)
+		return;
+	MemoryContextReset(detoast_cache_context);
+	memset(detoast_cache, 0, sizeof(detoast_cache));
+	detoast_cache_bytes = 0;
+}
+
+static void
+detoast_cache_xact_callback(XactEvent event, void *arg)
+{
+	if (event == XACT_EVENT_COMMIT || event == XACT_EVENT_PARALLEL_COMMIT ||
+		event == XACT_EVENT_ABORT || event == XACT_EVENT_PARALLEL_ABORT ||
+		event == XACT_EVENT_PREPARE)
+		detoast_cache_reset();
+	/* Before the values stored by the transaction become visible */
+	else if (detoast_shared != NULL && (event == XACT_EVENT_PRE_COMMIT ||
+		event == XACT_EVENT_PARALLEL_PRE_COMMIT ||
+		event == XACT_EVENT_PRE_PREPARE))
+		detoast_shared_check_oids();
+}
+
+static void
+detoast_cache_size_assign(int newval, void *extra)
+{
+	/* Values added with the previous size may no longer fit */
+	detoast_cache_reset();
+}
+
+/*****************************************************************************
+ * Shared cache
+ *****************************************************************************/
+
+static int
+detoast_shared_nsets(void)
+{
+	Size bytes = (Size) shared_cache_size * 1024;
+	return Max(16, (int) (bytes / (DETOAST_SHARED_VALUE_SIZE * 
+		DETOAST_SHARED_WAYS)));
+}
+
+static Size
+detoast_shared_header_size(void)
+{
+	return MAXALIGN(offsetof(DetoastSharedCache, entries) +
+		sizeof(DetoastSharedEntry) * detoast_shared_nsets() * 
+		DETOAST_SHARED_WAYS);
+}
+
+static Size
+detoast_shared_area_size(void)
+{
+	return Max((Size) shared_cache_size * 1024, dsa_minimum_size());
+}
+
+/*
+ * Create the shared cache, or attach to it when it already exists
+ */
+static void
+detoast_shared_startup(void)
+{
+	bool found;
+
+	if (prev_shmem_startup_hook)
+		prev_shmem_startup_hook();
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	detoast_shared = ShmemInitStruct("MobilityDB detoast cache",
+		detoast_shared_header_size() + detoast_shared_area_size(), &found);
+	if (! found)
+	{
+		int nentries = detoast_shared_nsets() * DETOAST_SHARED_WAYS;
+		detoast_shared->lock = 
+			&(GetNamedLWLockTranche("MobilityDB detoast cache"))->lock;
+		detoast_shared->tranche = LWLockNewTrancheId();
+		detoast_shared->nsets = detoast_shared_nsets();
+		pg_atomic_init_u64(&detoast_shared->clock, 0);
+		pg_atomic_init_u32(&detoast_shared->nextoid, 
+			ShmemVariableCache->nextOid);
+		pg_atomic_init_u32(&detoast_shared->generation, 0);
+		detoast_shared->freedgen = 0;
+		memset(detoast_shared->entries, 0, 
+			sizeof(DetoastSharedEntry) * nentries);
+		/* The area stays attached to by the postmaster during its lifetime */
+		dsa_area *area = dsa_create_in_place(
+			(char *) detoast_shared + detoast_shared_header_size(),
+			detoast_shared_area_size(), detoast_shared->tranche, NULL);
+		/* Do not create other segments when the area is full */
+		dsa_set_size_limit(area, detoast_shared_area_size());
+	}
+	LWLockRelease(AddinShmemInitLock);
+}
+
+static void
+detoast_shared_detach(int code, Datum arg)
+{
+	dsa_release_in_place(DatumGetPointer(arg));
+}
+
+/*
+ * Returns the shared area of the cache, attaching to it on the first call
+ * of the backend. The area is allocated in TopMemoryContext since it is
+ * kept until the backend exits.
+ */
+static dsa_area *
+detoast_shared_get_area(void)
+{
+	if (detoast_shared_area == NULL)
+	{
+		void *place = (char *) detoast_shared + detoast_shared_header_size();
+		LWLockRegisterTranche(detoast_shared->tranche, 
+			"MobilityDB detoast cache area");
+		MemoryContext oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+		detoast_shared_area = dsa_attach_in_place(place, NULL);
+		MemoryContextSwitchTo(oldcontext);
+		on_shmem_exit(detoast_shared_detach, PointerGetDatum(place));
+	}
+	return detoast_shared_area;
+}
+
+/*
+ * Invalidate the entries of the cache when the OID counter has wrapped
+ * around since the last call of any backend, since the identifiers of the
+ * values and of the TOAST tables of the entries may have been reused. The
+ * counter is read without lock, so that a backend may see a value that is
+ * slightly behind the one seen by another backend. Only a counter that is
+ * more than half of its range behind the largest value seen has wrapped.
+ */
+static void
+detoast_shared_check_oids(void)
+{
+	uint32 nextoid = (uint32) ShmemVariableCache->nextOid;
+	uint32 last = pg_atomic_read_u32(&detoast_shared->nextoid);
+	while (nextoid > last)
+	{
+		if (pg_atomic_compare_exchange_u32(&detoast_shared->nextoid, &last,
+				nextoid))
+			return;
+	}
+	if (last - nextoid > PG_UINT32_MAX / 2 &&
+		pg_atomic_compare_exchange_u32(&detoast_shared->nextoid, &last,
+			nextoid))
+		pg_atomic_fetch_add_u32(&detoast_shared->generation, 1);
+}
+
+static DetoastSharedEntry *
+detoast_shared_set(struct varatt_external *toast_pointer)
+{
+	uint32 hash = (uint32) toast_pointer->va_valueid * 2654435761u ^ 
+		(uint32) toast_pointer->va_toastrelid ^ 
+		(uint32) MyDatabaseId * 40503u;
+	return &detoast_shared->entries[(hash % detoast_shared->nsets) * 
+		DETOAST_SHARED_WAYS];
+}
+
+static bool
+detoast_shared_match(DetoastSharedEntry *entry, 
+	struct varatt_external *toast_pointer, uint32 generation)
+{
+	return entry->size > 0 && entry->generation == generation &&
+		entry->valueid == toast_pointer->va_valueid &&
+		entry->toastrelid == toast_pointer->va_toastrelid &&
+		entry->dbid == MyDatabaseId &&
+		entry->rawsize == toast_pointer->va_rawsize &&
+		entry->extsize == toast_pointer->va_extsize;
+}
+
+/*
+ * Returns a copy of a value of the shared cache, or NULL if the value is not
+ * in the cache
+ */
+static struct varlena *
+detoast_shared_lookup(struct varatt_external *toast_pointer)
+{
+	struct varlena *result = NULL;
+	dsa_area *area = detoast_shared_get_area();
+	DetoastSharedEntry *set = detoast_shared_set(toast_pointer);
+	detoast_shared_check_oids();
+	LWLockAcquire(detoast_shared->lock, LW_SHARED);
+	uint32 generation = pg_atomic_read_u32(&detoast_shared->generation);
+	for (int i = 0; i < DETOAST_SHARED_WAYS; i++)
+	{
+		DetoastSharedEntry *entry = &set[i];
+		if (detoast_shared_match(entry, toast_pointer, generation))
+		{
+			/* Concurrent updates of the clock of the entry are harmless */
+			entry->lastused = pg_atomic_add_fetch_u64(&detoast_shared->clock, 1);
+			result = palloc(entry->size);
+			memcpy(result, dsa_get_address(area, entry->value), entry->size);
+			break;
+		}
+	}
+	LWLockRelease(detoast_shared->lock);
+	return result;
+}
+
+/*
+ * Add a value to the shared cache, replacing the least recently used entry
+ * of its set. The value is not added if the area has no room for it. The
+ * first backend adding a value after the counter has wrapped frees the
+ * values of the entries invalidated.
+ */
+static void
+detoast_shared_insert(struct varatt_external *toast_pointer,
+	struct varlena *value)
+{
+	Size size = VARSIZE(value);
+	if (size > (Size) shared_cache_size * 1024 / DETOAST_SHARED_WAYS)
+		return;
+	dsa_area *area = detoast_shared_get_area();
+	DetoastSharedEntry *set = detoast_shared_set(toast_pointer);
+	detoast_shared_check_oids();
+	LWLockAcquire(detoast_shared->lock, LW_EXCLUSIVE);
+	uint32 generation = pg_atomic_read_u32(&detoast_shared->generation);
+	if (detoast_shared->freedgen != generation)
+	{
+		int nentries = detoast_shared->nsets * DETOAST_SHARED_WAYS;
+		for (int i = 0; i < nentries; i++)
+		{
+			DetoastSharedEntry *entry = &detoast_shared->entries[i];
+			if (entry->size > 0 && entry->generation != generation)
+			{
+				dsa_free(area, entry->value);
+				entry->size = 0;
+			}
+		}
+		detoast_shared->freedgen = generation;
+	}
+	DetoastSharedEntry *entry = NULL;
+	for (int i = 0; i < DETOAST_SHARED_WAYS; i++)
+	{
+		if (detoast_shared_match(&set[i], toast_pointer, generation))
+		{
+			/* Added by another backend in the meantime */
+			LWLockRelease(detoast_shared->lock);
+			return;
+		}
+		if (entry == NULL || set[i].size == 0 ||
+			(entry->size > 0 && set[i].lastused < entry->lastused))
+			entry = &set[i];
+	}
+	if (entry->size > 0)
+	{
+		dsa_free(area, entry->value);
+		entry->size = 0;
+	}
+	dsa_pointer ptr = dsa_allocate_extended(area, size, DSA_ALLOC_NO_OOM);
+	if (DsaPointerIsValid(ptr))
+	{
+		memcpy(dsa_get_address(area, ptr), value, size);
+		entry->dbid = MyDatabaseId;
+		entry->toastrelid = toast_pointer->va_toastrelid;
+		entry->valueid = toast_pointer->va_valueid;
+		entry->rawsize = toast_pointer->va_rawsize;
+		entry->extsize = toast_pointer->va_extsize;
+		entry->generation = generation;
+		entry->lastused = pg_atomic_add_fetch_u64(&detoast_shared->clock, 1);
+		entry->value = ptr;
+		entry->size = size;
+	}
+	LWLockRelease(detoast_shared->lock);
+}
+
+/*****************************************************************************/
+
+/*
+ * Define the settings of the caches and register the function that empties
+ * the backend cache at the end of the transactions. The shared cache is
+ * only created when the extension is loaded by shared_preload_libraries.
+ * Called when loading the extension.
+ */
+void
+temporal_cache_init(void)
+{
+	DefineCustomIntVariable("mobilitydb.detoast_cache_size",
+		"Maximum amount of memory used to cache the detoasted temporal values.",
+		"The temporal values stored out of line are kept during the "
+		"transaction, so that the functions taking the same value as argument "
+		"fetch it only once. The value 0 disables the cache.",
+		&detoast_cache_size, 8192, 0, MAX_KILOBYTES, PGC_USERSET,
+		GUC_UNIT_KB, NULL, detoast_cache_size_assign, NULL);
+	DefineCustomIntVariable("mobilitydb.shared_cache_size",
+		"Amount of shared memory used to cache the detoasted temporal values.",
+		"The temporal values stored out of line are kept across transactions "
+		"and sessions. Requires loading the extension with "
+		"shared_preload_libraries. The value 0 disables the cache.",
+		&shared_cache_size, 0, 0, MAX_KILOBYTES, PGC_POSTMASTER,
+		GUC_UNIT_KB, NULL, NULL, NULL);
+	RegisterXactCallback(detoast_cache_xact_callback, NULL);
+
+	if (process_shared_preload_libraries_in_progress && shared_cache_size > 0)
+	{
+		RequestAddinShmemSpace(detoast_shared_header_size() + 
+			detoast_shared_area_size());
+		RequestNamedLWLockTranche("MobilityDB detoast cache", 1);
+		prev_shmem_startup_hook = shmem_startup_hook;
+		shmem_startup_hook = detoast_shared_startup;
+	}
+}
+
+/*
+ * Add a value to the cache, evicting the least recently used ones if needed
+ */
+static void
+detoast_cache_insert(struct varatt_external *toast_pointer,
+	struct varlena *value)
+{
+	Size size = VARSIZE(value);
+	Size maxbytes = (Size) detoast_cache_size * 1024;
+	if (size > maxbytes)
+		return;
+	if (detoast_cache_context == NULL)
+		detoast_cache_context = AllocSetContextCreate(TopMemoryContext,
+			"MobilityDB detoast cache", ALLOCSET_DEFAULT_SIZES);
+
+	DetoastCacheEntry *entry;
+	while (true)
+	{
+		DetoastCacheEntry *victim = NULL;
+		entry = NULL;
+		for (int i = 0; i < DETOAST_CACHE_ENTRIES; i++)
+		{
+			if (detoast_cache[i].value == NULL)
+				entry = &detoast_cache[i];
+			else if (victim == NULL ||
+				detoast_cache[i].lastused < victim->lastused)
+				victim = &detoast_cache[i];
+		}
+		if ((entry != NULL && detoast_cache_bytes + size <= maxbytes) ||
+			victim == NULL)
+			break;
+		detoast_cache_bytes -= VARSIZE(victim->value);
+		pfree(victim->value);
+		victim->value = NULL;
+	}
+	entry->toastrelid = toast_pointer->va_toastrelid;
+	entry->valueid = toast_pointer->va_valueid;
+	entry->lastused = ++detoast_cache_clock;
+	entry->value = MemoryContextAlloc(detoast_cache_context, size);
+	memcpy(entry->value, value, size);
+	detoast_cache_bytes += size;
+}
+
+/*
+ * Decode a detoasted value if it is compressed, freeing the compressed copy.
+ * The shared cache keeps the compressed values, which are smaller, while the
+ * local cache keeps the decoded ones.
+ */
+static struct varlena *
+temporal_decode(struct varlena *value)
+{
+	struct varlena *result = (struct varlena *) 
+		temporal_uncompressed((Temporal *) value);
+	if (result != value)
+		pfree(value);
+	return result;
+}
+
+/*
+ * Detoast a temporal argument, reusing the value of a previous call when
+ * the argument is stored out of line. Compressed values are decoded.
+ */
+struct varlena *
+temporal_detoast_cached(Datum value)
+{
+	struct varlena *result = (struct varlena *) DatumGetPointer(value);
+	if (! VARATT_IS_EXTENDED(result))
+		return (struct varlena *) temporal_uncompressed((Temporal *) result);
+
+	struct varatt_external toast_pointer;
+	bool cache = detoast_cache_size > 0 && VARATT_IS_EXTERNAL_ONDISK(result);
+	if (cache)
+	{
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, result);
+		for (int i = 0; i < DETOAST_CACHE_ENTRIES; i++)
+		{
+			DetoastCacheEntry *entry = &detoast_cache[i];
+			if (entry->value != NULL &&
+				entry->valueid == toast_pointer.va_valueid &&
+				entry->toastrelid == toast_pointer.va_toastrelid)
+			{
+				entry->lastused = ++detoast_cache_clock;
+				MOBDB_STAT_INC(STAT_DETOAST_CACHE_HITS);
+				result = palloc(VARSIZE(entry->value));
+				memcpy(result, entry->value, VARSIZE(entry->value));
+				return result;
+			}
+		}
+	}
+
+	/* The shared cache is only used for the values stored out of line */
+	bool shared = detoast_shared != NULL && VARATT_IS_EXTERNAL_ONDISK(result);
+	if (shared)
+	{
+		if (! cache)
+			VARATT_EXTERNAL_GET_POINTER(toast_pointer, result);
+		struct varlena *value = detoast_shared_lookup(&toast_pointer);
+		if (value != NULL)
+		{
+			MOBDB_STAT_INC(STAT_SHARED_CACHE_HITS);
+			result = temporal_decode(value);
+			if (cache)
+				detoast_cache_insert(&toast_pointer, result);
+			return result;
+		}
+	}
+
+	MOBDB_PROFILE_BEGIN(start);
+	result = pg_detoast_datum(result);
+	MOBDB_PROFILE_END("detoast", start);
+	MOBDB_STAT_INC(STAT_DETOASTED_VALUES);
+	MOBDB_STAT_ADD(STAT_DETOASTED_BYTES, VARSIZE(result));
+	if (shared)
+		detoast_shared_insert(&toast_pointer, result);
+	result = temporal_decode(result);
+	if (cache)
+		detoast_cache_insert(&toast_pointer, result);
+	return result;
+}
+
+/*****************************************************************************/
@@ -14,6 +14,8 @@
 
 #include <utils/lsyscache.h>
 
+#include "period.h"
+#include "timeops.h"
 #include "temporaltypes.h"
 #include "temporal_util.h"
 #include "lifting.h"
@@ -51,6 +53,367 @@ tcomp_temporal_base(Temporal *temp, Datum value, Oid datumtypid,
 	return result;
 }
 
+/*****************************************************************************
+ * Comparison of temporal numbers with linear interpolation
+ *
+ * When at least one of two temporal numbers has linear interpolation, their
+ * comparison depends on the sign of the difference of their values. This
+ * difference is linear in each synchronized segment and thus changes its
+ * sign at most once per segment, at the crossing of the two segments. The
+ * functions below compute these signs on the values of the segments and
+ * only emit the instants at which the comparison changes its value, instead
+ * of synchronizing the arguments with their crossings, building one or
+ * more Boolean sequences per segment, and normalizing them afterwards. The
+ * value of a comparison for a negative, zero, and positive difference is
+ * given by an array of three Booleans.
+ *****************************************************************************/
+
+static const bool tcomp_eq_signs[3] = {false, true, false};
+static const bool tcomp_ne_signs[3] = {true, false, true};
+static const bool tcomp_lt_signs[3] = {true, false, false};
+static const bool tcomp_le_signs[3] = {true, true, false};
+static const bool tcomp_gt_signs[3] = {false, false, true};
+static const bool tcomp_ge_signs[3] = {false, true, true};
+
+/*
+ * Builder of the sequences of a temporal Boolean with stepwise interpolation
+ * from consecutive pieces of constant value. Adjacent pieces are joined in
+ * the same sequence whenever it can represent them, so that the resulting
+ * sequences are normalized.
+ */
+typedef struct
+{
+	TemporalSeq **sequences;	/* Sequences built so far */
+	int			count;			/* Number of sequences built so far */
+	TemporalInst **instants;	/* Instants of the open sequence */
+	int			ninstants;		/* Number of instants of the open sequence */
+	bool		lower_inc;		/* Lower bound of the open sequence */
+	TimestampTz upper;			/* Upper bound of the open sequence */
+	bool		upper_inc;
+	bool		value;			/* Value at the end of the open sequence */
+} TBoolSeqBuilder;
+
+static void
+tboolseq_builder_close(TBoolSeqBuilder *builder)
+{
+	if (builder->ninstants == 0)
+		return;
+	if (builder->instants[builder->ninstants - 1]->t != builder->upper)
+		builder->instants[builder->ninstants++] = temporalinst_make(
+			BoolGetDatum(builder->value), builder->upper, BOOLOID);
+	builder->sequences[builder->count++] = temporalseq_from_temporalinstarr(
+		builder->instants, builder->ninstants, builder->lower_inc,
+		builder->upper_inc, false, false);
+	for (int i = 0; i < builder->ninstants; i++)
+		pfree(builder->instants[i]);
+	builder->ninstants = 0;
+}
+
+/*
+ * Appends a piece of constant value after the pieces already appended
+ */
+static void
+tboolseq_builder_add(TBoolSeqBuilder *builder, bool value, TimestampTz lower,
+	bool lower_inc, TimestampTz upper, bool upper_inc)
+{
+	bool adjacent = builder->ninstants > 0 && lower == builder->upper &&
+		(builder->upper_inc || lower_inc);
+	/* A step sequence can change its value at an instant included in the
+	 * next piece but not just after an instant included in the previous one */
+	if (adjacent && (value == builder->value || ! builder->upper_inc))
+	{
+		if (value != builder->value)
+			builder->instants[builder->ninstants++] = temporalinst_make(
+				BoolGetDatum(value), lower, BOOLOID);
+	}
+	else
+	{
+		tboolseq_builder_close(builder);
+		builder->instants[builder->ninstants++] = temporalinst_make(
+			BoolGetDatum(value), lower, BOOLOID);
+		builder->lower_inc = lower_inc;
+	}
+	builder->upper = upper;
+	builder->upper_inc = upper_inc;
+	builder->value = value;
+}
+
+static inline int
+double_sign(double x, double y)
+{
+	return (x > y) - (x < y);
+}
+
+/*
+ * Value at the timestamp of a segment of a temporal number given by the 
+ * values at its bounds, computed as in temporalseq_value_at_timestamp1
+ */
+static double
+tnumber_segment_value(TimestampTz t1, double value1, TimestampTz t2,
+	double value2, bool linear, TimestampTz t)
+{
+	if (value1 == value2 || t1 == t || (! linear && t < t2))
+		return value1;
+	if (t == t2)
+		return value2;
+	double ratio = (double) (t - t1) / (double) (t2 - t1);
+	return value1 + (value2 - value1) * ratio;
+}
+
+/*
+ * Fraction of a segment with linear interpolation at which it takes a value
+ * located between the values at its bounds, computed as in 
+ * tlinearseq_timestamp_at_value
+ */
+static double
+tnumber_segment_fraction(double value1, double value2, double value)
+{
+	double min = Min(value1, value2);
+	double max = Max(value1, value2);
+	double partial = value - min;
+	return value1 < value2 ? partial / (max - min) : 1 - partial / (max - min);
+}
+
+/*
+ * Appends the comparison of two synchronized segments
+ */
+static void
+tcomp_tnumber_segment(TBoolSeqBuilder *builder, const bool *signs,
+	TimestampTz t1, TimestampTz t2, double start1, double end1, bool linear1,
+	double start2, double end2, bool linear2, bool lower_inc, bool upper_inc)
+{
+	int startsign = double_sign(start1, start2);
+	if (lower_inc)
+		tboolseq_builder_add(builder, signs[startsign + 1], t1, true, t1, true);
+
+	/* Sign of the difference just before the end of the segment */
+	int lastsign = double_sign(linear1 ? end1 : start1,
+		linear2 ? end2 : start2);
+	if (startsign != 0 && lastsign != 0 && startsign != lastsign)
+	{
+		/* The difference changes its sign at the crossing of the segments */
+		double fraction;
+		if (! linear1)
+			fraction = tnumber_segment_fraction(start2, end2, start1);
+		else if (! linear2)
+			fraction = tnumber_segment_fraction(start1, end1, start2);
+		else
+			fraction = (start2 - start1) / (end1 - start1 - end2 + start2);
+		TimestampTz cross = t1 + (long) ((double) (t2 - t1) * fraction);
+		if (fraction > EPSILON && fraction < 1.0 - EPSILON &&
+			t1 < cross && cross < t2)
+		{
+			tboolseq_builder_add(builder, signs[startsign + 1], t1, false, 
+				cross, false);
+			tboolseq_builder_add(builder, signs[1], cross, true, cross, true);
+			tboolseq_builder_add(builder, signs[lastsign + 1], cross, false, 
+				t2, false);
+		}
+		else
+			/* As in the synchronization, crossings too close to the bounds
+			 * are ignored */
+			tboolseq_builder_add(builder, signs[startsign + 1], t1, false, 
+				t2, false);
+	}
+	else
+		tboolseq_builder_add(builder, 
+			signs[(startsign != 0 ? startsign : lastsign) + 1], t1, false, 
+			t2, false);
+
+	if (upper_inc)
+		tboolseq_builder_add(builder, signs[double_sign(end1, end2) + 1], 
+			t2, true, t2, true);
+}
+
+/*
+ * Value of a temporal number sequence at a timestamp contained in it
+ */
+static double
+tnumberseq_value_at(TemporalSeq *seq, TimestampTz t, int *n)
+{
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	*n = 0;
+	if (seq->count == 1 || timestamp_cmp_internal(t, inst1->t) == 0)
+		return datum_double(temporalinst_value(inst1), seq->valuetypid);
+	*n = temporalseq_find_timestamp(seq, t);
+	inst1 = temporalseq_inst_n(seq, *n);
+	TemporalInst *inst2 = temporalseq_inst_n(seq, *n + 1);
+	return tnumber_segment_value(inst1->t,
+		datum_double(temporalinst_value(inst1), seq->valuetypid), inst2->t,
+		datum_double(temporalinst_value(inst2), seq->valuetypid),
+		MOBDB_FLAGS_GET_LINEAR(seq->flags), t);
+}
+
+/*
+ * Appends the comparison of two temporal number sequences
+ */
+static void
+tcomp_tnumberseq_tnumberseq(TBoolSeqBuilder *builder, TemporalSeq *seq1,
+	TemporalSeq *seq2, const bool *signs)
+{
+	/* Test whether the bounding period of the two temporal values overlap */
+	Period *inter = intersection_period_period_internal(&seq1->period, 
+		&seq2->period);
+	if (inter == NULL)
+		return;
+
+	bool linear1 = MOBDB_FLAGS_GET_LINEAR(seq1->flags);
+	bool linear2 = MOBDB_FLAGS_GET_LINEAR(seq2->flags);
+	int i, j;
+	double start1 = tnumberseq_value_at(seq1, inter->lower, &i);
+	double start2 = tnumberseq_value_at(seq2, inter->lower, &j);
+	/* If the two sequences intersect at an instant */
+	if (timestamp_cmp_internal(inter->lower, inter->upper) == 0)
+	{
+		tboolseq_builder_add(builder, signs[double_sign(start1, start2) + 1],
+			inter->lower, true, inter->lower, true);
+		pfree(inter);
+		return;
+	}
+
+	/* General case */
+	TimestampTz t1 = inter->lower;
+	bool lower_inc = inter->lower_inc;
+	i++; j++;
+	while (i < seq1->count && j < seq2->count)
+	{
+		TemporalInst *inst1 = temporalseq_inst_n(seq1, i);
+		TemporalInst *inst2 = temporalseq_inst_n(seq2, j);
+		double end1 = datum_double(temporalinst_value(inst1), seq1->valuetypid);
+		double end2 = datum_double(temporalinst_value(inst2), seq2->valuetypid);
+		TimestampTz t2;
+		int cmp = timestamp_cmp_internal(inst1->t, inst2->t);
+		if (cmp == 0)
+		{
+			t2 = inst1->t;
+			i++; j++;
+		}
+		else if (cmp < 0)
+		{
+			t2 = inst1->t;
+			end2 = tnumber_segment_value(t1, start2, inst2->t, end2, linear2, t2);
+			i++;
+		}
+		else
+		{
+			t2 = inst2->t;
+			end1 = tnumber_segment_value(t1, start1, inst1->t, end1, linear1, t2);
+			j++;
+		}
+		bool upper_inc = (timestamp_cmp_internal(t2, inter->upper) == 0) ? 
+			inter->upper_inc : false;
+		tcomp_tnumber_segment(builder, signs, t1, t2, start1, end1, linear1,
+			start2, end2, linear2, lower_inc, upper_inc);
+		t1 = t2;
+		start1 = end1;
+		start2 = end2;
+		lower_inc = true;
+	}
+	pfree(inter);
+}
+
+static int
+tnumber_instants(Temporal *temp)
+{
+	return temp->duration == TEMPORALSEQ ? ((TemporalSeq *) temp)->count :
+		((TemporalS *) temp)->totalcount;
+}
+
+/*
+ * Comparison of two temporal numbers of sequence or sequence set duration,
+ * at least one of them having linear interpolation
+ */
+static TemporalS *
+tcomp_tnumber_tnumber_cross(Temporal *temp1, Temporal *temp2, 
+	const bool *signs)
+{
+	TemporalSeq **sequences1, **sequences2;
+	int count1, count2;
+	if (temp1->duration == TEMPORALSEQ)
+	{
+		sequences1 = (TemporalSeq **) &temp1;
+		count1 = 1;
+	}
+	else
+	{
+		count1 = ((TemporalS *) temp1)->count;
+		sequences1 = palloc(sizeof(TemporalSeq *) * count1);
+		for (int i = 0; i < count1; i++)
+			sequences1[i] = temporals_seq_n((TemporalS *) temp1, i);
+	}
+	if (temp2->duration == TEMPORALSEQ)
+	{
+		sequences2 = (TemporalSeq **) &temp2;
+		count2 = 1;
+	}
+	else
+	{
+		count2 = ((TemporalS *) temp2)->count;
+		sequences2 = palloc(sizeof(TemporalSeq *) * count2);
+		for (int i = 0; i < count2; i++)
+			sequences2[i] = temporals_seq_n((TemporalS *) temp2, i);
+	}
+
+	/* Each synchronized segment adds at most five pieces, and there are less
+	 * segments than twice the number of instants of the arguments */
+	int maxcount = 10 * (tnumber_instants(temp1) + tnumber_instants(temp2));
+	TBoolSeqBuilder builder;
+	builder.sequences = palloc(sizeof(TemporalSeq *) * maxcount);
+	builder.instants = palloc(sizeof(TemporalInst *) * maxcount);
+	builder.count = builder.ninstants = 0;
+
+	int i = 0, j = 0;
+	while (i < count1 && j < count2)
+	{
+		TemporalSeq *seq1 = sequences1[i];
+		TemporalSeq *seq2 = sequences2[j];
+		tcomp_tnumberseq_tnumberseq(&builder, seq1, seq2, signs);
+		if (period_eq_internal(&seq1->period, &seq2->period))
+		{
+			i++; j++;
+		}
+		else if (period_lt_internal(&seq1->period, &seq2->period))
+			i++; 
+		else 
+			j++;
+	}
+	tboolseq_builder_close(&builder);
+
+	TemporalS *result = NULL;
+	if (builder.count > 0)
+		/* The sequences are already normalized */
+		result = temporals_from_temporalseqarr(builder.sequences, 
+			builder.count, false, false);
+	for (i = 0; i < builder.count; i++)
+		pfree(builder.sequences[i]);
+	pfree(builder.sequences); pfree(builder.instants);
+	if (temp1->duration == TEMPORALS)
+		pfree(sequences1);
+	if (temp2->duration == TEMPORALS)
+		pfree(sequences2);
+	return result;
+}
+
+/*
+ * Generic comparison of two temporal values
+ */
+static Temporal *
+tcomp_temporal_temporal(Temporal *temp1, Temporal *temp2,
+	Datum (*func)(Datum, Datum, Oid, Oid), const bool *signs)
+{
+	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
+		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
+	if (! linear)
+		return sync_tfunc4_temporal_temporal(temp1, temp2, func, BOOLOID, 
+			linear, NULL);
+	if ((temp1->valuetypid == INT4OID || temp1->valuetypid == FLOAT8OID) &&
+		(temp2->valuetypid == INT4OID || temp2->valuetypid == FLOAT8OID) &&
+		(temp1->duration == TEMPORALSEQ || temp1->duration == TEMPORALS) &&
+		(temp2->duration == TEMPORALSEQ || temp2->duration == TEMPORALS))
+		return (Temporal *) tcomp_tnumber_tnumber_cross(temp1, temp2, signs);
+	return sync_tfunc4_temporal_temporal_cross(temp1, temp2, func, BOOLOID);
+}
+
 /*****************************************************************************
  * Temporal eq
  *****************************************************************************/
@@ -90,13 +453,8 @@ teq_temporal_temporal(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
-		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
-	Temporal *result = linear ?
-		sync_tfunc4_temporal_temporal_cross(temp1, temp2, &datum2_eq2, 
-			BOOLOID) :
-		sync_tfunc4_temporal_temporal(temp1, temp2, &datum2_eq2, BOOLOID, 
-			linear, NULL);
+	Temporal *result = tcomp_temporal_temporal(temp1, temp2, &datum2_eq2,
+		tcomp_eq_signs);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -143,13 +501,8 @@ tne_temporal_temporal(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
-		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
-	Temporal *result = linear ?
-		sync_tfunc4_temporal_temporal_cross(temp1, temp2, &datum2_ne2,
-			BOOLOID) :
-		sync_tfunc4_temporal_temporal(temp1, temp2, &datum2_ne2, BOOLOID, 
-			linear, NULL);
+	Temporal *result = tcomp_temporal_temporal(temp1, temp2, &datum2_ne2,
+		tcomp_ne_signs);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -196,13 +549,8 @@ tlt_temporal_temporal(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
-		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
-	Temporal *result = linear ?
-		sync_tfunc4_temporal_temporal_cross(temp1, temp2, &datum2_lt2,
-			BOOLOID) :
-		sync_tfunc4_temporal_temporal(temp1, temp2, &datum2_lt2, BOOLOID, 
-			linear, NULL);
+	Temporal *result = tcomp_temporal_temporal(temp1, temp2, &datum2_lt2,
+		tcomp_lt_signs);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -249,13 +597,8 @@ tle_temporal_temporal(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
-		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
-	Temporal *result = linear ?
-		sync_tfunc4_temporal_temporal_cross(temp1, temp2, &datum2_le2,
-			BOOLOID) :
-		sync_tfunc4_temporal_temporal(temp1, temp2, &datum2_le2, BOOLOID, 
-			linear, NULL);
+	Temporal *result = tcomp_temporal_temporal(temp1, temp2, &datum2_le2,
+		tcomp_le_signs);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -302,13 +645,8 @@ tgt_temporal_temporal(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
-		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
-	Temporal *result = linear ?
-		sync_tfunc4_temporal_temporal_cross(temp1, temp2, &datum2_gt2,
-			BOOLOID) :
-		sync_tfunc4_temporal_temporal(temp1, temp2, &datum2_gt2, BOOLOID, 
-			linear, NULL);
+	Temporal *result = tcomp_temporal_temporal(temp1, temp2, &datum2_gt2,
+		tcomp_gt_signs);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
@@ -355,13 +693,8 @@ tge_temporal_temporal(PG_FUNCTION_ARGS)
 {
 	Temporal *temp1 = PG_GETARG_TEMPORAL(0);
 	Temporal *temp2 = PG_GETARG_TEMPORAL(1);
-	bool linear = MOBDB_FLAGS_GET_LINEAR(temp1->flags) || 
-		MOBDB_FLAGS_GET_LINEAR(temp2->flags);
-	Temporal *result = linear ?
-		sync_tfunc4_temporal_temporal_cross(temp1, temp2, &datum2_ge2,
-			BOOLOID) :
-		sync_tfunc4_temporal_temporal(temp1, temp2, &datum2_ge2, BOOLOID, 
-			linear, NULL);
+	Temporal *result = tcomp_temporal_temporal(temp1, temp2, &datum2_ge2,
+		tcomp_ge_signs);
 	PG_FREE_IF_COPY(temp1, 0);
 	PG_FREE_IF_COPY(temp2, 1);
 	if (result == NULL)
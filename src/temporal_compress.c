@@ -0,0 +1,591 @@
+/*****************************************************************************
+ *
+ * temporal_compress.c
+ *	  Compressed encoding of temporal sequences and sequence sets
+ *
+ * Long sequences spend most of their size in the headers of the instants,
+ * their timestamps, and their values, which the TOAST compression reduces
+ * poorly. The function temporal_compress writes a TemporalSeq or TemporalS
+ * in a compressed layout recorded with the COMPRESSED flag, as explained in
+ * temporal.h, where the instants are encoded as follows
+ * - The first timestamp is written as is and the following ones as the
+ *   difference of their deltas, i.e., delta-of-delta, in zigzag varints.
+ *   Regularly sampled timestamps then take one byte each.
+ * - The floats are XORed with the previous one as in the Gorilla encoding,
+ *   at the byte level: a control byte with the number of leading and
+ *   trailing zero bytes of the XOR is followed by its remaining bytes.
+ * - The integers are written as zigzag varints of their deltas and the
+ *   Booleans as one byte.
+ * - The points are written as the coordinates of the serialized point that
+ *   differ from the ones of the previous point, encoded as the floats. The
+ *   serialized point of the first instant is written once and is used as
+ *   template for the other ones, which must thus have the same SRID and
+ *   flags. Points are not quantized since the values must be kept exactly.
+ * - The texts are written as is after their length.
+ * The instants of a TemporalS are preceded by the bounds and the number of
+ * instants of their sequence.
+ *
+ * The bounding box and the period of a compressed value are kept decoded.
+ * The accessors to them and temporal_bbox_slice thus do not decode the
+ * value. The instants are decoded by PG_GETARG_TEMPORAL, which keeps the
+ * decoded value in the cache of detoasted values. All the functions hence
+ * work on compressed values as on the other ones, and the values they
+ * return are not compressed.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_compress.h"
+
+#include <assert.h>
+#include <lib/stringinfo.h>
+#include <utils/timestamp.h>
+
+#include "period.h"
+#include "temporaltypes.h"
+#include "oidcache.h"
+#include "temporal_util.h"
+#include "temporal_boxops.h"
+#include "temporal_stats.h"
+
+/* State of the encoding or decoding of the instants of a value */
+typedef struct
+{
+	Oid			valuetypid;		/* Base type */
+	char	   *point;			/* Serialized point used as template */
+	size_t		pointsize;		/* Size of the serialized point */
+	int			ncoords;		/* Number of coordinates of the points */
+	TimestampTz	prevtime;		/* Previous timestamp */
+	uint64		prevdelta;		/* Previous delta of the timestamps */
+	bool		first;			/* No timestamp has been encoded yet */
+	int32		prevint;		/* Previous integer */
+	uint64		prevbits[3];	/* Previous float or coordinates */
+} CompressState;
+
+/* Encoded instants being decoded */
+typedef struct
+{
+	const uint8 *ptr;			/* Next byte to read */
+	const uint8 *end;			/* End of the encoded instants */
+} CompressReader;
+
+static bool
+point_type(Oid valuetypid)
+{
+#ifdef WITH_POSTGIS
+	return valuetypid == type_oid(T_GEOMETRY) ||
+		valuetypid == type_oid(T_GEOGRAPHY);
+#else
+	return false;
+#endif
+}
+
+static void
+compress_state_init(CompressState *state, Oid valuetypid, int16 flags)
+{
+	memset(state, 0, sizeof(CompressState));
+	state->valuetypid = valuetypid;
+	state->ncoords = MOBDB_FLAGS_GET_Z(flags) ? 3 : 2;
+	state->first = true;
+}
+
+/*****************************************************************************
+ * Encoding
+ *****************************************************************************/
+
+static void
+append_varint(StringInfo buf, uint64 value)
+{
+	while (value >= 0x80)
+	{
+		appendStringInfoChar(buf, (char) ((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	appendStringInfoChar(buf, (char) value);
+}
+
+static void
+append_zigzag(StringInfo buf, int64 value)
+{
+	append_varint(buf, ((uint64) value << 1) ^ (uint64) (value >> 63));
+}
+
+/* Append the XOR of the bits with the previous ones */
+static void
+append_xor(StringInfo buf, uint64 bits, uint64 *prev)
+{
+	uint64 x = bits ^ *prev;
+	*prev = bits;
+	if (x == 0)
+	{
+		appendStringInfoChar(buf, (char) (8 << 4));
+		return;
+	}
+	int lead = 0, trail = 0;
+	while (((x >> (56 - 8 * lead)) & 0xFF) == 0)
+		lead++;
+	while (((x >> (8 * trail)) & 0xFF) == 0)
+		trail++;
+	appendStringInfoChar(buf, (char) ((lead << 4) | trail));
+	for (int i = 7 - lead; i >= trail; i--)
+		appendStringInfoChar(buf, (char) ((x >> (8 * i)) & 0xFF));
+}
+
+static void
+compress_timestamp(StringInfo buf, CompressState *state, TimestampTz t)
+{
+	if (state->first)
+	{
+		appendBinaryStringInfo(buf, (char *) &t, sizeof(TimestampTz));
+		state->first = false;
+	}
+	else
+	{
+		/* The deltas are computed in unsigned arithmetic to wrap around */
+		uint64 delta = (uint64) t - (uint64) state->prevtime;
+		append_zigzag(buf, (int64) (delta - state->prevdelta));
+		state->prevdelta = delta;
+	}
+	state->prevtime = t;
+}
+
+static void
+compress_value(StringInfo buf, CompressState *state, Datum value)
+{
+	if (state->valuetypid == BOOLOID)
+		appendStringInfoChar(buf, DatumGetBool(value) ? 1 : 0);
+	else if (state->valuetypid == INT4OID)
+	{
+		int32 i = DatumGetInt32(value);
+		append_zigzag(buf, (int64) i - (int64) state->prevint);
+		state->prevint = i;
+	}
+	else if (state->valuetypid == FLOAT8OID)
+	{
+		double d = DatumGetFloat8(value);
+		uint64 bits;
+		memcpy(&bits, &d, sizeof(uint64));
+		append_xor(buf, bits, &state->prevbits[0]);
+	}
+	else if (state->valuetypid == TEXTOID)
+	{
+		char *text = DatumGetPointer(value);
+		append_varint(buf, VARSIZE_ANY(text));
+		appendBinaryStringInfo(buf, text, VARSIZE_ANY(text));
+	}
+	else /* point_type(state->valuetypid) */
+	{
+		char *coords = DatumGetPointer(value) + state->pointsize -
+			sizeof(double) * state->ncoords;
+		for (int i = 0; i < state->ncoords; i++)
+		{
+			uint64 bits;
+			memcpy(&bits, coords + sizeof(double) * i, sizeof(uint64));
+			append_xor(buf, bits, &state->prevbits[i]);
+		}
+	}
+}
+
+static void
+compress_seq(StringInfo buf, CompressState *state, TemporalSeq *seq)
+{
+	for (int i = 0; i < seq->count; i++)
+	{
+		TemporalInst *inst = temporalseq_inst_n(seq, i);
+		compress_timestamp(buf, state, inst->t);
+		compress_value(buf, state, temporalinst_value(inst));
+	}
+}
+
+/*
+ * Set the template of the points of the sequence and ensure that all its
+ * points only differ from it by their coordinates
+ */
+static bool
+compress_points(CompressState *state, TemporalSeq *seq)
+{
+	for (int i = 0; i < seq->count; i++)
+	{
+		char *point = DatumGetPointer(temporalinst_value(
+			temporalseq_inst_n(seq, i)));
+		if (state->point == NULL)
+		{
+			state->point = point;
+			state->pointsize = VARSIZE(point);
+		}
+		else if (VARSIZE(point) != state->pointsize || memcmp(point,
+			state->point, state->pointsize - sizeof(double) * state->ncoords) != 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Make a compressed value from the fixed part of the temporal value, its
+ * bounding box, its period if it is a TemporalS, and the encoded instants
+ */
+static Temporal *
+temporal_compressed_make(Temporal *temp, size_t fixedsize, void *bbox,
+	Period *period, StringInfo buf)
+{
+	size_t bboxsize = temporal_bbox_size(temp->valuetypid);
+	size_t size = fixedsize + double_pad(bboxsize) +
+		(period != NULL ? double_pad(sizeof(Period)) : 0) + buf->len;
+	Temporal *result = palloc0(size);
+	memcpy(result, temp, fixedsize);
+	SET_VARSIZE(result, size);
+	MOBDB_FLAGS_SET_TRAJ(result->flags, false);
+	MOBDB_FLAGS_SET_SUMMARY(result->flags, false);
+	MOBDB_FLAGS_SET_OFFSETS32(result->flags, true);
+	MOBDB_FLAGS_SET_COMPRESSED(result->flags, true);
+	char *data = (char *) result + fixedsize;
+	memcpy(data, bbox, bboxsize);
+	data += double_pad(bboxsize);
+	if (period != NULL)
+	{
+		memcpy(data, period, sizeof(Period));
+		data += double_pad(sizeof(Period));
+	}
+	memcpy(data, buf->data, buf->len);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, size);
+	return result;
+}
+
+/**
+ * @brief Returns the temporal value in the compressed layout
+ * @note The value is returned unchanged if it is not a TemporalSeq or a
+ * 		TemporalS, if its points do not all have the same SRID and flags,
+ * 		or if the compressed layout is not smaller.
+ */
+Temporal *
+temporal_compress_internal(Temporal *temp)
+{
+	if ((temp->duration != TEMPORALSEQ && temp->duration != TEMPORALS) ||
+		MOBDB_FLAGS_GET_COMPRESSED(temp->flags))
+		return temporal_copy(temp);
+	if (temp->valuetypid != BOOLOID && temp->valuetypid != INT4OID &&
+		temp->valuetypid != FLOAT8OID && temp->valuetypid != TEXTOID &&
+		! point_type(temp->valuetypid))
+		return temporal_copy(temp);
+
+	CompressState state;
+	compress_state_init(&state, temp->valuetypid, temp->flags);
+	StringInfoData buf;
+	initStringInfo(&buf);
+	Temporal *result;
+	if (temp->duration == TEMPORALSEQ)
+	{
+		TemporalSeq *seq = (TemporalSeq *) temp;
+		if (point_type(temp->valuetypid) && ! compress_points(&state, seq))
+			return temporal_copy(temp);
+		if (state.point != NULL)
+		{
+			append_varint(&buf, state.pointsize);
+			appendBinaryStringInfo(&buf, state.point, state.pointsize);
+		}
+		compress_seq(&buf, &state, seq);
+		result = temporal_compressed_make(temp, offsetof(TemporalSeq, offsets),
+			temporalseq_bbox_ptr(seq), NULL, &buf);
+	}
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		if (point_type(temp->valuetypid))
+		{
+			for (int i = 0; i < ts->count; i++)
+				if (! compress_points(&state, temporals_seq_n(ts, i)))
+					return temporal_copy(temp);
+			append_varint(&buf, state.pointsize);
+			appendBinaryStringInfo(&buf, state.point, state.pointsize);
+		}
+		for (int i = 0; i < ts->count; i++)
+		{
+			TemporalSeq *seq = temporals_seq_n(ts, i);
+			appendStringInfoChar(&buf, (char) ((seq->period.lower_inc ? 1 : 0) |
+				(seq->period.upper_inc ? 2 : 0)));
+			append_varint(&buf, (uint64) seq->count);
+			compress_seq(&buf, &state, seq);
+		}
+		Period p;
+		temporals_period(&p, ts);
+		result = temporal_compressed_make(temp, offsetof(TemporalS, offsets),
+			temporals_bbox_ptr(ts), &p, &buf);
+	}
+	pfree(buf.data);
+	if (VARSIZE(result) >= VARSIZE(temp))
+	{
+		pfree(result);
+		return temporal_copy(temp);
+	}
+	return result;
+}
+
+/*****************************************************************************
+ * Decoding
+ *****************************************************************************/
+
+static uint8
+read_byte(CompressReader *reader)
+{
+	if (reader->ptr >= reader->end)
+		ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED),
+			errmsg("Corrupted compressed temporal value")));
+	return *reader->ptr++;
+}
+
+static void
+read_bytes(CompressReader *reader, void *result, size_t size)
+{
+	if (reader->end - reader->ptr < (ptrdiff_t) size)
+		ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED),
+			errmsg("Corrupted compressed temporal value")));
+	memcpy(result, reader->ptr, size);
+	reader->ptr += size;
+}
+
+static uint64
+read_varint(CompressReader *reader)
+{
+	uint64 result = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		uint8 byte = read_byte(reader);
+		result |= (uint64) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return result;
+	}
+	ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED),
+		errmsg("Corrupted compressed temporal value")));
+	return 0;	/* make the compiler quiet */
+}
+
+static int64
+read_zigzag(CompressReader *reader)
+{
+	uint64 value = read_varint(reader);
+	return (int64) (value >> 1) ^ -((int64) (value & 1));
+}
+
+static uint64
+read_xor(CompressReader *reader, uint64 *prev)
+{
+	uint8 control = read_byte(reader);
+	int lead = control >> 4, trail = control & 0x0F;
+	uint64 x = 0;
+	if (lead + trail > 8)
+		ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED),
+			errmsg("Corrupted compressed temporal value")));
+	for (int i = 7 - lead; i >= trail; i--)
+		x |= (uint64) read_byte(reader) << (8 * i);
+	*prev ^= x;
+	return *prev;
+}
+
+static TimestampTz
+decompress_timestamp(CompressReader *reader, CompressState *state)
+{
+	if (state->first)
+	{
+		read_bytes(reader, &state->prevtime, sizeof(TimestampTz));
+		state->first = false;
+	}
+	else
+	{
+		state->prevdelta += (uint64) read_zigzag(reader);
+		state->prevtime = (TimestampTz) ((uint64) state->prevtime +
+			state->prevdelta);
+	}
+	return state->prevtime;
+}
+
+/* Decode an instant, the buffer of a point being reused for all instants */
+static TemporalInst *
+decompress_inst(CompressReader *reader, CompressState *state)
+{
+	TimestampTz t = decompress_timestamp(reader, state);
+	Datum value;
+	if (state->valuetypid == BOOLOID)
+		value = BoolGetDatum(read_byte(reader) != 0);
+	else if (state->valuetypid == INT4OID)
+	{
+		state->prevint = (int32) ((int64) state->prevint + read_zigzag(reader));
+		value = Int32GetDatum(state->prevint);
+	}
+	else if (state->valuetypid == FLOAT8OID)
+	{
+		uint64 bits = read_xor(reader, &state->prevbits[0]);
+		double d;
+		memcpy(&d, &bits, sizeof(double));
+		value = Float8GetDatum(d);
+	}
+	else if (state->valuetypid == TEXTOID)
+	{
+		size_t size = (size_t) read_varint(reader);
+		char *text = palloc(size);
+		read_bytes(reader, text, size);
+		TemporalInst *result = temporalinst_make(PointerGetDatum(text), t,
+			state->valuetypid);
+		pfree(text);
+		return result;
+	}
+	else /* point_type(state->valuetypid) */
+	{
+		char *coords = state->point + state->pointsize -
+			sizeof(double) * state->ncoords;
+		for (int i = 0; i < state->ncoords; i++)
+		{
+			uint64 bits = read_xor(reader, &state->prevbits[i]);
+			memcpy(coords + sizeof(double) * i, &bits, sizeof(uint64));
+		}
+		value = PointerGetDatum(state->point);
+	}
+	return temporalinst_make(value, t, state->valuetypid);
+}
+
+static TemporalSeq *
+decompress_seq(CompressReader *reader, CompressState *state, int count,
+	bool lower_inc, bool upper_inc, bool linear)
+{
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
+	for (int i = 0; i < count; i++)
+		instants[i] = decompress_inst(reader, state);
+	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, count,
+		lower_inc, upper_inc, linear, false);
+	for (int i = 0; i < count; i++)
+		pfree(instants[i]);
+	pfree(instants);
+	return result;
+}
+
+/**
+ * @brief Returns the temporal value in the uncompressed layout, i.e., the
+ * 		value itself if it is not compressed
+ */
+Temporal *
+temporal_uncompressed(Temporal *temp)
+{
+	if (temp->duration == TEMPORALINST || temp->duration == TEMPORALI ||
+		! MOBDB_FLAGS_GET_COMPRESSED(temp->flags))
+		return temp;
+
+	CompressState state;
+	compress_state_init(&state, temp->valuetypid, temp->flags);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(temp->flags);
+	size_t fixedsize = temp->duration == TEMPORALSEQ ?
+		offsetof(TemporalSeq, offsets) : offsetof(TemporalS, offsets);
+	size_t datasize = fixedsize +
+		double_pad(temporal_bbox_size(temp->valuetypid));
+	if (temp->duration == TEMPORALS)
+		datasize += double_pad(sizeof(Period));
+	CompressReader reader;
+	reader.ptr = (uint8 *) temp + datasize;
+	reader.end = (uint8 *) temp + VARSIZE(temp);
+	if (point_type(temp->valuetypid))
+	{
+		state.pointsize = (size_t) read_varint(&reader);
+		if (state.pointsize < VARHDRSZ + sizeof(double) * state.ncoords)
+			ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED),
+				errmsg("Corrupted compressed temporal value")));
+		state.point = palloc(state.pointsize);
+		read_bytes(&reader, state.point, state.pointsize);
+	}
+
+	Temporal *result;
+	if (temp->duration == TEMPORALSEQ)
+	{
+		TemporalSeq *seq = (TemporalSeq *) temp;
+		result = (Temporal *) decompress_seq(&reader, &state, seq->count,
+			seq->period.lower_inc, seq->period.upper_inc, linear);
+	}
+	else /* temp->duration == TEMPORALS */
+	{
+		TemporalS *ts = (TemporalS *) temp;
+		TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+		for (int i = 0; i < ts->count; i++)
+		{
+			uint8 bounds = read_byte(&reader);
+			int count = (int) read_varint(&reader);
+			sequences[i] = decompress_seq(&reader, &state, count,
+				(bounds & 1) != 0, (bounds & 2) != 0, linear);
+		}
+		result = (Temporal *) temporals_from_temporalseqarr(sequences,
+			ts->count, linear, false);
+		for (int i = 0; i < ts->count; i++)
+			pfree(sequences[i]);
+		pfree(sequences);
+	}
+	if (state.point != NULL)
+		pfree(state.point);
+	return result;
+}
+
+/**
+ * @brief Detoast the temporal value and decode it if it is compressed
+ * @note This function must be used instead of DatumGetTemporal when the
+ * 		instants of the value are accessed
+ */
+Temporal *
+temporal_detoast_uncompressed(Datum value)
+{
+	Temporal *temp = DatumGetTemporal(value);
+	Temporal *result = temporal_uncompressed(temp);
+	if (result != temp && temp != (Temporal *) DatumGetPointer(value))
+		pfree(temp);
+	return result;
+}
+
+/*****************************************************************************
+ * SQL functions
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(temporal_compress);
+/**
+ * @brief Returns the temporal value in the compressed layout
+ */
+PGDLLEXPORT Datum
+temporal_compress(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Temporal *result = temporal_compress_internal(temp);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_decompress);
+/**
+ * @brief Returns the temporal value in the uncompressed layout
+ * @note The argument is decoded by PG_GETARG_TEMPORAL
+ */
+PGDLLEXPORT Datum
+temporal_decompress(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Temporal *result = temporal_copy(temp);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_POINTER(result);
+}
+
+PG_FUNCTION_INFO_V1(temporal_is_compressed);
+/**
+ * @brief Returns true if the temporal value is stored in the compressed
+ * 		layout
+ * @note Only the fixed part of the value is fetched, which is not decoded
+ */
+PGDLLEXPORT Datum
+temporal_is_compressed(PG_FUNCTION_ARGS)
+{
+	Datum tempdatum = PG_GETARG_DATUM(0);
+	Temporal *temp = (Temporal *) PG_DETOAST_DATUM_SLICE(tempdatum, 0,
+		sizeof(Temporal) - VARHDRSZ);
+	bool result = temp->duration != TEMPORALINST &&
+		temp->duration != TEMPORALI && MOBDB_FLAGS_GET_COMPRESSED(temp->flags);
+	if (temp != (Temporal *) DatumGetPointer(tempdatum))
+		pfree(temp);
+	PG_RETURN_BOOL(result);
+}
+
+/*****************************************************************************/
@@ -0,0 +1,119 @@
+/*****************************************************************************
+ *
+ * temporal_expanded.c
+ *	  Read-write expanded temporal values transformed in place
+ *
+ * Unary transformations such as shift, setSRID, or the cast of a temporal
+ * integer to a temporal float only rewrite the timestamps, the values, or
+ * the bounding box of a copy of their argument, without changing its size.
+ * When their argument is a read-write pointer to an expanded temporal value,
+ * which the executor passes when the argument is the result of another
+ * function, the argument is dead after the call and the transformation
+ * overwrites it instead of copying it. These functions always return an
+ * expanded value, so that in an expression such as
+ * shift(setSRID(trip, 3812), '1 hour') the value is copied only once and
+ * is flattened when it is stored or output. The transformations that must
+ * build their result anew, such as setPrecision for sequences, which may
+ * remove the instants made redundant by the rounding, free their read-write
+ * argument as soon as the result is built, so that the intermediate values
+ * of the expression are not all kept until the end of the row.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_expanded.h"
+
+#include <assert.h>
+#include <utils/memutils.h>
+
+#include "temporal_cache.h"
+#include "temporal_stats.h"
+
+/*****************************************************************************/
+
+static Size
+expanded_temporal_get_flat_size(ExpandedObjectHeader *eohptr)
+{
+	ExpandedTemporal *et = (ExpandedTemporal *) eohptr;
+	return VARSIZE(et->temp);
+}
+
+static void
+expanded_temporal_flatten_into(ExpandedObjectHeader *eohptr, void *result,
+	Size allocated_size)
+{
+	ExpandedTemporal *et = (ExpandedTemporal *) eohptr;
+	assert(allocated_size == VARSIZE(et->temp));
+	memcpy(result, et->temp, allocated_size);
+}
+
+static const ExpandedObjectMethods expanded_temporal_methods =
+{
+	expanded_temporal_get_flat_size,
+	expanded_temporal_flatten_into
+};
+
+/**
+ * @brief Creates an expanded temporal value without a value in the current
+ *		memory context
+ *
+ * The caller sets the value, which must be allocated in the memory context
+ * of the object.
+ */
+ExpandedTemporal *
+expanded_temporal_make(void)
+{
+	MemoryContext objcxt = AllocSetContextCreate(CurrentMemoryContext,
+		"expanded temporal", ALLOCSET_START_SMALL_SIZES);
+	ExpandedTemporal *et = MemoryContextAllocZero(objcxt, 
+		sizeof(ExpandedTemporal));
+	EOH_init_header(&et->hdr, &expanded_temporal_methods, objcxt);
+	return et;
+}
+
+/**
+ * @brief Returns the expanded temporal value pointed to by the datum if it
+ * 		is a read-write pointer, and NULL otherwise
+ */
+ExpandedTemporal *
+temporal_get_expanded_rw(Datum value)
+{
+	if (! VARATT_IS_EXTERNAL_EXPANDED_RW(DatumGetPointer(value)))
+		return NULL;
+	ExpandedObjectHeader *eohptr = DatumGetEOHP(value);
+	if (eohptr->eoh_methods != &expanded_temporal_methods)
+		return NULL;
+	MOBDB_STAT_INC(STAT_EXPANDED_REUSED);
+	return (ExpandedTemporal *) eohptr;
+}
+
+/**
+ * @brief Returns an expanded temporal value that the caller may overwrite
+ *
+ * The value pointed to by a read-write pointer is returned as is. Otherwise,
+ * the argument is detoasted into a new expanded value in the current memory
+ * context, which costs the same single copy as the transformations that do
+ * not work in place.
+ */
+ExpandedTemporal *
+temporal_expand_rw(Datum value)
+{
+	ExpandedTemporal *et = temporal_get_expanded_rw(value);
+	if (et != NULL)
+		return et;
+
+	et = expanded_temporal_make();
+	MemoryContext oldcxt = MemoryContextSwitchTo(et->hdr.eoh_context);
+	Temporal *temp = (Temporal *) temporal_detoast_cached(value);
+	if ((Pointer) temp == DatumGetPointer(value))
+		temp = temporal_copy(temp);
+	MemoryContextSwitchTo(oldcxt);
+	et->temp = temp;
+	return et;
+}
+
+/*****************************************************************************/
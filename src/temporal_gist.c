@@ -14,12 +14,136 @@
 #include "temporal_gist.h"
 
 #include <access/gist.h>
+#include <storage/proc.h>
+#include <utils/snapmgr.h>
 
 #include "timetypes.h"
 #include "temporal.h"
 #include "oidcache.h"
 #include "time_gist.h"
 
+/*****************************************************************************
+ * Cache of the boxes of the queries
+ *****************************************************************************/
+
+/*
+ * Maximum number of query boxes kept by an index method
+ */
+#define INDEX_QUERY_CACHE_ENTRIES	4
+
+typedef struct
+{
+	Oid subtype;			/* Type of the query */
+	struct varlena *raw;	/* Copy of the query as received, NULL if unused */
+	LocalTransactionId lxid;	/* For a query stored out of line, transaction */
+	TransactionId xmax;		/* and snapshot in which it was converted */
+	CommandId curcid;
+	bool found;				/* Result of the conversion into a box */
+	void *box;				/* Box of the query */
+} IndexQueryEntry;
+
+/*
+ * The consistent and distance methods of the indexes are called for each
+ * index entry visited with the same query. The boxes of the last queries 
+ * are kept in fn_extra, which lives as long as the scan for GiST and as long
+ * as the relation cache entry of the index for SP-GiST, together with a copy
+ * of the query as received. A query compressed inline is identified by this
+ * copy, which is its contents. A query stored out of line is only 
+ * identified by its TOAST pointer while the value it points to cannot have
+ * been replaced, since the identifiers of the TOAST values are reused once
+ * the OID counter wraps around. The box of such a query is thus only reused
+ * in the same transaction with a snapshot that has the same xmax and command
+ * identifier, that is, when no transaction has committed a new value in the 
+ * meantime. The snapshot does not change during a scan, so that such a
+ * query is still converted only once per scan.
+ */
+typedef struct
+{
+	int next;				/* Entry replaced when adding a box */
+	IndexQueryEntry entries[INDEX_QUERY_CACHE_ENTRIES];
+} IndexQueryCache;
+
+/**
+ * @brief Convert the query argument of an index method into a box, 
+ * keeping the box in fn_extra for the next calls with the same query
+ *
+ * Only the queries compressed or stored out of line are cached, since
+ * converting them requires detoasting them at each call. The other ones 
+ * are converted directly, their box being read from their header in most
+ * cases. The box is set by the conversion function also when it returns
+ * false, e.g., the SP-GiST methods rely on its infinite dimensions.
+ */
+bool
+index_query_box(FmgrInfo *flinfo, Datum query, Oid subtype,
+	index_query_box_func func, size_t boxsize, void *box)
+{
+	struct varlena *raw = (struct varlena *) DatumGetPointer(query);
+	bool ondisk = VARATT_IS_EXTERNAL_ONDISK(raw);
+	if (flinfo == NULL || (! ondisk && ! VARATT_IS_COMPRESSED(raw)) ||
+		(ondisk && ! ActiveSnapshotSet()))
+		return func(box, query, subtype);
+	Snapshot snapshot = ondisk ? GetActiveSnapshot() : NULL;
+
+	IndexQueryCache *cache = (IndexQueryCache *) flinfo->fn_extra;
+	if (cache == NULL)
+	{
+		cache = MemoryContextAllocZero(flinfo->fn_mcxt, sizeof(IndexQueryCache));
+		flinfo->fn_extra = cache;
+	}
+	Size size = VARSIZE_ANY(raw);
+	IndexQueryEntry *entry;
+	for (int i = 0; i < INDEX_QUERY_CACHE_ENTRIES; i++)
+	{
+		entry = &cache->entries[i];
+		if (entry->raw != NULL && entry->subtype == subtype && 
+			VARSIZE_ANY(entry->raw) == size && memcmp(entry->raw, raw, size) == 0 &&
+			(! ondisk || (entry->lxid == MyProc->lxid && 
+				entry->xmax == snapshot->xmax && 
+				entry->curcid == snapshot->curcid)))
+		{
+			MOBDB_STAT_INC(STAT_INDEX_QUERY_CACHE_HITS);
+			memcpy(box, entry->box, boxsize);
+			return entry->found;
+		}
+	}
+
+	bool result = func(box, query, subtype);
+	entry = &cache->entries[cache->next];
+	cache->next = (cache->next + 1) % INDEX_QUERY_CACHE_ENTRIES;
+	if (entry->raw != NULL)
+	{
+		pfree(entry->raw);
+		pfree(entry->box);
+	}
+	entry->raw = MemoryContextAlloc(flinfo->fn_mcxt, size);
+	memcpy(entry->raw, raw, size);
+	entry->box = MemoryContextAlloc(flinfo->fn_mcxt, boxsize);
+	memcpy(entry->box, box, boxsize);
+	entry->subtype = subtype;
+	if (ondisk)
+	{
+		entry->lxid = MyProc->lxid;
+		entry->xmax = snapshot->xmax;
+		entry->curcid = snapshot->curcid;
+	}
+	entry->found = result;
+	return result;
+}
+
+/*
+ * Convert a temporal query into its bounding box, whose type depends on
+ * the one of the temporal value
+ */
+bool
+temporal_query_box(void *box, Datum query, Oid subtype)
+{
+	Temporal *temp = (Temporal *) temporal_detoast_cached(query);
+	temporal_bbox(box, temp);
+	if ((Pointer) temp != DatumGetPointer(query))
+		pfree(temp);
+	return true;
+}
+
 /*****************************************************************************
  * Consistent method for temporal types
  *****************************************************************************/
@@ -29,6 +153,7 @@ PG_FUNCTION_INFO_V1(gist_temporal_consistent);
 PGDLLEXPORT Datum
 gist_temporal_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
 	StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
 	Oid 		subtype = PG_GETARG_OID(3);
@@ -49,12 +174,9 @@ gist_temporal_consistent(PG_FUNCTION_ARGS)
 	}
 	else if (temporal_type_oid(subtype))
 	{
-		Temporal *query = PG_GETARG_TEMPORAL(1);
-		if (query == NULL)
-			PG_RETURN_BOOL(false);
 		period = &p;
-		temporal_bbox(period, query);
-		PG_FREE_IF_COPY(query, 1);
+		index_query_box(fcinfo->flinfo, PG_GETARG_DATUM(1), subtype,
+			&temporal_query_box, sizeof(Period), period);
 	}
 	else
 		elog(ERROR, "unrecognized strategy number: %d", strategy);
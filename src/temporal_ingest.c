@@ -0,0 +1,337 @@
+/*****************************************************************************
+ *
+ * temporal_ingest.c
+ *	  Batched ingestion of instants into temporal columns
+ *
+ * Appending instants one at a time with appendInstant rewrites the whole
+ * temporal value for every new observation. The functions in this file
+ * instead accumulate the incoming instants in a staging table whose rows
+ * are pairs (key, instant), and periodically flush them into a target table
+ * whose rows are pairs (key, temporal). Each flush moves a batch of staging
+ * rows, groups them by key and time, and calls appendInstants once per key,
+ * so that each temporal value is copied once per batch. Instants that are
+ * not after the end of the temporal value of their key are discarded. Keys
+ * that are not yet in the target table are inserted as new sequences.
+ *
+ * The flush can be called explicitly with ingestFlush or by a dynamic
+ * background worker started with ingestStart, which flushes the staging
+ * table every given number of milliseconds, and immediately again as long
+ * as the batches are full. The worker runs as the user who started it and
+ * is stopped with pg_terminate_backend.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_ingest.h"
+
+#include <access/htup_details.h>
+#include <access/xact.h>
+#include <catalog/pg_proc.h>
+#include <executor/spi.h>
+#include <lib/stringinfo.h>
+#include <miscadmin.h>
+#include <pgstat.h>
+#include <postmaster/bgworker.h>
+#include <storage/ipc.h>
+#include <storage/latch.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/snapmgr.h>
+#include <utils/syscache.h>
+
+#include "temporal.h"
+
+/*
+ * Arguments of the background worker, passed in the bgw_extra field of its
+ * registration. The relation and column names are resolved by the worker
+ * at each flush so that renaming them does not break the ingestion.
+ */
+typedef struct
+{
+	Oid			dbid;			/* Database of the tables */
+	Oid			userid;			/* User who started the worker */
+	Oid			staging;		/* Staging table */
+	Oid			target;			/* Target table */
+	AttrNumber	keyatt;			/* Key column of the target table */
+	AttrNumber	tempatt;		/* Temporal column of the target table */
+	int			interval;		/* Flush interval in milliseconds */
+	int			batchsize;		/* Maximum number of staging rows per flush */
+} IngestWorkerArgs;
+
+/* Set by the SIGTERM handler of the worker */
+static volatile sig_atomic_t ingest_got_sigterm = false;
+
+/*****************************************************************************
+ * Flush of the staging table
+ *****************************************************************************/
+
+/*
+ * Returns the qualified and quoted name of the relation
+ */
+static char *
+ingest_relname(Oid relid)
+{
+	char *relname = get_rel_name(relid);
+	if (relname == NULL)
+		ereport(ERROR, (errcode(ERRCODE_UNDEFINED_TABLE),
+			errmsg("Relation with OID %u does not exist", relid)));
+	return quote_qualified_identifier(
+		get_namespace_name(get_rel_namespace(relid)), relname);
+}
+
+/*
+ * Returns the quoted name of the column of the relation
+ */
+static const char *
+ingest_attname(Oid relid, AttrNumber attnum)
+{
+	char *attname = get_attname(relid, attnum, true);
+	if (attname == NULL)
+		ereport(ERROR, (errcode(ERRCODE_UNDEFINED_COLUMN),
+			errmsg("Column %d of relation with OID %u does not exist",
+				attnum, relid)));
+	return quote_identifier(attname);
+}
+
+/*
+ * Moves at most batchsize rows of the staging table into the target table
+ * and returns the number of rows moved. The staging table must have two
+ * columns named as the key and temporal columns of the target table, the
+ * latter containing instants. Rows locked by a concurrent flush are skipped.
+ * The function must be called within a transaction with an active snapshot.
+ */
+int64
+ingest_flush_internal(Oid staging, Oid target, AttrNumber keyatt,
+	AttrNumber tempatt, int batchsize)
+{
+	char *stagname = ingest_relname(staging);
+	char *targname = ingest_relname(target);
+	const char *key = ingest_attname(target, keyatt);
+	const char *temp = ingest_attname(target, tempatt);
+	/* The constructor of sequences of the type, e.g., tgeompointseq */
+	char *typname = format_type_be(get_atttype(target, tempatt));
+
+	StringInfoData query;
+	initStringInfo(&query);
+	appendStringInfo(&query,
+		"WITH batch AS ("
+		"DELETE FROM %s WHERE ctid = ANY(ARRAY("
+		"SELECT ctid FROM %s LIMIT %d FOR UPDATE SKIP LOCKED)) "
+		"RETURNING %s AS k, %s AS inst), ",
+		stagname, stagname, batchsize, key, temp);
+	appendStringInfo(&query,
+		"grouped AS ("
+		"SELECT k, array_agg(inst ORDER BY getTimestamp(inst)) AS insts "
+		"FROM (SELECT DISTINCT ON (k, getTimestamp(inst)) k, inst FROM batch "
+		"WHERE k IS NOT NULL AND inst IS NOT NULL) b GROUP BY k), ");
+	appendStringInfo(&query,
+		"updated AS ("
+		"UPDATE %s t SET %s = appendInstants(t.%s, ARRAY("
+		"SELECT i FROM unnest(g.insts) WITH ORDINALITY u(i, n) "
+		"WHERE getTimestamp(i) > endTimestamp(t.%s) ORDER BY n)) "
+		"FROM grouped g WHERE t.%s = g.k RETURNING t.%s AS k), ",
+		targname, temp, temp, temp, key, key);
+	appendStringInfo(&query,
+		"inserted AS ("
+		"INSERT INTO %s (%s, %s) SELECT g.k, %sseq(g.insts) FROM grouped g "
+		"WHERE NOT EXISTS (SELECT 1 FROM updated u WHERE u.k = g.k) "
+		"RETURNING 1) "
+		"SELECT count(*) FROM batch",
+		targname, key, temp, typname);
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "SPI_connect failed");
+	if (SPI_execute(query.data, false, 0) != SPI_OK_SELECT ||
+		SPI_processed != 1)
+		elog(ERROR, "Cannot flush the staging table %s", stagname);
+	bool isnull;
+	int64 result = DatumGetInt64(SPI_getbinval(SPI_tuptable->vals[0],
+		SPI_tuptable->tupdesc, 1, &isnull));
+	SPI_finish();
+	pfree(query.data);
+	return result;
+}
+
+/*
+ * Verifies the arguments of the flush and returns the attribute numbers
+ * of the key and temporal columns of the target table
+ */
+static void
+ingest_check_args(Oid target, Name keycol, Name tempcol, int batchsize,
+	AttrNumber *keyatt, AttrNumber *tempatt)
+{
+	*keyatt = get_attnum(target, NameStr(*keycol));
+	if (*keyatt == InvalidAttrNumber)
+		ereport(ERROR, (errcode(ERRCODE_UNDEFINED_COLUMN),
+			errmsg("Column \"%s\" does not exist in the target table",
+				NameStr(*keycol))));
+	*tempatt = get_attnum(target, NameStr(*tempcol));
+	if (*tempatt == InvalidAttrNumber)
+		ereport(ERROR, (errcode(ERRCODE_UNDEFINED_COLUMN),
+			errmsg("Column \"%s\" does not exist in the target table",
+				NameStr(*tempcol))));
+	if (! temporal_type_oid(get_atttype(target, *tempatt)))
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("Column \"%s\" must be of a temporal type",
+				NameStr(*tempcol))));
+	if (batchsize <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The batch size must be strictly positive")));
+}
+
+PG_FUNCTION_INFO_V1(ingest_flush);
+/**
+ * @brief Move a batch of rows of a staging table into a target table
+ */
+PGDLLEXPORT Datum
+ingest_flush(PG_FUNCTION_ARGS)
+{
+	Oid staging = PG_GETARG_OID(0);
+	Oid target = PG_GETARG_OID(1);
+	Name keycol = PG_GETARG_NAME(2);
+	Name tempcol = PG_GETARG_NAME(3);
+	int batchsize = PG_GETARG_INT32(4);
+	AttrNumber keyatt, tempatt;
+	ingest_check_args(target, keycol, tempcol, batchsize, &keyatt, &tempatt);
+	int64 result = ingest_flush_internal(staging, target, keyatt, tempatt,
+		batchsize);
+	PG_RETURN_INT64(result);
+}
+
+/*****************************************************************************
+ * Background worker
+ *****************************************************************************/
+
+static void
+ingest_sigterm(SIGNAL_ARGS)
+{
+	int save_errno = errno;
+	ingest_got_sigterm = true;
+	SetLatch(MyLatch);
+	errno = save_errno;
+}
+
+/**
+ * @brief Main function of the background worker flushing a staging table
+ */
+void
+ingest_worker_main(Datum main_arg)
+{
+	IngestWorkerArgs args;
+	memcpy(&args, MyBgworkerEntry->bgw_extra, sizeof(IngestWorkerArgs));
+
+	pqsignal(SIGTERM, ingest_sigterm);
+	BackgroundWorkerUnblockSignals();
+	BackgroundWorkerInitializeConnectionByOid(args.dbid, args.userid, 0);
+
+	bool full = false;
+	while (! ingest_got_sigterm)
+	{
+		/* A full batch means that the staging table is behind and thus the
+		 * next batch is flushed without waiting */
+		if (! full)
+		{
+			int rc = WaitLatch(MyLatch,
+				WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+				args.interval, PG_WAIT_EXTENSION);
+			ResetLatch(MyLatch);
+			if (rc & WL_POSTMASTER_DEATH)
+				proc_exit(1);
+			if (ingest_got_sigterm)
+				break;
+		}
+		CHECK_FOR_INTERRUPTS();
+
+		SetCurrentStatementStartTimestamp();
+		StartTransactionCommand();
+		PushActiveSnapshot(GetTransactionSnapshot());
+		pgstat_report_activity(STATE_RUNNING, "ingestFlush");
+		int64 count = ingest_flush_internal(args.staging, args.target,
+			args.keyatt, args.tempatt, args.batchsize);
+		PopActiveSnapshot();
+		CommitTransactionCommand();
+		pgstat_report_stat(false);
+		pgstat_report_activity(STATE_IDLE, NULL);
+		full = (count == args.batchsize);
+	}
+	proc_exit(0);
+}
+
+/*
+ * Returns the name of the shared library defining the function, so that
+ * the worker is loaded from the same file as the extension
+ */
+static char *
+ingest_library_name(Oid fnoid)
+{
+	HeapTuple tuple = SearchSysCache1(PROCOID, ObjectIdGetDatum(fnoid));
+	if (! HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for function %u", fnoid);
+	bool isnull;
+	Datum probin = SysCacheGetAttr(PROCOID, tuple, Anum_pg_proc_probin,
+		&isnull);
+	if (isnull)
+		elog(ERROR, "null probin for function %u", fnoid);
+	char *result = TextDatumGetCString(probin);
+	ReleaseSysCache(tuple);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(ingest_start);
+/**
+ * @brief Start a background worker periodically flushing a staging table
+ * 		into a target table and return its process identifier
+ */
+PGDLLEXPORT Datum
+ingest_start(PG_FUNCTION_ARGS)
+{
+	StaticAssertStmt(sizeof(IngestWorkerArgs) <= BGW_EXTRALEN,
+		"ingest worker arguments do not fit in bgw_extra");
+	IngestWorkerArgs args;
+	args.dbid = MyDatabaseId;
+	args.userid = GetUserId();
+	args.staging = PG_GETARG_OID(0);
+	args.target = PG_GETARG_OID(1);
+	Name keycol = PG_GETARG_NAME(2);
+	Name tempcol = PG_GETARG_NAME(3);
+	args.interval = PG_GETARG_INT32(4);
+	args.batchsize = PG_GETARG_INT32(5);
+	ingest_check_args(args.target, keycol, tempcol, args.batchsize,
+		&args.keyatt, &args.tempatt);
+	if (args.interval <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The flush interval must be strictly positive")));
+
+	BackgroundWorker worker;
+	memset(&worker, 0, sizeof(BackgroundWorker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS |
+		BGWORKER_BACKEND_DATABASE_CONNECTION;
+	worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	strlcpy(worker.bgw_library_name, ingest_library_name(fcinfo->flinfo->fn_oid),
+		BGW_MAXLEN);
+	strlcpy(worker.bgw_function_name, "ingest_worker_main", BGW_MAXLEN);
+	snprintf(worker.bgw_name, BGW_MAXLEN, "mobilitydb ingest into %s",
+		get_rel_name(args.target));
+	strlcpy(worker.bgw_type, "mobilitydb ingest", BGW_MAXLEN);
+	worker.bgw_main_arg = (Datum) 0;
+	worker.bgw_notify_pid = MyProcPid;
+	memcpy(worker.bgw_extra, &args, sizeof(IngestWorkerArgs));
+
+	BackgroundWorkerHandle *handle;
+	if (! RegisterDynamicBackgroundWorker(&worker, &handle))
+		ereport(ERROR, (errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+			errmsg("Cannot register the ingest background worker"),
+			errhint("You may need to increase max_worker_processes.")));
+	pid_t pid;
+	if (WaitForBackgroundWorkerStartup(handle, &pid) != BGWH_STARTED)
+		ereport(ERROR, (errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+			errmsg("Cannot start the ingest background worker")));
+	PG_RETURN_INT32(pid);
+}
+
+/*****************************************************************************/
@@ -0,0 +1,175 @@
+/*****************************************************************************
+ *
+ * temporal_parallel.c
+ *	  Pool of threads for the numeric kernels of a single query
+ *
+ * Some functions spend most of their time in numeric computations over
+ * coordinates that have been decoded beforehand, e.g., the filtering of the
+ * candidate pairs of tdwithin_pairs. The function parallel_for splits such a
+ * computation into chunks that are run by the backend and by a pool of
+ * threads. The threads are started the first time they are needed and live
+ * as long as the backend. They have all signals blocked so that the signals
+ * are always handled by the backend, and they never call PostgreSQL: the
+ * kernels they run only read and write plain C arrays prepared by the
+ * backend, which merges the results once all chunks are done.
+ *
+ * The pool is only compiled when the extension is built with WITH_THREADS.
+ * The number of threads is bounded by mobilitydb.max_threads, whose default
+ * value 1 runs the kernels in the backend only.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_parallel.h"
+
+#ifdef WITH_THREADS
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+int parallel_max_threads = 1;
+
+#ifdef WITH_THREADS
+
+/*
+ * State of the pool shared by the backend and the threads, protected by
+ * the mutex. A job is the range [0, count) of items to which the kernel is
+ * applied, split into chunks of the given size. The threads whose number
+ * is at least nhelpers do not take part in the current job.
+ */
+static struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t work;		/* Signaled when a job is posted */
+	pthread_cond_t done;		/* Signaled when the last chunk is finished */
+	int			nthreads;		/* Number of started threads */
+	int			nhelpers;		/* Number of threads used by the current job */
+	ParallelKernel kernel;		/* Kernel of the current job */
+	void	   *arg;			/* Argument of the kernel */
+	int			count;			/* Number of items of the current job */
+	int			chunk;			/* Number of items per chunk */
+	int			next;			/* First item of the next chunk to run */
+	int			pending;		/* Number of chunks not yet finished */
+} pool =
+{
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER, 0, 0, NULL, NULL, 0, 0, 0, 0
+};
+
+/*
+ * Runs the chunks of the current job until there are none left. The mutex
+ * is held when the function is called and when it returns.
+ */
+static void
+parallel_run_chunks(void)
+{
+	while (pool.next < pool.count)
+	{
+		int start = pool.next;
+		int end = Min(start + pool.chunk, pool.count);
+		pool.next = end;
+		ParallelKernel kernel = pool.kernel;
+		void *arg = pool.arg;
+		pthread_mutex_unlock(&pool.lock);
+		kernel(arg, start, end);
+		pthread_mutex_lock(&pool.lock);
+		if (--pool.pending == 0)
+			pthread_cond_signal(&pool.done);
+	}
+}
+
+static void *
+parallel_thread_main(void *arg)
+{
+	int idx = (int) (intptr_t) arg;
+	pthread_mutex_lock(&pool.lock);
+	for (;;)
+	{
+		while (pool.next >= pool.count || idx >= pool.nhelpers)
+			pthread_cond_wait(&pool.work, &pool.lock);
+		parallel_run_chunks();
+	}
+	return NULL;
+}
+
+/*
+ * Starts threads until the pool has the given number of them and returns
+ * the number of threads actually available. The signals are blocked while
+ * the threads are created so that they inherit a mask blocking all signals.
+ */
+static int
+parallel_start_threads(int nthreads)
+{
+	if (pool.nthreads >= nthreads)
+		return nthreads;
+	sigset_t all, old;
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	while (pool.nthreads < nthreads)
+	{
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, &parallel_thread_main,
+				(void *) (intptr_t) pool.nthreads) != 0)
+			break;
+		pthread_detach(thread);
+		pool.nthreads++;
+	}
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	return pool.nthreads;
+}
+
+#endif /* WITH_THREADS */
+
+/**
+ * @brief Apply the kernel to the items [0, count), splitting them into
+ * 		chunks of at least minchunk items that are run in parallel
+ *
+ * The function returns when the kernel has been applied to all items.
+ * When the extension is built without WITH_THREADS, when the pool is
+ * limited to one thread, or when there are too few items, the kernel is
+ * applied to all items by the backend.
+ */
+void
+parallel_for(int count, int minchunk, ParallelKernel kernel, void *arg)
+{
+	if (count <= 0)
+		return;
+#ifdef WITH_THREADS
+	minchunk = Max(minchunk, 1);
+	int nthreads = Min(parallel_max_threads, (count + minchunk - 1) / minchunk);
+	if (nthreads > 1)
+		/* The backend is one of the threads running the job */
+		nthreads = parallel_start_threads(nthreads - 1) + 1;
+	if (nthreads > 1)
+	{
+		/* Several chunks per thread balance the load of uneven items */
+		int nchunks = Min(nthreads * 4, (count + minchunk - 1) / minchunk);
+		pthread_mutex_lock(&pool.lock);
+		pool.kernel = kernel;
+		pool.arg = arg;
+		pool.chunk = (count + nchunks - 1) / nchunks;
+		pool.pending = (count + pool.chunk - 1) / pool.chunk;
+		pool.next = 0;
+		pool.count = count;
+		pool.nhelpers = nthreads - 1;
+		pthread_cond_broadcast(&pool.work);
+		parallel_run_chunks();
+		while (pool.pending > 0)
+			pthread_cond_wait(&pool.done, &pool.lock);
+		pool.kernel = NULL;
+		pool.arg = NULL;
+		pool.count = 0;
+		pool.next = 0;
+		pool.nhelpers = 0;
+		pthread_mutex_unlock(&pool.lock);
+		return;
+	}
+#endif
+	kernel(arg, 0, count);
+}
+
+/*****************************************************************************/
@@ -3,10 +3,11 @@
  * temporal_parser.c
  *	  Functions for parsing time types and temporal types.
  *
- * Many functions make two passes for parsing, the first one to obtain the 
- * number of elements in order to do memory allocation with palloc, the second
- * one to create the type. This is the only approach we can see at the moment
- * which is both correct and simple.
+ * The functions make a single pass over the input, collecting the elements
+ * in an array that is enlarged as needed and creating the type at the end.
+ * Timestamps in the canonical ISO format with an explicit time zone offset
+ * and plain floating point numbers are parsed directly, and all other
+ * values are passed to the input function of their type.
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  *		Universite Libre de Bruxelles
@@ -17,12 +18,18 @@
 
 #include "temporal_parser.h"
 
+#include <ctype.h>
+#include <math.h>
+#include <utils/datetime.h>
+
 #include "periodset.h"
 #include "period.h"
 #include "timestampset.h"
 #include "temporaltypes.h"
 #include "temporal_util.h"
 
+/* Initial number of elements of the arrays collecting the parsed elements */
+#define PARSE_INITIAL_COUNT 64
 
 /*****************************************************************************/
 
@@ -117,6 +124,33 @@ p_comma(char **str)
 	return false;
 }
 
+/*
+ * Parse a plain finite floating point number without calling the input 
+ * function. Returns false if the string is not such a number, in which case
+ * the input function must be called, either because the value has a 
+ * special form, e.g., 'NaN' or 'Infinity', or to raise the error.
+ */
+static bool
+double_parse_fast(char *str, Datum *result)
+{
+	while (*str == ' ' || *str == '\t' || *str == '\n' || *str == '\r')
+		str++;
+	if (! isdigit((unsigned char) *str) && *str != '-' && *str != '+' &&
+		*str != '.')
+		return false;
+	char *end;
+	errno = 0;
+	double d = strtod(str, &end);
+	if (end == str || errno != 0 || ! isfinite(d))
+		return false;
+	while (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r')
+		end++;
+	if (*end != '\0')
+		return false;
+	*result = Float8GetDatum(d);
+	return true;
+}
+
 Datum 
 basetype_parse(char **str, Oid basetype)
 {
@@ -142,7 +176,9 @@ basetype_parse(char **str, Oid basetype)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse element value")));
 	(*str)[delim] = '\0';
-	Datum result = call_input(basetype, *str);
+	Datum result;
+	if (basetype != FLOAT8OID || ! double_parse_fast(*str, &result))
+		result = call_input(basetype, *str);
 	if (isttext)
 		/* Replace the double quote */
 		(*str)[delim++] = '"';
@@ -281,10 +317,97 @@ tbox_parse(char **str)
 /*****************************************************************************/
 /* Time Types */
 
+/* Read n decimal digits, returns -1 if they are not all digits */
+static int
+p_digits(const char *str, int n)
+{
+	int result = 0;
+	for (int i = 0; i < n; i++)
+	{
+		if (! isdigit((unsigned char) str[i]))
+			return -1;
+		result = result * 10 + (str[i] - '0');
+	}
+	return result;
+}
+
+/*
+ * Parse a timestamp in the canonical format YYYY-MM-DD HH:MM:SS[.ffffff]
+ * followed by a time zone offset +HH[:MM], that is, the output format for 
+ * the ISO DateStyle, without calling the input function. The offset makes
+ * the value independent of the TimeZone setting. Returns false if the 
+ * string is not in this format, in which case the input function must be 
+ * called, either because the value has another valid format or to raise 
+ * the error.
+ */
+static bool
+timestamp_parse_fast(char **str, TimestampTz *result)
+{
+	const char *s = *str;
+	struct pg_tm tt, *tm = &tt;
+	fsec_t fsec = 0;
+	memset(tm, 0, sizeof(struct pg_tm));
+	/* The fields are tested in order so that the string is not read past
+	 * its end */
+	if ((tm->tm_year = p_digits(s, 4)) < 1 || s[4] != '-' ||
+		(tm->tm_mon = p_digits(s + 5, 2)) < 1 || tm->tm_mon > 12 ||
+		s[7] != '-' || (tm->tm_mday = p_digits(s + 8, 2)) < 1 ||
+		tm->tm_mday > day_tab[isleap(tm->tm_year)][tm->tm_mon - 1] ||
+		(s[10] != ' ' && s[10] != 'T') ||
+		(tm->tm_hour = p_digits(s + 11, 2)) < 0 || tm->tm_hour > 23 ||
+		s[13] != ':' || (tm->tm_min = p_digits(s + 14, 2)) < 0 ||
+		tm->tm_min > 59 || s[16] != ':' ||
+		(tm->tm_sec = p_digits(s + 17, 2)) < 0 || tm->tm_sec > 59)
+		return false;
+	s += 19;
+	if (*s == '.')
+	{
+		int ndigits = 0;
+		s++;
+		while (isdigit((unsigned char) *s) && ndigits < 6)
+		{
+			fsec = fsec * 10 + (*s++ - '0');
+			ndigits++;
+		}
+		/* More than 6 digits needs rounding */
+		if (ndigits == 0 || isdigit((unsigned char) *s))
+			return false;
+		for (; ndigits < 6; ndigits++)
+			fsec *= 10;
+	}
+	if (*s != '+' && *s != '-')
+		return false;
+	int sign = (*s == '+') ? 1 : -1;
+	int tzhour = p_digits(s + 1, 2), tzmin = 0;
+	if (tzhour < 0 || tzhour > 15)
+		return false;
+	s += 3;
+	if (*s == ':')
+	{
+		tzmin = p_digits(s + 1, 2);
+		if (tzmin < 0 || tzmin > 59)
+			return false;
+		s += 3;
+	}
+	/* Ensure the timestamp ends here, a space may be followed by 'BC' */
+	if (*s != ',' && *s != ']' && *s != ')' && *s != '}' && *s != '\0')
+		return false;
+	/* The time zone is given in seconds west of UTC */
+	int tz = - sign * (tzhour * SECS_PER_HOUR + tzmin * SECS_PER_MINUTE);
+	if (tm2timestamp(tm, fsec, &tz, result) != 0 || 
+		! IS_VALID_TIMESTAMP(*result))
+		return false;
+	*str = (char *) s;
+	return true;
+}
+
 TimestampTz 
 timestamp_parse(char **str) 
 {
 	p_whitespace(str);
+	TimestampTz t;
+	if (timestamp_parse_fast(str, &t))
+		return t;
 	int delim = 0;
 	while ((*str)[delim] != ',' && (*str)[delim] != ']' && (*str)[delim] != ')' && 
 		(*str)[delim] != '}' && (*str)[delim] != '\0')
@@ -333,27 +456,21 @@ timestampset_parse(char **str)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse timestamp set")));
 
-	/* First parsing */
-	char *bak = *str;
-	timestamp_parse(str);
-	int count = 1;
-	while (p_comma(str)) 
+	int count = 0, maxcount = PARSE_INITIAL_COUNT;
+	TimestampTz *times = palloc(sizeof(TimestampTz) * maxcount);
+	do
 	{
-		count++;
-		timestamp_parse(str);
-	}
+		if (count == maxcount)
+		{
+			maxcount *= 2;
+			times = repalloc(times, sizeof(TimestampTz) * maxcount);
+		}
+		times[count++] = timestamp_parse(str);
+	} while (p_comma(str));
 	if (!p_cbrace(str))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse timestamp set")));
 
-	*str = bak;
-	TimestampTz *times = palloc(sizeof(TimestampTz) * count);
-	for (int i = 0; i < count; i++) 
-	{
-		p_comma(str);
-		times[i] = timestamp_parse(str);
-	}
-	p_cbrace(str);
 	TimestampSet *result = timestampset_from_timestamparr_internal(times, count);
 
 	pfree(times);
@@ -368,28 +485,21 @@ periodset_parse(char **str)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse period set")));
 
-	/* First parsing */
-	char *bak = *str;
-	period_parse(str, false);
-	int count = 1;
-	while (p_comma(str)) 
+	int count = 0, maxcount = PARSE_INITIAL_COUNT;
+	Period **periods = palloc(sizeof(Period *) * maxcount);
+	do
 	{
-		count++;
-		period_parse(str, false);
-	}
+		if (count == maxcount)
+		{
+			maxcount *= 2;
+			periods = repalloc(periods, sizeof(Period *) * maxcount);
+		}
+		periods[count++] = period_parse(str, true);
+	} while (p_comma(str));
 	if (!p_cbrace(str))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse period set")));
 
-	/* Second parsing */
-	*str = bak;
-	Period **periods = palloc(sizeof(Period *) * count);
-	for (int i = 0; i < count; i++) 
-	{
-		p_comma(str);
-		periods[i] = period_parse(str, true);
-	}
-	p_cbrace(str);
 	PeriodSet *result = periodset_from_periodarr_internal(periods, count, true);
 
 	for (int i = 0; i < count; i++)
@@ -428,6 +538,33 @@ temporalinst_parse(char **str, Oid basetype, bool end, bool make)
 	return temporalinst_make(elem, t, basetype);
 }
 
+/* Parse a comma-separated list of instants and return their number in
+ * count. When make is false the instants are only validated and NULL is
+ * returned. */
+static TemporalInst **
+temporalinstarr_parse(char **str, Oid basetype, bool make, int *count)
+{
+	int maxcount = make ? PARSE_INITIAL_COUNT : 0;
+	TemporalInst **result = make ? 
+		palloc(sizeof(TemporalInst *) * maxcount) : NULL;
+	*count = 0;
+	do
+	{
+		TemporalInst *inst = temporalinst_parse(str, basetype, false, make);
+		if (make)
+		{
+			if (*count == maxcount)
+			{
+				maxcount *= 2;
+				result = repalloc(result, sizeof(TemporalInst *) * maxcount);
+			}
+			result[*count] = inst;
+		}
+		(*count)++;
+	} while (p_comma(str));
+	return result;
+}
+
 /* Arguments:
  * str: input string
  * basetype: Oid of the base type */
@@ -439,15 +576,9 @@ temporali_parse(char **str, Oid basetype)
 	 * to call this function in the dispatch function temporal_parse */
 	p_obrace(str);
 
-	/* First parsing */
-	char *bak = *str;
-	temporalinst_parse(str, basetype, false, false);
-	int count = 1;
-	while (p_comma(str)) 
-	{
-		count++;
-		temporalinst_parse(str, basetype, false, false);
-	}
+	int count;
+	TemporalInst **instants = temporalinstarr_parse(str, basetype, true, 
+		&count);
 	if (!p_cbrace(str))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse temporal value")));
@@ -457,15 +588,6 @@ temporali_parse(char **str, Oid basetype)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse temporal value")));
 
-	/* Second parsing */
-	*str = bak;
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
-	for (int i = 0; i < count; i++) 
-	{
-		p_comma(str);
-		instants[i] = temporalinst_parse(str, basetype, false, true);
-	}
-	p_cbrace(str);
 	TemporalI *result = temporali_from_temporalinstarr(instants, count);
 
 	for (int i = 0; i < count; i++)
@@ -494,15 +616,9 @@ temporalseq_parse(char **str, Oid basetype, bool linear, bool end, bool make)
 	else if (p_oparen(str))
 		lower_inc = false;
 
-	/* First parsing */
-	char *bak = *str;
-	temporalinst_parse(str, basetype, false, false);
-	int count = 1;
-	while (p_comma(str)) 
-	{
-		count++;
-		temporalinst_parse(str, basetype, false, false);
-	}
+	int count;
+	TemporalInst **instants = temporalinstarr_parse(str, basetype, make, 
+		&count);
 	if (p_cbracket(str))
 		upper_inc = true;
 	else if (p_cparen(str))
@@ -518,17 +634,6 @@ temporalseq_parse(char **str, Oid basetype, bool linear, bool end, bool make)
 			ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 				errmsg("Could not parse temporal value")));
 	}
-	/* Second parsing */
-	*str = bak; 
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
-	for (int i = 0; i < count; i++) 
-	{
-		p_comma(str);
-		instants[i] = temporalinst_parse(str, basetype, false, true);
-	}
-	p_cbracket(str);
-	p_cparen(str);
-
 	if (! make)
 		return NULL;
 
@@ -554,15 +659,18 @@ temporals_parse(char **str, Oid basetype, bool linear)
 	 * to call this function in the dispatch function temporal_parse */
 	p_obrace(str);
 
-	/* First parsing */
-	char *bak = *str;
-	temporalseq_parse(str, basetype, linear, false, false);
-	int count = 1;
-	while (p_comma(str)) 
+	int count = 0, maxcount = PARSE_INITIAL_COUNT;
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * maxcount);
+	do
 	{
-		count++;
-		temporalseq_parse(str, basetype, linear, false, false);
-	}
+		if (count == maxcount)
+		{
+			maxcount *= 2;
+			sequences = repalloc(sequences, sizeof(TemporalSeq *) * maxcount);
+		}
+		sequences[count++] = temporalseq_parse(str, basetype, linear, false, 
+			true);
+	} while (p_comma(str));
 	if (!p_cbrace(str))
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse temporal value")));
@@ -572,15 +680,6 @@ temporals_parse(char **str, Oid basetype, bool linear)
 		ereport(ERROR, (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION), 
 			errmsg("Could not parse temporal value")));
 
-	/* Second parsing */
-	*str = bak;
-	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * count);
-	for (int i = 0; i < count; i++) 
-	{
-		p_comma(str);
-		sequences[i] = temporalseq_parse(str, basetype, linear, false, true);
-	}
-	p_cbrace(str);
 	TemporalS *result = temporals_from_temporalseqarr(sequences, count,
 		linear, true);
 
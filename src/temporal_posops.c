@@ -922,3 +922,68 @@ overafter_tnumber_tnumber(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+/* Temporal <-> time */
+
+/*
+ * Distance in seconds between the time of a temporal value and a timestamp
+ * or a period, which is zero when the temporal value is defined at some
+ * instant of the time value
+ */
+
+PG_FUNCTION_INFO_V1(distance_temporal_timestamp);
+
+PGDLLEXPORT Datum
+distance_temporal_timestamp(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+	PeriodSet *ps = temporal_get_time_internal(temp);
+	double result = distance_periodset_timestamp_internal(ps, t);
+	pfree(ps);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestamp_temporal);
+
+PGDLLEXPORT Datum
+distance_timestamp_temporal(PG_FUNCTION_ARGS)
+{
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+	Temporal *temp = PG_GETARG_TEMPORAL(1);
+	PeriodSet *ps = temporal_get_time_internal(temp);
+	double result = distance_periodset_timestamp_internal(ps, t);
+	pfree(ps);
+	PG_FREE_IF_COPY(temp, 1);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_temporal_period);
+
+PGDLLEXPORT Datum
+distance_temporal_period(PG_FUNCTION_ARGS)
+{
+	Temporal *temp = PG_GETARG_TEMPORAL(0);
+	Period *p = PG_GETARG_PERIOD(1);
+	PeriodSet *ps = temporal_get_time_internal(temp);
+	double result = distance_periodset_period_internal(ps, p);
+	pfree(ps);
+	PG_FREE_IF_COPY(temp, 0);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_temporal);
+
+PGDLLEXPORT Datum
+distance_period_temporal(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(0);
+	Temporal *temp = PG_GETARG_TEMPORAL(1);
+	PeriodSet *ps = temporal_get_time_internal(temp);
+	double result = distance_periodset_period_internal(ps, p);
+	pfree(ps);
+	PG_FREE_IF_COPY(temp, 1);
+	PG_RETURN_FLOAT8(result);
+}
+
+/*****************************************************************************/
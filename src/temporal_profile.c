@@ -0,0 +1,294 @@
+/*****************************************************************************
+ *
+ * temporal_profile.c
+ *	  Per-backend timing of the calls to external functions
+ *
+ * The performance counters of temporal_stats.c tell how often the extension
+ * leaves its own code, but not how long it waits for the callee. When the
+ * extension is compiled with WITH_PROFILE and mobilitydb.profile is enabled,
+ * the calls through call_functionN, e.g., to PostGIS and GEOS, the
+ * detoasting of the temporal arguments, and the splices into the skiplists
+ * of the aggregates are timed and accumulated per function name. While such
+ * a call is in progress, the backend reports the wait event Extension in
+ * pg_stat_activity. The times are inclusive, i.e., the time of a call made
+ * while another one is timed is also counted in the outer one.
+ *
+ * The times are kept in backend-local memory and are returned by
+ * mobilitydb_profile(). When mobilitydb.profile_notice is also enabled, the
+ * times of each top-level query are reported as notices at the end of its
+ * execution, next to the plan logged by auto_explain if it is loaded.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_profile.h"
+
+#include <access/htup_details.h>
+#include <access/xact.h>
+#include <executor/executor.h>
+#include <funcapi.h>
+#include <pgstat.h>
+#include <utils/builtins.h>
+#include <utils/guc.h>
+#include <utils/hsearch.h>
+#include <utils/memutils.h>
+
+bool profile_enabled = false;
+bool profile_notice = false;
+
+#ifdef WITH_PROFILE
+
+/* Time accumulated for a function name since the last reset */
+typedef struct
+{
+	char		name[NAMEDATALEN];	/* Hash key */
+	int64		calls;				/* Calls since the last reset */
+	instr_time	total;				/* Time of these calls */
+	int64		query_calls;		/* Calls of the current top-level query */
+	instr_time	query_total;		/* Time of these calls */
+} ProfileEntry;
+
+static HTAB *profile_entries = NULL;
+
+/* Number of executors running, the top-level query being the first one */
+static int profile_depth = 0;
+
+static ExecutorStart_hook_type prev_ExecutorStart = NULL;
+static ExecutorEnd_hook_type prev_ExecutorEnd = NULL;
+
+static ProfileEntry *
+profile_entry(const char *name)
+{
+	if (profile_entries == NULL)
+	{
+		HASHCTL ctl;
+		memset(&ctl, 0, sizeof(ctl));
+		ctl.keysize = NAMEDATALEN;
+		ctl.entrysize = sizeof(ProfileEntry);
+		ctl.hcxt = TopMemoryContext;
+		profile_entries = hash_create("MobilityDB profile", 64, &ctl,
+			HASH_ELEM | HASH_CONTEXT);
+	}
+	bool found;
+	ProfileEntry *entry = (ProfileEntry *) hash_search(profile_entries, name,
+		HASH_ENTER, &found);
+	if (! found)
+	{
+		entry->calls = entry->query_calls = 0;
+		INSTR_TIME_SET_ZERO(entry->total);
+		INSTR_TIME_SET_ZERO(entry->query_total);
+	}
+	return entry;
+}
+
+/*
+ * Zero the times of the current query when a top-level query starts and
+ * report them when it ends. An error leaves the counter of the running
+ * executors as it is, it is reset at the end of the transaction.
+ */
+static void
+profile_ExecutorStart(QueryDesc *queryDesc, int eflags)
+{
+	if (profile_depth == 0 && profile_entries != NULL)
+	{
+		HASH_SEQ_STATUS status;
+		ProfileEntry *entry;
+		hash_seq_init(&status, profile_entries);
+		while ((entry = (ProfileEntry *) hash_seq_search(&status)) != NULL)
+		{
+			entry->query_calls = 0;
+			INSTR_TIME_SET_ZERO(entry->query_total);
+		}
+	}
+	if (prev_ExecutorStart)
+		prev_ExecutorStart(queryDesc, eflags);
+	else
+		standard_ExecutorStart(queryDesc, eflags);
+	profile_depth++;
+}
+
+static void
+profile_ExecutorEnd(QueryDesc *queryDesc)
+{
+	if (profile_depth > 0)
+		profile_depth--;
+	if (profile_depth == 0 && profile_notice && profile_entries != NULL)
+	{
+		HASH_SEQ_STATUS status;
+		ProfileEntry *entry;
+		hash_seq_init(&status, profile_entries);
+		while ((entry = (ProfileEntry *) hash_seq_search(&status)) != NULL)
+		{
+			if (entry->query_calls == 0)
+				continue;
+			ereport(NOTICE,
+				(errmsg("mobilitydb profile: %s: " INT64_FORMAT " calls, %.3f ms",
+					entry->name, entry->query_calls,
+					INSTR_TIME_GET_MILLISEC(entry->query_total))));
+		}
+	}
+	if (prev_ExecutorEnd)
+		prev_ExecutorEnd(queryDesc);
+	else
+		standard_ExecutorEnd(queryDesc);
+}
+
+static void
+profile_xact_callback(XactEvent event, void *arg)
+{
+	if (event == XACT_EVENT_ABORT || event == XACT_EVENT_PARALLEL_ABORT)
+		profile_depth = 0;
+}
+
+static int
+profile_entry_cmp(const void *a, const void *b)
+{
+	double ta = INSTR_TIME_GET_DOUBLE(((const ProfileEntry *) a)->total);
+	double tb = INSTR_TIME_GET_DOUBLE(((const ProfileEntry *) b)->total);
+	return (ta < tb) ? 1 : ((ta > tb) ? -1 : 0);
+}
+
+#endif /* WITH_PROFILE */
+
+/*****************************************************************************/
+
+/**
+ * @brief Start timing a call and report the wait event Extension
+ */
+void
+profile_begin(instr_time *start)
+{
+	INSTR_TIME_SET_CURRENT(*start);
+	pgstat_report_wait_start(PG_WAIT_EXTENSION);
+}
+
+/**
+ * @brief Add the time elapsed since the start of a call to the given name
+ */
+void
+profile_end(const char *name, instr_time *start)
+{
+	instr_time end;
+	INSTR_TIME_SET_CURRENT(end);
+	pgstat_report_wait_end();
+#ifdef WITH_PROFILE
+	ProfileEntry *entry = profile_entry(name);
+	entry->calls++;
+	INSTR_TIME_ACCUM_DIFF(entry->total, end, *start);
+	entry->query_calls++;
+	INSTR_TIME_ACCUM_DIFF(entry->query_total, end, *start);
+#endif
+}
+
+/*
+ * Define the settings of the profile and install the hooks reporting the
+ * times of the queries. Called when loading the extension.
+ */
+void
+temporal_profile_init(void)
+{
+	DefineCustomBoolVariable("mobilitydb.profile",
+		"Measure the time spent in the calls to external functions.",
+		"The calls to PostGIS and GEOS, the detoasting of the temporal "
+		"arguments, and the splices into the skiplists of the aggregates are "
+		"timed per function name. The times are only measured when the "
+		"extension is built with WITH_PROFILE.",
+		&profile_enabled, false, PGC_USERSET, 0, NULL, NULL, NULL);
+	DefineCustomBoolVariable("mobilitydb.profile_notice",
+		"Report the profile of each top-level query as notices.",
+		"The notices are raised at the end of the execution of the query, "
+		"e.g., next to the plan logged by auto_explain.",
+		&profile_notice, false, PGC_USERSET, 0, NULL, NULL, NULL);
+#ifdef WITH_PROFILE
+	prev_ExecutorStart = ExecutorStart_hook;
+	ExecutorStart_hook = profile_ExecutorStart;
+	prev_ExecutorEnd = ExecutorEnd_hook;
+	ExecutorEnd_hook = profile_ExecutorEnd;
+	RegisterXactCallback(profile_xact_callback, NULL);
+#endif
+}
+
+/*****************************************************************************/
+
+PG_FUNCTION_INFO_V1(mobilitydb_profile);
+/**
+ * @brief Returns the times of the current backend as (name, calls,
+ * total_time) rows, where the time is in milliseconds, the most expensive
+ * functions first
+ */
+PGDLLEXPORT Datum
+mobilitydb_profile(PG_FUNCTION_ARGS)
+{
+#ifdef WITH_PROFILE
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext =
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		/* Take a snapshot so that the rows are consistent with each other */
+		long count = profile_entries ? hash_get_num_entries(profile_entries) : 0;
+		ProfileEntry *snapshot = palloc(sizeof(ProfileEntry) * Max(count, 1));
+		if (count > 0)
+		{
+			HASH_SEQ_STATUS status;
+			ProfileEntry *entry;
+			int i = 0;
+			hash_seq_init(&status, profile_entries);
+			while ((entry = (ProfileEntry *) hash_seq_search(&status)) != NULL)
+				snapshot[i++] = *entry;
+			qsort(snapshot, count, sizeof(ProfileEntry), profile_entry_cmp);
+		}
+		funcctx->user_fctx = snapshot;
+		funcctx->max_calls = count;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	if (funcctx->call_cntr == funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	ProfileEntry *entry = (ProfileEntry *) funcctx->user_fctx +
+		funcctx->call_cntr;
+	Datum values[3];
+	bool nulls[3] = {false, false, false};
+	values[0] = CStringGetTextDatum(entry->name);
+	values[1] = Int64GetDatum(entry->calls);
+	values[2] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(entry->total));
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+#else
+	ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		errmsg("MobilityDB was compiled without profiling"),
+		errhint("Rebuild the extension with the option WITH_PROFILE.")));
+	PG_RETURN_NULL();
+#endif
+}
+
+PG_FUNCTION_INFO_V1(mobilitydb_profile_reset);
+/**
+ * @brief Resets the times of the current backend
+ */
+PGDLLEXPORT Datum
+mobilitydb_profile_reset(PG_FUNCTION_ARGS)
+{
+#ifdef WITH_PROFILE
+	if (profile_entries != NULL)
+	{
+		hash_destroy(profile_entries);
+		profile_entries = NULL;
+	}
+#endif
+	PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
@@ -50,6 +50,8 @@
 #include "time_selfuncs.h"
 #include "rangetypes_ext.h"
 #include "temporal_analyze.h"
+#include "temporal_util.h"
+#include "tnumber_selfuncs.h"
 #include "tpoint.h"
 
 /*****************************************************************************
@@ -1407,12 +1409,240 @@ temporal_sel(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8(selec);
 }
 
+/*
+ * Compute the join selectivity of the time dimension of two columns whose
+ * statistics contain histograms of period bounds, that is, columns of time
+ * types or of temporal types of durations distinct from TemporalInst.
+ * Returns -1 if the selectivity cannot be estimated from the statistics.
+ */
+Selectivity
+temporals_joinsel(VariableStatData *vardata1, VariableStatData *vardata2,
+	CachedOp cachedOp)
+{
+	/* The statistics of TemporalInst columns do not contain periods */
+	if (TYPMOD_GET_DURATION(vardata1->atttypmod) == TEMPORALINST ||
+		TYPMOD_GET_DURATION(vardata2->atttypmod) == TEMPORALINST)
+		return -1.0;
+
+	if (cachedOp == OVERLAPS_OP || cachedOp == CONTAINS_OP ||
+		cachedOp == CONTAINED_OP || cachedOp == BEFORE_OP ||
+		cachedOp == AFTER_OP || cachedOp == OVERBEFORE_OP || 
+		cachedOp == OVERAFTER_OP) 
+		return calc_period_hist_joinsel(vardata1, vardata2, cachedOp);
+
+	return -1.0;
+}
+
+/*
+ * Estimate the join selectivity value of the operators for temporal types 
+ * whose bounding box is a Period, that is, tbool and ttext.
+ */
 PG_FUNCTION_INFO_V1(temporal_joinsel);
 
 PGDLLEXPORT Datum
 temporal_joinsel(PG_FUNCTION_ARGS)
 {
-	PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+	PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+	Oid operator = PG_GETARG_OID(1);
+	List *args = (List *) PG_GETARG_POINTER(2);
+	SpecialJoinInfo *sjinfo = (SpecialJoinInfo *) PG_GETARG_POINTER(4);
+	VariableStatData vardata1, vardata2;
+	bool join_is_reversed;
+	Selectivity selec;
+	CachedOp cachedOp;
+
+	/*
+	 * Get enumeration value associated to the operator
+	 */
+	bool found = temporal_cachedop(operator, &cachedOp);
+	/* In the case of unknown operator */
+	if (!found)
+		PG_RETURN_FLOAT8(DEFAULT_TEMP_SELECTIVITY);
+
+	get_join_variables(root, args, sjinfo, &vardata1, &vardata2,
+		&join_is_reversed);
+
+	/* Ensure that the first variable is the left argument of the operator */
+	if (join_is_reversed)
+		selec = temporals_joinsel(&vardata2, &vardata1, cachedOp);
+	else
+		selec = temporals_joinsel(&vardata1, &vardata2, cachedOp);
+
+	ReleaseVariableStats(vardata1);
+	ReleaseVariableStats(vardata2);
+
+	/* Use default selectivity if the statistics are not available */
+	if (selec < 0.0)
+		PG_RETURN_FLOAT8(default_temporal_selectivity(cachedOp));
+
+	CLAMP_PROBABILITY(selec);
+	PG_RETURN_FLOAT8(selec);
+}
+
+/*****************************************************************************
+ * Selectivity of the ever and always equal operators
+ * The temporal value ever takes a base value if the value belongs to its
+ * value set, and always takes it if its value set is a singleton containing 
+ * the value. For TemporalInst columns both operators are the equality of
+ * the base values and the most common values of the value dimension are
+ * used. For other durations the selectivity is estimated from the most 
+ * common values of the value sets for tbool and ttext, and from the histogram
+ * of the value ranges for tint and tfloat.
+ *****************************************************************************/
+
+/*
+ * Selectivity of the ever (or always) equal operator from the most common
+ * values of the value sets of the column. Returns -1 if these statistics are
+ * not available.
+ */
+static Selectivity
+value_mcelem_selectivity(VariableStatData *vardata, Oid valuetypid,
+	Datum value, bool ever)
+{
+	AttStatsSlot sslot;
+	Selectivity selec;
+	int i;
+
+	if (!(HeapTupleIsValid(vardata->statsTuple) &&
+		  get_attstatsslot(&sslot, vardata->statsTuple,
+			STATISTIC_KIND_VALUE_MCELEM, InvalidOid,
+			ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS)))
+		return -1.0;
+
+	/* The values not in the list are at most as frequent as the last one */
+	selec = sslot.numbers[sslot.nvalues] / 2.0;
+	for (i = 0; i < sslot.nvalues; i++)
+	{
+		if (datum_eq(sslot.values[i], value, valuetypid))
+		{
+			selec = sslot.numbers[i];
+			break;
+		}
+	}
+	/* Assume that taking a single base value is independent of the value */
+	if (! ever)
+		selec *= sslot.numbers[sslot.nvalues + 1];
+	free_attstatsslot(&sslot);
+	return selec;
+}
+
+/*
+ * Selectivity of the ever (or always) equal operator
+ */
+static Selectivity
+temporal_ever_eq_sel(PlannerInfo *root, VariableStatData *vardata,
+	Datum value, bool ever)
+{
+	Oid valuetypid = base_oid_from_temporal(vardata->vartype);
+	int16 duration = TYPMOD_GET_DURATION(vardata->atttypmod);
+	ensure_valid_duration_all(duration);
+
+	if (duration == TEMPORALINST)
+	{
+		TypeCacheEntry *typentry = lookup_type_cache(valuetypid, 
+			TYPECACHE_EQ_OPR);
+		return var_eq_const(vardata, typentry->eq_opr, value, false, true,
+			false);
+	}
+
+	Selectivity selec = value_mcelem_selectivity(vardata, valuetypid, value, 
+		ever);
+	if (selec >= 0.0)
+		return selec;
+
+	if (valuetypid == INT4OID || valuetypid == FLOAT8OID)
+	{
+		/* The value range of the temporal value contains the value (ever)
+		 * or is contained in the value (always) */
+		TBOX box;
+		memset(&box, 0, sizeof(TBOX));
+		box.xmin = box.xmax = datum_double(value, valuetypid);
+		MOBDB_FLAGS_SET_X(box.flags, true);
+		return tnumbers_sel(root, vardata, &box, 
+			ever ? CONTAINS_OP : CONTAINED_OP, valuetypid);
+	}
+	return DEFAULT_EQ_SEL;
+}
+
+/*
+ * Estimate the selectivity of the ever and always equal and not equal
+ * operators, that is, ?=, %=, ?<>, and %<>. The not equal operators are the 
+ * negators of the equal ones: ever not equal is the negation of always equal
+ * and always not equal is the negation of ever equal.
+ */
+PG_FUNCTION_INFO_V1(temporal_ever_sel);
+
+PGDLLEXPORT Datum
+temporal_ever_sel(PG_FUNCTION_ARGS)
+{
+	PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+	Oid operator = PG_GETARG_OID(1);
+	List *args = (List *) PG_GETARG_POINTER(2);
+	int varRelid = PG_GETARG_INT32(3);
+	VariableStatData vardata;
+	Node *other;
+	bool varonleft, ever, negate;
+	Selectivity selec;
+
+	char *opname = get_opname(operator);
+	if (opname == NULL)
+		PG_RETURN_FLOAT8(DEFAULT_EQ_SEL);
+	if (strcmp(opname, "?=") == 0)
+	{
+		ever = true; negate = false;
+	}
+	else if (strcmp(opname, "%=") == 0)
+	{
+		ever = false; negate = false;
+	}
+	else if (strcmp(opname, "?<>") == 0)
+	{
+		ever = false; negate = true;
+	}
+	else if (strcmp(opname, "%<>") == 0)
+	{
+		ever = true; negate = true;
+	}
+	else
+		PG_RETURN_FLOAT8(DEFAULT_EQ_SEL);
+	pfree(opname);
+
+	/*
+	 * If expression is not (variable op constant) with the temporal variable
+	 * on the left, then punt and return a default estimate.
+	 */
+	if (!get_restriction_variable(root, args, varRelid,
+								  &vardata, &other, &varonleft))
+		PG_RETURN_FLOAT8(negate ? 1.0 - DEFAULT_EQ_SEL : DEFAULT_EQ_SEL);
+	if (!varonleft || !IsA(other, Const) || 
+		!temporal_type_oid(vardata.vartype))
+	{
+		ReleaseVariableStats(vardata);
+		PG_RETURN_FLOAT8(negate ? 1.0 - DEFAULT_EQ_SEL : DEFAULT_EQ_SEL);
+	}
+
+	/* The operators are strict */
+	if (((Const *) other)->constisnull)
+	{
+		ReleaseVariableStats(vardata);
+		PG_RETURN_FLOAT8(0.0);
+	}
+
+	selec = temporal_ever_eq_sel(root, &vardata, 
+		((Const *) other)->constvalue, ever);
+	CLAMP_PROBABILITY(selec);
+	if (negate)
+	{
+		/* Do not count the null values, as done by PostgreSQL in eqsel */
+		double nullfrac = 0.0;
+		if (HeapTupleIsValid(vardata.statsTuple))
+			nullfrac = ((Form_pg_statistic) 
+				GETSTRUCT(vardata.statsTuple))->stanullfrac;
+		selec = 1.0 - selec - nullfrac;
+	}
+	ReleaseVariableStats(vardata);
+	CLAMP_PROBABILITY(selec);
+	PG_RETURN_FLOAT8(selec);
 }
 
 /*****************************************************************************/
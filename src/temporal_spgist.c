@@ -20,6 +20,7 @@
 #include "oidcache.h"
 #include "period.h"
 #include "time_gist.h"
+#include "temporal_gist.h"
 #include "time_spgist.h"
 #include "temporaltypes.h"
 
@@ -32,6 +33,7 @@ PG_FUNCTION_INFO_V1(spgist_temporal_inner_consistent);
 PGDLLEXPORT Datum
 spgist_temporal_inner_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
 	spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
 	int	which, i;
@@ -88,8 +90,8 @@ spgist_temporal_inner_consistent(PG_FUNCTION_ARGS)
 		else if (temporal_type_oid(subtype))
 		{
 			period = palloc(sizeof(Period));
-			temporal_bbox(period,
-				DatumGetTemporal(in->scankeys[i].sk_argument));
+			index_query_box(fcinfo->flinfo, in->scankeys[i].sk_argument, 
+				subtype, &temporal_query_box, sizeof(Period), period);
 			mustfree = true;
 		}
 		else
@@ -278,6 +280,7 @@ PG_FUNCTION_INFO_V1(spgist_temporal_leaf_consistent);
 PGDLLEXPORT Datum
 spgist_temporal_leaf_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgLeafConsistentIn *in = (spgLeafConsistentIn *) PG_GETARG_POINTER(0);
 	spgLeafConsistentOut *out = (spgLeafConsistentOut *) PG_GETARG_POINTER(1);
 	Period 	   *key = DatumGetPeriod(in->leafDatum);
@@ -305,10 +308,10 @@ spgist_temporal_leaf_consistent(PG_FUNCTION_ARGS)
 		else if (temporal_type_oid(subtype))
 		{
 			Period period;
-			temporal_bbox(&period,
-				DatumGetTemporal(in->scankeys[i].sk_argument));
+			index_query_box(fcinfo->flinfo, in->scankeys[i].sk_argument, 
+				subtype, &temporal_query_box, sizeof(Period), &period);
 			res = index_leaf_consistent_time(key, &period, strategy);
-	}
+		}
 		else
 			elog(ERROR, "Unrecognized strategy number: %d", strategy);
 
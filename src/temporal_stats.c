@@ -0,0 +1,112 @@
+/*****************************************************************************
+ *
+ * temporal_stats.c
+ *	  Per-backend performance counters
+ *
+ * The counters are incremented in the hot paths of the extension, that is,
+ * the lifting functions, the detoasting of the temporal arguments, the 
+ * construction of temporal values, the calls to external functions such as 
+ * those of PostGIS, the temporal aggregates, and the consistent functions 
+ * of the indexes. They are kept in backend-local memory and thus only 
+ * report the work done by the current session.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+#include "temporal_stats.h"
+
+#include <access/htup_details.h>
+#include <funcapi.h>
+#include <utils/builtins.h>
+
+#ifdef WITH_STATS
+
+uint64 mobility_stats[STAT_COUNT];
+
+static const char *mobility_stat_names[STAT_COUNT] =
+{
+	"lifted_calls",
+	"lifted_instants",
+	"sync_calls",
+	"detoasted_values",
+	"detoasted_bytes",
+	"constructed_bytes",
+	"function_callouts",
+	"spatialrel_calls",
+	"skiplist_splices",
+	"skiplist_spills",
+	"index_consistent_calls",
+	"detoast_cache_hits",
+	"shared_cache_hits",
+	"index_query_cache_hits",
+	"expanded_reused"
+};
+
+#endif
+
+/*****************************************************************************/
+
+PG_FUNCTION_INFO_V1(mobilitydb_stats);
+/**
+ * @brief Returns the counters of the current backend as (name, value) rows
+ */
+PGDLLEXPORT Datum
+mobilitydb_stats(PG_FUNCTION_ARGS)
+{
+#ifdef WITH_STATS
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext = 
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		/* Take a snapshot so that the rows are consistent with each other */
+		uint64 *snapshot = palloc(sizeof(mobility_stats));
+		memcpy(snapshot, mobility_stats, sizeof(mobility_stats));
+		funcctx->user_fctx = snapshot;
+		funcctx->max_calls = STAT_COUNT;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	if (funcctx->call_cntr == funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	uint64 *snapshot = (uint64 *) funcctx->user_fctx;
+	Datum values[2];
+	bool nulls[2] = {false, false};
+	values[0] = CStringGetTextDatum(mobility_stat_names[funcctx->call_cntr]);
+	values[1] = Int64GetDatum((int64) snapshot[funcctx->call_cntr]);
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+#else
+	ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		errmsg("MobilityDB was compiled without performance counters"),
+		errhint("Rebuild the extension with the option WITH_STATS.")));
+	PG_RETURN_NULL();
+#endif
+}
+
+PG_FUNCTION_INFO_V1(mobilitydb_stats_reset);
+/**
+ * @brief Resets the counters of the current backend
+ */
+PGDLLEXPORT Datum
+mobilitydb_stats_reset(PG_FUNCTION_ARGS)
+{
+#ifdef WITH_STATS
+	memset(mobility_stats, 0, sizeof(mobility_stats));
+#endif
+	PG_RETURN_VOID();
+}
+
+/*****************************************************************************/
@@ -13,20 +13,32 @@
 #include "temporal_util.h"
 
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <access/hash.h>
 #include <catalog/pg_collation.h>
+#include <lib/hyperloglog.h>
 #include <utils/builtins.h>
+#include <utils/guc.h>
 #include <utils/lsyscache.h>
 #include <utils/timestamp.h>
 #include <utils/varlena.h>
 
 #include "period.h"
 #include "temporal.h"
+#include "temporalseq.h"
 #include "oidcache.h"
 #include "doublen.h"
+#include "temporal_analyze.h"
+#include "temporal_compress.h"
+#include "temporal_parallel.h"
+#include "temporal_profile.h"
 
 #ifdef WITH_POSTGIS
 #include "tpoint.h"
 #include "tpoint_spatialfuncs.h"
+#include "tpoint_distance.h"
+#include "tpoint_gist.h"
 #endif
 
 #ifdef PG_MODULE_MAGIC
@@ -45,6 +57,63 @@ _PG_init(void)
 	/* elog(WARNING, "This is MobilityDB."); */
 #ifdef WITH_POSTGIS
 	temporalgeom_init();
+#endif
+	temporal_cache_init();
+	temporal_profile_init();
+	DefineCustomBoolVariable("mobilitydb.precompute_trajectory",
+		"Store the trajectory of temporal point sequences.",
+		"When disabled, the trajectory is computed when it is needed.",
+		&precompute_trajectory, true, PGC_USERSET, 0, NULL, NULL, NULL);
+	DefineCustomIntVariable("mobilitydb.analyze_detoast_limit",
+		"Maximum amount of data fetched from the sampled temporal values by ANALYZE.",
+		"When the limit is reached, the statistics of the column are computed "
+		"with the values read so far. The value -1 disables the limit.",
+		&analyze_detoast_limit, -1, -1, MAX_KILOBYTES, PGC_USERSET, 
+		GUC_UNIT_KB, NULL, NULL, NULL);
+	DefineCustomIntVariable("mobilitydb.summary_min_count",
+		"Minimum number of instants of the temporal number sequences that "
+		"store a block summary.",
+		"The summary speeds up the integral and the time-weighted average "
+		"over a period. The value 0 disables the summaries.",
+		&summary_min_count, 256, 0, INT_MAX, PGC_USERSET, 0, 
+		NULL, NULL, NULL);
+	DefineCustomIntVariable("mobilitydb.max_threads",
+		"Maximum number of threads running the numeric kernels of a query.",
+		"The backend is one of the threads, and thus the value 1 does not "
+		"start any thread. The threads are only available when the "
+		"extension is built with WITH_THREADS.",
+		&parallel_max_threads, 1, 1, PARALLEL_MAX_THREADS, PGC_USERSET, 0,
+		NULL, NULL, NULL);
+#ifdef WITH_POSTGIS
+	DefineCustomBoolVariable("mobilitydb.geodetic_fast_path",
+		"Compute the distances of temporal geography points on the sphere.",
+		"When enabled, the distances and lengths are computed on the sphere "
+		"instead of on the spheroid, with a relative error below 0.6%. The "
+		"dwithin functions use the spheroid when the spherical distance is "
+		"within this error of the threshold. The points of the segments are "
+		"interpolated and located on great circles of the sphere.",
+		&geodetic_fast_path, false, PGC_USERSET, 0, NULL, NULL, NULL);
+	DefineCustomRealVariable("mobilitydb.index_time_weight",
+		"Weight of the time dimension in the GiST indexes of temporal points.",
+		"The extent of the time dimension of the boxes is raised to this "
+		"power when computing the penalty and choosing the split axis. "
+		"The value 0 ignores the time dimension.",
+		&index_time_weight, 1.0, 0.0, 100.0, PGC_USERSET, 0,
+		NULL, NULL, NULL);
+	DefineCustomIntVariable("mobilitydb.index_time_unit",
+		"Unit of the time dimension in the GiST indexes of temporal points.",
+		"The extent of the time dimension of the boxes is expressed in this "
+		"unit before being compared with the spatial dimensions. The value 0 "
+		"uses microseconds.",
+		&index_time_unit, 0, 0, INT_MAX, PGC_USERSET, GUC_UNIT_S,
+		NULL, NULL, NULL);
+	DefineCustomBoolVariable("mobilitydb.index_use_z",
+		"Take the Z dimension into account when building the indexes of "
+		"temporal points.",
+		"When disabled, the GiST and the SP-GiST kd-tree indexes organize "
+		"the boxes only by their X, Y, and T dimensions. The keys keep "
+		"the Z dimension and thus the queries are not affected.",
+		&index_use_z, true, PGC_USERSET, 0, NULL, NULL, NULL);
 #endif
 }
 
@@ -209,10 +278,15 @@ call_recv(Oid type, StringInfo buf)
 	return ReceiveFunctionCall(&recvfuncinfo, buf, basetype, -1);
 }
 
-/* Call PostgreSQL function with 1 to 4 arguments */
+/*
+ * Call PostgreSQL function with 1 to 4 arguments. The functions are called
+ * through the macros call_function1 to call_function4, which pass the name
+ * of the callee to the profile.
+ */
 
 Datum
-call_function1(PGFunction func, Datum arg1)
+call_function1_named(const char *name, PGFunction func,
+	Datum arg1)
 {
 	FunctionCallInfoData fcinfo;
 	FmgrInfo flinfo;
@@ -222,14 +296,18 @@ call_function1(PGFunction func, Datum arg1)
 	InitFunctionCallInfoData(fcinfo, &flinfo, 1, DEFAULT_COLLATION_OID, NULL, NULL);
 	fcinfo.arg[0] = arg1;
 	fcinfo.argnull[0] = false;
+	MOBDB_STAT_INC(STAT_FUNCTION_CALLOUTS);
+	MOBDB_PROFILE_BEGIN(start);
 	result = (*func) (&fcinfo);
+	MOBDB_PROFILE_END(name, start);
 	if (fcinfo.isnull)
 		elog(ERROR, "Function %p returned NULL", (void *) func);
 	return result;
 }
 
 Datum
-call_function2(PGFunction func, Datum arg1, Datum arg2)
+call_function2_named(const char *name, PGFunction func,
+	Datum arg1, Datum arg2)
 {
 	FunctionCallInfoData fcinfo;
 	FmgrInfo flinfo;
@@ -241,14 +319,18 @@ call_function2(PGFunction func, Datum arg1, Datum arg2)
 	fcinfo.argnull[0] = false;
 	fcinfo.arg[1] = arg2;
 	fcinfo.argnull[1] = false;
+	MOBDB_STAT_INC(STAT_FUNCTION_CALLOUTS);
+	MOBDB_PROFILE_BEGIN(start);
 	result = (*func) (&fcinfo);
+	MOBDB_PROFILE_END(name, start);
 	if (fcinfo.isnull)
 		elog(ERROR, "function %p returned NULL", (void *) func);
 	return result;
 }
 
 Datum
-call_function3(PGFunction func, Datum arg1, Datum arg2, Datum arg3)
+call_function3_named(const char *name, PGFunction func,
+	Datum arg1, Datum arg2, Datum arg3)
 {
 	FunctionCallInfoData fcinfo;
 	FmgrInfo flinfo;
@@ -262,14 +344,18 @@ call_function3(PGFunction func, Datum arg1, Datum arg2, Datum arg3)
 	fcinfo.argnull[1] = false;
 	fcinfo.arg[2] = arg3;
 	fcinfo.argnull[2] = false;
+	MOBDB_STAT_INC(STAT_FUNCTION_CALLOUTS);
+	MOBDB_PROFILE_BEGIN(start);
 	result = (*func) (&fcinfo);
+	MOBDB_PROFILE_END(name, start);
 	if (fcinfo.isnull)
 		elog(ERROR, "function %p returned NULL", (void *) func);
 	return result;
 }
 
 Datum
-call_function4(PGFunction func, Datum arg1, Datum arg2, Datum arg3, Datum arg4)
+call_function4_named(const char *name, PGFunction func,
+	Datum arg1, Datum arg2, Datum arg3, Datum arg4)
 {
 	FunctionCallInfoData fcinfo;
 	FmgrInfo flinfo;
@@ -285,7 +371,10 @@ call_function4(PGFunction func, Datum arg1, Datum arg2, Datum arg3, Datum arg4)
 	fcinfo.argnull[2] = false;
 	fcinfo.arg[3] = arg4;
 	fcinfo.argnull[3] = false;
+	MOBDB_STAT_INC(STAT_FUNCTION_CALLOUTS);
+	MOBDB_PROFILE_BEGIN(start);
 	result = (*func) (&fcinfo);
+	MOBDB_PROFILE_END(name, start);
 	if (fcinfo.isnull)
 		elog(ERROR, "function %p returned NULL", (void *) func);
 	return result;
@@ -332,6 +421,9 @@ temporalarr_extract(ArrayType *array, int *count)
 {
 	Temporal **result;
 	deconstruct_array(array, array->elemtype, -1, false, 'd', (Datum **) &result, NULL, count);
+	/* The elements of the array are not decoded by PG_GETARG_TEMPORAL */
+	for (int i = 0; i < *count; i++)
+		result[i] = temporal_uncompressed(result[i]);
 	return result;
 }
 
@@ -491,6 +583,123 @@ temporalseqarr_sort(TemporalSeq **sequences, int count)
 		  (qsort_comparator) &temporalseqarr_sort_cmp);
 }
 
+/*****************************************************************************
+ * Sort support functions
+ * The abbreviated key of a value is the leading component compared by the
+ * B-tree comparison function, e.g., the lower bound of a period, encoded as
+ * an unsigned integer such that the order of the keys is the order of the
+ * components. Abbreviated keys require 8-byte datums.
+ *****************************************************************************/
+
+typedef struct
+{
+	uint64 (*key)(Datum);		/* Abbreviated key of a value */
+	int64 input_count;			/* Number of values seen */
+	bool estimating;			/* Whether the cardinality is still estimated */
+	hyperLogLogState abbr_card;	/* Cardinality estimator of the keys */
+} SortSupportAbbrevState;
+
+static int
+sortsupport_abbrev_cmp(Datum x, Datum y, SortSupport ssup)
+{
+	if (x < y)
+		return -1;
+	if (x > y)
+		return 1;
+	return 0;
+}
+
+static Datum
+sortsupport_abbrev_convert(Datum original, SortSupport ssup)
+{
+	SortSupportAbbrevState *state = (SortSupportAbbrevState *) ssup->ssup_extra;
+	uint64 key = state->key(original);
+	state->input_count++;
+	if (state->estimating)
+	{
+		uint32 tmp = (uint32) key ^ (uint32) (key >> 32);
+		addHyperLogLog(&state->abbr_card, DatumGetUInt32(hash_uint32(tmp)));
+	}
+	return (Datum) key;
+}
+
+/*
+ * Abort the abbreviation if the keys are not distinct enough, using the
+ * same heuristic as the abbreviated keys of the uuid type
+ */
+static bool
+sortsupport_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+	SortSupportAbbrevState *state = (SortSupportAbbrevState *) ssup->ssup_extra;
+	if (memtupcount < 10000 || state->input_count < 10000 ||
+		! state->estimating)
+		return false;
+
+	double abbr_card = estimateHyperLogLog(&state->abbr_card);
+	/* The keys are distinct enough, stop estimating */
+	if (abbr_card > 100000.0)
+	{
+		state->estimating = false;
+		return false;
+	}
+	if (abbr_card < state->input_count / 2000.0 + 0.5)
+		return true;
+	return false;
+}
+
+/*
+ * Set the comparator of the sort support and, when allowed by the caller,
+ * the abbreviated keys computed by the function key
+ */
+void
+sortsupport_abbrev_init(SortSupport ssup,
+	int (*comparator)(Datum, Datum, SortSupport), uint64 (*key)(Datum))
+{
+	ssup->comparator = comparator;
+#if SIZEOF_DATUM == 8
+	if (ssup->abbreviate && key != NULL)
+	{
+		MemoryContext oldcontext = MemoryContextSwitchTo(ssup->ssup_cxt);
+		SortSupportAbbrevState *state = palloc(sizeof(SortSupportAbbrevState));
+		state->key = key;
+		state->input_count = 0;
+		state->estimating = true;
+		initHyperLogLog(&state->abbr_card, 10);
+		MemoryContextSwitchTo(oldcontext);
+		ssup->ssup_extra = state;
+		ssup->comparator = &sortsupport_abbrev_cmp;
+		ssup->abbrev_converter = &sortsupport_abbrev_convert;
+		ssup->abbrev_abort = &sortsupport_abbrev_abort;
+		ssup->abbrev_full_comparator = comparator;
+	}
+#endif
+}
+
+/* Abbreviated key of a timestamp */
+
+uint64
+timestamp_sortkey(TimestampTz t)
+{
+	/* Flip the sign bit to order negative values before positive ones */
+	return ((uint64) t) ^ (UINT64CONST(1) << 63);
+}
+
+/* Abbreviated key of a double */
+
+uint64
+double_sortkey(double d)
+{
+	/* The comparison functions consider -0.0 and 0.0 as equal */
+	if (d == 0.0)
+		d = 0.0;
+	uint64 bits;
+	memcpy(&bits, &d, sizeof(uint64));
+	/* Negative values are ordered in reverse by their bit pattern */
+	if (bits & (UINT64CONST(1) << 63))
+		return ~bits;
+	return bits ^ (UINT64CONST(1) << 63);
+}
+
 /*****************************************************************************
  * Remove duplicate functions
  * These functions assume that the array has been sorted before 
@@ -522,6 +731,32 @@ timestamp_remove_duplicates(TimestampTz *values, int count)
 	return newcount + 1;
 }
 
+/*****************************************************************************
+ * Search functions
+ *****************************************************************************/
+
+/*
+ * Position in [0, n] of a timestamp assuming that n + 1 timestamps are
+ * regularly spaced between lower and upper. It is used as the first probe
+ * of the searches of a timestamp, which is then exact for regularly sampled
+ * values. Integer arithmetic is used when the spacing is an integer number
+ * of microseconds, so that the position is not rounded down when the 
+ * timestamp is one of the regularly spaced timestamps.
+ */
+int
+timestamp_interpolate_pos(TimestampTz lower, TimestampTz upper, int n,
+	TimestampTz t)
+{
+	if (t <= lower || upper <= lower || n <= 0)
+		return 0;
+	if (t >= upper)
+		return n;
+	int64 span = upper - lower;
+	if (span % n == 0)
+		return (int) ((t - lower) / (span / n));
+	return (int) ((double) (t - lower) / (double) span * n);
+}
+
 /*****************************************************************************
  * Text functions
  * Function copied from PostgreSQL since they are not exported
@@ -544,23 +779,105 @@ text_cmp(text *arg1, text *arg2, Oid collid)
 	return varstr_cmp(a1p, len1, a2p, len2, collid);
 }
 
+/*
+ * Binary equality of two texts. Since all collations are deterministic,
+ * two texts are equal if and only if they are bytewise equal, as in the
+ * texteq function of PostgreSQL, and thus no collation-aware comparison 
+ * is needed. The ordering comparisons call varstr_cmp, which compares the
+ * bytes without calling strcoll when the collation is "C".
+ */
+static bool
+datum_text_eq(Datum l, Datum r)
+{
+	if (l == r)
+		return true;
+	text *arg1 = DatumGetTextPP(l);
+	text *arg2 = DatumGetTextPP(r);
+	int len1 = (int) VARSIZE_ANY_EXHDR(arg1);
+	int len2 = (int) VARSIZE_ANY_EXHDR(arg2);
+	return len1 == len2 && memcmp(VARDATA_ANY(arg1), VARDATA_ANY(arg2), 
+		len1) == 0;
+}
+
+/*****************************************************************************
+ * Hash functions on datums
+ * The functions compute the same values as the hash functions of the
+ * PostgreSQL base types without the overhead of calling them through fmgr
+ *****************************************************************************/
+
+/* Hash value of a double, equivalent to hashfloat8 */
+
+uint32
+double_hash(double d)
+{
+	/* -0.0 and 0.0 are equal and must have the same hash */
+	if (d == (double) 0)
+		return 0;
+	/* All NaNs are equal and must have the same hash */
+	if (isnan(d))
+		d = get_float8_nan();
+	return DatumGetUInt32(hash_any((unsigned char *) &d, sizeof(double)));
+}
+
+/* Hash value of a timestamp, equivalent to hashint8 */
+
+uint32
+timestamp_hash(TimestampTz t)
+{
+	uint32 lohalf = (uint32) t;
+	uint32 hihalf = (uint32) (t >> 32);
+	lohalf ^= (t >= 0) ? hihalf : ~hihalf;
+	return DatumGetUInt32(hash_uint32(lohalf));
+}
+
+/*
+ * Hash value of a value of a temporal base type. The hash of a point is
+ * computed from its coordinates.
+ */
+uint32
+datum_hash(Datum value, Oid type)
+{
+	uint32 result = 0;
+	ensure_temporal_base_type(type);
+	if (type == BOOLOID)
+		result = DatumGetUInt32(hash_uint32((int32) DatumGetChar(value)));
+	else if (type == INT4OID)
+		result = DatumGetUInt32(hash_uint32(DatumGetInt32(value)));
+	else if (type == FLOAT8OID)
+		result = double_hash(DatumGetFloat8(value));
+	else if (type == TEXTOID)
+	{
+		text *txt = DatumGetTextPP(value);
+		result = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(txt),
+			VARSIZE_ANY_EXHDR(txt)));
+	}
+#ifdef WITH_POSTGIS
+	else if (type == type_oid(T_GEOMETRY) || type == type_oid(T_GEOGRAPHY))
+		result = datum_point_hash(value);
+#endif
+	return result;
+}
+
 /*****************************************************************************
  * Comparison functions on datums
  *****************************************************************************/
 
 /*
 * Version of the functions where the types of both arguments is equal
+* The base types passed by value are tested first since these functions are
+* called in the inner loops of most functions and the remaining tests 
+* require looking up the Oid cache.
 */
 
 bool
 datum_eq(Datum l, Datum r, Oid type)
 {
+	if (type == BOOLOID || type == INT4OID || type == FLOAT8OID)
+		return l == r;
 	ensure_temporal_base_type_all(type);
 	bool result = false;
-	if (type == BOOLOID || type == INT4OID || type == FLOAT8OID)
-		result = l == r;
-	else if (type == TEXTOID)
-		result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) == 0;
+	if (type == TEXTOID)
+		result = datum_text_eq(l, r);
 	else if (type == type_oid(T_DOUBLE2))
 		result = double2_eq((double2 *)DatumGetPointer(l), (double2 *)DatumGetPointer(r));
 	else if (type == type_oid(T_DOUBLE3))
@@ -587,16 +904,16 @@ datum_ne(Datum l, Datum r, Oid type)
 bool
 datum_lt(Datum l, Datum r, Oid type)
 {
+	if (type == INT4OID)
+		return DatumGetInt32(l) < DatumGetInt32(r);
+	if (type == FLOAT8OID)
+		return DatumGetFloat8(l) < DatumGetFloat8(r);
+	if (type == BOOLOID)
+		return DatumGetBool(l) < DatumGetBool(r);
 	ensure_temporal_base_type(type);
 	bool result = false;
-	if (type == BOOLOID)
-		result = DatumGetBool(l) < DatumGetBool(r);
-	else if (type == INT4OID)
-		result = DatumGetInt32(l) < DatumGetInt32(r);
-	else if (type == FLOAT8OID)
-		result = DatumGetFloat8(l) < DatumGetFloat8(r);
-	else if (type == TEXTOID)
-		result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) < 0;
+	if (type == TEXTOID)
+		result = text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) < 0;
 #ifdef WITH_POSTGIS
 	else if (type == type_oid(T_GEOMETRY))
 		result = DatumGetBool(call_function2(lwgeom_lt, l, r));
@@ -609,6 +926,12 @@ datum_lt(Datum l, Datum r, Oid type)
 bool
 datum_le(Datum l, Datum r, Oid type)
 {
+	if (type == INT4OID)
+		return DatumGetInt32(l) <= DatumGetInt32(r);
+	if (type == FLOAT8OID)
+		return DatumGetFloat8(l) <= DatumGetFloat8(r);
+	if (type == TEXTOID)
+		return text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) <= 0;
 	return datum_eq(l, r, type) || datum_lt(l, r, type);
 }
 
@@ -621,6 +944,12 @@ datum_gt(Datum l, Datum r, Oid type)
 bool
 datum_ge(Datum l, Datum r, Oid type)
 {
+	if (type == INT4OID)
+		return DatumGetInt32(l) >= DatumGetInt32(r);
+	if (type == FLOAT8OID)
+		return DatumGetFloat8(l) >= DatumGetFloat8(r);
+	if (type == TEXTOID)
+		return text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) >= 0;
 	return datum_eq(l, r, type) || datum_lt(r, l, type);
 }
 
@@ -634,28 +963,15 @@ datum_ge(Datum l, Datum r, Oid type)
 bool
 datum_eq2(Datum l, Datum r, Oid typel, Oid typer)
 {
+	if (typel == typer)
+		return datum_eq(l, r, typel);
 	ensure_temporal_base_type_all(typel);
 	ensure_temporal_base_type_all(typer);
 	bool result = false;
-	if ((typel == BOOLOID && typer == BOOLOID) ||
-		(typel == INT4OID && typer == INT4OID) ||
-		(typel == FLOAT8OID && typer == FLOAT8OID))
-		result = l == r;
-	else if (typel == INT4OID && typer == FLOAT8OID)
+	if (typel == INT4OID && typer == FLOAT8OID)
 		result = DatumGetInt32(l) == DatumGetFloat8(r);
 	else if (typel == FLOAT8OID && typer == INT4OID)
 		result = DatumGetFloat8(l) == DatumGetInt32(r);
-	else if (typel == TEXTOID && typer == TEXTOID)
-		result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) == 0;
-		/* This function is never called with doubleN */
-#ifdef WITH_POSTGIS
-	else if (typel == type_oid(T_GEOMETRY) && typer == type_oid(T_GEOMETRY))
-		//	result = DatumGetBool(call_function2(lwgeom_eq, l, r));
-		result = datum_point_eq(l, r);
-	else if (typel == type_oid(T_GEOGRAPHY) && typer == type_oid(T_GEOGRAPHY))
-		//	result = DatumGetBool(call_function2(geography_eq, l, r));
-		result = datum_point_eq(l, r);
-#endif
 	return result;
 }
 
@@ -680,7 +996,7 @@ datum_lt2(Datum l, Datum r, Oid typel, Oid typer)
 	else if (typel == FLOAT8OID && typer == FLOAT8OID)
 		result = DatumGetFloat8(l) < DatumGetFloat8(r);
 	else if (typel == TEXTOID && typer == TEXTOID)
-		result = text_cmp(DatumGetTextP(l), DatumGetTextP(r), DEFAULT_COLLATION_OID) < 0;
+		result = text_cmp(DatumGetTextPP(l), DatumGetTextPP(r), DEFAULT_COLLATION_OID) < 0;
 	return result;
 }
 
@@ -742,3 +1058,88 @@ datum2_ge2(Datum l, Datum r, Oid typel, Oid typer)
 
 /*****************************************************************************/
 
+/*****************************************************************************
+ * Space-filling curves
+ *****************************************************************************/
+
+/*
+ * Normalize a coordinate to [0, 1] with respect to the bounds of an extent,
+ * the coordinates outside of the extent are clamped to its bounds
+ */
+double
+spacefill_coord(double value, double min, double max)
+{
+	if (! (max > min))
+		return 0.0;
+	double result = (value - min) / (max - min);
+	if (! (result > 0.0))
+		return 0.0;
+	return result > 1.0 ? 1.0 : result;
+}
+
+/*
+ * Transform in place the cells of a point in a grid with 2^bits cells per 
+ * dimension into the transposed form of its index in the Hilbert curve,
+ * as described in J. Skilling, "Programming the Hilbert curve", AIP 
+ * Conference Proceedings 707, 2004.
+ */
+static void
+hilbert_transpose(uint32 *cells, int bits, int n)
+{
+	uint32 m = 1u << (bits - 1), p, q, t;
+	/* Inverse undo */
+	for (q = m; q > 1; q >>= 1)
+	{
+		p = q - 1;
+		for (int i = 0; i < n; i++)
+		{
+			if (cells[i] & q)
+				cells[0] ^= p;
+			else
+			{
+				t = (cells[0] ^ cells[i]) & p;
+				cells[0] ^= t;
+				cells[i] ^= t;
+			}
+		}
+	}
+	/* Gray encode */
+	for (int i = 1; i < n; i++)
+		cells[i] ^= cells[i - 1];
+	t = 0;
+	for (q = m; q > 1; q >>= 1)
+	{
+		if (cells[n - 1] & q)
+			t ^= q - 1;
+	}
+	for (int i = 0; i < n; i++)
+		cells[i] ^= t;
+}
+
+/*
+ * Key of a point in a Z-order or a Hilbert curve. The coordinates of the
+ * point must be normalized to [0, 1]. Each of the (at most 4) dimensions
+ * is discretized with the number of bits that keeps the key positive, 
+ * and the key is obtained by interleaving these bits.
+ */
+int64
+spacefill_key(const double *coords, int n, bool hilbert)
+{
+	assert(n > 0 && n <= 4);
+	uint32 cells[4];
+	int bits = Min(63 / n, 31);
+	uint32 maxcell = (1u << bits) - 1;
+	for (int i = 0; i < n; i++)
+		cells[i] = (uint32) (coords[i] * maxcell);
+	if (hilbert)
+		hilbert_transpose(cells, bits, n);
+	uint64 result = 0;
+	for (int b = bits - 1; b >= 0; b--)
+	{
+		for (int i = 0; i < n; i++)
+			result = (result << 1) | ((cells[i] >> b) & 1);
+	}
+	return (int64) result;
+}
+
+/*****************************************************************************/
@@ -12,6 +12,7 @@
 
 #include "temporal_waggfuncs.h"
 
+#include <assert.h>
 #include <utils/builtins.h>
 #include <utils/timestamp.h>
 
@@ -25,6 +26,17 @@
  * Generic functions
  *****************************************************************************/
 
+/* Aggregate operation computed by the window evaluator */
+
+typedef enum
+{
+	WAGG_MIN,
+	WAGG_MAX,
+	WAGG_SUM,
+	WAGG_COUNT,
+	WAGG_AVG
+} WindowAggOper;
+
 /* Extend the temporal value by a time interval */
 
 static int
@@ -57,33 +69,134 @@ temporali_extend(TemporalSeq **result, TemporalI *ti, Interval *interval)
 	return ti->count;
 }
 
+/*
+ * Compute in a single pass the window aggregate of a temporal sequence 
+ * with stepwise interpolation. Each segment of the sequence keeps its value
+ * during the segment extended by the interval, that is, the value of the
+ * segment [t_i, t_i+1) is valid during [t_i, t_i+1 + interval). Since both
+ * the start and the end of the extended segments are increasing, the
+ * segments that are active at each instant are a sliding window over the
+ * segments of the sequence. The minimum and the maximum of the window are
+ * maintained with a monotonic deque and the sum and the count with running
+ * totals. This avoids extending every segment of the sequence and merging
+ * the overlapping extended segments in the skiplist.
+ * The result is a single stepwise sequence, except for the average where
+ * the result is a set of constant sequences with linear interpolation,
+ * as for the other inputs of the average.
+ */
 static int
-tstepwseq_extend(TemporalSeq **result, TemporalSeq *seq, Interval *interval)
+tstepwseq_wagg(TemporalSeq **result, TemporalSeq *seq, Interval *interval,
+	WindowAggOper oper)
 {
-	if (seq->count == 1)
-		return temporalinst_extend(result, temporalseq_inst_n(seq, 0), interval);
-	
-	TemporalInst *instants[2];
-	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
-	bool lower_inc = seq->period.lower_inc;
-	for (int i = 0; i < seq->count - 1; i++)
+	assert(seq->count > 1);
+	int n = seq->count - 1;
+	double *values = palloc(sizeof(double) * n);
+	TimestampTz *lowers = palloc(sizeof(TimestampTz) * n);
+	TimestampTz *uppers = palloc(sizeof(TimestampTz) * n);
+	for (int i = 0; i < n; i++)
 	{
-		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
-		bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false ;
-		TimestampTz upper = DatumGetTimestampTz(
-			DirectFunctionCall2(timestamptz_pl_interval,
-			TimestampTzGetDatum(inst2->t),
+		TemporalInst *inst = temporalseq_inst_n(seq, i);
+		lowers[i] = inst->t;
+		values[i] = (oper == WAGG_COUNT) ? 1.0 :
+			datum_double(temporalinst_value(inst), inst->valuetypid);
+		uppers[i] = DatumGetTimestampTz(DirectFunctionCall2(
+			timestamptz_pl_interval,
+			TimestampTzGetDatum(temporalseq_inst_n(seq, i + 1)->t),
 			PointerGetDatum(interval)));
-		instants[0] = inst1;
-		instants[1] = temporalinst_make(temporalinst_value(inst1), 
-			upper, inst1->valuetypid);
-		result[i] = temporalseq_from_temporalinstarr(instants, 2,
-			lower_inc, upper_inc, MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
-		pfree(instants[1]);
-		inst1 = inst2;
-		lower_inc = true;
 	}
-	return seq->count - 1;
+	Oid valuetypid = (oper == WAGG_COUNT) ? INT4OID :
+		(oper == WAGG_AVG) ? type_oid(T_DOUBLE2) : seq->valuetypid;
+
+	/* Indexes of the active segments that may become the min or max */
+	int *deque = palloc(sizeof(int) * n);
+	int front = 0, back = 0;
+	double sum = 0.0;
+	int active = 0;
+	TimestampTz *times = palloc(sizeof(TimestampTz) * (2 * n));
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * (2 * n));
+	int i = 0, j = 0, k = 0;
+	while (j < n)
+	{
+		TimestampTz t = (i < n && timestamp_cmp_internal(lowers[i], uppers[j]) <= 0) ?
+			lowers[i] : uppers[j];
+		/* Remove the segments whose extended period ends at t */
+		while (j < n && timestamp_cmp_internal(uppers[j], t) <= 0)
+		{
+			if (front < back && deque[front] == j)
+				front++;
+			sum -= values[j];
+			active--;
+			j++;
+		}
+		/* Add the segments starting at t */
+		while (i < n && timestamp_cmp_internal(lowers[i], t) <= 0)
+		{
+			if (oper == WAGG_MIN)
+				while (front < back && values[deque[back - 1]] >= values[i])
+					back--;
+			else if (oper == WAGG_MAX)
+				while (front < back && values[deque[back - 1]] <= values[i])
+					back--;
+			deque[back++] = i;
+			sum += values[i];
+			active++;
+			i++;
+		}
+		if (j == n)
+			break;
+
+		Datum value;
+		double2 dvalue;
+		if (oper == WAGG_MIN || oper == WAGG_MAX || oper == WAGG_SUM)
+		{
+			double d = (oper == WAGG_SUM) ? sum : values[deque[front]];
+			value = (valuetypid == INT4OID) ? Int32GetDatum((int32) d) :
+				Float8GetDatum(d);
+		}
+		else if (oper == WAGG_COUNT)
+			value = Int32GetDatum(active);
+		else /* oper == WAGG_AVG */
+		{
+			double2_set(&dvalue, sum, active);
+			value = PointerGetDatum(&dvalue);
+		}
+		times[k] = t;
+		instants[k++] = temporalinst_make(value, t, valuetypid);
+	}
+
+	int count;
+	if (oper != WAGG_AVG)
+	{
+		/* The last segment keeps its value until the end of its window */
+		instants[k] = temporalinst_make(temporalinst_value(instants[k - 1]),
+			uppers[n - 1], valuetypid);
+		result[0] = temporalseq_from_temporalinstarr(instants, k + 1,
+			seq->period.lower_inc, seq->period.upper_inc, false, true);
+		pfree(instants[k]);
+		count = 1;
+	}
+	else
+	{
+		TemporalInst *pair[2];
+		for (int l = 0; l < k; l++)
+		{
+			TimestampTz upper = (l == k - 1) ? uppers[n - 1] : times[l + 1];
+			pair[0] = instants[l];
+			pair[1] = temporalinst_make(temporalinst_value(instants[l]),
+				upper, valuetypid);
+			result[l] = temporalseq_from_temporalinstarr(pair, 2,
+				(l == 0) ? seq->period.lower_inc : true,
+				(l == k - 1) ? seq->period.upper_inc : false, true, false);
+			pfree(pair[1]);
+		}
+		count = k;
+	}
+
+	for (int l = 0; l < k; l++)
+		pfree(instants[l]);
+	pfree(instants); pfree(times); pfree(deque);
+	pfree(values); pfree(lowers); pfree(uppers);
+	return count;
 }
 
 static int
@@ -156,16 +269,23 @@ tlinearseq_extend(TemporalSeq **result, TemporalSeq *seq, Interval *interval, bo
 }
 
 static int
-tstepws_extend(TemporalSeq **result, TemporalS *ts, Interval *interval)
+tstepwseq_extend(TemporalSeq **result, TemporalSeq *seq, Interval *interval,
+	WindowAggOper oper)
 {
-	if (ts->count == 1)
-		return tstepwseq_extend(result, temporals_seq_n(ts, 0), interval);
+	if (seq->count == 1)
+		return temporalinst_extend(result, temporalseq_inst_n(seq, 0), interval);
+	return tstepwseq_wagg(result, seq, interval, oper);
+}
 
+static int
+tstepws_extend(TemporalSeq **result, TemporalS *ts, Interval *interval,
+	WindowAggOper oper)
+{
 	int k = 0;
 	for (int i = 0; i < ts->count; i++)
 	{
 		TemporalSeq *seq = temporals_seq_n(ts, i);
-		k += tstepwseq_extend(&result[k], seq, interval);
+		k += tstepwseq_extend(&result[k], seq, interval, oper);
 	}
 	return k;
 }
@@ -174,7 +294,7 @@ static int
 tlinears_extend(TemporalSeq **result, TemporalS *ts, Interval *interval, bool min)
 {
 	if (ts->count == 1)
-		return tstepwseq_extend(result, temporals_seq_n(ts, 0), interval);
+		return tlinearseq_extend(result, temporals_seq_n(ts, 0), interval, min);
 
 	int k = 0;
 	for (int i = 0; i < ts->count; i++)
@@ -188,8 +308,10 @@ tlinears_extend(TemporalSeq **result, TemporalS *ts, Interval *interval, bool mi
 /* Dispatch function */
 
 static TemporalSeq **
-temporal_extend(Temporal *temp, Interval *interval, bool min, int *count)
+temporal_extend(Temporal *temp, Interval *interval, WindowAggOper oper,
+	int *count)
 {
+	bool min = (oper != WAGG_MAX);
 	TemporalSeq **result = NULL;
 	ensure_valid_duration(temp->duration);
 	if (temp->duration == TEMPORALINST)
@@ -209,7 +331,7 @@ temporal_extend(Temporal *temp, Interval *interval, bool min, int *count)
 		TemporalSeq *seq = (TemporalSeq *)temp;
 		result = palloc(sizeof(TemporalSeq *) * seq->count);
 		if (! MOBDB_FLAGS_GET_LINEAR(temp->flags))
-			*count = tstepwseq_extend(result, seq, interval);
+			*count = tstepwseq_extend(result, seq, interval, oper);
 		else
 			*count = tlinearseq_extend(result, seq, interval, min);
 	}
@@ -218,7 +340,7 @@ temporal_extend(Temporal *temp, Interval *interval, bool min, int *count)
 		TemporalS *ts = (TemporalS *)temp;
 		result = palloc(sizeof(TemporalSeq *) * ts->totalcount);
 		if (! MOBDB_FLAGS_GET_LINEAR(temp->flags))
-			*count = tstepws_extend(result, ts, interval);
+			*count = tstepws_extend(result, ts, interval, oper);
 		else
 			*count = tlinears_extend(result, ts, interval, min);
 	}
@@ -262,26 +384,7 @@ temporalseq_transform_wcount(TemporalSeq **result, TemporalSeq *seq, Interval *i
 {
 	if (seq->count == 1)
 		return temporalinst_transform_wcount(result, temporalseq_inst_n(seq, 0), interval);
-
-	TemporalInst *instants[2];
-	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
-	bool lower_inc = seq->period.lower_inc;
-	for (int i = 0; i < seq->count - 1; i++)
-	{
-		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
-		bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false ;
-		TimestampTz upper = DatumGetTimestampTz(DirectFunctionCall2(
-			timestamptz_pl_interval, TimestampTzGetDatum(inst2->t), 
-			PointerGetDatum(interval)));
-		instants[0] = temporalinst_make(Int32GetDatum(1), inst1->t, INT4OID);
-		instants[1] = temporalinst_make(Int32GetDatum(1), upper, INT4OID);
-		result[i] = temporalseq_from_temporalinstarr(instants, 2,
-			lower_inc, upper_inc, false, false);
-		pfree(instants[0]); pfree(instants[1]);
-		inst1 = inst2;
-		lower_inc = true;
-	}	
-	return seq->count - 1;
+	return tstepwseq_wagg(result, seq, interval, WAGG_COUNT);
 }
 
 static int
@@ -401,28 +504,7 @@ tintseq_transform_wavg(TemporalSeq **result, TemporalSeq *seq, Interval *interva
 		return 1;
 	}
 
-	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
-	bool lower_inc = seq->period.lower_inc;
-	for (int i = 0; i < seq->count - 1; i++)
-	{
-		TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
-		bool upper_inc = (i == seq->count - 2) ? seq->period.upper_inc : false ;
-		double value = DatumGetInt32(temporalinst_value(inst1)); 
-		double2 *dvalue = double2_construct(value, 1);
-		TimestampTz upper = DatumGetTimestampTz(DirectFunctionCall2(
-			timestamptz_pl_interval, TimestampTzGetDatum(inst2->t),
-			PointerGetDatum(interval)));
-		instants[0] = temporalinst_make(PointerGetDatum(dvalue), inst1->t,
-			type_oid(T_DOUBLE2));
-		instants[1] = temporalinst_make(PointerGetDatum(dvalue), upper,
-			type_oid(T_DOUBLE2));
-		result[i] = temporalseq_from_temporalinstarr(instants, 2,
-			lower_inc, upper_inc, linear, false);
-		pfree(instants[0]); pfree(instants[1]);
-		inst1 = inst2;
-		lower_inc = true;
-	}
-	return seq->count - 1;
+	return tstepwseq_wagg(result, seq, interval, WAGG_AVG);
 }
 
 static int
@@ -459,13 +541,14 @@ tnumber_transform_wavg(Temporal *temp, Interval *interval, int *count)
 	else if (temp->duration == TEMPORALSEQ)
 	{
 		TemporalSeq *seq = (TemporalSeq *)temp;
-		result = palloc(sizeof(TemporalSeq *) * seq->count);
+		/* The window average of a sequence is split at every window bound */
+		result = palloc(sizeof(TemporalSeq *) * seq->count * 2);
 		*count = tintseq_transform_wavg(result, seq, interval);
 	}
 	else if (temp->duration == TEMPORALS)
 	{
 		TemporalS *ts = (TemporalS *)temp;
-		result = palloc(sizeof(TemporalSeq *) * ts->totalcount);
+		result = palloc(sizeof(TemporalSeq *) * ts->totalcount * 2);
 		*count = tints_transform_wavg(result, ts, interval);
 	}
 	return result;
@@ -480,10 +563,10 @@ tnumber_transform_wavg(Temporal *temp, Interval *interval, int *count)
 static SkipList *
 temporal_wagg_transfn(FunctionCallInfo fcinfo, SkipList *state, 
 	Temporal *temp, Interval *interval,
-	Datum (*func)(Datum, Datum), bool min, bool crossings)
+	Datum (*func)(Datum, Datum), WindowAggOper oper, bool crossings)
 {
 	int count;
-	TemporalSeq **sequences = temporal_extend(temp, interval, min, &count);
+	TemporalSeq **sequences = temporal_extend(temp, interval, oper, &count);
 	SkipList *result = temporalseq_tagg_transfn(fcinfo, state, sequences[0], 
 		func, crossings);
 	for (int i = 1; i < count; i++)
@@ -514,7 +597,7 @@ tint_wmin_transfn(PG_FUNCTION_ARGS)
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Interval *interval = PG_GETARG_INTERVAL_P(2);
 	SkipList *result = temporal_wagg_transfn(fcinfo, state, temp, interval, 
-		&datum_min_int32, true, true);
+		&datum_min_int32, WAGG_MIN, true);
 	PG_FREE_IF_COPY(temp, 1);
 	PG_FREE_IF_COPY(interval, 2);
 	PG_RETURN_POINTER(result);
@@ -537,7 +620,7 @@ tfloat_wmin_transfn(PG_FUNCTION_ARGS)
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Interval *interval = PG_GETARG_INTERVAL_P(2);
 	SkipList *result = temporal_wagg_transfn(fcinfo, state, temp, interval, 
-		&datum_min_float8, true, true);
+		&datum_min_float8, WAGG_MIN, true);
 	PG_FREE_IF_COPY(temp, 1);
 	PG_FREE_IF_COPY(interval, 2);
 	PG_RETURN_POINTER(result);
@@ -562,7 +645,7 @@ tint_wmax_transfn(PG_FUNCTION_ARGS)
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Interval *interval = PG_GETARG_INTERVAL_P(2);
 	SkipList *result = temporal_wagg_transfn(fcinfo, state, temp, interval, 
-		&datum_max_int32, false, true);
+		&datum_max_int32, WAGG_MAX, true);
 	PG_FREE_IF_COPY(temp, 1);
 	PG_FREE_IF_COPY(interval, 2);
 	PG_RETURN_POINTER(result);
@@ -585,7 +668,7 @@ tfloat_wmax_transfn(PG_FUNCTION_ARGS)
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Interval *interval = PG_GETARG_INTERVAL_P(2);
 	SkipList *result = temporal_wagg_transfn(fcinfo, state, temp, interval, 
-		&datum_max_float8, false, true);
+		&datum_max_float8, WAGG_MAX, true);
 	PG_FREE_IF_COPY(temp, 1);
 	PG_FREE_IF_COPY(interval, 2);
 	PG_RETURN_POINTER(result);
@@ -610,7 +693,7 @@ tint_wsum_transfn(PG_FUNCTION_ARGS)
 	Temporal *temp = PG_GETARG_TEMPORAL(1);
 	Interval *interval = PG_GETARG_INTERVAL_P(2);
 	SkipList *result = temporal_wagg_transfn(fcinfo, state, temp, interval, 
-		&datum_sum_int32, true, false);
+		&datum_sum_int32, WAGG_SUM, false);
 	PG_FREE_IF_COPY(temp, 1);
 	PG_FREE_IF_COPY(interval, 2);
 	PG_RETURN_POINTER(result);
@@ -637,7 +720,7 @@ tfloat_wsum_transfn(PG_FUNCTION_ARGS)
 			errmsg("Operation not supported for temporal float sequences")));
 	Interval *interval = PG_GETARG_INTERVAL_P(2);
 	SkipList *result = temporal_wagg_transfn(fcinfo, state, temp, interval, 
-		&datum_sum_float8, true, false);
+		&datum_sum_float8, WAGG_SUM, false);
 	PG_FREE_IF_COPY(temp, 1);
 	PG_FREE_IF_COPY(interval, 2);
 	PG_RETURN_POINTER(result);
@@ -49,7 +49,8 @@
  *
  * where the X are unused bytes added for double padding, offset_0 to offset_1
  * are offsets for the corresponding instants, and offset_2 is the offset for 
- * the bounding box.
+ * the bounding box. The offsets are of type size_t in version 1 of the format
+ * and of type uint32 in version 2, as explained in temporal.h.
  */
 
 /* N-th TemporalInst of a TemporalI */
@@ -58,8 +59,8 @@ TemporalInst *
 temporali_inst_n(TemporalI *ti, int index)
 {
 	return (TemporalInst *) (
-		(char *)(&ti->offsets[ti->count + 1]) + 	/* start of data */
-			ti->offsets[index]);					/* offset */
+		TEMPORAL_DATA_PTR(ti->offsets, ti->flags, ti->count + 1) + 	/* start of data */
+			TEMPORAL_OFFSET_GET(ti->offsets, ti->flags, index));		/* offset */
 }
 
 /* Pointer to the bounding box of a TemporalI */
@@ -67,8 +68,8 @@ temporali_inst_n(TemporalI *ti, int index)
 void * 
 temporali_bbox_ptr(TemporalI *ti) 
 {
-	return (char *)(&ti->offsets[ti->count + 1]) +  /* start of data */
-		ti->offsets[ti->count];						/* offset */
+	return TEMPORAL_DATA_PTR(ti->offsets, ti->flags, ti->count + 1) +  /* start of data */
+		TEMPORAL_OFFSET_GET(ti->offsets, ti->flags, ti->count);			/* offset */
 }
 
 /* Copy the bounding box of a TemporalI in the first argument */
@@ -129,15 +130,19 @@ temporali_from_temporalinstarr(TemporalInst **instants, int count)
 	/* Add the size of composing instants */
 	for (int i = 0; i < count; i++)
 		memsize += double_pad(VARSIZE(instants[i]));
-	/* Add the size of the struct and the offset array 
-	 * Notice that the first offset is already declared in the struct */
-	size_t pdata = double_pad(sizeof(TemporalI) + count * sizeof(size_t));
+	/* Add the size of the struct and the offset array */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	size_t pdata = offsetof(TemporalI, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, count + 1);
 	/* Create the TemporalI */
 	TemporalI *result = palloc0(pdata + memsize);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
 	SET_VARSIZE(result, pdata + memsize);
 	result->count = count;
 	result->valuetypid = valuetypid;
 	result->duration = TEMPORALI;
+	result->flags = flags;
 	MOBDB_FLAGS_SET_LINEAR(result->flags, 
 		MOBDB_FLAGS_GET_LINEAR(instants[0]->flags));
 #ifdef WITH_POSTGIS
@@ -152,7 +157,7 @@ temporali_from_temporalinstarr(TemporalInst **instants, int count)
 	for (int i = 0; i < count; i++)
 	{
 		memcpy(((char *)result) + pdata + pos, instants[i], VARSIZE(instants[i]));
-		result->offsets[i] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, i, pos);
 		pos += double_pad(VARSIZE(instants[i]));
 	}
 	/*
@@ -164,7 +169,7 @@ temporali_from_temporalinstarr(TemporalInst **instants, int count)
 	{
 		void *bbox = ((char *) result) + pdata + pos;
 		temporali_make_bbox(bbox, instants, count);
-		result->offsets[count] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, count, pos);
 	}
 	return result;
 }
@@ -208,15 +213,19 @@ temporali_append_instant(TemporalI *ti, TemporalInst *inst)
 	for (int i = 0; i < ti->count; i++)
 		memsize += double_pad(VARSIZE(temporali_inst_n(ti, i)));
 	memsize += double_pad(VARSIZE(inst));
-	/* Add the size of the struct and the offset array 
-	 * Notice that the first offset is already declared in the struct */
-	size_t pdata = double_pad(sizeof(TemporalI) + (ti->count + 1) * sizeof(size_t));
+	/* Add the size of the struct and the offset array */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	size_t pdata = offsetof(TemporalI, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, ti->count + 2);
 	/* Create the TemporalI */
 	TemporalI *result = palloc0(pdata + memsize);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
 	SET_VARSIZE(result, pdata + memsize);
 	result->count = ti->count + 1;
 	result->valuetypid = valuetypid;
 	result->duration = TEMPORALI;
+	result->flags = flags;
 	MOBDB_FLAGS_SET_LINEAR(result->flags, 
 		MOBDB_FLAGS_GET_LINEAR(inst->flags));
 #ifdef WITH_POSTGIS
@@ -229,18 +238,18 @@ temporali_append_instant(TemporalI *ti, TemporalInst *inst)
 	{
 		inst1 = temporali_inst_n(ti, i);
 		memcpy(((char *)result) + pdata + pos, inst1, VARSIZE(inst1));
-		result->offsets[i] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, i, pos);
 		pos += double_pad(VARSIZE(inst1));
 	}
 	memcpy(((char *)result) + pdata + pos, inst, VARSIZE(inst));
-	result->offsets[ti->count] = pos;
+	TEMPORAL_OFFSET_SET(result->offsets, flags, ti->count, pos);
 	pos += double_pad(VARSIZE(inst));
 	/* Expand the bounding box */
 	if (bboxsize != 0) 
 	{
 		void *bbox = ((char *) result) + pdata + pos;
 		temporali_expand_bbox(bbox, ti, inst);
-		result->offsets[ti->count + 1] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, ti->count + 1, pos);
 	}
 	return result;
 }
@@ -272,12 +281,13 @@ bool
 temporali_find_timestamp(TemporalI *ti, TimestampTz t, int *pos) 
 {
 	int first = 0, last = ti->count - 1;
-	int middle = 0; /* make compiler quiet */
-	TemporalInst *inst = NULL; /* make compiler quiet */
+	/* The first probe is the position of the timestamp if the instants
+	 * were regularly sampled */
+	int middle = timestamp_interpolate_pos(temporali_inst_n(ti, 0)->t,
+		temporali_inst_n(ti, last)->t, last, t);
 	while (first <= last) 
 	{
-		middle = (first + last)/2;
-		inst = temporali_inst_n(ti, middle);
+		TemporalInst *inst = temporali_inst_n(ti, middle);
 		int cmp = timestamp_cmp_internal(inst->t, t);
 		if (cmp == 0)
 		{
@@ -288,10 +298,9 @@ temporali_find_timestamp(TemporalI *ti, TimestampTz t, int *pos)
 			last = middle - 1;
 		else
 			first = middle + 1;
+		middle = (first + last)/2;
 	}
-	if (timestamp_cmp_internal(t, inst->t) > 0)
-		middle++;
-	*pos = middle;
+	*pos = first;
 	return false;
 }
 
@@ -465,15 +474,23 @@ TemporalI *
 tinti_to_tfloati(TemporalI *ti)
 {
 	TemporalI *result = temporali_copy(ti);
-	result->valuetypid = FLOAT8OID;
+	tinti_to_tfloati_inplace(result);
+	return result;
+}
+
+/* Cast a temporal integer as a temporal float, overwriting the value */
+
+void
+tinti_to_tfloati_inplace(TemporalI *ti)
+{
+	ti->valuetypid = FLOAT8OID;
 	for (int i = 0; i < ti->count; i++)
 	{
-		TemporalInst *inst = temporali_inst_n(result, i);
+		TemporalInst *inst = temporali_inst_n(ti, i);
 		inst->valuetypid = FLOAT8OID;
 		Datum *value_ptr = temporalinst_value_ptr(inst);
 		*value_ptr = Float8GetDatum((double)DatumGetInt32(temporalinst_value(inst)));
 	}
-	return result;
 }
 
 /* Cast a temporal float as a temporal integer */
@@ -542,7 +559,7 @@ temporals_to_temporali(TemporalS *ts)
 
 /* Set of values taken by the temporal value */
 
-static Datum *
+Datum *
 temporali_values1(TemporalI *ti, int *count)
 {
 	Datum *result = palloc(sizeof(Datum *) * ti->count);
@@ -730,20 +747,29 @@ temporali_timestamps(TemporalI *ti)
 TemporalI *
 temporali_shift(TemporalI *ti, Interval *interval)
 {
-   	TemporalI *result = temporali_copy(ti);
+	TemporalI *result = temporali_copy(ti);
+	temporali_shift_inplace(result, interval);
+	return result;
+}
+
+/* Shift the time span of a temporal value by an interval, overwriting the
+ * value */
+
+void
+temporali_shift_inplace(TemporalI *ti, Interval *interval)
+{
 	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ti->count);
 	for (int i = 0; i < ti->count; i++)
 	{
-		TemporalInst *inst = instants[i] = temporali_inst_n(result, i);
+		TemporalInst *inst = instants[i] = temporali_inst_n(ti, i);
 		inst->t = DatumGetTimestampTz(
 			DirectFunctionCall2(timestamptz_pl_interval,
 			TimestampTzGetDatum(inst->t), PointerGetDatum(interval)));
 	}
 	/* Recompute the bounding box */
-	void *bbox = temporali_bbox_ptr(result); 
+	void *bbox = temporali_bbox_ptr(ti); 
 	temporali_make_bbox(bbox, instants, ti->count);
 	pfree(instants);
-	return result;
 }
 
 /*****************************************************************************
@@ -791,7 +817,7 @@ temporali_always_eq(TemporalI *ti, Datum value)
 				(int)(box.xmax) == DatumGetInt32(value);
 		else
 			return box.xmin == box.xmax &&
-				(int)(box.xmax) == DatumGetFloat8(value);
+				box.xmax == DatumGetFloat8(value);
 	}
 
 	for (int i = 0; i < ti->count; i++) 
@@ -1117,6 +1143,51 @@ tnumberi_at_range(TemporalI *ti, RangeType *range)
 	return result;
 }
 
+/*
+ * Time during which the temporal value is equal to a value. The periods are
+ * appended to the builder without constructing the restriction.
+ */
+void
+temporali_when_at_value(PeriodSetBuilder *builder, TemporalI *ti, Datum value)
+{
+	Oid valuetypid = ti->valuetypid;
+	/* Bounding box test */
+	if (valuetypid == INT4OID || valuetypid == FLOAT8OID)
+	{
+		TBOX box1, box2;
+		memset(&box1, 0, sizeof(TBOX));
+		memset(&box2, 0, sizeof(TBOX));
+		temporali_bbox(&box1, ti);
+		number_to_box(&box2, value, valuetypid);
+		if (!contains_tbox_tbox_internal(&box1, &box2))
+			return;
+	}
+
+	for (int i = 0; i < ti->count; i++)
+		temporalinst_when_at_value(builder, temporali_inst_n(ti, i), value);
+}
+
+/*
+ * Time during which the temporal value is in a range. The periods are
+ * appended to the builder without constructing the restriction.
+ */
+void
+tnumberi_when_at_range(PeriodSetBuilder *builder, TemporalI *ti,
+	RangeType *range)
+{
+	/* Bounding box test */
+	TBOX box1, box2;
+	memset(&box1, 0, sizeof(TBOX));
+	memset(&box2, 0, sizeof(TBOX));
+	temporali_bbox(&box1, ti);
+	range_to_tbox_internal(&box2, range);
+	if (!overlaps_tbox_tbox_internal(&box1, &box2))
+		return;
+
+	for (int i = 0; i < ti->count; i++)
+		tnumberinst_when_at_range(builder, temporali_inst_n(ti, i), range);
+}
+
 /* Restriction to the complement of a range */
 
 TemporalI *
@@ -1331,6 +1402,70 @@ temporali_value_at_timestamp(TemporalI *ti, TimestampTz t, Datum *result)
 	return true;
 }
 
+/*
+ * Value at a timestamp starting the search from the instant found by a
+ * previous call, which is updated with the position found.
+ */
+bool
+temporali_value_at_timestamp_hint(TemporalI *ti, TimestampTz t, int *hint,
+	Datum *result)
+{
+	int n = *hint;
+	if (n >= 0 && n < ti->count &&
+		timestamp_cmp_internal(temporali_inst_n(ti, n)->t, t) <= 0)
+	{
+		int last = Min(n + HINT_MAX_SCAN, ti->count - 1);
+		for (int i = n; i <= last; i++)
+		{
+			TemporalInst *inst = temporali_inst_n(ti, i);
+			int cmp = timestamp_cmp_internal(inst->t, t);
+			if (cmp == 0)
+			{
+				*hint = i;
+				*result = temporalinst_value_copy(inst);
+				return true;
+			}
+			if (cmp > 0)
+			{
+				*hint = i;
+				return false;
+			}
+		}
+	}
+	bool found = temporali_find_timestamp(ti, t, &n);
+	*hint = n;
+	if (found)
+		*result = temporalinst_value_copy(temporali_inst_n(ti, n));
+	return found;
+}
+
+/*
+ * Values at the timestamps of a timestamp set. The instants and the
+ * timestamps are traversed in parallel since both are ordered.
+ * The null flags must be initialized to true by the calling function.
+ */
+void
+temporali_values_at_timestampset(TemporalI *ti, TimestampSet *ts,
+	Datum *values, bool *nulls)
+{
+	int i = 0, j = 0;
+	while (i < ti->count && j < ts->count)
+	{
+		TemporalInst *inst = temporali_inst_n(ti, i);
+		int cmp = timestamp_cmp_internal(inst->t, timestampset_time_n(ts, j));
+		if (cmp == 0)
+		{
+			values[j] = temporalinst_value_copy(inst);
+			nulls[j] = false;
+			i++; j++;
+		}
+		else if (cmp < 0)
+			i++;
+		else
+			j++;
+	}
+}
+
 /* Restriction to the complement of a timestamptz */
 
 TemporalI *
@@ -1682,8 +1817,10 @@ tnumberi_twavg(TemporalI *ti)
 bool
 temporali_eq(TemporalI *ti1, TemporalI *ti2)
 {
-	/* If number of sequences or flags are not equal */
-	if (ti1->count != ti2->count || ti1->flags != ti2->flags)
+	/* If number of sequences or flags are not equal. The flag telling the 
+	   version of the format is ignored */
+	if (ti1->count != ti2->count || 
+		(ti1->flags | 0x100) != (ti2->flags | 0x100))
 		return false;
 
 	/* If bounding boxes are not equal */
@@ -1731,9 +1868,9 @@ temporali_cmp(TemporalI *ti1, TemporalI *ti2)
 	else if (ti2->count < ti1->count) /* ti2 has less instants than ti1 */
 		return 1;
 	/* Compare flags */
-	if (ti1->flags < ti2->flags)
+	if ((ti1->flags | 0x100) < (ti2->flags | 0x100))
 		return -1;
-	if (ti1->flags > ti2->flags)
+	if ((ti1->flags | 0x100) > (ti2->flags | 0x100))
 		return 1;
 	/* The two values are equal */
 	return 0;
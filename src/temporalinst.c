@@ -30,6 +30,7 @@
 
 #ifdef WITH_POSTGIS
 #include "tpoint.h"
+#include "tpoint_spatialfuncs.h"
 #endif
 
 /*****************************************************************************
@@ -98,56 +99,69 @@ temporalinst_bbox(void *box, TemporalInst *inst)
 	temporalinst_make_bbox(box, value, inst->t, inst->valuetypid);
 }
 
-/* Construct a temporal instant value */
- 
-TemporalInst *
-temporalinst_make(Datum value, TimestampTz t, Oid valuetypid)
+/* Size of a temporal instant value */
+
+size_t
+temporalinst_make_size(Datum value, Oid valuetypid)
+{
+	size_t size = double_pad(sizeof(TemporalInst));
+	if (get_typbyval_fast(valuetypid))
+		return size + double_pad(sizeof(Datum));
+	int typlen = get_typlen_fast(valuetypid);
+	return size + (typlen != -1 ? double_pad((unsigned int) typlen) : 
+		double_pad(VARSIZE(DatumGetPointer(value))));
+}
+
+/*
+ * Initialize a temporal instant value in zeroed memory of the size given
+ * by temporalinst_make_size. This allows the instants to be written
+ * directly into the temporal value that contains them.
+ */
+void
+temporalinst_set(TemporalInst *inst, size_t size, Datum value, 
+	TimestampTz t, Oid valuetypid)
 {
-	size_t value_offset = double_pad(sizeof(TemporalInst));
-	size_t size = value_offset;
-	/* Create the temporal value */
-	TemporalInst *result;
-	size_t value_size;
-	/* Copy value */
+	void *value_to = ((char *) inst) + double_pad(sizeof(TemporalInst));
 	bool byval = get_typbyval_fast(valuetypid);
 	if (byval)
-	{
 		/* For base types passed by value */
-		value_size = double_pad(sizeof(Datum));
-		size += value_size;
-		result = palloc0(size);
-		void *value_to = ((char *) result) + value_offset;
 		memcpy(value_to, &value, sizeof(Datum));
-	}
 	else 
 	{
 		/* For base types passed by reference */
 		void *value_from = DatumGetPointer(value);
 		int typlen = get_typlen_fast(valuetypid);
-		value_size = typlen != -1 ? double_pad((unsigned int) typlen) : 
-			double_pad(VARSIZE(value_from));
-		size += value_size;
-		result = palloc0(size);
-		void *value_to = ((char *) result) + value_offset;
-		memcpy(value_to, value_from, value_size);
+		memcpy(value_to, value_from, typlen != -1 ? (unsigned int) typlen : 
+			VARSIZE(value_from));
 	}
 	/* Initialize fixed-size values */
-	result->duration = TEMPORALINST;
-	result->valuetypid = valuetypid;
-	result->t = t;
-	SET_VARSIZE(result, size);
-	MOBDB_FLAGS_SET_BYVAL(result->flags, byval);
-	MOBDB_FLAGS_SET_LINEAR(result->flags, linear_interpolation(valuetypid));
+	inst->duration = TEMPORALINST;
+	inst->valuetypid = valuetypid;
+	inst->t = t;
+	SET_VARSIZE(inst, size);
+	MOBDB_FLAGS_SET_BYVAL(inst->flags, byval);
+	MOBDB_FLAGS_SET_LINEAR(inst->flags, linear_interpolation(valuetypid));
 #ifdef WITH_POSTGIS
 	if (valuetypid == type_oid(T_GEOMETRY) || 
 		valuetypid == type_oid(T_GEOGRAPHY))
 	{
 		GSERIALIZED *gs = (GSERIALIZED *)PG_DETOAST_DATUM(value);
-		MOBDB_FLAGS_SET_Z(result->flags, FLAGS_GET_Z(gs->flags));
-		MOBDB_FLAGS_SET_GEODETIC(result->flags, FLAGS_GET_GEODETIC(gs->flags));
+		MOBDB_FLAGS_SET_Z(inst->flags, FLAGS_GET_Z(gs->flags));
+		MOBDB_FLAGS_SET_GEODETIC(inst->flags, FLAGS_GET_GEODETIC(gs->flags));
 		POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(value));
 	}
 #endif
+}
+
+/* Construct a temporal instant value */
+ 
+TemporalInst *
+temporalinst_make(Datum value, TimestampTz t, Oid valuetypid)
+{
+	size_t size = temporalinst_make_size(value, valuetypid);
+	TemporalInst *result = palloc0(size);
+	temporalinst_set(result, size, value, t, valuetypid);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, size);
 	return result;
 }
 
@@ -201,15 +215,42 @@ temporalinst_to_string(TemporalInst *inst, char *(*value_out)(Oid, Datum))
 
 /* 
  * Send function. 
+ * The timestamp and the values of the fixed-width base types are written
+ * directly in the binary format of their send functions, avoiding the
+ * function call and the intermediate bytea for every instant. The same
+ * applies to geometry points, which are written in extended WKB.
  */
 void
 temporalinst_write(TemporalInst *inst, StringInfo buf)
 {
-	bytea *bt = call_send(TIMESTAMPTZOID, TimestampTzGetDatum(inst->t));
-	bytea *bv = call_send(inst->valuetypid, temporalinst_value(inst));
-	pq_sendbytes(buf, VARDATA(bt), VARSIZE(bt) - VARHDRSZ);
-	pq_sendint32(buf, VARSIZE(bv) - VARHDRSZ) ;
-	pq_sendbytes(buf, VARDATA(bv), VARSIZE(bv) - VARHDRSZ);
+	Datum value = temporalinst_value(inst);
+	pq_sendint64(buf, inst->t);
+	if (inst->valuetypid == BOOLOID)
+	{
+		pq_sendint32(buf, 1);
+		pq_sendbyte(buf, DatumGetBool(value) ? 1 : 0);
+	}
+	else if (inst->valuetypid == INT4OID)
+	{
+		pq_sendint32(buf, 4);
+		pq_sendint32(buf, (uint32) DatumGetInt32(value));
+	}
+	else if (inst->valuetypid == FLOAT8OID)
+	{
+		pq_sendint32(buf, 8);
+		pq_sendfloat8(buf, DatumGetFloat8(value));
+	}
+#ifdef WITH_POSTGIS
+	else if (inst->valuetypid == type_oid(T_GEOMETRY))
+		geompoint_write(value, buf);
+#endif
+	else
+	{
+		bytea *bv = call_send(inst->valuetypid, value);
+		pq_sendint32(buf, VARSIZE(bv) - VARHDRSZ) ;
+		pq_sendbytes(buf, VARDATA(bv), VARSIZE(bv) - VARHDRSZ);
+		pfree(bv);
+	}
 }
 
 /* 
@@ -218,7 +259,10 @@ temporalinst_write(TemporalInst *inst, StringInfo buf)
 TemporalInst *
 temporalinst_read(StringInfo buf, Oid valuetypid)
 {
-	TimestampTz t = call_recv(TIMESTAMPTZOID, buf);
+	TimestampTz t = (TimestampTz) pq_getmsgint64(buf);
+	if (!TIMESTAMP_NOT_FINITE(t) && !IS_VALID_TIMESTAMP(t))
+		ereport(ERROR, (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+			errmsg("timestamp out of range")));
 	int size = pq_getmsgint(buf, 4) ;
 	StringInfoData buf2 =
 	{
@@ -227,7 +271,22 @@ temporalinst_read(StringInfo buf, Oid valuetypid)
 		.maxlen = size,
 		.data = buf->data + buf->cursor
 	};	
-	Datum value = call_recv(valuetypid, &buf2);
+	Datum value;
+	if (valuetypid == BOOLOID)
+		value = BoolGetDatum(pq_getmsgbyte(&buf2) != 0);
+	else if (valuetypid == INT4OID)
+		value = Int32GetDatum((int32) pq_getmsgint(&buf2, 4));
+	else if (valuetypid == FLOAT8OID)
+		value = Float8GetDatum(pq_getmsgfloat8(&buf2));
+#ifdef WITH_POSTGIS
+	else if (valuetypid == type_oid(T_GEOMETRY))
+	{
+		if (! geompoint_read(&buf2, &value))
+			value = call_recv(valuetypid, &buf2);
+	}
+#endif
+	else
+		value = call_recv(valuetypid, &buf2);
 	buf->cursor += size ;
 	return temporalinst_make(value, t, valuetypid);
 }
@@ -258,13 +317,22 @@ TemporalInst *
 tintinst_to_tfloatinst(TemporalInst *inst)
 {
 	TemporalInst *result = temporalinst_copy(inst);
-	result->valuetypid = FLOAT8OID;
-	MOBDB_FLAGS_SET_LINEAR(result->flags, true);
-	Datum *value_ptr = temporalinst_value_ptr(result);
-	*value_ptr = Float8GetDatum((double)DatumGetInt32(temporalinst_value(inst)));
+	tintinst_to_tfloatinst_inplace(result);
 	return result;
 }
 
+/* Cast temporal integer as temporal float, overwriting the instant */
+
+void
+tintinst_to_tfloatinst_inplace(TemporalInst *inst)
+{
+	Datum value = temporalinst_value(inst);
+	inst->valuetypid = FLOAT8OID;
+	MOBDB_FLAGS_SET_LINEAR(inst->flags, true);
+	Datum *value_ptr = temporalinst_value_ptr(inst);
+	*value_ptr = Float8GetDatum((double)DatumGetInt32(value));
+}
+
 /* Cast temporal float as temporal integer */
 
 TemporalInst *
@@ -380,10 +448,19 @@ TemporalInst *
 temporalinst_shift(TemporalInst *inst, Interval *interval)
 {
 	TemporalInst *result = temporalinst_copy(inst);
-	result->t = DatumGetTimestampTz(
+	temporalinst_shift_inplace(result, interval);
+	return result;
+}
+
+/* Shift the time span of a temporal value by an interval, overwriting the 
+ * instant */
+
+void
+temporalinst_shift_inplace(TemporalInst *inst, Interval *interval)
+{
+	inst->t = DatumGetTimestampTz(
 		DirectFunctionCall2(timestamptz_pl_interval,
 		TimestampTzGetDatum(inst->t), PointerGetDatum(interval)));
-	return result;
 }
 
 /*****************************************************************************
@@ -505,6 +582,31 @@ tnumberinst_at_range(TemporalInst *inst, RangeType *range)
 	return temporalinst_copy(inst);
 }
 
+/*
+ * Time during which the temporal value is equal to a value. The period is
+ * appended to the builder without constructing the restriction.
+ */
+void
+temporalinst_when_at_value(PeriodSetBuilder *builder, TemporalInst *inst,
+	Datum value)
+{
+	if (datum_eq(temporalinst_value(inst), value, inst->valuetypid))
+		periodset_build_append(builder, inst->t, inst->t, true, true);
+}
+
+/*
+ * Time during which the temporal value is in a range. The period is
+ * appended to the builder without constructing the restriction.
+ */
+void
+tnumberinst_when_at_range(PeriodSetBuilder *builder, TemporalInst *inst,
+	RangeType *range)
+{
+	TypeCacheEntry* typcache = lookup_type_cache(range->rangetypid, TYPECACHE_RANGE_INFO);
+	if (range_contains_elem_internal(typcache, range, temporalinst_value(inst)))
+		periodset_build_append(builder, inst->t, inst->t, true, true);
+}
+
 /* Restriction to the complement of a range */
 
 TemporalInst *
@@ -581,6 +683,22 @@ temporalinst_value_at_timestamp(TemporalInst *inst, TimestampTz t, Datum *result
 	return true;
 }
 
+/*
+ * Values at the timestamps of a timestamp set. The arrays of values and
+ * null flags have one element per timestamp, the null flags must be
+ * initialized to true by the calling function.
+ */
+void
+temporalinst_values_at_timestampset(TemporalInst *inst, TimestampSet *ts,
+	Datum *values, bool *nulls)
+{
+	int n;
+	if (! timestampset_find_timestamp(ts, inst->t, &n))
+		return;
+	values[n] = temporalinst_value_copy(inst);
+	nulls[n] = false;
+}
+
 /* Restriction to the complement of a timestamptz */
 
 TemporalInst *
@@ -759,25 +877,10 @@ temporalinst_hash(TemporalInst *inst)
 	uint32		result;
 	uint32		time_hash;
 
-	Datum value = temporalinst_value(inst);
 	/* Apply the hash function according to the subtype */
-	uint32 value_hash = 0; 
-	ensure_temporal_base_type(inst->valuetypid);
-	if (inst->valuetypid == BOOLOID)
-		value_hash = DatumGetUInt32(call_function1(hashchar, value));
-	else if (inst->valuetypid == INT4OID)
-		value_hash = DatumGetUInt32(call_function1(hashint4, value));
-	else if (inst->valuetypid == FLOAT8OID)
-		value_hash = DatumGetUInt32(call_function1(hashfloat8, value));
-	else if (inst->valuetypid == TEXTOID)
-		value_hash = DatumGetUInt32(call_function1(hashtext, value));
-#ifdef WITH_POSTGIS
-	else if (inst->valuetypid == type_oid(T_GEOMETRY) || 
-		inst->valuetypid == type_oid(T_GEOGRAPHY))
-		value_hash = DatumGetUInt32(call_function1(lwgeom_hash, value));
-#endif
+	uint32 value_hash = datum_hash(temporalinst_value(inst), inst->valuetypid);
 	/* Apply the hash function according to the timestamp */
-	time_hash = DatumGetUInt32(call_function1(hashint8, TimestampTzGetDatum(inst->t)));
+	time_hash = timestamp_hash(inst->t);
 
 	/* Merge hashes of value and timestamp */
 	result = value_hash;
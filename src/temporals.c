@@ -48,7 +48,9 @@
  *
  * where the X are unused bytes added for double padding, offset_0 and offset_1
  * are offsets for the corresponding sequences and offset_2 is the offset for the 
- * bounding box. There is no precomputed trajectory for TemporalS.
+ * bounding box. There is no precomputed trajectory for TemporalS. The offsets
+ * are of type size_t in version 1 of the format and of type uint32 in 
+ * version 2, as explained in temporal.h.
  */
 
 /* N-th TemporalSeq of a TemporalS */
@@ -56,9 +58,10 @@
 TemporalSeq *
 temporals_seq_n(TemporalS *ts, int index)
 {
+	Assert(! MOBDB_FLAGS_GET_COMPRESSED(ts->flags));
 	return (TemporalSeq *)(
-		(char *)(&ts->offsets[ts->count + 1]) + 	/* start of data */
-			ts->offsets[index]);					/* offset */
+		TEMPORAL_DATA_PTR(ts->offsets, ts->flags, ts->count + 1) + 	/* start of data */
+			TEMPORAL_OFFSET_GET(ts->offsets, ts->flags, index));		/* offset */
 }
 
 /* Pointer to the bounding box of a TemporalS */
@@ -66,8 +69,10 @@ temporals_seq_n(TemporalS *ts, int index)
 void *
 temporals_bbox_ptr(TemporalS *ts) 
 {
-	return (char *)(&ts->offsets[ts->count + 1]) +  /* start of data */
-		ts->offsets[ts->count];						/* offset */
+	if (MOBDB_FLAGS_GET_COMPRESSED(ts->flags))
+		return TEMPORAL_COMPRESSED_BBOX_PTR(ts);
+	return TEMPORAL_DATA_PTR(ts->offsets, ts->flags, ts->count + 1) +  /* start of data */
+		TEMPORAL_OFFSET_GET(ts->offsets, ts->flags, ts->count);			/* offset */
 }
 
 /* Copy the bounding box of a TemporalS in the first argument */
@@ -128,13 +133,19 @@ temporals_from_temporalseqarr(TemporalSeq **sequences, int count,
 #endif
 	}
 
+	/* The input sequences are used as they are when none of them can be
+	 * joined with the next one */
+	bool normalized = normalize && count > 1 &&
+		temporalseqarr_has_adjacent(sequences, count);
 	TemporalSeq **newsequences = sequences;
 	int newcount = count;
-	if (normalize && count > 1)
+	if (normalized)
 		newsequences = temporalseqarr_normalize(sequences, count, &newcount);
-	/* Add the size of the struct and the offset array 
-	 * Notice that the first offset is already declared in the struct */
-	size_t pdata = double_pad(sizeof(TemporalS)) + newcount * sizeof(size_t);
+	/* Add the size of the struct and the offset array */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	size_t pdata = offsetof(TemporalS, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, newcount + 1);
 	size_t memsize = 0;
 	int totalcount = 0;
 	for (int i = 0; i < newcount; i++)
@@ -146,11 +157,13 @@ temporals_from_temporalseqarr(TemporalSeq **sequences, int count,
 	size_t bboxsize = temporal_bbox_size(valuetypid);
 	memsize += double_pad(bboxsize);
 	TemporalS *result = palloc0(pdata + memsize);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
 	SET_VARSIZE(result, pdata + memsize);
 	result->count = newcount;
 	result->totalcount = totalcount;
 	result->valuetypid = valuetypid;
 	result->duration = TEMPORALS;
+	result->flags = flags;
 	MOBDB_FLAGS_SET_LINEAR(result->flags, linear);
 #ifdef WITH_POSTGIS
 	if (isgeo)
@@ -164,7 +177,7 @@ temporals_from_temporalseqarr(TemporalSeq **sequences, int count,
 	for (int i = 0; i < newcount; i++)
 	{
 		memcpy(((char *) result) + pdata + pos, newsequences[i], VARSIZE(newsequences[i]));
-		result->offsets[i] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, i, pos);
 		pos += double_pad(VARSIZE(newsequences[i]));
 	}
 	/*
@@ -176,9 +189,9 @@ temporals_from_temporalseqarr(TemporalSeq **sequences, int count,
 	{
 		void *bbox = ((char *) result) + pdata + pos;
 		temporals_make_bbox(bbox, newsequences, newcount);
-		result->offsets[newcount] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, newcount, pos);
 	}
-	if (normalize && count > 1)
+	if (normalized)
 	{
 		for (int i = 0; i < newcount; i++)
 			pfree(newsequences[i]);
@@ -195,23 +208,28 @@ temporals_append_instant(TemporalS *ts, TemporalInst *inst)
 	/* Add the instant to the last sequence */
 	TemporalSeq *seq = temporals_seq_n(ts, ts->count - 1);
 	TemporalSeq *newseq = temporalseq_append_instant(seq, inst);
-	/* Add the size of the struct and the offset array 
-	 * Notice that the first offset is already declared in the struct */
-	size_t pdata = double_pad(sizeof(TemporalS)) + ts->count * sizeof(size_t);
+	/* Add the size of the struct and the offset array */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	size_t pdata = offsetof(TemporalS, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, ts->count + 1);
 	/* Get the bounding box size */
 	size_t bboxsize = temporal_bbox_size(ts->valuetypid);
 	size_t memsize = double_pad(bboxsize);
-	/* Add the size of composing instants */
-	for (int i = 0; i < ts->count - 1; i++)
-		memsize += double_pad(VARSIZE(temporals_seq_n(ts, i)));
-	memsize += double_pad(VARSIZE(newseq));
+	/* The sequences kept from the value are contiguous and keep their
+	 * offsets in the result, they are copied with a single memcpy */
+	size_t keptsize = TEMPORAL_OFFSET_GET(ts->offsets, ts->flags, ts->count - 1);
+	/* Add the size of composing sequences */
+	memsize += keptsize + double_pad(VARSIZE(newseq));
 	/* Create the TemporalS */
 	TemporalS *result = palloc0(pdata + memsize);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
 	SET_VARSIZE(result, pdata + memsize);
 	result->count = ts->count;
 	result->totalcount = ts->totalcount - seq->count + newseq->count;
 	result->valuetypid = ts->valuetypid;
 	result->duration = TEMPORALS;
+	result->flags = flags;
 	MOBDB_FLAGS_SET_LINEAR(result->flags, MOBDB_FLAGS_GET_LINEAR(ts->flags));
 #ifdef WITH_POSTGIS
 	if (ts->valuetypid == type_oid(T_GEOMETRY) ||
@@ -219,16 +237,16 @@ temporals_append_instant(TemporalS *ts, TemporalInst *inst)
 		MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(ts->flags));
 #endif
 	/* Initialization of the variable-length part */
-	size_t pos = 0;	
-	for (int i = 0; i < ts->count - 1; i++)
-	{
-		seq = temporals_seq_n(ts,i);
-		memcpy(((char *) result) + pdata + pos, seq, VARSIZE(seq));
-		result->offsets[i] = pos;
-		pos += double_pad(VARSIZE(seq));
-	}
+	memcpy(((char *) result) + pdata, temporals_seq_n(ts, 0), keptsize);
+	if (MOBDB_FLAGS_GET_OFFSETS32(ts->flags))
+		memcpy(result->offsets, ts->offsets, (ts->count - 1) * sizeof(uint32));
+	else
+		for (int i = 0; i < ts->count - 1; i++)
+			TEMPORAL_OFFSET_SET(result->offsets, flags, i, 
+				TEMPORAL_OFFSET_GET(ts->offsets, ts->flags, i));
+	size_t pos = keptsize;
 	memcpy(((char *) result) + pdata + pos, newseq, VARSIZE(newseq));
-	result->offsets[ts->count - 1] = pos;
+	TEMPORAL_OFFSET_SET(result->offsets, flags, ts->count - 1, pos);
 	pos += double_pad(VARSIZE(newseq));
 	/*
 	 * Precompute the bounding box 
@@ -240,12 +258,29 @@ temporals_append_instant(TemporalS *ts, TemporalInst *inst)
 		void *bbox = ((char *) result) + pdata + pos;
 		memcpy(bbox, temporals_bbox_ptr(ts), bboxsize);
 		temporals_expand_bbox(bbox, ts, inst);
-		result->offsets[ts->count] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, ts->count, pos);
 	}
 	pfree(newseq);
 	return result;
 }
 
+/* Append an array of TemporalInst to the last sequence of a TemporalS */
+
+TemporalS *
+temporals_append_instants(TemporalS *ts, TemporalInst **instants, int count)
+{
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
+	for (int i = 0; i < ts->count - 1; i++)
+		sequences[i] = temporals_seq_n(ts, i);
+	TemporalSeq *newseq = temporalseq_append_instants(
+		temporals_seq_n(ts, ts->count - 1), instants, count);
+	sequences[ts->count - 1] = newseq;
+	TemporalS *result = temporals_from_temporalseqarr(sequences, ts->count,
+		MOBDB_FLAGS_GET_LINEAR(ts->flags), false);
+	pfree(newseq); pfree(sequences);
+	return result;
+}
+
 /* Copy a TemporalS */
 TemporalS *
 temporals_copy(TemporalS *ts)
@@ -275,11 +310,15 @@ bool
 temporals_find_timestamp(TemporalS *ts, TimestampTz t, int *pos) 
 {
 	int first = 0, last = ts->count - 1;
-	int middle = 0; /* make compiler quiet */
+	/* The first probe is the position of the timestamp if the sequences
+	 * were regularly spaced */
+	int middle = timestamp_interpolate_pos(temporals_seq_n(ts, 0)->period.lower,
+		temporals_seq_n(ts, last)->period.upper, ts->count, t);
+	if (middle > last)
+		middle = last;
 	TemporalSeq *seq = NULL; /* make compiler quiet */
 	while (first <= last) 
 	{
-		middle = (first + last)/2;
 		seq = temporals_seq_n(ts, middle);
 		if (contains_period_timestamp_internal(&seq->period, t))
 		{
@@ -290,10 +329,9 @@ temporals_find_timestamp(TemporalS *ts, TimestampTz t, int *pos)
 			last = middle - 1;
 		else
 			first = middle + 1;
+		middle = (first + last)/2;
 	}
-	if (timestamp_cmp_internal(t, seq->period.upper) >= 0)
-		middle++;
-	*pos = middle;
+	*pos = first;
 	return false;
 }
 
@@ -703,22 +741,22 @@ TemporalS *
 tints_to_tfloats(TemporalS *ts)
 {
 	TemporalS *result = temporals_copy(ts);
-	result->valuetypid = FLOAT8OID;
-	MOBDB_FLAGS_SET_LINEAR(result->flags, false);
-	for (int i = 0; i < ts->count; i++)
-	{
-		TemporalSeq *seq = temporals_seq_n(result, i);
-		for (int j = 0; j < seq->count; j++)
-		{
-			TemporalInst *inst = temporalseq_inst_n(seq, j);
-			inst->valuetypid = FLOAT8OID;
-			Datum *value_ptr = temporalinst_value_ptr(inst);
-			*value_ptr = Float8GetDatum((double)DatumGetInt32(temporalinst_value(inst)));
-		}
-	}
+	tints_to_tfloats_inplace(result);
 	return result;
 }
 
+/* Cast a temporal integer value as a temporal float value, overwriting the
+ * value */
+
+void
+tints_to_tfloats_inplace(TemporalS *ts)
+{
+	ts->valuetypid = FLOAT8OID;
+	MOBDB_FLAGS_SET_LINEAR(ts->flags, false);
+	for (int i = 0; i < ts->count; i++)
+		tintseq_to_tfloatseq_inplace(temporals_seq_n(ts, i));
+}
+
 /* Cast a temporal float with stepwise interpolation as a temporal integer */
 
 TemporalS *
@@ -733,6 +771,8 @@ tfloats_to_tints(TemporalS *ts)
 	for (int i = 0; i < ts->count; i++)
 	{
 		TemporalSeq *seq = temporals_seq_n(result, i);
+		/* The values are truncated */
+		MOBDB_FLAGS_SET_SUMMARY(seq->flags, false);
 		for (int j = 0; j < seq->count; j++)
 		{
 			TemporalInst *inst = temporalseq_inst_n(seq, j);
@@ -974,6 +1014,11 @@ temporals_interval_double(TemporalS *ts)
 void
 temporals_period(Period *p, TemporalS *ts)
 {
+	if (MOBDB_FLAGS_GET_COMPRESSED(ts->flags))
+	{
+		memcpy(p, TEMPORALS_COMPRESSED_PERIOD_PTR(ts), sizeof(Period));
+		return;
+	}
 	TemporalSeq *start = temporals_seq_n(ts, 0);
 	TemporalSeq *end = temporals_seq_n(ts, ts->count - 1);
 	period_set(p, start->period.lower, end->period.upper, 
@@ -1065,6 +1110,68 @@ temporals_instant_n(TemporalS *ts, int n)
 	return next;
 }
 
+/*
+ * Cumulative number of distinct instants of the sequences, that is, the
+ * element i of the array is the number of distinct instants of the first 
+ * i + 1 sequences. An instant ending a sequence and starting the next one 
+ * is counted once.
+ */
+void
+temporals_instant_counts(TemporalS *ts, int *counts)
+{
+	TemporalInst *lastinst = NULL;
+	int count = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		count += seq->count;
+		if (lastinst != NULL && temporalinst_eq(lastinst, temporalseq_inst_n(seq, 0)))
+			count--;
+		lastinst = temporalseq_inst_n(seq, seq->count - 1);
+		counts[i] = count;
+	}
+}
+
+/*
+ * Find with a binary search on the cumulative counts of the sequences the
+ * sequence containing the n-th distinct element, 1-based, and its position
+ * in the sequence
+ */
+static int
+temporals_find_count(TemporalS *ts, const int *counts, int n, int *pos)
+{
+	int first = 0, last = ts->count - 1;
+	while (first < last)
+	{
+		int middle = (first + last) / 2;
+		if (counts[middle] < n)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	int prevcount = (first == 0) ? 0 : counts[first - 1];
+	TemporalSeq *seq = temporals_seq_n(ts, first);
+	/* Skip the first element of the sequence if it was counted in the
+	 * previous one */
+	int skip = seq->count - (counts[first] - prevcount);
+	*pos = n - prevcount - 1 + skip;
+	return first;
+}
+
+/*
+ * N-th distinct instant, 1-based, given the cumulative counts of the 
+ * distinct instants of the sequences
+ */
+TemporalInst *
+temporals_instant_n_counts(TemporalS *ts, const int *counts, int n)
+{
+	if (n < 1 || n > counts[ts->count - 1])
+		return NULL;
+	int pos;
+	int i = temporals_find_count(ts, counts, n, &pos);
+	return temporalseq_inst_n(temporals_seq_n(ts, i), pos);
+}
+
 /* Distinct instants */
 
 static int
@@ -1182,6 +1289,43 @@ temporals_timestamp_n(TemporalS *ts, int n, TimestampTz *result)
 	return true;
 }
 
+/*
+ * Cumulative number of distinct timestamps of the sequences, that is, the
+ * element i of the array is the number of distinct timestamps of the first 
+ * i + 1 sequences
+ */
+void
+temporals_timestamp_counts(TemporalS *ts, int *counts)
+{
+	TimestampTz lasttime = 0;
+	int count = 0;
+	for (int i = 0; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		count += seq->count;
+		if (i > 0 && lasttime == temporalseq_inst_n(seq, 0)->t)
+			count--;
+		lasttime = temporalseq_inst_n(seq, seq->count - 1)->t;
+		counts[i] = count;
+	}
+}
+
+/*
+ * N-th distinct timestamp, 1-based, given the cumulative counts of the 
+ * distinct timestamps of the sequences
+ */
+bool
+temporals_timestamp_n_counts(TemporalS *ts, const int *counts, int n,
+	TimestampTz *result)
+{
+	if (n < 1 || n > counts[ts->count - 1])
+		return false;
+	int pos;
+	int i = temporals_find_count(ts, counts, n, &pos);
+	*result = temporalseq_inst_n(temporals_seq_n(ts, i), pos)->t;
+	return true;
+}
+
 /* Distinct timestamps */
 
 TimestampTz *
@@ -1230,36 +1374,21 @@ TemporalS *
 temporals_shift(TemporalS *ts, Interval *interval)
 {
 	TemporalS *result = temporals_copy(ts);
-	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * ts->count);
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * ts->totalcount);
+	temporals_shift_inplace(result, interval);
+	return result;
+}
+
+/* Shift the time span of a temporal value by an interval, overwriting the
+ * value */
+
+void
+temporals_shift_inplace(TemporalS *ts, Interval *interval)
+{
 	for (int i = 0; i < ts->count; i++)
-	{
-		TemporalSeq *seq = sequences[i] = temporals_seq_n(result, i);
-		for (int j = 0; j < seq->count; j++)
-		{
-			TemporalInst *inst = instants[j] = temporalseq_inst_n(seq, j);
-			inst->t = DatumGetTimestampTz(
-				DirectFunctionCall2(timestamptz_pl_interval,
-				TimestampTzGetDatum(inst->t), PointerGetDatum(interval)));
-		}
-		/* Shift period */
-		seq->period.lower = DatumGetTimestampTz(
-				DirectFunctionCall2(timestamptz_pl_interval,
-				TimestampTzGetDatum(seq->period.lower), PointerGetDatum(interval)));
-		seq->period.upper = DatumGetTimestampTz(
-				DirectFunctionCall2(timestamptz_pl_interval,
-				TimestampTzGetDatum(seq->period.upper), PointerGetDatum(interval)));
-		/* Shift bounding box */
-		void *bbox = temporalseq_bbox_ptr(seq); 
-		shift_bbox(bbox, seq->valuetypid, interval);
-	
-	}
+		temporalseq_shift_inplace(temporals_seq_n(ts, i), interval);
 	/* Shift bounding box */
-	void *bbox = temporals_bbox_ptr(result); 
+	void *bbox = temporals_bbox_ptr(ts); 
 	shift_bbox(bbox, ts->valuetypid, interval);
-	pfree(sequences);
-	pfree(instants);
-	return result;
 }
 
 /*****************************************************************************
@@ -1623,6 +1752,51 @@ tnumbers_at_range(TemporalS *ts, RangeType *range)
 	return result;
 }
 
+/*
+ * Time during which the temporal value is equal to a value. The periods are
+ * appended to the builder without constructing the restriction.
+ */
+void
+temporals_when_at_value(PeriodSetBuilder *builder, TemporalS *ts, Datum value)
+{
+	Oid valuetypid = ts->valuetypid;
+	/* Bounding box test */
+	if (valuetypid == INT4OID || valuetypid == FLOAT8OID)
+	{
+		TBOX box1, box2;
+		memset(&box1, 0, sizeof(TBOX));
+		memset(&box2, 0, sizeof(TBOX));
+		temporals_bbox(&box1, ts);
+		number_to_box(&box2, value, valuetypid);
+		if (!contains_tbox_tbox_internal(&box1, &box2))
+			return;
+	}
+
+	for (int i = 0; i < ts->count; i++)
+		temporalseq_when_at_value(builder, temporals_seq_n(ts, i), value);
+}
+
+/*
+ * Time during which the temporal value is in a range. The periods are
+ * appended to the builder without constructing the restriction.
+ */
+void
+tnumbers_when_at_range(PeriodSetBuilder *builder, TemporalS *ts,
+	RangeType *range)
+{
+	/* Bounding box test */
+	TBOX box1, box2;
+	memset(&box1, 0, sizeof(TBOX));
+	memset(&box2, 0, sizeof(TBOX));
+	temporals_bbox(&box1, ts);
+	range_to_tbox_internal(&box2, range);
+	if (!overlaps_tbox_tbox_internal(&box1, &box2))
+		return;
+
+	for (int i = 0; i < ts->count; i++)
+		tnumberseq_when_at_range(builder, temporals_seq_n(ts, i), range);
+}
+
 /*
  * Restriction to the complement of range.
  */
@@ -1893,6 +2067,46 @@ temporals_value_at_timestamp(TemporalS *ts, TimestampTz t, Datum *result)
 	return temporalseq_value_at_timestamp(temporals_seq_n(ts, n), t, result);
 }
 
+/*
+ * Value at a timestamp starting the search from the sequence and the
+ * segment found by a previous call, which are updated with those found.
+ * The current sequence and the next one are tested before searching.
+ */
+bool
+temporals_value_at_timestamp_hint(TemporalS *ts, TimestampTz t, int *seqhint,
+	int *insthint, Datum *result)
+{
+	int n = *seqhint;
+	if (n < 0 || n >= ts->count ||
+		!contains_period_timestamp_internal(&temporals_seq_n(ts, n)->period, t))
+	{
+		if (n >= 0 && n < ts->count - 1 && contains_period_timestamp_internal(
+				&temporals_seq_n(ts, n + 1)->period, t))
+			n++;
+		else if (!temporals_find_timestamp(ts, t, &n))
+			return false;
+		*seqhint = n;
+		*insthint = 0;
+	}
+	return temporalseq_value_at_timestamp_hint(temporals_seq_n(ts, n), t,
+		insthint, result);
+}
+
+/*
+ * Values at the timestamps of a timestamp set. The cursor on the timestamps
+ * is shared by the sequences, so that each timestamp is visited once.
+ * The null flags must be initialized to true by the calling function.
+ */
+void
+temporals_values_at_timestampset(TemporalS *ts1, TimestampSet *ts2,
+	Datum *values, bool *nulls)
+{
+	int pos = 0;
+	for (int i = 0; i < ts1->count && pos < ts2->count; i++)
+		temporalseq_values_at_timestampset1(temporals_seq_n(ts1, i), ts2,
+			&pos, values, nulls);
+}
+
 /*
  * Restriction to a timestampset.
  */
@@ -2094,24 +2308,12 @@ temporals_at_periodset(TemporalS *ts, PeriodSet *ps)
 	temporals_find_timestamp(ts, t, &n1);
 	periodset_find_timestamp(ps, t, &n2);
 	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * (ts->count + ps->count - n1 - n2));
-	int i = n1, j = n2, k = 0;
-	while (i < ts->count && j < ps->count)
-	{
-		TemporalSeq *seq = temporals_seq_n(ts, i);
-		Period *p = periodset_per_n(ps, j);
-		TemporalSeq *seq1 = temporalseq_at_period(seq, p);
-		if (seq1 != NULL)
-			sequences[k++] = seq1;
-		int cmp = timestamp_cmp_internal(seq->period.upper, p->upper);
-		if (cmp == 0 && seq->period.upper_inc == p->upper_inc)
-		{
-			i++; j++;
-		}
-		else if (cmp < 0 || (cmp == 0 && ! seq->period.upper_inc && p->upper_inc))
-			i++;
-		else 
-			j++;
-	}
+	/* Merge walk over the sequences and the periods, where each sequence 
+	   resumes from the first period that may overlap it */
+	int k = 0;
+	for (int i = n1; i < ts->count && n2 < ps->count; i++)
+		k += temporalseq_at_periodset_walk(&sequences[k], temporals_seq_n(ts, i),
+			ps, &n2);
 	if (k == 0)
 	{
 		pfree(sequences);
@@ -2121,7 +2323,7 @@ temporals_at_periodset(TemporalS *ts, PeriodSet *ps)
 	   necessary to normalize the result of the projection */
 	TemporalS *result = temporals_from_temporalseqarr(sequences, k,
 		MOBDB_FLAGS_GET_LINEAR(ts->flags), false);
-	for (i = 0; i < k; i++)
+	for (int i = 0; i < k; i++)
 		pfree(sequences[i]);
 	pfree(sequences); 
 	return result;
@@ -2147,40 +2349,13 @@ temporals_minus_periodset(TemporalS *ts, PeriodSet *ps)
 
 	/* General case */
 	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * (ts->count + ps->count));
-	int i = 0, j = 0, k = 0;
-	while (i < ts->count && j < ps->count)
-	{
-		TemporalSeq *seq = temporals_seq_n(ts, i);
-		p2 = periodset_per_n(ps, j);
-		/* The sequence and the period do not overlap, copy the sequence */
-		if (!overlaps_period_period_internal(&seq->period, p2))
-		{
-			sequences[k++] = temporalseq_copy(seq);
-			i++;
-		}
-		else
-		{
-			/* Find all periods in ps that overlap with seq
-							  i
-				|------------------------|  
-					 |-----|  |-----|	  |---|
-						j					l
-			*/
-			int l;
-			for (l = j; l < ps->count; l++)
-			{
-				Period *p3 = periodset_per_n(ps, l);
-				if (!overlaps_period_period_internal(&seq->period, p3))
-					break;
-			}
-			int count = l - j;
-			/* Compute the difference of the overlapping periods */
-			k += temporalseq_minus_periodset1(&sequences[k], seq,
-				ps, j, count);
-			i++;
-			j = l;
-		}
-	}
+	/* Merge walk over the sequences and the periods, where each sequence 
+	   resumes from the first period that may overlap it. The sequences
+	   after the last period are copied by temporalseq_minus_periodset1 */
+	int j = 0, k = 0;
+	for (int i = 0; i < ts->count; i++)
+		k += temporalseq_minus_periodset1(&sequences[k], temporals_seq_n(ts, i),
+			ps, &j);
 	if (k == 0)
 	{
 		pfree(sequences);
@@ -2190,7 +2365,7 @@ temporals_minus_periodset(TemporalS *ts, PeriodSet *ps)
 	   necessary to normalize the result of the difference */
 	TemporalS *result = temporals_from_temporalseqarr(sequences, k,
 		MOBDB_FLAGS_GET_LINEAR(ts->flags), false);
-	for (i = 0; i < k; i++)
+	for (int i = 0; i < k; i++)
 		pfree(sequences[i]);
 	pfree(sequences);
 	return result;
@@ -2289,6 +2464,108 @@ tnumbers_twavg(TemporalS *ts)
 	return result;
 }
 
+/* 
+ * Integral of the temporal number restricted to a period that overlaps it,
+ * where the sequences contained in the period use their block summary, if
+ * any. The duration of the restriction is returned in the last argument. 
+ */
+static double
+tnumbers_integral_period1(TemporalS *ts, Period *p, double *duration)
+{
+	double result = 0;
+	*duration = 0;
+	int n;
+	temporals_find_timestamp(ts, p->lower, &n);
+	for (int i = n; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		if (timestamp_cmp_internal(p->upper, seq->period.lower) < 0)
+			break;
+		if (!overlaps_period_period_internal(&seq->period, p))
+			continue;
+		if (contains_period_period_internal(p, &seq->period))
+		{
+			result += tnumberseq_integral(seq);
+			*duration += (double) (seq->period.upper - seq->period.lower);
+		}
+		else
+		{
+			result += tnumberseq_integral_period(seq, p);
+			*duration += (double) (Min(seq->period.upper, p->upper) - 
+				Max(seq->period.lower, p->lower));
+		}
+	}
+	return result;
+}
+
+double
+tnumbers_integral_period(TemporalS *ts, Period *p)
+{
+	double duration;
+	return tnumbers_integral_period1(ts, p, &duration);
+}
+
+/* Time-weighted average of the temporal number restricted to a period */
+
+double
+tnumbers_twavg_period(TemporalS *ts, Period *p)
+{
+	double duration;
+	double result = tnumbers_integral_period1(ts, p, &duration);
+	if (duration != 0)
+		return result / duration;
+
+	/* All the intersections are instantaneous */
+	int n, count = 0;
+	temporals_find_timestamp(ts, p->lower, &n);
+	for (int i = n; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		if (timestamp_cmp_internal(p->upper, seq->period.lower) < 0)
+			break;
+		if (!overlaps_period_period_internal(&seq->period, p))
+			continue;
+		result += tnumberseq_twavg_period(seq, p);
+		count++;
+	}
+	return result / count;
+}
+
+/* 
+ * Minimum and maximum values of the temporal number restricted to a period.
+ * Returns false if the restriction is empty.
+ */
+
+bool
+tnumbers_minmax_period(TemporalS *ts, Period *p, double *min, double *max)
+{
+	bool found = false;
+	int n;
+	temporals_find_timestamp(ts, p->lower, &n);
+	for (int i = n; i < ts->count; i++)
+	{
+		TemporalSeq *seq = temporals_seq_n(ts, i);
+		if (timestamp_cmp_internal(p->upper, seq->period.lower) < 0)
+			break;
+		if (!overlaps_period_period_internal(&seq->period, p))
+			continue;
+		double min1, max1;
+		tnumberseq_minmax_period(seq, p, &min1, &max1);
+		if (! found)
+		{
+			*min = min1;
+			*max = max1;
+			found = true;
+		}
+		else
+		{
+			*min = Min(*min, min1);
+			*max = Max(*max, max1);
+		}
+	}
+	return found;
+}
+
 /*****************************************************************************
  * Functions for defining B-tree index
  * The functions assume that the arguments are of the same temptypid
@@ -2301,8 +2578,10 @@ tnumbers_twavg(TemporalS *ts)
 bool
 temporals_eq(TemporalS *ts1, TemporalS *ts2)
 {
-	/* If number of sequences or flags are not equal */
-	if (ts1->count != ts2->count || ts1->flags != ts2->flags)
+	/* If number of sequences or flags are not equal. The flag telling the 
+	   version of the format is ignored */
+	if (ts1->count != ts2->count || 
+		(ts1->flags | 0x100) != (ts2->flags | 0x100))
 		return false;
 
 	/* If bounding boxes are not equal */
@@ -2311,6 +2590,10 @@ temporals_eq(TemporalS *ts1, TemporalS *ts2)
 	if (! temporal_bbox_eq(ts1->valuetypid, box1, box2))
 		return false;
 
+	/* If the sequences have the same representation */
+	if (temporal_identical(ts1, ts2))
+		return true;
+
 	/* Compare the composing sequences */
 	for (int i = 0; i < ts1->count; i++)
 	{
@@ -2336,6 +2619,10 @@ temporals_cmp(TemporalS *ts1, TemporalS *ts2)
 	if (result)
 		return result;
 
+	/* If the sequences have the same representation */
+	if (temporal_identical(ts1, ts2))
+		return 0;
+
 	/* Compare composing instants */
 	int count = Min(ts1->count, ts2->count);
 	for (int i = 0; i < count; i++)
@@ -2352,9 +2639,9 @@ temporals_cmp(TemporalS *ts1, TemporalS *ts2)
 	else if (ts2->count < ts1->count) /* ts2 has less sequences than ts1 */
 		return 1;
 	/* Compare flags */
-	if (ts1->flags < ts2->flags)
+	if ((ts1->flags | 0x100) < (ts2->flags | 0x100))
 		return -1;
-	if (ts1->flags > ts2->flags)
+	if ((ts1->flags | 0x100) > (ts2->flags | 0x100))
 		return 1;
 	/* The two values are equal */
 	return 0;
@@ -55,17 +55,36 @@
  * are offsets for the corresponding instants, offset_2 is the offset for the 
  * bounding box and offset_3 is the offset for the precomputed trajectory. 
  * Precomputed trajectories are only kept for temporal points of sequence 
- * duration.
+ * duration. The offsets are of type size_t in version 1 of the format and of
+ * type uint32 in version 2, as explained in temporal.h.
+ *
+ * BLOCK SUMMARIES
+ * Long sequences of temporal numbers keep instead at offset_3 a summary of 
+ * their blocks of SUMMARY_BLOCK_SIZE segments, which contains the integral
+ * of the sequence up to the beginning of each block and a segment tree 
+ * with the minimum and maximum values of the blocks. Aggregates over a
+ * period are then computed from the summary, scanning only the segments at
+ * both ends of the period. A summary is built when the sequence has at 
+ * least summary_min_count instants and its presence is recorded in the
+ * flags of the sequence. Sequences constructed in other ways, such as by
+ * appending an instant, do not have a summary.
+ */
+
+/* 
+ * Value of the mobilitydb.summary_min_count parameter. A value of 0
+ * disables the block summaries.
  */
+int summary_min_count = 256;
 
 /* N-th TemporalInst of a TemporalSeq */
 
 TemporalInst *
 temporalseq_inst_n(TemporalSeq *seq, int index)
 {
+	Assert(! MOBDB_FLAGS_GET_COMPRESSED(seq->flags));
 	return (TemporalInst *)(
-		(char *)(&seq->offsets[seq->count + 2]) + 	/* start of data */
-			seq->offsets[index]);					/* offset */
+		TEMPORAL_DATA_PTR(seq->offsets, seq->flags, seq->count + 2) + 	/* start of data */
+			TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, index));		/* offset */
 }
 
 /* Pointer to the bounding box of a TemporalSeq */
@@ -73,8 +92,10 @@ temporalseq_inst_n(TemporalSeq *seq, int index)
 void * 
 temporalseq_bbox_ptr(TemporalSeq *seq) 
 {
-	return (char *)(&seq->offsets[seq->count + 2]) +  	/* start of data */
-		seq->offsets[seq->count];						/* offset */
+	if (MOBDB_FLAGS_GET_COMPRESSED(seq->flags))
+		return TEMPORAL_COMPRESSED_BBOX_PTR(seq);
+	return TEMPORAL_DATA_PTR(seq->offsets, seq->flags, seq->count + 2) +  /* start of data */
+		TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, seq->count);			/* offset */
 }
 
 /* Copy the bounding box of a TemporalSeq in the first argument */
@@ -87,6 +108,166 @@ temporalseq_bbox(void *box, TemporalSeq *seq)
 	memcpy(box, box1, bboxsize);
 }
 
+/* Pointer to the block summary of a TemporalSeq, NULL if it has none */
+
+TemporalSeqSummary *
+temporalseq_summary_ptr(TemporalSeq *seq)
+{
+	if (! MOBDB_FLAGS_GET_SUMMARY(seq->flags))
+		return NULL;
+	return (TemporalSeqSummary *)(
+		TEMPORAL_DATA_PTR(seq->offsets, seq->flags, seq->count + 2) +  /* start of data */
+			TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, seq->count + 1));	/* offset */
+}
+
+/* Value of an instant of a temporal number as a double */
+
+static double
+tnumberinst_double(TemporalInst *inst)
+{
+	Datum value = *temporalinst_value_ptr(inst);
+	return inst->valuetypid == INT4OID ? (double) DatumGetInt32(value) :
+		DatumGetFloat8(value);
+}
+
+/* Integral of a segment of a temporal number */
+
+static double
+tnumberseq_segment_integral(TemporalInst *inst1, TemporalInst *inst2, 
+	bool linear)
+{
+	double value1 = tnumberinst_double(inst1);
+	if (! linear)
+		return value1 * (double) (inst2->t - inst1->t);
+	double value2 = tnumberinst_double(inst2);
+	return (value1 + value2) * (double) (inst2->t - inst1->t) / 2.0;
+}
+
+/* Integral of a segment of a temporal number between two timestamps */
+
+static double
+tnumberseq_segment_integral_part(TemporalInst *inst1, TemporalInst *inst2, 
+	bool linear, TimestampTz t1, TimestampTz t2)
+{
+	double value1 = tnumberinst_double(inst1);
+	if (! linear)
+		return value1 * (double) (t2 - t1);
+	double value2 = tnumberinst_double(inst2);
+	double duration = (double) (inst2->t - inst1->t);
+	double start = value1 + (value2 - value1) * (double) (t1 - inst1->t) / duration;
+	double end = value1 + (value2 - value1) * (double) (t2 - inst1->t) / duration;
+	return (start + end) * (double) (t2 - t1) / 2.0;
+}
+
+/* Size of the block summary of a sequence, 0 if it has none */
+
+static size_t
+temporalseq_summary_size(Oid valuetypid, int count)
+{
+	if (summary_min_count <= 0 || count < summary_min_count || count < 2 ||
+		(valuetypid != INT4OID && valuetypid != FLOAT8OID))
+		return 0;
+	int nblocks = (count - 2) / SUMMARY_BLOCK_SIZE + 1;
+	/* The first value is already declared in the struct */
+	return double_pad(sizeof(TemporalSeqSummary) + 
+		nblocks * 5 * sizeof(double));
+}
+
+/* 
+ * Minimum and maximum values of the nodes of the segment tree of a block
+ * summary. Node 1 is the root, the children of node i are the nodes 2i and
+ * 2i + 1, and the leaves are the nodes count to 2 * count - 1. The minimum 
+ * and maximum values of node i are at positions 2i and 2i + 1.
+ */
+static double *
+temporalseq_summary_minmax(TemporalSeqSummary *summary)
+{
+	return &summary->integral[summary->count + 1];
+}
+
+/* Can the segments of a block of a summary take the value? */
+
+static bool
+temporalseq_summary_block_contains(TemporalSeqSummary *summary, int block,
+	double value)
+{
+	double *minmax = temporalseq_summary_minmax(summary);
+	int node = summary->count + block;
+	return minmax[2 * node] <= value && value <= minmax[2 * node + 1];
+}
+
+/* Minimum and maximum values of the blocks block1 to block2 of a summary */
+
+static void
+temporalseq_summary_minmax_blocks(TemporalSeqSummary *summary, int block1,
+	int block2, double *min, double *max)
+{
+	double *minmax = temporalseq_summary_minmax(summary);
+	int l = summary->count + block1;
+	int r = summary->count + block2 + 1;
+	while (l < r)
+	{
+		if (l & 1)
+		{
+			*min = Min(*min, minmax[2 * l]);
+			*max = Max(*max, minmax[2 * l + 1]);
+			l++;
+		}
+		if (r & 1)
+		{
+			r--;
+			*min = Min(*min, minmax[2 * r]);
+			*max = Max(*max, minmax[2 * r + 1]);
+		}
+		l >>= 1;
+		r >>= 1;
+	}
+}
+
+/* Construct the block summary of the instants of a sequence */
+
+static void
+temporalseq_make_summary(TemporalSeqSummary *summary, size_t size,
+	TemporalInst **instants, int count, bool linear)
+{
+	summary->size = (int32) size;
+	summary->count = (count - 2) / SUMMARY_BLOCK_SIZE + 1;
+	summary->integral[0] = 0;
+	double integral = 0;
+	for (int i = 1; i < count; i++)
+	{
+		integral += tnumberseq_segment_integral(instants[i - 1], instants[i],
+			linear);
+		if (i % SUMMARY_BLOCK_SIZE == 0 || i == count - 1)
+			summary->integral[(i + SUMMARY_BLOCK_SIZE - 1) / SUMMARY_BLOCK_SIZE] =
+				integral;
+	}
+	/* The leaves of the segment tree contain the values of the instants
+	   of the blocks, including the last instant that they share with the
+	   next block */
+	double *minmax = temporalseq_summary_minmax(summary);
+	for (int i = 0; i < summary->count; i++)
+	{
+		int node = summary->count + i;
+		int last = Min((i + 1) * SUMMARY_BLOCK_SIZE, count - 1);
+		double min = tnumberinst_double(instants[i * SUMMARY_BLOCK_SIZE]);
+		double max = min;
+		for (int j = i * SUMMARY_BLOCK_SIZE + 1; j <= last; j++)
+		{
+			double value = tnumberinst_double(instants[j]);
+			min = Min(min, value);
+			max = Max(max, value);
+		}
+		minmax[2 * node] = min;
+		minmax[2 * node + 1] = max;
+	}
+	for (int node = summary->count - 1; node > 0; node--)
+	{
+		minmax[2 * node] = Min(minmax[4 * node], minmax[4 * node + 2]);
+		minmax[2 * node + 1] = Max(minmax[4 * node + 1], minmax[4 * node + 3]);
+	}
+}
+
 /* 
  * Are the three temporal instant values collinear?
  * These functions supposes that the segments are not constant.
@@ -460,6 +641,25 @@ temporalseq_join(TemporalSeq *seq1, TemporalSeq *seq2, bool last, bool first)
 	return result;
 }
 
+/*
+ * Returns true if two consecutive sequences of an ordered and non-overlapping
+ * array are adjacent. This is a necessary condition for the normalization of
+ * the array to join sequences, callers use it to avoid copying the sequences
+ * when nothing can be joined.
+ */
+bool
+temporalseqarr_has_adjacent(TemporalSeq **sequences, int count)
+{
+	for (int i = 1; i < count; i++)
+	{
+		if (timestamp_cmp_internal(sequences[i - 1]->period.upper,
+				sequences[i]->period.lower) == 0 &&
+			(sequences[i - 1]->period.upper_inc || sequences[i]->period.lower_inc))
+			return true;
+	}
+	return false;
+}
+
 /*
  * Normalize an array of temporal sequences values. 
  * It is supposed that each individual sequence is already normalized.
@@ -643,15 +843,23 @@ temporalseq_from_temporalinstarr(TemporalInst **instants, int count,
 		}
 	}
 #endif
-	/* Add the size of the struct and the offset array 
-	 * Notice that the first offset is already declared in the struct */
-	size_t pdata = double_pad(sizeof(TemporalSeq)) + (newcount + 1) * sizeof(size_t);
+	/* Add the size of the block summary */
+	size_t summarysize = temporalseq_summary_size(valuetypid, newcount);
+	memsize += summarysize;
+	/* Add the size of the struct and the offset array, the two last 
+	 * offsets are those of the bounding box and of the trajectory */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	size_t pdata = offsetof(TemporalSeq, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, newcount + 2);
 	/* Create the TemporalSeq */
 	TemporalSeq *result = palloc0(pdata + memsize);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
 	SET_VARSIZE(result, pdata + memsize);
 	result->count = newcount;
 	result->valuetypid = valuetypid;
 	result->duration = TEMPORALSEQ;
+	result->flags = flags;
 	period_set(&result->period, newinstants[0]->t, newinstants[newcount - 1]->t,
 		lower_inc, upper_inc);
 	MOBDB_FLAGS_SET_LINEAR(result->flags, linear);
@@ -660,6 +868,7 @@ temporalseq_from_temporalinstarr(TemporalInst **instants, int count,
 	{
 		MOBDB_FLAGS_SET_Z(result->flags, hasz);
 		MOBDB_FLAGS_SET_GEODETIC(result->flags, isgeodetic);
+		MOBDB_FLAGS_SET_TRAJ(result->flags, trajectory);
 	}
 #endif
 	/* Initialization of the variable-length part */
@@ -668,7 +877,7 @@ temporalseq_from_temporalinstarr(TemporalInst **instants, int count,
 	{
 		memcpy(((char *)result) + pdata + pos, newinstants[i], 
 			VARSIZE(newinstants[i]));
-		result->offsets[i] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, i, pos);
 		pos += double_pad(VARSIZE(newinstants[i]));
 	}
 	/*
@@ -693,18 +902,26 @@ temporalseq_from_temporalinstarr(TemporalInst **instants, int count,
 #endif
 			temporalseq_make_bbox(bbox, newinstants, newcount, 
 				lower_inc, upper_inc);
-		result->offsets[newcount] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, newcount, pos);
 		pos += double_pad(bboxsize);
 	}
 #ifdef WITH_POSTGIS
 	if (isgeo && trajectory)
 	{
-		result->offsets[newcount + 1] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, newcount + 1, pos);
 		memcpy(((char *) result) + pdata + pos, DatumGetPointer(traj),
 			VARSIZE(DatumGetPointer(traj)));
 		pfree(DatumGetPointer(traj));
 	}
 #endif
+	if (summarysize != 0)
+	{
+		TEMPORAL_OFFSET_SET(result->offsets, flags, newcount + 1, pos);
+		temporalseq_make_summary((TemporalSeqSummary *)
+			(((char *) result) + pdata + pos), summarysize, newinstants,
+			newcount, linear);
+		MOBDB_FLAGS_SET_SUMMARY(result->flags, true);
+	}
 
 	if (normalize && count > 2)
 		pfree(newinstants);
@@ -712,6 +929,298 @@ temporalseq_from_temporalinstarr(TemporalInst **instants, int count,
 	return result;
 }
 
+/*****************************************************************************
+ * Construction of a TemporalSeq from instants given in increasing order of
+ * time, as produced by the restriction and lifting functions. The instants
+ * are written directly into the sequence under construction, instead of
+ * first making an array of TemporalInst that is then copied again by 
+ * temporalseq_from_temporalinstarr. The buffer is allocated for the expected
+ * number of instants and grows when needed. When normalization is requested 
+ * a redundant instant is removed as soon as the next instant is appended.
+ * The bounding box of temporal numbers is expanded with every instant, for
+ * temporal points it is computed from the trajectory at the end.
+ *****************************************************************************/
+
+static size_t
+temporalseq_build_pdata(int maxcount)
+{
+	/* The two last offsets are those of the bounding box and of the 
+	 * trajectory */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	return offsetof(TemporalSeq, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, maxcount + 2);
+}
+
+/* Ensure that the buffer can contain size additional bytes of instants */
+
+static void
+temporalseq_build_reserve(TemporalSeqBuilder *builder, size_t size)
+{
+	size_t needed = builder->pdata + builder->size + size;
+	if (needed <= builder->maxsize)
+		return;
+	size_t maxsize = Max(needed, builder->maxsize * 2);
+	builder->seq = repalloc(builder->seq, maxsize);
+	memset(((char *) builder->seq) + builder->maxsize, 0, 
+		maxsize - builder->maxsize);
+	builder->maxsize = maxsize;
+}
+
+/* Ensure that the array of offsets can contain one more instant */
+
+static void
+temporalseq_build_grow(TemporalSeqBuilder *builder)
+{
+	if (builder->count < builder->maxcount)
+		return;
+	int maxcount = builder->maxcount * 2;
+	size_t pdata = temporalseq_build_pdata(maxcount);
+	temporalseq_build_reserve(builder, pdata - builder->pdata);
+	char *seq = (char *) builder->seq;
+	memmove(seq + pdata, seq + builder->pdata, builder->size);
+	memset(seq + builder->pdata, 0, pdata - builder->pdata);
+	builder->pdata = pdata;
+	builder->maxcount = maxcount;
+}
+
+static TemporalInst *
+temporalseq_build_inst_n(TemporalSeqBuilder *builder, int index)
+{
+	return (TemporalInst *) (((char *) builder->seq) + builder->pdata + 
+		TEMPORAL_OFFSET_GET(builder->seq->offsets, builder->seq->flags, index));
+}
+
+/*
+ * Remove the last instant appended when it is redundant with respect to
+ * the previous one and the instant to append, with the same rules as 
+ * temporalinstarr_normalize
+ */
+static void
+temporalseq_build_normalize(TemporalSeqBuilder *builder, Datum value3, 
+	TimestampTz t3)
+{
+	if (!builder->normalize || builder->count < 2)
+		return;
+	Oid valuetypid = builder->valuetypid;
+	bool linear = builder->linear;
+	TemporalInst *inst1 = temporalseq_build_inst_n(builder, builder->count - 2);
+	TemporalInst *inst2 = temporalseq_build_inst_n(builder, builder->count - 1);
+	Datum value1 = temporalinst_value(inst1);
+	Datum value2 = temporalinst_value(inst2);
+	if ((!linear && datum_eq(value1, value2, valuetypid)) ||
+		(linear && datum_eq(value1, value2, valuetypid) && 
+			datum_eq(value2, value3, valuetypid)) ||
+		(linear && datum_collinear(valuetypid, value1, value2, value3, 
+			inst1->t, inst2->t, t3)))
+	{
+		builder->count--;
+		builder->size = TEMPORAL_OFFSET_GET(builder->seq->offsets, 
+			builder->seq->flags, builder->count);
+		memset(((char *) builder->seq) + builder->pdata + builder->size, 0,
+			VARSIZE(inst2));
+	}
+}
+
+/* Check the instant to append and make room for it */
+
+static TemporalInst *
+temporalseq_build_next(TemporalSeqBuilder *builder, Datum value, 
+	TimestampTz t, size_t size)
+{
+	if (builder->count > 0)
+	{
+		TemporalInst *last = temporalseq_build_inst_n(builder, builder->count - 1);
+		if (timestamp_cmp_internal(last->t, t) >= 0)
+		{
+			char *t1 = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(last->t));
+			char *t2 = call_output(TIMESTAMPTZOID, TimestampTzGetDatum(t));
+			ereport(ERROR, (errcode(ERRCODE_RESTRICT_VIOLATION), 
+				errmsg("Timestamps for temporal value must be increasing: %s, %s", t1, t2)));
+		}
+	}
+	temporalseq_build_normalize(builder, value, t);
+	temporalseq_build_grow(builder);
+	temporalseq_build_reserve(builder, size);
+	TEMPORAL_OFFSET_SET(builder->seq->offsets, builder->seq->flags, 
+		builder->count, builder->size);
+	TemporalInst *result = (TemporalInst *) (((char *) builder->seq) + 
+		builder->pdata + builder->size);
+	builder->size += double_pad(size);
+	builder->count++;
+	if (builder->valuetypid == INT4OID || builder->valuetypid == FLOAT8OID)
+	{
+		TBOX box;
+		memset(&box, 0, sizeof(TBOX));
+		temporalinst_make_bbox(&box, value, t, builder->valuetypid);
+		if (builder->count == 1)
+			builder->box = box;
+		else
+			tbox_expand(&builder->box, &box);
+	}
+	return result;
+}
+
+void
+temporalseq_build_init(TemporalSeqBuilder *builder, Oid valuetypid, 
+	int maxcount, bool linear, bool normalize)
+{
+	maxcount = Max(maxcount, 1);
+	size_t instsize = double_pad(sizeof(TemporalInst)) + 
+		double_pad(get_typbyval_fast(valuetypid) ? sizeof(Datum) :
+			(get_typlen_fast(valuetypid) != -1 ? 
+				(unsigned int) get_typlen_fast(valuetypid) : 64));
+	builder->valuetypid = valuetypid;
+	builder->linear = linear;
+	builder->normalize = normalize;
+	builder->count = 0;
+	builder->maxcount = maxcount;
+	builder->pdata = temporalseq_build_pdata(maxcount);
+	builder->size = 0;
+	builder->maxsize = builder->pdata + instsize * maxcount + 
+		double_pad(temporal_bbox_size(valuetypid));
+	builder->seq = palloc0(builder->maxsize);
+	MOBDB_FLAGS_SET_OFFSETS32(builder->seq->flags, true);
+}
+
+/* Append an instant given by its value and its timestamp */
+
+void
+temporalseq_build_append(TemporalSeqBuilder *builder, Datum value, 
+	TimestampTz t)
+{
+	size_t size = temporalinst_make_size(value, builder->valuetypid);
+	TemporalInst *inst = temporalseq_build_next(builder, value, t, size);
+	temporalinst_set(inst, size, value, t, builder->valuetypid);
+}
+
+/* Append a copy of a temporal instant */
+
+void
+temporalseq_build_append_inst(TemporalSeqBuilder *builder, TemporalInst *inst)
+{
+	TemporalInst *result = temporalseq_build_next(builder, 
+		temporalinst_value(inst), inst->t, VARSIZE(inst));
+	memcpy(result, inst, VARSIZE(inst));
+}
+
+/*
+ * Finish the construction of the TemporalSeq. The instants are moved next
+ * to the array of offsets of the actual number of instants and the bounding
+ * box and the trajectory are added after them.
+ */
+TemporalSeq *
+temporalseq_build_finish(TemporalSeqBuilder *builder, bool lower_inc, 
+	bool upper_inc)
+{
+	Oid valuetypid = builder->valuetypid;
+	int count = builder->count;
+	assert(count > 0);
+	if (count == 1 && (!lower_inc || !upper_inc))
+		ereport(ERROR, (errcode(ERRCODE_RESTRICT_VIOLATION), 
+			errmsg("Instant sequence must have inclusive bounds")));
+	if (!builder->linear && count > 1 && !upper_inc &&
+		datum_ne(temporalinst_value(temporalseq_build_inst_n(builder, count - 1)), 
+			temporalinst_value(temporalseq_build_inst_n(builder, count - 2)), 
+			valuetypid))
+		ereport(ERROR, (errcode(ERRCODE_RESTRICT_VIOLATION), 
+			errmsg("Invalid end value for temporal sequence")));
+
+	/* Move the instants next to the array of offsets */
+	size_t pdata = temporalseq_build_pdata(count);
+	if (pdata < builder->pdata)
+	{
+		char *seq = (char *) builder->seq;
+		memmove(seq + pdata, seq + builder->pdata, builder->size);
+		memset(seq + pdata + builder->size, 0, builder->pdata - pdata);
+		builder->pdata = pdata;
+	}
+	size_t bboxsize = temporal_bbox_size(valuetypid);
+	size_t memsize = builder->size + double_pad(bboxsize);
+	TemporalInst **instants = palloc(sizeof(TemporalInst *) * count);
+#ifdef WITH_POSTGIS
+	bool isgeo = (valuetypid == type_oid(T_GEOMETRY) ||
+		valuetypid == type_oid(T_GEOGRAPHY));
+	bool trajectory = false; /* keep compiler quiet */
+	Datum traj = 0; /* keep compiler quiet */
+	if (isgeo)
+	{
+		trajectory = type_has_precomputed_trajectory(valuetypid);  
+		if (trajectory)
+		{
+			for (int i = 0; i < count; i++)
+				instants[i] = temporalseq_build_inst_n(builder, i);
+			traj = tpointseq_make_trajectory(instants, count, builder->linear);
+			memsize += double_pad(VARSIZE(DatumGetPointer(traj)));
+		}
+	}
+#endif
+	size_t summarysize = temporalseq_summary_size(valuetypid, count);
+	memsize += summarysize;
+	temporalseq_build_reserve(builder, memsize - builder->size);
+	TemporalSeq *result = builder->seq;
+	for (int i = 0; i < count; i++)
+		instants[i] = temporalseq_build_inst_n(builder, i);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
+	SET_VARSIZE(result, pdata + memsize);
+	result->count = count;
+	result->valuetypid = valuetypid;
+	result->duration = TEMPORALSEQ;
+	period_set(&result->period, instants[0]->t, instants[count - 1]->t,
+		lower_inc, upper_inc);
+	MOBDB_FLAGS_SET_LINEAR(result->flags, builder->linear);
+#ifdef WITH_POSTGIS
+	if (isgeo)
+	{
+		MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(instants[0]->flags));
+		MOBDB_FLAGS_SET_GEODETIC(result->flags, 
+			MOBDB_FLAGS_GET_GEODETIC(instants[0]->flags));
+		MOBDB_FLAGS_SET_TRAJ(result->flags, trajectory);
+	}
+#endif
+	/* Precompute the bounding box */
+	size_t pos = builder->size;
+	if (bboxsize != 0)
+	{
+		void *bbox = ((char *) result) + pdata + pos;
+		if (valuetypid == INT4OID || valuetypid == FLOAT8OID)
+			memcpy(bbox, &builder->box, sizeof(TBOX));
+#ifdef WITH_POSTGIS
+		else if (isgeo && trajectory)
+		{
+			geo_to_stbox_internal(bbox, (GSERIALIZED *)DatumGetPointer(traj));
+			((STBOX *)bbox)->tmin = result->period.lower;
+			((STBOX *)bbox)->tmax = result->period.upper;
+			MOBDB_FLAGS_SET_T(((STBOX *)bbox)->flags, true);
+		}
+#endif
+		else
+			temporalseq_make_bbox(bbox, instants, count, lower_inc, upper_inc);
+		TEMPORAL_OFFSET_SET(result->offsets, result->flags, count, pos);
+		pos += double_pad(bboxsize);
+	}
+#ifdef WITH_POSTGIS
+	if (isgeo && trajectory)
+	{
+		TEMPORAL_OFFSET_SET(result->offsets, result->flags, count + 1, pos);
+		memcpy(((char *) result) + pdata + pos, DatumGetPointer(traj),
+			VARSIZE(DatumGetPointer(traj)));
+		pfree(DatumGetPointer(traj));
+	}
+#endif
+	if (summarysize != 0)
+	{
+		TEMPORAL_OFFSET_SET(result->offsets, result->flags, count + 1, pos);
+		temporalseq_make_summary((TemporalSeqSummary *)
+			(((char *) result) + pdata + pos), summarysize, instants, count,
+			builder->linear);
+		MOBDB_FLAGS_SET_SUMMARY(result->flags, true);
+	}
+	pfree(instants);
+	builder->seq = NULL;
+	return result;
+}
+
 /* Append a TemporalInst to a TemporalSeq */
 
 TemporalSeq *
@@ -778,10 +1287,14 @@ temporalseq_append_instant(TemporalSeq *seq, TemporalInst *inst)
 	/* Get the bounding box size */
 	size_t bboxsize = temporal_bbox_size(valuetypid);
 	size_t memsize = double_pad(bboxsize);
+	/* The instants kept from the sequence are contiguous and keep their
+	 * offsets in the result, they are copied with a single memcpy */
+	size_t keptsize = (newcount - 1 < seq->count) ? 
+		TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, newcount - 1) :
+		TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, seq->count - 1) + 
+			double_pad(VARSIZE(temporalseq_inst_n(seq, seq->count - 1)));
 	/* Add the size of composing instants */
-	for (int i = 0; i < newcount - 1; i++)
-		memsize += double_pad(VARSIZE(temporalseq_inst_n(seq, i)));
-	memsize += double_pad(VARSIZE(inst));
+	memsize += keptsize + double_pad(VARSIZE(inst));
 	/* Expand the trajectory */
 #ifdef WITH_POSTGIS
 	bool trajectory = false; /* keep compiler quiet */
@@ -797,46 +1310,56 @@ temporalseq_append_instant(TemporalSeq *seq, TemporalInst *inst)
 		}
 	}
 #endif
-	/* Add the size of the struct and the offset array 
-	 * Notice that the first offset is already declared in the struct */
-	size_t pdata = double_pad(sizeof(TemporalSeq)) + (newcount + 1) * sizeof(size_t);
+	/* Add the size of the struct and the offset array, the two last 
+	 * offsets are those of the bounding box and of the trajectory */
+	int16 flags = 0;
+	MOBDB_FLAGS_SET_OFFSETS32(flags, true);
+	size_t pdata = offsetof(TemporalSeq, offsets) + 
+		TEMPORAL_OFFSETS_SIZE(flags, newcount + 2);
 	/* Create the TemporalSeq */
 	TemporalSeq *result = palloc0(pdata + memsize);
+	MOBDB_STAT_ADD(STAT_CONSTRUCTED_BYTES, pdata + memsize);
 	SET_VARSIZE(result, pdata + memsize);
 	result->count = newcount;
 	result->valuetypid = valuetypid;
 	result->duration = TEMPORALSEQ;
+	result->flags = flags;
 	period_set(&result->period, seq->period.lower, inst->t, 
 		seq->period.lower_inc, true);
 	MOBDB_FLAGS_SET_LINEAR(result->flags, MOBDB_FLAGS_GET_LINEAR(seq->flags));
 #ifdef WITH_POSTGIS
 	if (isgeo)
+	{
 		MOBDB_FLAGS_SET_Z(result->flags, MOBDB_FLAGS_GET_Z(seq->flags));
+		MOBDB_FLAGS_SET_GEODETIC(result->flags, MOBDB_FLAGS_GET_GEODETIC(seq->flags));
+		MOBDB_FLAGS_SET_TRAJ(result->flags, trajectory);
+	}
 #endif
 	/* Initialization of the variable-length part */
-	size_t pos = 0;
-	for (int i = 0; i < newcount - 1; i++)
-	{
-		inst1 = temporalseq_inst_n(seq, i);
-		memcpy(((char *)result) + pdata + pos, inst1, VARSIZE(inst1));
-		result->offsets[i] = pos;
-		pos += double_pad(VARSIZE(inst1));
-	}
+	memcpy(((char *)result) + pdata, temporalseq_inst_n(seq, 0), keptsize);
+	if (MOBDB_FLAGS_GET_OFFSETS32(seq->flags))
+		memcpy(result->offsets, seq->offsets, (newcount - 1) * sizeof(uint32));
+	else
+		for (int i = 0; i < newcount - 1; i++)
+			TEMPORAL_OFFSET_SET(result->offsets, flags, i, 
+				TEMPORAL_OFFSET_GET(seq->offsets, seq->flags, i));
+	size_t pos = keptsize;
 	/* Append the instant */
 	memcpy(((char *)result) + pdata + pos, inst, VARSIZE(inst));
-	result->offsets[newcount - 1] = pos;
+	TEMPORAL_OFFSET_SET(result->offsets, flags, newcount - 1, pos);
 	pos += double_pad(VARSIZE(inst));
 	/* Expand the bounding box */
 	if (bboxsize != 0) 
 	{
 		void *bbox = ((char *) result) + pdata + pos;
 		temporalseq_expand_bbox(bbox, seq, inst);
-		result->offsets[newcount] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, newcount, pos);
+		pos += double_pad(bboxsize);
 	}
 #ifdef WITH_POSTGIS
 	if (isgeo && trajectory)
 	{
-		result->offsets[newcount + 1] = pos;
+		TEMPORAL_OFFSET_SET(result->offsets, flags, newcount + 1, pos);
 		memcpy(((char *) result) + pdata + pos, DatumGetPointer(traj),
 			VARSIZE(DatumGetPointer(traj)));
 		pfree(DatumGetPointer(traj));
@@ -845,6 +1368,41 @@ temporalseq_append_instant(TemporalSeq *seq, TemporalInst *inst)
 	return result;
 }
 
+/*
+ * Append an array of TemporalInst with increasing timestamps to a TemporalSeq.
+ * The instants of the sequence are copied once into a builder instead of
+ * once per appended instant.
+ */
+TemporalSeq *
+temporalseq_append_instants(TemporalSeq *seq, TemporalInst **instants, 
+	int count)
+{
+#ifdef WITH_POSTGIS
+	if (seq->valuetypid == type_oid(T_GEOMETRY) ||
+		seq->valuetypid == type_oid(T_GEOGRAPHY))
+	{
+		int srid = tpoint_srid_internal((Temporal *)seq);
+		for (int i = 0; i < count; i++)
+		{
+			if (tpoint_srid_internal((Temporal *)instants[i]) != srid)
+				ereport(ERROR, (errcode(ERRCODE_RESTRICT_VIOLATION), 
+					errmsg("All geometries composing a temporal point must be of the same SRID")));
+			if (MOBDB_FLAGS_GET_Z(instants[i]->flags) != MOBDB_FLAGS_GET_Z(seq->flags))
+				ereport(ERROR, (errcode(ERRCODE_RESTRICT_VIOLATION), 
+					errmsg("All geometries composing a temporal point must be of the same dimensionality")));
+		}
+	}
+#endif
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, seq->valuetypid, seq->count + count,
+		MOBDB_FLAGS_GET_LINEAR(seq->flags), true);
+	for (int i = 0; i < seq->count; i++)
+		temporalseq_build_append_inst(&builder, temporalseq_inst_n(seq, i));
+	for (int i = 0; i < count; i++)
+		temporalseq_build_append_inst(&builder, instants[i]);
+	return temporalseq_build_finish(&builder, seq->period.lower_inc, true);
+}
+
 /* Copy a temporal sequence */
 
 TemporalSeq *
@@ -855,32 +1413,78 @@ temporalseq_copy(TemporalSeq *seq)
 	return result;
 }
 
-/* Binary search of a timestamptz in a TemporalSeq */
+/* Binary search of a timestamptz in a TemporalSeq 
+ * Returns the index of the segment containing the timestamp or -1 if the
+ * timestamp is not contained in the sequence. The bounds are tested against
+ * the period of the sequence so that the search only needs to read the
+ * timestamp of a single instant at each step. The first probe is the
+ * position of the timestamp if the sequence were regularly sampled, which
+ * finds the segment at once for sensor data and otherwise splits the
+ * search interval as any other probe. */
 
 int
 temporalseq_find_timestamp(TemporalSeq *seq, TimestampTz t) 
 {
+	if (seq->count < 2)
+		return -1;
+	int cmp1 = timestamp_cmp_internal(t, seq->period.lower);
+	int cmp2 = timestamp_cmp_internal(t, seq->period.upper);
+	if (cmp1 < 0 || (cmp1 == 0 && !seq->period.lower_inc) ||
+		cmp2 > 0 || (cmp2 == 0 && !seq->period.upper_inc))
+		return -1;
+	if (cmp2 == 0)
+		return seq->count - 2;
+	/* Find the last instant whose timestamp is less than or equal to t */
 	int first = 0;
 	int last = seq->count - 2;
-	int middle = (first + last)/2;
-	while (first <= last) 
-	{
-		TemporalInst *inst1 = temporalseq_inst_n(seq, middle);
-		TemporalInst *inst2 = temporalseq_inst_n(seq, middle + 1);
-		bool lower_inc = (middle == 0) ? seq->period.lower_inc : true;
-		bool upper_inc = (middle == seq->count - 2) ? seq->period.upper_inc : false;
-		if ((timestamp_cmp_internal(inst1->t, t) < 0 && 
-			timestamp_cmp_internal(t, inst2->t) < 0) ||
-			(lower_inc && timestamp_cmp_internal(inst1->t, t) == 0) ||
-			(upper_inc && timestamp_cmp_internal(inst2->t, t) == 0))
-			return middle;
-		if (timestamp_cmp_internal(t, inst1->t) <= 0)
-			last = middle - 1;
+	int guess = timestamp_interpolate_pos(seq->period.lower, seq->period.upper,
+		seq->count - 1, t);
+	if (guess > last)
+		guess = last;
+	if (timestamp_cmp_internal(temporalseq_inst_n(seq, guess)->t, t) <= 0)
+	{
+		if (guess == last ||
+			timestamp_cmp_internal(temporalseq_inst_n(seq, guess + 1)->t, t) > 0)
+			return guess;
+		first = guess + 1;
+	}
+	else
+		last = guess - 1;
+	while (first < last) 
+	{
+		int middle = (first + last + 1)/2;
+		if (timestamp_cmp_internal(temporalseq_inst_n(seq, middle)->t, t) <= 0)
+			first = middle;
 		else
-			first = middle + 1;	
-		middle = (first + last)/2;
+			last = middle - 1;
+	}
+	return first;
+}
+
+/* 
+ * Search of a timestamptz in a TemporalSeq starting from the segment found
+ * by a previous search. Since successive searches are frequently made with
+ * increasing timestamps, the segments following the hint are scanned before
+ * reverting to a binary search. The hint is validated, so that any value
+ * can be given. Returns the same result as temporalseq_find_timestamp.
+ */
+int
+temporalseq_find_timestamp_hint(TemporalSeq *seq, TimestampTz t, int hint) 
+{
+	if (seq->count < 2 || !contains_period_timestamp_internal(&seq->period, t))
+		return -1;
+	if (hint >= 0 && hint < seq->count - 1 &&
+		timestamp_cmp_internal(temporalseq_inst_n(seq, hint)->t, t) <= 0)
+	{
+		int last = Min(hint + HINT_MAX_SCAN, seq->count - 2);
+		for (int i = hint; i <= last; i++)
+		{
+			if (i == seq->count - 2 ||
+				timestamp_cmp_internal(t, temporalseq_inst_n(seq, i + 1)->t) < 0)
+				return i;
+		}
 	}
-	return -1;
+	return temporalseq_find_timestamp(seq, t);
 }
 
 /*****************************************************************************
@@ -1140,7 +1744,7 @@ synchronize_temporalseq_temporalseq(TemporalSeq *seq1, TemporalSeq *seq2,
  * intersect. This function is used for temporal comparisons such as 
  * tfloat <comp> tfloat where <comp> is <, <=, ... since the comparison 
  * changes its value before/at/after the intersection point */
-static bool
+bool
 tnumberseq_intersect_at_timestamp(TemporalInst *start1, TemporalInst *end1, 
 	TemporalInst *start2, TemporalInst *end2, TimestampTz *t)
 {
@@ -1280,6 +1884,23 @@ temporalseq_intersect_at_timestamp(TemporalInst *start1, TemporalInst *end1, boo
 #ifdef WITH_POSTGIS
 	else if (start1->valuetypid == type_oid(T_GEOMETRY))
 		result = tpointseq_intersect_at_timestamp(start1, end1, linear1, start2, end2, linear2, inter);
+	else if (start1->valuetypid == type_oid(T_GEOGRAPHY) && geodetic_fast_path &&
+		linear1 && linear2)
+	{
+		/* Intersect the great circle segments traversed by the two points */
+		GeogSegment seg1, seg2;
+		bool hasz = MOBDB_FLAGS_GET_Z(start1->flags);
+		double fraction;
+		if (geog_segment_init(&seg1, temporalinst_value(start1), 
+				temporalinst_value(end1), hasz) &&
+			geog_segment_init(&seg2, temporalinst_value(start2), 
+				temporalinst_value(end2), hasz) &&
+			geog_segments_intersect(&seg1, &seg2, &fraction))
+		{
+			*inter = start1->t + (long) ((double) (end1->t - start1->t) * fraction);
+			result = true;
+		}
+	}
 	else if (start1->valuetypid == type_oid(T_GEOGRAPHY))
 	{
 		/* For geographies we do as the ST_Intersection function, e.g.
@@ -1400,16 +2021,24 @@ TemporalSeq *
 tintseq_to_tfloatseq(TemporalSeq *seq)
 {
 	TemporalSeq *result = temporalseq_copy(seq);
-	result->valuetypid = FLOAT8OID;
-	MOBDB_FLAGS_SET_LINEAR(result->flags, false);
+	tintseq_to_tfloatseq_inplace(result);
+	return result;
+}
+
+/* Cast a temporal integer as a temporal float, overwriting the value */
+
+void
+tintseq_to_tfloatseq_inplace(TemporalSeq *seq)
+{
+	seq->valuetypid = FLOAT8OID;
+	MOBDB_FLAGS_SET_LINEAR(seq->flags, false);
 	for (int i = 0; i < seq->count; i++)
 	{
-		TemporalInst *inst = temporalseq_inst_n(result, i);
+		TemporalInst *inst = temporalseq_inst_n(seq, i);
 		inst->valuetypid = FLOAT8OID;
 		Datum *value_ptr = temporalinst_value_ptr(inst);
 		*value_ptr = Float8GetDatum((double)DatumGetInt32(temporalinst_value(inst)));
 	}
-	return result;
 }
 
 /* Cast a temporal float with stepwise interpolation as a temporal integer */
@@ -1423,6 +2052,8 @@ tfloatseq_to_tintseq(TemporalSeq *seq)
 	TemporalSeq *result = temporalseq_copy(seq);
 	result->valuetypid = INT4OID;
 	MOBDB_FLAGS_SET_LINEAR(result->flags, false);
+	/* The values are truncated */
+	MOBDB_FLAGS_SET_SUMMARY(result->flags, false);
 	for (int i = 0; i < seq->count; i++)
 	{
 		TemporalInst *inst = temporalseq_inst_n(result, i);
@@ -1649,6 +2280,13 @@ temporalseq_min_value(TemporalSeq *seq)
 		TBOX *box = temporalseq_bbox_ptr(seq);
 		return Float8GetDatum(box->xmin);
 	}
+	if (seq->valuetypid == BOOLOID)
+	{
+		for (int i = 0; i < seq->count; i++)
+			if (! DatumGetBool(*temporalinst_value_ptr(temporalseq_inst_n(seq, i))))
+				return BoolGetDatum(false);
+		return BoolGetDatum(true);
+	}
 	Datum result = temporalinst_value(temporalseq_inst_n(seq, 0));
 	for (int i = 1; i < seq->count; i++)
 	{
@@ -1674,6 +2312,13 @@ temporalseq_max_value(TemporalSeq *seq)
 		TBOX *box = temporalseq_bbox_ptr(seq);
 		return Float8GetDatum(box->xmax);
 	}
+	if (seq->valuetypid == BOOLOID)
+	{
+		for (int i = 0; i < seq->count; i++)
+			if (DatumGetBool(*temporalinst_value_ptr(temporalseq_inst_n(seq, i))))
+				return BoolGetDatum(true);
+		return BoolGetDatum(false);
+	}
 	Datum result = temporalinst_value(temporalseq_inst_n(seq, 0));
 	for (int i = 1; i < seq->count; i++)
 	{
@@ -1684,6 +2329,106 @@ temporalseq_max_value(TemporalSeq *seq)
 	return result;
 }
 
+/* Minimum and maximum values of the instants from and to */
+
+static void
+tnumberseq_minmax_instants(TemporalSeq *seq, int from, int to, 
+	double *min, double *max)
+{
+	TemporalSeqSummary *summary = temporalseq_summary_ptr(seq);
+	int block1 = 0, block2 = -1;
+	if (summary != NULL && to - from > 2 * SUMMARY_BLOCK_SIZE)
+	{
+		/* Blocks whose instants are all between from and to */
+		block1 = (from + SUMMARY_BLOCK_SIZE - 1) / SUMMARY_BLOCK_SIZE;
+		block2 = to / SUMMARY_BLOCK_SIZE - 1;
+	}
+	if (block1 > block2)
+	{
+		for (int i = from; i <= to; i++)
+		{
+			double value = tnumberinst_double(temporalseq_inst_n(seq, i));
+			*min = Min(*min, value);
+			*max = Max(*max, value);
+		}
+		return;
+	}
+	temporalseq_summary_minmax_blocks(summary, block1, block2, min, max);
+	for (int i = from; i < block1 * SUMMARY_BLOCK_SIZE; i++)
+	{
+		double value = tnumberinst_double(temporalseq_inst_n(seq, i));
+		*min = Min(*min, value);
+		*max = Max(*max, value);
+	}
+	for (int i = (block2 + 1) * SUMMARY_BLOCK_SIZE + 1; i <= to; i++)
+	{
+		double value = tnumberinst_double(temporalseq_inst_n(seq, i));
+		*min = Min(*min, value);
+		*max = Max(*max, value);
+	}
+}
+
+/* 
+ * Minimum and maximum values of a temporal number restricted to a period
+ * that overlaps it, which are equal to those of the restriction of the 
+ * sequence to the period without constructing it
+ */
+void
+tnumberseq_minmax_period(TemporalSeq *seq, Period *p, double *min, 
+	double *max)
+{
+	if (seq->count == 1 || contains_period_period_internal(p, &seq->period))
+	{
+		TBOX *box = temporalseq_bbox_ptr(seq);
+		*min = box->xmin;
+		*max = box->xmax;
+		return;
+	}
+
+	TimestampTz lower = Max(seq->period.lower, p->lower);
+	TimestampTz upper = Min(seq->period.upper, p->upper);
+	bool upper_inc;
+	int cmp = timestamp_cmp_internal(p->upper, seq->period.upper);
+	if (cmp < 0)
+		upper_inc = p->upper_inc;
+	else if (cmp > 0)
+		upper_inc = seq->period.upper_inc;
+	else
+		upper_inc = p->upper_inc && seq->period.upper_inc;
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	int n1 = temporalseq_find_timestamp(seq, lower);
+	/* If the lower bound of the sequence is exclusive */
+	if (n1 == -1)
+		n1 = 0;
+	TemporalInst *inst1 = temporalseq_inst_n(seq, n1);
+	TemporalInst *inst2 = temporalseq_inst_n(seq, n1 + 1);
+	double value = datum_double(temporalseq_value_at_timestamp1(inst1, inst2,
+		linear, lower), seq->valuetypid);
+	*min = *max = value;
+	if (timestamp_cmp_internal(lower, upper) == 0)
+		return;
+
+	int n2 = temporalseq_find_timestamp(seq, upper);
+	/* If the upper bound of the sequence is exclusive */
+	if (n2 == -1)
+		n2 = seq->count - 2;
+	inst1 = temporalseq_inst_n(seq, n2);
+	inst2 = temporalseq_inst_n(seq, n2 + 1);
+	/* With stepwise interpolation the value at an exclusive upper bound is
+	   the value of the previous instant */
+	if (linear || upper_inc)
+	{
+		value = datum_double(temporalseq_value_at_timestamp1(inst1, inst2,
+			linear, upper), seq->valuetypid);
+		*min = Min(*min, value);
+		*max = Max(*max, value);
+	}
+	/* Instants strictly between the bounds */
+	int last = timestamp_cmp_internal(inst1->t, upper) == 0 ? n2 - 1 : n2;
+	if (n1 + 1 <= last)
+		tnumberseq_minmax_instants(seq, n1 + 1, last, min, max);
+}
+
 /* Timespan */
 
 Datum
@@ -1764,26 +2509,36 @@ TemporalSeq *
 temporalseq_shift(TemporalSeq *seq, Interval *interval)
 {
 	TemporalSeq *result = temporalseq_copy(seq);
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * seq->count);
+	temporalseq_shift_inplace(result, interval);
+	return result;
+}
+
+/* Shift the time span of a temporal value by an interval, overwriting the
+ * value */
+
+void
+temporalseq_shift_inplace(TemporalSeq *seq, Interval *interval)
+{
 	for (int i = 0; i < seq->count; i++)
 	{
-		TemporalInst *inst = instants[i] = temporalseq_inst_n(result, i);
+		TemporalInst *inst = temporalseq_inst_n(seq, i);
 		inst->t = DatumGetTimestampTz(
 			DirectFunctionCall2(timestamptz_pl_interval,
 			TimestampTzGetDatum(inst->t), PointerGetDatum(interval)));
 	}
 	/* Shift period */
-	result->period.lower = DatumGetTimestampTz(
+	seq->period.lower = DatumGetTimestampTz(
 			DirectFunctionCall2(timestamptz_pl_interval,
 			TimestampTzGetDatum(seq->period.lower), PointerGetDatum(interval)));
-	result->period.upper = DatumGetTimestampTz(
+	seq->period.upper = DatumGetTimestampTz(
 			DirectFunctionCall2(timestamptz_pl_interval,
 			TimestampTzGetDatum(seq->period.upper), PointerGetDatum(interval)));
 	/* Shift bounding box */
-	void *bbox = temporalseq_bbox_ptr(result); 
+	void *bbox = temporalseq_bbox_ptr(seq); 
 	shift_bbox(bbox, seq->valuetypid, interval);
-	pfree(instants);
-	return result;
+	/* The durations of the segments may change with months and days */
+	if (interval->month != 0 || interval->day != 0)
+		MOBDB_FLAGS_SET_SUMMARY(seq->flags, false);
 }
 
 /*****************************************************************************
@@ -1876,7 +2631,7 @@ temporalseq_always_eq(TemporalSeq *seq, Datum value)
 				(int)(box.xmax) == DatumGetInt32(value);
 		else
 			return box.xmin == box.xmax &&
-				(int)(box.xmax) == DatumGetFloat8(value);
+				box.xmax == DatumGetFloat8(value);
 	}
 
 	/* The following test assumes that the sequence is in normal form */
@@ -2193,32 +2948,51 @@ tlinearseq_timestamp_at_value(TemporalInst *inst1, TemporalInst *inst2,
 			return false;
 		}
 
-		/* We are sure that the trajectory is a line */
-		Datum line = geogpoint_trajectory(value1, value2);
-		bool inter = DatumGetFloat8(call_function4(geography_distance, line, 
-			value, Float8GetDatum(0.0), BoolGetDatum(false))) < 0.00001;
-		if (!inter)
+		GeogSegment seg;
+		bool hasz = MOBDB_FLAGS_GET_Z(inst1->flags);
+		if (geodetic_fast_path && geog_segment_init(&seg, value1, value2, hasz))
 		{
-			pfree(DatumGetPointer(line));
-			return false;
+			/* Locate the point on the great circle segment */
+			POINT2D p = datum_get_point2d(value);
+			double dist;
+			fraction = geog_segment_locate(&seg, &p, &dist);
+			if (dist >= GEOG_SEGMENT_TOLERANCE || fraction < 0.0 || 
+				fraction > 1.0 || (hasz && fabs(datum_get_point3dz(value).z - 
+					(seg.p1.z + (seg.p2.z - seg.p1.z) * fraction)) > EPSILON))
+			{
+				POSTGIS_FREE_IF_COPY_P(gs, DatumGetPointer(value));
+				return false;
+			}
 		}
+		else
+		{
+			/* We are sure that the trajectory is a line */
+			Datum line = geogpoint_trajectory(value1, value2);
+			bool inter = DatumGetFloat8(call_function4(geography_distance, line, 
+				value, Float8GetDatum(0.0), BoolGetDatum(false))) < 0.00001;
+			if (!inter)
+			{
+				pfree(DatumGetPointer(line));
+				return false;
+			}
 		
-		/* There is no function equivalent to LWGEOM_line_locate_point 
-		 * for geographies. We do as the ST_Intersection function, e.g.
-		 * 'SELECT geography(ST_Transform(ST_Intersection(ST_Transform(geometry($1), 
-		 * @extschema@._ST_BestSRID($1, $2)), 
-		 * ST_Transform(geometry($2), @extschema@._ST_BestSRID($1, $2))), 4326))' */
-
-		Datum bestsrid = call_function2(geography_bestsrid, line, line);
-		Datum line1 = call_function1(geometry_from_geography, line);
-		Datum line2 = call_function2(transform, line1, bestsrid);
-		value1 = call_function1(geometry_from_geography, value);
-		value2 = call_function2(transform, value1, bestsrid);
-		fraction = DatumGetFloat8(call_function2(LWGEOM_line_locate_point,
-			line2, value2));
-		pfree(DatumGetPointer(line)); pfree(DatumGetPointer(line1)); 
-		pfree(DatumGetPointer(line2)); pfree(DatumGetPointer(value1)); 
-		pfree(DatumGetPointer(value2));
+			/* There is no function equivalent to LWGEOM_line_locate_point 
+			 * for geographies. We do as the ST_Intersection function, e.g.
+			 * 'SELECT geography(ST_Transform(ST_Intersection(ST_Transform(geometry($1), 
+			 * @extschema@._ST_BestSRID($1, $2)), 
+			 * ST_Transform(geometry($2), @extschema@._ST_BestSRID($1, $2))), 4326))' */
+
+			Datum bestsrid = call_function2(geography_bestsrid, line, line);
+			Datum line1 = call_function1(geometry_from_geography, line);
+			Datum line2 = call_function2(transform, line1, bestsrid);
+			value1 = call_function1(geometry_from_geography, value);
+			value2 = call_function2(transform, value1, bestsrid);
+			fraction = DatumGetFloat8(call_function2(LWGEOM_line_locate_point,
+				line2, value2));
+			pfree(DatumGetPointer(line)); pfree(DatumGetPointer(line1)); 
+			pfree(DatumGetPointer(line2)); pfree(DatumGetPointer(value1)); 
+			pfree(DatumGetPointer(value2));
+		}
 	}
 #endif
 
@@ -2335,11 +3109,23 @@ temporalseq_at_value2(TemporalSeq **result, TemporalSeq *seq, Datum value)
 	}
 
 	/* General case */
+	TemporalSeqSummary *summary = temporalseq_summary_ptr(seq);
+	double dvalue = summary == NULL ? 0 : datum_double(value, valuetypid);
 	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
 	bool lower_inc = seq->period.lower_inc;
 	int k = 0;
 	for (int i = 1; i < seq->count; i++)
 	{
+		/* Skip the blocks whose values do not bracket the value */
+		if (summary != NULL && (i - 1) % SUMMARY_BLOCK_SIZE == 0 &&
+			! temporalseq_summary_block_contains(summary, 
+				(i - 1) / SUMMARY_BLOCK_SIZE, dvalue))
+		{
+			i = Min(i - 1 + SUMMARY_BLOCK_SIZE, seq->count - 1);
+			inst1 = temporalseq_inst_n(seq, i);
+			lower_inc = true;
+			continue;
+		}
 		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
 		bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
 		TemporalSeq *seq1 = temporalseq_at_value1(inst1, inst2, 
@@ -2547,9 +3333,33 @@ temporalseq_minus_value(TemporalSeq *seq, Datum value)
 	return result;
 }
 
+/*
+ * Returns the position of the first value of the sorted array that is not
+ * less than the value, or count if there is no such value
+ */
+static int
+datumarr_lower_bound(Datum *values, int count, Datum value, Oid valuetypid)
+{
+	int first = 0, last = count;
+	while (first < last)
+	{
+		int middle = (first + last) / 2;
+		if (datum_lt(values[middle], value, valuetypid))
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	return first;
+}
+
 /* 
  * Restriction to an array of values.
- * The function assumes that there are no duplicates values.
+ * The function assumes that the values are sorted and that there are no
+ * duplicates values. The segments are swept once and the values that may be
+ * taken in each segment are found by binary search, in the order in which
+ * they are taken in the segment, so that the resulting sequences are
+ * obtained in time order. Linear segments of points, for which there is no 
+ * such order, are compared with every value.
  * This function is called for each sequence of a TemporalS. 
  */
 int
@@ -2569,6 +3379,9 @@ temporalseq_at_values1(TemporalSeq **result, TemporalSeq *seq, Datum *values, in
 	}
 	
 	/* General case */
+	Oid valuetypid = seq->valuetypid;
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	bool sweep = !linear || valuetypid == FLOAT8OID;
 	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
 	bool lower_inc = seq->period.lower_inc;
 	int k = 0;	
@@ -2576,17 +3389,67 @@ temporalseq_at_values1(TemporalSeq **result, TemporalSeq *seq, Datum *values, in
 	{
 		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
 		bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
-		for (int j = 0; j < count; j++)
+		Datum value1 = temporalinst_value(inst1);
+		Datum value2 = temporalinst_value(inst2);
+		TemporalSeq *seq1;
+		if (!sweep)
 		{
-			TemporalSeq *seq1 = temporalseq_at_value1(inst1, inst2, 
-				MOBDB_FLAGS_GET_LINEAR(seq->flags), lower_inc, upper_inc, values[j]);
-			if (seq1 != NULL) 
-				result[k++] = seq1;
+			for (int j = 0; j < count; j++)
+			{
+				seq1 = temporalseq_at_value1(inst1, inst2, linear,
+					lower_inc, upper_inc, values[j]);
+				if (seq1 != NULL) 
+					result[k++] = seq1;
+			}
+		}
+		else if (!linear || datum_eq(value1, value2, valuetypid))
+		{
+			/* Stepwise or constant segment: only its bounds may be found */
+			int j = datumarr_lower_bound(values, count, value1, valuetypid);
+			if (j < count && datum_eq(values[j], value1, valuetypid))
+			{
+				seq1 = temporalseq_at_value1(inst1, inst2, linear,
+					lower_inc, upper_inc, value1);
+				if (seq1 != NULL) 
+					result[k++] = seq1;
+			}
+			if (upper_inc && datum_ne(value1, value2, valuetypid))
+			{
+				j = datumarr_lower_bound(values, count, value2, valuetypid);
+				if (j < count && datum_eq(values[j], value2, valuetypid))
+				{
+					seq1 = temporalseq_at_value1(inst1, inst2, linear,
+						lower_inc, upper_inc, value2);
+					if (seq1 != NULL) 
+						result[k++] = seq1;
+				}
+			}
+		}
+		else
+		{
+			/* Linear segment: the values between the bounds of the segment
+			 * taken in increasing or decreasing order */
+			bool increasing = DatumGetFloat8(value1) < DatumGetFloat8(value2);
+			Datum min = increasing ? value1 : value2;
+			Datum max = increasing ? value2 : value1;
+			int first = datumarr_lower_bound(values, count, min, valuetypid);
+			int last = first;
+			while (last < count && DatumGetFloat8(values[last]) <= DatumGetFloat8(max))
+				last++;
+			for (int j = first; j < last; j++)
+			{
+				Datum value = values[increasing ? j : first + last - 1 - j];
+				seq1 = temporalseq_at_value1(inst1, inst2, linear,
+					lower_inc, upper_inc, value);
+				if (seq1 != NULL) 
+					result[k++] = seq1;
+			}
 		}
 		inst1 = inst2;
 		lower_inc = true;
 	}
-	temporalseqarr_sort(result, k);
+	if (!sweep)
+		temporalseqarr_sort(result, k);
 	return k;
 }
 	
@@ -2819,6 +3682,242 @@ tnumberseq_at_range(TemporalSeq *seq, RangeType *range)
 	pfree(sequences);
 	return result;
 }
+
+/*
+ * Time during which a segment is equal to a value. The period is appended
+ * to the builder without constructing the restriction of the segment.
+ */
+static void
+temporalseq_when_at_value1(PeriodSetBuilder *builder, TemporalInst *inst1,
+	TemporalInst *inst2, bool linear, bool lower_inc, bool upper_inc,
+	Datum value)
+{
+	Datum value1 = temporalinst_value(inst1);
+	Datum value2 = temporalinst_value(inst2);
+	Oid valuetypid = inst1->valuetypid;
+	bool eq1 = datum_eq(value1, value, valuetypid);
+
+	/* Constant segment (stepwise or linear interpolation) */
+	if (datum_eq(value1, value2, valuetypid))
+	{
+		if (eq1)
+			periodset_build_append(builder, inst1->t, inst2->t,
+				lower_inc, upper_inc);
+		return;
+	}
+
+	bool eq2 = datum_eq(value2, value, valuetypid);
+	/* Stepwise interpolation */
+	if (! linear)
+	{
+		if (eq1)
+			periodset_build_append(builder, inst1->t, inst2->t,
+				lower_inc, false);
+		else if (upper_inc && eq2)
+			periodset_build_append(builder, inst2->t, inst2->t, true, true);
+		return;
+	}
+
+	/* Linear interpolation: Test of bounds */
+	if (eq1 || eq2)
+	{
+		if (eq1 && lower_inc)
+			periodset_build_append(builder, inst1->t, inst1->t, true, true);
+		if (eq2 && upper_inc)
+			periodset_build_append(builder, inst2->t, inst2->t, true, true);
+		return;
+	}
+
+	/* Continuous base type: Interpolation */
+	TimestampTz t;
+	if (tlinearseq_timestamp_at_value(inst1, inst2, value, valuetypid, &t))
+		periodset_build_append(builder, t, t, true, true);
+}
+
+/*
+ * Time during which the temporal value is equal to a value. The periods are
+ * appended to the builder without constructing the restriction.
+ * This function is called for each sequence of a TemporalS.
+ */
+void
+temporalseq_when_at_value(PeriodSetBuilder *builder, TemporalSeq *seq,
+	Datum value)
+{
+	Oid valuetypid = seq->valuetypid;
+	/* Bounding box test */
+	if (valuetypid == INT4OID || valuetypid == FLOAT8OID)
+	{
+		TBOX box1, box2;
+		memset(&box1, 0, sizeof(TBOX));
+		memset(&box2, 0, sizeof(TBOX));
+		temporalseq_bbox(&box1, seq);
+		number_to_box(&box2, value, valuetypid);
+		if (!contains_tbox_tbox_internal(&box1, &box2))
+			return;
+	}
+
+	/* Instantaneous sequence */
+	if (seq->count == 1)
+	{
+		temporalinst_when_at_value(builder, temporalseq_inst_n(seq, 0), value);
+		return;
+	}
+
+	/* General case */
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	bool lower_inc = seq->period.lower_inc;
+	for (int i = 1; i < seq->count; i++)
+	{
+		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
+		bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
+		temporalseq_when_at_value1(builder, inst1, inst2, linear, lower_inc,
+			upper_inc, value);
+		inst1 = inst2;
+		lower_inc = true;
+	}
+}
+
+/*
+ * Timestamp at which a segment of a temporal float with linear interpolation
+ * takes a value between the values of its instants (both inclusive). The
+ * interpolation is the same as in tlinearseq_timestamp_at_value.
+ */
+static TimestampTz
+tfloatseq_timestamp_at_value(TemporalInst *inst1, TemporalInst *inst2,
+	double value)
+{
+	double value1 = DatumGetFloat8(temporalinst_value(inst1));
+	double value2 = DatumGetFloat8(temporalinst_value(inst2));
+	if (value == value1)
+		return inst1->t;
+	if (value == value2)
+		return inst2->t;
+	double min = Min(value1, value2);
+	double max = Max(value1, value2);
+	double partial = value - min;
+	double fraction = value1 < value2 ?
+		partial / (max - min) : 1 - partial / (max - min);
+	return inst1->t + (long) ((double) (inst2->t - inst1->t) * fraction);
+}
+
+/*
+ * Time during which a segment is in a range. The periods are appended to the
+ * builder without constructing the restriction of the segment.
+ */
+static void
+tnumberseq_when_at_range1(PeriodSetBuilder *builder, TemporalInst *inst1,
+	TemporalInst *inst2, bool lower_inc, bool upper_inc, bool linear,
+	TypeCacheEntry *typcache, RangeType *range, RangeBound *lower,
+	RangeBound *upper)
+{
+	Datum value1 = temporalinst_value(inst1);
+	Datum value2 = temporalinst_value(inst2);
+	Oid valuetypid = inst1->valuetypid;
+	/* Discrete base type or constant segment */
+	bool constant = datum_eq(value1, value2, valuetypid);
+	if (!linear || constant)
+	{
+		if (range_contains_elem_internal(typcache, range, value1))
+			periodset_build_append(builder, inst1->t, inst2->t, lower_inc,
+				constant ? upper_inc : false);
+		if (! constant && upper_inc &&
+			range_contains_elem_internal(typcache, range, value2))
+			periodset_build_append(builder, inst2->t, inst2->t, true, true);
+		return;
+	}
+
+	/* Ensure data type with linear interpolation */
+	assert(valuetypid == FLOAT8OID);
+	double dvalue1 = DatumGetFloat8(value1);
+	double dvalue2 = DatumGetFloat8(value2);
+	/* Range of values of the segment */
+	bool increasing = dvalue1 < dvalue2;
+	double min = increasing ? dvalue1 : dvalue2;
+	double max = increasing ? dvalue2 : dvalue1;
+	bool min_inc = increasing ? lower_inc : upper_inc;
+	bool max_inc = increasing ? upper_inc : lower_inc;
+	/* Intersection with the range */
+	if (! lower->infinite)
+	{
+		double rmin = DatumGetFloat8(lower->val);
+		if (rmin > min)
+		{
+			min = rmin;
+			min_inc = lower->inclusive;
+		}
+		else if (rmin == min)
+			min_inc &= lower->inclusive;
+	}
+	if (! upper->infinite)
+	{
+		double rmax = DatumGetFloat8(upper->val);
+		if (rmax < max)
+		{
+			max = rmax;
+			max_inc = upper->inclusive;
+		}
+		else if (rmax == max)
+			max_inc &= upper->inclusive;
+	}
+	if (min > max)
+		return;
+
+	TimestampTz tmin = tfloatseq_timestamp_at_value(inst1, inst2, min);
+	TimestampTz tmax = tfloatseq_timestamp_at_value(inst1, inst2, max);
+	/* Empty and instantaneous periods are handled by the builder */
+	if (increasing)
+		periodset_build_append(builder, tmin, tmax, min_inc, max_inc);
+	else
+		periodset_build_append(builder, tmax, tmin, max_inc, min_inc);
+}
+
+/*
+ * Time during which the temporal value is in a range. The periods are
+ * appended to the builder without constructing the restriction.
+ * This function is called for each sequence of a TemporalS.
+ */
+void
+tnumberseq_when_at_range(PeriodSetBuilder *builder, TemporalSeq *seq,
+	RangeType *range)
+{
+	/* Bounding box test */
+	TBOX box1, box2;
+	memset(&box1, 0, sizeof(TBOX));
+	memset(&box2, 0, sizeof(TBOX));
+	temporalseq_bbox(&box1, seq);
+	range_to_tbox_internal(&box2, range);
+	if (!overlaps_tbox_tbox_internal(&box1, &box2))
+		return;
+
+	/* Instantaneous sequence */
+	if (seq->count == 1)
+	{
+		tnumberinst_when_at_range(builder, temporalseq_inst_n(seq, 0), range);
+		return;
+	}
+
+	/* General case */
+	TypeCacheEntry *typcache = lookup_type_cache(range->rangetypid,
+		TYPECACHE_RANGE_INFO);
+	RangeBound lower, upper;
+	bool empty;
+	range_deserialize(typcache, range, &lower, &upper, &empty);
+	if (empty)
+		return;
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	bool lower_inc = seq->period.lower_inc;
+	for (int i = 1; i < seq->count; i++)
+	{
+		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
+		bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
+		tnumberseq_when_at_range1(builder, inst1, inst2, lower_inc, upper_inc,
+			linear, typcache, range, &lower, &upper);
+		inst1 = inst2;
+		lower_inc = true;
+	}
+}
 	
 /*
  * Restriction to the complement of a range.
@@ -2891,8 +3990,67 @@ tnumberseq_minus_range(TemporalSeq *seq, RangeType *range)
 	return result;
 }
 
+/*
+ * Returns true if the range ends before the value
+ */
+static bool
+range_ends_before_elem(TypeCacheEntry *typcache, RangeType *range, Datum value)
+{
+	RangeBound lower, upper;
+	bool empty;
+	range_deserialize(typcache, range, &lower, &upper, &empty);
+	if (empty)
+		return true;
+	if (upper.infinite)
+		return false;
+	int cmp = DatumGetInt32(FunctionCall2Coll(&typcache->rng_cmp_proc_finfo,
+		typcache->rng_collation, upper.val, value));
+	return cmp < 0 || (cmp == 0 && !upper.inclusive);
+}
+
+/*
+ * Returns true if the range starts after the value
+ */
+static bool
+range_starts_after_elem(TypeCacheEntry *typcache, RangeType *range, Datum value)
+{
+	RangeBound lower, upper;
+	bool empty;
+	range_deserialize(typcache, range, &lower, &upper, &empty);
+	if (empty || lower.infinite)
+		return false;
+	int cmp = DatumGetInt32(FunctionCall2Coll(&typcache->rng_cmp_proc_finfo,
+		typcache->rng_collation, lower.val, value));
+	return cmp > 0 || (cmp == 0 && !lower.inclusive);
+}
+
+/*
+ * Returns the position of the first range of the normalized array that does 
+ * not end before the value, or count if there is no such range
+ */
+static int
+rangearr_lower_bound(TypeCacheEntry *typcache, RangeType **normranges, 
+	int count, Datum value)
+{
+	int first = 0, last = count;
+	while (first < last)
+	{
+		int middle = (first + last) / 2;
+		if (range_ends_before_elem(typcache, normranges[middle], value))
+			first = middle + 1;
+		else
+			last = middle;
+	}
+	return first;
+}
+
 /* 
- * Restriction to an array of ranges 
+ * Restriction to an array of ranges.
+ * The function assumes that the ranges are normalized, that is, sorted and
+ * disjoint. The segments are swept once and the ranges that may intersect
+ * each segment are found by binary search, in the order in which they are
+ * reached in the segment, so that the resulting sequences are obtained in 
+ * time order.
  * This function is called for each sequence of a TemporalS.
  */
 int
@@ -2912,6 +4070,9 @@ tnumberseq_at_ranges1(TemporalSeq **result, TemporalSeq *seq,
 	}
 
 	/* General case */
+	TypeCacheEntry *typcache = lookup_type_cache(normranges[0]->rangetypid,
+		TYPECACHE_RANGE_INFO);
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
 	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
 	bool lower_inc = seq->period.lower_inc;
 	int k = 0;	
@@ -2919,20 +4080,45 @@ tnumberseq_at_ranges1(TemporalSeq **result, TemporalSeq *seq,
 	{
 		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
 		bool upper_inc = (i == seq->count - 1) ? seq->period.upper_inc : false;
-		for (int j = 0; j < count; j++)
+		Datum value1 = temporalinst_value(inst1);
+		Datum value2 = temporalinst_value(inst2);
+		TemporalSeq *seq1;
+		if (!linear || datum_eq(value1, value2, seq->valuetypid))
 		{
-			TemporalSeq *seq1 = tnumberseq_at_range1(inst1, inst2, 
-				lower_inc, upper_inc, MOBDB_FLAGS_GET_LINEAR(seq->flags), normranges[j]);
-			if (seq1 != NULL) 
-				result[k++] = seq1;
+			/* Stepwise or constant segment: only the range of its value */
+			int j = rangearr_lower_bound(typcache, normranges, count, value1);
+			if (j < count)
+			{
+				seq1 = tnumberseq_at_range1(inst1, inst2, lower_inc, upper_inc,
+					linear, normranges[j]);
+				if (seq1 != NULL) 
+					result[k++] = seq1;
+			}
+		}
+		else
+		{
+			/* Linear segment: the ranges between the bounds of the segment
+			 * taken in increasing or decreasing order */
+			bool increasing = DatumGetFloat8(value1) < DatumGetFloat8(value2);
+			Datum min = increasing ? value1 : value2;
+			Datum max = increasing ? value2 : value1;
+			int first = rangearr_lower_bound(typcache, normranges, count, min);
+			int last = first;
+			while (last < count && 
+				!range_starts_after_elem(typcache, normranges[last], max))
+				last++;
+			for (int j = first; j < last; j++)
+			{
+				RangeType *range = normranges[increasing ? j : first + last - 1 - j];
+				seq1 = tnumberseq_at_range1(inst1, inst2, lower_inc, upper_inc,
+					linear, range);
+				if (seq1 != NULL) 
+					result[k++] = seq1;
+			}
 		}
 		inst1 = inst2;
 		lower_inc = true;
 	}
-	if (k == 0) 
-		return 0;
-	
-	temporalseqarr_sort(result, k);
 	return k;
 }
 
@@ -3060,12 +4246,15 @@ TemporalS *
 temporalseq_at_min(TemporalSeq *seq)
 {
 	Datum xmin = temporalseq_min_value(seq);
-	TemporalSeq *sequences[2];
+	/* The extreme value may be reached at several instants */
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * 
+		Max(seq->count, 2));
 	int count = temporalseq_at_minmax(sequences, seq, xmin);
 	TemporalS *result = temporals_from_temporalseqarr(sequences, count,
 		MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
 	for (int i = 0; i < count; i++)
 		pfree(sequences[i]);
+	pfree(sequences);
 	return result;
 }
 
@@ -3084,12 +4273,15 @@ TemporalS *
 temporalseq_at_max(TemporalSeq *seq)
 {
 	Datum xmax = temporalseq_max_value(seq);
-	TemporalSeq *sequences[2];
+	/* The extreme value may be reached at several instants */
+	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * 
+		Max(seq->count, 2));
 	int count = temporalseq_at_minmax(sequences, seq, xmax);
 	TemporalS *result = temporals_from_temporalseqarr(sequences, count,
 		MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
 	for (int i = 0; i < count; i++)
 		pfree(sequences[i]);
+	pfree(sequences);
 	return result;
 }
  
@@ -3153,6 +4345,10 @@ temporalseq_value_at_timestamp1(TemporalInst *inst1, TemporalInst *inst2,
 			line, Float8GetDatum(ratio));
 		pfree(DatumGetPointer(line)); 
 	}
+	else if (valuetypid == type_oid(T_GEOGRAPHY) && geodetic_fast_path &&
+		geogpoint_interpolate(value1, value2, ratio, &result))
+		/* Spherical linear interpolation on the great circle segment */
+		;
 	else if (valuetypid == type_oid(T_GEOGRAPHY))
 	{
 		/* We are sure that the trajectory is a line */
@@ -3224,6 +4420,81 @@ temporalseq_value_at_timestamp(TemporalSeq *seq, TimestampTz t, Datum *result)
 	return true;
 }
 
+/*
+ * Value at a timestamp starting the search from the segment found by a
+ * previous call, which is updated with the segment found.
+ */
+bool
+temporalseq_value_at_timestamp_hint(TemporalSeq *seq, TimestampTz t, 
+	int *hint, Datum *result)
+{
+	/* Bounding box test */
+	if (!contains_period_timestamp_internal(&seq->period, t))
+		return false;
+
+	/* Instantaneous sequence */
+	if (seq->count == 1)
+	{
+		*result = temporalinst_value_copy(temporalseq_inst_n(seq, 0));
+		return true;
+	}
+
+	/* General case */
+	int n = temporalseq_find_timestamp_hint(seq, t, *hint);
+	*hint = n;
+	TemporalInst *inst1 = temporalseq_inst_n(seq, n);
+	TemporalInst *inst2 = temporalseq_inst_n(seq, n + 1);
+	*result = temporalseq_value_at_timestamp1(inst1, inst2, MOBDB_FLAGS_GET_LINEAR(seq->flags), t);
+	return true;
+}
+
+/*
+ * Values at the timestamps of a timestamp set starting at the position
+ * given by the cursor pos. The timestamps and the segments are traversed
+ * with a single forward cursor each, instead of searching the segment of
+ * every timestamp. On return the cursor is positioned at the first
+ * timestamp after the sequence, which enables a sequence set to call this
+ * function for each of its sequences. The null flags must be initialized
+ * to true by the calling function.
+ */
+void
+temporalseq_values_at_timestampset1(TemporalSeq *seq, TimestampSet *ts,
+	int *pos, Datum *values, bool *nulls)
+{
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	TemporalInst *inst2 = (seq->count == 1) ? inst1 :
+		temporalseq_inst_n(seq, 1);
+	int i = 1, j = *pos;
+	while (j < ts->count)
+	{
+		TimestampTz t = timestampset_time_n(ts, j);
+		if (timestamp_cmp_internal(t, seq->period.upper) > 0)
+			break;
+		if (contains_period_timestamp_internal(&seq->period, t))
+		{
+			/* The upper bound of the sequence ensures that i < seq->count */
+			while (timestamp_cmp_internal(inst2->t, t) < 0)
+			{
+				inst1 = inst2;
+				inst2 = temporalseq_inst_n(seq, ++i);
+			}
+			values[j] = temporalseq_value_at_timestamp1(inst1, inst2, linear, t);
+			nulls[j] = false;
+		}
+		j++;
+	}
+	*pos = j;
+}
+
+void
+temporalseq_values_at_timestampset(TemporalSeq *seq, TimestampSet *ts,
+	Datum *values, bool *nulls)
+{
+	int pos = 0;
+	temporalseq_values_at_timestampset1(seq, ts, &pos, values, nulls);
+}
+
 /* 
  * Restriction to a timestamp.
  * The function supposes that the timestamp t is between inst1->t and inst2->t
@@ -3466,74 +4737,117 @@ temporalseq_minus_timestampset(TemporalSeq *seq, TimestampSet *ts)
 }
 
 /*
- * Restriction to a period.
+ * Restriction to a period that overlaps the sequence. The instants are 
+ * searched from the segment given by the cursor n, which is advanced to the
+ * segment containing the upper bound of the result. Successive calls with 
+ * ordered and disjoint periods thus traverse the instants only once.
  */
-TemporalSeq *
-temporalseq_at_period(TemporalSeq *seq, Period *p)
+static TemporalSeq *
+temporalseq_at_period_cursor(TemporalSeq *seq, Period *p, int *n)
 {
-	/* Bounding box test */
-	if (!overlaps_period_period_internal(&seq->period, p))
-		return NULL;
-
-	/* Instantaneous sequence */
-	if (seq->count == 1)
+	/* Instantaneous sequence or the period contains the sequence */
+	if (seq->count == 1 || contains_period_period_internal(p, &seq->period))
 		return temporalseq_copy(seq);
 
-	/* General case */
-	Period *inter = intersection_period_period_internal(&seq->period, p);
-	/* Intersecting period is instantaneous */
-	if (timestamp_cmp_internal(inter->lower, inter->upper) == 0)
+	/* Compute the intersecting period, which is not empty by hypothesis */
+	Period inter;
+	if (period_cmp_bounds(seq->period.lower, p->lower, true, true,
+		seq->period.lower_inc, p->lower_inc) >= 0)
 	{
-		TemporalInst *inst = temporalseq_at_timestamp(seq, inter->lower);
-		TemporalSeq *result = temporalseq_from_temporalinstarr(&inst, 1,
-			true, true, MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
-		pfree(inst); pfree(inter);
-		return result;		
+		inter.lower = seq->period.lower;
+		inter.lower_inc = seq->period.lower_inc;
 	}
-	
-	int n = temporalseq_find_timestamp(seq, inter->lower);
-	/* If the lower bound of the intersecting period is exclusive */
-	if (n == -1)
-		n = 0;
-	TemporalInst **instants = palloc(sizeof(TemporalInst *) * (seq->count - n));
+	else
+	{
+		inter.lower = p->lower;
+		inter.lower_inc = p->lower_inc;
+	}
+	if (period_cmp_bounds(seq->period.upper, p->upper, false, false,
+		seq->period.upper_inc, p->upper_inc) <= 0)
+	{
+		inter.upper = seq->period.upper;
+		inter.upper_inc = seq->period.upper_inc;
+	}
+	else
+	{
+		inter.upper = p->upper;
+		inter.upper_inc = p->upper_inc;
+	}
+
+	/* Advance the cursor to the segment containing the lower bound */
+	int i = *n;
+	while (i < seq->count - 2 &&
+		timestamp_cmp_internal(temporalseq_inst_n(seq, i + 1)->t, inter.lower) <= 0)
+		i++;
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	TemporalInst *inst1 = temporalseq_inst_n(seq, i);
+	TemporalInst *inst2 = temporalseq_inst_n(seq, i + 1);
 	/* Compute the value at the beginning of the intersecting period */
-	TemporalInst *inst1 = temporalseq_inst_n(seq, n);
-	TemporalInst *inst2 = temporalseq_inst_n(seq, n + 1);
-	instants[0] = temporalseq_at_timestamp1(inst1, inst2, 
-		MOBDB_FLAGS_GET_LINEAR(seq->flags), inter->lower);
-	int k = 1;
-	for (int i = n+2; i < seq->count; i++)
+	Datum value = temporalseq_value_at_timestamp1(inst1, inst2, linear,
+		inter.lower);
+	/* Intersecting period is instantaneous */
+	if (timestamp_cmp_internal(inter.lower, inter.upper) == 0)
 	{
-		/* If the end of the intersecting period is between inst1 and inst2 */
-		if (timestamp_cmp_internal(inst1->t, inter->upper) <= 0 &&
-			timestamp_cmp_internal(inter->upper, inst2->t) <= 0)
-			break;
+		TemporalInst *inst = temporalinst_make(value, inter.lower, 
+			seq->valuetypid);
+		TemporalSeq *result = temporalseq_from_temporalinstarr(&inst, 1,
+			true, true, linear, false);
+		FREE_DATUM(value, seq->valuetypid);
+		pfree(inst);
+		*n = i;
+		return result;
+	}
 
+	TemporalSeqBuilder builder;
+	temporalseq_build_init(&builder, seq->valuetypid, seq->count - i, linear,
+		false);
+	temporalseq_build_append(&builder, value, inter.lower);
+	FREE_DATUM(value, seq->valuetypid);
+	/* Append the instants until the segment containing the upper bound */
+	while (i < seq->count - 2 &&
+		timestamp_cmp_internal(inst2->t, inter.upper) < 0)
+	{
+		i++;
 		inst1 = inst2;
-		inst2 = temporalseq_inst_n(seq, i);
-		/* If the intersecting period contains inst1 */
-		if (timestamp_cmp_internal(inter->lower, inst1->t) <= 0 &&
-			timestamp_cmp_internal(inst1->t, inter->upper) <= 0)
-			instants[k++] = inst1;
+		inst2 = temporalseq_inst_n(seq, i + 1);
+		temporalseq_build_append_inst(&builder, inst1);
 	}
 	/* The last two values of sequences with stepwise interpolation and 
-	   exclusive upper bound must be equal */
-	if (MOBDB_FLAGS_GET_LINEAR(seq->flags) || inter->upper_inc)
-		instants[k++] = temporalseq_at_timestamp1(inst1, inst2, 
-			MOBDB_FLAGS_GET_LINEAR(seq->flags), inter->upper);
-	else
-	{	
-		Datum value = temporalinst_value(instants[k - 1]);
-		instants[k++] = temporalinst_make(value, inter->upper, seq->valuetypid);
+	   exclusive upper bound must be equal. In that case the last value
+	   appended is the one of inst1, either the instant itself or the value
+	   at the beginning of the intersecting period */
+	if (linear || inter.upper_inc)
+	{
+		value = temporalseq_value_at_timestamp1(inst1, inst2, linear,
+			inter.upper);
+		temporalseq_build_append(&builder, value, inter.upper);
+		FREE_DATUM(value, seq->valuetypid);
 	}
+	else
+		temporalseq_build_append(&builder, temporalinst_value(inst1), 
+			inter.upper);
+	*n = i;
 	/* Since by definition the sequence is normalized it is not necessary to
 	   normalize the projection of the sequence to the period */
-	TemporalSeq *result = temporalseq_from_temporalinstarr(instants, k,
-		inter->lower_inc, inter->upper_inc, MOBDB_FLAGS_GET_LINEAR(seq->flags), false);
+	return temporalseq_build_finish(&builder, inter.lower_inc,
+		inter.upper_inc);
+}
 
-	pfree(instants[0]); pfree(instants[k - 1]); pfree(instants); pfree(inter);
-	
-	return result;
+/*
+ * Restriction to a period.
+ */
+TemporalSeq *
+temporalseq_at_period(TemporalSeq *seq, Period *p)
+{
+	/* Bounding box test */
+	if (!overlaps_period_period_internal(&seq->period, p))
+		return NULL;
+
+	int n = temporalseq_find_timestamp(seq, Max(seq->period.lower, p->lower));
+	/* If the lower bound of the sequence is exclusive */
+	if (n == -1)
+		n = 0;
+	return temporalseq_at_period_cursor(seq, p, &n);
 }
 
 /*
@@ -3580,6 +4894,43 @@ temporalseq_minus_period(TemporalSeq *seq, Period *p)
 	return result;
 }
 
+/*
+ * Restriction to the periods of a periodset starting from the one at 
+ * position from. The periods and the instants of the sequence are traversed
+ * together in a single merge walk. On return from is the position of the
+ * first period that may overlap the sequences following this one in a
+ * TemporalS.
+ */
+int
+temporalseq_at_periodset_walk(TemporalSeq **result, TemporalSeq *seq, 
+	PeriodSet *ps, int *from)
+{
+	int i = 0, j = *from, k = 0;
+	while (j < ps->count)
+	{
+		Period *p = periodset_per_n(ps, j);
+		/* The period is before the sequence */
+		if (period_cmp_bounds(p->upper, seq->period.lower, false, true,
+				p->upper_inc, seq->period.lower_inc) < 0)
+		{
+			j++;
+			continue;
+		}
+		/* The period and the remaining ones are after the sequence */
+		if (period_cmp_bounds(seq->period.upper, p->lower, false, true,
+				seq->period.upper_inc, p->lower_inc) < 0)
+			break;
+		result[k++] = temporalseq_at_period_cursor(seq, p, &i);
+		/* The period ends after the sequence */
+		if (period_cmp_bounds(seq->period.upper, p->upper, false, false,
+				seq->period.upper_inc, p->upper_inc) <= 0)
+			break;
+		j++;
+	}
+	*from = j;
+	return k;
+}
+
 /*
  * Restriction to a periodset.
  * This function is called for each sequence of a TemporalS.
@@ -3606,17 +4957,7 @@ temporalseq_at_periodset1(TemporalSeq **result, TemporalSeq *seq, PeriodSet *ps)
 	/* General case */
 	int n;
 	periodset_find_timestamp(ps, seq->period.lower, &n);
-	int k = 0;
-	for (int i = n; i < ps->count; i++)
-	{
-		p = periodset_per_n(ps, i);
-		TemporalSeq *seq1 = temporalseq_at_period(seq, p);
-		if (seq1 != NULL)
-			result[k++] = seq1;
-		if (timestamp_cmp_internal(seq->period.upper, p->upper) < 0)
-			break;
-	}
-	return k;
+	return temporalseq_at_periodset_walk(result, seq, ps, &n);
 }
 
 TemporalSeq **
@@ -3649,45 +4990,65 @@ temporalseq_at_periodset(TemporalSeq *seq, PeriodSet *ps)
 }
 
 /*
- * Restriction to the complement of a periodset.
+ * Restriction to the complement of the periods of a periodset starting from
+ * the one at position from. The gaps between the periods are computed while
+ * traversing the periods and the instants of the sequence together in a
+ * single merge walk. On return from is the position of the first period 
+ * that may overlap the sequences following this one in a TemporalS.
+ * The sequence can be split at most into (count + 1) sequences
+ *		|----------------------|
+ *			|---| |---| |---|
  */
 
 int
-temporalseq_minus_periodset1(TemporalSeq **result, TemporalSeq *seq, PeriodSet *ps, 
-	int from, int count)
-{
-	/* The sequence can be split at most into (count + 1) sequences
-		|----------------------|
-			|---| |---| |---|
-	*/
-	TemporalSeq *curr = temporalseq_copy(seq);
-	int k = 0;
-	for (int i = from; i < count; i++)
-	{
-		Period *p1 = periodset_per_n(ps, i);
-		/* If the remaining periods are to the left of the current period */
-		if (period_cmp_bounds(curr->period.upper, p1->lower, false, true,
-				curr->period.upper_inc, p1->lower_inc) < 0)
+temporalseq_minus_periodset1(TemporalSeq **result, TemporalSeq *seq, 
+	PeriodSet *ps, int *from)
+{
+	/* Lower bound of the current gap */
+	TimestampTz lower = seq->period.lower;
+	bool lower_inc = seq->period.lower_inc;
+	Period gap;
+	int i = 0, j = *from, k = 0;
+	while (j < ps->count)
+	{
+		Period *p = periodset_per_n(ps, j);
+		/* The period is before the sequence */
+		if (period_cmp_bounds(p->upper, seq->period.lower, false, true,
+				p->upper_inc, seq->period.lower_inc) < 0)
 		{
-			result[k++] = curr;
-			break;
+			j++;
+			continue;
 		}
-		TemporalSeq *minus[2];
-		int countminus = temporalseq_minus_period1(minus, curr, p1);
-		pfree(curr);
-		/* minus can have from 0 to 2 periods */
-		if (countminus == 0)
+		/* The period and the remaining ones are after the sequence */
+		if (period_cmp_bounds(seq->period.upper, p->lower, false, true,
+				seq->period.upper_inc, p->lower_inc) < 0)
 			break;
-		else if (countminus == 1)
-			curr = minus[0];
-		else /* countminus == 2 */
+		/* The gap before the period is not empty */
+		if (period_cmp_bounds(lower, p->lower, true, false,
+				lower_inc, ! p->lower_inc) <= 0)
 		{
-			result[k++] = minus[0];
-			curr = minus[1];
+			period_set(&gap, lower, p->lower, lower_inc, ! p->lower_inc);
+			result[k++] = temporalseq_at_period_cursor(seq, &gap, &i);
 		}
-		/* There are no more periods left */
-		if (i == count - 1)
-			result[k++] = curr;
+		/* The period covers the rest of the sequence */
+		if (period_cmp_bounds(seq->period.upper, p->upper, false, false,
+				seq->period.upper_inc, p->upper_inc) <= 0)
+		{
+			*from = j;
+			return k;
+		}
+		lower = p->upper;
+		lower_inc = ! p->upper_inc;
+		j++;
+	}
+	*from = j;
+	/* The gap after the last period */
+	if (period_cmp_bounds(lower, seq->period.upper, true, false,
+			lower_inc, seq->period.upper_inc) <= 0)
+	{
+		period_set(&gap, lower, seq->period.upper, lower_inc, 
+			seq->period.upper_inc);
+		result[k++] = temporalseq_at_period_cursor(seq, &gap, &i);
 	}
 	return k;
 }
@@ -3713,8 +5074,9 @@ temporalseq_minus_periodset(TemporalSeq *seq, PeriodSet *ps)
 
 	/* General case */
 	TemporalSeq **sequences = palloc(sizeof(TemporalSeq *) * (ps->count + 1));
-	int count = temporalseq_minus_periodset1(sequences, seq, ps,
-		0, ps->count);
+	int n;
+	periodset_find_timestamp(ps, seq->period.lower, &n);
+	int count = temporalseq_minus_periodset1(sequences, seq, ps, &n);
 	if (count == 0)
 	{
 		pfree(sequences);
@@ -3780,12 +5142,15 @@ double
 tstepwseq_integral(TemporalSeq *seq)
 {
 	double result = 0;
+	bool isint = seq->valuetypid == INT4OID;
 	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
 	for (int i = 1; i < seq->count; i++)
 	{
 		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
-		result += datum_double(temporalinst_value(inst1), inst1->valuetypid) *
-			(double) (inst2->t - inst1->t);
+		Datum value1 = *temporalinst_value_ptr(inst1);
+		double value = isint ? (double) DatumGetInt32(value1) :
+			DatumGetFloat8(value1);
+		result += value * (double) (inst2->t - inst1->t);
 		inst1 = inst2;
 	}
 	return result;
@@ -3798,15 +5163,14 @@ tlinearseq_integral(TemporalSeq *seq)
 {
 	double result = 0;
 	TemporalInst *inst1 = temporalseq_inst_n(seq, 0);
+	double value1 = DatumGetFloat8(*temporalinst_value_ptr(inst1));
 	for (int i = 1; i < seq->count; i++)
 	{
 		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
-		double min = Min(DatumGetFloat8(temporalinst_value(inst1)), 
-			DatumGetFloat8(temporalinst_value(inst2)));
-		double max = Max(DatumGetFloat8(temporalinst_value(inst1)), 
-			DatumGetFloat8(temporalinst_value(inst2)));
-		result += (max + min) * (double) (inst2->t - inst1->t) / 2.0;
+		double value2 = DatumGetFloat8(*temporalinst_value_ptr(inst2));
+		result += (value1 + value2) * (double) (inst2->t - inst1->t) / 2.0;
 		inst1 = inst2;
+		value1 = value2;
 	}
 	return result;
 }
@@ -3814,12 +5178,86 @@ tlinearseq_integral(TemporalSeq *seq)
 double
 tnumberseq_integral(TemporalSeq *seq)
 {
+	TemporalSeqSummary *summary = temporalseq_summary_ptr(seq);
+	if (summary != NULL)
+		return summary->integral[summary->count];
 	if (MOBDB_FLAGS_GET_LINEAR(seq->flags))
 		return tlinearseq_integral(seq);
 	else
 		return tstepwseq_integral(seq);
 }
 
+/* Integral of a temporal number between the instants from and to */
+
+static double
+tnumberseq_integral_scan(TemporalSeq *seq, int from, int to)
+{
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	double result = 0;
+	TemporalInst *inst1 = temporalseq_inst_n(seq, from);
+	for (int i = from + 1; i <= to; i++)
+	{
+		TemporalInst *inst2 = temporalseq_inst_n(seq, i);
+		result += tnumberseq_segment_integral(inst1, inst2, linear);
+		inst1 = inst2;
+	}
+	return result;
+}
+
+/* 
+ * Integral of a temporal number between the instants from and to. When
+ * the sequence has a block summary the integral is obtained from the
+ * integrals of the blocks containing both instants.
+ */
+static double
+tnumberseq_integral_instants(TemporalSeq *seq, int from, int to)
+{
+	TemporalSeqSummary *summary = temporalseq_summary_ptr(seq);
+	if (summary == NULL || to - from <= SUMMARY_BLOCK_SIZE)
+		return tnumberseq_integral_scan(seq, from, to);
+	int block1 = from / SUMMARY_BLOCK_SIZE;
+	int block2 = to / SUMMARY_BLOCK_SIZE;
+	return summary->integral[block2] - summary->integral[block1] +
+		tnumberseq_integral_scan(seq, block2 * SUMMARY_BLOCK_SIZE, to) -
+		tnumberseq_integral_scan(seq, block1 * SUMMARY_BLOCK_SIZE, from);
+}
+
+/* 
+ * Integral of a temporal number restricted to a period that overlaps it,
+ * which is equal to the integral of the restriction of the sequence to the
+ * period without constructing it
+ */
+double
+tnumberseq_integral_period(TemporalSeq *seq, Period *p)
+{
+	TimestampTz lower = Max(seq->period.lower, p->lower);
+	TimestampTz upper = Min(seq->period.upper, p->upper);
+	if (seq->count == 1 || timestamp_cmp_internal(lower, upper) >= 0)
+		return 0;
+	int n1 = temporalseq_find_timestamp(seq, lower);
+	/* If the lower bound of the sequence is exclusive */
+	if (n1 == -1)
+		n1 = 0;
+	int n2 = temporalseq_find_timestamp(seq, upper);
+	/* If the upper bound of the sequence is exclusive */
+	if (n2 == -1)
+		n2 = seq->count - 2;
+	bool linear = MOBDB_FLAGS_GET_LINEAR(seq->flags);
+	TemporalInst *inst1 = temporalseq_inst_n(seq, n1);
+	TemporalInst *inst2 = temporalseq_inst_n(seq, n1 + 1);
+	if (n1 == n2)
+		return tnumberseq_segment_integral_part(inst1, inst2, linear,
+			lower, upper);
+	double result = tnumberseq_segment_integral_part(inst1, inst2, linear,
+		lower, inst2->t);
+	result += tnumberseq_integral_instants(seq, n1 + 1, n2);
+	inst1 = temporalseq_inst_n(seq, n2);
+	inst2 = temporalseq_inst_n(seq, n2 + 1);
+	result += tnumberseq_segment_integral_part(inst1, inst2, linear,
+		inst1->t, upper);
+	return result;
+}
+
 /* Time-weighted average of temporal numbers */
 
 double
@@ -3836,6 +5274,27 @@ tnumberseq_twavg(TemporalSeq *seq)
 	return result;
 }
 
+/* 
+ * Time-weighted average of a temporal number restricted to a period that 
+ * overlaps it
+ */
+double
+tnumberseq_twavg_period(TemporalSeq *seq, Period *p)
+{
+	TimestampTz lower = Max(seq->period.lower, p->lower);
+	TimestampTz upper = Min(seq->period.upper, p->upper);
+	double duration = (double) (upper - lower);
+	if (duration == 0)
+	{
+		/* Instantaneous intersection */
+		TemporalInst *inst = temporalseq_at_timestamp(seq, lower);
+		double result = tnumberinst_double(inst);
+		pfree(inst);
+		return result;
+	}
+	return tnumberseq_integral_period(seq, p) / duration;
+}
+
 /*****************************************************************************
  * Functions for defining B-tree index
  * The functions assume that the arguments are of the same temptypid
@@ -3848,8 +5307,11 @@ tnumberseq_twavg(TemporalSeq *seq)
 bool
 temporalseq_eq(TemporalSeq *seq1, TemporalSeq *seq2)
 {
-	/* If number of sequences, flags, or periods are not equal */
-	if (seq1->count != seq2->count || seq1->flags != seq2->flags ||
+	/* If number of sequences, flags, or periods are not equal. The flags
+	   telling whether the sequences have a block summary and the version of
+	   their format are ignored */
+	if (seq1->count != seq2->count || 
+		(seq1->flags | 0x180) != (seq2->flags | 0x180) ||
 			! period_eq_internal(&seq1->period, &seq2->period)) 
 		return false;
 
@@ -3858,6 +5320,10 @@ temporalseq_eq(TemporalSeq *seq1, TemporalSeq *seq2)
 	void *box2 = temporalseq_bbox_ptr(seq2);
 	if (! temporal_bbox_eq(seq1->valuetypid, box1, box2))
 		return false;
+
+	/* If the instants have the same representation */
+	if (temporal_identical(seq1, seq2))
+		return true;
 	
 	/* Compare the composing instants */
 	for (int i = 0; i < seq1->count; i++)
@@ -3883,6 +5349,10 @@ temporalseq_cmp(TemporalSeq *seq1, TemporalSeq *seq2)
 	if (result)
 		return result;
 
+	/* If the instants have the same representation */
+	if (temporal_identical(seq1, seq2))
+		return 0;
+
 	/* Compare composing instants */
 	int count = Min(seq1->count, seq2->count);
 	for (int i = 0; i < count; i++)
@@ -3899,9 +5369,9 @@ temporalseq_cmp(TemporalSeq *seq1, TemporalSeq *seq2)
 	else if (seq2->count < seq1->count) /* seq2 has less instants than seq1 */
 		return 1;
 	/* Compare flags */
-	if (seq1->flags < seq2->flags)
+	if ((seq1->flags | 0x100) < (seq2->flags | 0x100))
 		return -1;
-	if (seq1->flags > seq2->flags)
+	if ((seq1->flags | 0x100) > (seq2->flags | 0x100))
 		return 1;
 	/* The two values are equal */
 	return 0;
@@ -24,8 +24,21 @@
 #include "time_analyze.h"
 
 #include <assert.h>
+#include <access/heapam.h>
+#include <access/htup_details.h>
+#include <catalog/indexing.h>
 #include <catalog/pg_operator.h>
+#include <catalog/pg_statistic.h>
 #include <commands/vacuum.h>
+#include <miscadmin.h>
+#include <storage/bufmgr.h>
+#include <utils/acl.h>
+#include <utils/array.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+#include <utils/snapmgr.h>
+#include <utils/syscache.h>
 
 #include "timestampset.h"
 #include "period.h"
@@ -405,4 +418,440 @@ periodset_analyze(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(true);
 }
 
+/*****************************************************************************/
+ * Incremental refresh of the period histograms
+ *
+ * On append-only tables, e.g., tables of observations, the rows inserted
+ * since the last ANALYZE are stored in the blocks after the number of
+ * blocks recorded in pg_class.relpages by ANALYZE. The function
+ * mergePeriodStats reads these blocks and merges the bounding periods of
+ * their values into the period bounds and length histograms of the columns
+ * of the table, so that the estimates for the most recent time ranges stay
+ * accurate until the next ANALYZE. The histograms are merged as weighted
+ * samples: each value of an existing histogram stands for an equal share of
+ * the rows of the table, and each row read stands for itself. The relpages
+ * and reltuples of the relation are then advanced so that the next call
+ * only reads the blocks appended in between.
+ *****************************************************************************/
+
+/*
+ * Period bound or length of a merged histogram and number of rows it stands for
+ */
+typedef struct
+{
+	PeriodBound bound;
+	double		weight;
+} WeightedBound;
+
+typedef struct
+{
+	float8		length;
+	double		weight;
+} WeightedLength;
+
+/*
+ * Periods read from the appended blocks for a column having a period
+ * bounds histogram
+ */
+typedef struct
+{
+	AttrNumber	attnum;			/* Number of the column */
+	Oid			typid;			/* Type of the column */
+	int			nulls;			/* Number of null values read */
+	int			count;			/* Number of periods read */
+	int			maxcount;		/* Number of elements allocated */
+	PeriodBound *lowers;
+	PeriodBound *uppers;
+	float8	   *lengths;
+} PeriodStatsMerge;
+
+static int
+weighted_bound_cmp(const void *a1, const void *a2)
+{
+	const WeightedBound *b1 = (const WeightedBound *) a1;
+	const WeightedBound *b2 = (const WeightedBound *) a2;
+	return period_bound_qsort_cmp(&b1->bound, &b2->bound);
+}
+
+static int
+weighted_length_cmp(const void *a1, const void *a2)
+{
+	const WeightedLength *l1 = (const WeightedLength *) a1;
+	const WeightedLength *l2 = (const WeightedLength *) a2;
+	return float8_qsort_cmp(&l1->length, &l2->length);
+}
+
+/*
+ * Returns in the last argument the positions of the num_hist evenly-spaced
+ * quantiles of the sorted weighted values, the first and last ones being
+ * the first and last values
+ */
+static void
+weighted_quantiles(const double *weights, int count, int num_hist, int *pos)
+{
+	double total = 0, cum;
+	int i, j;
+	for (i = 0; i < count; i++)
+		total += weights[i];
+	j = 0;
+	cum = weights[0];
+	for (i = 0; i < num_hist; i++)
+	{
+		double target = total * i / (num_hist - 1);
+		while (j < count - 1 && cum < target)
+			cum += weights[++j];
+		pos[i] = j;
+	}
+	pos[num_hist - 1] = count - 1;
+}
+
+/*
+ * Merges the periods read into the period bounds histogram given by the
+ * values of the slot, each of which stands for oldweight rows
+ */
+static ArrayType *
+period_bounds_hist_merge(Datum *values, int nvalues, double oldweight,
+	const PeriodStatsMerge *merge, double newweight, int num_bins)
+{
+	int count = nvalues + merge->count, num_hist, i;
+	WeightedBound *lowers = palloc(sizeof(WeightedBound) * count);
+	WeightedBound *uppers = palloc(sizeof(WeightedBound) * count);
+	double *weights = palloc(sizeof(double) * count);
+	PeriodBound *hist_lowers;
+	int *pos;
+	Datum *hist;
+
+	for (i = 0; i < nvalues; i++)
+	{
+		period_deserialize(DatumGetPeriod(values[i]), &lowers[i].bound,
+			&uppers[i].bound);
+		lowers[i].weight = uppers[i].weight = oldweight;
+	}
+	for (i = 0; i < merge->count; i++)
+	{
+		lowers[nvalues + i].bound = merge->lowers[i];
+		uppers[nvalues + i].bound = merge->uppers[i];
+		lowers[nvalues + i].weight = uppers[nvalues + i].weight = newweight;
+	}
+	qsort(lowers, (size_t) count, sizeof(WeightedBound), weighted_bound_cmp);
+	qsort(uppers, (size_t) count, sizeof(WeightedBound), weighted_bound_cmp);
+
+	num_hist = Min(count, num_bins + 1);
+	pos = palloc(sizeof(int) * num_hist);
+	hist_lowers = palloc(sizeof(PeriodBound) * num_hist);
+	hist = palloc(sizeof(Datum) * num_hist);
+	/*
+	 * Since both bounds of a value have the same weight, the quantiles of
+	 * the lower bounds are not after those of the upper bounds
+	 */
+	for (i = 0; i < count; i++)
+		weights[i] = lowers[i].weight;
+	weighted_quantiles(weights, count, num_hist, pos);
+	for (i = 0; i < num_hist; i++)
+		hist_lowers[i] = lowers[pos[i]].bound;
+	for (i = 0; i < count; i++)
+		weights[i] = uppers[i].weight;
+	weighted_quantiles(weights, count, num_hist, pos);
+	for (i = 0; i < num_hist; i++)
+	{
+		const PeriodBound *upper = &uppers[pos[i]].bound;
+		hist[i] = PointerGetDatum(period_make(hist_lowers[i].val, upper->val,
+			hist_lowers[i].inclusive, upper->inclusive));
+	}
+	ArrayType *result = construct_array(hist, num_hist, type_oid(T_PERIOD),
+		sizeof(Period), false, 'd');
+	pfree(lowers); pfree(uppers); pfree(weights); pfree(pos);
+	pfree(hist_lowers); pfree(hist);
+	return result;
+}
+
+/*
+ * Merges the lengths of the periods read into the period length histogram
+ * given by the values of the slot, each of which stands for oldweight rows
+ */
+static ArrayType *
+period_length_hist_merge(Datum *values, int nvalues, double oldweight,
+	const PeriodStatsMerge *merge, double newweight, int num_bins)
+{
+	int count = nvalues + merge->count, num_hist, i;
+	WeightedLength *lengths = palloc(sizeof(WeightedLength) * count);
+	double *weights = palloc(sizeof(double) * count);
+	int *pos;
+	Datum *hist;
+
+	for (i = 0; i < nvalues; i++)
+	{
+		lengths[i].length = DatumGetFloat8(values[i]);
+		lengths[i].weight = oldweight;
+	}
+	for (i = 0; i < merge->count; i++)
+	{
+		lengths[nvalues + i].length = merge->lengths[i];
+		lengths[nvalues + i].weight = newweight;
+	}
+	qsort(lengths, (size_t) count, sizeof(WeightedLength), weighted_length_cmp);
+
+	num_hist = Min(count, num_bins + 1);
+	pos = palloc(sizeof(int) * num_hist);
+	hist = palloc(sizeof(Datum) * num_hist);
+	for (i = 0; i < count; i++)
+		weights[i] = lengths[i].weight;
+	weighted_quantiles(weights, count, num_hist, pos);
+	for (i = 0; i < num_hist; i++)
+		hist[i] = Float8GetDatum(lengths[pos[i]].length);
+	ArrayType *result = construct_array(hist, num_hist, FLOAT8OID,
+		sizeof(float8), FLOAT8PASSBYVAL, 'd');
+	pfree(lengths); pfree(weights); pfree(pos); pfree(hist);
+	return result;
+}
+
+/*
+ * Returns the slot of the statistics tuple having the kind, or -1
+ */
+static int
+stats_slot_index(HeapTuple statstuple, int16 kind)
+{
+	Form_pg_statistic form = (Form_pg_statistic) GETSTRUCT(statstuple);
+	for (int i = 0; i < STATISTIC_NUM_SLOTS; i++)
+	{
+		if ((&form->stakind1)[i] == kind)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Adds the bounding period of a value read from the appended blocks
+ */
+static void
+period_stats_merge_add(PeriodStatsMerge *merge, Datum value)
+{
+	Period p, *period;
+	PeriodBound lower, upper;
+
+	if (merge->typid == type_oid(T_PERIOD))
+		period = DatumGetPeriod(value);
+	else if (merge->typid == type_oid(T_TIMESTAMPSET))
+		period = timestampset_bbox(DatumGetTimestampSet(value));
+	else if (merge->typid == type_oid(T_PERIODSET))
+		period = periodset_bbox(DatumGetPeriodSet(value));
+	else
+	{
+		temporal_period_slice(value, &p);
+		period = &p;
+	}
+	period_deserialize(period, &lower, &upper);
+
+	if (merge->count == merge->maxcount)
+	{
+		merge->maxcount *= 2;
+		merge->lowers = repalloc(merge->lowers, sizeof(PeriodBound) * merge->maxcount);
+		merge->uppers = repalloc(merge->uppers, sizeof(PeriodBound) * merge->maxcount);
+		merge->lengths = repalloc(merge->lengths, sizeof(float8) * merge->maxcount);
+	}
+	merge->lowers[merge->count] = lower;
+	merge->uppers[merge->count] = upper;
+	merge->lengths[merge->count] = period_to_secs(upper.val, lower.val);
+	merge->count++;
+}
+
+/*
+ * Replaces the period histograms and the null fraction of the statistics
+ * of the column by the ones merged with the periods read
+ */
+static void
+period_stats_merge_update(Relation rel, Relation sd,
+	const PeriodStatsMerge *merge, double scale)
+{
+	Datum values[Natts_pg_statistic];
+	bool nulls[Natts_pg_statistic];
+	bool replaces[Natts_pg_statistic];
+	AttStatsSlot sslot;
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(rel),
+		merge->attnum - 1);
+	int num_bins = attr->attstattarget < 0 ? default_statistics_target :
+		attr->attstattarget;
+
+	HeapTuple statstuple = SearchSysCache3(STATRELATTINH,
+		ObjectIdGetDatum(RelationGetRelid(rel)),
+		Int16GetDatum(merge->attnum), BoolGetDatum(false));
+	if (! HeapTupleIsValid(statstuple))
+		return;
+	Form_pg_statistic form = (Form_pg_statistic) GETSTRUCT(statstuple);
+	int bounds_slot = stats_slot_index(statstuple,
+		STATISTIC_KIND_PERIOD_BOUNDS_HISTOGRAM);
+	int length_slot = stats_slot_index(statstuple,
+		STATISTIC_KIND_PERIOD_LENGTH_HISTOGRAM);
+
+	/* Rows of the table without the rows read, which are weighted by scale */
+	double oldrows = Max(rel->rd_rel->reltuples, 0);
+	double oldnotnull = oldrows * (1.0 - form->stanullfrac);
+	double newrows = (merge->count + merge->nulls) * scale;
+
+	memset(nulls, false, sizeof(nulls));
+	memset(replaces, false, sizeof(replaces));
+	values[Anum_pg_statistic_stanullfrac - 1] = Float4GetDatum((float4)
+		((oldrows * form->stanullfrac + merge->nulls * scale) /
+		Max(oldrows + newrows, 1)));
+	replaces[Anum_pg_statistic_stanullfrac - 1] = true;
+	if (merge->count > 0)
+	{
+		get_attstatsslot(&sslot, statstuple,
+			STATISTIC_KIND_PERIOD_BOUNDS_HISTOGRAM, InvalidOid,
+			ATTSTATSSLOT_VALUES);
+		if (sslot.nvalues + merge->count >= 2)
+		{
+			values[Anum_pg_statistic_stavalues1 - 1 + bounds_slot] =
+				PointerGetDatum(period_bounds_hist_merge(sslot.values,
+					sslot.nvalues, oldnotnull / Max(sslot.nvalues, 1),
+					merge, scale, num_bins));
+			replaces[Anum_pg_statistic_stavalues1 - 1 + bounds_slot] = true;
+		}
+		free_attstatsslot(&sslot);
+	}
+	if (merge->count > 0 && length_slot >= 0)
+	{
+		get_attstatsslot(&sslot, statstuple,
+			STATISTIC_KIND_PERIOD_LENGTH_HISTOGRAM, InvalidOid,
+			ATTSTATSSLOT_VALUES);
+		if (sslot.nvalues + merge->count >= 2)
+		{
+			values[Anum_pg_statistic_stavalues1 - 1 + length_slot] =
+				PointerGetDatum(period_length_hist_merge(sslot.values,
+					sslot.nvalues, oldnotnull / Max(sslot.nvalues, 1),
+					merge, scale, num_bins));
+			replaces[Anum_pg_statistic_stavalues1 - 1 + length_slot] = true;
+		}
+		free_attstatsslot(&sslot);
+	}
+
+	HeapTuple newtuple = heap_modify_tuple(statstuple, RelationGetDescr(sd),
+		values, nulls, replaces);
+	CatalogTupleUpdate(sd, &newtuple->t_self, newtuple);
+	heap_freetuple(newtuple);
+	ReleaseSysCache(statstuple);
+}
+
+PG_FUNCTION_INFO_V1(merge_period_stats);
+/**
+ * @brief Merge the periods of the rows appended to the table since the
+ * 		last ANALYZE into the period histograms of its columns
+ * @return Number of rows read
+ * @note When more than maxblocks blocks have been appended, only the last
+ * 		maxblocks ones are read and their rows stand for those of all the
+ * 		appended blocks
+ */
+PGDLLEXPORT Datum
+merge_period_stats(PG_FUNCTION_ARGS)
+{
+	Oid relid = PG_GETARG_OID(0);
+	int32 maxblocks = PG_GETARG_INT32(1);
+	if (maxblocks <= 0)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The maximum number of blocks must be strictly positive")));
+
+	/* Same lock as ANALYZE, which conflicts with concurrent ANALYZE */
+	Relation rel = heap_open(relid, ShareUpdateExclusiveLock);
+	if (rel->rd_rel->relkind != RELKIND_RELATION)
+		ereport(ERROR, (errcode(ERRCODE_WRONG_OBJECT_TYPE),
+			errmsg("\"%s\" is not a table", RelationGetRelationName(rel))));
+	if (! pg_class_ownercheck(relid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER, OBJECT_TABLE,
+			RelationGetRelationName(rel));
+
+	/* Collect the columns having a period bounds histogram */
+	TupleDesc tupdesc = RelationGetDescr(rel);
+	PeriodStatsMerge *merges = palloc0(sizeof(PeriodStatsMerge) * tupdesc->natts);
+	int nmerges = 0;
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		if (attr->attisdropped || (attr->atttypid != type_oid(T_PERIOD) &&
+			attr->atttypid != type_oid(T_TIMESTAMPSET) &&
+			attr->atttypid != type_oid(T_PERIODSET) &&
+			! temporal_type_oid(attr->atttypid)))
+			continue;
+		HeapTuple statstuple = SearchSysCache3(STATRELATTINH,
+			ObjectIdGetDatum(relid), Int16GetDatum(attr->attnum),
+			BoolGetDatum(false));
+		if (! HeapTupleIsValid(statstuple))
+			continue;
+		bool found = stats_slot_index(statstuple,
+			STATISTIC_KIND_PERIOD_BOUNDS_HISTOGRAM) >= 0;
+		ReleaseSysCache(statstuple);
+		if (! found)
+			continue;
+		PeriodStatsMerge *merge = &merges[nmerges++];
+		merge->attnum = attr->attnum;
+		merge->typid = attr->atttypid;
+		merge->maxcount = 64;
+		merge->lowers = palloc(sizeof(PeriodBound) * merge->maxcount);
+		merge->uppers = palloc(sizeof(PeriodBound) * merge->maxcount);
+		merge->lengths = palloc(sizeof(float8) * merge->maxcount);
+	}
+	if (nmerges == 0)
+		ereport(ERROR, (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+			errmsg("Relation \"%s\" has no period histograms",
+				RelationGetRelationName(rel)),
+			errhint("Run ANALYZE on the relation.")));
+
+	/* Read the blocks appended since the last ANALYZE or merge */
+	BlockNumber nblocks = RelationGetNumberOfBlocks(rel);
+	BlockNumber oldblocks = (BlockNumber) rel->rd_rel->relpages;
+	int64 rows = 0;
+	double scale = 1.0;
+	if (nblocks > oldblocks)
+	{
+		BlockNumber startblock = oldblocks;
+		if (nblocks - oldblocks > (BlockNumber) maxblocks)
+		{
+			startblock = nblocks - maxblocks;
+			scale = (double) (nblocks - oldblocks) / maxblocks;
+		}
+		HeapScanDesc scan = heap_beginscan_strat(rel, GetActiveSnapshot(),
+			0, NULL, true, false);
+		heap_setscanlimits(scan, startblock, nblocks - startblock);
+		/* The values detoasted for a row are freed before reading the next 
+		 * one, the arrays of the merges being enlarged in their own context */
+		MemoryContext rowcontext = AllocSetContextCreate(CurrentMemoryContext,
+			"period stats merge row", ALLOCSET_DEFAULT_SIZES);
+		HeapTuple tuple;
+		while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+		{
+			CHECK_FOR_INTERRUPTS();
+			MemoryContext oldcontext = MemoryContextSwitchTo(rowcontext);
+			for (int i = 0; i < nmerges; i++)
+			{
+				bool isnull;
+				Datum value = heap_getattr(tuple, merges[i].attnum, tupdesc,
+					&isnull);
+				if (isnull)
+					merges[i].nulls++;
+				else
+					period_stats_merge_add(&merges[i], value);
+			}
+			MemoryContextSwitchTo(oldcontext);
+			MemoryContextReset(rowcontext);
+			rows++;
+		}
+		heap_endscan(scan);
+		MemoryContextDelete(rowcontext);
+
+		/* Merge into the statistics of the columns */
+		Relation sd = heap_open(StatisticRelationId, RowExclusiveLock);
+		for (int i = 0; i < nmerges; i++)
+			period_stats_merge_update(rel, sd, &merges[i], scale);
+		heap_close(sd, RowExclusiveLock);
+
+		/* Advance the blocks and rows covered by the statistics */
+		vac_update_relstats(rel, nblocks,
+			Max(rel->rd_rel->reltuples, 0) + rows * scale,
+			rel->rd_rel->relallvisible, rel->rd_rel->relhasindex,
+			InvalidTransactionId, InvalidMultiXactId, true);
+	}
+
+	heap_close(rel, NoLock);
+	PG_RETURN_INT64(rows);
+}
+
 /*****************************************************************************/
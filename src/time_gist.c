@@ -23,6 +23,7 @@
 #include "timeops.h"
 #include "temporal.h"
 #include "oidcache.h"
+#include "temporal_util.h"
 
 /*****************************************************************************/
 
@@ -31,6 +32,11 @@
  */
 #define LIMIT_RATIO  0.3
 
+/*
+ * Maximum number of periods of the keys of periodset indexes.
+ */
+#define GIST_MAX_PERIODS  8
+
 /*
  * Context for gist_period_consider_split.
  */
@@ -522,6 +528,119 @@ gist_period_double_sorting_split(GistEntryVector *entryvec,
 	v->spl_rdatum = PointerGetDatum(right_period);
 }
 
+/*****************************************************************************
+ * Keys of periodset indexes
+ * The key of a period set is a period set with at most GIST_MAX_PERIODS
+ * periods that covers it. Sparse period sets such as schedules are thus not
+ * collapsed into their bounding period, which would match most queries.
+ *****************************************************************************/
+
+/*
+ * Gap between two consecutive periods of a period set
+ */
+typedef struct
+{
+	int			index;			/* Position of the period before the gap */
+	double		gap;			/* Duration of the gap in seconds */
+} PeriodGap;
+
+static int
+period_gap_cmp(const void *i1, const void *i2)
+{
+	const PeriodGap *g1 = (const PeriodGap *) i1;
+	const PeriodGap *g2 = (const PeriodGap *) i2;
+	if (g1->gap != g2->gap)
+		return (g1->gap > g2->gap) ? -1 : 1;
+	return g1->index - g2->index;
+}
+
+/*
+ * Reduce a period set to maxcount periods by merging greedily the periods
+ * separated by the smallest gaps, that is, by keeping only the maxcount - 1
+ * largest gaps. The result covers the period set and has the same bounding
+ * period.
+ */
+static PeriodSet *
+periodset_reduce(PeriodSet *ps, int maxcount)
+{
+	int count = ps->count;
+	PeriodGap *gaps = palloc(sizeof(PeriodGap) * (count - 1));
+	for (int i = 0; i < count - 1; i++)
+	{
+		gaps[i].index = i;
+		gaps[i].gap = period_to_secs(periodset_per_n(ps, i + 1)->lower,
+			periodset_per_n(ps, i)->upper);
+	}
+	qsort(gaps, (size_t) (count - 1), sizeof(PeriodGap), period_gap_cmp);
+	bool *keep = palloc0(sizeof(bool) * (count - 1));
+	for (int i = 0; i < maxcount - 1; i++)
+		keep[gaps[i].index] = true;
+
+	PeriodSetBuilder builder;
+	periodset_build_init(&builder, maxcount);
+	Period *first = periodset_per_n(ps, 0);
+	for (int i = 0; i < count; i++)
+	{
+		if (i < count - 1 && ! keep[i])
+			continue;
+		Period *last = periodset_per_n(ps, i);
+		periodset_build_append(&builder, first->lower, last->upper,
+			first->lower_inc, last->upper_inc);
+		if (i < count - 1)
+			first = periodset_per_n(ps, i + 1);
+	}
+	pfree(gaps); pfree(keep);
+	return periodset_build_finish(&builder);
+}
+
+/*
+ * Returns the key covering the periods of the keys given in the array
+ */
+static PeriodSet *
+periodset_keys_union(PeriodSet **keys, int count)
+{
+	int totalcount = 0;
+	for (int i = 0; i < count; i++)
+		totalcount += keys[i]->count;
+	Period **periods = palloc(sizeof(Period *) * totalcount);
+	int k = 0;
+	for (int i = 0; i < count; i++)
+		for (int j = 0; j < keys[i]->count; j++)
+			periods[k++] = periodset_per_n(keys[i], j);
+	periodarr_sort(periods, totalcount);
+
+	/* The builder merges the overlapping and adjacent periods */
+	PeriodSetBuilder builder;
+	periodset_build_init(&builder, totalcount);
+	for (int i = 0; i < totalcount; i++)
+		periodset_build_append(&builder, periods[i]->lower, periods[i]->upper,
+			periods[i]->lower_inc, periods[i]->upper_inc);
+	PeriodSet *result = periodset_build_finish(&builder);
+	pfree(periods);
+	if (result->count > GIST_MAX_PERIODS)
+	{
+		PeriodSet *reduced = periodset_reduce(result, GIST_MAX_PERIODS);
+		pfree(result);
+		result = reduced;
+	}
+	return result;
+}
+
+/*
+ * Total duration in seconds of the periods of a period set
+ */
+static double
+periodset_to_secs(PeriodSet *ps)
+{
+	double result = 0.0;
+	for (int i = 0; i < ps->count; i++)
+	{
+		Period *p = periodset_per_n(ps, i);
+		result += period_to_secs(p->upper, p->lower);
+	}
+	return result;
+}
+
 /*****************************************************************************
  * Consistent methods for time types
  *****************************************************************************/
@@ -609,6 +728,7 @@ PG_FUNCTION_INFO_V1(gist_period_consistent);
 PGDLLEXPORT Datum
 gist_period_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
 	StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
 	Oid 		subtype = PG_GETARG_OID(3);
@@ -663,6 +783,54 @@ gist_period_consistent(PG_FUNCTION_ARGS)
 	
 }
 
+/*****************************************************************************
+ * Distance methods for time types
+ *****************************************************************************/
+
+/*
+ * Distance between the key and the query, which is a lower bound of the
+ * distance of the values under the key. The distance is exact for the
+ * leaves of period indexes while the leaves of timestampset indexes are
+ * their bounding periods and the value must be rechecked.
+ */
+static double
+gist_time_distance(FunctionCallInfo fcinfo, bool exact)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	Oid 		subtype = PG_GETARG_OID(3);
+	bool	   *recheck = (bool *) PG_GETARG_POINTER(4);
+	Period	   *key = DatumGetPeriod(entry->key);
+	double		result;
+
+	if (GIST_LEAF(entry))
+		*recheck = ! exact;
+
+	if (subtype == TIMESTAMPTZOID)
+		result = distance_period_timestamp_internal(key,
+			PG_GETARG_TIMESTAMPTZ(1));
+	else if (subtype == type_oid(T_PERIOD))
+		result = distance_period_period_internal(key, PG_GETARG_PERIOD(1));
+	else
+		elog(ERROR, "unrecognized subtype for distance: %u", subtype);
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(gist_period_distance);
+
+PGDLLEXPORT Datum
+gist_period_distance(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_FLOAT8(gist_time_distance(fcinfo, true));
+}
+
+PG_FUNCTION_INFO_V1(gist_timeset_distance);
+
+PGDLLEXPORT Datum
+gist_timeset_distance(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_FLOAT8(gist_time_distance(fcinfo, false));
+}
+
 /*****************************************************************************
  * Union methods for time types
  *****************************************************************************/
@@ -738,7 +906,9 @@ gist_period_compress(PG_FUNCTION_ARGS)
 }
 
 /*
- * GiST compress method for periodset
+ * GiST compress method for periodset. The key is the period set itself when
+ * it has at most GIST_MAX_PERIODS periods and is reduced to this number of
+ * periods otherwise.
  */
 PG_FUNCTION_INFO_V1(gist_periodset_compress);
 
@@ -751,9 +921,9 @@ gist_periodset_compress(PG_FUNCTION_ARGS)
 	{
 		GISTENTRY *retval = palloc(sizeof(GISTENTRY));
 		PeriodSet *ps = DatumGetPeriodSet(entry->key);
-		Period *period = palloc(sizeof(Period));
-		periodset_to_period_internal(period, ps);
-		gistentryinit(*retval, PointerGetDatum(period),
+		PeriodSet *key = (ps->count <= GIST_MAX_PERIODS) ? ps :
+			periodset_reduce(ps, GIST_MAX_PERIODS);
+		gistentryinit(*retval, PeriodSetGetDatum(key),
 			entry->rel, entry->page, entry->offset, false);
 		PG_RETURN_POINTER(retval);
 	}
@@ -855,4 +1025,235 @@ gist_period_fetch(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(entry);
 }
 
-/*****************************************************************************/
\ No newline at end of file
+/*****************************************************************************
+ * GiST methods for the periodset keys
+ *****************************************************************************/
+
+/*
+ * Leaf-level consistency for periodset keys. Since the key covers the value,
+ * the value may satisfy the predicate only if the key overlaps or contains
+ * the query. The bounding period of the key is the one of the value.
+ */
+static bool
+index_leaf_consistent_periodset(PeriodSet *key, PeriodSet *query,
+	StrategyNumber strategy)
+{
+	switch (strategy)
+	{
+		case RTOverlapStrategyNumber:
+			return overlaps_periodset_periodset_internal(key, query);
+		case RTContainsStrategyNumber:
+			return contains_periodset_periodset_internal(key, query);
+		case RTContainedByStrategyNumber:
+			return contains_period_period_internal(periodset_bbox(query),
+					periodset_bbox(key)) &&
+				overlaps_periodset_periodset_internal(key, query);
+		case RTSameStrategyNumber:
+			return period_eq_internal(periodset_bbox(key),
+					periodset_bbox(query)) &&
+				contains_periodset_periodset_internal(key, query);
+		default:
+			return index_leaf_consistent_time(periodset_bbox(key),
+				periodset_bbox(query), strategy);
+	}
+}
+
+/*
+ * Internal-page consistency for periodset keys
+ */
+static bool
+index_internal_consistent_periodset(PeriodSet *key, PeriodSet *query,
+	StrategyNumber strategy)
+{
+	switch (strategy)
+	{
+		case RTOverlapStrategyNumber:
+		case RTContainedByStrategyNumber:
+			return overlaps_periodset_periodset_internal(key, query);
+		case RTContainsStrategyNumber:
+		case RTSameStrategyNumber:
+			return contains_periodset_periodset_internal(key, query);
+		default:
+			return index_internal_consistent_period(periodset_bbox(key),
+				periodset_bbox(query), strategy);
+	}
+}
+
+/* 
+ * Consistent method for periodset keys. The query is converted into a
+ * period set.
+ */
+PG_FUNCTION_INFO_V1(gist_periodset_consistent);
+
+PGDLLEXPORT Datum
+gist_periodset_consistent(PG_FUNCTION_ARGS)
+{
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
+	GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
+	Oid 		subtype = PG_GETARG_OID(3);
+	bool	   *recheck = (bool *) PG_GETARG_POINTER(4),
+				result;
+	PeriodSet  *key = DatumGetPeriodSet(entry->key),
+			   *query;
+	Period		p,
+			   *period = &p;
+	
+	/* Determine whether the operator is exact */
+	*recheck = index_period_bbox_recheck(strategy);
+	
+	if (subtype == TIMESTAMPTZOID)
+	{
+		TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+		period_set(&p, t, t, true, true);
+		query = periodset_from_periodarr_internal(&period, 1, false);
+	}
+	else if (subtype == type_oid(T_TIMESTAMPSET))
+	{
+		TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+		query = timestampset_to_periodset_internal(ts);
+		PG_FREE_IF_COPY(ts, 1);
+	}
+	else if (subtype == type_oid(T_PERIOD))
+	{
+		period = PG_GETARG_PERIOD(1);
+		query = periodset_from_periodarr_internal(&period, 1, false);
+	}
+	else if (subtype == type_oid(T_PERIODSET))
+		query = PG_GETARG_PERIODSET(1);
+	else
+		elog(ERROR, "unrecognized strategy number: %d", strategy);
+
+	if (GIST_LEAF(entry))
+		result = index_leaf_consistent_periodset(key, query, strategy);
+	else
+		result = index_internal_consistent_periodset(key, query, strategy);
+
+	PG_RETURN_BOOL(result);
+}
+
+/*
+ * Distance method for periodset keys. The distance to the key is a lower 
+ * bound of the distance to the value.
+ */
+PG_FUNCTION_INFO_V1(gist_periodset_distance);
+
+PGDLLEXPORT Datum
+gist_periodset_distance(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	Oid 		subtype = PG_GETARG_OID(3);
+	bool	   *recheck = (bool *) PG_GETARG_POINTER(4);
+	PeriodSet  *key = DatumGetPeriodSet(entry->key);
+	double		result;
+
+	if (GIST_LEAF(entry))
+		*recheck = true;
+
+	if (subtype == TIMESTAMPTZOID)
+		result = distance_periodset_timestamp_internal(key,
+			PG_GETARG_TIMESTAMPTZ(1));
+	else if (subtype == type_oid(T_PERIOD))
+		result = distance_periodset_period_internal(key, PG_GETARG_PERIOD(1));
+	else
+		elog(ERROR, "unrecognized subtype for distance: %u", subtype);
+	PG_RETURN_FLOAT8(result);
+}
+
+/*
+ * Union method for periodset keys
+ */
+PG_FUNCTION_INFO_V1(gist_periodset_union);
+
+PGDLLEXPORT Datum
+gist_periodset_union(PG_FUNCTION_ARGS)
+{
+	GistEntryVector *entryvec = (GistEntryVector *) PG_GETARG_POINTER(0);
+	PeriodSet **keys = palloc(sizeof(PeriodSet *) * entryvec->n);
+	for (int i = 0; i < entryvec->n; i++)
+		keys[i] = DatumGetPeriodSet(entryvec->vector[i].key);
+	PeriodSet *result = periodset_keys_union(keys, entryvec->n);
+	pfree(keys);
+	PG_RETURN_PERIODSET(result);
+}
+
+/*
+ * Penalty method for periodset keys, which is the increase of the duration
+ * covered by the original key
+ */
+PG_FUNCTION_INFO_V1(gist_periodset_penalty);
+ 
+PGDLLEXPORT Datum
+gist_periodset_penalty(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *origentry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	GISTENTRY  *newentry = (GISTENTRY *) PG_GETARG_POINTER(1);
+	float	   *penalty = (float *) PG_GETARG_POINTER(2);
+	PeriodSet  *keys[2];
+
+	keys[0] = DatumGetPeriodSet(origentry->key);
+	keys[1] = DatumGetPeriodSet(newentry->key);
+	PeriodSet *ps = periodset_keys_union(keys, 2);
+	*penalty = (float4) (periodset_to_secs(ps) - periodset_to_secs(keys[0]));
+	pfree(ps);
+	PG_RETURN_POINTER(penalty);
+}
+
+/*
+ * Picksplit method for periodset keys. The entries are split according to
+ * their bounding periods.
+ */
+PG_FUNCTION_INFO_V1(gist_periodset_picksplit);
+
+PGDLLEXPORT Datum
+gist_periodset_picksplit(PG_FUNCTION_ARGS)
+{
+	GistEntryVector *entryvec = (GistEntryVector *) PG_GETARG_POINTER(0);
+	GIST_SPLITVEC *v = (GIST_SPLITVEC *) PG_GETARG_POINTER(1);
+	size_t			nbytes;
+	OffsetNumber maxoff, i;
+
+	maxoff = (OffsetNumber) (entryvec->n - 1);
+	nbytes = (maxoff + 1) * sizeof(OffsetNumber);
+	v->spl_left = (OffsetNumber *) palloc(nbytes);
+	v->spl_right = (OffsetNumber *) palloc(nbytes);
+
+	GistEntryVector *bboxvec = palloc(GEVHDRSZ +
+		sizeof(GISTENTRY) * entryvec->n);
+	bboxvec->n = entryvec->n;
+	for (i = FirstOffsetNumber; i <= maxoff; i = OffsetNumberNext(i))
+		bboxvec->vector[i].key = PeriodGetDatum(periodset_bbox(
+			DatumGetPeriodSet(entryvec->vector[i].key)));
+	gist_period_double_sorting_split(bboxvec, v);
+
+	/* Replace the bounding periods of the groups by their keys */
+	PeriodSet **keys = palloc(sizeof(PeriodSet *) * maxoff);
+	for (i = 0; i < v->spl_nleft; i++)
+		keys[i] = DatumGetPeriodSet(entryvec->vector[v->spl_left[i]].key);
+	v->spl_ldatum = PeriodSetGetDatum(periodset_keys_union(keys,
+		v->spl_nleft));
+	for (i = 0; i < v->spl_nright; i++)
+		keys[i] = DatumGetPeriodSet(entryvec->vector[v->spl_right[i]].key);
+	v->spl_rdatum = PeriodSetGetDatum(periodset_keys_union(keys,
+		v->spl_nright));
+	pfree(keys); pfree(bboxvec);
+
+	PG_RETURN_POINTER(v);
+}
+
+/*
+ * Same method for periodset keys
+ */
+PG_FUNCTION_INFO_V1(gist_periodset_same);
+
+PGDLLEXPORT Datum
+gist_periodset_same(PG_FUNCTION_ARGS)
+{
+	PeriodSet  *ps1 = PG_GETARG_PERIODSET(0);
+	PeriodSet  *ps2 = PG_GETARG_PERIODSET(1);
+	bool	   *result = (bool *) PG_GETARG_POINTER(2);
+	*result = periodset_eq_internal(ps1, ps2);
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
@@ -268,6 +268,58 @@ calc_period_hist_selectivity(VariableStatData *vardata, Period *constval,
 	return hist_selec;
 }
 
+/*
+ * Calculate the join selectivity of a period operator using the histograms
+ * of period bounds of both sides.
+ *
+ * The histogram of the right side is an equi-depth sample of its values.
+ * The join selectivity is thus approximated by the average over the entries
+ * of this histogram of the restriction selectivity of the left side wrt the
+ * entry, scaled by the fraction of non-NULL values of both sides.
+ * Returns -1 if any of the statistics are not available.
+ */
+double
+calc_period_hist_joinsel(VariableStatData *vardata1,
+	VariableStatData *vardata2, CachedOp cachedOp)
+{
+	AttStatsSlot hslot;
+	double		selec = 0.0, nullfrac1, nullfrac2;
+	int			i;
+
+	if (!HeapTupleIsValid(vardata1->statsTuple) ||
+		!(HeapTupleIsValid(vardata2->statsTuple) &&
+		  get_attstatsslot(&hslot, vardata2->statsTuple,
+						   STATISTIC_KIND_PERIOD_BOUNDS_HISTOGRAM, 
+						   InvalidOid, ATTSTATSSLOT_VALUES)))
+		return -1.0;
+
+	/* Check that it is a histogram, not just a dummy entry */
+	if (hslot.nvalues < 2)
+	{
+		free_attstatsslot(&hslot);
+		return -1.0;
+	}
+
+	for (i = 0; i < hslot.nvalues; i++)
+	{
+		double s = calc_period_hist_selectivity(vardata1,
+			DatumGetPeriod(hslot.values[i]), cachedOp);
+		if (s < 0.0)
+		{
+			free_attstatsslot(&hslot);
+			return -1.0;
+		}
+		selec += s;
+	}
+	selec /= hslot.nvalues;
+	free_attstatsslot(&hslot);
+
+	nullfrac1 = ((Form_pg_statistic) GETSTRUCT(vardata1->statsTuple))->stanullfrac;
+	nullfrac2 = ((Form_pg_statistic) GETSTRUCT(vardata2->statsTuple))->stanullfrac;
+	selec *= (1.0 - nullfrac1) * (1.0 - nullfrac2);
+	return selec;
+}
+
 /*
  * Binary search on an array of period bounds. Returns greatest index of period
  * bound in array which is less(less or equal) than given period bound. If all
@@ -209,6 +209,7 @@ PG_FUNCTION_INFO_V1(spgist_period_inner_consistent);
 PGDLLEXPORT Datum
 spgist_period_inner_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
 	spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
 	int			which,
@@ -458,6 +459,7 @@ PG_FUNCTION_INFO_V1(spgist_period_leaf_consistent);
 PGDLLEXPORT Datum
 spgist_period_leaf_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgLeafConsistentIn *in = (spgLeafConsistentIn *) PG_GETARG_POINTER(0);
 	spgLeafConsistentOut *out = (spgLeafConsistentOut *) PG_GETARG_POINTER(1);
 	Period 	   *key = DatumGetPeriod(in->leafDatum);
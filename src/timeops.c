@@ -13,12 +13,16 @@
 #include "timeops.h"
 
 #include <assert.h>
+#include <float.h>
+#include <funcapi.h>
+#include <access/htup_details.h>
 #include <utils/timestamp.h>
 
 #include "period.h"
 #include "periodset.h"
 #include "timestampset.h"
 #include "oidcache.h"
+#include "temporal_util.h"
 
 /*****************************************************************************/
 
@@ -2332,37 +2336,32 @@ union_timestampset_timestamp(PG_FUNCTION_ARGS)
 TimestampSet *
 union_timestampset_timestampset_internal(TimestampSet *ts1, TimestampSet *ts2)
 {
-	TimestampTz *times = palloc(sizeof(TimestampTz) * (ts1->count + ts2->count));
-	TimestampTz t1 = timestampset_time_n(ts1, 0);
-	TimestampTz t2 = timestampset_time_n(ts2, 0);
-	int i = 0, j = 0, k = 0;
+	TimestampSetBuilder builder;
+	timestampset_build_init(&builder, ts1->count + ts2->count);
+	int i = 0, j = 0;
 	while (i < ts1->count && j < ts2->count)
 	{
-		if (timestamp_cmp_internal(t1, t2) == 0)
-		{
-			times[k++] = t1;
-			t1 = timestampset_time_n(ts1, ++i);
-			t2 = timestampset_time_n(ts2, ++j);
-		}
-		else if (timestamp_cmp_internal(t1, t2) < 0)
+		TimestampTz t1 = timestampset_time_n(ts1, i);
+		TimestampTz t2 = timestampset_time_n(ts2, j);
+		int cmp = timestamp_cmp_internal(t1, t2);
+		if (cmp <= 0)
 		{
-			times[k++] = t1;
-			t1 = timestampset_time_n(ts1, ++i);
+			timestampset_build_append(&builder, t1);
+			i++;
+			if (cmp == 0)
+				j++;
 		}
 		else
 		{
-			times[k++] = t2;
-			t2 = timestampset_time_n(ts2, ++j);
+			timestampset_build_append(&builder, t2);
+			j++;
 		}
 	}
 	while (i < ts1->count)
-		times[k++] = timestampset_time_n(ts1, i++);
+		timestampset_build_append(&builder, timestampset_time_n(ts1, i++));
 	while (j < ts2->count)
-		times[k++] = timestampset_time_n(ts2, j++);
-
-	TimestampSet *result = timestampset_from_timestamparr_internal(times, k);
-	pfree(times);
-	return result;
+		timestampset_build_append(&builder, timestampset_time_n(ts2, j++));
+	return timestampset_build_finish(&builder);
 }
 
 PG_FUNCTION_INFO_V1(union_timestampset_timestampset);
@@ -2633,138 +2632,39 @@ union_periodset_period(PG_FUNCTION_ARGS)
 PeriodSet *
 union_periodset_periodset_internal(PeriodSet *ps1, PeriodSet *ps2)
 {
-	Period **periods = palloc(sizeof(Period *) * (ps1->count + ps2->count));
-	
-	/* If the period sets do not overlap */
-	if (!overlaps_periodset_periodset_internal(ps1, ps2))
+	/* Merge the periods by their lower bound, the builder merges the
+	 * periods that overlap or are adjacent */
+	PeriodSetBuilder builder;
+	periodset_build_init(&builder, ps1->count + ps2->count);
+	int i = 0, j = 0;
+	while (i < ps1->count || j < ps2->count)
 	{
-		int i = 0, j = 0, k = 0;
-		while (i < ps1->count && j < ps2->count)
+		Period *p;
+		if (j == ps2->count)
+			p = periodset_per_n(ps1, i++);
+		else if (i == ps1->count)
+			p = periodset_per_n(ps2, j++);
+		else
 		{
 			Period *p1 = periodset_per_n(ps1, i);
 			Period *p2 = periodset_per_n(ps2, j);
-			if (before_period_period_internal(p1, p2))
-			{
-				periods[k++] = p1;
-				i++;
-			}
-			else
-			{
-				periods[k++] = p2;
-				j++;
-			}
-		}
-		PeriodSet *result = periodset_from_periodarr_internal(periods, k, false);
-		pfree(periods);
-		return result;
-	}
-
-	Period **mustfree = palloc(sizeof(Period *) * Max(ps1->count, ps2->count));
-	int i = 0, j = 0, k = 0, l = 0;
-	while (i < ps1->count && j < ps2->count)
-	{
-		Period *p1 = periodset_per_n(ps1, i);
-		Period *p2 = periodset_per_n(ps2, j);
-		/* The periods do not overlap, copy the earliest period */
-		if (!overlaps_period_period_internal(p1, p2))
-		{
-			if (before_period_period_internal(p1, p2))
+			if (period_cmp_bounds(p1->lower, p2->lower, true, true,
+				p1->lower_inc, p2->lower_inc) <= 0)
 			{
-				periods[k++] = p1;
+				p = p1;
 				i++;
 			}
 			else
 			{
-				periods[k++] = p2;
+				p = p2;
 				j++;
 			}
 		}
-		else
-		{
-			/* Find all periods in ps1 that overlap with periods in ps2
-				   i				 i
-				|-----|  |-----|  |-----|  |-----|	 
-					 |-----|  |-----| 
-						j		j
-			*/
-			Period *q1 = NULL, *q2 = NULL; /* keep compiler quiet */
-			/* remember whether i or j was the last value incremented */
-			bool ilastinc = false, jlastinc = false;
-			while (i < ps1->count && j < ps2->count)
-			{
-				q1 = periodset_per_n(ps1, i);
-				q2 = periodset_per_n(ps2, j);
-				if (overlaps_period_period_internal(q1, q2))
-				{
-					if (timestamp_cmp_internal(q1->upper, q2->upper) == 0)
-					{
-						i++; j++;
-						ilastinc = true; jlastinc = true;
-
-					}
-					else if (timestamp_cmp_internal(q1->upper, q2->upper) < 0)
-					{
-						i++;
-						ilastinc = true; jlastinc = false;
-					}
-					else
-					{
-						j++;
-						ilastinc = false; jlastinc = true;
-					}
-				}
-				else
-					break;
-			}
-			/* Put after the value of last counter to be incremented */
-			if (ilastinc)
-				q1 = periodset_per_n(ps1, --i);
-			if (jlastinc)
-				q2 = periodset_per_n(ps2, --j);
-			/* Compute the union of the overlapping periods */
-			TimestampTz lower, upper;
-			bool lower_inc, upper_inc;
-			if (period_cmp_bounds(p1->lower, p2->lower, true, true,
-				p1->lower_inc, p2->lower_inc) < 0)
-			{
-				lower = p1->lower;
-				lower_inc = p1->lower_inc;
-			}
-			else
-			{
-				lower = p2->lower;
-				lower_inc = p2->lower_inc;
-			}
-			if (period_cmp_bounds(q1->upper, q2->upper, false, false,
-				q1->upper_inc, q2->upper_inc) > 0)
-			{
-				upper = q1->upper;
-				upper_inc = q1->upper_inc;
-			}
-			else
-			{
-				upper = q2->upper;
-				upper_inc = q2->upper_inc;
-			}
-			Period *p3 = period_make(lower, upper, lower_inc, upper_inc);
-			periods[k++] = p3;
-			mustfree[l++] = p3;
-			i++; j++;
-		}
+		periodset_build_append(&builder, p->lower, p->upper,
+			p->lower_inc, p->upper_inc);
 	}
-	while (i < ps1->count)
-		periods[k++] = periodset_per_n(ps1, i++);
-	while (j < ps2->count)
-		periods[k++] = periodset_per_n(ps2, j++);
-	/* k is never equal to 0 since the periodsets are not empty*/
-	PeriodSet *result = periodset_from_periodarr_internal(periods, k, true);
-
-	pfree(periods);
-	for (i = 0; i < l; i++)
-		pfree(mustfree[i]);
-	pfree(mustfree);
-
-	return result;
+	/* The result is never empty since the periodsets are not empty */
+	return periodset_build_finish(&builder);
 }
 
 PG_FUNCTION_INFO_V1(union_periodset_periodset);
@@ -2861,31 +2761,25 @@ intersection_timestampset_timestampset_internal(TimestampSet *ts1, TimestampSet
 	if (!overlaps_period_period_internal(p1, p2))
 		return NULL;
 
-	TimestampTz *times = palloc(sizeof(TimestampTz) * (ts1->count + ts2->count));
-	int i = 0, j = 0, k = 0;
+	TimestampSetBuilder builder;
+	timestampset_build_init(&builder, Min(ts1->count, ts2->count));
+	int i = 0, j = 0;
 	while (i < ts1->count && j < ts2->count)
 	{
 		TimestampTz t1 = timestampset_time_n(ts1, i);
 		TimestampTz t2 = timestampset_time_n(ts2, j);
-		if (timestamp_cmp_internal(t1, t2) == 0)
+		int cmp = timestamp_cmp_internal(t1, t2);
+		if (cmp == 0)
 		{
-			times[k++] = t1;
+			timestampset_build_append(&builder, t1);
 			i++; j++;
 		}
-		else if (timestamp_cmp_internal(t1, t2) < 0)
+		else if (cmp < 0)
 			i++;
 		else
 			j++;
 	}
-	if (k == 0)
-	{
-		pfree(times);
-		return NULL;
-	}
-
-	TimestampSet *result = timestampset_from_timestamparr_internal(times, k);
-	pfree(times);
-	return result;
+	return timestampset_build_finish(&builder);
 }
 
 PG_FUNCTION_INFO_V1(intersection_timestampset_timestampset);
@@ -3205,20 +3099,30 @@ intersection_periodset_periodset_internal(PeriodSet *ps1, PeriodSet *ps2)
 	if (!overlaps_period_period_internal(p1, p2))
 		return NULL;
 
-	Period *inter = intersection_period_period_internal(p1, p2);
+	/* Start from the periods containing or following the lower bound of
+	 * the intersection of the bounding boxes */
+	TimestampTz start = (timestamp_cmp_internal(p1->lower, p2->lower) >= 0) ?
+		p1->lower : p2->lower;
 	int n1, n2;
-	periodset_find_timestamp(ps1, inter->lower, &n1);
-	periodset_find_timestamp(ps2, inter->lower, &n2);
-	pfree(inter);
-	Period **periods = palloc(sizeof(Period *) * (ps1->count + ps2->count - n1 - n2));
-	int i = n1, j = n2, k = 0;
+	periodset_find_timestamp(ps1, start, &n1);
+	periodset_find_timestamp(ps2, start, &n2);
+	PeriodSetBuilder builder;
+	periodset_build_init(&builder, ps1->count + ps2->count - n1 - n2);
+	int i = n1, j = n2;
 	while (i < ps1->count && j < ps2->count)
 	{
 		p1 = periodset_per_n(ps1, i);
 		p2 = periodset_per_n(ps2, j);
-		inter = intersection_period_period_internal(p1, p2);
-		if (inter != NULL)
-			periods[k++] = inter;
+		/* Compute the intersection of the periods in place, the builder
+		 * skips it if it is empty */
+		bool lower1 = period_cmp_bounds(p1->lower, p2->lower, true, true,
+			p1->lower_inc, p2->lower_inc) >= 0;
+		bool upper1 = period_cmp_bounds(p1->upper, p2->upper, false, false,
+			p1->upper_inc, p2->upper_inc) <= 0;
+		periodset_build_append(&builder,
+			lower1 ? p1->lower : p2->lower, upper1 ? p1->upper : p2->upper,
+			lower1 ? p1->lower_inc : p2->lower_inc,
+			upper1 ? p1->upper_inc : p2->upper_inc);
 		int cmp = timestamp_cmp_internal(p1->upper, p2->upper);
 		if (cmp == 0 && p1->upper_inc == p2->upper_inc)
 		{
@@ -3229,17 +3133,7 @@ intersection_periodset_periodset_internal(PeriodSet *ps1, PeriodSet *ps2)
 		else
 			j++;
 	}
-	if (k == 0)
-	{
-		pfree(periods);
-		return NULL;
-	}
-
-	PeriodSet *result = periodset_from_periodarr_internal(periods, k, true);
-	for (i = 0; i < k; i++)
-		pfree(periods[i]);
-	pfree(periods);
-	return result;
+	return periodset_build_finish(&builder);
 }
 
 PG_FUNCTION_INFO_V1(intersection_periodset_periodset);
@@ -3368,33 +3262,29 @@ minus_timestampset_timestampset_internal(TimestampSet *ts1, TimestampSet *ts2)
 	if (!overlaps_period_period_internal(p1, p2))
 		return timestampset_copy(ts1);
 
-	TimestampTz *times = palloc(sizeof(TimestampTz) * ts1->count);
-	int i = 0, j = 0, k = 0;
+	TimestampSetBuilder builder;
+	timestampset_build_init(&builder, ts1->count);
+	int i = 0, j = 0;
 	while (i < ts1->count && j < ts2->count)
 	{
 		TimestampTz t1 = timestampset_time_n(ts1, i);
 		TimestampTz t2 = timestampset_time_n(ts2, j);
-		if (timestamp_cmp_internal(t1, t2) == 0)
+		int cmp = timestamp_cmp_internal(t1, t2);
+		if (cmp == 0)
 		{
 			i++; j++;
 		}
-		if (timestamp_cmp_internal(t1, t2) < 0)
+		else if (cmp < 0)
 		{
-			times[k++] = t1;
+			timestampset_build_append(&builder, t1);
 			i++;
 		}
 		else
 			j++;
 	}
-	if (k == 0)
-	{
-		pfree(times);
-		return NULL;
-	}
-	
-	TimestampSet *result = timestampset_from_timestamparr_internal(times, k);
-	pfree(times);
-	return result;
+	while (i < ts1->count)
+		timestampset_build_append(&builder, timestampset_time_n(ts1, i++));
+	return timestampset_build_finish(&builder);
 }
 
 PG_FUNCTION_INFO_V1(minus_timestampset_timestampset);
@@ -4015,52 +3905,49 @@ minus_periodset_periodset_internal(PeriodSet *ps1, PeriodSet *ps2)
 	if (!overlaps_period_period_internal(p1, p2))
 		return periodset_copy(ps1);
 
-	Period **periods = palloc(sizeof(Period *) * (ps1->count + ps2->count));
-	int i = 0, j = 0, k = 0;
-	while (i < ps1->count && j < ps2->count)
+	PeriodSetBuilder builder;
+	periodset_build_init(&builder, ps1->count + ps2->count);
+	int j = 0;
+	for (int i = 0; i < ps1->count; i++)
 	{
 		p1 = periodset_per_n(ps1, i);
-		p2 = periodset_per_n(ps2, j);
-		/* The periods do not overlap, copy the first period */
-		if (!overlaps_period_period_internal(p1, p2))
-		{
-			periods[k++] = period_copy(p1);
-			i++;
-		}
-		else
+		/* Skip the periods in ps2 that are before p1 */
+		while (j < ps2->count && before_period_period_internal(
+				periodset_per_n(ps2, j), p1))
+			j++;
+		/* Remove from p1 the periods in ps2 that overlap with it
+						  i
+			|------------------------|
+				 |-----|  |-----|	   |---|
+					j		 l
+		*/
+		TimestampTz lower = p1->lower;
+		bool lower_inc = p1->lower_inc;
+		bool covered = false;
+		for (int l = j; l < ps2->count; l++)
 		{
-			/* Find all periods in ps2 that overlap with p1
-							  i
-				|------------------------|  
-					 |-----|  |-----|	  |---|
-						j					l
-			*/
-			int l;
-			for (l = j; l < ps2->count; l++)
+			p2 = periodset_per_n(ps2, l);
+			if (!overlaps_period_period_internal(p1, p2))
+				break;
+			periodset_build_append(&builder, lower, p2->lower,
+				lower_inc, ! p2->lower_inc);
+			if (period_cmp_bounds(p2->upper, p1->upper, false, false,
+				p2->upper_inc, p1->upper_inc) >= 0)
 			{
-				Period *p3 = periodset_per_n(ps2, l);
-				if (!overlaps_period_period_internal(p1, p3))
-					break;
+				covered = true;
+				break;
 			}
-			int count = l - j;
-			/* Compute the difference of the overlapping periods */
-			k += minus_period_periodset_internal1(&periods[k], p1,
-				ps2, j, count);
-			i++;
-			j = l;
+			lower = p2->upper;
+			lower_inc = ! p2->upper_inc;
+			/* The period in ps2 ends before p1, it cannot overlap the
+			 * next period in ps1 */
+			j = l + 1;
 		}
+		if (!covered)
+			periodset_build_append(&builder, lower, p1->upper,
+				lower_inc, p1->upper_inc);
 	}
-	if (k == 0)
-	{
-		pfree(periods);
-		return NULL;
-	}
-
-	PeriodSet *result = periodset_from_periodarr_internal(periods, k, false);
-	for (i = 0; i < k; i++)
-		pfree(periods[i]);
-	pfree(periods);
-	return result;
+	return periodset_build_finish(&builder);
 }
 
 PG_FUNCTION_INFO_V1(minus_periodset_periodset);
@@ -4078,4 +3965,401 @@ minus_periodset_periodset(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Distance functions
+ * The distance between two time values is the number of seconds between
+ * their closest timestamps, which is zero if the values overlap. Exclusive
+ * bounds are not taken into account since the distance is the infimum of
+ * the distances between the timestamps of the values.
+ *****************************************************************************/
+
+double
+distance_period_timestamp_internal(Period *p, TimestampTz t)
+{
+	if (contains_period_timestamp_internal(p, t))
+		return 0.0;
+	if (timestamp_cmp_internal(t, p->lower) <= 0)
+		return period_to_secs(p->lower, t);
+	return period_to_secs(t, p->upper);
+}
+
+double
+distance_period_period_internal(Period *p1, Period *p2)
+{
+	if (overlaps_period_period_internal(p1, p2))
+		return 0.0;
+	if (timestamp_cmp_internal(p1->upper, p2->lower) <= 0)
+		return period_to_secs(p2->lower, p1->upper);
+	return period_to_secs(p1->lower, p2->upper);
+}
+
+double
+distance_timestampset_timestamp_internal(TimestampSet *ts, TimestampTz t)
+{
+	int pos;
+	if (timestampset_find_timestamp(ts, t, &pos))
+		return 0.0;
+	/* The closest timestamps are those before and after t */
+	double result = DBL_MAX;
+	if (pos > 0)
+		result = period_to_secs(t, timestampset_time_n(ts, pos - 1));
+	if (pos < ts->count)
+		result = Min(result,
+			period_to_secs(timestampset_time_n(ts, pos), t));
+	return result;
+}
+
+double
+distance_timestampset_period_internal(TimestampSet *ts, Period *p)
+{
+	int pos;
+	timestampset_find_timestamp(ts, p->lower, &pos);
+	/* The closest timestamps are the last one before the lower bound of
+	 * the period and the first one after it */
+	double result = DBL_MAX;
+	if (pos > 0)
+		result = distance_period_timestamp_internal(p, 
+			timestampset_time_n(ts, pos - 1));
+	if (pos < ts->count)
+		result = Min(result, distance_period_timestamp_internal(p,
+			timestampset_time_n(ts, pos)));
+	return result;
+}
+
+double
+distance_periodset_timestamp_internal(PeriodSet *ps, TimestampTz t)
+{
+	int pos;
+	if (periodset_find_timestamp(ps, t, &pos))
+		return 0.0;
+	/* The closest periods are those before and after t */
+	double result = DBL_MAX;
+	if (pos > 0)
+		result = distance_period_timestamp_internal(
+			periodset_per_n(ps, pos - 1), t);
+	if (pos < ps->count)
+		result = Min(result, distance_period_timestamp_internal(
+			periodset_per_n(ps, pos), t));
+	return result;
+}
+
+double
+distance_periodset_period_internal(PeriodSet *ps, Period *p)
+{
+	int pos;
+	periodset_find_timestamp(ps, p->lower, &pos);
+	/* The closest periods are the one containing or preceding the lower
+	 * bound of the period and the next one */
+	double result = DBL_MAX;
+	if (pos > 0)
+		result = distance_period_period_internal(
+			periodset_per_n(ps, pos - 1), p);
+	if (pos < ps->count)
+		result = Min(result, distance_period_period_internal(
+			periodset_per_n(ps, pos), p));
+	return result;
+}
+
+PG_FUNCTION_INFO_V1(distance_timestamp_timestampset);
+
+PGDLLEXPORT Datum
+distance_timestamp_timestampset(PG_FUNCTION_ARGS)
+{
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+	TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+	double result = distance_timestampset_timestamp_internal(ts, t);
+	PG_FREE_IF_COPY(ts, 1);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestamp_period);
+
+PGDLLEXPORT Datum
+distance_timestamp_period(PG_FUNCTION_ARGS)
+{
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+	Period *p = PG_GETARG_PERIOD(1);
+	double result = distance_period_timestamp_internal(p, t);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestamp_periodset);
+
+PGDLLEXPORT Datum
+distance_timestamp_periodset(PG_FUNCTION_ARGS)
+{
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(0);
+	PeriodSet *ps = PG_GETARG_PERIODSET(1);
+	double result = distance_periodset_timestamp_internal(ps, t);
+	PG_FREE_IF_COPY(ps, 1);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestampset_timestamp);
+
+PGDLLEXPORT Datum
+distance_timestampset_timestamp(PG_FUNCTION_ARGS)
+{
+	TimestampSet *ts = PG_GETARG_TIMESTAMPSET(0);
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+	double result = distance_timestampset_timestamp_internal(ts, t);
+	PG_FREE_IF_COPY(ts, 0);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_timestampset_period);
+
+PGDLLEXPORT Datum
+distance_timestampset_period(PG_FUNCTION_ARGS)
+{
+	TimestampSet *ts = PG_GETARG_TIMESTAMPSET(0);
+	Period *p = PG_GETARG_PERIOD(1);
+	double result = distance_timestampset_period_internal(ts, p);
+	PG_FREE_IF_COPY(ts, 0);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_timestamp);
+
+PGDLLEXPORT Datum
+distance_period_timestamp(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(0);
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+	double result = distance_period_timestamp_internal(p, t);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_timestampset);
+
+PGDLLEXPORT Datum
+distance_period_timestampset(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(0);
+	TimestampSet *ts = PG_GETARG_TIMESTAMPSET(1);
+	double result = distance_timestampset_period_internal(ts, p);
+	PG_FREE_IF_COPY(ts, 1);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_period);
+
+PGDLLEXPORT Datum
+distance_period_period(PG_FUNCTION_ARGS)
+{
+	Period *p1 = PG_GETARG_PERIOD(0);
+	Period *p2 = PG_GETARG_PERIOD(1);
+	double result = distance_period_period_internal(p1, p2);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_period_periodset);
+
+PGDLLEXPORT Datum
+distance_period_periodset(PG_FUNCTION_ARGS)
+{
+	Period *p = PG_GETARG_PERIOD(0);
+	PeriodSet *ps = PG_GETARG_PERIODSET(1);
+	double result = distance_periodset_period_internal(ps, p);
+	PG_FREE_IF_COPY(ps, 1);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_periodset_timestamp);
+
+PGDLLEXPORT Datum
+distance_periodset_timestamp(PG_FUNCTION_ARGS)
+{
+	PeriodSet *ps = PG_GETARG_PERIODSET(0);
+	TimestampTz t = PG_GETARG_TIMESTAMPTZ(1);
+	double result = distance_periodset_timestamp_internal(ps, t);
+	PG_FREE_IF_COPY(ps, 0);
+	PG_RETURN_FLOAT8(result);
+}
+
+PG_FUNCTION_INFO_V1(distance_periodset_period);
+
+PGDLLEXPORT Datum
+distance_periodset_period(PG_FUNCTION_ARGS)
+{
+	PeriodSet *ps = PG_GETARG_PERIODSET(0);
+	Period *p = PG_GETARG_PERIOD(1);
+	double result = distance_periodset_period_internal(ps, p);
+	PG_FREE_IF_COPY(ps, 0);
+	PG_RETURN_FLOAT8(result);
+}
+
+/*****************************************************************************
+ * Overlapping pairs of two arrays of periods
+ *****************************************************************************/
+
+/* Period of an array together with its position in the array */
+
+typedef struct
+{
+	Period	   *p;				/* Period */
+	int			idx;			/* Position of the period in its array */
+} PeriodSweepItem;
+
+/* State of the function overlaps_pairs returning the pairs one by one */
+
+typedef struct
+{
+	int			count;			/* Number of pairs */
+	int			pos;			/* Position of the next pair to return */
+	Datum	   *ids1;			/* Identifiers of the first element of the pairs */
+	Datum	   *ids2;			/* Identifiers of the second element of the pairs */
+} OverlapsPairsState;
+
+static int
+period_sweep_cmp(const void *a, const void *b)
+{
+	const PeriodSweepItem *item1 = (const PeriodSweepItem *) a;
+	const PeriodSweepItem *item2 = (const PeriodSweepItem *) b;
+	return period_cmp_bounds(item1->p->lower, item2->p->lower, true, true,
+		item1->p->lower_inc, item2->p->lower_inc);
+}
+
+static PeriodSweepItem *
+period_sweep_items(Period **periods, int count)
+{
+	PeriodSweepItem *result = palloc(sizeof(PeriodSweepItem) * Max(count, 1));
+	for (int i = 0; i < count; i++)
+	{
+		result[i].p = periods[i];
+		result[i].idx = i;
+	}
+	qsort(result, count, sizeof(PeriodSweepItem), &period_sweep_cmp);
+	return result;
+}
+
+/*
+ * Sweep step for a period of one of the arrays. The active periods of the
+ * other array that end before the period starts are removed, since they
+ * cannot overlap this period nor the following ones, and the remaining ones
+ * that overlap the period are added as pairs.
+ */
+static void
+overlaps_pairs_sweep(OverlapsPairsState *state, int *maxcount, 
+	PeriodSweepItem *item, Datum id, PeriodSweepItem *others, int *active, 
+	int *nactive, Datum *otherids, bool first)
+{
+	int k = 0;
+	for (int j = 0; j < *nactive; j++)
+	{
+		PeriodSweepItem *other = &others[active[j]];
+		if (timestamp_cmp_internal(other->p->upper, item->p->lower) < 0)
+			continue;
+		active[k++] = active[j];
+		if (! overlaps_period_period_internal(item->p, other->p))
+			continue;
+		if (state->count == *maxcount)
+		{
+			*maxcount *= 2;
+			state->ids1 = repalloc(state->ids1, sizeof(Datum) * *maxcount);
+			state->ids2 = repalloc(state->ids2, sizeof(Datum) * *maxcount);
+		}
+		state->ids1[state->count] = first ? id : otherids[other->idx];
+		state->ids2[state->count++] = first ? otherids[other->idx] : id;
+	}
+	*nactive = k;
+}
+
+/*
+ * Compute the pairs of overlapping periods of two arrays. Both arrays are
+ * sorted by the lower bound of their periods and merged by a sweep line
+ * that keeps for each array the periods that may overlap the following 
+ * ones. Each pair is found when its period that starts last is reached, 
+ * so that the cost is O((n + m) log(n + m)) for sorting the arrays plus 
+ * the number of pairs.
+ */
+static OverlapsPairsState *
+overlaps_pairs1(Datum *ids1, Period **periods1, int count1, Datum *ids2, 
+	Period **periods2, int count2)
+{
+	OverlapsPairsState *state = palloc0(sizeof(OverlapsPairsState));
+	int maxcount = Max(count1 + count2, 1);
+	state->ids1 = palloc(sizeof(Datum) * maxcount);
+	state->ids2 = palloc(sizeof(Datum) * maxcount);
+	PeriodSweepItem *items1 = period_sweep_items(periods1, count1);
+	PeriodSweepItem *items2 = period_sweep_items(periods2, count2);
+	int *active1 = palloc(sizeof(int) * Max(count1, 1));
+	int *active2 = palloc(sizeof(int) * Max(count2, 1));
+	int nactive1 = 0, nactive2 = 0;
+	int i = 0, j = 0;
+	while (i < count1 || j < count2)
+	{
+		if (j == count2 || (i < count1 &&
+			period_sweep_cmp(&items1[i], &items2[j]) <= 0))
+		{
+			overlaps_pairs_sweep(state, &maxcount, &items1[i], 
+				ids1[items1[i].idx], items2, active2, &nactive2, ids2, true);
+			active1[nactive1++] = i++;
+		}
+		else
+		{
+			overlaps_pairs_sweep(state, &maxcount, &items2[j], 
+				ids2[items2[j].idx], items1, active1, &nactive1, ids1, false);
+			active2[nactive2++] = j++;
+		}
+	}
+	pfree(items1); pfree(items2);
+	pfree(active1); pfree(active2);
+	return state;
+}
+
+PG_FUNCTION_INFO_V1(overlaps_pairs);
+/**
+ * @brief Returns the pairs of identifiers of the periods of two arrays
+ *		that overlap
+ *
+ * The function computes the join of two tables on the && operator of their
+ * periods, or of the time spans of their temporal values cast to periods,
+ * without an index probe per row of one of the tables.
+ */
+PGDLLEXPORT Datum
+overlaps_pairs(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	if (SRF_IS_FIRSTCALL())
+	{
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext oldcontext = 
+			MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+		ArrayType *idarr1 = PG_GETARG_ARRAYTYPE_P(0);
+		ArrayType *periodarr1 = PG_GETARG_ARRAYTYPE_P(1);
+		ArrayType *idarr2 = PG_GETARG_ARRAYTYPE_P(2);
+		ArrayType *periodarr2 = PG_GETARG_ARRAYTYPE_P(3);
+		int count1, count2, count3, count4;
+		Datum *ids1 = datumarr_extract(idarr1, &count1);
+		Period **periods1 = periodarr_extract(periodarr1, &count2);
+		Datum *ids2 = datumarr_extract(idarr2, &count3);
+		Period **periods2 = periodarr_extract(periodarr2, &count4);
+		if (count1 != count2 || count3 != count4)
+			ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), 
+				errmsg("The arrays of identifiers and of periods must have the same length")));
+		TypeFuncClass typeclass = get_call_result_type(fcinfo, NULL,
+			&funcctx->tuple_desc);
+		if (typeclass != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(funcctx->tuple_desc);
+		funcctx->user_fctx = overlaps_pairs1(ids1, periods1, count1, ids2,
+			periods2, count3);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	OverlapsPairsState *state = (OverlapsPairsState *) funcctx->user_fctx;
+	if (state->pos == state->count)
+		SRF_RETURN_DONE(funcctx);
+
+	Datum values[2];
+	bool nulls[2] = {false, false};
+	values[0] = state->ids1[state->pos];
+	values[1] = state->ids2[state->pos];
+	state->pos++;
+	HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
 /******************************************************************************/
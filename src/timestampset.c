@@ -28,33 +28,38 @@
 /* 
  * The memory structure of a TimestampSet with, e.g., 3 timestamps is as follows
  *
- *  --------------------------------------------------------------------
- *	( TimestampSet | offset_0 | offset_1 | offset_2 | offset_3 | )_X | ...
- *	--------------------------------------------------------------------
- *	------------------------------------------------------------
- *	( Timestamp_0 | Timestamp_1 | Timestamp_2 | ( bbox )_Y )_X |
- *	------------------------------------------------------------
+ *	------------------------------------------------------------------------
+ *	( TimestampSet )_X | Timestamp_0 | Timestamp_1 | Timestamp_2 | ( bbox )_X |
+ *	------------------------------------------------------------------------
  *
- * where the X are unused bytes added for double padding, the Y are unused bytes 
- * added for int4 padding, offset_0 to offset_2 are offsets for the corresponding 
- * timestamps, and offset_3 is the offset for the bounding box.
+ * where the X are unused bytes added for double padding. Since all the
+ * timestamps have the same size they are stored contiguously without an
+ * array of offsets, which halves the size of large sets and lets the search
+ * functions scan the timestamps as a plain C array.
+ *
+ * The values written by previous versions of the extension have an array of
+ * count + 1 offsets between the header and the timestamps. These offsets are
+ * always equal to the position of the timestamps in the array and thus the
+ * only difference between both layouts is the position of the first
+ * timestamp, which is found from the size of the value.
  */
- 
-/* Pointer to array of offsets of the TimestampSet */
 
-static size_t *
-timestampset_offsets_ptr(TimestampSet *ts)
-{
-	return (size_t *) (((char *)ts) + sizeof(TimestampSet));
-}
+/* Size of a TimestampSet with the given number of timestamps */
+
+#define TIMESTAMPSET_SIZE(count) \
+	(double_pad(sizeof(TimestampSet)) + sizeof(TimestampTz) * (count) + \
+	 double_pad(sizeof(Period)))
 
-/* Pointer to the first timestamp */
+/* Pointer to the array of timestamps of the TimestampSet */
 
-static char * 
-timestampset_data_ptr(TimestampSet *ts)
+static TimestampTz *
+timestampset_times_ptr(TimestampSet *ts)
 {
-	return (char *)ts + double_pad(sizeof(TimestampSet) + 
-		sizeof(size_t) * (ts->count + 1));
+	if (VARSIZE(ts) == TIMESTAMPSET_SIZE(ts->count))
+		return (TimestampTz *) (((char *) ts) + double_pad(sizeof(TimestampSet)));
+	/* Layout with an array of offsets */
+	return (TimestampTz *) (((char *) ts) + double_pad(sizeof(TimestampSet) +
+		sizeof(size_t) * (ts->count + 1)));
 }
 
 /* N-th TimestampTz of a TimestampSet */
@@ -62,9 +67,7 @@ timestampset_data_ptr(TimestampSet *ts)
 TimestampTz
 timestampset_time_n(TimestampSet *ts, int index)
 {
-	size_t *offsets = timestampset_offsets_ptr(ts);
-	TimestampTz *result = (TimestampTz *) (timestampset_data_ptr(ts) + offsets[index]);
-	return *result;
+	return timestampset_times_ptr(ts)[index];
 }
 
 /* Bounding box of a TimestampSet */
@@ -72,8 +75,7 @@ timestampset_time_n(TimestampSet *ts, int index)
 Period *
 timestampset_bbox(TimestampSet *ts) 
 {
-	size_t *offsets = timestampset_offsets_ptr(ts);
-	return (Period *)(timestampset_data_ptr(ts) + offsets[ts->count]);
+	return (Period *) (timestampset_times_ptr(ts) + ts->count);
 }
 
 /* Construct a TimestampSet from an array of TimestampTz */
@@ -81,7 +83,6 @@ timestampset_bbox(TimestampSet *ts)
 TimestampSet *
 timestampset_from_timestamparr_internal(TimestampTz *times, int count)
 {
-	Period bbox;
 	/* Test the validity of the timestamps */
 	for (int i = 0; i < count - 1; i++)
 	{
@@ -90,27 +91,15 @@ timestampset_from_timestamparr_internal(TimestampTz *times, int count)
 				errmsg("Invalid value for timestamp set")));
 	}
 
-	size_t memsize = double_pad(sizeof(TimestampTz) * count + double_pad(sizeof(Period)));
-	/* Array of pointers containing the pointers to the component timestamps,
-	   and a pointer to the bbox */
-	size_t pdata = double_pad(sizeof(TimestampSet) + (count + 1) * sizeof(size_t));
 	/* Create the TimestampSet */
-	TimestampSet *result = palloc0(pdata + memsize);
-	SET_VARSIZE(result, pdata + memsize);
+	TimestampSet *result = palloc0(TIMESTAMPSET_SIZE(count));
+	SET_VARSIZE(result, TIMESTAMPSET_SIZE(count));
 	result->count = count;
-
-	size_t *offsets = timestampset_offsets_ptr(result);
-	size_t pos = 0;	
-	for (int i = 0; i < count; i++)
-	{
-		memcpy(((char *) result) + pdata + pos, &times[i], sizeof(TimestampTz));
-		offsets[i] = pos;
-		pos += sizeof(TimestampTz);
-	}
+	TimestampTz *resulttimes = timestampset_times_ptr(result);
+	memcpy(resulttimes, times, sizeof(TimestampTz) * count);
 	/* Precompute the bounding box */
-	period_set(&bbox, times[0], times[count - 1], true, true);
-	offsets[count] = pos;
-	memcpy(((char *) result) + pdata + pos, &bbox, sizeof(Period));
+	period_set((Period *) (resulttimes + count), times[0], times[count - 1],
+		true, true);
 	return result;
 }
 
@@ -122,6 +111,58 @@ timestampset_copy(TimestampSet *ts)
 	return result;
 }
 
+/*
+ * Construction of a TimestampSet from timestamps given in increasing order,
+ * as produced by the set operations. The result is allocated once for the
+ * maximum number of timestamps and the timestamps are written directly into
+ * it, skipping those that are not greater than the last one appended.
+ */
+
+void
+timestampset_build_init(TimestampSetBuilder *builder, int maxcount)
+{
+	builder->ts = palloc0(TIMESTAMPSET_SIZE(maxcount));
+	builder->times = (TimestampTz *) (((char *) builder->ts) +
+		double_pad(sizeof(TimestampSet)));
+	builder->maxcount = maxcount;
+	builder->count = 0;
+}
+
+void
+timestampset_build_append(TimestampSetBuilder *builder, TimestampTz t)
+{
+	if (builder->count > 0 &&
+		timestamp_cmp_internal(t, builder->times[builder->count - 1]) <= 0)
+		return;
+	assert(builder->count < builder->maxcount);
+	builder->times[builder->count++] = t;
+}
+
+/*
+ * Finish the construction of the TimestampSet. The timestamps are already
+ * at their place and only the bounding box is added after them. Returns NULL
+ * if no timestamp was appended.
+ */
+TimestampSet *
+timestampset_build_finish(TimestampSetBuilder *builder)
+{
+	TimestampSet *result = builder->ts;
+	int count = builder->count;
+	if (count == 0)
+	{
+		pfree(result);
+		return NULL;
+	}
+
+	TimestampTz *times = builder->times;
+	SET_VARSIZE(result, TIMESTAMPSET_SIZE(count));
+	result->count = count;
+	/* Precompute the bounding box */
+	period_set((Period *) (times + count), times[0], times[count - 1],
+		true, true);
+	return result;
+}
+
 /*
  * Binary search of a timestamptz in a timestampset.
  * If the timestamp is found, the position of the period is returned in pos.
@@ -134,18 +175,25 @@ timestampset_copy(TimestampSet *ts)
  * 2)			t^ 					=> result = 1
  * 3)					t^ 			=> result = 2
  * 4)							t^	=> result = 3
+ *
+ * The binary search stops when at most TIME_SEARCH_BLOCK timestamps remain,
+ * which are then compared with the timestamp in a loop without branches that
+ * the compiler turns into vector instructions.
  */
 
 bool 
 timestampset_find_timestamp(TimestampSet *ts, TimestampTz t, int *pos) 
 {
+	const TimestampTz *times = timestampset_times_ptr(ts);
 	int first = 0;
 	int last = ts->count - 1;
-	int middle = 0; /* make compiler quiet */
-	while (first <= last) 
+	/* The first probe is the position of the timestamp if the timestamps
+	 * were regularly spaced */
+	Period *p = (Period *) (times + ts->count);
+	int middle = timestamp_interpolate_pos(p->lower, p->upper, last, t);
+	while (last - first >= TIME_SEARCH_BLOCK) 
 	{
-		middle = (first + last)/2;
-		TimestampTz t1 = timestampset_time_n(ts, middle);
+		TimestampTz t1 = times[middle];
 		int cmp = timestamp_cmp_internal(t, t1);
 		if (cmp == 0)
 		{
@@ -156,11 +204,14 @@ timestampset_find_timestamp(TimestampSet *ts, TimestampTz t, int *pos)
 			last = middle - 1;
 		else
 			first = middle + 1;
+		middle = (first + last)/2;
 	}
-	if (middle == ts->count)
-		middle++;
-	*pos = middle;
-	return false;
+	/* Count the timestamps of the block that are before the timestamp */
+	int before = 0;
+	for (int i = first; i <= last; i++)
+		before += (times[i] < t);
+	*pos = first + before;
+	return (*pos <= last && times[*pos] == t);
 }
 
 /*****************************************************************************
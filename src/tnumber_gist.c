@@ -19,8 +19,11 @@
 
 #include "temporal.h"
 #include "oidcache.h"
+#include "period.h"
+#include "timeops.h"
 #include "temporal_boxops.h"
 #include "temporal_posops.h"
+#include "temporal_gist.h"
 
 /* Minimum accepted ratio of split */
 #define LIMIT_RATIO 0.3
@@ -41,7 +44,7 @@
 /*
  * Calculates union of two tboxes, a and b. The result is stored in *n.
  */
-static void
+void
 rt_tbox_union(TBOX *n, const TBOX *a, const TBOX *b)
 {
 	n->xmax = FLOAT8_MAX(a->xmax, b->xmax);
@@ -871,7 +874,7 @@ index_leaf_consistent_tbox(TBOX *key, TBOX *query, StrategyNumber strategy)
  * in the pg_amop table.
  *****************************************************************************/
 
-static bool
+bool
 gist_internal_consistent_tbox(TBOX *key, TBOX *query, StrategyNumber strategy)
 {
 	bool retval;
@@ -927,6 +930,7 @@ PG_FUNCTION_INFO_V1(gist_tnumber_consistent);
 PGDLLEXPORT Datum
 gist_tnumber_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
 	StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16(2);
 	Oid subtype = PG_GETARG_OID(3);
@@ -971,11 +975,8 @@ gist_tnumber_consistent(PG_FUNCTION_ARGS)
 	}
 	else if (temporal_type_oid(subtype))
 	{
-		Temporal *temp = PG_GETARG_TEMPORAL(1);
-		if (temp == NULL)
-			PG_RETURN_BOOL(false);
-		temporal_bbox(&query, temp);
-		PG_FREE_IF_COPY(temp, 1);
+		index_query_box(fcinfo->flinfo, PG_GETARG_DATUM(1), subtype,
+			&temporal_query_box, sizeof(TBOX), &query);
 	}
 	else
 		elog(ERROR, "unrecognized strategy number: %d", strategy);
@@ -988,6 +989,43 @@ gist_tnumber_consistent(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(result);	
 }
 
+/*****************************************************************************
+ * Distance method for temporal numbers
+ *****************************************************************************/
+
+/*
+ * Distance in seconds between the time dimension of the key and the query.
+ * Since the leaves are the bounding boxes of the values, which may not be
+ * defined during the whole span of their box, the distance is a lower bound
+ * and the value must be rechecked.
+ */
+PG_FUNCTION_INFO_V1(gist_tnumber_distance);
+
+PGDLLEXPORT Datum
+gist_tnumber_distance(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	Oid subtype = PG_GETARG_OID(3);
+	bool *recheck = (bool *) PG_GETARG_POINTER(4);
+	TBOX *key = DatumGetTboxP(entry->key);
+	Period p;
+	double result;
+
+	if (GIST_LEAF(entry))
+		*recheck = true;
+
+	period_set(&p, key->tmin, key->tmax, true, true);
+	if (subtype == TIMESTAMPTZOID)
+		result = distance_period_timestamp_internal(&p,
+			PG_GETARG_TIMESTAMPTZ(1));
+	else if (subtype == type_oid(T_PERIOD))
+		result = distance_period_period_internal(&p, PG_GETARG_PERIOD(1));
+	else
+		elog(ERROR, "unrecognized subtype for distance: %u", subtype);
+
+	PG_RETURN_FLOAT8(result);
+}
+
 /*****************************************************************************
  * Compress method for temporal numbers
  *****************************************************************************/
@@ -1037,4 +1075,19 @@ gist_tbox_same(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
+/*****************************************************************************
+ * Fetch method for boxes
+ * The keys of an index on a tbox column are the values themselves, which
+ * enables index-only scans
+ *****************************************************************************/
+
+PG_FUNCTION_INFO_V1(gist_tbox_fetch);
+
+PGDLLEXPORT Datum
+gist_tbox_fetch(PG_FUNCTION_ARGS)
+{
+	GISTENTRY  *entry = (GISTENTRY *) PG_GETARG_POINTER(0);
+	PG_RETURN_POINTER(entry);
+}
+
 /*****************************************************************************/
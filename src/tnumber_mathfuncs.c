@@ -2,7 +2,7 @@
  *
  * tnumber_mathfuncs.c
  *	Temporal mathematical operators (+, -, *, /) and functions (round, 
- *	degrees).
+ *	degrees, weighted sum).
  *
  * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
  * 		Universite Libre de Bruxelles
@@ -668,3 +668,71 @@ temporal_degrees(PG_FUNCTION_ARGS)
 }
 
 /*****************************************************************************/
+
+/*****************************************************************************
+ * Weighted sum of temporal floats
+ * The sum is computed in a single pass over all the arguments instead of
+ * a chain of multiplications and additions. Since the result varies linearly
+ * between the synchronized timestamps, the arguments with stepwise 
+ * interpolation are first transformed to linear interpolation.
+ *****************************************************************************/
+
+static Datum
+datum_weighted_sum(Datum *values, int count, Datum weights)
+{
+	double *w = (double *) DatumGetPointer(weights);
+	double result = 0;
+	for (int i = 0; i < count; i++)
+		result += w[i] * DatumGetFloat8(values[i]);
+	return Float8GetDatum(result);
+}
+
+PG_FUNCTION_INFO_V1(tfloat_weighted_sum);
+
+PGDLLEXPORT Datum
+tfloat_weighted_sum(PG_FUNCTION_ARGS)
+{
+	ArrayType *array = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType *warray = PG_GETARG_ARRAYTYPE_P(1);
+	int count, wcount;
+	Temporal **temparr = temporalarr_extract(array, &count);
+	Datum *wdatums = datumarr_extract(warray, &wcount);
+	if (count != wcount)
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			errmsg("The number of weights must be equal to the number of temporal values")));
+	if (count == 0)
+	{
+		PG_FREE_IF_COPY(array, 0);
+		PG_FREE_IF_COPY(warray, 1);
+		PG_RETURN_NULL();
+	}
+
+	double *weights = palloc(sizeof(double) * count);
+	Temporal **lintemparr = palloc(sizeof(Temporal *) * count);
+	for (int i = 0; i < count; i++)
+	{
+		weights[i] = DatumGetFloat8(wdatums[i]);
+		Temporal *temp = temparr[i];
+		if (MOBDB_FLAGS_GET_LINEAR(temp->flags) || 
+			temp->duration == TEMPORALINST || temp->duration == TEMPORALI)
+			lintemparr[i] = temp;
+		else if (temp->duration == TEMPORALSEQ)
+			lintemparr[i] = (Temporal *) tstepwseq_to_linear((TemporalSeq *)temp);
+		else
+			lintemparr[i] = (Temporal *) tstepws_to_linear((TemporalS *)temp);
+	}
+	TemporalS *result = sync_tfuncn_temporal(lintemparr, count, 
+		PointerGetDatum(weights), &datum_weighted_sum, FLOAT8OID, true);
+
+	for (int i = 0; i < count; i++)
+		if (lintemparr[i] != temparr[i])
+			pfree(lintemparr[i]);
+	pfree(lintemparr); pfree(weights); pfree(temparr); pfree(wdatums);
+	PG_FREE_IF_COPY(array, 0);
+	PG_FREE_IF_COPY(warray, 1);
+	if (result == NULL)
+		PG_RETURN_NULL();
+	PG_RETURN_POINTER(result);
+}
+
+/*****************************************************************************/
@@ -942,6 +942,69 @@ tnumberinst_sel(PlannerInfo *root, VariableStatData *vardata, TBOX *box,
 	return selec;
 }
 
+/*
+ * Estimate the selectivity of the overlaps operator with a box having both
+ * the value and the time dimensions from the two-dimensional histogram of the
+ * column. The cells of the histogram overlapping the box contribute their
+ * fraction of values pro-rated by the proportion of the cell that is covered
+ * by the box. Returns -1 if the histogram is not available.
+ */
+static double
+calc_tbox_hist_selectivity(VariableStatData *vardata, const TBOX *box)
+{
+	AttStatsSlot sslot;
+	TBOX *extent;
+	int vsize, tsize, i, j;
+	double vcellsize, tcellsize, selec = 0.0;
+
+	if (!(HeapTupleIsValid(vardata->statsTuple) &&
+		  get_attstatsslot(&sslot, vardata->statsTuple,
+			STATISTIC_KIND_TBOX_HISTOGRAM, InvalidOid,
+			ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS)))
+		return -1.0;
+
+	extent = DatumGetTboxP(sslot.values[0]);
+	vsize = (int) sslot.numbers[0];
+	tsize = (int) sslot.numbers[1];
+
+	/* The box does not overlap the extent of the histogram */
+	if (box->xmax < extent->xmin || box->xmin > extent->xmax ||
+		box->tmax < extent->tmin || box->tmin > extent->tmax)
+	{
+		free_attstatsslot(&sslot);
+		return 0.0;
+	}
+
+	vcellsize = (extent->xmax - extent->xmin) / vsize;
+	tcellsize = ((double) extent->tmax - (double) extent->tmin) / tsize;
+	for (i = 0; i < vsize; i++)
+	{
+		double vmin = extent->xmin + i * vcellsize,
+			vmax = extent->xmin + (i + 1) * vcellsize, vratio;
+		if (vsize == 1)
+			vratio = 1.0;
+		else if (box->xmax < vmin || box->xmin > vmax)
+			continue;
+		else
+			vratio = (Min(box->xmax, vmax) - Max(box->xmin, vmin)) / vcellsize;
+		for (j = 0; j < tsize; j++)
+		{
+			double tmin = (double) extent->tmin + j * tcellsize,
+				tmax = (double) extent->tmin + (j + 1) * tcellsize, tratio;
+			if (tsize == 1)
+				tratio = 1.0;
+			else if ((double) box->tmax < tmin || (double) box->tmin > tmax)
+				continue;
+			else
+				tratio = (Min((double) box->tmax, tmax) - 
+					Max((double) box->tmin, tmin)) / tcellsize;
+			selec += sslot.numbers[2 + i * tsize + j] * vratio * tratio;
+		}
+	}
+	free_attstatsslot(&sslot);
+	return selec;
+}
+
 /*
  * Compute selectivity for columns of durations distinct from TemporalInst,
  * including columns containing temporal values of mixed durations.
@@ -975,6 +1038,22 @@ tnumbers_sel(PlannerInfo *root, VariableStatData *vardata, TBOX *box,
 	if (MOBDB_FLAGS_GET_T(box->flags))
 		period_set(&period, box->tmin, box->tmax, true, true);
 
+	/*
+	 * For the overlaps operator with a box having both dimensions, use the 
+	 * histogram of both dimensions that captures their correlation
+	 */
+	if (cachedOp == OVERLAPS_OP && MOBDB_FLAGS_GET_X(box->flags) && 
+		MOBDB_FLAGS_GET_T(box->flags))
+	{
+		selec = calc_tbox_hist_selectivity(vardata, box);
+		if (selec >= 0.0)
+		{
+			pfree(range);
+			return selec;
+		}
+		selec = 1.0;
+	}
+
 	/*
 	 * There is no ~= operator for range/time types and thus it is necessary to
 	 * take care of this operator here.
@@ -82,6 +82,7 @@
 #include "oidcache.h"
 #include "temporal_boxops.h"
 #include "tnumber_gist.h"
+#include "temporal_gist.h"
 
 /*****************************************************************************/
 
@@ -408,6 +409,7 @@ PG_FUNCTION_INFO_V1(spgist_tnumber_inner_consistent);
 PGDLLEXPORT Datum
 spgist_tnumber_inner_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgInnerConsistentIn *in = (spgInnerConsistentIn *) PG_GETARG_POINTER(0);
 	spgInnerConsistentOut *out = (spgInnerConsistentOut *) PG_GETARG_POINTER(1);
 	int i;
@@ -454,8 +456,8 @@ spgist_tnumber_inner_consistent(PG_FUNCTION_ARGS)
 		else if (subtype == type_oid(T_TBOX))
 			memcpy(&queries[i], DatumGetTboxP(in->scankeys[i].sk_argument), sizeof(TBOX));
 		else if (temporal_type_oid(subtype))
-			temporal_bbox(&queries[i],
-				DatumGetTemporal(in->scankeys[i].sk_argument));
+			index_query_box(fcinfo->flinfo, in->scankeys[i].sk_argument,
+				subtype, &temporal_query_box, sizeof(TBOX), &queries[i]);
 		else
 			elog(ERROR, "Unrecognized strategy number: %d", strategy);
 	}
@@ -553,6 +555,7 @@ PG_FUNCTION_INFO_V1(spgist_tnumber_leaf_consistent);
 PGDLLEXPORT Datum
 spgist_tnumber_leaf_consistent(PG_FUNCTION_ARGS)
 {
+	MOBDB_STAT_INC(STAT_INDEX_CONSISTENT_CALLS);
 	spgLeafConsistentIn *in = (spgLeafConsistentIn *) PG_GETARG_POINTER(0);
 	spgLeafConsistentOut *out = (spgLeafConsistentOut *) PG_GETARG_POINTER(1);
 	TBOX *key = DatumGetTboxP(in->leafDatum), query;
@@ -593,8 +596,8 @@ spgist_tnumber_leaf_consistent(PG_FUNCTION_ARGS)
 		}
 		else if (temporal_type_oid(subtype))
 		{
-			temporal_bbox(&query,
-				DatumGetTemporal(in->scankeys[i].sk_argument));
+			index_query_box(fcinfo->flinfo, in->scankeys[i].sk_argument,
+				subtype, &temporal_query_box, sizeof(TBOX), &query);
 			res = index_leaf_consistent_tbox(key, &query, strategy);
 		}
 		else
@@ -0,0 +1,166 @@
+/*****************************************************************************
+ *
+ * micro.sql
+ *	  Micro-benchmarks of the core functions of temporal types
+ *
+ * Each benchmark evaluates a function a given number of times in a single
+ * statement, and the time of the same statement evaluating a trivial
+ * expression is subtracted to obtain the cost per call. The benchmarks are
+ * run for temporal sequences of increasing number of instants and for
+ * temporal sequence sets of increasing number of sequences. The results,
+ * in nanoseconds per call together with the size in bytes of the input
+ * values, are collected in table bench_micro.
+ *
+ * Portions Copyright (c) 2020, Esteban Zimanyi, Arthur Lesuisse,
+ *		Universite Libre de Bruxelles
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *****************************************************************************/
+
+DROP TABLE IF EXISTS bench_micro;
+CREATE TABLE bench_micro(
+	kernel text,
+	size int,
+	iterations int,
+	ns_per_op float,
+	bytes int,
+	run timestamptz DEFAULT now()
+);
+
+-------------------------------------------------------------------------------
+
+/* Elapsed time in nanoseconds of the execution of a statement */
+CREATE OR REPLACE FUNCTION bench_time(query text)
+	RETURNS float AS $$
+DECLARE
+	start timestamptz;
+BEGIN
+	start = clock_timestamp();
+	EXECUTE query;
+	RETURN extract(epoch FROM clock_timestamp() - start) * 1e9;
+END;
+$$ LANGUAGE 'plpgsql' STRICT;
+
+/*
+ * Run a benchmark. The query and the baseline query have a placeholder %s
+ * for the number of iterations. The number of bytes is the size of the
+ * input values of a call.
+ */
+CREATE OR REPLACE FUNCTION bench_run(kernel text, size int, bytes int,
+	query text, baseline text, iterations int)
+	RETURNS void AS $$
+DECLARE
+	elapsed float;
+	base float;
+BEGIN
+	/* Warm up the caches */
+	PERFORM bench_time(format(query, 1));
+	base = bench_time(format(baseline, iterations));
+	elapsed = bench_time(format(query, iterations));
+	INSERT INTO bench_micro(kernel, size, iterations, ns_per_op, bytes)
+	VALUES (kernel, size, iterations,
+		greatest(elapsed - base, 0) / iterations, bytes);
+END;
+$$ LANGUAGE 'plpgsql' STRICT;
+
+-------------------------------------------------------------------------------
+-- Input data
+-------------------------------------------------------------------------------
+
+/* Sequences with an increasing number of instants */
+DROP TABLE IF EXISTS bench_tfloatseq;
+CREATE TABLE bench_tfloatseq AS
+SELECT n AS size,
+	tfloatseq(array_agg(tfloatinst(random() * 100,
+		'2000-01-01'::timestamptz + i * interval '1 minute') ORDER BY i)) AS seq1,
+	tfloatseq(array_agg(tfloatinst(random() * 100,
+		'2000-01-01'::timestamptz + i * interval '1 minute' + interval '30 seconds') ORDER BY i)) AS seq2,
+	'2000-01-01'::timestamptz + (n / 3) * interval '1 minute' + interval '10 seconds' AS t
+FROM unnest(ARRAY[10, 100, 1000, 10000]) n, generate_series(1, n) i
+GROUP BY n;
+ALTER TABLE bench_tfloatseq ADD COLUMN txt text;
+UPDATE bench_tfloatseq SET txt = seq1::text;
+
+/* Sequence sets with an increasing number of sequences of 10 instants */
+DROP TABLE IF EXISTS bench_tfloats;
+CREATE TABLE bench_tfloats AS
+WITH seqs AS (
+	SELECT n, j, tfloatseq(array_agg(tfloatinst(random() * 100,
+		'2000-01-01'::timestamptz + j * interval '1 hour' +
+		i * interval '1 minute') ORDER BY i)) AS seq
+	FROM unnest(ARRAY[10, 100, 1000]) n, generate_series(1, n) j, generate_series(1, 10) i
+	GROUP BY n, j )
+SELECT n AS size, tfloats(array_agg(seq ORDER BY j)) AS ts,
+	'2000-01-01'::timestamptz + (n / 3) * interval '1 hour' +
+		interval '5 minutes' AS t
+FROM seqs
+GROUP BY n;
+
+/* Rows of sequences to aggregate */
+DROP TABLE IF EXISTS bench_tfloatseq_rows;
+CREATE TABLE bench_tfloatseq_rows AS
+SELECT n AS size, tfloatseq(array_agg(tfloatinst(random() * 100,
+	'2000-01-01'::timestamptz + (r % 60) * interval '1 minute' +
+	i * interval '1 minute') ORDER BY i)) AS seq
+FROM unnest(ARRAY[10, 100, 1000]) n, generate_series(1, n) r, generate_series(1, 10) i
+GROUP BY n, r;
+
+-------------------------------------------------------------------------------
+-- Benchmarks
+-------------------------------------------------------------------------------
+
+/* Binary search of a timestamp in a sequence */
+SELECT bench_run('atTimestamp(tfloatseq)', size, pg_column_size(seq1),
+	format('SELECT count(atTimestamp(seq1, t)) FROM bench_tfloatseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	format('SELECT count(t) FROM bench_tfloatseq, '
+		'generate_series(1, %%s) WHERE size = %s', size), 1000)
+FROM bench_tfloatseq ORDER BY size;
+
+/* Binary search of a timestamp in a sequence set */
+SELECT bench_run('atTimestamp(tfloats)', size, pg_column_size(ts),
+	format('SELECT count(atTimestamp(ts, t)) FROM bench_tfloats, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	format('SELECT count(t) FROM bench_tfloats, '
+		'generate_series(1, %%s) WHERE size = %s', size), 1000)
+FROM bench_tfloats ORDER BY size;
+
+/* Synchronization of two sequences */
+SELECT bench_run('tfloatseq + tfloatseq', size,
+	pg_column_size(seq1) + pg_column_size(seq2),
+	format('SELECT count(seq1 + seq2) FROM bench_tfloatseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	format('SELECT count(seq1) FROM bench_tfloatseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	greatest(10, 100000 / size))
+FROM bench_tfloatseq ORDER BY size;
+
+/* Input function */
+SELECT bench_run('tfloat_in', size, octet_length(txt),
+	format('SELECT count(txt::tfloat) FROM bench_tfloatseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	format('SELECT count(txt) FROM bench_tfloatseq, '
+		'generate_series(1, %%s) WHERE size = %s', size),
+	greatest(10, 100000 / size))
+FROM bench_tfloatseq ORDER BY size;
+
+/* Temporal aggregation with a skiplist */
+SELECT bench_run('tsum(tfloatseq)', size,
+	(SELECT sum(pg_column_size(seq))::int FROM bench_tfloatseq_rows r
+		WHERE r.size = s.size),
+	format('SELECT count(*) FROM (SELECT tsum(seq) FROM bench_tfloatseq_rows, '
+		'generate_series(1, %%s) i WHERE size = %s GROUP BY i) t', size),
+	format('SELECT count(*) FROM (SELECT count(seq) FROM bench_tfloatseq_rows, '
+		'generate_series(1, %%s) i WHERE size = %s GROUP BY i) t', size),
+	greatest(5, 1000 / size))
+FROM (SELECT DISTINCT size FROM bench_tfloatseq_rows) s ORDER BY size;
+
+-------------------------------------------------------------------------------
+
+SELECT kernel, size, iterations, round(ns_per_op::numeric, 1) AS ns_per_op,
+	bytes
+FROM bench_micro
+ORDER BY kernel, size;
+
+-------------------------------------------------------------------------------
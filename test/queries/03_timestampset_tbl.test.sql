@@ -43,4 +43,6 @@ SELECT count(*) FROM tbl_timestampset t1, tbl_timestampset t2 WHERE t1.ts <= t2.
 SELECT count(*) FROM tbl_timestampset t1, tbl_timestampset t2 WHERE t1.ts > t2.ts;
 SELECT count(*) FROM tbl_timestampset t1, tbl_timestampset t2 WHERE t1.ts >= t2.ts;
 
+SELECT count(*) FROM generate_series(0, 1999) i WHERE timestampset(array(SELECT timestamptz '2000-01-01' + j * interval '2 min' FROM generate_series(0, 999) j)) @> timestamptz '2000-01-01' + i * interval '1 min';
+
 -------------------------------------------------------------------------------
@@ -38,4 +38,6 @@ select count(*) from tbl_periodset t1, tbl_periodset t2 where t1.ps <= t2.ps;
 select count(*) from tbl_periodset t1, tbl_periodset t2 where t1.ps > t2.ps;
 select count(*) from tbl_periodset t1, tbl_periodset t2 where t1.ps >= t2.ps;
 
+SELECT count(*) FROM generate_series(0, 2999) i WHERE periodset(array(SELECT period(timestamptz '2000-01-01' + j * interval '3 min', timestamptz '2000-01-01' + j * interval '3 min' + interval '1 min') FROM generate_series(0, 999) j)) @> timestamptz '2000-01-01' + i * interval '1 min';
+
 -------------------------------------------------------------------------------
@@ -165,6 +165,7 @@ SELECT periodset '{[2000-01-01, 2000-01-03]}' - period '[2000-01-01, 2000-01-03]
 SELECT periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}' - periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}';
 SELECT periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}' - periodset '{[2000-01-04, 2000-01-05]}';
 SELECT periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}' - periodset '{[2000-01-01, 2000-01-03]}';
+SELECT periodset '{[2000-01-01, 2000-01-02],[2000-01-05, 2000-01-06]}' - periodset '{[2000-01-03, 2000-01-04],[2000-01-05, 2000-01-05]}';
 
 -------------------------------------------------------------------------------
 
@@ -218,3 +219,21 @@ SELECT periodset '{[2000-01-01, 2000-01-03],[2000-01-04, 2000-01-05]}' * periods
 SELECT periodset '{[2000-01-03, 2000-01-04],[2000-01-07, 2000-01-08]}' * periodset '{[2000-01-01, 2000-01-02],[2000-01-05, 2000-01-06]}';
 
 -------------------------------------------------------------------------------
+
+SELECT timestamptz '2000-01-01' <-> timestampset '{2000-01-02, 2000-01-04}';
+
+SELECT timestampset '{2000-01-01, 2000-01-05}' <-> timestamptz '2000-01-02';
+SELECT timestampset '{2000-01-01, 2000-01-05}' <-> period '[2000-01-02, 2000-01-03]';
+
+SELECT period '[2000-01-01, 2000-01-02]' <-> timestamptz '2000-01-01 12:00';
+SELECT period '[2000-01-01, 2000-01-02)' <-> timestamptz '2000-01-03';
+SELECT period '[2000-01-01, 2000-01-02]' <-> period '[2000-01-04, 2000-01-05]';
+SELECT period '[2000-01-04, 2000-01-05]' <-> period '[2000-01-01, 2000-01-02]';
+SELECT period '[2000-01-01 12:00, 2000-01-01 18:00]' <-> periodset '{[2000-01-01, 2000-01-02],[2000-01-05, 2000-01-06]}';
+
+SELECT periodset '{[2000-01-01, 2000-01-02],[2000-01-05, 2000-01-06]}' <-> timestamptz '2000-01-04';
+SELECT periodset '{[2000-01-01, 2000-01-02],[2000-01-05, 2000-01-06]}' <-> period '[2000-01-03, 2000-01-03 12:00]';
+
+SELECT * FROM overlapsPairs(ARRAY[1, 2, 3]::bigint[], ARRAY[period '[2000-01-01, 2000-01-03]', period '[2000-01-05, 2000-01-06)', period '(2000-01-02, 2000-01-10]'], ARRAY[10, 20]::bigint[], ARRAY[period '[2000-01-03, 2000-01-04]', period '[2000-01-06, 2000-01-07]']) ORDER BY 1, 2;
+
+-------------------------------------------------------------------------------
@@ -87,4 +87,29 @@ SELECT count(*) FROM tbl_periodset, tbl_timestampset WHERE ps * ts IS NOT NULL;
 SELECT count(*) FROM tbl_periodset, tbl_period WHERE ps * p IS NOT NULL;
 SELECT count(*) FROM tbl_periodset t1, tbl_periodset t2 WHERE t1.ps * t2.ps IS NOT NULL;
 
+WITH pairs AS (
+	SELECT (overlapsPairs(
+		(SELECT array_agg(k::bigint ORDER BY k) FROM tbl_period WHERE p IS NOT NULL),
+		(SELECT array_agg(p ORDER BY k) FROM tbl_period WHERE p IS NOT NULL),
+		(SELECT array_agg(k::bigint ORDER BY k) FROM tbl_periodset WHERE ps IS NOT NULL),
+		(SELECT array_agg(period(ps) ORDER BY k) FROM tbl_periodset WHERE ps IS NOT NULL))).* ),
+brute AS (
+	SELECT t1.k::bigint AS id1, t2.k::bigint AS id2
+	FROM tbl_period t1, tbl_periodset t2 WHERE t1.p && period(t2.ps) )
+SELECT count(*) FROM (
+	(SELECT * FROM pairs EXCEPT ALL SELECT * FROM brute) UNION ALL
+	(SELECT * FROM brute EXCEPT ALL SELECT * FROM pairs) ) t;
+WITH pairs AS (
+	SELECT (overlapsPairs(
+		(SELECT array_agg(k::bigint ORDER BY k) FROM tbl_tfloat WHERE temp IS NOT NULL),
+		(SELECT array_agg(period(temp) ORDER BY k) FROM tbl_tfloat WHERE temp IS NOT NULL),
+		(SELECT array_agg(k::bigint ORDER BY k) FROM tbl_period WHERE p IS NOT NULL),
+		(SELECT array_agg(p ORDER BY k) FROM tbl_period WHERE p IS NOT NULL))).* ),
+brute AS (
+	SELECT t1.k::bigint AS id1, t2.k::bigint AS id2
+	FROM tbl_tfloat t1, tbl_period t2 WHERE period(t1.temp) && t2.p )
+SELECT count(*) FROM (
+	(SELECT * FROM pairs EXCEPT ALL SELECT * FROM brute) UNION ALL
+	(SELECT * FROM brute EXCEPT ALL SELECT * FROM pairs) ) t;
+
 -------------------------------------------------------------------------------
@@ -2080,3 +2080,26 @@ END;
 $$ LANGUAGE 'plpgsql';
 
 -------------------------------------------------------------------------------
+-- Incremental refresh of the period histograms of an append-only table
+-------------------------------------------------------------------------------
+
+CREATE TABLE tbl_period_append AS
+SELECT k, period(timestamptz '2001-01-01' + k * interval '1 hour',
+  timestamptz '2001-01-01' + (k + 1) * interval '1 hour') AS p
+FROM generate_series(1, 1000) k;
+ANALYZE tbl_period_append;
+INSERT INTO tbl_period_append
+SELECT k, period(timestamptz '2001-01-01' + k * interval '1 hour',
+  timestamptz '2001-01-01' + (k + 1) * interval '1 hour') AS p
+FROM generate_series(1001, 2000) k;
+
+SELECT mergePeriodStats('tbl_period_append') > 500;
+SELECT mergePeriodStats('tbl_period_append');
+SELECT (SELECT max(upper(p)) FROM unnest(stavalues1::text::period[]) p) =
+  timestamptz '2001-01-01' + 2001 * interval '1 hour'
+FROM pg_statistic WHERE starelid = 'tbl_period_append'::regclass AND stakind1 = 8;
+SELECT mergePeriodStats('tbl_period');
+
+DROP TABLE tbl_period_append;
+
+-------------------------------------------------------------------------------
@@ -79,6 +79,13 @@ SELECT tbox 'TBOX((1.0, 2000-01-02), (1.0, 2000-01-02))' = floatrange '[1, 2]'::
 
 -------------------------------------------------------------------------------
 
+SELECT zorderKey(tbox 'TBOX((1.0, 2000-01-01), (3.0, 2000-01-02))', tbox 'TBOX((0, 2000-01-01), (10, 2000-01-11))');
+SELECT hilbertKey(tbox 'TBOX((1.0, 2000-01-01), (3.0, 2000-01-02))', tbox 'TBOX((0, 2000-01-01), (10, 2000-01-11))');
+SELECT hilbertKey(tbox 'TBOX((1.0,), (3.0,))', tbox 'TBOX((0, 2000-01-01), (10, 2000-01-11))');
+SELECT zorderKey(tbox 'TBOX((1.0,), (3.0,))', tbox 'TBOX((, 2000-01-01), (, 2000-01-11))');
+
+-------------------------------------------------------------------------------
+
 SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 where t1.b = t2.b;
 SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 where t1.b <> t2.b;
 SELECT count(*) FROM tbl_tbox t1, tbl_tbox t2 where t1.b < t2.b;
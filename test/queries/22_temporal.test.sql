@@ -477,6 +477,35 @@ SELECT appendInstant(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[C
 /* Errors */
 SELECT appendInstant(tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]', tint '[1@2000-01-04, 1@2000-01-05]');
 
+SELECT appendInstants(tint '1@2000-01-01', ARRAY[tint '2@2000-01-02', tint '3@2000-01-03']);
+SELECT appendInstants(tfloat '[1@2000-01-01, 3@2000-01-02]', ARRAY[tfloat '2@2000-01-03', tfloat '4@2000-01-04']);
+SELECT appendInstants(ttext '{[AAA@2000-01-01, BBB@2000-01-02],[CCC@2000-01-03, CCC@2000-01-04]}', ARRAY[ttext 'DDD@2000-01-05']);
+SELECT appendInstants(tbool '[t@2000-01-01, f@2000-01-02]', ARRAY[]::tbool[]);
+/* Errors */
+SELECT appendInstants(tint '[1@2000-01-01, 2@2000-01-02]', ARRAY[tint '[3@2000-01-03, 3@2000-01-04]']);
+SELECT appendInstants(tint '[1@2000-01-01, 2@2000-01-02]', ARRAY[tint '3@2000-01-02']);
+
+CREATE TABLE tbl_ingest_staging(k int, temp tint);
+CREATE TABLE tbl_ingest_target(k int, temp tint);
+INSERT INTO tbl_ingest_target VALUES (1, tint '[1@2000-01-01, 2@2000-01-02]');
+INSERT INTO tbl_ingest_staging VALUES (1, tint '1@2000-01-01'), (1, tint '4@2000-01-04'), (1, tint '3@2000-01-03'), (2, tint '5@2000-01-01'), (2, tint '6@2000-01-02');
+SELECT ingestFlush('tbl_ingest_staging', 'tbl_ingest_target', 'k', 'temp');
+SELECT temp FROM tbl_ingest_target ORDER BY k;
+SELECT count(*) FROM tbl_ingest_staging;
+/* Errors */
+SELECT ingestFlush('tbl_ingest_staging', 'tbl_ingest_target', 'k', 'tmp');
+SELECT ingestFlush('tbl_ingest_staging', 'tbl_ingest_target', 'temp', 'k');
+DROP TABLE tbl_ingest_staging;
+DROP TABLE tbl_ingest_target;
+
+SELECT merge(ARRAY[tint '[1@2000-01-03, 2@2000-01-04]', tint '[3@2000-01-01, 3@2000-01-02]']);
+SELECT merge(ARRAY[tfloat '[1@2000-01-01, 3@2000-01-03]', tfloat '[10@2000-01-02, 20@2000-01-04]']);
+SELECT merge(ARRAY[tfloat '[1@2000-01-01, 3@2000-01-03]', tfloat '[10@2000-01-02, 20@2000-01-04]'], 'first');
+SELECT merge(ARRAY[tint '1@2000-01-01', tint '2@2000-01-01', tint '3@2000-01-02'], 'first');
+SELECT merge_agg(temp) FROM (VALUES (tint '[1@2000-01-01, 1@2000-01-02]'), (tint '[1@2000-01-02, 2@2000-01-03]')) t(temp);
+/* Errors */
+SELECT merge(ARRAY[tint '1@2000-01-01', tint '2@2000-01-02'], 'middle');
+
 -------------------------------------------------------------------------------
 -- Accessor functions
 -------------------------------------------------------------------------------
@@ -520,6 +549,23 @@ SELECT memSize(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}');
 SELECT memSize(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]');
 SELECT memSize(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
 
+SELECT formatVersion(tint '1@2000-01-01');
+SELECT formatVersion(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}');
+SELECT formatVersion(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]');
+SELECT formatVersion(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
+SELECT upgrade(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}');
+SELECT memSize(upgrade(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]'));
+SELECT compress(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}');
+SELECT isCompressed(compress(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}'));
+SELECT isCompressed(compress(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}'));
+SELECT isCompressed(decompress(compress(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]')));
+SELECT compress(tbool '[true@2000-01-01, false@2000-01-02, true@2000-01-03]') = tbool '[true@2000-01-01, false@2000-01-02, true@2000-01-03]';
+SELECT compress(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]') = tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]';
+SELECT compress(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}') = ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
+SELECT memSize(compress(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]')) < memSize(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]');
+SELECT timespan(compress(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}')) = timespan(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}');
+SELECT compress(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}') && tbox 'TBOX((3,2000-01-05),(4,2000-01-06))';
+
 /*
 SELECT tbox(tint '1@2000-01-01');
 SELECT tbox(tfloat '1.5@2000-01-01');
@@ -642,6 +688,13 @@ SELECT maxValue(ttext 'AAA@2000-01-01');
 SELECT maxValue(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}');
 SELECT maxValue(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]');
 SELECT maxValue(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
+SELECT minValue(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]', period '[2000-01-01 12:00, 2000-01-02 12:00]');
+SELECT maxValue(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]', period '[2000-01-01 12:00, 2000-01-02 12:00]');
+SELECT maxValue(tint '[1@2000-01-01, 3@2000-01-02, 2@2000-01-03]', period '[2000-01-01 12:00, 2000-01-02)');
+SELECT minValue(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}', period '[2000-01-02 12:00, 2000-01-03 12:00]');
+SELECT minValue(tfloat '[1.5@2000-01-01, 2.5@2000-01-02]', period '[2000-01-03, 2000-01-04]');
+SELECT minValue(temp, period '[2000-01-01 02:00:30, 2000-01-01 10:30]') = minValue(atPeriod(temp, period '[2000-01-01 02:00:30, 2000-01-01 10:30]')) AND maxValue(temp, period '[2000-01-01 02:00:30, 2000-01-01 10:30]') = maxValue(atPeriod(temp, period '[2000-01-01 02:00:30, 2000-01-01 10:30]')) FROM (SELECT tfloatseq(array_agg(tfloatinst(sin(i), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS temp FROM generate_series(0, 999) i) t;
+SELECT numSequences(atMin(temp)) FROM (SELECT tintseq(array_agg(tintinst(i % 100, timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS temp FROM generate_series(0, 999) i) t;
 
 SELECT getTimestamp(tbool 't@2000-01-01');
 SELECT getTimestamp(tint '1@2000-01-01');
@@ -933,6 +986,11 @@ SELECT instants(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}');
 SELECT instants(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]');
 SELECT instants(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}');
 
+SELECT t, value, seqno FROM unnestInstants(tbool 't@2000-01-01');
+SELECT count(*), bool_and(seqno IS NULL) FROM unnestInstants(tint '{1@2000-01-01, 2@2000-01-02}');
+SELECT t, value, seqno FROM unnestInstants(tfloat '{[1@2000-01-01, 2@2000-01-02],[3@2000-01-03, 3@2000-01-04]}');
+SELECT seqno, count(*) FROM unnestInstants(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}') GROUP BY seqno ORDER BY seqno;
+
 SELECT numTimestamps(tbool 't@2000-01-01');
 SELECT numTimestamps(tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}');
 SELECT numTimestamps(tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]');
@@ -1055,6 +1113,10 @@ SELECT shift(ttext 'AAA@2000-01-01', '5 min');
 SELECT shift(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}', '5 min');
 SELECT shift(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]', '5 min');
 SELECT shift(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}', '5 min');
+SELECT shift(shift(tint '1@2000-01-01'::tfloat, '5 min'), '5 min');
+SELECT shift(shift(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}'::tfloat, '5 min'), '5 min');
+SELECT shift(shift(tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]'::tfloat, '5 min'), '5 min');
+SELECT shift(shift(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}'::tfloat, '5 min'), '5 min');
 
 -------------------------------------------------------------------------------
 -- Ever/always comparison functions
@@ -1116,6 +1178,9 @@ SELECT ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04,
 SELECT tint '{[1@2000-01-01, 1@2000-01-02]}' %= 1;
 SELECT tfloat '{[1@2000-01-01, 1@2000-01-02]}' %= 1;
 SELECT tfloat '{[1@2000-01-01, 1@2000-01-02]}' %= 2;
+SELECT tfloat '[1.5@2000-01-01, 1.5@2000-01-02]' %= 1.5;
+SELECT tfloat '[1@2000-01-01, 3@2000-01-02)' ?= 3;
+SELECT tfloat '[1@2000-01-01, 3@2000-01-02)' ?= 2;
 
 -------------------------------------------------------------------------------
 
@@ -1394,6 +1459,11 @@ SELECT atRange(tfloat 'Interp=Stepwise;{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@200
 
 SELECT atRange(tfloat '[1@2000-01-01, 2@2000-01-02]', floatrange '[2, 3]');
 
+SELECT whenTrue(tbool '[t@2000-01-01, f@2000-01-02, t@2000-01-03]');
+SELECT whenAtValue(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}', 1);
+SELECT whenAtRange(tfloat '[1@2000-01-01, 3@2000-01-03]', floatrange '[2,3]');
+SELECT whenGt(tfloat '[1@2000-01-01, 3@2000-01-03, 1@2000-01-05]', 2.0);
+
 SELECT minusRange(tint '1@2000-01-01', intrange '[1,3]');
 SELECT minusRange(tint '{1@2000-01-01}', intrange '[1,3]');
 SELECT minusRange(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}', intrange '[1,3]');
@@ -1586,6 +1656,16 @@ SELECT valueAtTimestamp(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03}'
 SELECT valueAtTimestamp(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]', timestamptz '2000-01-01');
 SELECT valueAtTimestamp(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}', timestamptz '2000-01-01');
 
+SELECT valuesAtTimestampSet(tint '1@2000-01-01', timestampset '{2000-01-01, 2000-01-02}');
+SELECT valuesAtTimestampSet(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}', timestampset '{2000-01-02, 2000-01-02 12:00:00, 2000-01-03}');
+SELECT valuesAtTimestampSet(tfloat '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03)', timestampset '{1999-12-31, 2000-01-01 12:00:00, 2000-01-02 12:00:00, 2000-01-03}');
+SELECT valuesAtTimestampSet(tbool '{[t@2000-01-01, f@2000-01-02, t@2000-01-03],[f@2000-01-04, f@2000-01-05]}', timestampset '{2000-01-01 12:00:00, 2000-01-03 12:00:00, 2000-01-04, 2000-01-06}');
+SELECT valuesAtTimestampSet(ttext '[AAA@2000-01-01, BBB@2000-01-02]', timestampset '{2000-01-01, 2000-01-02}');
+
+SELECT array_agg(valueAtTimestamp(temp, t) ORDER BY t) FROM (SELECT tfloat '{[1@2000-01-01, 3@2000-01-03], [3@2000-01-04, 5@2000-01-06]}' AS temp) x, generate_series(timestamptz '2000-01-01', '2000-01-06', '12 hours') t;
+SELECT array_agg(valueAtTimestamp(temp, t) ORDER BY t DESC) FROM (SELECT tfloat '{[1@2000-01-01, 3@2000-01-03], [3@2000-01-04, 5@2000-01-06]}' AS temp) x, generate_series(timestamptz '2000-01-06', '2000-01-01', '-12 hours') t;
+SELECT array_agg(valueAtTimestamp(temp, t) ORDER BY t) FROM (SELECT tint '{1@2000-01-01, 2@2000-01-02, 3@2000-01-04}' AS temp) x, generate_series(timestamptz '2000-01-01', '2000-01-04', '1 day') t;
+
 SELECT minusTimestamp(tbool 't@2000-01-01', timestamptz '2000-01-01');
 SELECT minusTimestamp(tbool '{t@2000-01-01}', timestamptz '2000-01-01');
 SELECT minusTimestamp(tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}', timestamptz '2000-01-01');
@@ -1804,6 +1884,9 @@ SELECT minusPeriodSet(tfloat '[1@2000-01-03]', periodset '{[2000-01-01, 2000-01-
 SELECT minusPeriodSet(tfloat '[1@2000-01-01,1@2000-01-03]', periodset '{[2000-01-02, 2000-01-03],[2000-01-04, 2000-01-05]}');
 SELECT minusPeriodSet(tfloat '{[1@2000-01-01, 1@2000-01-02]}', periodset '{[2000-01-01, 2000-01-02]}');
 SELECT minusPeriodSet(tfloat '{[1@2000-01-01, 1@2000-01-02],[1@2000-01-03, 1@2000-01-04]}', periodset '{[2000-01-01, 2000-01-02],[2000-01-03, 2000-01-04]}');
+SELECT atPeriodSet(tfloat '[1@2000-01-01, 5@2000-01-05]', periodset '{[2000-01-01, 2000-01-02],[2000-01-03, 2000-01-04]}');
+SELECT minusPeriodSet(tfloat '[1@2000-01-01, 5@2000-01-05]', periodset '{[2000-01-01, 2000-01-02],[2000-01-03, 2000-01-04]}');
+SELECT atPeriodSet(tfloat '{[1@2000-01-01, 3@2000-01-03],[4@2000-01-04, 6@2000-01-06]}', periodset '{[2000-01-02, 2000-01-05),(2000-01-05, 2000-01-07]}');
 
 SELECT intersectsTimestamp(tbool 't@2000-01-01', timestamptz '2000-01-01');
 SELECT intersectsTimestamp(tbool '{t@2000-01-01, f@2000-01-02, t@2000-01-03}', timestamptz '2000-01-01');
@@ -1875,6 +1958,29 @@ SELECT intersectsPeriodSet(ttext '{AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-0
 SELECT intersectsPeriodSet(ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]', periodset '{[2000-01-01,2000-01-02]}');
 SELECT intersectsPeriodSet(ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}', periodset '{[2000-01-01,2000-01-02]}');
 
+SELECT tsample(tfloat '[1@2000-01-01, 5@2000-01-05]', interval '1 day');
+SELECT tsample(tfloat '[1@2000-01-01, 5@2000-01-05)', interval '2 days');
+SELECT tsample(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}', interval '12 hours', '2000-01-01 06:00:00');
+SELECT tsample(ttext '{AAA@2000-01-01, BBB@2000-01-02 12:00:00}', interval '1 day');
+SELECT tsample(tfloat '[1@2000-01-01 01:00:00, 2@2000-01-01 02:00:00]', interval '1 day');
+SELECT tbucket(tbool 't@2000-01-01', interval '1 day');
+SELECT tbucket(tfloat '[1@2000-01-01, 5@2000-01-05]', interval '2 days');
+SELECT tbucket(tint '[1@2000-01-01 12:00:00, 2@2000-01-03, 2@2000-01-04 12:00:00)', interval '1 day');
+SELECT tbucket(tint '{[1@2000-01-01, 2@2000-01-02, 1@2000-01-03],[3@2000-01-04, 3@2000-01-05]}', interval '2 days', '2000-01-01');
+
+SELECT tsample(tfloat '1@2000-01-01', interval '1 month');
+SELECT tbucket(tfloat '1@2000-01-01', interval '-1 day');
+
+SELECT * FROM tsync(ARRAY[tfloat '[1@2000-01-01, 3@2000-01-03]', tfloat '[10@2000-01-02, 20@2000-01-04]']);
+SELECT * FROM tsync(ARRAY[tfloat '[1@2000-01-01, 3@2000-01-03]', tfloat '[10@2000-01-02, 20@2000-01-04]'], 'intersection');
+SELECT * FROM tsync(ARRAY[tint '{[1@2000-01-01, 1@2000-01-02), [2@2000-01-02, 2@2000-01-03]}', tint '{5@2000-01-02, 6@2000-01-04}']);
+SELECT * FROM tsync(ARRAY[tint '[1@2000-01-01, 2@2000-01-03]', tint '{5@2000-01-02, 6@2000-01-04}'], interval '1 day');
+SELECT * FROM tsync(ARRAY[ttext '[AAA@2000-01-01, AAA@2000-01-02)', ttext 'CCC@2000-01-02'], interval '12 hours');
+/* Errors */
+SELECT * FROM tsync(ARRAY[tint '1@2000-01-01'], 'foo');
+SELECT * FROM tsync(ARRAY[]::tint[]);
+SELECT * FROM tsync(ARRAY[tint '1@2000-01-01'], interval '1 month');
+
 SELECT integral(tint '1@2000-01-01');
 SELECT integral(tint '{1@2000-01-01, 2@2000-01-02, 1@2000-01-03}');
 SELECT integral(tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]');
@@ -1905,6 +2011,12 @@ SELECT round(twAvg(tfloat 'Interp=Stepwise;[1.5@2000-01-01, 2.5@2000-01-02, 1.5@
 SELECT round(twAvg(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}')::numeric, 6);
 SELECT round(twAvg(tfloat 'Interp=Stepwise;{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}')::numeric, 6);
 
+SELECT round(integral(tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]', period '[2000-01-01 12:00, 2000-01-02 12:00]')::numeric, 6);
+SELECT round(twAvg(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]', period '[2000-01-01 12:00, 2000-01-02 12:00]')::numeric, 6);
+SELECT round(twAvg(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}', period '[2000-01-02, 2000-01-04 12:00]')::numeric, 6);
+SELECT twAvg(tfloat '[1.5@2000-01-01, 2.5@2000-01-02]', period '[2000-01-03, 2000-01-04]');
+SELECT abs(twAvg(temp, period '[2000-01-01 02:00:30, 2000-01-01 10:30]') - twAvg(atPeriod(temp, period '[2000-01-01 02:00:30, 2000-01-01 10:30]'))) < 1e-9 FROM (SELECT tfloatseq(array_agg(tfloatinst(sin(i), timestamptz '2000-01-01' + i * interval '1 minute') ORDER BY i)) AS temp FROM generate_series(0, 999) i) t;
+
 -------------------------------------------------------------------------------
 -- Comparison functions and B-tree indexing
 -------------------------------------------------------------------------------
@@ -0,0 +1,23 @@
+-------------------------------------------------------------------------------
+-- Tests for the caches of detoasted temporal values.
+-- File temporal_cache.c
+-------------------------------------------------------------------------------
+-- The test setup enables the shared cache. The backend cache is disabled so
+-- that the values stored out of line are read from the shared cache by the
+-- queries following the one that detoasted them.
+
+SET mobilitydb.detoast_cache_size = 0;
+CREATE TABLE tbl_tint_toast(k int, temp tint);
+ALTER TABLE tbl_tint_toast ALTER COLUMN temp SET STORAGE EXTERNAL;
+INSERT INTO tbl_tint_toast SELECT k, tintseq(array(SELECT tintinst(j % 7, timestamptz '2000-01-01' + (k * 1000 + j) * interval '1 min') FROM generate_series(0, 999) j)) FROM generate_series(1, 10) k;
+
+SELECT sum(numInstants(temp)) FROM tbl_tint_toast;
+SELECT sum(numInstants(temp)) FROM tbl_tint_toast;
+SELECT count(*) FROM tbl_tint_toast WHERE valueAtTimestamp(temp, timestamptz '2000-01-01' + (k * 1000 + 3) * interval '1 min') = 3;
+SELECT count(*) FROM tbl_tint_toast t1, tbl_tint_toast t2 WHERE t1.temp = t2.temp;
+SELECT sum(numInstants(temp)) FROM tbl_tint_toast;
+
+DROP TABLE tbl_tint_toast;
+RESET mobilitydb.detoast_cache_size;
+
+-------------------------------------------------------------------------------
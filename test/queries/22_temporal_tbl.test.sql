@@ -147,6 +147,10 @@ SELECT MAX(memSize(temp)) FROM tbl_tint;
 SELECT MAX(memSize(temp)) FROM tbl_tfloat;
 SELECT MAX(memSize(temp)) FROM tbl_ttext;
 
+SELECT COUNT(*) FROM tbl_tint WHERE formatVersion(temp) <> 2;
+SELECT COUNT(*) FROM tbl_tfloat WHERE upgrade(temp) <> temp;
+SELECT COUNT(*) FROM tbl_ttext WHERE upgrade(temp) <> temp;
+
 /*
 SELECT period(temp) FROM tbl_tbool;
 SELECT box(temp) FROM tbl_tint;
@@ -300,6 +304,14 @@ SELECT MAX(timestampN(temp, numTimestamps(temp))) FROM tbl_tint;
 SELECT MAX(timestampN(temp, numTimestamps(temp))) FROM tbl_tfloat;
 SELECT MAX(timestampN(temp, numTimestamps(temp))) FROM tbl_ttext;
 
+CREATE TABLE tbl_tfloats_big(temp tfloat);
+ALTER TABLE tbl_tfloats_big ALTER COLUMN temp SET STORAGE EXTERNAL;
+INSERT INTO tbl_tfloats_big SELECT tfloats(array_agg(tfloatseq(ARRAY[tfloatinst(0, timestamptz '2000-01-01' + i * interval '1 min'), tfloatinst(1, timestamptz '2000-01-01' + (i + 1) * interval '1 min')], true, false) ORDER BY i)) FROM generate_series(0, 199) i;
+SELECT numInstants(temp), numTimestamps(temp) FROM tbl_tfloats_big;
+SELECT COUNT(*) FROM tbl_tfloats_big, generate_series(1, 400) i WHERE instantN(temp, i) <> (instants(temp))[i];
+SELECT COUNT(*) FROM tbl_tfloats_big, generate_series(1, 201) i WHERE timestampN(temp, i) <> (timestamps(temp))[i];
+DROP TABLE tbl_tfloats_big;
+
 SELECT MAX(array_length(timestamps(temp),1)) FROM tbl_tbool;
 SELECT MAX(array_length(timestamps(temp),1)) FROM tbl_tint;
 SELECT MAX(array_length(timestamps(temp),1)) FROM tbl_tfloat;
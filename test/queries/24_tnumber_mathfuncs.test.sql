@@ -467,4 +467,11 @@ SELECT round(degrees(tfloat '{1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03}'),
 SELECT round(degrees(tfloat '[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03]'), 1);
 SELECT round(degrees(tfloat '{[1.5@2000-01-01, 2.5@2000-01-02, 1.5@2000-01-03],[3.5@2000-01-04, 3.5@2000-01-05]}'), 1);
 
+SELECT weightedSum(ARRAY[tfloat '[1@2000-01-01, 3@2000-01-03]', tfloat '[2@2000-01-02, 4@2000-01-04]'], ARRAY[1, 2]);
+SELECT weightedSum(ARRAY[tfloat '[1@2000-01-01, 5@2000-01-05]', tfloat '[0@2000-01-01, 2@2000-01-03, 0@2000-01-05]', tfloat '{[1@2000-01-02, 1@2000-01-04]}'], ARRAY[1, 1, -1]);
+SELECT weightedSum(ARRAY[tfloat 'Interp=Stepwise;[1@2000-01-01, 2@2000-01-02, 2@2000-01-03]', tfloat '[0@2000-01-01, 2@2000-01-03]'], ARRAY[1, 1]);
+SELECT weightedSum(ARRAY[tfloat '[1@2000-01-01, 2@2000-01-02]', tfloat '[1@2000-01-03, 2@2000-01-04]'], ARRAY[1, 1]) IS NULL;
+/* Errors */
+SELECT weightedSum(ARRAY[tfloat '[1@2000-01-01, 2@2000-01-02]'], ARRAY[1, 2]);
+
 -------------------------------------------------------------------------------
@@ -956,3 +956,11 @@ SELECT ttext '[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03]' #>= ttext '{[AAA
 SELECT ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}' #>= ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
 
 -------------------------------------------------------------------------------
+-- Crossings of temporal numbers with linear interpolation
+-------------------------------------------------------------------------------
+
+SELECT tfloat '[1@2000-01-01, 3@2000-01-03]' #< tfloat '[3@2000-01-01, 1@2000-01-03]';
+SELECT tfloat '[1@2000-01-01, 3@2000-01-03]' #= tfloat '[3@2000-01-01, 1@2000-01-03]';
+SELECT tfloat '{[1@2000-01-01, 3@2000-01-03], [3@2000-01-04, 1@2000-01-06]}' #<= tint '[2@2000-01-01, 2@2000-01-06]';
+
+-------------------------------------------------------------------------------
@@ -1452,3 +1452,11 @@ SELECT ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04,
 SELECT ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}' #&> ttext '{[AAA@2000-01-01, BBB@2000-01-02, AAA@2000-01-03],[CCC@2000-01-04, CCC@2000-01-05]}';
 
 -------------------------------------------------------------------------------
+
+SELECT tint '[1@2000-01-01, 2@2000-01-02]' <-> timestamptz '2000-01-04';
+SELECT tint '[1@2000-01-01, 2@2000-01-02]' <-> period '[2000-01-01 12:00, 2000-01-03]';
+SELECT tfloat '{[1@2000-01-01, 2@2000-01-02],[1@2000-01-05, 1@2000-01-06]}' <-> timestamptz '2000-01-03';
+SELECT timestamptz '2000-01-03' <-> tfloat '{[1@2000-01-01, 2@2000-01-02],[1@2000-01-05, 1@2000-01-06]}';
+SELECT period '[2000-01-03, 2000-01-03 12:00]' <-> tfloat '{1@2000-01-01, 2@2000-01-05}';
+
+-------------------------------------------------------------------------------
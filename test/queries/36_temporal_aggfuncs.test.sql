@@ -152,6 +152,32 @@ SELECT round(tavg(temp), 6) FROM (VALUES
 ('[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tfloat), 
 ('[3@2000-01-02, 4@2000-01-06]'::tfloat)) t(temp);
 
+SELECT tseq_agg(v, t) FROM (VALUES
+(2.5::float, timestamptz '2000-01-03'), (1.5, timestamptz '2000-01-01'), 
+(NULL, timestamptz '2000-01-02')) t(v, t);
+SELECT tseq_agg(v, t) FROM (VALUES
+(1, timestamptz '2000-01-01'), (2, timestamptz '2000-01-02')) t(v, t);
+SELECT tcount_buckets(temp, interval '1 day') FROM (VALUES
+(tint '[1@2000-01-01, 2@2000-01-03]'), (tint '[3@2000-01-02 12:00, 3@2000-01-05)')) t(temp);
+SELECT tcount_buckets(temp, interval '2 hours', timestamptz '2000-01-01 01:00') FROM (VALUES
+(tbool '{t@2000-01-01 01:30, f@2000-01-01 06:00}'), (tbool 't@2000-01-01 02:00')) t(temp);
+SELECT tcount(temp) OVER (ORDER BY k ROWS 1 PRECEDING) FROM (VALUES
+(1, tint '[1@2000-01-01, 1@2000-01-03]'), (2, tint '[2@2000-01-02, 2@2000-01-04]'),
+(3, tint '[3@2000-01-03, 3@2000-01-05]')) t(k, temp);
+SELECT tavg(temp) OVER (ORDER BY k ROWS 1 PRECEDING) FROM (VALUES
+(1, tfloat '[1@2000-01-01, 3@2000-01-03]'), (2, tfloat '[5@2000-01-02, 5@2000-01-04]'),
+(3, tfloat '[2@2000-01-03, 2@2000-01-05]')) t(k, temp);
+WITH t(k, temp) AS (SELECT k, tintseq(ARRAY[
+  tintinst(k % 3, timestamptz '2000-01-01' + k * interval '1 day'),
+  tintinst(k % 3 + 1, timestamptz '2000-01-01' + (k + 3) * interval '1 day')])
+  FROM generate_series(1, 10) k)
+SELECT bool_and(m1 = r1 AND m2 = r2 AND m3 = r3) FROM (
+  SELECT tcount(temp) OVER w AS m1, tsum(temp) OVER w AS m2, tavg(temp) OVER w AS m3,
+    (SELECT tcount(temp) FROM t t2 WHERE t2.k BETWEEN t1.k - 2 AND t1.k) AS r1,
+    (SELECT tsum(temp) FROM t t2 WHERE t2.k BETWEEN t1.k - 2 AND t1.k) AS r2,
+    (SELECT tavg(temp) FROM t t2 WHERE t2.k BETWEEN t1.k - 2 AND t1.k) AS r3
+  FROM t t1 WINDOW w AS (ORDER BY k ROWS 2 PRECEDING)) s;
+
 --------------------------------------------------
 
 /* Errors */
@@ -164,5 +190,9 @@ SELECT tsum(temp) FROM ( VALUES
 SELECT tsum(temp) FROM (VALUES
 ('Interp=Stepwise;[1@2000-01-01, 2@2000-01-03, 1@2000-01-05, 2@2000-01-07]'::tfloat), 
 ('[3@2000-01-02, 4@2000-01-06]'::tfloat)) t(temp);
+SELECT tseq_agg(v, t) FROM (VALUES
+(1, timestamptz '2000-01-01'), (2, timestamptz '2000-01-01')) t(v, t);
+SELECT tcount_buckets(temp, interval '1 month') FROM (VALUES
+(tint '[1@2000-01-01, 2@2000-01-03]')) t(temp);
 
 --------------------------------------------------
@@ -217,3 +217,27 @@ set force_parallel_mode=off;
 
 -------------------------------------------------------------------------------
 
+-------------------------------------------------------------------------------
+-- Aggregate states spilled to disk
+-------------------------------------------------------------------------------
+
+create temp table tbl_tagg_spill as
+select k, tintseq(array[tintinst(1, t), tintinst(1, t + interval '30 minutes')]) as seq
+from (select k, timestamptz '2000-01-01' + (k * 7919 % 10000 / 2) * interval '1 hour' +
+  (k * 7919 % 10000 % 2) * interval '15 minutes' as t from generate_series(0, 9999) k) t;
+create temp table tbl_tagg_result as
+select tcount(seq) as c, tsum(seq) as s, tavg(seq) as a from tbl_tagg_spill;
+
+set work_mem = '64kB';
+select numSequences(tcount(seq)) from tbl_tagg_spill;
+select (select tcount(seq) from tbl_tagg_spill) = c, (select tsum(seq) from tbl_tagg_spill) = s,
+  (select tavg(seq) from tbl_tagg_spill) = a from tbl_tagg_result;
+select (select tcount(seq order by startTimestamp(seq)) from tbl_tagg_spill) = c
+from tbl_tagg_result;
+reset work_mem;
+
+drop table tbl_tagg_spill;
+drop table tbl_tagg_result;
+
+-------------------------------------------------------------------------------
+
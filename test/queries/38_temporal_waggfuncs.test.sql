@@ -55,6 +55,8 @@ SELECT wavg(temp, interval '5 minutes') FROM (VALUES (NULL::tfloat),('1@2000-01-
 --------------------------------------------------
 
 SELECT wmax(temp, interval '1 day') FROM (VALUES (tfloat '[1@2000-01-01, 1@2000-01-02]'),('[1@2000-01-03, 1@2000-01-04]')) t(temp);
+SELECT wmin(temp, interval '1 day') FROM (VALUES (tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]')) t(temp);
+SELECT wsum(temp, interval '1 day') FROM (VALUES (tint '[1@2000-01-01, 2@2000-01-02, 1@2000-01-03]')) t(temp);
 
 /* Errors */
 SELECT wsum(temp, interval '1 day') FROM (VALUES (tfloat '[1@2000-01-01, 1@2000-01-02]'),('[1@2000-01-03, 1@2000-01-04]')) t(temp);
@@ -151,6 +151,57 @@ DROP INDEX IF EXISTS tbl_tint_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_tfloat_big_spgist_idx;
 DROP INDEX IF EXISTS tbl_ttext_big_spgist_idx;
 
+-------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tint_big_brin_idx ON tbl_tint_big USING BRIN(temp);
+CREATE INDEX tbl_tfloat_big_brin_idx ON tbl_tfloat_big USING BRIN(temp);
+
+SELECT count(*) FROM tbl_tint_big WHERE temp && intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp <@ intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp ~= intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp << intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp &< intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp >> intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp &> intrange '[1,50]';
+SELECT count(*) FROM tbl_tint_big WHERE temp <<# period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp &<# period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp #>> period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp #&> period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp && tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp @> tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp <@ tint '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tint_big WHERE temp ~= tint '[1@2001-01-01, 10@2001-02-01]';
+
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp <@ floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp ~= floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp << floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp &< floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp >> floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp &> floatrange '[1,50]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp <<# period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp &<# period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #>> period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp #&> period '[2001-01-01, 2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp && tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp @> tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp <@ tfloat '[1@2001-01-01, 10@2001-02-01]';
+SELECT count(*) FROM tbl_tfloat_big WHERE temp ~= tfloat '[1@2001-01-01, 10@2001-02-01]';
+
+DROP INDEX IF EXISTS tbl_tint_big_brin_idx;
+DROP INDEX IF EXISTS tbl_tfloat_big_brin_idx;
+
+-------------------------------------------------------------------------------
+
+CREATE INDEX tbl_tbox_gist_idx ON tbl_tbox USING GIST(b);
+
+SELECT (SELECT count(*) FROM tbl_tbox WHERE b && tbox 'TBOX((1, 2001-01-01), (50, 2001-06-01))') = (SELECT count(*) FROM tbl_tbox WHERE tbox_overlaps(b, tbox 'TBOX((1, 2001-01-01), (50, 2001-06-01))'));
+SELECT (SELECT count(*) FROM tbl_tbox WHERE b @> tbox 'TBOX((1, 2001-01-01), (50, 2001-06-01))') = (SELECT count(*) FROM tbl_tbox WHERE tbox_contains(b, tbox 'TBOX((1, 2001-01-01), (50, 2001-06-01))'));
+
+DROP INDEX IF EXISTS tbl_tbox_gist_idx;
+
 
 -------------------------------------------------------------------------------
 
@@ -47,3 +47,13 @@ foreach(file ${testfiles})
 	set_tests_properties(${TESTNAME} PROPERTIES RESOURCE_LOCK DBLOCK)
 endforeach()
 
+
+if (WITH_BENCHMARK)
+	add_test(
+		NAME bench_micro
+		WORKING_DIRECTORY ${PROJECT_SOURCE_DIR}/test
+		COMMAND ${PROJECT_SOURCE_DIR}/test/scripts/test.sh run_passfail ${CMAKE_BINARY_DIR} bench_micro "bench/micro.sql"
+	)
+	set_tests_properties(bench_micro PROPERTIES FIXTURES_REQUIRED DB)
+	set_tests_properties(bench_micro PROPERTIES RESOURCE_LOCK DBLOCK)
+endif ()
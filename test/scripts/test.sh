@@ -25,8 +25,11 @@ setup)
 
 	if [ ! -z "$POSTGIS" ]; then
 		POSTGIS=`basename $POSTGIS .so`
-		echo "shared_preload_libraries = '$POSTGIS'" >> $WORKDIR/db/postgresql.conf 
+		PRELOAD="$POSTGIS,"
 	fi
+	# The extension is preloaded to test the cache shared by the backends
+	echo "shared_preload_libraries = '$PRELOAD$SOFILE'" >> $WORKDIR/db/postgresql.conf 
+	echo "mobilitydb.shared_cache_size = 1MB" >> $WORKDIR/db/postgresql.conf
 	echo "max_locks_per_transaction = 128" >> $WORKDIR/db/postgresql.conf
 	echo "timezone = 'UTC'" >> $WORKDIR/db/postgresql.conf
 	echo "parallel_tuple_cost = 100" >> $WORKDIR/db/postgresql.conf